@@ -34,9 +34,115 @@
 #pragma once
 
 #include <cmath>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+// SIMD backend: SSE2 is the x86-64 baseline (SSE4.1 blends when the compiler targets it), NEON on ARM64.
+// Batch transforms pick AVX2/FMA at runtime through InstructionSet.
+// Define AMF_MATH_SCALAR to build the scalar reference implementation.
+#if !defined(AMF_MATH_SCALAR)
+    #if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+        #define AMF_MATH_SSE
+        #include <emmintrin.h>
+        #if defined(__SSE4_1__) || defined(__AVX__)
+            #define AMF_MATH_SSE41
+            #include <smmintrin.h>
+        #endif
+        #include <immintrin.h>
+        #include "CPUCaps.h"
+    #elif defined(__aarch64__) || defined(_M_ARM64)
+        #define AMF_MATH_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined(AMF_MATH_SSE) || defined(AMF_MATH_NEON)
+    #define AMF_MATH_SIMD
+#endif
+
+#if defined(AMF_MATH_SSE) && (defined(__GNUC__) || defined(__clang__))
+    #define AMF_MATH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+    #define AMF_MATH_TARGET_AVX2
+#endif
 
 namespace amf
 {
+#if defined(AMF_MATH_SSE)
+    //---------------------------------------------------------------------------------------------
+    // 4 x float register helpers shared by the SSE and NEON paths; results match the scalar code
+    // bit for bit except where noted (operation order is kept)
+    typedef __m128 AMFFloat4;
+
+    #define AMF_FLOAT4_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(w, z, y, x))
+    #define AMF_FLOAT4_SPLAT_LANE(v, i)       _mm_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+
+    inline AMFFloat4 AMFFloat4Load(const float* p)              { return _mm_loadu_ps(p); }
+    inline void      AMFFloat4Store(float* p, AMFFloat4 v)      { _mm_storeu_ps(p, v); }
+    inline AMFFloat4 AMFFloat4Splat(float f)                    { return _mm_set1_ps(f); }
+    inline AMFFloat4 AMFFloat4Add(AMFFloat4 a, AMFFloat4 b)     { return _mm_add_ps(a, b); }
+    inline AMFFloat4 AMFFloat4Sub(AMFFloat4 a, AMFFloat4 b)     { return _mm_sub_ps(a, b); }
+    inline AMFFloat4 AMFFloat4Mul(AMFFloat4 a, AMFFloat4 b)     { return _mm_mul_ps(a, b); }
+    inline AMFFloat4 AMFFloat4Div(AMFFloat4 a, AMFFloat4 b)     { return _mm_div_ps(a, b); }
+    inline AMFFloat4 AMFFloat4Sqrt(AMFFloat4 a)                 { return _mm_sqrt_ps(a); }
+    inline AMFFloat4 AMFFloat4Negate(AMFFloat4 a)               { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    inline AMFFloat4 AMFFloat4MergeLow(AMFFloat4 a, AMFFloat4 b)   { return _mm_unpacklo_ps(a, b); }
+    inline AMFFloat4 AMFFloat4MergeHigh(AMFFloat4 a, AMFFloat4 b)  { return _mm_unpackhi_ps(a, b); }
+    // x + y + z summed in scalar order and broadcast
+    inline AMFFloat4 AMFFloat4Dot3(AMFFloat4 a, AMFFloat4 b)
+    {
+        AMFFloat4 p = _mm_mul_ps(a, b);
+        AMFFloat4 sum = _mm_add_ss(_mm_add_ss(p, AMF_FLOAT4_SWIZZLE(p, 1, 1, 1, 1)), AMF_FLOAT4_SWIZZLE(p, 2, 2, 2, 2));
+        return AMF_FLOAT4_SWIZZLE(sum, 0, 0, 0, 0);
+    }
+    inline AMFFloat4 AMFFloat4Dot4(AMFFloat4 a, AMFFloat4 b)
+    {
+        AMFFloat4 p = _mm_mul_ps(a, b);
+        AMFFloat4 sum = _mm_add_ss(_mm_add_ss(p, AMF_FLOAT4_SWIZZLE(p, 1, 1, 1, 1)), AMF_FLOAT4_SWIZZLE(p, 2, 2, 2, 2));
+        sum = _mm_add_ss(sum, AMF_FLOAT4_SWIZZLE(p, 3, 3, 3, 3));
+        return AMF_FLOAT4_SWIZZLE(sum, 0, 0, 0, 0);
+    }
+    inline AMFFloat4 AMFFloat4Cross3(AMFFloat4 a, AMFFloat4 b)
+    {
+        AMFFloat4 r = _mm_sub_ps(
+            _mm_mul_ps(AMF_FLOAT4_SWIZZLE(a, 1, 2, 0, 3), AMF_FLOAT4_SWIZZLE(b, 2, 0, 1, 3)),
+            _mm_mul_ps(AMF_FLOAT4_SWIZZLE(a, 2, 0, 1, 3), AMF_FLOAT4_SWIZZLE(b, 1, 2, 0, 3)));
+#if defined(AMF_MATH_SSE41)
+        return _mm_blend_ps(r, _mm_setzero_ps(), 0x8);
+#else
+        return _mm_and_ps(r, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+#endif
+    }
+    inline float     AMFFloat4GetX(AMFFloat4 v)                 { return _mm_cvtss_f32(v); }
+#elif defined(AMF_MATH_NEON)
+    typedef float32x4_t AMFFloat4;
+
+    #define AMF_FLOAT4_SPLAT_LANE(v, i)       vdupq_laneq_f32((v), (i))
+
+    inline AMFFloat4 AMFFloat4Load(const float* p)              { return vld1q_f32(p); }
+    inline void      AMFFloat4Store(float* p, AMFFloat4 v)      { vst1q_f32(p, v); }
+    inline AMFFloat4 AMFFloat4Splat(float f)                    { return vdupq_n_f32(f); }
+    inline AMFFloat4 AMFFloat4Add(AMFFloat4 a, AMFFloat4 b)     { return vaddq_f32(a, b); }
+    inline AMFFloat4 AMFFloat4Sub(AMFFloat4 a, AMFFloat4 b)     { return vsubq_f32(a, b); }
+    inline AMFFloat4 AMFFloat4Mul(AMFFloat4 a, AMFFloat4 b)     { return vmulq_f32(a, b); }
+    inline AMFFloat4 AMFFloat4Div(AMFFloat4 a, AMFFloat4 b)     { return vdivq_f32(a, b); }
+    inline AMFFloat4 AMFFloat4Sqrt(AMFFloat4 a)                 { return vsqrtq_f32(a); }
+    inline AMFFloat4 AMFFloat4Negate(AMFFloat4 a)               { return vnegq_f32(a); }
+    inline AMFFloat4 AMFFloat4MergeLow(AMFFloat4 a, AMFFloat4 b)   { return vzip1q_f32(a, b); }
+    inline AMFFloat4 AMFFloat4MergeHigh(AMFFloat4 a, AMFFloat4 b)  { return vzip2q_f32(a, b); }
+    inline AMFFloat4 AMFFloat4Dot3(AMFFloat4 a, AMFFloat4 b)
+    {
+        AMFFloat4 p = vmulq_f32(a, b);
+        return vdupq_n_f32(vgetq_lane_f32(p, 0) + vgetq_lane_f32(p, 1) + vgetq_lane_f32(p, 2));
+    }
+    inline AMFFloat4 AMFFloat4Dot4(AMFFloat4 a, AMFFloat4 b)
+    {
+        AMFFloat4 p = vmulq_f32(a, b);
+        return vdupq_n_f32(vgetq_lane_f32(p, 0) + vgetq_lane_f32(p, 1) + vgetq_lane_f32(p, 2) + vgetq_lane_f32(p, 3));
+    }
+    inline float     AMFFloat4GetX(AMFFloat4 v)                 { return vgetq_lane_f32(v, 0); }
+#endif
     // right-handed system
     // +y is up
     // +x is to the right
@@ -77,54 +183,88 @@ namespace amf
         {
             x= _x; y = _y; z = _z; w = _w;
         }
+#if defined(AMF_MATH_SIMD)
+        inline AMFFloat4 Load() const { return AMFFloat4Load(&x); }
+        inline void Store(AMFFloat4 v) { AMFFloat4Store(&x, v); }
+        static inline VectorPOD FromFloat4(AMFFloat4 v)
+        {
+            VectorPOD vector;
+            vector.Store(v);
+            return vector;
+        }
+#endif
 
         inline VectorPOD& operator-=(const VectorPOD& other)
         {
+#if defined(AMF_MATH_SIMD)
+            Store(AMFFloat4Sub(Load(), other.Load()));
+#else
             x -=other.x; y -=other.y; z -=other.z; w -=other.w;
+#endif
             return *this;
         }
         inline VectorPOD operator-(const VectorPOD& other) const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Sub(Load(), other.Load()));
+#else
             VectorPOD vector;
             vector.x = x - other.x;
             vector.y = y - other.y;
             vector.z = z - other.z;
             vector.w = w - other.w;
             return vector;
+#endif
         }
         inline VectorPOD& operator+=(const VectorPOD& other)
         {
+#if defined(AMF_MATH_SIMD)
+            Store(AMFFloat4Add(Load(), other.Load()));
+#else
             x +=other.x;
             y +=other.y;
             z +=other.z;
             w +=other.w;
+#endif
             return *this;
         }
         inline VectorPOD operator+(const VectorPOD& other)  const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Add(Load(), other.Load()));
+#else
             VectorPOD vector;
             vector.x = x + other.x;
             vector.y = y + other.y;
             vector.z = z + other.z;
             vector.w = w + other.w;
             return vector;
+#endif
         }
 
         inline VectorPOD operator*(const VectorPOD& other)  const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Mul(Load(), other.Load()));
+#else
             VectorPOD vector;
             vector.x = x * other.x;
             vector.y = y * other.y;
             vector.z = z * other.z;
             vector.w = w * other.w;
             return vector;
+#endif
         }
         inline VectorPOD operator*=(const VectorPOD& other)
         {
+#if defined(AMF_MATH_SIMD)
+            Store(AMFFloat4Mul(Load(), other.Load()));
+#else
             x*=other.x;
             y*=other.y;
             z*=other.z;
             w*=other.w;
+#endif
             return *this;
         }
 
@@ -157,17 +297,25 @@ namespace amf
         inline bool operator!=(const VectorPOD& other) const { return !operator==(other); }
         inline VectorPOD Dot3(const VectorPOD& vec) const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Dot3(Load(), vec.Load()));
+#else
             float fValue = x * vec.x + y * vec.y + z * vec.z;
             VectorPOD Result;
             Result.Assign(fValue, fValue, fValue, fValue);
             return Result;
+#endif
         }
         inline VectorPOD Dot4(const VectorPOD& vec) const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Dot4(Load(), vec.Load()));
+#else
             float fValue = x * vec.x + y * vec.y + z * vec.z + w * vec.w;
             VectorPOD Result;
             Result.Assign(fValue, fValue, fValue, fValue);
             return Result;
+#endif
         }
 
         inline VectorPOD LengthSq3()  const
@@ -182,12 +330,16 @@ namespace amf
 
         inline VectorPOD Sqrt()  const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Sqrt(Load()));
+#else
             VectorPOD Result;
             Result.x = sqrtf(x);
             Result.y = sqrtf(y);
             Result.z = sqrtf(z);
             Result.w = sqrtf(w);
             return Result;
+#endif
         }
         inline VectorPOD Length3()  const
         {
@@ -216,16 +368,22 @@ namespace amf
             {
                 fLength = 1.0f / fLength;
             }
-
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Mul(Load(), AMFFloat4Splat(fLength)));
+#else
             vResult.x = x * fLength;
             vResult.y = y * fLength;
             vResult.z = z * fLength;
             vResult.w = w * fLength;
             return vResult;
+#endif
         }
 
         inline VectorPOD Cross3(const VectorPOD& vec) const
         {
+#if defined(AMF_MATH_SSE)
+            return FromFloat4(AMFFloat4Cross3(Load(), vec.Load()));
+#else
             VectorPOD vResult;
             vResult.Assign(
                 (y * vec.z) - (z * vec.y),
@@ -233,15 +391,20 @@ namespace amf
                 (x * vec.y) - (y * vec.x),
                 0.0f);
             return vResult;
+#endif
         }
         inline VectorPOD Negate() const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Negate(Load()));
+#else
             VectorPOD Result;
             Result.x = -x;
             Result.y = -y;
             Result.z = -z;
             Result.w = -w;
             return Result;
+#endif
         }
 
 		inline VectorPOD operator-() const
@@ -251,21 +414,29 @@ namespace amf
 
         inline VectorPOD MergeXY(const VectorPOD& vec) const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4MergeLow(Load(), vec.Load()));
+#else
             VectorPOD Result;
             Result.x = x;
             Result.y = vec.x;
             Result.z = y;
             Result.w = vec.y;
             return Result;
+#endif
         }
         inline VectorPOD MergeZW(const VectorPOD& vec) const
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4MergeHigh(Load(), vec.Load()));
+#else
             VectorPOD Result;
             Result.x = z;
             Result.y = vec.z;
             Result.z = w;
             Result.w = vec.w;
             return Result;
+#endif
         }
         inline VectorPOD VectorPermute(const VectorPOD& vec, uint32_t PermuteX, uint32_t PermuteY, uint32_t PermuteZ, uint32_t PermuteW ) const
         {
@@ -296,12 +467,16 @@ namespace amf
         }
         inline VectorPOD Reciprocal()
         {
+#if defined(AMF_MATH_SIMD)
+            return FromFloat4(AMFFloat4Div(AMFFloat4Splat(1.f), Load()));
+#else
             VectorPOD Result;
             Result.x = 1.f / x;
             Result.y = 1.f / y;
             Result.z = 1.f / z;
             Result.w = 1.f / w;
             return Result;
+#endif
         }
     };
 
@@ -381,12 +556,24 @@ namespace amf
 
         inline Quaternion operator*(const Quaternion& other) const
         {
+#if defined(AMF_MATH_SSE)
+            // same terms and summation order as the scalar code, signs folded into constants
+            const AMFFloat4 q = Load();
+            AMFFloat4 res = _mm_mul_ps(_mm_set1_ps(other.w), q);
+            res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(other.x), _mm_mul_ps(AMF_FLOAT4_SWIZZLE(q, 3, 2, 1, 0), _mm_setr_ps(1.f, -1.f, 1.f, -1.f))));
+            res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(other.y), _mm_mul_ps(AMF_FLOAT4_SWIZZLE(q, 2, 3, 0, 1), _mm_setr_ps(1.f, 1.f, -1.f, -1.f))));
+            res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(other.z), _mm_mul_ps(AMF_FLOAT4_SWIZZLE(q, 1, 0, 3, 2), _mm_setr_ps(-1.f, 1.f, 1.f, -1.f))));
+            Quaternion result;
+            result.Store(res);
+            return result;
+#else
             return Quaternion(
             other.w * x + other.x * w + other.y * z - other.z * y,
             other.w * y - other.x * z + other.y * w + other.z * x,
             other.w * z + other.x * y - other.y * x + other.z * w,
             other.w * w - other.x * x - other.y * y - other.z * z
             );
+#endif
         }
 
         inline const Quaternion& RotateBy(const Quaternion& rotator)
@@ -536,6 +723,63 @@ namespace amf
         *pCos = sign*p;
     }
 
+#if defined(AMF_MATH_SSE)
+    //---------------------------------------------------------------------------------------------
+    // AVX/FMA is not part of the x86-64 baseline: check the CPU and that the OS saves YMM state
+    inline bool AMFMathHasAVX2()
+    {
+        static const bool s_bAVX2 = []()
+        {
+            if(!InstructionSet::OSXSAVE() || !InstructionSet::AVX() || !InstructionSet::AVX2() || !InstructionSet::FMA())
+            {
+                return false;
+            }
+#if defined(_MSC_VER)
+            const unsigned long long xcr0 = _xgetbv(0);
+#else
+            unsigned int eax = 0;
+            unsigned int edx = 0;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            const unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+            return (xcr0 & 0x6) == 0x6;
+        }();
+        return s_bAVX2;
+    }
+    //---------------------------------------------------------------------------------------------
+    // pDst[i] = x * rows[0] + y * rows[1] + z * rows[2] + rows[3], two vertices per 256-bit register.
+    // Uses FMA so results can differ from the scalar path in the last bit.
+    AMF_MATH_TARGET_AVX2 inline void AMFMathTransformAVX2(const VectorPOD rows[4], const VectorPOD* pSrc, VectorPOD* pDst, size_t count)
+    {
+        const __m256 r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&rows[0]));
+        const __m256 r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&rows[1]));
+        const __m256 r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&rows[2]));
+        const __m256 r3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&rows[3]));
+
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+        {
+            const __m256 v0 = _mm256_loadu_ps(&pSrc[i].x);
+            const __m256 v1 = _mm256_loadu_ps(&pSrc[i + 2].x);
+            __m256 res0 = _mm256_fmadd_ps(_mm256_permute_ps(v0, 0xAA), r2, r3);
+            __m256 res1 = _mm256_fmadd_ps(_mm256_permute_ps(v1, 0xAA), r2, r3);
+            res0 = _mm256_fmadd_ps(_mm256_permute_ps(v0, 0x55), r1, res0);
+            res1 = _mm256_fmadd_ps(_mm256_permute_ps(v1, 0x55), r1, res1);
+            res0 = _mm256_fmadd_ps(_mm256_permute_ps(v0, 0x00), r0, res0);
+            res1 = _mm256_fmadd_ps(_mm256_permute_ps(v1, 0x00), r0, res1);
+            _mm256_storeu_ps(&pDst[i].x, res0);
+            _mm256_storeu_ps(&pDst[i + 2].x, res1);
+        }
+        for(; i < count; i++)
+        {
+            const __m128 v = _mm_loadu_ps(&pSrc[i].x);
+            __m128 res = _mm_fmadd_ps(AMF_FLOAT4_SWIZZLE(v, 2, 2, 2, 2), _mm256_castps256_ps128(r2), _mm256_castps256_ps128(r3));
+            res = _mm_fmadd_ps(AMF_FLOAT4_SWIZZLE(v, 1, 1, 1, 1), _mm256_castps256_ps128(r1), res);
+            res = _mm_fmadd_ps(AMF_FLOAT4_SWIZZLE(v, 0, 0, 0, 0), _mm256_castps256_ps128(r0), res);
+            _mm_storeu_ps(&pDst[i].x, res);
+        }
+    }
+#endif
     //---------------------------------------------------------------------------------------------
     class Matrix
     {
@@ -573,11 +817,30 @@ namespace amf
 
         inline Matrix operator*(const Matrix& n) const
         {
+#if defined(AMF_MATH_SIMD)
+            // row i of the result is sum(n.m[i][j] * r[j]), accumulated in the scalar order
+            const AMFFloat4 r0 = r[0].Load();
+            const AMFFloat4 r1 = r[1].Load();
+            const AMFFloat4 r2 = r[2].Load();
+            const AMFFloat4 r3 = r[3].Load();
+            float ret[16];
+            for(int i = 0; i < 4; i++)
+            {
+                const AMFFloat4 nr = n.r[i].Load();
+                AMFFloat4 row = AMFFloat4Mul(AMF_FLOAT4_SPLAT_LANE(nr, 0), r0);
+                row = AMFFloat4Add(row, AMFFloat4Mul(AMF_FLOAT4_SPLAT_LANE(nr, 1), r1));
+                row = AMFFloat4Add(row, AMFFloat4Mul(AMF_FLOAT4_SPLAT_LANE(nr, 2), r2));
+                row = AMFFloat4Add(row, AMFFloat4Mul(AMF_FLOAT4_SPLAT_LANE(nr, 3), r3));
+                AMFFloat4Store(ret + i * 4, row);
+            }
+            return Matrix(ret);
+#else
             return Matrix(
                      k[0]*n.k[0]  + k[4]*n.k[1]  + k[8]*n.k[2]  + k[12]*n.k[3],   k[1]*n.k[0]  + k[5]*n.k[1]  + k[9]*n.k[2]  + k[13]*n.k[3],   k[2]*n.k[0]  + k[6]*n.k[1]  + k[10]*n.k[2]  + k[14]*n.k[3],   k[3]*n.k[0]  + k[7]*n.k[1]  + k[11]*n.k[2]  + k[15]*n.k[3],
                      k[0]*n.k[4]  + k[4]*n.k[5]  + k[8]*n.k[6]  + k[12]*n.k[7],   k[1]*n.k[4]  + k[5]*n.k[5]  + k[9]*n.k[6]  + k[13]*n.k[7],   k[2]*n.k[4]  + k[6]*n.k[5]  + k[10]*n.k[6]  + k[14]*n.k[7],   k[3]*n.k[4]  + k[7]*n.k[5]  + k[11]*n.k[6]  + k[15]*n.k[7],
                      k[0]*n.k[8]  + k[4]*n.k[9]  + k[8]*n.k[10] + k[12]*n.k[11],  k[1]*n.k[8]  + k[5]*n.k[9]  + k[9]*n.k[10] + k[13]*n.k[11],  k[2]*n.k[8]  + k[6]*n.k[9]  + k[10]*n.k[10] + k[14]*n.k[11],  k[3]*n.k[8]  + k[7]*n.k[9]  + k[11]*n.k[10] + k[15]*n.k[11],
                      k[0]*n.k[12] + k[4]*n.k[13] + k[8]*n.k[14] + k[12]*n.k[15],  k[1]*n.k[12] + k[5]*n.k[13] + k[9]*n.k[14] + k[13]*n.k[15],  k[2]*n.k[12] + k[6]*n.k[13] + k[10]*n.k[14] + k[14]*n.k[15],  k[3]*n.k[12] + k[7]*n.k[13] + k[11]*n.k[14] + k[15]*n.k[15]);
+#endif
         }
         inline Matrix operator*=(const Matrix& other)
         {
@@ -596,6 +859,13 @@ namespace amf
 
         inline Vector operator*(const Vector& v) const
         {
+#if defined(AMF_MATH_SIMD)
+            const AMFFloat4 vec = v.Load();
+            AMFFloat4 ret = AMFFloat4Add(AMFFloat4Mul(AMF_FLOAT4_SPLAT_LANE(vec, 2), r[2].Load()), r[3].Load());
+            ret = AMFFloat4Add(AMFFloat4Mul(AMF_FLOAT4_SPLAT_LANE(vec, 1), r[1].Load()), ret);
+            ret = AMFFloat4Add(AMFFloat4Mul(AMF_FLOAT4_SPLAT_LANE(vec, 0), r[0].Load()), ret);
+            return VectorPOD::FromFloat4(ret);
+#else
             Vector Z(v.z, v.z, v.z, v.z);
             Vector Y(v.y, v.y, v.y, v.y);
             Vector X(v.x, v.x, v.x, v.x);
@@ -606,6 +876,22 @@ namespace amf
             ret = X * r[0] + ret;
 
             return ret;
+#endif
+        }
+        // transforms an array of points (w ignored) as operator*(const Vector&) does
+        inline void Transform(const VectorPOD* pSrc, VectorPOD* pDst, size_t count) const
+        {
+#if defined(AMF_MATH_SSE)
+            if(AMFMathHasAVX2())
+            {
+                AMFMathTransformAVX2(r, pSrc, pDst, count);
+                return;
+            }
+#endif
+            for(size_t i = 0; i < count; i++)
+            {
+                pDst[i] = *this * Vector(pSrc[i]);
+            }
         }
 
         void MatrixAffineTransformation(const Vector &Scaling, const Vector &RotationOrigin, const Vector &RotationQuaternion, const Vector &Translation)
@@ -983,6 +1269,70 @@ namespace amf
         }
         inline Matrix Inverse(Vector *pDeterminant)
         {
+#if defined(AMF_MATH_SSE)
+            // 2x2 block adjugate form: M = |A B|
+            //                              |C D|, X# denotes adj(X)
+            // rounding differs from the scalar cofactor expansion, accuracy is the same
+            #define AMF_MAT2_MUL(a, b)      _mm_add_ps(_mm_mul_ps(a, AMF_FLOAT4_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(AMF_FLOAT4_SWIZZLE(a, 1, 0, 3, 2), AMF_FLOAT4_SWIZZLE(b, 2, 1, 2, 1)))
+            #define AMF_MAT2_ADJ_MUL(a, b)  _mm_sub_ps(_mm_mul_ps(AMF_FLOAT4_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(AMF_FLOAT4_SWIZZLE(a, 1, 1, 2, 2), AMF_FLOAT4_SWIZZLE(b, 2, 3, 0, 1)))
+            #define AMF_MAT2_MUL_ADJ(a, b)  _mm_sub_ps(_mm_mul_ps(a, AMF_FLOAT4_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(AMF_FLOAT4_SWIZZLE(a, 1, 0, 3, 2), AMF_FLOAT4_SWIZZLE(b, 2, 1, 2, 1)))
+
+            const __m128 r0 = r[0].Load();
+            const __m128 r1 = r[1].Load();
+            const __m128 r2 = r[2].Load();
+            const __m128 r3 = r[3].Load();
+
+            const __m128 A = _mm_movelh_ps(r0, r1);
+            const __m128 B = _mm_movehl_ps(r1, r0);
+            const __m128 C = _mm_movelh_ps(r2, r3);
+            const __m128 D = _mm_movehl_ps(r3, r2);
+
+            // (|A| |B| |C| |D|)
+            const __m128 detSub = _mm_sub_ps(
+                _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+                _mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0))));
+            const __m128 detA = AMF_FLOAT4_SWIZZLE(detSub, 0, 0, 0, 0);
+            const __m128 detB = AMF_FLOAT4_SWIZZLE(detSub, 1, 1, 1, 1);
+            const __m128 detC = AMF_FLOAT4_SWIZZLE(detSub, 2, 2, 2, 2);
+            const __m128 detD = AMF_FLOAT4_SWIZZLE(detSub, 3, 3, 3, 3);
+
+            const __m128 D_C = AMF_MAT2_ADJ_MUL(D, C);
+            const __m128 A_B = AMF_MAT2_ADJ_MUL(A, B);
+            __m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), AMF_MAT2_MUL(B, D_C));
+            __m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), AMF_MAT2_MUL(C, A_B));
+            __m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), AMF_MAT2_MUL_ADJ(D, A_B));
+            __m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), AMF_MAT2_MUL_ADJ(A, D_C));
+
+            // |M| = |A||D| + |B||C| - tr(A#B D#C)
+            __m128 tr = _mm_mul_ps(A_B, AMF_FLOAT4_SWIZZLE(D_C, 0, 2, 1, 3));
+            tr = _mm_add_ps(tr, AMF_FLOAT4_SWIZZLE(tr, 1, 0, 3, 2));
+            tr = _mm_add_ps(tr, AMF_FLOAT4_SWIZZLE(tr, 2, 3, 0, 1));
+            const __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+            const __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), detM);
+            X_ = _mm_mul_ps(X_, rDetM);
+            Y_ = _mm_mul_ps(Y_, rDetM);
+            Z_ = _mm_mul_ps(Z_, rDetM);
+            W_ = _mm_mul_ps(W_, rDetM);
+
+            Matrix ret;
+            ret.r[0].Store(_mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(1, 3, 1, 3)));
+            ret.r[1].Store(_mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(0, 2, 0, 2)));
+            ret.r[2].Store(_mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(1, 3, 1, 3)));
+            ret.r[3].Store(_mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(0, 2, 0, 2)));
+
+            #undef AMF_MAT2_MUL
+            #undef AMF_MAT2_ADJ_MUL
+            #undef AMF_MAT2_MUL_ADJ
+
+            if (pDeterminant != nullptr)
+            {
+                // like the scalar path this reports the reciprocal
+                const float det = 1.0f / AMFFloat4GetX(detM);
+                *pDeterminant = Vector(det, det, det, det);
+            }
+            return ret;
+#else
 
             float A2323 = m[2][2] * m[3][3] - m[2][3] * m[3][2];
             float A1323 = m[2][1] * m[3][3] - m[2][3] * m[3][1];
@@ -1032,6 +1382,7 @@ namespace amf
                 *pDeterminant = Vector(det,det,det,det);
             }
             return ret;
+#endif
         }
 
     };
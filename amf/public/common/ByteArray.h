@@ -40,21 +40,33 @@
 #define    INIT_ARRAY_SIZE 1024
 #define    ARRAY_MAX_SIZE (1LL << 60LL) // extremely large maximum size
 //------------------------------------------------------------------------
+// growable byte buffer
+// - capacity grows geometrically, new bytes are not initialized
+// - Consume() drops data from the front by moving the head, the data is compacted lazily on growth
+//------------------------------------------------------------------------
 class AMFByteArray
 {
 protected:
-    amf_uint8        *m_pData;
+    amf_uint8        *m_pData;      // allocation
+    amf_size         m_iOffset;     // consumed bytes in front of the data
     amf_size         m_iSize;
-    amf_size         m_iMaxSize;
+    amf_size         m_iMaxSize;    // allocation size
 public:
-    AMFByteArray() : m_pData(0), m_iSize(0), m_iMaxSize(0)
+    AMFByteArray() : m_pData(0), m_iOffset(0), m_iSize(0), m_iMaxSize(0)
     {
     }
-    AMFByteArray(const AMFByteArray &other) : m_pData(0), m_iSize(0), m_iMaxSize(0)
+    AMFByteArray(const AMFByteArray &other) : m_pData(0), m_iOffset(0), m_iSize(0), m_iMaxSize(0)
     {
         *this = other;
     }
-    AMFByteArray(amf_size num) : m_pData(0), m_iSize(0), m_iMaxSize(0)
+    AMFByteArray(AMFByteArray &&other) : m_pData(other.m_pData), m_iOffset(other.m_iOffset), m_iSize(other.m_iSize), m_iMaxSize(other.m_iMaxSize)
+    {
+        other.m_pData = 0;
+        other.m_iOffset = 0;
+        other.m_iSize = 0;
+        other.m_iMaxSize = 0;
+    }
+    AMFByteArray(amf_size num) : m_pData(0), m_iOffset(0), m_iSize(0), m_iMaxSize(0)
     {
         SetSize(num);
     }
@@ -67,70 +79,127 @@ public:
     }
     void  SetSize(amf_size num)
     {
-        if (num == m_iSize)
+        if (num > m_iMaxSize - m_iOffset && !Realloc(num))
         {
             return;
         }
-        if (num < m_iSize)
+        m_iSize = num;
+        if (m_iSize == 0)
         {
-            memset(m_pData + num, 0, m_iMaxSize - num);
+            m_iOffset = 0;
         }
-        else if (num > m_iMaxSize)
+    }
+    // makes sure that SetSize(num) will not reallocate
+    void  Reserve(amf_size num)
+    {
+        if (num > m_iMaxSize - m_iOffset)
         {
-            // This is done to prevent the following error from surfacing
-            // for the pNewData allocation on some compilers:
-            //     -Werror=alloc-size-larger-than=
-            amf_size newSize = (num / INIT_ARRAY_SIZE) * INIT_ARRAY_SIZE + INIT_ARRAY_SIZE;
-            if (newSize > ARRAY_MAX_SIZE)
-            {
-                return;
-            }
-            m_iMaxSize = newSize;
-
-            amf_uint8 *pNewData = new amf_uint8[m_iMaxSize];
-            memset(pNewData, 0, m_iMaxSize);
-            if (m_pData != NULL)
-            {
-                memcpy(pNewData, m_pData, m_iSize);
-                delete[] m_pData;
-            }
-            m_pData = pNewData;
+            Realloc(num);
         }
-        m_iSize = num;
     }
-    void Copy(const AMFByteArray &old)
+    // removes num bytes from the front without moving the remaining data
+    void  Consume(amf_size num)
     {
-        if (m_iMaxSize < old.m_iSize)
+        if (num >= m_iSize)
         {
-            m_iMaxSize = old.m_iMaxSize;
-            if (m_pData != NULL)
-            {
-                delete[] m_pData;
-            }
-            m_pData = new amf_uint8[m_iMaxSize];
-            memset(m_pData, 0, m_iMaxSize);
+            m_iOffset = 0;
+            m_iSize = 0;
+            return;
         }
-        memcpy(m_pData, old.m_pData, old.m_iSize);
-        m_iSize = old.m_iSize;
+        m_iOffset += num;
+        m_iSize -= num;
+    }
+    void  Clear()
+    {
+        m_iOffset = 0;
+        m_iSize = 0;
+    }
+    void Copy(const AMFByteArray &old)
+    {
+        *this = old;
     }
     amf_uint8    operator[] (amf_size iPos) const
     {
-        return m_pData[iPos];
+        return m_pData[m_iOffset + iPos];
     }
     amf_uint8&    operator[] (amf_size iPos)
     {
-        return m_pData[iPos];
+        return m_pData[m_iOffset + iPos];
     }
     AMFByteArray&    operator=(const AMFByteArray &other)
     {
-        SetSize(other.GetSize());
-        if (GetSize() > 0)
+        if (this != &other)
         {
-            memcpy(GetData(), other.GetData(), GetSize());
+            Clear();
+            SetSize(other.GetSize());
+            if (GetSize() > 0)
+            {
+                memcpy(GetData(), other.GetData(), GetSize());
+            }
         }
         return *this;
     }
-    amf_uint8 *GetData() const { return m_pData; }
+    AMFByteArray&    operator=(AMFByteArray &&other)
+    {
+        if (this != &other)
+        {
+            if (m_pData != 0)
+            {
+                delete[] m_pData;
+            }
+            m_pData = other.m_pData;
+            m_iOffset = other.m_iOffset;
+            m_iSize = other.m_iSize;
+            m_iMaxSize = other.m_iMaxSize;
+            other.m_pData = 0;
+            other.m_iOffset = 0;
+            other.m_iSize = 0;
+            other.m_iMaxSize = 0;
+        }
+        return *this;
+    }
+    amf_uint8 *GetData() const { return m_pData != 0 ? m_pData + m_iOffset : 0; }
     amf_size GetSize() const { return m_iSize; }
+    amf_size GetCapacity() const { return m_iMaxSize - m_iOffset; }
+protected:
+    bool Realloc(amf_size num)
+    {
+        // compact in place if at least as much was consumed as has to be moved - keeps memmove amortized
+        if (num <= m_iMaxSize && m_iOffset >= m_iSize)
+        {
+            if (m_iSize > 0)
+            {
+                memmove(m_pData, m_pData + m_iOffset, m_iSize);
+            }
+            m_iOffset = 0;
+            return true;
+        }
+        amf_size newSize = m_iMaxSize * 2;
+        if (newSize < num)
+        {
+            newSize = num;
+        }
+        // This is done to prevent the following error from surfacing
+        // for the pNewData allocation on some compilers:
+        //     -Werror=alloc-size-larger-than=
+        newSize = (newSize + INIT_ARRAY_SIZE - 1) / INIT_ARRAY_SIZE * INIT_ARRAY_SIZE;
+        if (newSize > ARRAY_MAX_SIZE)
+        {
+            return false;
+        }
+        amf_uint8 *pNewData = new amf_uint8[newSize];
+        if (m_pData != NULL)
+        {
+            if (m_iSize > 0)
+            {
+                memcpy(pNewData, m_pData + m_iOffset, m_iSize);
+            }
+            delete[] m_pData;
+        }
+        m_pData = pNewData;
+        m_iOffset = 0;
+        m_iMaxSize = newSize;
+        return true;
+    }
 };
 #endif // AMF_ByteArray_h
\ No newline at end of file
@@ -30,7 +30,8 @@
 // THE SOFTWARE.
 //
 
-#include <iostream>
+#pragma once
+
 #include <vector>
 #include <bitset>
 #include <array>
@@ -50,71 +51,76 @@ class InstructionSet
 
 public:
 	// getters
-	static std::string Vendor(void) { return CPU_Rep.vendor_; }
-	static std::string Brand(void) { return CPU_Rep.brand_; }
-
-	static bool SSE3(void) { return CPU_Rep.f_1_ECX_[0]; }
-	static bool PCLMULQDQ(void) { return CPU_Rep.f_1_ECX_[1]; }
-	static bool MONITOR(void) { return CPU_Rep.f_1_ECX_[3]; }
-	static bool SSSE3(void) { return CPU_Rep.f_1_ECX_[9]; }
-	static bool FMA(void) { return CPU_Rep.f_1_ECX_[12]; }
-	static bool CMPXCHG16B(void) { return CPU_Rep.f_1_ECX_[13]; }
-	static bool SSE41(void) { return CPU_Rep.f_1_ECX_[19]; }
-	static bool SSE42(void) { return CPU_Rep.f_1_ECX_[20]; }
-	static bool MOVBE(void) { return CPU_Rep.f_1_ECX_[22]; }
-	static bool POPCNT(void) { return CPU_Rep.f_1_ECX_[23]; }
-	static bool AES(void) { return CPU_Rep.f_1_ECX_[25]; }
-	static bool XSAVE(void) { return CPU_Rep.f_1_ECX_[26]; }
-	static bool OSXSAVE(void) { return CPU_Rep.f_1_ECX_[27]; }
-	static bool AVX(void) { return CPU_Rep.f_1_ECX_[28]; }
-	static bool F16C(void) { return CPU_Rep.f_1_ECX_[29]; }
-	static bool RDRAND(void) { return CPU_Rep.f_1_ECX_[30]; }
-
-	static bool MSR(void) { return CPU_Rep.f_1_EDX_[5]; }
-	static bool CX8(void) { return CPU_Rep.f_1_EDX_[8]; }
-	static bool SEP(void) { return CPU_Rep.f_1_EDX_[11]; }
-	static bool CMOV(void) { return CPU_Rep.f_1_EDX_[15]; }
-	static bool CLFSH(void) { return CPU_Rep.f_1_EDX_[19]; }
-	static bool MMX(void) { return CPU_Rep.f_1_EDX_[23]; }
-	static bool FXSR(void) { return CPU_Rep.f_1_EDX_[24]; }
-	static bool SSE(void) { return CPU_Rep.f_1_EDX_[25]; }
-	static bool SSE2(void) { return CPU_Rep.f_1_EDX_[26]; }
-
-	static bool FSGSBASE(void) { return CPU_Rep.f_7_EBX_[0]; }
-	static bool BMI1(void) { return CPU_Rep.f_7_EBX_[3]; }
-	static bool HLE(void) { return CPU_Rep.isIntel_ && CPU_Rep.f_7_EBX_[4]; }
-	static bool AVX2(void) { return CPU_Rep.f_7_EBX_[5]; }
-	static bool BMI2(void) { return CPU_Rep.f_7_EBX_[8]; }
-	static bool ERMS(void) { return CPU_Rep.f_7_EBX_[9]; }
-	static bool INVPCID(void) { return CPU_Rep.f_7_EBX_[10]; }
-	static bool RTM(void) { return CPU_Rep.isIntel_ && CPU_Rep.f_7_EBX_[11]; }
-	static bool AVX512F(void) { return CPU_Rep.f_7_EBX_[16]; }
-	static bool RDSEED(void) { return CPU_Rep.f_7_EBX_[18]; }
-	static bool ADX(void) { return CPU_Rep.f_7_EBX_[19]; }
-	static bool AVX512PF(void) { return CPU_Rep.f_7_EBX_[26]; }
-	static bool AVX512ER(void) { return CPU_Rep.f_7_EBX_[27]; }
-	static bool AVX512CD(void) { return CPU_Rep.f_7_EBX_[28]; }
-	static bool SHA(void) { return CPU_Rep.f_7_EBX_[29]; }
-	static bool AVX512BW(void) { return CPU_Rep.f_7_EBX_[30]; }
-	static bool AVX512VL(void) { return CPU_Rep.f_7_EBX_[31]; }
-
-	static bool PREFETCHWT1(void) { return CPU_Rep.f_7_ECX_[0]; }
-
-	static bool LAHF(void) { return CPU_Rep.f_81_ECX_[0]; }
-	static bool LZCNT(void) { return CPU_Rep.isIntel_ && CPU_Rep.f_81_ECX_[5]; }
-	static bool ABM(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_ECX_[5]; }
-	static bool SSE4a(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_ECX_[6]; }
-	static bool XOP(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_ECX_[11]; }
-	static bool TBM(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_ECX_[21]; }
-
-	static bool SYSCALL(void) { return CPU_Rep.isIntel_ && CPU_Rep.f_81_EDX_[11]; }
-	static bool MMXEXT(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[22]; }
-	static bool RDTSCP(void) { return CPU_Rep.isIntel_ && CPU_Rep.f_81_EDX_[27]; }
-	static bool _3DNOWEXT(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[30]; }
-	static bool _3DNOW(void) { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[31]; }
+	static std::string Vendor(void) { return CPU_Rep().vendor_; }
+	static std::string Brand(void) { return CPU_Rep().brand_; }
+
+	static bool SSE3(void) { return CPU_Rep().f_1_ECX_[0]; }
+	static bool PCLMULQDQ(void) { return CPU_Rep().f_1_ECX_[1]; }
+	static bool MONITOR(void) { return CPU_Rep().f_1_ECX_[3]; }
+	static bool SSSE3(void) { return CPU_Rep().f_1_ECX_[9]; }
+	static bool FMA(void) { return CPU_Rep().f_1_ECX_[12]; }
+	static bool CMPXCHG16B(void) { return CPU_Rep().f_1_ECX_[13]; }
+	static bool SSE41(void) { return CPU_Rep().f_1_ECX_[19]; }
+	static bool SSE42(void) { return CPU_Rep().f_1_ECX_[20]; }
+	static bool MOVBE(void) { return CPU_Rep().f_1_ECX_[22]; }
+	static bool POPCNT(void) { return CPU_Rep().f_1_ECX_[23]; }
+	static bool AES(void) { return CPU_Rep().f_1_ECX_[25]; }
+	static bool XSAVE(void) { return CPU_Rep().f_1_ECX_[26]; }
+	static bool OSXSAVE(void) { return CPU_Rep().f_1_ECX_[27]; }
+	static bool AVX(void) { return CPU_Rep().f_1_ECX_[28]; }
+	static bool F16C(void) { return CPU_Rep().f_1_ECX_[29]; }
+	static bool RDRAND(void) { return CPU_Rep().f_1_ECX_[30]; }
+
+	static bool MSR(void) { return CPU_Rep().f_1_EDX_[5]; }
+	static bool CX8(void) { return CPU_Rep().f_1_EDX_[8]; }
+	static bool SEP(void) { return CPU_Rep().f_1_EDX_[11]; }
+	static bool CMOV(void) { return CPU_Rep().f_1_EDX_[15]; }
+	static bool CLFSH(void) { return CPU_Rep().f_1_EDX_[19]; }
+	static bool MMX(void) { return CPU_Rep().f_1_EDX_[23]; }
+	static bool FXSR(void) { return CPU_Rep().f_1_EDX_[24]; }
+	static bool SSE(void) { return CPU_Rep().f_1_EDX_[25]; }
+	static bool SSE2(void) { return CPU_Rep().f_1_EDX_[26]; }
+
+	static bool FSGSBASE(void) { return CPU_Rep().f_7_EBX_[0]; }
+	static bool BMI1(void) { return CPU_Rep().f_7_EBX_[3]; }
+	static bool HLE(void) { return CPU_Rep().isIntel_ && CPU_Rep().f_7_EBX_[4]; }
+	static bool AVX2(void) { return CPU_Rep().f_7_EBX_[5]; }
+	static bool BMI2(void) { return CPU_Rep().f_7_EBX_[8]; }
+	static bool ERMS(void) { return CPU_Rep().f_7_EBX_[9]; }
+	static bool INVPCID(void) { return CPU_Rep().f_7_EBX_[10]; }
+	static bool RTM(void) { return CPU_Rep().isIntel_ && CPU_Rep().f_7_EBX_[11]; }
+	static bool AVX512F(void) { return CPU_Rep().f_7_EBX_[16]; }
+	static bool RDSEED(void) { return CPU_Rep().f_7_EBX_[18]; }
+	static bool ADX(void) { return CPU_Rep().f_7_EBX_[19]; }
+	static bool AVX512PF(void) { return CPU_Rep().f_7_EBX_[26]; }
+	static bool AVX512ER(void) { return CPU_Rep().f_7_EBX_[27]; }
+	static bool AVX512CD(void) { return CPU_Rep().f_7_EBX_[28]; }
+	static bool SHA(void) { return CPU_Rep().f_7_EBX_[29]; }
+	static bool AVX512BW(void) { return CPU_Rep().f_7_EBX_[30]; }
+	static bool AVX512VL(void) { return CPU_Rep().f_7_EBX_[31]; }
+
+	static bool PREFETCHWT1(void) { return CPU_Rep().f_7_ECX_[0]; }
+
+	static bool LAHF(void) { return CPU_Rep().f_81_ECX_[0]; }
+	static bool LZCNT(void) { return CPU_Rep().isIntel_ && CPU_Rep().f_81_ECX_[5]; }
+	static bool ABM(void) { return CPU_Rep().isAMD_ && CPU_Rep().f_81_ECX_[5]; }
+	static bool SSE4a(void) { return CPU_Rep().isAMD_ && CPU_Rep().f_81_ECX_[6]; }
+	static bool XOP(void) { return CPU_Rep().isAMD_ && CPU_Rep().f_81_ECX_[11]; }
+	static bool TBM(void) { return CPU_Rep().isAMD_ && CPU_Rep().f_81_ECX_[21]; }
+
+	static bool SYSCALL(void) { return CPU_Rep().isIntel_ && CPU_Rep().f_81_EDX_[11]; }
+	static bool MMXEXT(void) { return CPU_Rep().isAMD_ && CPU_Rep().f_81_EDX_[22]; }
+	static bool RDTSCP(void) { return CPU_Rep().isIntel_ && CPU_Rep().f_81_EDX_[27]; }
+	static bool _3DNOWEXT(void) { return CPU_Rep().isAMD_ && CPU_Rep().f_81_EDX_[30]; }
+	static bool _3DNOW(void) { return CPU_Rep().isAMD_ && CPU_Rep().f_81_EDX_[31]; }
 
 private:
-	static const InstructionSet_Internal CPU_Rep;
+	// function local so the header can be included from several translation units
+	static const InstructionSet_Internal& CPU_Rep(void)
+	{
+		static const InstructionSet_Internal s_Rep;
+		return s_Rep;
+	}
 
 	class InstructionSet_Internal
 	{
@@ -173,13 +179,13 @@ private:
 			//__cpuid(cpui.data(), 0);
 			GetCpuID(cpui.data(), 0);
 
-			nIds_ = cpui[0];
+			nIds_ = static_cast<unsigned int>(cpui[0]);
 
-			for (int i = 0; i <= nIds_; ++i)
+			for (unsigned int i = 0; i <= nIds_; ++i)
 			{
 				//todo: verify
 				//__cpuidex(cpui.data(), i, 0);
-				GetCpuID(cpui.data(), i, 0);
+				GetCpuID(cpui.data(), static_cast<int32_t>(i), 0);
 
 				data_.push_back(cpui);
 			}
@@ -220,16 +226,16 @@ private:
 			//__cpuid(cpui.data(), 0x80000000);
 			GetCpuID(cpui.data(), 0x80000000);
 
-			nExIds_ = cpui[0];
+			nExIds_ = static_cast<unsigned int>(cpui[0]);
 
 			char brand[0x40];
 			memset(brand, 0, sizeof(brand));
 
-			for (int i = 0x80000000; i <= nExIds_; ++i)
+			for (unsigned int i = 0x80000000; i <= nExIds_; ++i)
 			{
 				//todo: verify
 				//__cpuidex(cpui.data(), i, 0);
-				GetCpuID(cpui.data(), i, 0);
+				GetCpuID(cpui.data(), static_cast<int32_t>(i), 0);
 
 				extdata_.push_back(cpui);
 			}
@@ -257,8 +263,8 @@ private:
 			++i;
 		}
 
-		int nIds_;
-		int nExIds_;
+		unsigned int nIds_;
+		unsigned int nExIds_;
 		std::string vendor_;
 		std::string brand_;
 		bool isIntel_;
@@ -46,7 +46,10 @@ namespace amf
 {
     // currently supports only
     // file://
+    // mmap://              - read only file stream served from a memory mapping, see AMFDataStreamView
     // memory://
+    // memory://chunked     - memory stream backed by fixed size chunks, written data never moves
+    // readahead://<url>    - read only, prefetches <url> on a background thread
 
     // eventually can be extended with:
     // rtsp://
@@ -103,6 +106,21 @@ namespace amf
     //----------------------------------------------------------------------------------------------
     typedef AMFInterfacePtr_T<AMFDataStream> AMFDataStreamPtr;
     //----------------------------------------------------------------------------------------------
+    // AMFDataStreamView interface - zero-copy access for streams backed by memory
+    //----------------------------------------------------------------------------------------------
+    class AMF_NO_VTABLE AMFDataStreamView : public AMFDataStream
+    {
+    public:
+        AMF_DECLARE_IID(0x5c1f7b2e, 0x3d4a, 0x4b8e, 0x9a, 0x61, 0x2f, 0xe4, 0x0b, 0x7d, 0x93, 0xc8)
+
+        // returns pointer to the stream data at iOffset without moving the position
+        // *pViewSize receives number of contiguous bytes available at the pointer, it can be less than iSize
+        // the pointer stays valid until the stream is closed or, for resizable streams, written
+        virtual AMF_RESULT          AMF_STD_CALL GetView(amf_int64 iOffset, amf_size iSize, const void** ppData, amf_size* pViewSize) = 0;
+    };
+    //----------------------------------------------------------------------------------------------
+    typedef AMFInterfacePtr_T<AMFDataStreamView> AMFDataStreamViewPtr;
+    //----------------------------------------------------------------------------------------------
     
 } //namespace amf
 
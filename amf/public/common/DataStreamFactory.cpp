@@ -33,6 +33,7 @@
 #include "DataStream.h"
 #include "DataStreamMemory.h"
 #include "DataStreamFile.h"
+#include "DataStreamReadAhead.h"
 #include "TraceAdapter.h"
 #include <string>
 
@@ -66,6 +67,16 @@ AMF_RESULT AMF_STD_CALL amf::AMFDataStream::OpenDataStream(const wchar_t* pFileU
         ptr = new AMFDataStreamFileImpl;
         res = AMF_OK;
     }
+    if(protocol == L"mmap")
+    {
+        ptr = new AMFDataStreamMappedFileImpl;
+        res = AMF_OK;
+    }
+    if(protocol == L"readahead")
+    {
+        ptr = new AMFDataStreamReadAheadImpl();
+        res = AMF_OK;
+    }
     if(protocol == L"memory")
     {
         ptr = new AMFDataStreamMemoryImpl();
@@ -36,6 +36,9 @@
 #pragma warning(disable: 4996)
 #if defined(_WIN32)
 #include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
 #endif
 
 #include <fcntl.h>
@@ -269,3 +272,208 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamFileImpl::Open(const wchar_t* pFilePath, AM
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+// class AMFDataStreamMappedFileImpl
+//-------------------------------------------------------------------------------------------------
+AMFDataStreamMappedFileImpl::AMFDataStreamMappedFileImpl()
+    : m_pFile(),
+    m_pMapped(NULL),
+    m_uiMappedSize(0),
+    m_pos(0),
+    m_hMapping(NULL)
+{}
+//-------------------------------------------------------------------------------------------------
+AMFDataStreamMappedFileImpl::~AMFDataStreamMappedFileImpl()
+{
+    Close();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Open(const wchar_t* pFilePath, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType)
+{
+    Close();
+
+    m_pFile = new AMFDataStreamFileImpl;
+    AMF_RESULT res = m_pFile->Open(pFilePath, eOpenType, eShareType);
+    if(res != AMF_OK)
+    {
+        m_pFile = NULL;
+        return res;
+    }
+    if(eOpenType == AMFSO_READ && Map() != AMF_OK)
+    {
+        AMFTraceDebug(AMF_FACILITY, L"Open() - %s is not mapped, using file descriptor reads", pFilePath);
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFDataStreamMappedFileImpl::Map()
+{
+    const int fd = m_pFile->GetFileDescriptor();
+#if defined(_WIN32)
+    struct _stat64 st = {};
+    if(_fstat64(fd, &st) != 0 || (st.st_mode & _S_IFREG) == 0 || st.st_size <= 0 || (amf_uint64)st.st_size > (amf_uint64)(amf_size)-1)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+    HANDLE hFile = (HANDLE)_get_osfhandle(fd);
+    HANDLE hMapping = ::CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(hMapping == NULL)
+    {
+        return AMF_FAIL;
+    }
+    void* pMapped = ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if(pMapped == NULL)
+    {
+        ::CloseHandle(hMapping);
+        return AMF_FAIL;
+    }
+    m_hMapping = hMapping;
+#else
+    struct stat st = {};
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || (amf_uint64)st.st_size > (amf_uint64)(amf_size)-1)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+#if defined(__linux)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    void* pMapped = mmap(NULL, (amf_size)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(pMapped == MAP_FAILED)
+    {
+        return AMF_FAIL;
+    }
+    madvise(pMapped, (amf_size)st.st_size, MADV_SEQUENTIAL);
+#endif
+    m_pMapped = (const amf_uint8*)pMapped;
+    m_uiMappedSize = (amf_size)st.st_size;
+    m_pos = 0;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamMappedFileImpl::Unmap()
+{
+    if(m_pMapped != NULL)
+    {
+#if defined(_WIN32)
+        ::UnmapViewOfFile(m_pMapped);
+        ::CloseHandle((HANDLE)m_hMapping);
+        m_hMapping = NULL;
+#else
+        munmap((void*)m_pMapped, m_uiMappedSize);
+#endif
+    }
+    m_pMapped = NULL;
+    m_uiMappedSize = 0;
+    m_pos = 0;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Close()
+{
+    Unmap();
+    AMF_RESULT err = AMF_OK;
+    if(m_pFile != NULL)
+    {
+        err = m_pFile->Close();
+        m_pFile = NULL;
+    }
+    return err;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Read(void* pData, amf_size iSize, amf_size* pRead)
+{
+    AMF_RETURN_IF_FALSE(m_pFile != NULL, AMF_FILE_NOT_OPEN, L"Read() - File not open");
+    if(m_pMapped == NULL)
+    {
+        return m_pFile->Read(pData, iSize, pRead);
+    }
+    amf_size toRead = m_pos < m_uiMappedSize ? AMF_MIN(iSize, m_uiMappedSize - m_pos) : 0;
+    memcpy(pData, m_pMapped + m_pos, toRead);
+    m_pos += toRead;
+    if(pRead != NULL)
+    {
+        *pRead = toRead;
+    }
+    return toRead == 0 ? AMF_EOF : AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Write(const void* pData, amf_size iSize, amf_size* pWritten)
+{
+    AMF_RETURN_IF_FALSE(m_pFile != NULL, AMF_FILE_NOT_OPEN, L"Write() - File not Open");
+    AMF_RETURN_IF_FALSE(m_pMapped == NULL, AMF_ACCESS_DENIED, L"Write() - File is opened for reading");
+    return m_pFile->Write(pData, iSize, pWritten);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::Seek(AMF_SEEK_ORIGIN eOrigin, amf_int64 iPosition, amf_int64* pNewPosition)
+{
+    AMF_RETURN_IF_FALSE(m_pFile != NULL, AMF_FILE_NOT_OPEN, L"Seek() - File not Open");
+    if(m_pMapped == NULL)
+    {
+        return m_pFile->Seek(eOrigin, iPosition, pNewPosition);
+    }
+    amf_int64 new_pos = iPosition;
+    switch(eOrigin)
+    {
+    case AMF_SEEK_BEGIN:
+        break;
+    case AMF_SEEK_CURRENT:
+        new_pos += (amf_int64)m_pos;
+        break;
+    case AMF_SEEK_END:
+        new_pos += (amf_int64)m_uiMappedSize;
+        break;
+    }
+    if(new_pos < 0) // same as lseek: position past the end is allowed, before the start is not
+    {
+        return AMF_FAIL;
+    }
+    m_pos = (amf_size)new_pos;
+    if(pNewPosition != NULL)
+    {
+        *pNewPosition = new_pos;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::GetPosition(amf_int64* pPosition)
+{
+    AMF_RETURN_IF_FALSE(pPosition != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(m_pFile != NULL, AMF_FILE_NOT_OPEN, L"GetPosition() - File not Open");
+    if(m_pMapped == NULL)
+    {
+        return m_pFile->GetPosition(pPosition);
+    }
+    *pPosition = (amf_int64)m_pos;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::GetSize(amf_int64* pSize)
+{
+    AMF_RETURN_IF_FALSE(pSize != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(m_pFile != NULL, AMF_FILE_NOT_OPEN, L"GetSize() - File not open");
+    if(m_pMapped == NULL)
+    {
+        return m_pFile->GetSize(pSize);
+    }
+    *pSize = (amf_int64)m_uiMappedSize;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL AMFDataStreamMappedFileImpl::IsSeekable()
+{
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMappedFileImpl::GetView(amf_int64 iOffset, amf_size iSize, const void** ppData, amf_size* pViewSize)
+{
+    AMF_RETURN_IF_FALSE(ppData != NULL, AMF_INVALID_POINTER, L"GetView() - ppData==NULL");
+    AMF_RETURN_IF_FALSE(pViewSize != NULL, AMF_INVALID_POINTER, L"GetView() - pViewSize==NULL");
+    if(m_pMapped == NULL) // expected for pipes and special files, caller falls back to Read()
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+    AMF_RETURN_IF_FALSE(iOffset >= 0 && (amf_uint64)iOffset <= m_uiMappedSize, AMF_OUT_OF_RANGE, L"GetView() - offset %" LPRId64 L" is out of file size", iOffset);
+
+    *ppData = m_pMapped + (amf_size)iOffset;
+    *pViewSize = AMF_MIN(iSize, m_uiMappedSize - (amf_size)iOffset);
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
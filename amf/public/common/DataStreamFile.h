@@ -59,9 +59,54 @@ namespace amf
         // local
         // aways pass full URL just in case
         virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* pFilePath, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType);
+        int GetFileDescriptor() const { return m_iFileDescriptor; }
     protected:
         int m_iFileDescriptor;
         amf_wstring m_Path;
     };
+    typedef AMFInterfacePtr_T<AMFDataStreamFileImpl> AMFDataStreamFileImplPtr;
+
+    //----------------------------------------------------------------------------------------------
+    // mmap:// - read only file stream served from a memory mapping of the whole file
+    // writing, pipes, non-regular files and failed mappings fall back to the descriptor based stream
+    //----------------------------------------------------------------------------------------------
+    class AMFDataStreamMappedFileImpl : public AMFInterfaceImpl<AMFDataStreamView>
+    {
+    public:
+        AMFDataStreamMappedFileImpl();
+        virtual ~AMFDataStreamMappedFileImpl();
+
+        AMF_BEGIN_INTERFACE_MAP
+            AMF_INTERFACE_ENTRY(AMFDataStream)
+            AMF_INTERFACE_CHAIN_ENTRY(AMFInterfaceImpl<AMFDataStreamView>)
+        AMF_END_INTERFACE_MAP
+
+        // interface
+        virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* pFilePath, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType);
+        virtual AMF_RESULT AMF_STD_CALL Close();
+        virtual AMF_RESULT AMF_STD_CALL Read(void* pData, amf_size iSize, amf_size* pRead);
+        virtual AMF_RESULT AMF_STD_CALL Write(const void* pData, amf_size iSize, amf_size* pWritten);
+        virtual AMF_RESULT AMF_STD_CALL Seek(AMF_SEEK_ORIGIN eOrigin, amf_int64 iPosition, amf_int64* pNewPosition);
+        virtual AMF_RESULT AMF_STD_CALL GetPosition(amf_int64* pPosition);
+        virtual AMF_RESULT AMF_STD_CALL GetSize(amf_int64* pSize);
+        virtual bool       AMF_STD_CALL IsSeekable();
+
+        // AMFDataStreamView interface - fails with AMF_NOT_SUPPORTED when the file could not be mapped
+        virtual AMF_RESULT AMF_STD_CALL GetView(amf_int64 iOffset, amf_size iSize, const void** ppData, amf_size* pViewSize);
+
+        bool IsMapped() const { return m_pMapped != NULL; }
+    protected:
+        AMF_RESULT Map();
+        void Unmap();
+
+        AMFDataStreamFileImplPtr m_pFile;
+        const amf_uint8* m_pMapped;
+        amf_size m_uiMappedSize;
+        amf_size m_pos;
+        amf_handle m_hMapping;  // Windows file mapping object
+    private:
+        AMFDataStreamMappedFileImpl(const AMFDataStreamMappedFileImpl&);
+        AMFDataStreamMappedFileImpl& operator=(const AMFDataStreamMappedFileImpl&);
+    };
 } //namespace amf
 #endif // AMF_DataStreamFile_h
\ No newline at end of file
@@ -38,12 +38,16 @@ using namespace amf;
 
 #define AMF_FACILITY    L"AMFDataStreamMemoryImpl"
 
+#define AMF_DATA_STREAM_MEMORY_MIN_ALLOC (64 * 1024)
+
 //-------------------------------------------------------------------------------------------------
-AMFDataStreamMemoryImpl::AMFDataStreamMemoryImpl()
+AMFDataStreamMemoryImpl::AMFDataStreamMemoryImpl(amf_size uiChunkSize)
     : m_pMemory(NULL),
     m_uiMemorySize(0),
     m_uiAllocatedSize(0),
-    m_pos(0)
+    m_pos(0),
+    m_uiChunkSize(uiChunkSize),
+    m_Chunks()
 {}
 //-------------------------------------------------------------------------------------------------
 AMFDataStreamMemoryImpl::~AMFDataStreamMemoryImpl()
@@ -53,12 +57,30 @@ AMFDataStreamMemoryImpl::~AMFDataStreamMemoryImpl()
 //-------------------------------------------------------------------------------------------------
 // interface
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Open(const wchar_t* pFileUrl, AMF_STREAM_OPEN /*eOpenType*/, AMF_FILE_SHARE /*eShareType*/)
+{
+    if(pFileUrl != NULL && wcscmp(pFileUrl, L"chunked") == 0)
+    {
+        AMF_RETURN_IF_FALSE(m_uiMemorySize == 0, AMF_ALREADY_INITIALIZED, L"Open() - chunked mode must be selected before writing");
+        if(m_uiChunkSize == 0)
+        {
+            m_uiChunkSize = AMF_DATA_STREAM_MEMORY_CHUNK_SIZE;
+        }
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Close()
 {
     if(m_pMemory != NULL)
     {
         amf_virtual_free(m_pMemory);
     }
+    for(amf_size i = 0; i < m_Chunks.size(); i++)
+    {
+        amf_virtual_free(m_Chunks[i]);
+    }
+    m_Chunks.clear();
     m_pMemory = NULL,
     m_uiMemorySize = 0,
     m_uiAllocatedSize = 0,
@@ -68,21 +90,44 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Close()
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT AMFDataStreamMemoryImpl::Realloc(amf_size iSize)
 {
-    if(iSize > m_uiMemorySize)
+    if(iSize > m_uiAllocatedSize)
     {
-        amf_uint8* pNewMemory = (amf_uint8*)amf_virtual_alloc(iSize);
-        if(pNewMemory == NULL)
+        if(m_uiChunkSize != 0)
         {
-            return AMF_OUT_OF_MEMORY;
+            // chunked: add chunks, already written data stays in place
+            while(m_uiAllocatedSize < iSize)
+            {
+                amf_uint8* pChunk = (amf_uint8*)amf_virtual_alloc(m_uiChunkSize);
+                if(pChunk == NULL)
+                {
+                    return AMF_OUT_OF_MEMORY;
+                }
+                m_Chunks.push_back(pChunk);
+                m_uiAllocatedSize += m_uiChunkSize;
+            }
         }
-        m_uiAllocatedSize = iSize;
-        if(m_pMemory != NULL)
+        else
         {
-            memcpy(pNewMemory, m_pMemory, m_uiMemorySize);
-            amf_virtual_free(m_pMemory);
-        }
+            // grow geometrically so a sequence of small writes costs amortized O(1) per byte
+            amf_size newAllocated = AMF_MAX(m_uiAllocatedSize * 2, (amf_size)AMF_DATA_STREAM_MEMORY_MIN_ALLOC);
+            if(newAllocated < iSize)
+            {
+                newAllocated = iSize;
+            }
+            amf_uint8* pNewMemory = (amf_uint8*)amf_virtual_alloc(newAllocated);
+            if(pNewMemory == NULL)
+            {
+                return AMF_OUT_OF_MEMORY;
+            }
+            m_uiAllocatedSize = newAllocated;
+            if(m_pMemory != NULL)
+            {
+                memcpy(pNewMemory, m_pMemory, m_uiMemorySize);
+                amf_virtual_free(m_pMemory);
+            }
 
-        m_pMemory = pNewMemory;
+            m_pMemory = pNewMemory;
+        }
     }
     m_uiMemorySize = iSize;
     if(m_pos > m_uiMemorySize)
@@ -92,13 +137,51 @@ AMF_RESULT AMFDataStreamMemoryImpl::Realloc(amf_size iSize)
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+void AMFDataStreamMemoryImpl::CopyFrom(amf_size pos, void* pData, amf_size iSize) const
+{
+    if(m_uiChunkSize == 0)
+    {
+        memcpy(pData, m_pMemory + pos, iSize);
+        return;
+    }
+    amf_uint8* pDst = (amf_uint8*)pData;
+    while(iSize > 0)
+    {
+        amf_size offset = pos % m_uiChunkSize;
+        amf_size toCopy = AMF_MIN(iSize, m_uiChunkSize - offset);
+        memcpy(pDst, m_Chunks[pos / m_uiChunkSize] + offset, toCopy);
+        pDst += toCopy;
+        pos += toCopy;
+        iSize -= toCopy;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamMemoryImpl::CopyTo(amf_size pos, const void* pData, amf_size iSize)
+{
+    if(m_uiChunkSize == 0)
+    {
+        memcpy(m_pMemory + pos, pData, iSize);
+        return;
+    }
+    const amf_uint8* pSrc = (const amf_uint8*)pData;
+    while(iSize > 0)
+    {
+        amf_size offset = pos % m_uiChunkSize;
+        amf_size toCopy = AMF_MIN(iSize, m_uiChunkSize - offset);
+        memcpy(m_Chunks[pos / m_uiChunkSize] + offset, pSrc, toCopy);
+        pSrc += toCopy;
+        pos += toCopy;
+        iSize -= toCopy;
+    }
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Read(void* pData, amf_size iSize, amf_size* pRead)
 {
     AMF_RETURN_IF_FALSE(pData != NULL, AMF_INVALID_POINTER, L"Read() - pData==NULL");
-    AMF_RETURN_IF_FALSE(m_pMemory != NULL, AMF_NOT_INITIALIZED, L"Read() - Stream is not allocated");
+    AMF_RETURN_IF_FALSE(m_pMemory != NULL || !m_Chunks.empty(), AMF_NOT_INITIALIZED, L"Read() - Stream is not allocated");
 
     amf_size toRead = AMF_MIN(iSize, m_uiMemorySize - m_pos);
-    memcpy(pData, m_pMemory + m_pos, toRead);
+    CopyFrom(m_pos, pData, toRead);
     m_pos += toRead;
     if(pRead != NULL)
     {
@@ -110,10 +193,13 @@ AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Read(void* pData, amf_size iSiz
 AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::Write(const void* pData, amf_size iSize, amf_size* pWritten)
 {
     AMF_RETURN_IF_FALSE(pData != NULL, AMF_INVALID_POINTER, L"Write() - pData==NULL");
-    AMF_RETURN_IF_FAILED(Realloc(m_pos + iSize), L"Write() - Stream is not allocated");
+    if(m_pos + iSize > m_uiMemorySize)
+    {
+        AMF_RETURN_IF_FAILED(Realloc(m_pos + iSize), L"Write() - Stream is not allocated");
+    }
 
     amf_size toWrite = AMF_MIN(iSize, m_uiMemorySize - m_pos);
-    memcpy(m_pMemory + m_pos, pData, toWrite);
+    CopyTo(m_pos, pData, toWrite);
     m_pos += toWrite;
     if(pWritten != NULL)
     {
@@ -169,6 +255,32 @@ bool AMF_STD_CALL AMFDataStreamMemoryImpl::IsSeekable()
     return true;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamMemoryImpl::GetView(amf_int64 iOffset, amf_size iSize, const void** ppData, amf_size* pViewSize)
+{
+    AMF_RETURN_IF_FALSE(ppData != NULL, AMF_INVALID_POINTER, L"GetView() - ppData==NULL");
+    AMF_RETURN_IF_FALSE(pViewSize != NULL, AMF_INVALID_POINTER, L"GetView() - pViewSize==NULL");
+    AMF_RETURN_IF_FALSE(iOffset >= 0 && (amf_size)iOffset <= m_uiMemorySize, AMF_OUT_OF_RANGE, L"GetView() - offset %" LPRId64 L" is out of stream size", iOffset);
+
+    amf_size pos = (amf_size)iOffset;
+    amf_size available = AMF_MIN(iSize, m_uiMemorySize - pos);
+    if(m_uiChunkSize == 0)
+    {
+        *ppData = m_pMemory + pos;
+    }
+    else if(available == 0)
+    {
+        *ppData = NULL;
+    }
+    else
+    {
+        amf_size offset = pos % m_uiChunkSize;
+        *ppData = m_Chunks[pos / m_uiChunkSize] + offset;
+        available = AMF_MIN(available, m_uiChunkSize - offset);
+    }
+    *pViewSize = available;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
@@ -37,22 +37,26 @@
 
 #include "DataStream.h"
 #include "InterfaceImpl.h"
+#include "AMFSTL.h"
 
 namespace amf
 {
-    class AMFDataStreamMemoryImpl : public AMFInterfaceImpl<AMFDataStream>
+    #define AMF_DATA_STREAM_MEMORY_CHUNK_SIZE   (1024 * 1024)
+
+    class AMFDataStreamMemoryImpl : public AMFInterfaceImpl<AMFDataStreamView>
     {
     public:
-        AMFDataStreamMemoryImpl();
+        // uiChunkSize != 0 - chunked backing: storage grows by chunks, written data is never moved
+        AMFDataStreamMemoryImpl(amf_size uiChunkSize = 0);
         virtual ~AMFDataStreamMemoryImpl();
+
+        AMF_BEGIN_INTERFACE_MAP
+            AMF_INTERFACE_ENTRY(AMFDataStream)
+            AMF_INTERFACE_CHAIN_ENTRY(AMFInterfaceImpl<AMFDataStreamView>)
+        AMF_END_INTERFACE_MAP
+
         // interface
-        virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* /*pFileUrl*/, AMF_STREAM_OPEN /*eOpenType*/, AMF_FILE_SHARE /*eShareType*/)
-        {
-            //pFileUrl;
-            //eOpenType;
-            //eShareType;
-            return AMF_OK;
-        }
+        virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* pFileUrl, AMF_STREAM_OPEN /*eOpenType*/, AMF_FILE_SHARE /*eShareType*/);
         virtual AMF_RESULT AMF_STD_CALL Close();
         virtual AMF_RESULT AMF_STD_CALL Read(void* pData, amf_size iSize, amf_size* pRead);
         virtual AMF_RESULT AMF_STD_CALL Write(const void* pData, amf_size iSize, amf_size* pWritten);
@@ -61,13 +65,20 @@ namespace amf
         virtual AMF_RESULT AMF_STD_CALL GetSize(amf_int64* pSize);
         virtual bool       AMF_STD_CALL IsSeekable();
 
+        // AMFDataStreamView interface
+        virtual AMF_RESULT AMF_STD_CALL GetView(amf_int64 iOffset, amf_size iSize, const void** ppData, amf_size* pViewSize);
+
     protected:
         AMF_RESULT Realloc(amf_size iSize);
+        void CopyFrom(amf_size pos, void* pData, amf_size iSize) const;
+        void CopyTo(amf_size pos, const void* pData, amf_size iSize);
 
         amf_uint8* m_pMemory;
         amf_size m_uiMemorySize;
         amf_size m_uiAllocatedSize;
         amf_size m_pos;
+        amf_size m_uiChunkSize;
+        amf_vector<amf_uint8*> m_Chunks;
     private:
         AMFDataStreamMemoryImpl(const AMFDataStreamMemoryImpl&);
         AMFDataStreamMemoryImpl& operator=(const AMFDataStreamMemoryImpl&);
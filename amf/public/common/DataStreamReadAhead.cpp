@@ -0,0 +1,386 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "TraceAdapter.h"
+#include "DataStreamReadAhead.h"
+#include <string.h>
+
+using namespace amf;
+
+#define AMF_FACILITY    L"AMFDataStreamReadAheadImpl"
+
+//-------------------------------------------------------------------------------------------------
+AMFDataStreamReadAheadImpl::AMFDataStreamReadAheadImpl(amf_size uiDepth, amf_size uiBufferSize) :
+    m_DataEvent(false, false),
+    m_SpaceEvent(false, false),
+    m_uiDepth(AMF_DATA_STREAM_READ_AHEAD_DEPTH),
+    m_uiBufferSize(AMF_DATA_STREAM_READ_AHEAD_BUFFER_SIZE),
+    m_iHead(0),
+    m_iReady(0),
+    m_uiHeadOffset(0),
+    m_iPosition(0),
+    m_iFetchPos(0),
+    m_iStreamPos(0),
+    m_uiGeneration(0),
+    m_bFetchDone(false),
+    m_iStallCount(0),
+    m_iStallTime(0)
+{
+    SetReadAhead(uiDepth, uiBufferSize);
+}
+//-------------------------------------------------------------------------------------------------
+AMFDataStreamReadAheadImpl::~AMFDataStreamReadAheadImpl()
+{
+    Close();
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamReadAheadImpl::SetReadAhead(amf_size uiDepth, amf_size uiBufferSize)
+{
+    m_uiDepth = uiDepth > 1 ? uiDepth : 2; // at least one buffer for the consumer and one in flight
+    m_uiBufferSize = uiBufferSize > 0 ? uiBufferSize : AMF_DATA_STREAM_READ_AHEAD_BUFFER_SIZE;
+    // keep the buffers a multiple of the alignment so the wrapped stream sees aligned offsets
+    m_uiBufferSize = (m_uiBufferSize + AMF_DATA_STREAM_READ_AHEAD_ALIGNMENT - 1) & ~amf_size(AMF_DATA_STREAM_READ_AHEAD_ALIGNMENT - 1);
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamReadAheadImpl::ResetStatistics()
+{
+    AMFLock lock(&m_sync);
+    m_iStallCount = 0;
+    m_iStallTime = 0;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamReadAheadImpl::Open(const wchar_t* pFileUrl, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType)
+{
+    AMF_RETURN_IF_FALSE(pFileUrl != NULL, AMF_INVALID_ARG);
+    AMF_RETURN_IF_FALSE(eOpenType == AMFSO_READ, AMF_NOT_SUPPORTED, L"Open() - read ahead streams are read only");
+
+    AMFDataStreamPtr pStream;
+    AMF_RESULT res = AMFDataStream::OpenDataStream(pFileUrl, eOpenType, eShareType, &pStream);
+    AMF_RETURN_IF_FAILED(res, L"Open() - failed to open %s", pFileUrl);
+    return Attach(pStream);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFDataStreamReadAheadImpl::Attach(AMFDataStream* pStream)
+{
+    AMF_RETURN_IF_FALSE(pStream != NULL, AMF_INVALID_ARG);
+    Close();
+
+    amf_int64 iPosition = 0;
+    AMF_RETURN_IF_FAILED(pStream->GetPosition(&iPosition));
+
+    bool bAllocated = true;
+    m_Buffers.resize(m_uiDepth);
+    for(amf_size i = 0; i < m_Buffers.size(); i++)
+    {
+        Buffer& buffer = m_Buffers[i];
+        buffer.pData = (amf_uint8*)amf_aligned_alloc(m_uiBufferSize, AMF_DATA_STREAM_READ_AHEAD_ALIGNMENT);
+        buffer.iOffset = 0;
+        buffer.uiFilled = 0;
+        buffer.res = AMF_OK;
+        bAllocated = bAllocated && buffer.pData != NULL;
+    }
+    if(!bAllocated)
+    {
+        ReleaseBuffers();
+    }
+    AMF_RETURN_IF_FALSE(bAllocated, AMF_OUT_OF_MEMORY, L"Attach() - failed to allocate %d buffers of %d bytes", (int)m_uiDepth, (int)m_uiBufferSize);
+
+    m_pStream = pStream;
+    m_iStreamPos = iPosition;
+    return StartPrefetch(iPosition);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamReadAheadImpl::Close()
+{
+    StopPrefetch();
+    if(m_pStream != NULL && m_iStallCount > 0)
+    {
+        AMFTraceDebug(AMF_FACILITY, L"Close() - %" LPRId64 L" stalls, %" LPRId64 L" ms waiting for data", m_iStallCount, m_iStallTime / AMF_MILLISECOND);
+    }
+    m_pStream = NULL;
+    ReleaseBuffers();
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamReadAheadImpl::ReleaseBuffers()
+{
+    for(amf_size i = 0; i < m_Buffers.size(); i++)
+    {
+        if(m_Buffers[i].pData != NULL)
+        {
+            amf_aligned_free(m_Buffers[i].pData);
+        }
+    }
+    m_Buffers.clear();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFDataStreamReadAheadImpl::StartPrefetch(amf_int64 iPosition)
+{
+    {
+        AMFLock lock(&m_sync);
+        m_iPosition = iPosition;
+        Invalidate(iPosition);
+    }
+    AMF_RETURN_IF_FALSE(AMFThread::Start(), AMF_FAIL, L"StartPrefetch() - failed to start thread");
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamReadAheadImpl::StopPrefetch()
+{
+    if(IsRunning())
+    {
+        RequestStop();
+        m_SpaceEvent.SetEvent();
+        WaitForStop();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamReadAheadImpl::Invalidate(amf_int64 iPosition)
+{
+    m_uiGeneration++;
+    m_iHead = (m_iHead + m_iReady) % (m_Buffers.size() > 0 ? m_Buffers.size() : 1);
+    m_iReady = 0;
+    m_uiHeadOffset = 0;
+    m_iFetchPos = iPosition;
+    m_bFetchDone = false;
+    m_SpaceEvent.SetEvent();
+}
+//-------------------------------------------------------------------------------------------------
+void AMFDataStreamReadAheadImpl::Run()
+{
+    amf_int64 iStreamPos = m_iStreamPos;
+    while(!StopRequested())
+    {
+        amf_size    iSlot = 0;
+        amf_int64   iFetchPos = 0;
+        amf_uint32  uiGeneration = 0;
+        {
+            AMFLock lock(&m_sync);
+            if(m_bFetchDone || m_iReady == m_Buffers.size())
+            {
+                lock.Unlock();
+                m_SpaceEvent.Lock();
+                continue;
+            }
+            iSlot = (m_iHead + m_iReady) % m_Buffers.size();
+            iFetchPos = m_iFetchPos;
+            uiGeneration = m_uiGeneration;
+        }
+        // the slot is not visible to the consumer until committed, fill it without holding m_sync
+        Buffer& buffer = m_Buffers[iSlot];
+        amf_size uiRead = 0;
+        AMF_RESULT res = AMF_OK;
+        {
+            AMFLock lock(&m_StreamSync);
+            if(iStreamPos != iFetchPos)
+            {
+                res = m_pStream->Seek(AMF_SEEK_BEGIN, iFetchPos, &iStreamPos);
+            }
+            if(res == AMF_OK)
+            {
+                res = m_pStream->Read(buffer.pData, m_uiBufferSize, &uiRead);
+                iStreamPos = iFetchPos + uiRead;
+            }
+            else
+            {
+                iStreamPos = -1;
+            }
+        }
+        if(res == AMF_OK && uiRead == 0)
+        {
+            res = AMF_EOF;
+        }
+
+        AMFLock lock(&m_sync);
+        if(uiGeneration != m_uiGeneration)
+        {
+            continue; // Seek happened while reading, drop the data
+        }
+        buffer.iOffset = iFetchPos;
+        buffer.uiFilled = uiRead;
+        buffer.res = res;
+        m_iFetchPos += uiRead;
+        m_iReady++;
+        m_bFetchDone = res != AMF_OK;
+        m_DataEvent.SetEvent();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamReadAheadImpl::Read(void* pData, amf_size iSize, amf_size* pRead)
+{
+    AMF_RETURN_IF_FALSE(m_pStream != NULL, AMF_FILE_NOT_OPEN, L"Read() - stream not open");
+    AMF_RETURN_IF_FALSE(pData != NULL || iSize == 0, AMF_INVALID_POINTER);
+
+    amf_uint8* pDst = static_cast<amf_uint8*>(pData);
+    amf_size uiDone = 0;
+    AMF_RESULT res = AMF_OK;
+
+    AMFLock lock(&m_sync);
+    while(uiDone < iSize)
+    {
+        if(m_iReady == 0)
+        {
+            m_iStallCount++;
+            amf_pts start = amf_high_precision_clock();
+            while(m_iReady == 0)
+            {
+                lock.Unlock();
+                m_DataEvent.Lock();
+                lock.Lock();
+            }
+            m_iStallTime += amf_high_precision_clock() - start;
+        }
+        Buffer& buffer = m_Buffers[m_iHead];
+        amf_size uiAvailable = buffer.uiFilled - m_uiHeadOffset;
+        if(uiAvailable == 0)
+        {
+            if(buffer.res != AMF_OK)
+            {
+                // leave the terminating buffer queued so the next Read() reports the same result
+                res = buffer.res;
+                break;
+            }
+            m_iHead = (m_iHead + 1) % m_Buffers.size();
+            m_iReady--;
+            m_uiHeadOffset = 0;
+            m_SpaceEvent.SetEvent();
+            continue;
+        }
+        amf_size uiCopy = AMF_MIN(uiAvailable, iSize - uiDone);
+        // ready buffers are not touched by the prefetch thread, copy outside of the lock
+        lock.Unlock();
+        memcpy(pDst + uiDone, buffer.pData + m_uiHeadOffset, uiCopy);
+        lock.Lock();
+        uiDone += uiCopy;
+        m_uiHeadOffset += uiCopy;
+        m_iPosition += uiCopy;
+    }
+    if(pRead != NULL)
+    {
+        *pRead = uiDone;
+    }
+    if(uiDone > 0 && res == AMF_EOF)
+    {
+        res = AMF_OK;
+    }
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamReadAheadImpl::Write(const void* /*pData*/, amf_size /*iSize*/, amf_size* /*pWritten*/)
+{
+    return AMF_ACCESS_DENIED;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamReadAheadImpl::Seek(AMF_SEEK_ORIGIN eOrigin, amf_int64 iPosition, amf_int64* pNewPosition)
+{
+    AMF_RETURN_IF_FALSE(m_pStream != NULL, AMF_FILE_NOT_OPEN, L"Seek() - stream not open");
+
+    amf_int64 iNewPosition = 0;
+    switch(eOrigin)
+    {
+    case AMF_SEEK_BEGIN:
+        iNewPosition = iPosition;
+        break;
+    case AMF_SEEK_CURRENT:
+        {
+            AMFLock lock(&m_sync);
+            iNewPosition = m_iPosition + iPosition;
+        }
+        break;
+    case AMF_SEEK_END:
+        {
+            amf_int64 iSize = 0;
+            AMF_RETURN_IF_FAILED(GetSize(&iSize));
+            iNewPosition = iSize + iPosition;
+        }
+        break;
+    default:
+        return AMF_INVALID_ARG;
+    }
+    AMF_RETURN_IF_FALSE(iNewPosition >= 0, AMF_INVALID_ARG, L"Seek() - negative position");
+
+    AMFLock lock(&m_sync);
+    // inside the ready buffers - drop only what is before the new position
+    amf_size iSlot = m_iHead;
+    bool bFound = false;
+    for(amf_size i = 0; i < m_iReady; i++, iSlot = (iSlot + 1) % m_Buffers.size())
+    {
+        const Buffer& buffer = m_Buffers[iSlot];
+        if(iNewPosition >= buffer.iOffset && iNewPosition < buffer.iOffset + (amf_int64)buffer.uiFilled)
+        {
+            m_iReady -= i;
+            m_iHead = iSlot;
+            m_uiHeadOffset = amf_size(iNewPosition - buffer.iOffset);
+            bFound = true;
+            if(i > 0)
+            {
+                m_SpaceEvent.SetEvent();
+            }
+            break;
+        }
+    }
+    if(!bFound && iNewPosition != m_iPosition)
+    {
+        AMF_RETURN_IF_FALSE(m_pStream->IsSeekable(), AMF_NOT_SUPPORTED, L"Seek() - stream is not seekable");
+        Invalidate(iNewPosition);
+    }
+    m_iPosition = iNewPosition;
+    if(pNewPosition != NULL)
+    {
+        *pNewPosition = iNewPosition;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamReadAheadImpl::GetPosition(amf_int64* pPosition)
+{
+    AMF_RETURN_IF_FALSE(pPosition != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(m_pStream != NULL, AMF_FILE_NOT_OPEN, L"GetPosition() - stream not open");
+    AMFLock lock(&m_sync);
+    *pPosition = m_iPosition;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFDataStreamReadAheadImpl::GetSize(amf_int64* pSize)
+{
+    AMF_RETURN_IF_FALSE(pSize != NULL, AMF_INVALID_POINTER);
+    AMF_RETURN_IF_FALSE(m_pStream != NULL, AMF_FILE_NOT_OPEN, L"GetSize() - stream not open");
+    // file streams move the descriptor position to query the size, serialize with the prefetch
+    AMFLock lock(&m_StreamSync);
+    return m_pStream->GetSize(pSize);
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL AMFDataStreamReadAheadImpl::IsSeekable()
+{
+    return m_pStream != NULL ? m_pStream->IsSeekable() : false;
+}
+//-------------------------------------------------------------------------------------------------
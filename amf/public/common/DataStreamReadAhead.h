@@ -0,0 +1,123 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifndef AMF_DataStreamReadAhead_h
+#define AMF_DataStreamReadAhead_h
+
+#pragma once
+
+#include "DataStream.h"
+#include "InterfaceImpl.h"
+#include "Thread.h"
+#include "AMFSTL.h"
+
+namespace amf
+{
+    #define AMF_DATA_STREAM_READ_AHEAD_DEPTH        4
+    #define AMF_DATA_STREAM_READ_AHEAD_BUFFER_SIZE  (1024 * 1024)
+    #define AMF_DATA_STREAM_READ_AHEAD_ALIGNMENT    4096
+
+    //----------------------------------------------------------------------------------------------
+    // readahead://<url> - read only decorator that prefetches the wrapped stream on a background
+    // thread into a ring of aligned buffers, so I/O overlaps with the consumer's processing.
+    // Seek inside the buffered range reuses the data, any other Seek drops the prefetched buffers.
+    //----------------------------------------------------------------------------------------------
+    class AMFDataStreamReadAheadImpl : public AMFInterfaceImpl<AMFDataStream>, protected AMFThread
+    {
+    public:
+        AMFDataStreamReadAheadImpl(amf_size uiDepth = AMF_DATA_STREAM_READ_AHEAD_DEPTH, amf_size uiBufferSize = AMF_DATA_STREAM_READ_AHEAD_BUFFER_SIZE);
+        virtual ~AMFDataStreamReadAheadImpl();
+
+        // interface
+        virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* pFileUrl, AMF_STREAM_OPEN eOpenType, AMF_FILE_SHARE eShareType);
+        virtual AMF_RESULT AMF_STD_CALL Close();
+        virtual AMF_RESULT AMF_STD_CALL Read(void* pData, amf_size iSize, amf_size* pRead);
+        virtual AMF_RESULT AMF_STD_CALL Write(const void* pData, amf_size iSize, amf_size* pWritten);
+        virtual AMF_RESULT AMF_STD_CALL Seek(AMF_SEEK_ORIGIN eOrigin, amf_int64 iPosition, amf_int64* pNewPosition);
+        virtual AMF_RESULT AMF_STD_CALL GetPosition(amf_int64* pPosition);
+        virtual AMF_RESULT AMF_STD_CALL GetSize(amf_int64* pSize);
+        virtual bool       AMF_STD_CALL IsSeekable();
+
+        // local
+        // wraps an already opened stream, reading starts from its current position
+        AMF_RESULT Attach(AMFDataStream* pStream);
+        // takes effect on the next Open() / Attach()
+        void SetReadAhead(amf_size uiDepth, amf_size uiBufferSize);
+
+        // number of Read() calls that had to wait for the prefetch thread
+        amf_int64 GetStallCount() const { return m_iStallCount; }
+        amf_pts GetStallTime() const { return m_iStallTime; }
+        void ResetStatistics();
+
+    protected:
+        struct Buffer
+        {
+            amf_uint8*  pData;
+            amf_int64   iOffset;    // stream position of pData[0]
+            amf_size    uiFilled;
+            AMF_RESULT  res;        // AMF_EOF or error terminate the prefetch until the next Seek
+        };
+
+        // AMFThread
+        virtual void Run();
+
+        AMF_RESULT StartPrefetch(amf_int64 iPosition);
+        void StopPrefetch();
+        void ReleaseBuffers();
+        void Invalidate(amf_int64 iPosition);    // must be called under m_sync
+
+        AMFDataStreamPtr        m_pStream;
+        AMFCriticalSection      m_StreamSync;   // guards m_pStream
+        AMFCriticalSection      m_sync;         // guards the ring state below
+        AMFEvent                m_DataEvent;    // buffer filled
+        AMFEvent                m_SpaceEvent;   // buffer released or prefetch restarted
+
+        amf_vector<Buffer>      m_Buffers;
+        amf_size                m_uiDepth;
+        amf_size                m_uiBufferSize;
+        amf_size                m_iHead;        // oldest ready buffer
+        amf_size                m_iReady;       // number of ready buffers starting at m_iHead
+        amf_size                m_uiHeadOffset; // consumed bytes in the head buffer
+        amf_int64               m_iPosition;    // consumer position
+        amf_int64               m_iFetchPos;    // position of the next prefetch
+        amf_int64               m_iStreamPos;   // wrapped stream position when the prefetch starts
+        amf_uint32              m_uiGeneration; // bumped by Seek to drop reads in flight
+        bool                    m_bFetchDone;   // EOF or error queued, prefetch idle
+
+        amf_int64               m_iStallCount;
+        amf_pts                 m_iStallTime;
+    private:
+        AMFDataStreamReadAheadImpl(const AMFDataStreamReadAheadImpl&);
+        AMFDataStreamReadAheadImpl& operator=(const AMFDataStreamReadAheadImpl&);
+    };
+} //namespace amf
+#endif // AMF_DataStreamReadAhead_h
@@ -36,6 +36,7 @@
 #include "public/include/core/Interface.h"
 #include "public/include/core/Variant.h"
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 namespace amf
@@ -55,7 +56,8 @@ namespace amf
             UNEXPECTED_END,
             DUPLICATE_NAME,
             INVALID_ARG,
-            INVALID_VALUE
+            INVALID_VALUE,
+            ABORTED             // a streaming Handler returned false
         };
         //-----------------------------------------------------------------------------------------
         typedef amf::AMFInterfacePtr_T<JSONParser>  Ptr;
@@ -93,6 +95,30 @@ namespace amf
             uint8_t nOffsetSize;
         };
         //-----------------------------------------------------------------------------------------
+        // non-owning view into the parsed buffer; strings are not unescaped, same as the DOM
+        struct StringView
+        {
+            const char* pData;
+            size_t      nLength;
+        };
+        //-----------------------------------------------------------------------------------------
+        // event sink for JSONParser2::ParseStream(); return false from any callback to stop parsing
+        class Handler
+        {
+        public:
+            virtual bool OnStartObject() = 0;
+            virtual bool OnKey(const StringView& name) = 0;
+            virtual bool OnEndObject() = 0;
+            virtual bool OnStartArray() = 0;
+            virtual bool OnEndArray() = 0;
+            virtual bool OnString(const StringView& val) = 0;
+            virtual bool OnNumber(const StringView& val) = 0;   // raw token text
+            virtual bool OnBool(bool val) = 0;
+            virtual bool OnNull() = 0;
+        protected:
+            virtual ~Handler() {}
+        };
+        //-----------------------------------------------------------------------------------------
         class Element : public amf::AMFInterface
         {
         public:
@@ -167,6 +193,66 @@ namespace amf
         virtual size_t GetLastErrorOffset() const = 0;  //  Returns the offset of the last syntax error (same as what is passed in the exception if thrown)
     };
 
+    //---------------------------------------------------------------------------------------------
+    // Extended parser, obtained from a JSONParser through QueryInterface(). Kept separate so that
+    // the JSONParser and Element layouts stay compatible with binaries built against older headers.
+    class JSONParser2 : public JSONParser
+    {
+    public:
+        typedef amf::AMFInterfacePtr_T<JSONParser2>  Ptr;
+        AMF_DECLARE_IID(0x5b1c3e02, 0x7d94, 0x4f6a, 0xa1, 0x3e, 0x62, 0x0b, 0xd8, 0x4c, 0x97, 0x15)
+
+        virtual void StringifyTo(const Node* root, const OutputFormatDesc& format, std::string& out, int indent = 0) const = 0;  //  Append a DOM to an existing string
+
+        virtual Result ParseStream(const char* str, size_t length, Handler* handler) = 0;  //  Parse without building a DOM, str is not copied
+        virtual Result ParseArena(const char* str, size_t length, Node** root) = 0;  //  Parse into a DOM allocated from one arena; elements reference a single copy of str
+    };
+
+    //---------------------------------------------------------------------------------------------
+    // Streaming writer: appends JSON to one string as events arrive, formatted the same way
+    // as StringifyFormatted(). Can be passed to JSONParser2::ParseStream() to re-format without a DOM.
+    class JSONWriter : public JSONParser::Handler
+    {
+    public:
+        JSONWriter(std::string& out, const JSONParser::OutputFormatDesc* format = nullptr, int indent = 0);
+        virtual ~JSONWriter() {}
+
+        virtual bool OnStartObject();
+        virtual bool OnKey(const JSONParser::StringView& name);
+        virtual bool OnEndObject();
+        virtual bool OnStartArray();
+        virtual bool OnEndArray();
+        virtual bool OnString(const JSONParser::StringView& val);
+        virtual bool OnNumber(const JSONParser::StringView& val);
+        virtual bool OnBool(bool val);
+        virtual bool OnNull();
+
+        void WriteKey(const char* name);
+        void WriteString(const char* val);
+        void WriteInt64(int64_t val);
+        void WriteUInt64(uint64_t val);
+        void WriteDouble(double val);
+
+    private:
+        struct Level
+        {
+            bool    bObject;
+            bool    bFirst;
+            bool    bNewLineBeforeClose;
+            int     nIndent;
+        };
+
+        void BeginValue(bool container, bool object);
+        void BeginContainer(bool object);
+        void EndContainer();
+        void InsertTabs(int count);
+
+        std::string&                    m_Out;
+        JSONParser::OutputFormatDesc    m_Format;
+        std::vector<Level>              m_Levels;
+        int                             m_Indent;
+    };
+
     extern "C"
     {
         // Helpers
@@ -33,15 +33,53 @@
 
 
 #include "JsonImpl.h"
+#include "AMFSTL.h"
 #include <stdio.h>
 #include <cstdlib>
 #include <sstream>
 #include <inttypes.h>
+#include <string.h>
+#include <algorithm>
 
 #pragma warning(disable: 4996)
 
 static amf::JSONParser::OutputFormatDesc defaultFormat = {};
 
+static const char* const NULL_STR = "null";
+static const char* const TRUE_STR = "true";
+static const char* const FALSE_STR = "false";
+
+//-------------------------------------------------------------------------------------------------
+// prints val the way ValueImpl::SetValueAsDouble always has: %.16lf with trailing zeroes trimmed
+static size_t FormatDouble(double val, char* buf, size_t size, bool& isNull)
+{
+    int printed = snprintf(buf, size, "%.16lf", val);
+    size_t length = (printed < 0) ? 0 : ((size_t)printed < size ? (size_t)printed : size - 1);
+    isNull = strcmp(buf, "-nan(ind)") == 0;
+    if (isNull == false && memchr(buf, '.', length) != nullptr)
+    {
+        size_t found = length;
+        while (found > 0 && buf[found - 1] == '0')
+        {
+            --found;
+        }
+        if (found == 0) // case value == 0
+        {
+            length = 1;
+        }
+        else if (buf[found - 1] == '.')
+        {
+            length = found - 1;
+        }
+        else
+        {
+            length = found;
+        }
+        buf[length] = '\0';
+    }
+    return length;
+}
+
 ///////////////////////////// Element ////////////////////////////////////////
 amf::JSONParserImpl::ElementHelper::ElementHelper()
 {
@@ -208,10 +246,95 @@ void amf::JSONParserImpl::ElementHelper::InsertTabs(std::string& target, int cou
     }
 }
 
+void amf::JSONParserImpl::ElementHelper::AppendValue(std::string& target, VALUE_TYPE type, const char* value, size_t length) const
+{
+    const bool quote = (type == VT_String || length == 0) && type != VT_Null;
+    if (quote)
+    {
+        target += '\"';
+    }
+    target.append(value, length);
+    if (quote)
+    {
+        target += '\"';
+    }
+}
+
+void amf::JSONParserImpl::ElementHelper::StringifyElement(std::string& out, const JSONParser::Element* element, const OutputFormatDesc& format, int indent)
+{
+    JSONParser::Element* pElement = const_cast<JSONParser::Element*>(element);
+    ElementHelper* pHelper = nullptr;
+    if (pElement->QueryInterface(ElementHelper::IID(), reinterpret_cast<void**>(&pHelper)) == AMF_OK)
+    {
+        pHelper->StringifyTo(out, format, indent);
+        pElement->Release();
+    }
+    else
+    {
+        // element implemented outside of this parser
+        out += element->StringifyFormatted(format, indent);
+    }
+}
+
+void amf::JSONParserImpl::ElementHelper::AppendNodeMember(std::string& target, const char* name, size_t nameLength, JSONParser::Element* element, bool first, const OutputFormatDesc& format, int indent) const
+{
+    if (first == false)
+    {
+        target += ',';
+    }
+    if (format.bHumanReadable == true)
+    {
+        target += '\n';
+    }
+    InsertTabs(target, indent + 1, format);
+
+    target += '\"';
+    target.append(name, nameLength);
+    target += format.bHumanReadable == true ? "\" : " : "\":";
+    if (format.bHumanReadable == true && format.bNewLineBeforeBrace == true)
+    {
+        amf::JSONParser::Value::Ptr value(element);
+        if (value == nullptr)
+        {
+            target += '\n';
+        }
+    }
+    if (element == nullptr)
+    {
+        target += NULL_STR;
+    }
+    else
+    {
+        StringifyElement(target, element, format, indent + 1);
+    }
+}
+
+void amf::JSONParserImpl::ElementHelper::AppendArrayItem(std::string& target, JSONParser::Element* element, bool first, bool& newLineBeforeClosingBrace, const OutputFormatDesc& format, int indent) const
+{
+    if (first == false)
+    {
+        target += ',';
+    }
+    if (format.bHumanReadable == true)
+    {
+        amf::JSONParser::Node::Ptr node(element);
+        if (node != nullptr)
+        {
+            target += '\n';
+            newLineBeforeClosingBrace = true;
+        }
+    }
+    if (element == nullptr)
+    {
+        target += NULL_STR;
+    }
+    else
+    {
+        StringifyElement(target, element, format, indent + 1);
+    }
+}
+
 ///////////////////////////// Value ////////////////////////////////////////
-static const char* const NULL_STR = "null";
-static const char* const TRUE_STR = "true";
-static const char* const FALSE_STR = "false";
 amf::JSONParserImpl::ValueImpl::ValueImpl() :
     ElementHelper(),
     m_eType(VT_Unknown)
@@ -268,34 +391,18 @@ void amf::JSONParserImpl::ValueImpl::SetValueAsUInt64(uint64_t val)
 
 void amf::JSONParserImpl::ValueImpl::SetValueAsDouble(double val)
 {
-    char buf[100];
-    sprintf(buf, "%.16lf", val);
-    m_Value = buf;
-    if (m_Value.compare("-nan(ind)") == 0)
+    char buf[400];
+    bool isNull = false;
+    size_t length = FormatDouble(val, buf, sizeof(buf), isNull);
+    if (isNull == true)
     {
         SetToNull();
     }
     else
     {
+        m_Value.assign(buf, length);
         m_eType = VT_Numeric;
     }
-
-    //trim trailing zeroes
-    if (m_Value.find_first_of(".") != std::string::npos)
-    {
-        std::size_t found = m_Value.find_last_not_of("0");
-        if (found != std::string::npos)
-        {
-            if (m_Value[found] == '.')
-                m_Value.erase(found);
-            else
-                m_Value.erase(found + 1);
-        }
-        else // case value == 0
-        {
-            m_Value.erase(1);
-        }
-    }
 }
 
 void amf::JSONParserImpl::ValueImpl::SetValueAsFloat(float val)
@@ -465,21 +572,18 @@ std::string amf::JSONParserImpl::ValueImpl::Stringify() const
     return StringifyFormatted(defaultFormat, 0);
 }
 
-std::string amf::JSONParserImpl::ValueImpl::StringifyFormatted(const OutputFormatDesc&, int /*indent*/) const
+std::string amf::JSONParserImpl::ValueImpl::StringifyFormatted(const OutputFormatDesc& format, int indent) const
 {
     std::string jsonValue;
-    if ((m_eType == VT_String || m_Value.length() == 0) && IsNull() == false)
-    {
-        jsonValue += '\"';
-    }
-    jsonValue += m_Value;
-    if ((m_eType == VT_String || m_Value.length() == 0) && IsNull() == false)
-    {
-        jsonValue += '\"';
-    }
+    StringifyTo(jsonValue, format, indent);
     return jsonValue;
 }
 
+void amf::JSONParserImpl::ValueImpl::StringifyTo(std::string& out, const OutputFormatDesc&, int /*indent*/) const
+{
+    AppendValue(out, m_eType, m_Value.c_str(), m_Value.length());
+}
+
 ///////////////////////////// Node ////////////////////////////////////////
 amf::JSONParserImpl::NodeImpl::NodeImpl() :
     ElementHelper()
@@ -576,47 +680,28 @@ std::string amf::JSONParserImpl::NodeImpl::Stringify() const
 
 std::string amf::JSONParserImpl::NodeImpl::StringifyFormatted(const OutputFormatDesc& format, int indent) const
 {
-    bool first = true;
     std::string jsonValue;
+    StringifyTo(jsonValue, format, indent);
+    return jsonValue;
+}
+
+void amf::JSONParserImpl::NodeImpl::StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const
+{
+    bool first = true;
 
-    InsertTabs(jsonValue, indent, format);
-    jsonValue += '{';
+    InsertTabs(out, indent, format);
+    out += '{';
     for (ElementMap::const_iterator it = m_Elements.begin(); it != m_Elements.end(); ++it)
     {
-        if (first == false)
-        {
-            jsonValue += ',';
-        }
-        else
-        {
-            first = false;
-        }
-        if (format.bHumanReadable == true)
-        {
-            jsonValue += '\n';
-        }
-        InsertTabs(jsonValue, indent + 1, format);
-        
-        jsonValue += '\"';
-        jsonValue += it->first;
-        jsonValue += format.bHumanReadable == true ? "\" : " : "\":";
-        if (format.bHumanReadable == true)
-        {
-            amf::JSONParserImpl::Value::Ptr value(it->second);
-            if (value == nullptr && format.bNewLineBeforeBrace == true)
-            {
-                jsonValue += '\n';
-            }
-        }
-        jsonValue += it->second == nullptr ? "null" : it->second->StringifyFormatted(format, indent + 1);
+        AppendNodeMember(out, it->first.c_str(), it->first.length(), it->second, first, format, indent);
+        first = false;
     }
     if (format.bHumanReadable == true && format.bNewLineBeforeBrace == true)
     {
-        jsonValue += '\n';
+        out += '\n';
     }
-    InsertTabs(jsonValue, indent, format);
-    jsonValue += '}';
-    return jsonValue;
+    InsertTabs(out, indent, format);
+    out += '}';
 }
 
 amf::JSONParser::Element* amf::JSONParserImpl::NodeImpl::GetElementByName(const std::string& name) const
@@ -717,43 +802,29 @@ std::string amf::JSONParserImpl::ArrayImpl::Stringify() const
 
 std::string amf::JSONParserImpl::ArrayImpl::StringifyFormatted(const OutputFormatDesc& format, int indent) const
 {
-    bool first = true;
     std::string jsonValue;
-    InsertTabs(jsonValue, indent, format);
-    
-    jsonValue += '[';
+    StringifyTo(jsonValue, format, indent);
+    return jsonValue;
+}
+
+void amf::JSONParserImpl::ArrayImpl::StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const
+{
+    bool first = true;
     bool newLineBeforeClosingBrace = false;
+
+    InsertTabs(out, indent, format);
+    out += '[';
     for (ElementVector::const_iterator it = m_Elements.begin(); it != m_Elements.end(); ++it)
     {
-        if (first == false)
-        {
-            jsonValue += ',';
-        }
-        else
-        {
-            first = false;
-        }
-        if (format.bHumanReadable == true)
-        {
-            amf::JSONParserImpl::Node::Ptr node(*it);
-            if (node != nullptr)
-            {
-                jsonValue += '\n';
-                newLineBeforeClosingBrace = true;
-            }
-        }
-        jsonValue += *it == nullptr ? "null" : (*it)->StringifyFormatted(format, indent + 1);
+        AppendArrayItem(out, *it, first, newLineBeforeClosingBrace, format, indent);
+        first = false;
     }
     if (format.bHumanReadable == true && newLineBeforeClosingBrace == true)
     {
-        jsonValue += '\n';
+        out += '\n';
     }
-    InsertTabs(jsonValue, indent, format);
-    
-    jsonValue += ']';
-
-    return jsonValue;
-
+    InsertTabs(out, indent, format);
+    out += ']';
 }
 
 size_t amf::JSONParserImpl::ArrayImpl::GetElementCount() const
@@ -766,101 +837,1183 @@ amf::JSONParser::Element* amf::JSONParserImpl::ArrayImpl::GetElementAt(size_t id
     return m_Elements[idx];
 }
 
-///////////////////////////// JSONParser ////////////////////////////////////////
-amf::JSONParserImpl::JSONParserImpl() :
-    m_LastErrorOfs(0)
-{
-}
-
-amf::JSONParser::Result amf::JSONParserImpl::Parse(const std::string& str, amf::JSONParser::Node** root)
+///////////////////////////// Streaming parser ////////////////////////////////////////
+namespace
 {
-    amf::JSONParser::Result result = OK;
-    if (root == nullptr)
-    {
-        result = INVALID_ARG;
-    }
-    else
+    // Single pass recursive descent parser over the caller's buffer. Tokens are reported as
+    // views into the buffer; nothing is copied or allocated.
+    class JSONStreamParser
     {
-        amf::JSONParser::Node* rootNode(nullptr);
-        size_t start = str.find_first_of('{'); 
-        size_t end = str.find_last_of('}', str.length());
-        if (start != str.npos && end != str.npos)
+    public:
+        JSONStreamParser(const char* str, size_t length, amf::JSONParser::Handler* handler) :
+            m_pStr(str),
+            m_Length(length),
+            m_Pos(0),
+            m_pHandler(handler)
         {
-            rootNode = new NodeImpl();
-            Error parseErr = rootNode->Parse(str, start, end);
-            if (parseErr.GetResult() != OK)
+        }
+
+        amf::JSONParser::Result Parse()
+        {
+            // same leniency as JSONParserImpl::Parse(): anything before the root brace is ignored
+            const char* rootBrace = m_pStr != nullptr ? static_cast<const char*>(memchr(m_pStr, '{', m_Length)) : nullptr;
+            if (rootBrace == nullptr)
             {
-                result = parseErr.GetResult();
-                m_LastErrorOfs = parseErr.GetOffset();
+                return amf::JSONParser::MISSING_BRACE;
             }
-            else
+            m_Pos = rootBrace - m_pStr;
+            return ParseObject(0);
+        }
+
+        size_t GetOffset() const { return m_Pos; }
+
+    private:
+        static const int MAX_DEPTH = 512;
+
+        inline void SkipWhitespace()
+        {
+            while (m_Pos < m_Length)
             {
-                *root = rootNode;
-                (*root)->Acquire();
+                const char c = m_pStr[m_Pos];
+                if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+                {
+                    break;
+                }
+                ++m_Pos;
             }
         }
-        else
+
+        amf::JSONParser::Result ParseString(amf::JSONParser::StringView& view)
         {
-            result = MISSING_BRACE;
+            // m_Pos is at the opening quote
+            size_t pos = m_Pos + 1;
+            for (;;)
+            {
+                const char* quote = static_cast<const char*>(memchr(m_pStr + pos, '"', m_Length - pos));
+                if (quote == nullptr)
+                {
+                    return amf::JSONParser::MISSING_QUOTE;
+                }
+                size_t quotePos = quote - m_pStr;
+                size_t backslashes = 0;
+                while (quotePos - backslashes > m_Pos + 1 && m_pStr[quotePos - backslashes - 1] == '\\')
+                {
+                    ++backslashes;
+                }
+                if ((backslashes & 1) == 0)
+                {
+                    view.pData = m_pStr + m_Pos + 1;
+                    view.nLength = quotePos - m_Pos - 1;
+                    m_Pos = quotePos + 1;
+                    return amf::JSONParser::OK;
+                }
+                pos = quotePos + 1;
+            }
         }
-    }
-    return result;
-}
-    
-std::string amf::JSONParserImpl::Stringify(const JSONParser::Node* root) const
-{
-    return StringifyFormatted(root, defaultFormat, 0);
-}
-
-std::string amf::JSONParserImpl::StringifyFormatted(const Node* root, const OutputFormatDesc& format, int indent) const
-{
-    std::string jsonStr;
-    if (root != nullptr)
-    {
-        jsonStr = root->StringifyFormatted(format, indent);
-    }
-    return jsonStr;
-}
-
-size_t amf::JSONParserImpl::GetLastErrorOffset() const
-{
-    return m_LastErrorOfs;
-}
 
-amf::JSONParserImpl::Result amf::JSONParserImpl::CreateNode(Node** node) const 
-{
-    Result result = INVALID_ARG;
-    if (node != nullptr)
-    {
-        *node = new NodeImpl();
-        (*node)->Acquire();
-        result = OK;
-    }
-    return result;
-}
+        amf::JSONParser::Result ParseValue(int depth)
+        {
+            SkipWhitespace();
+            if (m_Pos >= m_Length)
+            {
+                return amf::JSONParser::UNEXPECTED_END;
+            }
+            switch (m_pStr[m_Pos])
+            {
+            case '{':
+                return ParseObject(depth + 1);
+            case '[':
+                return ParseArray(depth + 1);
+            case '"':
+            {
+                amf::JSONParser::StringView view;
+                amf::JSONParser::Result result = ParseString(view);
+                if (result != amf::JSONParser::OK)
+                {
+                    return result;
+                }
+                return m_pHandler->OnString(view) ? amf::JSONParser::OK : amf::JSONParser::ABORTED;
+            }
+            default:
+                break;
+            }
 
-amf::JSONParserImpl::Result amf::JSONParserImpl::CreateValue(Value** value) const 
-{
-    Result result = INVALID_ARG;
-    if (value != nullptr)
-    {
-        *value = new ValueImpl();
-        (*value)->Acquire();
-        result = OK;
-    }
-    return result;
-}
+            // literal or number: everything up to the next delimiter, like the DOM parser
+            const size_t start = m_Pos;
+            while (m_Pos < m_Length)
+            {
+                const char c = m_pStr[m_Pos];
+                if (c == ',' || c == '}' || c == ']' || c == ':' || c == ' ' || c == '\t' || c == '\n' || c == '\r')
+                {
+                    break;
+                }
+                ++m_Pos;
+            }
+            if (m_Pos == start)
+            {
+                return amf::JSONParser::MISSING_VALUE;
+            }
+            amf::JSONParser::StringView view = { m_pStr + start, m_Pos - start };
+            bool ok;
+            if (view.nLength == 4 && memcmp(view.pData, NULL_STR, 4) == 0)
+            {
+                ok = m_pHandler->OnNull();
+            }
+            else if (view.nLength == 4 && memcmp(view.pData, TRUE_STR, 4) == 0)
+            {
+                ok = m_pHandler->OnBool(true);
+            }
+            else if (view.nLength == 5 && memcmp(view.pData, FALSE_STR, 5) == 0)
+            {
+                ok = m_pHandler->OnBool(false);
+            }
+            else
+            {
+                ok = m_pHandler->OnNumber(view);
+            }
+            return ok ? amf::JSONParser::OK : amf::JSONParser::ABORTED;
+        }
 
-amf::JSONParserImpl::Result amf::JSONParserImpl::CreateArray(Array** array) const 
-{
-    Result result = INVALID_ARG;
-    if (array != nullptr)
-    {
-        *array = new ArrayImpl();
-        (*array)->Acquire();
-        result = OK;
-    }
-    return result;
+        amf::JSONParser::Result ParseObject(int depth)
+        {
+            // m_Pos is at '{'
+            if (depth > MAX_DEPTH)
+            {
+                return amf::JSONParser::INVALID_VALUE;
+            }
+            if (m_pHandler->OnStartObject() == false)
+            {
+                return amf::JSONParser::ABORTED;
+            }
+            ++m_Pos;
+            SkipWhitespace();
+            if (m_Pos < m_Length && m_pStr[m_Pos] == '}')
+            {
+                ++m_Pos;
+                return m_pHandler->OnEndObject() ? amf::JSONParser::OK : amf::JSONParser::ABORTED;
+            }
+            for (;;)
+            {
+                SkipWhitespace();
+                if (m_Pos >= m_Length)
+                {
+                    return amf::JSONParser::UNEXPECTED_END;
+                }
+                if (m_pStr[m_Pos] != '"')
+                {
+                    return amf::JSONParser::MISSING_QUOTE;
+                }
+                amf::JSONParser::StringView name;
+                amf::JSONParser::Result result = ParseString(name);
+                if (result != amf::JSONParser::OK)
+                {
+                    return result;
+                }
+                SkipWhitespace();
+                if (m_Pos >= m_Length || m_pStr[m_Pos] != ':')
+                {
+                    return amf::JSONParser::MISSING_DELIMITER;
+                }
+                ++m_Pos;
+                if (m_pHandler->OnKey(name) == false)
+                {
+                    return amf::JSONParser::ABORTED;
+                }
+                result = ParseValue(depth);
+                if (result != amf::JSONParser::OK)
+                {
+                    return result;
+                }
+                SkipWhitespace();
+                if (m_Pos >= m_Length)
+                {
+                    return amf::JSONParser::UNEXPECTED_END;
+                }
+                const char c = m_pStr[m_Pos++];
+                if (c == '}')
+                {
+                    return m_pHandler->OnEndObject() ? amf::JSONParser::OK : amf::JSONParser::ABORTED;
+                }
+                if (c != ',')
+                {
+                    --m_Pos;
+                    return amf::JSONParser::MISSING_BRACE;
+                }
+            }
+        }
+
+        amf::JSONParser::Result ParseArray(int depth)
+        {
+            // m_Pos is at '['
+            if (depth > MAX_DEPTH)
+            {
+                return amf::JSONParser::INVALID_VALUE;
+            }
+            if (m_pHandler->OnStartArray() == false)
+            {
+                return amf::JSONParser::ABORTED;
+            }
+            ++m_Pos;
+            SkipWhitespace();
+            if (m_Pos < m_Length && m_pStr[m_Pos] == ']')
+            {
+                ++m_Pos;
+                return m_pHandler->OnEndArray() ? amf::JSONParser::OK : amf::JSONParser::ABORTED;
+            }
+            for (;;)
+            {
+                amf::JSONParser::Result result = ParseValue(depth);
+                if (result != amf::JSONParser::OK)
+                {
+                    return result;
+                }
+                SkipWhitespace();
+                if (m_Pos >= m_Length)
+                {
+                    return amf::JSONParser::UNEXPECTED_END;
+                }
+                const char c = m_pStr[m_Pos++];
+                if (c == ']')
+                {
+                    return m_pHandler->OnEndArray() ? amf::JSONParser::OK : amf::JSONParser::ABORTED;
+                }
+                if (c != ',')
+                {
+                    --m_Pos;
+                    return amf::JSONParser::MISSING_BRACKET;
+                }
+            }
+        }
+
+        const char*                 m_pStr;
+        size_t                      m_Length;
+        size_t                      m_Pos;
+        amf::JSONParser::Handler*   m_pHandler;
+    };
+
+    //---------------------------------------------------------------------------------------------
+    // Handler that assembles an arena DOM. Children of the open containers are collected on one
+    // scratch stack and copied into the arena once the container is closed.
+    class JSONArenaBuilder : public amf::JSONParser::Handler
+    {
+    public:
+        typedef amf::JSONParserImpl::ArenaNodeImpl::Entry Entry;
+
+        JSONArenaBuilder(amf::JSONParserImpl::ArenaDocument* pDocument) :
+            m_pDocument(pDocument),
+            m_pRoot(nullptr),
+            m_Result(amf::JSONParser::OK)
+        {
+            m_PendingName.pData = nullptr;
+            m_PendingName.nLength = 0;
+        }
+
+        amf::JSONParserImpl::ArenaNodeImpl* GetRoot() const { return m_pRoot; }
+        amf::JSONParser::Result GetResult() const { return m_Result; }
+
+        virtual bool OnStartObject()
+        {
+            amf::JSONParserImpl::ArenaNodeImpl* node = m_pDocument->Create<amf::JSONParserImpl::ArenaNodeImpl>();
+            if (m_Frames.empty())
+            {
+                m_pRoot = node;
+            }
+            else
+            {
+                Push(node);
+            }
+            Frame frame = { node, m_Entries.size() };
+            m_Frames.push_back(frame);
+            return true;
+        }
+        virtual bool OnKey(const amf::JSONParser::StringView& name)
+        {
+            m_PendingName = name;
+            return true;
+        }
+        virtual bool OnEndObject()
+        {
+            Frame& frame = m_Frames.back();
+            const size_t count = m_Entries.size() - frame.firstEntry;
+            Entry* entries = static_cast<Entry*>(m_pDocument->Allocate(count * sizeof(Entry)));
+            if (count > 0)
+            {
+                memcpy(entries, &m_Entries[frame.firstEntry], count * sizeof(Entry));
+            }
+            if (amf::JSONParserImpl::ArenaNodeImpl::SortEntries(entries, count) == false)
+            {
+                m_Result = amf::JSONParser::DUPLICATE_NAME;
+                return false;
+            }
+            static_cast<amf::JSONParserImpl::ArenaNodeImpl*>(frame.pContainer)->SetEntries(entries, count);
+            m_Entries.resize(frame.firstEntry);
+            m_Frames.pop_back();
+            return true;
+        }
+        virtual bool OnStartArray()
+        {
+            amf::JSONParserImpl::ArenaArrayImpl* array = m_pDocument->Create<amf::JSONParserImpl::ArenaArrayImpl>();
+            Push(array);
+            Frame frame = { array, m_Entries.size() };
+            m_Frames.push_back(frame);
+            return true;
+        }
+        virtual bool OnEndArray()
+        {
+            Frame& frame = m_Frames.back();
+            const size_t count = m_Entries.size() - frame.firstEntry;
+            amf::JSONParser::Element** elements = static_cast<amf::JSONParser::Element**>(m_pDocument->Allocate(count * sizeof(amf::JSONParser::Element*)));
+            for (size_t i = 0; i < count; i++)
+            {
+                elements[i] = m_Entries[frame.firstEntry + i].pElement;
+            }
+            static_cast<amf::JSONParserImpl::ArenaArrayImpl*>(frame.pContainer)->SetElements(elements, count);
+            m_Entries.resize(frame.firstEntry);
+            m_Frames.pop_back();
+            return true;
+        }
+        virtual bool OnString(const amf::JSONParser::StringView& val)
+        {
+            return PushValue(amf::JSONParserImpl::VT_String, val);
+        }
+        virtual bool OnNumber(const amf::JSONParser::StringView& val)
+        {
+            return PushValue(amf::JSONParserImpl::VT_Numeric, val);
+        }
+        virtual bool OnBool(bool val)
+        {
+            amf::JSONParser::StringView view = { val ? TRUE_STR : FALSE_STR, val ? (size_t)4 : (size_t)5 };
+            return PushValue(amf::JSONParserImpl::VT_Bool, view);
+        }
+        virtual bool OnNull()
+        {
+            amf::JSONParser::StringView view = { NULL_STR, 4 };
+            return PushValue(amf::JSONParserImpl::VT_Null, view);
+        }
+
+    private:
+        struct Frame
+        {
+            amf::JSONParser::Element*   pContainer;
+            size_t                      firstEntry;
+        };
+
+        void Push(amf::JSONParser::Element* element)
+        {
+            Entry entry = { m_PendingName, element };
+            m_Entries.push_back(entry);
+        }
+        bool PushValue(amf::JSONParserImpl::VALUE_TYPE type, const amf::JSONParser::StringView& val)
+        {
+            amf::JSONParserImpl::ArenaValueImpl* value = m_pDocument->Create<amf::JSONParserImpl::ArenaValueImpl>();
+            value->Init(type, val.pData, val.nLength);
+            Push(value);
+            return true;
+        }
+
+        amf::JSONParserImpl::ArenaDocument*     m_pDocument;
+        amf::JSONParserImpl::ArenaNodeImpl*     m_pRoot;
+        amf::JSONParser::Result                 m_Result;
+        amf::JSONParser::StringView             m_PendingName;
+        std::vector<Frame>                      m_Frames;
+        std::vector<Entry>                      m_Entries;
+    };
+}
+
+//-------------------------------------------------------------------------------------------------
+// copies a token into a terminated buffer for the strto* family
+static const char* TerminateToken(const char* value, size_t length, char* buf, size_t size)
+{
+    if (length >= size)
+    {
+        length = size - 1;
+    }
+    memcpy(buf, value, length);
+    buf[length] = '\0';
+    return buf;
+}
+
+///////////////////////////// ArenaDocument ////////////////////////////////////////
+static const size_t ARENA_BLOCK_SIZE = 16 * 1024;
+static const size_t ARENA_ALIGNMENT = 16;
+
+amf::JSONParserImpl::ArenaDocument::ArenaDocument() :
+    m_pObjects(nullptr),
+    m_Used(0),
+    m_RefCount(0)
+{
+}
+
+amf::JSONParserImpl::ArenaDocument::~ArenaDocument()
+{
+    for (ArenaObject* obj = m_pObjects; obj != nullptr; )
+    {
+        ArenaObject* next = obj->m_pNextObject;
+        obj->~ArenaObject();
+        obj = next;
+    }
+    for (std::vector<Block>::iterator it = m_Blocks.begin(); it != m_Blocks.end(); ++it)
+    {
+        amf_free(it->pData);
+    }
+}
+
+amf_long amf::JSONParserImpl::ArenaDocument::Acquire()
+{
+    return amf_atomic_inc(&m_RefCount);
+}
+
+amf_long amf::JSONParserImpl::ArenaDocument::Release()
+{
+    amf_long newVal = amf_atomic_dec(&m_RefCount);
+    if (newVal == 0)
+    {
+        delete this;
+    }
+    return newVal;
+}
+
+void* amf::JSONParserImpl::ArenaDocument::Allocate(size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    if (m_Blocks.empty() || m_Used + size > m_Blocks.back().size)
+    {
+        Block block;
+        block.size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block.pData = static_cast<amf_uint8*>(amf_alloc(block.size));
+        m_Blocks.push_back(block);
+        m_Used = 0;
+    }
+    void* ptr = m_Blocks.back().pData + m_Used;
+    m_Used += size;
+    return ptr;
+}
+
+const char* amf::JSONParserImpl::ArenaDocument::CopyString(const char* str, size_t length)
+{
+    char* copy = static_cast<char*>(Allocate(length + 1));
+    if (length > 0)
+    {
+        memcpy(copy, str, length);
+    }
+    copy[length] = '\0';
+    return copy;
+}
+
+bool amf::JSONParserImpl::ArenaDocument::Owns(const void* ptr) const
+{
+    const amf_uint8* p = static_cast<const amf_uint8*>(ptr);
+    for (std::vector<Block>::const_iterator it = m_Blocks.begin(); it != m_Blocks.end(); ++it)
+    {
+        if (p >= it->pData && p < it->pData + it->size)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+///////////////////////////// ArenaValue ////////////////////////////////////////
+amf::JSONParserImpl::ArenaValueImpl::ArenaValueImpl(ArenaDocument* pDocument) :
+    ArenaElementImpl<JSONParser::Value>(pDocument),
+    m_eType(VT_Unknown),
+    m_pValue(""),
+    m_Length(0),
+    m_bCached(false)
+{
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::Init(VALUE_TYPE type, const char* value, size_t length)
+{
+    m_eType = type;
+    m_pValue = value;
+    m_Length = length;
+    m_bCached = false;
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::StringifyTo(std::string& out, const OutputFormatDesc&, int /*indent*/) const
+{
+    AppendValue(out, m_eType, m_pValue, m_Length);
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValue(const std::string& val)
+{
+    Init(VT_String, m_pDocument->CopyString(val.c_str(), val.length()), val.length());
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValueAsInt32(int32_t val)
+{
+    SetValueAsInt64(val);
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValueAsUInt32(uint32_t val)
+{
+    SetValueAsUInt64(val);
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValueAsInt64(int64_t val)
+{
+    char buf[32];
+    int length = snprintf(buf, sizeof(buf), "%" PRId64, val);
+    Init(VT_Numeric, m_pDocument->CopyString(buf, length), length);
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValueAsUInt64(uint64_t val)
+{
+    char buf[32];
+    int length = snprintf(buf, sizeof(buf), "%" PRIu64, val);
+    Init(VT_Numeric, m_pDocument->CopyString(buf, length), length);
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValueAsDouble(double val)
+{
+    char buf[400];
+    bool isNull = false;
+    size_t length = FormatDouble(val, buf, sizeof(buf), isNull);
+    if (isNull == true)
+    {
+        SetToNull();
+    }
+    else
+    {
+        Init(VT_Numeric, m_pDocument->CopyString(buf, length), length);
+    }
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValueAsFloat(float val)
+{
+    SetValueAsDouble(static_cast<double>(val));
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValueAsBool(bool val)
+{
+    Init(VT_Bool, val ? TRUE_STR : FALSE_STR, val ? 4 : 5);
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetValueAsTime(time_t date, bool utc)
+{
+    SetValueAsInt64((utc == true) ? date : std::mktime(std::localtime(&date)));
+}
+
+void amf::JSONParserImpl::ArenaValueImpl::SetToNull()
+{
+    Init(VT_Null, NULL_STR, 4);
+}
+
+const std::string& amf::JSONParserImpl::ArenaValueImpl::GetValue() const
+{
+    if (m_bCached == false)
+    {
+        m_Cache.assign(m_pValue, m_Length);
+        m_bCached = true;
+    }
+    return m_Cache;
+}
+
+int32_t amf::JSONParserImpl::ArenaValueImpl::GetValueAsInt32() const
+{
+    char buf[64];
+    return m_Length == 0 ? 0 : (int32_t)strtol(TerminateToken(m_pValue, m_Length, buf, sizeof(buf)), nullptr, 10);
+}
+
+uint32_t amf::JSONParserImpl::ArenaValueImpl::GetValueAsUInt32() const
+{
+    char buf[64];
+    return m_Length == 0 ? 0 : (uint32_t)strtoul(TerminateToken(m_pValue, m_Length, buf, sizeof(buf)), nullptr, 10);
+}
+
+int64_t amf::JSONParserImpl::ArenaValueImpl::GetValueAsInt64() const
+{
+    char buf[64];
+    return m_Length == 0 ? 0 : strtoll(TerminateToken(m_pValue, m_Length, buf, sizeof(buf)), nullptr, 10);
+}
+
+uint64_t amf::JSONParserImpl::ArenaValueImpl::GetValueAsUInt64() const
+{
+    char buf[64];
+    return m_Length == 0 ? 0 : strtoull(TerminateToken(m_pValue, m_Length, buf, sizeof(buf)), nullptr, 10);
+}
+
+double amf::JSONParserImpl::ArenaValueImpl::GetValueAsDouble() const
+{
+    char buf[400];
+    return m_Length == 0 ? 0 : strtod(TerminateToken(m_pValue, m_Length, buf, sizeof(buf)), nullptr);
+}
+
+float amf::JSONParserImpl::ArenaValueImpl::GetValueAsFloat() const
+{
+    return static_cast<float>(GetValueAsDouble());
+}
+
+bool amf::JSONParserImpl::ArenaValueImpl::GetValueAsBool() const
+{
+    if (m_Length == 0)
+    {
+        return false;
+    }
+    if (m_eType == VT_Bool)
+    {
+        return m_Length == 4 && memcmp(m_pValue, TRUE_STR, 4) == 0;
+    }
+    return GetValueAsDouble() != 0;
+}
+
+time_t amf::JSONParserImpl::ArenaValueImpl::GetValueAsTime() const
+{
+    if (m_Length != 0 && m_eType == VT_String)
+    {
+        return GetValueAsInt64();
+    }
+    return 0;
+}
+
+bool amf::JSONParserImpl::ArenaValueImpl::IsNull() const
+{
+    return m_eType == VT_Null;
+}
+
+///////////////////////////// ArenaNode ////////////////////////////////////////
+static inline int CompareNames(const char* name1, size_t length1, const char* name2, size_t length2)
+{
+    // same order as std::map<std::string, ...> used by NodeImpl
+    int cmp = memcmp(name1, name2, length1 < length2 ? length1 : length2);
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+    return length1 < length2 ? -1 : (length1 > length2 ? 1 : 0);
+}
+
+static bool EntryLess(const amf::JSONParserImpl::ArenaNodeImpl::Entry& e1, const amf::JSONParserImpl::ArenaNodeImpl::Entry& e2)
+{
+    return CompareNames(e1.name.pData, e1.name.nLength, e2.name.pData, e2.name.nLength) < 0;
+}
+
+amf::JSONParserImpl::ArenaNodeImpl::ArenaNodeImpl(ArenaDocument* pDocument) :
+    ArenaElementImpl<JSONParser::Node>(pDocument),
+    m_pEntries(nullptr),
+    m_Count(0)
+{
+}
+
+void amf::JSONParserImpl::ArenaNodeImpl::SetEntries(Entry* entries, size_t count)
+{
+    m_pEntries = entries;
+    m_Count = count;
+}
+
+bool amf::JSONParserImpl::ArenaNodeImpl::SortEntries(Entry* entries, size_t count)
+{
+    // presets are mostly written in order already; only sort when needed
+    bool sorted = true;
+    for (size_t i = 1; i < count && sorted; i++)
+    {
+        sorted = EntryLess(entries[i - 1], entries[i]);
+    }
+    if (sorted == false)
+    {
+        std::sort(entries, entries + count, EntryLess);
+    }
+    for (size_t i = 1; i < count; i++)
+    {
+        if (EntryLess(entries[i - 1], entries[i]) == false)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t amf::JSONParserImpl::ArenaNodeImpl::LowerBound(const char* name, size_t length) const
+{
+    size_t first = 0;
+    size_t count = m_Count;
+    while (count > 0)
+    {
+        size_t step = count / 2;
+        const Entry& entry = m_pEntries[first + step];
+        if (CompareNames(entry.name.pData, entry.name.nLength, name, length) < 0)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+    return first;
+}
+
+void amf::JSONParserImpl::ArenaNodeImpl::StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const
+{
+    InsertTabs(out, indent, format);
+    out += '{';
+    for (size_t i = 0; i < m_Count; i++)
+    {
+        AppendNodeMember(out, m_pEntries[i].name.pData, m_pEntries[i].name.nLength, m_pEntries[i].pElement, i == 0, format, indent);
+    }
+    if (format.bHumanReadable == true && format.bNewLineBeforeBrace == true)
+    {
+        out += '\n';
+    }
+    InsertTabs(out, indent, format);
+    out += '}';
+}
+
+size_t amf::JSONParserImpl::ArenaNodeImpl::GetElementCount() const
+{
+    return m_Count;
+}
+
+amf::JSONParser::Element* amf::JSONParserImpl::ArenaNodeImpl::GetElementByName(const std::string& name) const
+{
+    size_t idx = LowerBound(name.c_str(), name.length());
+    if (idx < m_Count && CompareNames(m_pEntries[idx].name.pData, m_pEntries[idx].name.nLength, name.c_str(), name.length()) == 0)
+    {
+        return m_pEntries[idx].pElement;
+    }
+    return nullptr;
+}
+
+amf::JSONParser::Result amf::JSONParserImpl::ArenaNodeImpl::AddElement(const std::string& name, JSONParser::Element* element)
+{
+    size_t idx = LowerBound(name.c_str(), name.length());
+    if (idx < m_Count && CompareNames(m_pEntries[idx].name.pData, m_pEntries[idx].name.nLength, name.c_str(), name.length()) == 0)
+    {
+        return JSONParser::DUPLICATE_NAME;
+    }
+    // elements of this document are kept alive by the document itself
+    if (element != nullptr && m_pDocument->Owns(element) == false)
+    {
+        m_External.push_back(Element::Ptr(element));
+    }
+    Entry* entries = static_cast<Entry*>(m_pDocument->Allocate((m_Count + 1) * sizeof(Entry)));
+    if (idx > 0)
+    {
+        memcpy(entries, m_pEntries, idx * sizeof(Entry));
+    }
+    if (idx < m_Count)
+    {
+        memcpy(entries + idx + 1, m_pEntries + idx, (m_Count - idx) * sizeof(Entry));
+    }
+    entries[idx].name.pData = m_pDocument->CopyString(name.c_str(), name.length());
+    entries[idx].name.nLength = name.length();
+    entries[idx].pElement = element;
+    m_pEntries = entries;
+    ++m_Count;
+    return JSONParser::OK;
+}
+
+amf::JSONParser::Element* amf::JSONParserImpl::ArenaNodeImpl::GetElementAt(size_t idx, std::string& name) const
+{
+    if (m_Count <= idx)
+    {
+        return nullptr;
+    }
+    name.assign(m_pEntries[idx].name.pData, m_pEntries[idx].name.nLength);
+    return m_pEntries[idx].pElement;
+}
+
+///////////////////////////// ArenaArray ////////////////////////////////////////
+amf::JSONParserImpl::ArenaArrayImpl::ArenaArrayImpl(ArenaDocument* pDocument) :
+    ArenaElementImpl<JSONParser::Array>(pDocument),
+    m_ppElements(nullptr),
+    m_Count(0),
+    m_Capacity(0)
+{
+}
+
+void amf::JSONParserImpl::ArenaArrayImpl::SetElements(JSONParser::Element** elements, size_t count)
+{
+    m_ppElements = elements;
+    m_Count = count;
+    m_Capacity = count;
+}
+
+void amf::JSONParserImpl::ArenaArrayImpl::StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const
+{
+    bool newLineBeforeClosingBrace = false;
+
+    InsertTabs(out, indent, format);
+    out += '[';
+    for (size_t i = 0; i < m_Count; i++)
+    {
+        AppendArrayItem(out, m_ppElements[i], i == 0, newLineBeforeClosingBrace, format, indent);
+    }
+    if (format.bHumanReadable == true && newLineBeforeClosingBrace == true)
+    {
+        out += '\n';
+    }
+    InsertTabs(out, indent, format);
+    out += ']';
+}
+
+size_t amf::JSONParserImpl::ArenaArrayImpl::GetElementCount() const
+{
+    return m_Count;
+}
+
+amf::JSONParser::Element* amf::JSONParserImpl::ArenaArrayImpl::GetElementAt(size_t idx) const
+{
+    return m_ppElements[idx];
+}
+
+void amf::JSONParserImpl::ArenaArrayImpl::AddElement(Element* element)
+{
+    if (element != nullptr && m_pDocument->Owns(element) == false)
+    {
+        m_External.push_back(Element::Ptr(element));
+    }
+    if (m_Count == m_Capacity)
+    {
+        size_t capacity = m_Capacity < 4 ? 8 : m_Capacity * 2;
+        JSONParser::Element** elements = static_cast<JSONParser::Element**>(m_pDocument->Allocate(capacity * sizeof(JSONParser::Element*)));
+        if (m_Count > 0)
+        {
+            memcpy(elements, m_ppElements, m_Count * sizeof(JSONParser::Element*));
+        }
+        m_ppElements = elements;
+        m_Capacity = capacity;
+    }
+    m_ppElements[m_Count++] = element;
+}
+
+///////////////////////////// JSONParser ////////////////////////////////////////
+amf::JSONParserImpl::JSONParserImpl() :
+    m_LastErrorOfs(0)
+{
+}
+
+amf::JSONParser::Result amf::JSONParserImpl::Parse(const std::string& str, amf::JSONParser::Node** root)
+{
+    amf::JSONParser::Result result = OK;
+    if (root == nullptr)
+    {
+        result = INVALID_ARG;
+    }
+    else
+    {
+        amf::JSONParser::Node* rootNode(nullptr);
+        size_t start = str.find_first_of('{'); 
+        size_t end = str.find_last_of('}', str.length());
+        if (start != str.npos && end != str.npos)
+        {
+            rootNode = new NodeImpl();
+            Error parseErr = rootNode->Parse(str, start, end);
+            if (parseErr.GetResult() != OK)
+            {
+                result = parseErr.GetResult();
+                m_LastErrorOfs = parseErr.GetOffset();
+            }
+            else
+            {
+                *root = rootNode;
+                (*root)->Acquire();
+            }
+        }
+        else
+        {
+            result = MISSING_BRACE;
+        }
+    }
+    return result;
+}
+    
+std::string amf::JSONParserImpl::Stringify(const JSONParser::Node* root) const
+{
+    return StringifyFormatted(root, defaultFormat, 0);
+}
+
+std::string amf::JSONParserImpl::StringifyFormatted(const Node* root, const OutputFormatDesc& format, int indent) const
+{
+    std::string jsonStr;
+    if (root != nullptr)
+    {
+        jsonStr = root->StringifyFormatted(format, indent);
+    }
+    return jsonStr;
+}
+
+size_t amf::JSONParserImpl::GetLastErrorOffset() const
+{
+    return m_LastErrorOfs;
+}
+
+amf::JSONParserImpl::Result amf::JSONParserImpl::CreateNode(Node** node) const 
+{
+    Result result = INVALID_ARG;
+    if (node != nullptr)
+    {
+        *node = new NodeImpl();
+        (*node)->Acquire();
+        result = OK;
+    }
+    return result;
+}
+
+amf::JSONParserImpl::Result amf::JSONParserImpl::CreateValue(Value** value) const 
+{
+    Result result = INVALID_ARG;
+    if (value != nullptr)
+    {
+        *value = new ValueImpl();
+        (*value)->Acquire();
+        result = OK;
+    }
+    return result;
+}
+
+amf::JSONParserImpl::Result amf::JSONParserImpl::CreateArray(Array** array) const 
+{
+    Result result = INVALID_ARG;
+    if (array != nullptr)
+    {
+        *array = new ArrayImpl();
+        (*array)->Acquire();
+        result = OK;
+    }
+    return result;
+}
+
+void amf::JSONParserImpl::StringifyTo(const Node* root, const OutputFormatDesc& format, std::string& out, int indent) const
+{
+    if (root != nullptr)
+    {
+        ElementHelper::StringifyElement(out, root, format, indent);
+    }
+}
+
+amf::JSONParser::Result amf::JSONParserImpl::ParseStream(const char* str, size_t length, Handler* handler)
+{
+    if (handler == nullptr || (str == nullptr && length != 0))
+    {
+        return INVALID_ARG;
+    }
+    JSONStreamParser parser(str, length, handler);
+    Result result = parser.Parse();
+    if (result != OK)
+    {
+        m_LastErrorOfs = parser.GetOffset();
+    }
+    return result;
+}
+
+amf::JSONParser::Result amf::JSONParserImpl::ParseArena(const char* str, size_t length, Node** root)
+{
+    if (root == nullptr || (str == nullptr && length != 0))
+    {
+        return INVALID_ARG;
+    }
+    ArenaDocument* pDocument = new ArenaDocument();
+    pDocument->Acquire();
+
+    // views in the DOM point into this copy, so the caller's buffer can go away
+    const char* copy = pDocument->CopyString(str, length);
+    JSONArenaBuilder builder(pDocument);
+    JSONStreamParser parser(copy, length, &builder);
+    Result result = parser.Parse();
+    if (result == ABORTED)
+    {
+        result = builder.GetResult();
+    }
+    if (result == OK)
+    {
+        *root = builder.GetRoot();
+        (*root)->Acquire();
+    }
+    else
+    {
+        m_LastErrorOfs = parser.GetOffset();
+    }
+    pDocument->Release();
+    return result;
+}
+
+///////////////////////////// JSONWriter ////////////////////////////////////////
+amf::JSONWriter::JSONWriter(std::string& out, const JSONParser::OutputFormatDesc* format, int indent) :
+    m_Out(out),
+    m_Format(format != nullptr ? *format : defaultFormat),
+    m_Indent(indent)
+{
+}
+
+void amf::JSONWriter::InsertTabs(int count)
+{
+    if (m_Format.bHumanReadable)
+    {
+        m_Out.append(size_t(count) * m_Format.nOffsetSize, m_Format.cOffsetWith);
+    }
+}
+
+void amf::JSONWriter::BeginValue(bool container, bool object)
+{
+    if (m_Levels.empty())
+    {
+        return;
+    }
+    Level& level = m_Levels.back();
+    if (level.bObject)
+    {
+        // separator and name were written by OnKey()
+        if (container == true && m_Format.bHumanReadable == true && m_Format.bNewLineBeforeBrace == true)
+        {
+            m_Out += '\n';
+        }
+        return;
+    }
+    if (level.bFirst == false)
+    {
+        m_Out += ',';
+    }
+    level.bFirst = false;
+    if (object == true && m_Format.bHumanReadable == true)
+    {
+        m_Out += '\n';
+        level.bNewLineBeforeClose = true;
+    }
+}
+
+void amf::JSONWriter::BeginContainer(bool object)
+{
+    BeginValue(true, object);
+    Level level = { object, true, false, m_Levels.empty() ? m_Indent : m_Levels.back().nIndent + 1 };
+    InsertTabs(level.nIndent);
+    m_Out += object ? '{' : '[';
+    m_Levels.push_back(level);
+}
+
+void amf::JSONWriter::EndContainer()
+{
+    const Level level = m_Levels.back();
+    m_Levels.pop_back();
+    if (m_Format.bHumanReadable == true && (level.bObject ? m_Format.bNewLineBeforeBrace : level.bNewLineBeforeClose) == true)
+    {
+        m_Out += '\n';
+    }
+    InsertTabs(level.nIndent);
+    m_Out += level.bObject ? '}' : ']';
+}
+
+bool amf::JSONWriter::OnStartObject()
+{
+    BeginContainer(true);
+    return true;
+}
+
+bool amf::JSONWriter::OnKey(const JSONParser::StringView& name)
+{
+    Level& level = m_Levels.back();
+    if (level.bFirst == false)
+    {
+        m_Out += ',';
+    }
+    level.bFirst = false;
+    if (m_Format.bHumanReadable == true)
+    {
+        m_Out += '\n';
+    }
+    InsertTabs(level.nIndent + 1);
+    m_Out += '"';
+    m_Out.append(name.pData, name.nLength);
+    m_Out += m_Format.bHumanReadable == true ? "\" : " : "\":";
+    return true;
+}
+
+bool amf::JSONWriter::OnEndObject()
+{
+    EndContainer();
+    return true;
+}
+
+bool amf::JSONWriter::OnStartArray()
+{
+    BeginContainer(false);
+    return true;
+}
+
+bool amf::JSONWriter::OnEndArray()
+{
+    EndContainer();
+    return true;
+}
+
+bool amf::JSONWriter::OnString(const JSONParser::StringView& val)
+{
+    BeginValue(false, false);
+    m_Out += '"';
+    m_Out.append(val.pData, val.nLength);
+    m_Out += '"';
+    return true;
+}
+
+bool amf::JSONWriter::OnNumber(const JSONParser::StringView& val)
+{
+    BeginValue(false, false);
+    if (val.nLength == 0)
+    {
+        m_Out += "\"\"";
+    }
+    else
+    {
+        m_Out.append(val.pData, val.nLength);
+    }
+    return true;
+}
+
+bool amf::JSONWriter::OnBool(bool val)
+{
+    BeginValue(false, false);
+    m_Out += val ? TRUE_STR : FALSE_STR;
+    return true;
+}
+
+bool amf::JSONWriter::OnNull()
+{
+    BeginValue(false, false);
+    m_Out += NULL_STR;
+    return true;
+}
+
+void amf::JSONWriter::WriteKey(const char* name)
+{
+    JSONParser::StringView view = { name, strlen(name) };
+    OnKey(view);
+}
+
+void amf::JSONWriter::WriteString(const char* val)
+{
+    JSONParser::StringView view = { val, strlen(val) };
+    OnString(view);
+}
+
+void amf::JSONWriter::WriteInt64(int64_t val)
+{
+    char buf[32];
+    JSONParser::StringView view = { buf, (size_t)snprintf(buf, sizeof(buf), "%" PRId64, val) };
+    OnNumber(view);
+}
+
+void amf::JSONWriter::WriteUInt64(uint64_t val)
+{
+    char buf[32];
+    JSONParser::StringView view = { buf, (size_t)snprintf(buf, sizeof(buf), "%" PRIu64, val) };
+    OnNumber(view);
+}
+
+void amf::JSONWriter::WriteDouble(double val)
+{
+    char buf[400];
+    bool isNull = false;
+    JSONParser::StringView view = { buf, FormatDouble(val, buf, sizeof(buf), isNull) };
+    if (isNull == true)
+    {
+        OnNull();
+    }
+    else
+    {
+        OnNumber(view);
+    }
 }
 
 extern "C"
@@ -38,24 +38,54 @@
 #include "Json.h"
 #include "InterfaceImpl.h"
 #include <map>
+#include <vector>
+#include <new>
 #include <ctime>
 
 namespace amf
 {
     //-----------------------------------------------------------------------------------------
     class JSONParserImpl : 
-        public AMFInterfaceImpl<JSONParser>
+        public AMFInterfaceImpl<JSONParser2>
     {
     public:
+        AMF_BEGIN_INTERFACE_MAP
+            AMF_INTERFACE_ENTRY(AMFInterface)
+            AMF_INTERFACE_ENTRY(JSONParser)
+            AMF_INTERFACE_ENTRY(JSONParser2)
+        AMF_END_INTERFACE_MAP
+
+        enum VALUE_TYPE
+        {
+            VT_Unknown  = 0,
+            VT_Null     = 1,
+            VT_Bool     = 2,
+            VT_String   = 3,
+            VT_Numeric  = 4,
+        };
         //-----------------------------------------------------------------------------------------
+        // Every element created by this parser also exposes ElementHelper through QueryInterface(),
+        // so nested elements append into one string instead of returning a copy per level.
         class ElementHelper
         {
+        public:
+            AMF_DECLARE_IID(0x9e4a7c21, 0x3f6b, 0x4d08, 0xb5, 0x2c, 0x1e, 0x87, 0x6a, 0xd3, 0x40, 0xf9)
+
+            virtual void StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const = 0;   //  appends to out
+
+            static void StringifyElement(std::string& out, const JSONParser::Element* element, const OutputFormatDesc& format, int indent);
         protected:
             ElementHelper();
+            virtual ~ElementHelper() {}
 
             Error CreateElement(const std::string& str, size_t start, size_t& valueStart, size_t& valueEnd, JSONParser::Element** val);
             size_t FindClosure(const std::string& str, char opener, char closer, size_t start);
             void InsertTabs(std::string& target, int count, const OutputFormatDesc& format) const;
+
+            // shared by the heap and arena elements so both stringify identically
+            void AppendValue(std::string& target, VALUE_TYPE type, const char* value, size_t length) const;
+            void AppendNodeMember(std::string& target, const char* name, size_t nameLength, JSONParser::Element* element, bool first, const OutputFormatDesc& format, int indent) const;
+            void AppendArrayItem(std::string& target, JSONParser::Element* element, bool first, bool& newLineBeforeClosingBrace, const OutputFormatDesc& format, int indent) const;
         protected:
         };
         //-----------------------------------------------------------------------------------------
@@ -69,12 +99,14 @@ namespace amf
             AMF_BEGIN_INTERFACE_MAP
                 AMF_INTERFACE_ENTRY(JSONParser::Element)
                 AMF_INTERFACE_ENTRY(JSONParser::Value)
+                AMF_INTERFACE_ENTRY(ElementHelper)
             AMF_END_INTERFACE_MAP
 
 
             virtual JSONParser::Error Parse(const std::string& str, size_t start, size_t end);
             virtual std::string Stringify() const;
             virtual std::string StringifyFormatted(const OutputFormatDesc& format, int indent) const;
+            virtual void StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const;
 
             virtual void                SetValue(const std::string& val);
             virtual void                SetValueAsInt32(int32_t val);
@@ -99,14 +131,6 @@ namespace amf
             virtual bool                IsNull() const;
 
         private:
-            enum VALUE_TYPE
-            {
-                VT_Unknown  = 0,
-                VT_Null     = 1,
-                VT_Bool     = 2,
-                VT_String   = 3,
-                VT_Numeric  = 4,
-            };
             VALUE_TYPE  m_eType;
             std::string m_Value;
         };
@@ -121,6 +145,7 @@ namespace amf
             AMF_BEGIN_INTERFACE_MAP
                 AMF_INTERFACE_ENTRY(JSONParser::Element)
                 AMF_INTERFACE_ENTRY(JSONParser::Node)
+                AMF_INTERFACE_ENTRY(ElementHelper)
             AMF_END_INTERFACE_MAP
 
             NodeImpl();
@@ -128,6 +153,7 @@ namespace amf
             virtual JSONParser::Error Parse(const std::string& str, size_t start, size_t end);
             virtual std::string Stringify() const;
             virtual std::string StringifyFormatted(const OutputFormatDesc& format, int indent) const;
+            virtual void StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const;
             
 
             virtual size_t GetElementCount() const;
@@ -151,6 +177,7 @@ namespace amf
             AMF_BEGIN_INTERFACE_MAP
                 AMF_INTERFACE_ENTRY(JSONParser::Element)
                 AMF_INTERFACE_ENTRY(JSONParser::Array)
+                AMF_INTERFACE_ENTRY(ElementHelper)
             AMF_END_INTERFACE_MAP
 
             ArrayImpl();
@@ -158,6 +185,7 @@ namespace amf
             virtual JSONParser::Error Parse(const std::string& str, size_t start, size_t end);
             virtual std::string Stringify() const;
             virtual std::string StringifyFormatted(const OutputFormatDesc& format, int indent) const;
+            virtual void StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const;
 
             virtual size_t GetElementCount() const;
             virtual JSONParser::Element* GetElementAt(size_t idx) const;
@@ -167,11 +195,199 @@ namespace amf
             ElementVector m_Elements;
         };
         //-----------------------------------------------------------------------------------------
+        class ArenaDocument;
+        //-----------------------------------------------------------------------------------------
+        class ArenaObject
+        {
+        public:
+            ArenaObject(ArenaDocument* pDocument) : m_pDocument(pDocument), m_pNextObject(nullptr) {}
+            virtual ~ArenaObject() {}
+
+            ArenaDocument*  m_pDocument;
+            ArenaObject*    m_pNextObject;
+        };
+        //-----------------------------------------------------------------------------------------
+        // Backing store for ParseArena(): one copy of the input plus bump-allocated elements.
+        // Every element forwards Acquire/Release here, so the document lives while any of its
+        // elements is referenced.
+        class ArenaDocument
+        {
+        public:
+            ArenaDocument();
+            ~ArenaDocument();
+
+            amf_long Acquire();
+            amf_long Release();
+
+            void* Allocate(size_t size);
+            const char* CopyString(const char* str, size_t length);
+            bool Owns(const void* ptr) const;
+
+            template<typename _T>
+            _T* Create()
+            {
+                _T* obj = new(Allocate(sizeof(_T))) _T(this);
+                obj->m_pNextObject = m_pObjects;
+                m_pObjects = obj;
+                return obj;
+            }
+        private:
+            ArenaDocument(const ArenaDocument&);
+            ArenaDocument& operator=(const ArenaDocument&);
+
+            struct Block
+            {
+                amf_uint8*  pData;
+                size_t      size;
+            };
+            ArenaObject*        m_pObjects;
+            std::vector<Block>  m_Blocks;
+            size_t              m_Used;
+            amf_long            m_RefCount;
+        };
+        //-----------------------------------------------------------------------------------------
+        template<class _Interface>
+        class ArenaElementImpl :
+            public _Interface,
+            public ArenaObject,
+            public ElementHelper
+        {
+        public:
+            ArenaElementImpl(ArenaDocument* pDocument) : ArenaObject(pDocument) {}
+
+            virtual amf_long AMF_STD_CALL Acquire() { return m_pDocument->Acquire(); }
+            virtual amf_long AMF_STD_CALL Release() { return m_pDocument->Release(); }
+
+            virtual std::string Stringify() const { return StringifyFormatted(OutputFormatDesc(), 0); }
+            virtual std::string StringifyFormatted(const OutputFormatDesc& format, int indent) const
+            {
+                std::string jsonValue;
+                this->StringifyTo(jsonValue, format, indent);
+                return jsonValue;
+            }
+            // arena elements are only built by ParseArena()
+            virtual JSONParser::Error Parse(const std::string&, size_t start, size_t) { return Error(start, JSONParser::INVALID_ARG); }
+        };
+        //-----------------------------------------------------------------------------------------
+        class ArenaValueImpl : public ArenaElementImpl<JSONParser::Value>
+        {
+        public:
+            ArenaValueImpl(ArenaDocument* pDocument);
+
+            AMF_BEGIN_INTERFACE_MAP
+                AMF_INTERFACE_ENTRY(AMFInterface)
+                AMF_INTERFACE_ENTRY(JSONParser::Element)
+                AMF_INTERFACE_ENTRY(JSONParser::Value)
+                AMF_INTERFACE_ENTRY(ElementHelper)
+            AMF_END_INTERFACE_MAP
+
+            void Init(VALUE_TYPE type, const char* value, size_t length);
+
+            virtual void StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const;
+
+            virtual void                SetValue(const std::string& val);
+            virtual void                SetValueAsInt32(int32_t val);
+            virtual void                SetValueAsUInt32(uint32_t val);
+            virtual void                SetValueAsInt64(int64_t val);
+            virtual void                SetValueAsUInt64(uint64_t val);
+            virtual void                SetValueAsDouble(double val);
+            virtual void                SetValueAsFloat(float val);
+            virtual void                SetValueAsBool(bool val);
+            virtual void                SetValueAsTime(time_t date, bool utc);
+            virtual void                SetToNull();
+
+            virtual const std::string&  GetValue() const;
+            virtual int32_t             GetValueAsInt32() const;
+            virtual uint32_t            GetValueAsUInt32() const;
+            virtual int64_t             GetValueAsInt64() const;
+            virtual uint64_t            GetValueAsUInt64() const;
+            virtual double              GetValueAsDouble() const;
+            virtual float               GetValueAsFloat() const;
+            virtual bool                GetValueAsBool() const;
+            virtual time_t              GetValueAsTime() const;
+            virtual bool                IsNull() const;
+
+        private:
+            VALUE_TYPE          m_eType;
+            const char*         m_pValue;
+            size_t              m_Length;
+            mutable std::string m_Cache;    // GetValue() only
+            mutable bool        m_bCached;
+        };
+        //-----------------------------------------------------------------------------------------
+        class ArenaNodeImpl : public ArenaElementImpl<JSONParser::Node>
+        {
+        public:
+            struct Entry
+            {
+                StringView              name;
+                JSONParser::Element*    pElement;
+            };
+
+            ArenaNodeImpl(ArenaDocument* pDocument);
+
+            AMF_BEGIN_INTERFACE_MAP
+                AMF_INTERFACE_ENTRY(AMFInterface)
+                AMF_INTERFACE_ENTRY(JSONParser::Element)
+                AMF_INTERFACE_ENTRY(JSONParser::Node)
+                AMF_INTERFACE_ENTRY(ElementHelper)
+            AMF_END_INTERFACE_MAP
+
+            // entries must be sorted by name, see SortEntries()
+            void SetEntries(Entry* entries, size_t count);
+            static bool SortEntries(Entry* entries, size_t count);  // false on duplicate names
+
+            virtual void StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const;
+
+            virtual size_t GetElementCount() const;
+            virtual JSONParser::Element* GetElementByName(const std::string& name) const;
+            virtual JSONParser::Result AddElement(const std::string& name, JSONParser::Element* element);
+            virtual JSONParser::Element* GetElementAt(size_t idx, std::string& name) const;
+
+        private:
+            size_t LowerBound(const char* name, size_t length) const;
+
+            Entry*                      m_pEntries;
+            size_t                      m_Count;
+            std::vector<Element::Ptr>   m_External;     // added elements from outside this document
+        };
+        //-----------------------------------------------------------------------------------------
+        class ArenaArrayImpl : public ArenaElementImpl<JSONParser::Array>
+        {
+        public:
+            ArenaArrayImpl(ArenaDocument* pDocument);
+
+            AMF_BEGIN_INTERFACE_MAP
+                AMF_INTERFACE_ENTRY(AMFInterface)
+                AMF_INTERFACE_ENTRY(JSONParser::Element)
+                AMF_INTERFACE_ENTRY(JSONParser::Array)
+                AMF_INTERFACE_ENTRY(ElementHelper)
+            AMF_END_INTERFACE_MAP
+
+            void SetElements(JSONParser::Element** elements, size_t count);
+
+            virtual void StringifyTo(std::string& out, const OutputFormatDesc& format, int indent) const;
+
+            virtual size_t GetElementCount() const;
+            virtual JSONParser::Element* GetElementAt(size_t idx) const;
+            virtual void AddElement(Element* element);
+
+        private:
+            JSONParser::Element**       m_ppElements;
+            size_t                      m_Count;
+            size_t                      m_Capacity;
+            std::vector<Element::Ptr>   m_External;
+        };
+        //-----------------------------------------------------------------------------------------
         JSONParserImpl();
 
         virtual JSONParser::Result Parse(const std::string& str, Node** root);
         virtual std::string Stringify(const Node* root) const;
         virtual std::string StringifyFormatted(const Node* root, const OutputFormatDesc& format, int indent) const;
+        virtual void StringifyTo(const Node* root, const OutputFormatDesc& format, std::string& out, int indent) const;
+
+        virtual Result ParseStream(const char* str, size_t length, Handler* handler);
+        virtual Result ParseArena(const char* str, size_t length, Node** root);
 
         virtual size_t GetLastErrorOffset() const;
 
@@ -71,6 +71,13 @@
 #include <sys/types.h>
 #include <semaphore.h>
 #include <pthread.h>
+#include <sched.h>
+#include <limits.h>
+
+#if defined(__linux)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 #include "../AMFSTL.h"
 
@@ -717,6 +724,105 @@ amf_pts AMF_STD_CALL amf_high_precision_clock()
     return ts.tv_sec * 10000000LL + ts.tv_nsec / 100.; //to nanosec
 }
 //---------------------------------------------------------------------------------------
+// precise waiter: on Linux a futex word with an absolute CLOCK_REALTIME timeout, the same clock as
+// amf_high_precision_clock(); cancel flips the word and wakes the sleeper. Other POSIX: condition variable
+struct MyWaiter
+{
+    int             m_cancel;
+#if !defined(__linux)
+    pthread_cond_t  m_cond;
+    pthread_mutex_t m_mutex;
+#endif
+};
+//---------------------------------------------------------------------------------------
+amf_handle AMF_STD_CALL amf_create_waiter()
+{
+    MyWaiter* waiter = new MyWaiter;
+    waiter->m_cancel = 0;
+#if !defined(__linux)
+    pthread_cond_t cond_tmp = PTHREAD_COND_INITIALIZER;
+    waiter->m_cond = cond_tmp;
+    pthread_mutex_t mutex_tmp = PTHREAD_MUTEX_INITIALIZER;
+    waiter->m_mutex = mutex_tmp;
+#endif
+    return (amf_handle)waiter;
+}
+//---------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_delete_waiter(amf_handle hwaiter)
+{
+    if(hwaiter == NULL)
+    {
+        return false;
+    }
+    MyWaiter* waiter = (MyWaiter*)hwaiter;
+#if !defined(__linux)
+    pthread_mutex_destroy(&waiter->m_mutex);
+    pthread_cond_destroy(&waiter->m_cond);
+#endif
+    delete waiter;
+    return true;
+}
+//---------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_wait_until(amf_handle hwaiter, amf_pts deadline)
+{
+    if(hwaiter == NULL)
+    {
+        return false;
+    }
+    MyWaiter* waiter = (MyWaiter*)hwaiter;
+    timespec abstime;
+    abstime.tv_sec = (time_t)(deadline / 10000000LL);
+    abstime.tv_nsec = (long)(deadline % 10000000LL) * 100;
+#if defined(__linux)
+    for(;;)
+    {
+        if(__atomic_exchange_n(&waiter->m_cancel, 0, __ATOMIC_ACQUIRE) != 0)
+        {
+            return false;
+        }
+        if(amf_high_precision_clock() >= deadline)
+        {
+            return true;
+        }
+        // sleeps only while m_cancel is still 0, EINTR and EAGAIN just loop
+        long err = syscall(SYS_futex, &waiter->m_cancel, FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME, 0, &abstime, NULL, FUTEX_BITSET_MATCH_ANY);
+        if(err == -1 && errno == ETIMEDOUT)
+        {
+            return __atomic_exchange_n(&waiter->m_cancel, 0, __ATOMIC_ACQUIRE) == 0;
+        }
+    }
+#else
+    pthread_mutex_lock(&waiter->m_mutex);
+    while(waiter->m_cancel == 0 && amf_high_precision_clock() < deadline)
+    {
+        pthread_cond_timedwait(&waiter->m_cond, &waiter->m_mutex, &abstime);
+    }
+    bool bCancelled = waiter->m_cancel != 0;
+    waiter->m_cancel = 0;
+    pthread_mutex_unlock(&waiter->m_mutex);
+    return !bCancelled;
+#endif
+}
+//---------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_cancel_wait(amf_handle hwaiter)
+{
+    if(hwaiter == NULL)
+    {
+        return false;
+    }
+    MyWaiter* waiter = (MyWaiter*)hwaiter;
+#if defined(__linux)
+    __atomic_store_n(&waiter->m_cancel, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &waiter->m_cancel, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&waiter->m_mutex);
+    waiter->m_cancel = 1;
+    pthread_cond_broadcast(&waiter->m_cond);
+    pthread_mutex_unlock(&waiter->m_mutex);
+#endif
+    return true;
+}
+//---------------------------------------------------------------------------------------
 // Returns number of physical cores
 amf_int32 AMF_STD_CALL amf_get_cpu_cores()
 {
@@ -750,6 +856,23 @@ amf_int32 AMF_STD_CALL amf_get_cpu_cores()
     // Failure, return default
     return 1;
 }
+//---------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_set_thread_affinity(amf_int32 iCpu)
+{
+#if defined(__linux)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (iCpu < 0 || cpus <= 0)
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(iCpu % cpus, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
 //--------------------------------------------------------------------------------
 // the end
 //--------------------------------------------------------------------------------
@@ -0,0 +1,359 @@
+// 
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+// 
+// MIT license 
+// 
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+///-------------------------------------------------------------------------
+///  @file   PropertyKeyMap.h
+///  @brief  interned property names and flat property map keyed by them
+///-------------------------------------------------------------------------
+#ifndef AMF_PropertyKeyMap_h
+#define AMF_PropertyKeyMap_h
+#pragma once
+
+#include "Thread.h"
+#include "AMFSTL.h"
+#include <atomic>
+#include <algorithm>
+
+namespace amf
+{
+    //---------------------------------------------------------------------------------------------
+    // interned property name: one entry per distinct string, lives until the process exits
+    struct AMFPropertyKeyEntry
+    {
+        amf_size    hash;
+        amf_size    length;
+        wchar_t     name[1];
+    };
+    //---------------------------------------------------------------------------------------------
+    // property name handle - equal names always share the same entry so comparison is a pointer compare
+    class AMFPropertyKey
+    {
+    public:
+        AMFPropertyKey() : m_pEntry(nullptr) {}
+        explicit AMFPropertyKey(const AMFPropertyKeyEntry* pEntry) : m_pEntry(pEntry) {}
+
+        bool            IsValid() const { return m_pEntry != nullptr; }
+        const wchar_t*  c_str() const   { return m_pEntry != nullptr ? m_pEntry->name : L""; }
+        amf_size        length() const  { return m_pEntry != nullptr ? m_pEntry->length : 0; }
+        amf_size        hash() const    { return m_pEntry != nullptr ? m_pEntry->hash : 0; }
+
+        bool operator==(const AMFPropertyKey& other) const { return m_pEntry == other.m_pEntry; }
+        bool operator!=(const AMFPropertyKey& other) const { return m_pEntry != other.m_pEntry; }
+    private:
+        const AMFPropertyKeyEntry* m_pEntry;
+    };
+    //---------------------------------------------------------------------------------------------
+    // process (module) wide atom table. Find() never locks: the open addressing table is only
+    // replaced as a whole and slots are published with release stores, retired tables are kept alive.
+    // Names are never removed, so the table grows with the number of distinct names ever stored in
+    // a map. Only storing a value interns a name - lookups, Has and rejected Set calls use Find().
+    // Code that makes up property names at runtime (per frame, per object) grows it without bound
+    // and should use fixed names with changing values instead.
+    class AMFPropertyKeyTable
+    {
+    public:
+        static AMFPropertyKey Intern(const wchar_t* pName)
+        {
+            return Instance().DoIntern(pName);
+        }
+        // returns invalid key if the name was never interned - nothing can be stored under it
+        static AMFPropertyKey Find(const wchar_t* pName)
+        {
+            if(pName == nullptr)
+            {
+                return AMFPropertyKey();
+            }
+            amf_size length = 0;
+            const amf_size hash = Hash(pName, length);
+            return AMFPropertyKey(Instance().Lookup(pName, length, hash));
+        }
+        // number of interned names
+        static amf_size GetCount()
+        {
+            AMFPropertyKeyTable& table = Instance();
+            AMFLock lock(&table.m_Sync);
+            return table.m_iCount;
+        }
+    private:
+        typedef std::atomic<const AMFPropertyKeyEntry*> Slot;
+
+        struct Table
+        {
+            amf_size    mask;
+            Slot*       pSlots;
+        };
+
+        AMFPropertyKeyTable() : m_pTable(nullptr), m_Sync(), m_Tables(), m_iCount(0)
+        {
+            m_pTable.store(CreateTable(1024), std::memory_order_release);
+        }
+
+        static AMFPropertyKeyTable& Instance()
+        {
+            // never destroyed: storages may be released from static destructors of other modules
+            static AMFPropertyKeyTable* s_pInstance = new AMFPropertyKeyTable();
+            return *s_pInstance;
+        }
+
+        static amf_size Hash(const wchar_t* pName, amf_size& length)
+        {
+            // FNV-1a per character unit, length computed in the same pass
+#if defined(_WIN64) || defined(__x86_64__) || defined(__aarch64__)
+            amf_size hash = amf_size(14695981039346656037ULL);
+            const amf_size prime = amf_size(1099511628211ULL);
+#else
+            amf_size hash = amf_size(2166136261U);
+            const amf_size prime = amf_size(16777619U);
+#endif
+            const wchar_t* p = pName;
+            for(; *p != 0; p++)
+            {
+                hash ^= amf_size(*p);
+                hash *= prime;
+            }
+            length = amf_size(p - pName);
+            return hash;
+        }
+
+        Table* CreateTable(amf_size capacity)
+        {
+            Table* pTable = new Table;
+            pTable->mask = capacity - 1;
+            pTable->pSlots = new Slot[capacity];
+            for(amf_size i = 0; i < capacity; i++)
+            {
+                pTable->pSlots[i].store(nullptr, std::memory_order_relaxed);
+            }
+            m_Tables.push_back(pTable);
+            return pTable;
+        }
+
+        const AMFPropertyKeyEntry* Lookup(const wchar_t* pName, amf_size length, amf_size hash) const
+        {
+            const Table* pTable = m_pTable.load(std::memory_order_acquire);
+            for(amf_size i = hash & pTable->mask; ; i = (i + 1) & pTable->mask)
+            {
+                const AMFPropertyKeyEntry* pEntry = pTable->pSlots[i].load(std::memory_order_acquire);
+                if(pEntry == nullptr)
+                {
+                    return nullptr;
+                }
+                if(pEntry->hash == hash && pEntry->length == length &&
+                    memcmp(pEntry->name, pName, length * sizeof(wchar_t)) == 0)
+                {
+                    return pEntry;
+                }
+            }
+        }
+
+        static void Insert(Table* pTable, const AMFPropertyKeyEntry* pEntry)
+        {
+            amf_size i = pEntry->hash & pTable->mask;
+            while(pTable->pSlots[i].load(std::memory_order_relaxed) != nullptr)
+            {
+                i = (i + 1) & pTable->mask;
+            }
+            pTable->pSlots[i].store(pEntry, std::memory_order_release);
+        }
+
+        AMFPropertyKey DoIntern(const wchar_t* pName)
+        {
+            if(pName == nullptr)
+            {
+                return AMFPropertyKey();
+            }
+            amf_size length = 0;
+            const amf_size hash = Hash(pName, length);
+            const AMFPropertyKeyEntry* pEntry = Lookup(pName, length, hash);
+            if(pEntry != nullptr)
+            {
+                return AMFPropertyKey(pEntry);
+            }
+
+            AMFLock lock(&m_Sync);
+            pEntry = Lookup(pName, length, hash); // could be added while we waited
+            if(pEntry != nullptr)
+            {
+                return AMFPropertyKey(pEntry);
+            }
+
+            AMFPropertyKeyEntry* pNew = static_cast<AMFPropertyKeyEntry*>(amf_alloc(sizeof(AMFPropertyKeyEntry) + length * sizeof(wchar_t)));
+            pNew->hash = hash;
+            pNew->length = length;
+            memcpy(pNew->name, pName, (length + 1) * sizeof(wchar_t));
+
+            Table* pTable = m_pTable.load(std::memory_order_relaxed);
+            if((m_iCount + 1) * 2 > pTable->mask + 1)
+            {
+                // readers may still probe the old table - it is not freed
+                Table* pGrown = CreateTable((pTable->mask + 1) * 2);
+                for(amf_size i = 0; i <= pTable->mask; i++)
+                {
+                    const AMFPropertyKeyEntry* pOld = pTable->pSlots[i].load(std::memory_order_relaxed);
+                    if(pOld != nullptr)
+                    {
+                        Insert(pGrown, pOld);
+                    }
+                }
+                m_pTable.store(pGrown, std::memory_order_release);
+                pTable = pGrown;
+            }
+            Insert(pTable, pNew);
+            m_iCount++;
+            return AMFPropertyKey(pNew);
+        }
+
+        std::atomic<Table*>     m_pTable;
+        AMFCriticalSection      m_Sync;
+        amf_vector<Table*>      m_Tables;
+        amf_size                m_iCount;
+    };
+    //---------------------------------------------------------------------------------------------
+    // flat map keyed by interned names: values are kept dense in insertion order, an open addressing
+    // index of item positions is probed by the name hash. clear() keeps capacity.
+    // begin()/end() iterate in insertion order; by_name(index) is the item at index in name order, the
+    // order std::map enumerated in, which GetPropertyAt() and GetPropertyInfo(index) expose.
+    // Like std::map the map itself is not synchronized; inserting invalidates iterators.
+    template<typename _TValue>
+    class AMFPropertyKeyMap
+    {
+    public:
+        struct value_type
+        {
+            AMFPropertyKey  first;
+            _TValue         second;
+        };
+        typedef typename amf_vector<value_type>::iterator          iterator;
+        typedef typename amf_vector<value_type>::const_iterator    const_iterator;
+
+        AMFPropertyKeyMap() : m_Items(), m_Index(), m_ByName()
+        {
+        }
+
+        iterator        begin()         { return m_Items.begin(); }
+        iterator        end()           { return m_Items.end(); }
+        const_iterator  begin() const   { return m_Items.begin(); }
+        const_iterator  end() const     { return m_Items.end(); }
+        amf_size        size() const    { return m_Items.size(); }
+        bool            empty() const   { return m_Items.empty(); }
+
+        const value_type& by_name(amf_size index) const { return m_Items[m_ByName[index]]; }
+
+        void clear()
+        {
+            m_Items.clear();
+            m_ByName.clear();
+            std::fill(m_Index.begin(), m_Index.end(), -1);
+        }
+
+        iterator        find(AMFPropertyKey key)            { return Position(m_Items.begin(), Lookup(key)); }
+        const_iterator  find(AMFPropertyKey key) const      { return Position(m_Items.begin(), Lookup(key)); }
+        iterator        find(const wchar_t* pName)          { return find(AMFPropertyKeyTable::Find(pName)); }
+        const_iterator  find(const wchar_t* pName) const    { return find(AMFPropertyKeyTable::Find(pName)); }
+        iterator        find(const amf_wstring& name)       { return find(name.c_str()); }
+        const_iterator  find(const amf_wstring& name) const { return find(name.c_str()); }
+
+        _TValue& operator[](AMFPropertyKey key)
+        {
+            amf_int32 pos = Lookup(key);
+            if(pos >= 0)
+            {
+                return m_Items[pos].second;
+            }
+            if((m_Items.size() + 1) * 2 > m_Index.size())
+            {
+                Rehash(AMF_MAX(amf_size(16), m_Index.size() * 2));
+            }
+            m_Index[Probe(key)] = amf_int32(m_Items.size());
+            m_ByName.insert(std::lower_bound(m_ByName.begin(), m_ByName.end(), key, NameLess(m_Items)), amf_int32(m_Items.size()));
+            m_Items.push_back(value_type());
+            m_Items.back().first = key;
+            return m_Items.back().second;
+        }
+        _TValue& operator[](const wchar_t* pName)       { return (*this)[AMFPropertyKeyTable::Intern(pName)]; }
+        _TValue& operator[](const amf_wstring& name)    { return (*this)[AMFPropertyKeyTable::Intern(name.c_str())]; }
+
+    private:
+        // item position against a key, compares as std::wstring::compare() does
+        struct NameLess
+        {
+            explicit NameLess(const amf_vector<value_type>& items) : m_Items(items) {}
+            bool operator()(amf_int32 pos, AMFPropertyKey key) const
+            {
+                const AMFPropertyKey& item = m_Items[pos].first;
+                const int order = std::char_traits<wchar_t>::compare(item.c_str(), key.c_str(), AMF_MIN(item.length(), key.length()));
+                return order < 0 || (order == 0 && item.length() < key.length());
+            }
+            const amf_vector<value_type>& m_Items;
+        };
+
+        template<typename _TIterator>
+        _TIterator Position(_TIterator first, amf_int32 pos) const
+        {
+            return pos >= 0 ? first + pos : first + m_Items.size();
+        }
+        // slot holding the key or the empty slot where it belongs
+        amf_size Probe(AMFPropertyKey key) const
+        {
+            const amf_size mask = m_Index.size() - 1;
+            amf_size i = key.hash() & mask;
+            while(m_Index[i] >= 0 && m_Items[m_Index[i]].first != key)
+            {
+                i = (i + 1) & mask;
+            }
+            return i;
+        }
+        amf_int32 Lookup(AMFPropertyKey key) const
+        {
+            if(!key.IsValid() || m_Items.empty())
+            {
+                return -1;
+            }
+            return m_Index[Probe(key)];
+        }
+        void Rehash(amf_size capacity)
+        {
+            m_Index.assign(capacity, -1);
+            for(amf_size i = 0; i < m_Items.size(); i++)
+            {
+                m_Index[Probe(m_Items[i].first)] = amf_int32(i);
+            }
+        }
+
+        amf_vector<value_type>  m_Items;
+        amf_vector<amf_int32>   m_Index;
+        amf_vector<amf_int32>   m_ByName;   // item positions sorted by name
+    };
+    //---------------------------------------------------------------------------------------------
+} // namespace amf
+
+#endif // #ifndef AMF_PropertyKeyMap_h
@@ -439,6 +439,7 @@ AMFPropertyInfoImpl& AMFPropertyInfoImpl::operator=(const AMFPropertyInfoImpl& p
 
     this->value = propertyInfo.value;
     this->userModified = propertyInfo.userModified;
+    this->snapshot.Write(this->value);
 
     return *this;
 }
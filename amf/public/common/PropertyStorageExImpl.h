@@ -43,9 +43,11 @@
 #include "InterfaceImpl.h"
 #include "ObservableImpl.h"
 #include "TraceAdapter.h"
+#include "PropertyKeyMap.h"
 #include <limits.h>
 #include <float.h>
 #include <memory>
+#include <atomic>
 
 namespace amf
 {
@@ -54,6 +56,79 @@ namespace amf
         AMF_PROPERTY_CONTENT_TYPE contentType,
         const AMFEnumDescriptionEntry* pEnumDescription = 0);
 
+    //---------------------------------------------------------------------------------------------
+    //---------------------------------------------------------------------------------------------
+    // lock-free copy of a property value for readers of read-mostly storages. Plain values (no string
+    // or interface, which would need a reference) are published under a sequence counter: Read()
+    // retries while a writer is between the two increments and returns false when nothing plain is
+    // published, the caller then copies the value under the storage lock. Write() is called under
+    // the storage lock.
+    class AMFPropertyValueSnapshot
+    {
+    public:
+        AMFPropertyValueSnapshot() : m_Sequence(0), m_Type(-1)
+        {
+            m_Words[0].store(0, std::memory_order_relaxed);
+            m_Words[1].store(0, std::memory_order_relaxed);
+        }
+
+        static bool IsPlain(AMF_VARIANT_TYPE type)
+        {
+            return type != AMF_VARIANT_STRING && type != AMF_VARIANT_WSTRING && type != AMF_VARIANT_INTERFACE;
+        }
+
+        void Write(const AMFVariantStruct& value)
+        {
+            amf_uint64 words[2] = { 0, 0 };
+            amf_int32 type = -1;
+            if (IsPlain(value.type))
+            {
+                type = value.type;
+                memcpy(words, &value.int64Value, PlainSize);
+            }
+            const amf_uint32 sequence = m_Sequence.load(std::memory_order_relaxed);
+            m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_Type.store(type, std::memory_order_relaxed);
+            m_Words[0].store(words[0], std::memory_order_relaxed);
+            m_Words[1].store(words[1], std::memory_order_relaxed);
+            m_Sequence.store(sequence + 2, std::memory_order_release);
+        }
+        bool Read(AMFVariantStruct* pValue) const
+        {
+            amf_int32 type = -1;
+            amf_uint64 words[2] = { 0, 0 };
+            for (;;)
+            {
+                const amf_uint32 sequence = m_Sequence.load(std::memory_order_acquire);
+                type = m_Type.load(std::memory_order_relaxed);
+                words[0] = m_Words[0].load(std::memory_order_relaxed);
+                words[1] = m_Words[1].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if ((sequence & 1) == 0 && m_Sequence.load(std::memory_order_relaxed) == sequence)
+                {
+                    break;
+                }
+            }
+            if (type < 0)
+            {
+                return false;
+            }
+            AMFVariantStruct plain;
+            plain.type = AMF_VARIANT_TYPE(type);
+            memcpy(&plain.int64Value, words, PlainSize);
+            return AMFVariantCopy(pValue, &plain) == AMF_OK;
+        }
+    private:
+        static const size_t PlainSize = 2 * sizeof(amf_uint64); // AMFRect, AMFFloatVector4D
+
+        std::atomic<amf_uint32>     m_Sequence;
+        std::atomic<amf_int32>      m_Type;     // -1 - nothing plain published
+        std::atomic<amf_uint64>     m_Words[2];
+
+        AMFPropertyValueSnapshot(const AMFPropertyValueSnapshot&);
+        AMFPropertyValueSnapshot& operator=(const AMFPropertyValueSnapshot&);
+    };
     //---------------------------------------------------------------------------------------------
     class AMFPropertyInfoImpl : public AMFPropertyInfo
     {
@@ -68,6 +143,8 @@ namespace amf
     public:
         AMFVariant  value;
         amf_bool    userModified = false;
+        // published copy of value for GetProperty(), changes to value go through the storage
+        mutable AMFPropertyValueSnapshot snapshot;
 
     public:
         AMFPropertyInfoImpl(const wchar_t* name, const wchar_t* desc, AMF_VARIANT_TYPE type, AMF_PROPERTY_CONTENT_TYPE contentType,
@@ -86,7 +163,8 @@ namespace amf
         virtual void  OnPropertyChanged() { }
     };
 
-    typedef amf_map<amf_wstring, std::shared_ptr<AMFPropertyInfoImpl> >  PropertyInfoMap;
+    // populated once by the component, lookups after that take no lock
+    typedef AMFPropertyKeyMap<std::shared_ptr<AMFPropertyInfoImpl> >  PropertyInfoMap;
 
     //---------------------------------------------------------------------------------------------
     template<typename _TBase> class AMFPropertyStorageExImpl :
@@ -219,17 +297,13 @@ namespace amf
             AMF_RETURN_IF_FALSE(nameSize != 0, AMF_INVALID_ARG);
             AMF_RETURN_IF_FALSE(index < m_PropertiesInfo.size(), AMF_INVALID_ARG);
 
-            PropertyInfoMap::const_iterator found = m_PropertiesInfo.begin();
-            for (amf_size i = 0; i < index; i++)
-            {
-                found++;
-            }
+            const PropertyInfoMap::value_type& found = m_PropertiesInfo.by_name(index);
 
-            size_t copySize = AMF_MIN(nameSize-1, found->first.length());
-            memcpy(name, found->first.c_str(), copySize * sizeof(wchar_t));
+            size_t copySize = AMF_MIN(nameSize-1, found.first.length());
+            memcpy(name, found.first.c_str(), copySize * sizeof(wchar_t));
             name[copySize] = 0;
             AMFLock lock(const_cast<AMFCriticalSection*>(&m_Sync));
-            AMFVariantCopy(pValue, &found->second->value);
+            AMFVariantCopy(pValue, &found.second->value);
             return AMF_OK;
         }
         //-------------------------------------------------------------------------------------------------
@@ -243,13 +317,7 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(ppParamInfo);
             AMF_RETURN_IF_FALSE(szInd < m_PropertiesInfo.size(), AMF_INVALID_ARG);
 
-            PropertyInfoMap::const_iterator it = m_PropertiesInfo.begin();
-            for (; szInd > 0; --szInd)
-            {
-                it++;
-            }
-
-            *ppParamInfo = it->second.get();
+            *ppParamInfo = m_PropertiesInfo.by_name(szInd).second.get();
             return AMF_OK;
         }
         //-------------------------------------------------------------------------------------------------
@@ -428,6 +496,7 @@ namespace amf
                     return AMF_OK;
                 }
                 found->second->value = validatedValue;
+                found->second->snapshot.Write(found->second->value);
             }
             found->second->OnPropertyChanged();
             OnPropertyChanged(name);
@@ -444,8 +513,17 @@ namespace amf
             PropertyInfoMap::const_iterator found = m_PropertiesInfo.find(name);
             if (found != m_PropertiesInfo.end())
             {
+                if (found->second->snapshot.Read(pValue))
+                {
+                    return AMF_OK;
+                }
                 AMFLock lock(const_cast<AMFCriticalSection*>(&m_Sync));
                 AMFVariantCopy(pValue, &found->second->value);
+                // publish values set before the storage existed, the next read takes no lock
+                if (AMFPropertyValueSnapshot::IsPlain(found->second->value.type))
+                {
+                    found->second->snapshot.Write(found->second->value);
+                }
                 return AMF_OK;
             }
 
@@ -502,6 +580,7 @@ namespace amf
 
                 info->value = info->defaultValue;
                 info->userModified = false;
+                info->snapshot.Write(info->value);
             }
         }
         //-------------------------------------------------------------------------------------------------
@@ -42,6 +42,7 @@
 #include "InterfaceImpl.h"
 #include "ObservableImpl.h"
 #include "TraceAdapter.h"
+#include "PropertyKeyMap.h"
 
 namespace amf
 {
@@ -80,8 +81,7 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(pName);
             AMF_RETURN_IF_INVALID_POINTER(pValue);
 
-            amf_wstring name(pName);
-            amf_map<amf_wstring, AMFVariant>::const_iterator found = m_PropertyValues.find(name);
+            AMFPropertyKeyMap<AMFVariant>::const_iterator found = m_PropertyValues.find(pName);
             if(found != m_PropertyValues.end())
             {
                 AMFVariantCopy(pValue, &found->second);
@@ -106,23 +106,15 @@ namespace amf
             AMF_RETURN_IF_INVALID_POINTER(pName);
             AMF_RETURN_IF_INVALID_POINTER(pValue);
             AMF_RETURN_IF_FALSE(nameSize != 0, AMF_INVALID_ARG);
-            amf_map<amf_wstring, AMFVariant>::const_iterator found = m_PropertyValues.begin();
-            if(found == m_PropertyValues.end())
+            if(index >= m_PropertyValues.size())
             {
                 return AMF_INVALID_ARG;
             }
-            for( amf_size i = 0; i < index; i++)
-            {
-                found++;
-                if(found == m_PropertyValues.end())
-                {
-                    return AMF_INVALID_ARG;
-                }
-            }
-            size_t copySize = AMF_MIN(nameSize-1, found->first.length());
-            memcpy(pName, found->first.c_str(), copySize * sizeof(wchar_t));
+            const AMFPropertyKeyMap<AMFVariant>::value_type& found = m_PropertyValues.by_name(index);
+            size_t copySize = AMF_MIN(nameSize-1, found.first.length());
+            memcpy(pName, found.first.c_str(), copySize * sizeof(wchar_t));
             pName[copySize] = 0;
-            AMFVariantCopy(pValue, &found->second);
+            AMFVariantCopy(pValue, &found.second);
             return AMF_OK;
         }
         //-------------------------------------------------------------------------------------------------
@@ -136,7 +128,7 @@ namespace amf
         {
             AMF_RETURN_IF_INVALID_POINTER(pDest);
             AMF_RESULT err = AMF_OK;
-            amf_map<amf_wstring, AMFVariant>::const_iterator it = m_PropertyValues.begin();
+            AMFPropertyKeyMap<AMFVariant>::const_iterator it = m_PropertyValues.begin();
 
             for(; it != m_PropertyValues.end(); it++)
             {
@@ -186,7 +178,7 @@ namespace amf
         //-------------------------------------------------------------------------------------------------
     protected:
         //-------------------------------------------------------------------------------------------------
-        amf_map<amf_wstring, AMFVariant> m_PropertyValues;
+        AMFPropertyKeyMap<AMFVariant> m_PropertyValues;
     };
     //---------------------------------------------------------------------------------------------
     //---------------------------------------------------------------------------------------------
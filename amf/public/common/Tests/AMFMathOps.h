@@ -0,0 +1,144 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Array wrappers of the AMFMath operations under test. Included once by AMFMathTest.cpp for the
+// SIMD build and once by AMFMathScalar.cpp for the scalar reference, each time into its own
+// namespace, so there is no include guard.
+
+namespace AMF_MATH_OPS_NAMESPACE
+{
+    inline amf::VectorPOD LoadVector(const float* p)
+    {
+        amf::VectorPOD v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    inline void StoreVector(float* p, const amf::VectorPOD& v)
+    {
+        memcpy(p, &v, sizeof(v));
+    }
+    inline amf::Matrix LoadMatrix(const float* p)
+    {
+        return amf::Matrix(const_cast<float*>(p));
+    }
+    inline void StoreMatrix(float* p, const amf::Matrix& m)
+    {
+        memcpy(p, m.k, sizeof(m.k));
+    }
+
+    #define AMF_MATH_VECTOR_OP(name, expr) \
+        void name(const float* pA, const float* pB, float* pOut, size_t count) \
+        { \
+            for (size_t i = 0; i < count; i++) \
+            { \
+                const amf::VectorPOD a = LoadVector(pA + i * 4); \
+                const amf::VectorPOD b = LoadVector(pB + i * 4); \
+                (void)b; \
+                StoreVector(pOut + i * 4, expr); \
+            } \
+        }
+
+    AMF_MATH_VECTOR_OP(Add,         a + b)
+    AMF_MATH_VECTOR_OP(Sub,         a - b)
+    AMF_MATH_VECTOR_OP(Mul,         a * b)
+    AMF_MATH_VECTOR_OP(Dot3,        a.Dot3(b))
+    AMF_MATH_VECTOR_OP(Dot4,        a.Dot4(b))
+    AMF_MATH_VECTOR_OP(Sqrt,        (a * a).Sqrt())
+    AMF_MATH_VECTOR_OP(Length3,     a.Length3())
+    AMF_MATH_VECTOR_OP(Normalize3,  a.Normalize3())
+    AMF_MATH_VECTOR_OP(Cross3,      a.Cross3(b))
+    AMF_MATH_VECTOR_OP(Negate,      a.Negate())
+    AMF_MATH_VECTOR_OP(MergeXY,     a.MergeXY(b))
+    AMF_MATH_VECTOR_OP(MergeZW,     a.MergeZW(b))
+    AMF_MATH_VECTOR_OP(Reciprocal,  amf::Vector(a).Reciprocal())
+    AMF_MATH_VECTOR_OP(QuaternionMul, amf::Quaternion(a.x, a.y, a.z, a.w) * amf::Quaternion(b.x, b.y, b.z, b.w))
+
+    #undef AMF_MATH_VECTOR_OP
+
+    void MatrixMul(const float* pA, const float* pB, float* pOut, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            StoreMatrix(pOut + i * 16, LoadMatrix(pA + i * 16) * LoadMatrix(pB + i * 16));
+        }
+    }
+    void MatrixVector(const float* pA, const float* pB, float* pOut, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            StoreVector(pOut + i * 4, LoadMatrix(pA + i * 16) * amf::Vector(LoadVector(pB + i * 4)));
+        }
+    }
+    void Transpose(const float* pA, const float*, float* pOut, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            StoreMatrix(pOut + i * 16, LoadMatrix(pA + i * 16).Transpose());
+        }
+    }
+    void Inverse(const float* pA, const float*, float* pOut, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            StoreMatrix(pOut + i * 16, LoadMatrix(pA + i * 16).Inverse(NULL));
+        }
+    }
+    void Transform(const float* pA, const float* pB, float* pOut, size_t count)
+    {
+        LoadMatrix(pA).Transform(reinterpret_cast<const amf::VectorPOD*>(pB), reinterpret_cast<amf::VectorPOD*>(pOut), count);
+    }
+
+    const MathOp s_MathOps[] =
+    {
+        { "Add",            4,  4,  4,  false,  MATH_OP_EXACT,      Add },
+        { "Sub",            4,  4,  4,  false,  MATH_OP_EXACT,      Sub },
+        { "Mul",            4,  4,  4,  false,  MATH_OP_EXACT,      Mul },
+        { "Dot3",           4,  4,  4,  false,  MATH_OP_EXACT,      Dot3 },
+        { "Dot4",           4,  4,  4,  false,  MATH_OP_EXACT,      Dot4 },
+        { "Sqrt",           4,  0,  4,  false,  MATH_OP_EXACT,      Sqrt },
+        { "Length3",        4,  0,  4,  false,  MATH_OP_EXACT,      Length3 },
+        { "Normalize3",     4,  0,  4,  false,  MATH_OP_EXACT,      Normalize3 },
+        { "Cross3",         4,  4,  4,  false,  MATH_OP_EXACT,      Cross3 },
+        { "Negate",         4,  0,  4,  false,  MATH_OP_EXACT,      Negate },
+        { "MergeXY",        4,  4,  4,  false,  MATH_OP_EXACT,      MergeXY },
+        { "MergeZW",        4,  4,  4,  false,  MATH_OP_EXACT,      MergeZW },
+        { "Reciprocal",     4,  0,  4,  false,  MATH_OP_EXACT,      Reciprocal },
+        { "Quaternion*",    4,  4,  4,  false,  MATH_OP_EXACT,      QuaternionMul },
+        { "Matrix*Matrix",  16, 16, 16, false,  MATH_OP_EXACT,      MatrixMul },
+        { "Matrix*Vector",  16, 4,  4,  false,  MATH_OP_EXACT,      MatrixVector },
+        { "Transpose",      16, 0,  16, false,  MATH_OP_EXACT,      Transpose },
+        { "Inverse",        16, 0,  16, false,  MATH_OP_INVERSE,    Inverse },
+        { "Transform",      16, 4,  4,  true,   MATH_OP_TRANSFORM,  Transform },
+    };
+}
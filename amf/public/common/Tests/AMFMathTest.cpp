@@ -0,0 +1,254 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "CommonTests.h"
+#include "AMFMathTest.h"
+#include "public/common/AMFMath.h"
+#include "public/common/AMFSTL.h"
+#include "public/common/Thread.h"
+#include <algorithm>
+#include <float.h>
+
+#define AMF_MATH_OPS_NAMESPACE MathSIMD
+#include "AMFMathOps.h"
+
+using namespace amf;
+
+const MathOp* GetSIMDMathOps(size_t* pCount)
+{
+    *pCount = sizeof(MathSIMD::s_MathOps) / sizeof(MathSIMD::s_MathOps[0]);
+    return MathSIMD::s_MathOps;
+}
+
+namespace
+{
+    const size_t CONFORMANCE_COUNT  = 20003;    // odd, so the batch kernels run their tails
+    const size_t BENCHMARK_COUNT    = 4096;
+
+    // magnitudes in [0.25, 4] with either sign: no zero divisors, no denormals or overflow
+    void FillRandom(amf_vector<float>& buffer, amf_uint32& seed)
+    {
+        for (size_t i = 0; i < buffer.size(); i++)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            const float magnitude = 0.25f + 3.75f * float(seed >> 8) / float(1 << 24);
+            buffer[i] = (seed & 1) ? -magnitude : magnitude;
+        }
+    }
+
+    // max |M * inv - I| over ||M|| * ||inv||, in double
+    double InverseResidual(const float* pM, const float* pInv)
+    {
+        double residual = 0.0;
+        double normM = 0.0;
+        double normInv = 0.0;
+        for (int row = 0; row < 4; row++)
+        {
+            double sumM = 0.0;
+            double sumInv = 0.0;
+            for (int col = 0; col < 4; col++)
+            {
+                double value = 0.0;
+                for (int k = 0; k < 4; k++)
+                {
+                    value += double(pM[row * 4 + k]) * double(pInv[k * 4 + col]);
+                }
+                residual = std::max(residual, fabs(value - (row == col ? 1.0 : 0.0)));
+                sumM += fabs(pM[row * 4 + col]);
+                sumInv += fabs(pInv[row * 4 + col]);
+            }
+            normM = std::max(normM, sumM);
+            normInv = std::max(normInv, sumInv);
+        }
+        return residual / (normM * normInv);
+    }
+
+    // |result - exact| over the sum of the term magnitudes, worst component
+    double TransformError(const float* pM, const float* pV, const float* pResult)
+    {
+        double error = 0.0;
+        for (int c = 0; c < 4; c++)
+        {
+            double exact = pM[12 + c];
+            double magnitude = fabs(pM[12 + c]);
+            for (int k = 0; k < 3; k++)
+            {
+                exact += double(pV[k]) * pM[k * 4 + c];
+                magnitude += fabs(double(pV[k]) * pM[k * 4 + c]);
+            }
+            error = std::max(error, fabs(pResult[c] - exact) / magnitude);
+        }
+        return error;
+    }
+
+    double Percentile(amf_vector<double>& values, double fraction)
+    {
+        std::sort(values.begin(), values.end());
+        return values[size_t(fraction * (values.size() - 1))];
+    }
+
+    struct MathOpData
+    {
+        amf_vector<float> a;
+        amf_vector<float> b;
+        amf_vector<float> out;
+
+        MathOpData(const MathOp& op, size_t count, amf_uint32& seed) :
+            a(op.bSharedA ? op.aFloats : op.aFloats * count),
+            b(std::max<size_t>(op.bFloats * count, 1)),
+            out(op.outFloats * count)
+        {
+            FillRandom(a, seed);
+            FillRandom(b, seed);
+        }
+    };
+
+    int CheckMathOp(const MathOp& scalar, const MathOp& simd, amf_uint32& seed)
+    {
+        int failures = 0;
+        const size_t count = CONFORMANCE_COUNT;
+        MathOpData data(scalar, count, seed);
+        amf_vector<float> reference(data.out.size());
+        scalar.Run(data.a.data(), data.b.data(), reference.data(), count);
+        simd.Run(data.a.data(), data.b.data(), data.out.data(), count);
+
+        switch (scalar.eCheck)
+        {
+        case MATH_OP_EXACT:
+        {
+            size_t mismatches = 0;
+            size_t first = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (memcmp(&reference[i * scalar.outFloats], &data.out[i * scalar.outFloats], scalar.outFloats * sizeof(float)) != 0)
+                {
+                    first = mismatches == 0 ? i : first;
+                    mismatches++;
+                }
+            }
+            TEST_CHECK(mismatches == 0, "AMFMath %s: %d of %d results differ from the scalar reference, first at %d",
+                scalar.pName, (int)mismatches, (int)count, (int)first);
+            break;
+        }
+        case MATH_OP_INVERSE:
+        {
+            amf_vector<double> residualScalar(count);
+            amf_vector<double> residualSIMD(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                residualScalar[i] = InverseResidual(&data.a[i * 16], &reference[i * 16]);
+                residualSIMD[i] = InverseResidual(&data.a[i * 16], &data.out[i * 16]);
+            }
+            // the SIMD form rounds differently, its accuracy has to match the reference
+            const double medianScalar = Percentile(residualScalar, 0.5);
+            const double medianSIMD = Percentile(residualSIMD, 0.5);
+            const double tailScalar = Percentile(residualScalar, 0.9999);
+            const double tailSIMD = Percentile(residualSIMD, 0.9999);
+            TEST_CHECK(medianSIMD <= 2.0 * medianScalar && medianSIMD < 16 * FLT_EPSILON, "AMFMath %s: median residual %g, scalar %g",
+                scalar.pName, medianSIMD, medianScalar);
+            TEST_CHECK(tailSIMD <= 2.0 * tailScalar, "AMFMath %s: 99.99%% residual %g, scalar %g", scalar.pName, tailSIMD, tailScalar);
+            break;
+        }
+        case MATH_OP_TRANSFORM:
+        {
+            double errorScalar = 0.0;
+            double errorSIMD = 0.0;
+            for (size_t i = 0; i < count; i++)
+            {
+                errorScalar = std::max(errorScalar, TransformError(data.a.data(), &data.b[i * 4], &reference[i * 4]));
+                errorSIMD = std::max(errorSIMD, TransformError(data.a.data(), &data.b[i * 4], &data.out[i * 4]));
+            }
+            TEST_CHECK(errorScalar <= 4 * FLT_EPSILON && errorSIMD <= 4 * FLT_EPSILON, "AMFMath %s: max error %g, scalar %g",
+                scalar.pName, errorSIMD, errorScalar);
+            break;
+        }
+        }
+        return failures;
+    }
+
+    // best of 7 runs, each runs the op 64 times over the arrays
+    double MeasureMathOp(const MathOp& op, MathOpData& data)
+    {
+        double best = 0.0;
+        for (int run = 0; run < 7; run++)
+        {
+            const amf_pts start = amf_high_precision_clock();
+            for (int i = 0; i < 64; i++)
+            {
+                op.Run(data.a.data(), data.b.data(), data.out.data(), BENCHMARK_COUNT);
+            }
+            const double ns = double(amf_high_precision_clock() - start) * 100.0 / (64.0 * BENCHMARK_COUNT);
+            best = (run == 0 || ns < best) ? ns : best;
+        }
+        return best;
+    }
+}
+
+int TestAMFMath()
+{
+    int failures = 0;
+    size_t scalarCount = 0;
+    size_t simdCount = 0;
+    const MathOp* pScalar = GetScalarMathOps(&scalarCount);
+    const MathOp* pSIMD = GetSIMDMathOps(&simdCount);
+    TEST_CHECK(scalarCount == simdCount, "AMFMath: %d scalar and %d SIMD ops", (int)scalarCount, (int)simdCount);
+
+    amf_uint32 seed = 0x2545f491;
+    for (size_t i = 0; i < scalarCount && i < simdCount; i++)
+    {
+        failures += CheckMathOp(pScalar[i], pSIMD[i], seed);
+    }
+    return failures;
+}
+
+void BenchmarkAMFMath()
+{
+    size_t scalarCount = 0;
+    size_t simdCount = 0;
+    const MathOp* pScalar = GetScalarMathOps(&scalarCount);
+    const MathOp* pSIMD = GetSIMDMathOps(&simdCount);
+
+    amf_uint32 seed = 0x9e3779b9;
+    printf("AMFMath benchmark, ns per op over %d-element arrays\n", (int)BENCHMARK_COUNT);
+    printf("%-16s %10s %10s\n", "op", "scalar", "SIMD");
+    for (size_t i = 0; i < scalarCount && i < simdCount; i++)
+    {
+        MathOpData data(pScalar[i], BENCHMARK_COUNT, seed);
+        const double scalar = MeasureMathOp(pScalar[i], data);
+        const double simd = MeasureMathOp(pSIMD[i], data);
+        printf("%-16s %10.2f %10.2f (%4.1fx)\n", pScalar[i].pName, scalar, simd, scalar / simd);
+    }
+}
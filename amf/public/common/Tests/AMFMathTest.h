@@ -0,0 +1,63 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <stddef.h>
+
+// how the SIMD result is compared with the scalar reference
+enum MATH_OP_CHECK
+{
+    MATH_OP_EXACT       = 0,    // bit for bit
+    MATH_OP_INVERSE,            // residual of M * inverse(M) in the range of the reference
+    MATH_OP_TRANSFORM,          // FMA rounding, within a few ulp of the sum of term magnitudes
+};
+
+// an AMFMath operation over arrays: pA and pB hold count items of aFloats and bFloats (a single
+// item of pA when bSharedA), pOut receives count items of outFloats
+struct MathOp
+{
+    const char*     pName;
+    size_t          aFloats;
+    size_t          bFloats;
+    size_t          outFloats;
+    bool            bSharedA;
+    MATH_OP_CHECK   eCheck;
+    void            (*Run)(const float* pA, const float* pB, float* pOut, size_t count);
+};
+
+// AMFMathScalar.cpp - AMFMath.h built with AMF_MATH_SCALAR
+const MathOp* GetScalarMathOps(size_t* pCount);
+// AMFMathTest.cpp - AMFMath.h as every other includer builds it
+const MathOp* GetSIMDMathOps(size_t* pCount);
@@ -0,0 +1,234 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#include "CommonTests.h"
+#include "public/common/ByteArray.h"
+#include "public/common/Thread.h"
+#include "public/common/AMFSTL.h"
+#include <vector>
+
+namespace
+{
+    // the AMFByteArray before geometric growth: 1 KB steps, every step zeroes and copies the whole array
+    class LegacyByteArray
+    {
+    public:
+        LegacyByteArray() : m_pData(NULL), m_iSize(0), m_iMaxSize(0) {}
+        ~LegacyByteArray() { delete[] m_pData; }
+        void SetSize(amf_size num)
+        {
+            if (num == m_iSize)
+            {
+                return;
+            }
+            if (num < m_iSize)
+            {
+                memset(m_pData + num, 0, m_iMaxSize - num);
+            }
+            else if (num > m_iMaxSize)
+            {
+                m_iMaxSize = (num / INIT_ARRAY_SIZE) * INIT_ARRAY_SIZE + INIT_ARRAY_SIZE;
+                amf_uint8 *pNewData = new amf_uint8[m_iMaxSize];
+                memset(pNewData, 0, m_iMaxSize);
+                if (m_pData != NULL)
+                {
+                    memcpy(pNewData, m_pData, m_iSize);
+                    delete[] m_pData;
+                }
+                m_pData = pNewData;
+            }
+            m_iSize = num;
+        }
+        // the parsers moved the remainder to the front after every access unit
+        void Consume(amf_size num)
+        {
+            memmove(m_pData, m_pData + num, m_iSize - num);
+            SetSize(m_iSize - num);
+        }
+        amf_uint8 *GetData() const { return m_pData; }
+        amf_size GetSize() const { return m_iSize; }
+    private:
+        amf_uint8 *m_pData;
+        amf_size  m_iSize;
+        amf_size  m_iMaxSize;
+    };
+
+    amf_uint8 Pattern(amf_size pos)
+    {
+        return amf_uint8(pos * 7 + (pos >> 8));
+    }
+
+    // the bitstream parser access pattern: the stream is appended in small reads until the buffer holds
+    // an access unit, then the access unit is dropped from the front; returns false if data was lost
+    template<typename _TArray>
+    bool ParseStream(_TArray& data, amf_size accessUnitSize, amf_size readSize, amf_size totalSize)
+    {
+        amf_size written = 0;
+        amf_size consumed = 0;
+        while (consumed < totalSize)
+        {
+            while (data.GetSize() < accessUnitSize)
+            {
+                const amf_size pos = data.GetSize();
+                data.SetSize(pos + readSize);
+                amf_uint8 *pDst = data.GetData() + pos;
+                for (amf_size i = 0; i < readSize; i += 512)
+                {
+                    pDst[i] = Pattern(written + i);
+                }
+                written += readSize;
+            }
+            const amf_size check = (512 - consumed % 512) % 512; // first marked byte of the access unit
+            if (data.GetData()[check] != Pattern(consumed + check))
+            {
+                return false;
+            }
+            data.Consume(accessUnitSize);
+            consumed += accessUnitSize;
+        }
+        return true;
+    }
+
+    // random SetSize/Consume/Reserve against std::vector, data has to survive every reallocation and compaction
+    int TestAgainstVector()
+    {
+        int failures = 0;
+        AMFByteArray array;
+        std::vector<amf_uint8> reference;
+        amf_uint32 seed = 12345;
+        amf_uint8 next = 0;
+        for (int step = 0; step < 20000 && failures == 0; step++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            const amf_size arg = (seed >> 8) % 5000;
+            switch (seed % 4)
+            {
+            case 0:
+            case 1:
+                {
+                    const amf_size pos = array.GetSize();
+                    array.SetSize(pos + arg);
+                    for (amf_size i = 0; i < arg; i++)
+                    {
+                        array[pos + i] = next;
+                        reference.push_back(next++);
+                    }
+                }
+                break;
+            case 2:
+                array.Consume(arg);
+                reference.erase(reference.begin(), reference.begin() + (arg < reference.size() ? arg : reference.size()));
+                break;
+            case 3:
+                array.Reserve(array.GetSize() + arg);
+                TEST_CHECK(array.GetCapacity() >= array.GetSize() + arg, "Reserve(%d) left capacity %d", int(array.GetSize() + arg), int(array.GetCapacity()));
+                break;
+            }
+            TEST_CHECK(array.GetSize() == reference.size(), "step %d: size %d, expected %d", step, int(array.GetSize()), int(reference.size()));
+            if (failures == 0 && reference.size() > 0)
+            {
+                TEST_CHECK(memcmp(array.GetData(), &reference[0], reference.size()) == 0, "step %d: data differs", step);
+            }
+        }
+        return failures;
+    }
+
+    int TestCopyAndMove()
+    {
+        int failures = 0;
+        AMFByteArray source(3000);
+        for (amf_size i = 0; i < source.GetSize(); i++)
+        {
+            source[i] = Pattern(i);
+        }
+        source.Consume(1000);
+
+        AMFByteArray copy(source);
+        TEST_CHECK(copy.GetSize() == 2000 && copy[0] == Pattern(1000) && copy[1999] == Pattern(2999), "copy of a consumed array");
+
+        AMFByteArray moved(std::move(copy));
+        TEST_CHECK(copy.GetSize() == 0 && copy.GetData() == NULL, "moved-from array is not empty");
+        TEST_CHECK(moved.GetSize() == 2000 && moved[0] == Pattern(1000), "move construction lost data");
+
+        AMFByteArray assigned;
+        assigned = std::move(moved);
+        TEST_CHECK(moved.GetSize() == 0 && assigned.GetSize() == 2000 && assigned[1999] == Pattern(2999), "move assignment lost data");
+
+        // consuming everything resets the head, the whole allocation is usable again without a reallocation
+        const amf_uint8 *pData = source.GetData() - 1000;
+        source.Consume(2000);
+        source.SetSize(3000);
+        TEST_CHECK(source.GetData() == pData, "SetSize() after a full Consume() reallocated");
+        return failures;
+    }
+}
+
+int TestByteArray()
+{
+    int failures = 0;
+    failures += TestAgainstVector();
+    failures += TestCopyAndMove();
+
+    AMFByteArray array;
+    TEST_CHECK(ParseStream(array, 256 * 1024 + 100, 4096, 16 * 1024 * 1024), "parser pattern lost data");
+    return failures;
+}
+
+void BenchmarkByteArray()
+{
+    // 400 MB of stream read 4 KB at a time
+    static const amf_size readSize = 4096;
+    static const amf_size totalSize = amf_size(400) * 1024 * 1024;
+    static const amf_size accessUnitSizes[] = { 64 * 1024, 2 * 1024 * 1024, 8 * 1024 * 1024 };
+
+    printf("AMFByteArray parser pattern, %d MB in %d byte reads, ms\n", int(totalSize >> 20), int(readSize));
+    printf("%-44s %10s %10s\n", "", "1 KB steps", "current");
+    for (size_t i = 0; i < amf_countof(accessUnitSizes); i++)
+    {
+        LegacyByteArray legacy;
+        amf_pts start = amf_high_precision_clock();
+        ParseStream(legacy, accessUnitSizes[i], readSize, totalSize);
+        const double legacyMs = double(amf_high_precision_clock() - start) / double(AMF_MILLISECOND);
+
+        AMFByteArray array;
+        start = amf_high_precision_clock();
+        ParseStream(array, accessUnitSizes[i], readSize, totalSize);
+        const double currentMs = double(amf_high_precision_clock() - start) / double(AMF_MILLISECOND);
+
+        char name[64];
+        snprintf(name, sizeof(name), "access unit %d KB", int(accessUnitSizes[i] >> 10));
+        printf("%-44s %10.1f %10.1f\n", name, legacyMs, currentMs);
+    }
+}
@@ -0,0 +1,367 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#include "CommonTests.h"
+#include "public/common/DataStream.h"
+#include "public/common/DataStreamMemory.h"
+#include "public/common/DataStreamReadAhead.h"
+#include "public/common/InterfaceImpl.h"
+#include <stdlib.h>
+#include "public/common/Thread.h"
+#include "public/common/AMFSTL.h"
+
+using namespace amf;
+
+namespace
+{
+    // MPEG-TS packet size, the typical write of a muxer into a memory stream
+    static const amf_size s_AppendWriteSize = 188;
+
+    amf_uint8 Pattern(amf_size pos)
+    {
+        return amf_uint8(pos * 13 + (pos >> 10));
+    }
+
+    // appends totalSize bytes in writeSize writes, the data follows Pattern()
+    void Append(AMFDataStream* pStream, amf_size writeSize, amf_size totalSize)
+    {
+        amf_vector<amf_uint8> data(writeSize);
+        for (amf_size pos = 0; pos < totalSize; pos += writeSize)
+        {
+            const amf_size size = AMF_MIN(writeSize, totalSize - pos);
+            for (amf_size i = 0; i < size; i++)
+            {
+                data[i] = Pattern(pos + i);
+            }
+            amf_size written = 0;
+            pStream->Write(&data[0], size, &written);
+        }
+    }
+
+    int CheckContent(const char* pWhat, AMFDataStream* pStream, amf_size totalSize)
+    {
+        int failures = 0;
+        amf_int64 size = 0;
+        pStream->GetSize(&size);
+        TEST_CHECK(size == amf_int64(totalSize), "%s: size %d, expected %d", pWhat, int(size), int(totalSize));
+
+        // odd read size so reads straddle the chunk boundaries
+        amf_vector<amf_uint8> data(100003);
+        pStream->Seek(AMF_SEEK_BEGIN, 0, NULL);
+        for (amf_size pos = 0; pos < totalSize && failures == 0; )
+        {
+            amf_size read = 0;
+            pStream->Read(&data[0], data.size(), &read);
+            TEST_CHECK(read == AMF_MIN(data.size(), totalSize - pos), "%s: read %d bytes at %d", pWhat, int(read), int(pos));
+            for (amf_size i = 0; i < read && failures == 0; i++)
+            {
+                TEST_CHECK(data[i] == Pattern(pos + i), "%s: byte %d differs", pWhat, int(pos + i));
+            }
+            pos += read;
+            if (read == 0)
+            {
+                break;
+            }
+        }
+        return failures;
+    }
+
+    int TestMemoryStream(const wchar_t* pUrl, bool bChunked)
+    {
+        int failures = 0;
+        const amf_size totalSize = AMF_DATA_STREAM_MEMORY_CHUNK_SIZE * 3 + 1000;
+        char what[64];
+        snprintf(what, sizeof(what), "%S", pUrl);
+
+        AMFDataStreamPtr pStream;
+        AMFDataStream::OpenDataStream(pUrl, AMFSO_READ_WRITE, AMFFS_EXCLUSIVE, &pStream);
+        TEST_CHECK(pStream != NULL, "%s: OpenDataStream() failed", what);
+        if (pStream == NULL)
+        {
+            return failures;
+        }
+        Append(pStream, s_AppendWriteSize, totalSize);
+        failures += CheckContent(what, pStream, totalSize);
+
+        // a view stops at the chunk boundary only in chunked mode
+        AMFDataStreamViewPtr pView(pStream);
+        TEST_CHECK(pView != NULL, "%s: no AMFDataStreamView", what);
+        if (pView != NULL)
+        {
+            const void* pData = NULL;
+            amf_size viewSize = 0;
+            const amf_int64 offset = AMF_DATA_STREAM_MEMORY_CHUNK_SIZE - 100;
+            pView->GetView(offset, 1000, &pData, &viewSize);
+            TEST_CHECK(viewSize == (bChunked ? 100 : 1000), "%s: view of %d bytes, expected %d", what, int(viewSize), bChunked ? 100 : 1000);
+            TEST_CHECK(pData != NULL && ((const amf_uint8*)pData)[0] == Pattern(amf_size(offset)), "%s: view data differs", what);
+        }
+        return failures;
+    }
+
+    // the memory stream before geometric growth: every extending write reallocated to the exact size
+    class LegacyMemoryStream
+    {
+    public:
+        LegacyMemoryStream() : m_pMemory(NULL), m_uiMemorySize(0) {}
+        ~LegacyMemoryStream() { amf_virtual_free(m_pMemory); }
+        void Write(const void* pData, amf_size iSize)
+        {
+            amf_uint8* pNewMemory = (amf_uint8*)amf_virtual_alloc(m_uiMemorySize + iSize);
+            if (m_pMemory != NULL)
+            {
+                memcpy(pNewMemory, m_pMemory, m_uiMemorySize);
+                amf_virtual_free(m_pMemory);
+            }
+            m_pMemory = pNewMemory;
+            memcpy(m_pMemory + m_uiMemorySize, pData, iSize);
+            m_uiMemorySize += iSize;
+        }
+    private:
+        amf_uint8* m_pMemory;
+        amf_size m_uiMemorySize;
+    };
+
+    double AppendMBps(const wchar_t* pUrl, amf_size totalSize)
+    {
+        AMFDataStreamPtr pStream;
+        AMFDataStream::OpenDataStream(pUrl, AMFSO_READ_WRITE, AMFFS_EXCLUSIVE, &pStream);
+        const amf_pts start = amf_high_precision_clock();
+        Append(pStream, s_AppendWriteSize, totalSize);
+        const amf_pts elapsed = amf_high_precision_clock() - start;
+        return double(totalSize) / (1024.0 * 1024.0) * double(AMF_SECOND) / double(elapsed);
+    }
+
+    static const wchar_t* s_ReadAheadFile = L"amf-common-tests-readahead.bin";
+
+    bool CreateTestFile(amf_size totalSize)
+    {
+        AMFDataStreamPtr pFile;
+        AMFDataStream::OpenDataStream(s_ReadAheadFile, AMFSO_WRITE, AMFFS_EXCLUSIVE, &pFile);
+        if (pFile == NULL)
+        {
+            return false;
+        }
+        Append(pFile, 1024 * 1024, totalSize);
+        return true;
+    }
+
+    void RemoveTestFile()
+    {
+        remove(amf_from_unicode_to_utf8(s_ReadAheadFile).c_str());
+    }
+
+    // file stream behind a slow link: every Read() pays a fixed latency, like on a network file system
+    class SlowStream : public AMFInterfaceImpl<AMFDataStream>
+    {
+    public:
+        SlowStream(AMFDataStream* pStream, amf_uint32 latencyMs) : m_pStream(pStream), m_latencyMs(latencyMs) {}
+
+        virtual AMF_RESULT AMF_STD_CALL Open(const wchar_t* /*pFileUrl*/, AMF_STREAM_OPEN /*eOpenType*/, AMF_FILE_SHARE /*eShareType*/) { return AMF_NOT_SUPPORTED; }
+        virtual AMF_RESULT AMF_STD_CALL Close() { return m_pStream->Close(); }
+        virtual AMF_RESULT AMF_STD_CALL Read(void* pData, amf_size iSize, amf_size* pRead)
+        {
+            amf_sleep(m_latencyMs);
+            return m_pStream->Read(pData, iSize, pRead);
+        }
+        virtual AMF_RESULT AMF_STD_CALL Write(const void* /*pData*/, amf_size /*iSize*/, amf_size* /*pWritten*/) { return AMF_ACCESS_DENIED; }
+        virtual AMF_RESULT AMF_STD_CALL Seek(AMF_SEEK_ORIGIN eOrigin, amf_int64 iPosition, amf_int64* pNewPosition) { return m_pStream->Seek(eOrigin, iPosition, pNewPosition); }
+        virtual AMF_RESULT AMF_STD_CALL GetPosition(amf_int64* pPosition) { return m_pStream->GetPosition(pPosition); }
+        virtual AMF_RESULT AMF_STD_CALL GetSize(amf_int64* pSize) { return m_pStream->GetSize(pSize); }
+        virtual bool       AMF_STD_CALL IsSeekable() { return m_pStream->IsSeekable(); }
+    private:
+        AMFDataStreamPtr m_pStream;
+        amf_uint32       m_latencyMs;
+    };
+
+    // Read() returns the whole request unless the stream ends, on both streams
+    AMF_RESULT ReadFully(AMFDataStream* pStream, amf_uint8* pData, amf_size size, amf_size* pRead)
+    {
+        amf_size done = 0;
+        AMF_RESULT res = AMF_OK;
+        while (done < size && res == AMF_OK)
+        {
+            amf_size read = 0;
+            res = pStream->Read(pData + done, size - done, &read);
+            done += read;
+        }
+        *pRead = done;
+        return done > 0 ? AMF_OK : res;
+    }
+
+    // random reads and seeks give the same data through the read-ahead stream as through the file
+    int TestReadAheadSeek(amf_size totalSize)
+    {
+        int failures = 0;
+        AMFDataStreamPtr pFile;
+        AMFDataStream::OpenDataStream(s_ReadAheadFile, AMFSO_READ, AMFFS_SHARE_READ, &pFile);
+        // small buffers so the reads and seeks cross buffer boundaries and run past the prefetched range
+        AMFDataStreamReadAheadImpl* pReadAheadImpl = new AMFDataStreamReadAheadImpl(3, 64 * 1024);
+        AMFDataStreamPtr pReadAhead(pReadAheadImpl);
+        pReadAhead->Open(s_ReadAheadFile, AMFSO_READ, AMFFS_SHARE_READ);
+        TEST_CHECK(pFile != NULL, "failed to open the test file");
+        if (pFile == NULL)
+        {
+            return failures;
+        }
+
+        amf_vector<amf_uint8> expected(300 * 1024);
+        amf_vector<amf_uint8> data(300 * 1024);
+        amf_uint32 seed = 4321;
+        for (int step = 0; step < 5000 && failures == 0; step++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            if (seed % 4 == 0)
+            {
+                // mostly near the current position, sometimes anywhere or past the end
+                amf_int64 position = 0;
+                pFile->GetPosition(&position);
+                const amf_int64 target = (seed >> 8) % 8 == 0 ? amf_int64((seed >> 4) % (totalSize + 1000)) :
+                    AMF_MAX(amf_int64(0), position + amf_int64((seed >> 8) % (256 * 1024)) - 128 * 1024);
+                amf_int64 fileNew = -1;
+                amf_int64 readAheadNew = -2;
+                pFile->Seek(AMF_SEEK_BEGIN, target, &fileNew);
+                pReadAhead->Seek(AMF_SEEK_BEGIN, target, &readAheadNew);
+                TEST_CHECK(fileNew == readAheadNew, "step %d: Seek(%d) went to %d and %d", step, int(target), int(fileNew), int(readAheadNew));
+            }
+            else
+            {
+                const amf_size size = 1 + (seed >> 8) % expected.size();
+                amf_size fileRead = 0;
+                amf_size readAheadRead = 0;
+                const AMF_RESULT fileRes = ReadFully(pFile, &expected[0], size, &fileRead);
+                const AMF_RESULT readAheadRes = ReadFully(pReadAhead, &data[0], size, &readAheadRead);
+                TEST_CHECK(fileRes == readAheadRes && fileRead == readAheadRead, "step %d: read %d bytes (%d) and %d bytes (%d)", step,
+                    int(fileRead), int(fileRes), int(readAheadRead), int(readAheadRes));
+                TEST_CHECK(fileRead == 0 || memcmp(&expected[0], &data[0], fileRead) == 0, "step %d: data differs", step);
+            }
+        }
+        // Close() traces the stalls, the trace needs the AMF runtime
+        pReadAheadImpl->ResetStatistics();
+        return failures;
+    }
+
+    // reads the stream in 64 KB blocks, processing costs processMs per MB; returns ms
+    double ReadStream(AMFDataStream* pStream, amf_uint32 processMs)
+    {
+        amf_vector<amf_uint8> data(64 * 1024);
+        const amf_pts start = amf_high_precision_clock();
+        amf_size total = 0;
+        for (;;)
+        {
+            amf_size read = 0;
+            if (pStream->Read(&data[0], data.size(), &read) != AMF_OK || read == 0)
+            {
+                break;
+            }
+            const amf_size mb = (total + read) >> 20;
+            if (processMs > 0 && mb != (total >> 20))
+            {
+                amf_sleep(processMs);
+            }
+            total += read;
+        }
+        return double(amf_high_precision_clock() - start) / double(AMF_MILLISECOND);
+    }
+
+    void BenchmarkReadAhead(const char* pName, amf_uint32 latencyMs, amf_uint32 processMs)
+    {
+        AMFDataStreamPtr pFile;
+        AMFDataStream::OpenDataStream(s_ReadAheadFile, AMFSO_READ, AMFFS_SHARE_READ, &pFile);
+        AMFDataStreamPtr pPlain(new SlowStream(pFile, latencyMs));
+        const double plainMs = ReadStream(pPlain, processMs);
+
+        pFile = NULL;
+        AMFDataStream::OpenDataStream(s_ReadAheadFile, AMFSO_READ, AMFFS_SHARE_READ, &pFile);
+        AMFDataStreamReadAheadImpl* pReadAheadImpl = new AMFDataStreamReadAheadImpl();
+        AMFDataStreamPtr pReadAhead(pReadAheadImpl);
+        pReadAheadImpl->Attach(new SlowStream(pFile, latencyMs));
+        const double readAheadMs = ReadStream(pReadAhead, processMs);
+        const amf_int64 stalls = pReadAheadImpl->GetStallCount();
+        pReadAheadImpl->ResetStatistics();
+
+        printf("%-44s %10.1f %10.1f %8d\n", pName, plainMs, readAheadMs, int(stalls));
+    }
+}
+
+int TestDataStream()
+{
+    int failures = 0;
+    failures += TestMemoryStream(L"memory://", false);
+    failures += TestMemoryStream(L"memory://chunked", true);
+    // only the exact name selects the chunked backing
+    failures += TestMemoryStream(L"memory://chunkedfoo", false);
+
+    const amf_size readAheadSize = 8 * 1024 * 1024 + 12345;
+    TEST_CHECK(CreateTestFile(readAheadSize), "failed to create the read-ahead test file");
+    failures += TestReadAheadSeek(readAheadSize);
+    RemoveTestFile();
+    return failures;
+}
+
+void BenchmarkDataStream()
+{
+    printf("Memory stream append, %d byte writes, MB/s\n", int(s_AppendWriteSize));
+
+    // the exact-size reallocation is quadratic, a few MB are enough to show it
+    static const amf_size legacySize = 2 * 1024 * 1024;
+    amf_vector<amf_uint8> packet(s_AppendWriteSize);
+    LegacyMemoryStream legacy;
+    const amf_pts start = amf_high_precision_clock();
+    for (amf_size pos = 0; pos < legacySize; pos += s_AppendWriteSize)
+    {
+        legacy.Write(&packet[0], s_AppendWriteSize);
+    }
+    const amf_pts elapsed = amf_high_precision_clock() - start;
+    printf("%-44s %10.1f\n", "exact size reallocation, 2 MB", double(legacySize) / (1024.0 * 1024.0) * double(AMF_SECOND) / double(elapsed));
+
+    static const amf_size totalSize = 256 * 1024 * 1024;
+    printf("%-44s %10.1f\n", "memory://, 256 MB", AppendMBps(L"memory://", totalSize));
+    printf("%-44s %10.1f\n", "memory://chunked, 256 MB", AppendMBps(L"memory://chunked", totalSize));
+}
+
+void BenchmarkReadAhead()
+{
+    static const amf_size totalSize = 256 * 1024 * 1024;
+    if (!CreateTestFile(totalSize))
+    {
+        return;
+    }
+    printf("readahead:// against file://, %d MB in 64 KB reads, ms\n", int(totalSize >> 20));
+    printf("%-44s %10s %10s %8s\n", "", "file", "readahead", "stalls");
+    BenchmarkReadAhead("page cache", 0, 0);
+    BenchmarkReadAhead("page cache, 2 ms processing per MB", 0, 2);
+    BenchmarkReadAhead("2 ms per read, 2 ms processing per MB", 2, 2);
+    RemoveTestFile();
+}
@@ -0,0 +1,465 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "CommonTests.h"
+#include "public/common/PropertyStorageImpl.h"
+#include "public/common/PropertyStorageExImpl.h"
+#include "public/common/Thread.h"
+#include <wchar.h>
+
+using namespace amf;
+
+namespace
+{
+    // the amf_map storage AMFPropertyStorageImpl used before the flat map, the reference for the
+    // enumeration order and the benchmark
+    class MapPropertyStorage : public AMFInterfaceImpl<AMFPropertyStorage>
+    {
+    public:
+        AMF_BEGIN_INTERFACE_MAP
+            AMF_INTERFACE_ENTRY(AMFPropertyStorage)
+        AMF_END_INTERFACE_MAP
+
+        virtual AMF_RESULT AMF_STD_CALL SetProperty(const wchar_t* pName, AMFVariantStruct value)
+        {
+            m_PropertyValues[pName] = value;
+            return AMF_OK;
+        }
+        virtual AMF_RESULT AMF_STD_CALL GetProperty(const wchar_t* pName, AMFVariantStruct* pValue) const
+        {
+            amf_map<amf_wstring, AMFVariant>::const_iterator found = m_PropertyValues.find(amf_wstring(pName));
+            if (found == m_PropertyValues.end())
+            {
+                return AMF_NOT_FOUND;
+            }
+            return AMFVariantCopy(pValue, &found->second);
+        }
+        virtual amf_bool AMF_STD_CALL HasProperty(const wchar_t* pName) const
+        {
+            return m_PropertyValues.find(pName) != m_PropertyValues.end();
+        }
+        virtual amf_size AMF_STD_CALL GetPropertyCount() const { return m_PropertyValues.size(); }
+        virtual AMF_RESULT AMF_STD_CALL GetPropertyAt(amf_size index, wchar_t* pName, amf_size nameSize, AMFVariantStruct* pValue) const
+        {
+            if (index >= m_PropertyValues.size())
+            {
+                return AMF_INVALID_ARG;
+            }
+            amf_map<amf_wstring, AMFVariant>::const_iterator found = m_PropertyValues.begin();
+            for (amf_size i = 0; i < index; i++)
+            {
+                found++;
+            }
+            const size_t copySize = AMF_MIN(nameSize - 1, found->first.length());
+            memcpy(pName, found->first.c_str(), copySize * sizeof(wchar_t));
+            pName[copySize] = 0;
+            return AMFVariantCopy(pValue, &found->second);
+        }
+        virtual AMF_RESULT AMF_STD_CALL Clear()
+        {
+            m_PropertyValues.clear();
+            return AMF_OK;
+        }
+        virtual AMF_RESULT AMF_STD_CALL AddTo(AMFPropertyStorage* pDest, amf_bool overwrite, amf_bool /*deep*/) const
+        {
+            for (amf_map<amf_wstring, AMFVariant>::const_iterator it = m_PropertyValues.begin(); it != m_PropertyValues.end(); it++)
+            {
+                if (!HasProperty(it->first.c_str()) || (!overwrite && pDest->HasProperty(it->first.c_str())))
+                {
+                    continue;
+                }
+                pDest->SetProperty(it->first.c_str(), it->second);
+            }
+            return AMF_OK;
+        }
+        virtual AMF_RESULT AMF_STD_CALL CopyTo(AMFPropertyStorage* pDest, amf_bool deep) const
+        {
+            pDest->Clear();
+            return AddTo(pDest, true, deep);
+        }
+        virtual void AMF_STD_CALL AddObserver(AMFPropertyStorageObserver* /*pObserver*/) {}
+        virtual void AMF_STD_CALL RemoveObserver(AMFPropertyStorageObserver* /*pObserver*/) {}
+    private:
+        amf_map<amf_wstring, AMFVariant> m_PropertyValues;
+    };
+
+    typedef AMFInterfaceImpl<AMFPropertyStorageImpl<AMFPropertyStorage> > FlatPropertyStorage;
+
+    // a component style storage, declared out of name order
+    class ComponentPropertyStorage : public AMFInterfaceImpl<AMFPropertyStorageExImpl<AMFPropertyStorageEx> >
+    {
+    public:
+        ComponentPropertyStorage()
+        {
+            AMFPrimitivePropertyInfoMapBegin
+                AMFPropertyInfoInt64(L"Zeta", L"", 0, 0, 1000000000, AMF_PROPERTY_ACCESS_READ_WRITE),
+                AMFPropertyInfoRect(L"Rect", L"", 0, 0, 0, 0, AMF_PROPERTY_ACCESS_READ_WRITE),
+                AMFPropertyInfoWString(L"Name", L"", L"default", AMF_PROPERTY_ACCESS_READ_WRITE),
+                AMFPropertyInfoBool(L"alpha", L"", false, AMF_PROPERTY_ACCESS_READ_WRITE),
+                AMFPropertyInfoDouble(L"Gain", L"", 1.0, 0.0, 10.0, AMF_PROPERTY_ACCESS_READ_WRITE),
+                AMFPropertyInfoInt64(L"Bitrate", L"", 5000000, 0, 1000000000, AMF_PROPERTY_ACCESS_READ_WRITE),
+            AMFPrimitivePropertyInfoMapEnd
+        }
+    };
+
+    const wchar_t* const s_FrameProperties[] =
+    {
+        L"PTS", L"Duration", L"FrameType", L"InsertSPS", L"InsertPPS", L"InsertAUD", L"ForceIDR", L"MarkLTR",
+        L"ReferenceLTR", L"QPDelta",
+    };
+    const amf_size s_FramePropertyCount = sizeof(s_FrameProperties) / sizeof(s_FrameProperties[0]);
+
+    amf_uint32 NextRandom(amf_uint32& seed)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+    // short names over a small alphabet, many share prefixes and differ only in case
+    amf_wstring RandomName(amf_uint32& seed)
+    {
+        static const wchar_t alphabet[] = L"aAbBz_0";
+        amf_wstring name;
+        const amf_uint32 length = 1 + NextRandom(seed) % 5;
+        for (amf_uint32 i = 0; i < length; i++)
+        {
+            name += alphabet[NextRandom(seed) % (sizeof(alphabet) / sizeof(alphabet[0]) - 1)];
+        }
+        return name;
+    }
+
+    int CompareEnumeration(const char* pWhat, AMFPropertyStorage* pTested, AMFPropertyStorage* pReference)
+    {
+        int failures = 0;
+        TEST_CHECK(pTested->GetPropertyCount() == pReference->GetPropertyCount(), "%s: %d properties, reference %d", pWhat,
+            (int)pTested->GetPropertyCount(), (int)pReference->GetPropertyCount());
+        for (amf_size i = 0; i < pReference->GetPropertyCount() && failures == 0; i++)
+        {
+            wchar_t name[64];
+            wchar_t referenceName[64];
+            AMFVariant value;
+            AMFVariant referenceValue;
+            TEST_CHECK(pTested->GetPropertyAt(i, name, 64, &value) == AMF_OK, "%s: GetPropertyAt(%d)", pWhat, (int)i);
+            pReference->GetPropertyAt(i, referenceName, 64, &referenceValue);
+            TEST_CHECK(wcscmp(name, referenceName) == 0 && value == referenceValue, "%s: property %d is %ls, the map has %ls", pWhat, (int)i, name, referenceName);
+        }
+        return failures;
+    }
+
+    // GetPropertyAt() enumerates by name like the std::map storage did, whatever the insertion order
+    int TestPropertyOrder()
+    {
+        int failures = 0;
+        amf_uint32 seed = 0x31415926;
+        AMFPropertyStoragePtr pFlat(new FlatPropertyStorage());
+        AMFPropertyStoragePtr pMap(new MapPropertyStorage());
+        for (int round = 0; round < 3; round++)
+        {
+            for (int i = 0; i < 300; i++)
+            {
+                const amf_wstring name = RandomName(seed);
+                const AMFVariant value(amf_int64(NextRandom(seed)));
+                pFlat->SetProperty(name.c_str(), value);
+                pMap->SetProperty(name.c_str(), value);
+            }
+            failures += CompareEnumeration("AMFPropertyStorageImpl", pFlat, pMap);
+
+            // Clear() keeps the capacity, the order is rebuilt
+            pFlat->Clear();
+            pMap->Clear();
+        }
+
+        // the same after CopyTo()
+        for (amf_size i = 0; i < s_FramePropertyCount; i++)
+        {
+            pMap->SetProperty(s_FrameProperties[i], AMFVariant(amf_int64(i)));
+        }
+        pMap->CopyTo(pFlat, false);
+        failures += CompareEnumeration("CopyTo", pFlat, pMap);
+
+        ComponentPropertyStorage* pComponent = new ComponentPropertyStorage();
+        AMFPropertyStorageExPtr pEx(pComponent);
+        const wchar_t* const sorted[] = { L"Bitrate", L"Gain", L"Name", L"Rect", L"Zeta", L"alpha" };
+        TEST_CHECK(pEx->GetPropertiesInfoCount() == sizeof(sorted) / sizeof(sorted[0]), "AMFPropertyStorageExImpl: %d properties", (int)pEx->GetPropertiesInfoCount());
+        for (amf_size i = 0; i < pEx->GetPropertiesInfoCount(); i++)
+        {
+            const AMFPropertyInfo* pInfo = NULL;
+            wchar_t name[64];
+            AMFVariant value;
+            TEST_CHECK(pEx->GetPropertyInfo(i, &pInfo) == AMF_OK && wcscmp(pInfo->name, sorted[i]) == 0, "GetPropertyInfo(%d) is %ls, expected %ls",
+                (int)i, pInfo != NULL ? pInfo->name : L"", sorted[i]);
+            TEST_CHECK(pEx->GetPropertyAt(i, name, 64, &value) == AMF_OK && wcscmp(name, sorted[i]) == 0, "GetPropertyAt(%d) is %ls, expected %ls",
+                (int)i, name, sorted[i]);
+        }
+        return failures;
+    }
+
+    // only storing a value interns a name
+    int TestPropertyInterning()
+    {
+        int failures = 0;
+        AMFPropertyStoragePtr pFlat(new FlatPropertyStorage());
+        AMFPropertyStorageExPtr pEx(new ComponentPropertyStorage());
+
+        const amf_size count = AMFPropertyKeyTable::GetCount();
+        for (int i = 0; i < 100; i++)
+        {
+            wchar_t name[64];
+            swprintf(name, 64, L"NeverStored_%d", i);
+            AMFVariant value;
+            pFlat->HasProperty(name);
+            pFlat->GetProperty(name, &value);
+            pEx->HasProperty(name);
+            pEx->GetProperty(name, &value);
+            pEx->SetProperty(name, AMFVariant(amf_int64(i)));   // not declared by the component
+            AMFPropertyKeyTable::Find(name);
+        }
+        TEST_CHECK(AMFPropertyKeyTable::GetCount() == count, "lookups interned %d names", (int)(AMFPropertyKeyTable::GetCount() - count));
+
+        pFlat->SetProperty(L"StoredOnce", AMFVariant(amf_int64(1)));
+        TEST_CHECK(AMFPropertyKeyTable::GetCount() == count + 1, "SetProperty interns the stored name");
+        pFlat->Clear();
+        pFlat->SetProperty(L"StoredOnce", AMFVariant(amf_int64(2)));
+        TEST_CHECK(AMFPropertyKeyTable::GetCount() == count + 1, "a name is interned once");
+        return failures;
+    }
+
+    // sets rect properties with all four members equal, increasing
+    class RectWriter : public AMFThread
+    {
+    public:
+        RectWriter(AMFPropertyStorage* pStorage, amf_int32 count) : m_pStorage(pStorage), m_iCount(count) {}
+    protected:
+        virtual void Run()
+        {
+            for (amf_int32 i = 1; i <= m_iCount; i++)
+            {
+                m_pStorage->SetProperty(L"Rect", AMFVariant(AMFConstructRect(i, i, i, i)));
+            }
+        }
+    private:
+        AMFPropertyStorage* m_pStorage;
+        amf_int32           m_iCount;
+    };
+    // a torn read shows members of different writes, values never go back
+    class RectReader : public AMFThread
+    {
+    public:
+        RectReader(AMFPropertyStorage* pStorage, amf_int32 last) : m_pStorage(pStorage), m_iLast(last), m_iTorn(0), m_iBackwards(0), m_iReads(0) {}
+
+        amf_int32 GetTorn() const       { return m_iTorn; }
+        amf_int32 GetBackwards() const  { return m_iBackwards; }
+        amf_int64 GetReads() const      { return m_iReads; }
+    protected:
+        virtual void Run()
+        {
+            amf_int32 previous = 0;
+            while (previous < m_iLast)
+            {
+                AMFVariant value;
+                m_pStorage->GetProperty(L"Rect", &value);
+                const AMFRect rect = value.ToRect();
+                if (rect.left != rect.top || rect.left != rect.right || rect.left != rect.bottom)
+                {
+                    m_iTorn++;
+                }
+                if (rect.left < previous)
+                {
+                    m_iBackwards++;
+                }
+                previous = rect.left;
+                m_iReads++;
+            }
+        }
+    private:
+        AMFPropertyStorage* m_pStorage;
+        amf_int32           m_iLast;
+        amf_int32           m_iTorn;
+        amf_int32           m_iBackwards;
+        amf_int64           m_iReads;
+    };
+
+    // plain values are read through the lock-free snapshot, strings under the lock
+    int TestPropertySnapshot()
+    {
+        int failures = 0;
+        AMFPropertyStorageExPtr pEx(new ComponentPropertyStorage());
+
+        AMFVariant value;
+        TEST_CHECK(pEx->GetProperty(L"Bitrate", &value) == AMF_OK && value == AMFVariant(amf_int64(5000000)), "default before any Set");
+        TEST_CHECK(pEx->GetProperty(L"Bitrate", &value) == AMF_OK && value == AMFVariant(amf_int64(5000000)), "published default");
+        TEST_CHECK(pEx->SetProperty(L"Bitrate", AMFVariant(amf_int64(8000000))) == AMF_OK, "Set");
+        TEST_CHECK(pEx->GetProperty(L"Bitrate", &value) == AMF_OK && value == AMFVariant(amf_int64(8000000)), "value after Set");
+        TEST_CHECK(pEx->SetProperty(L"Gain", AMFVariant(2.5)) == AMF_OK && pEx->GetProperty(L"Gain", &value) == AMF_OK && value == AMFVariant(2.5), "double");
+
+        // the output variant held a string, which has to be released
+        value = AMFVariant(L"some string");
+        TEST_CHECK(pEx->GetProperty(L"Zeta", &value) == AMF_OK && value == AMFVariant(amf_int64(0)), "plain read into a string variant");
+        TEST_CHECK(pEx->SetProperty(L"Name", AMFVariant(L"changed")) == AMF_OK, "Set string");
+        TEST_CHECK(pEx->GetProperty(L"Name", &value) == AMF_OK && value == AMFVariant(L"changed"), "string value");
+
+        pEx->Clear();   // back to the defaults
+        TEST_CHECK(pEx->GetProperty(L"Bitrate", &value) == AMF_OK && value == AMFVariant(amf_int64(5000000)), "default after Clear");
+        TEST_CHECK(pEx->GetProperty(L"Name", &value) == AMF_OK && value == AMFVariant(L"default"), "string default after Clear");
+
+        const amf_int32 writes = 200000;
+        RectWriter writer(pEx, writes);
+        RectReader reader1(pEx, writes);
+        RectReader reader2(pEx, writes);
+        reader1.Start();
+        reader2.Start();
+        writer.Start();
+        writer.WaitForStop();
+        reader1.WaitForStop();
+        reader2.WaitForStop();
+        TEST_CHECK(reader1.GetTorn() == 0 && reader2.GetTorn() == 0, "torn reads %d, %d", reader1.GetTorn(), reader2.GetTorn());
+        TEST_CHECK(reader1.GetBackwards() == 0 && reader2.GetBackwards() == 0, "values went back %d, %d times", reader1.GetBackwards(), reader2.GetBackwards());
+        return failures;
+    }
+
+    template<typename _TFunc>
+    double MeasureNs(_TFunc func)
+    {
+        static const amf_pts minDuration = AMF_SECOND / 4;
+        func();
+        amf_int64 iterations = 0;
+        const amf_pts start = amf_high_precision_clock();
+        amf_pts elapsed = 0;
+        do
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                func();
+            }
+            iterations += 100;
+            elapsed = amf_high_precision_clock() - start;
+        } while (elapsed < minDuration);
+        return double(elapsed) * 100.0 / double(iterations);
+    }
+
+    // a frame: the encoder parameters are set and two are read back
+    void SetGetFrame(AMFPropertyStorage* pStorage)
+    {
+        for (amf_size i = 0; i < s_FramePropertyCount; i++)
+        {
+            pStorage->SetProperty(s_FrameProperties[i], AMFVariant(amf_int64(i)));
+        }
+        AMFVariant value;
+        pStorage->GetProperty(L"PTS", &value);
+        pStorage->GetProperty(L"FrameType", &value);
+    }
+
+    // reads one property in a loop, the time per read is measured
+    class PropertyGetter : public AMFThread
+    {
+    public:
+        PropertyGetter(AMFPropertyStorage* pStorage, const wchar_t* pName, amf_int64 reads) : m_pStorage(pStorage), m_pName(pName), m_iReads(reads) {}
+    protected:
+        virtual void Run()
+        {
+            AMFVariant value;
+            for (amf_int64 i = 0; i < m_iReads; i++)
+            {
+                m_pStorage->GetProperty(m_pName, &value);
+            }
+        }
+    private:
+        AMFPropertyStorage* m_pStorage;
+        const wchar_t*      m_pName;
+        amf_int64           m_iReads;
+    };
+    double MeasureContendedGet(AMFPropertyStorage* pStorage, const wchar_t* pName, int threads)
+    {
+        const amf_int64 reads = 500000;
+        amf_vector<PropertyGetter*> getters;
+        for (int i = 0; i < threads; i++)
+        {
+            getters.push_back(new PropertyGetter(pStorage, pName, reads));
+        }
+        const amf_pts start = amf_high_precision_clock();
+        for (int i = 0; i < threads; i++)
+        {
+            getters[i]->Start();
+        }
+        for (int i = 0; i < threads; i++)
+        {
+            getters[i]->WaitForStop();
+            delete getters[i];
+        }
+        return double(amf_high_precision_clock() - start) * 100.0 / double(reads);
+    }
+}
+
+int TestPropertyStorage()
+{
+    int failures = 0;
+    failures += TestPropertyOrder();
+    failures += TestPropertyInterning();
+    failures += TestPropertySnapshot();
+    return failures;
+}
+
+void BenchmarkPropertyStorage()
+{
+    printf("Property storage benchmark, ns per operation\n");
+    printf("%-44s %10s %10s\n", "", "amf_map", "flat map");
+
+    AMFPropertyStoragePtr pMap(new MapPropertyStorage());
+    AMFPropertyStoragePtr pFlat(new FlatPropertyStorage());
+    const double mapFrame = MeasureNs([&]() { SetGetFrame(pMap); });
+    const double flatFrame = MeasureNs([&]() { SetGetFrame(pFlat); });
+    printf("%-44s %10.0f %10.0f\n", "AMFPropertyStorageImpl 10 Set + 2 Get", mapFrame, flatFrame);
+
+    AMFPropertyStoragePtr pMapCopy(new MapPropertyStorage());
+    AMFPropertyStoragePtr pFlatCopy(new FlatPropertyStorage());
+    const double mapCopy = MeasureNs([&]() { pMap->CopyTo(pMapCopy, false); });
+    const double flatCopy = MeasureNs([&]() { pFlat->CopyTo(pFlatCopy, false); });
+    printf("%-44s %10.0f %10.0f\n", "AMFPropertyStorageImpl CopyTo, 10 properties", mapCopy, flatCopy);
+
+    AMFPropertyStorageExPtr pEx(new ComponentPropertyStorage());
+    AMFPropertyStorageExPtr pExCopy(new ComponentPropertyStorage());
+    AMFVariant value;
+    printf("%-44s %10s %10.0f\n", "AMFPropertyStorageExImpl 1 Set + 2 Get", "-", MeasureNs([&]()
+    {
+        pEx->SetProperty(L"Bitrate", AMFVariant(amf_int64(6000000)));
+        pEx->GetProperty(L"Bitrate", &value);
+        pEx->GetProperty(L"Zeta", &value);
+    }));
+    printf("%-44s %10s %10.0f\n", "AMFPropertyStorageExImpl CopyTo, 6 properties", "-", MeasureNs([&]() { pEx->CopyTo(pExCopy, false); }));
+
+    // plain values take no lock, strings are copied under the storage lock
+    printf("%-44s %10s %10s\n", "AMFPropertyStorageExImpl Get, 4 threads", "locked", "lock-free");
+    printf("%-44s %10.1f %10.1f\n", "  wall time per read", MeasureContendedGet(pEx, L"Name", 4), MeasureContendedGet(pEx, L"Bitrate", 4));
+}
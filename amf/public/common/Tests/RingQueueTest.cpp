@@ -0,0 +1,208 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "CommonTests.h"
+#include "public/common/Thread.h"
+#include "public/common/AMFSTL.h"
+
+using namespace amf;
+
+namespace
+{
+    typedef AMFRingQueue<amf_int64> IntQueue;
+
+    int CheckFifo(const char* pWhat, IntQueue& queue, amf_int64 count)
+    {
+        int failures = 0;
+        for (amf_int64 i = 0; i < count && failures == 0; i++)
+        {
+            amf_ulong ulID = 0;
+            amf_int64 value = -1;
+            TEST_CHECK(queue.Get(ulID, value, 0) && value == i && ulID == amf_ulong(i), "%s: item %d is %d", pWhat, (int)i, (int)value);
+        }
+        amf_ulong ulID = 0;
+        amf_int64 value = -1;
+        TEST_CHECK(!queue.Get(ulID, value, 0), "%s: Get() from an empty queue", pWhat);
+        return failures;
+    }
+
+    // size 0 is unbounded like AMFQueue, a positive size bounds Add()
+    int TestRingQueueSize(AMF_RING_QUEUE_MODE eMode)
+    {
+        int failures = 0;
+        IntQueue queue(0, eMode);
+        TEST_CHECK(queue.GetQueueSize() == 0, "mode %d: default size %d", (int)eMode, (int)queue.GetQueueSize());
+        for (amf_int64 i = 0; i < 1000; i++)
+        {
+            TEST_CHECK(queue.Add(amf_ulong(i), i, 0, 0), "mode %d: unbounded Add(%d) failed", (int)eMode, (int)i);
+        }
+        TEST_CHECK(queue.GetSize() == 1000, "mode %d: unbounded size %d", (int)eMode, (int)queue.GetSize());
+        failures += CheckFifo("unbounded", queue, 1000);
+
+        TEST_CHECK(queue.SetQueueSize(5), "mode %d: SetQueueSize(5)", (int)eMode);
+        TEST_CHECK(queue.GetQueueSize() == 5, "mode %d: bounded size %d", (int)eMode, (int)queue.GetQueueSize());
+        for (amf_int64 i = 0; i < 5; i++)
+        {
+            TEST_CHECK(queue.Add(amf_ulong(i), i, 0, 0), "mode %d: bounded Add(%d) failed", (int)eMode, (int)i);
+        }
+        TEST_CHECK(!queue.Add(5, 5, 0, 0), "mode %d: Add() to a full queue", (int)eMode);
+        TEST_CHECK(queue.GetSize() == 5, "mode %d: bounded size %d", (int)eMode, (int)queue.GetSize());
+        failures += CheckFifo("bounded", queue, 5);
+
+        // back to unbounded, items left in the ring are dropped
+        queue.Add(0, 0, 0, 0);
+        TEST_CHECK(queue.SetQueueSize(0) && queue.GetQueueSize() == 0 && queue.GetSize() == 0, "mode %d: SetQueueSize(0)", (int)eMode);
+        for (amf_int64 i = 0; i < 100; i++)
+        {
+            queue.Add(amf_ulong(i), i, 0, 0);
+        }
+        failures += CheckFifo("unbounded again", queue, 100);
+        return failures;
+    }
+
+    // higher priority first, equal priorities in Add() order, bounded and unbounded alike
+    int TestRingQueuePriority(amf_int32 iQueueSize)
+    {
+        int failures = 0;
+        IntQueue queue(iQueueSize, AMF_RING_QUEUE_PRIORITY);
+        const amf_long priorities[] = { 1, 3, 2, 3, 1, 2 };
+        const amf_int64 expected[] = { 1, 3, 2, 5, 0, 4 };
+        for (amf_int64 i = 0; i < 6; i++)
+        {
+            queue.Add(amf_ulong(i), i, priorities[i], 0);
+        }
+        for (int i = 0; i < 6; i++)
+        {
+            amf_ulong ulID = 0;
+            amf_int64 value = -1;
+            TEST_CHECK(queue.Get(ulID, value, 0) && value == expected[i], "priority, size %d: item %d is %d, expected %d",
+                (int)iQueueSize, i, (int)value, (int)expected[i]);
+        }
+        return failures;
+    }
+
+    class QueueProducer : public AMFThread
+    {
+    public:
+        QueueProducer(IntQueue* pQueue, amf_int64 first, amf_int64 count) : m_pQueue(pQueue), m_first(first), m_count(count) {}
+    protected:
+        virtual void Run()
+        {
+            for (amf_int64 i = m_first; i < m_first + m_count; i++)
+            {
+                m_pQueue->Add(0, i);
+            }
+        }
+    private:
+        IntQueue*   m_pQueue;
+        amf_int64   m_first;
+        amf_int64   m_count;
+    };
+    class QueueConsumer : public AMFThread
+    {
+    public:
+        QueueConsumer(IntQueue* pQueue, amf_int64 count) : m_pQueue(pQueue), m_count(count), m_sum(0) {}
+        amf_int64 GetSum() const { return m_sum; }
+    protected:
+        virtual void Run()
+        {
+            for (amf_int64 i = 0; i < m_count; i++)
+            {
+                amf_ulong ulID = 0;
+                amf_int64 value = 0;
+                // the unbounded queue is AMFQueue: a wakeup can lose the item to the other consumer
+                while (!m_pQueue->Get(ulID, value, AMF_INFINITE))
+                {
+                }
+                m_sum += value;
+            }
+        }
+    private:
+        IntQueue*   m_pQueue;
+        amf_int64   m_count;
+        amf_int64   m_sum;
+    };
+
+    // every item arrives exactly once through a small ring
+    int TestRingQueueThreads(AMF_RING_QUEUE_MODE eMode, int producers, int consumers, amf_int32 iQueueSize)
+    {
+        int failures = 0;
+        const amf_int64 perProducer = 20000;
+        const amf_int64 total = perProducer * producers;
+        IntQueue queue(iQueueSize, eMode);
+        amf_vector<QueueProducer*> producerThreads;
+        amf_vector<QueueConsumer*> consumerThreads;
+        for (int i = 0; i < consumers; i++)
+        {
+            consumerThreads.push_back(new QueueConsumer(&queue, total / consumers));
+            consumerThreads.back()->Start();
+        }
+        for (int i = 0; i < producers; i++)
+        {
+            producerThreads.push_back(new QueueProducer(&queue, i * perProducer, perProducer));
+            producerThreads.back()->Start();
+        }
+        amf_int64 sum = 0;
+        for (int i = 0; i < producers; i++)
+        {
+            producerThreads[i]->WaitForStop();
+            delete producerThreads[i];
+        }
+        for (int i = 0; i < consumers; i++)
+        {
+            consumerThreads[i]->WaitForStop();
+            sum += consumerThreads[i]->GetSum();
+            delete consumerThreads[i];
+        }
+        TEST_CHECK(sum == total * (total - 1) / 2, "mode %d, size %d: %d producers, %d consumers lost or duplicated items", (int)eMode,
+            (int)iQueueSize, producers, consumers);
+        TEST_CHECK(queue.GetSize() == 0, "mode %d, size %d: %d items left", (int)eMode, (int)iQueueSize, (int)queue.GetSize());
+        return failures;
+    }
+}
+
+int TestRingQueue()
+{
+    int failures = 0;
+    failures += TestRingQueueSize(AMF_RING_QUEUE_MPMC);
+    failures += TestRingQueueSize(AMF_RING_QUEUE_SPSC);
+    failures += TestRingQueueSize(AMF_RING_QUEUE_PRIORITY);
+    failures += TestRingQueuePriority(0);
+    failures += TestRingQueuePriority(8);
+    failures += TestRingQueueThreads(AMF_RING_QUEUE_MPMC, 4, 2, 8);
+    failures += TestRingQueueThreads(AMF_RING_QUEUE_SPSC, 1, 1, 8);
+    failures += TestRingQueueThreads(AMF_RING_QUEUE_PRIORITY, 2, 2, 8);
+    failures += TestRingQueueThreads(AMF_RING_QUEUE_MPMC, 4, 2, 0);
+    return failures;
+}
@@ -0,0 +1,134 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "CommonTests.h"
+#include "public/common/Thread.h"
+
+using namespace amf;
+
+namespace
+{
+    // calls Cancel() on the waiter after a delay
+    template<typename _TWaiter>
+    class DelayedCancel : public AMFThread
+    {
+    public:
+        DelayedCancel(_TWaiter* pWaiter, amf_pts delay) : m_pWaiter(pWaiter), m_delay(delay) {}
+    protected:
+        virtual void Run()
+        {
+            amf_sleep(amf_ulong(m_delay / AMF_MILLISECOND));
+            m_pWaiter->Cancel();
+        }
+    private:
+        _TWaiter*   m_pWaiter;
+        amf_pts     m_delay;
+    };
+
+    // the polling callers rely on Wait(n) sleeping in 1 ms steps and on Cancel() only stopping a running wait
+    int TestPreciseWaiter()
+    {
+        int failures = 0;
+        AMFPreciseWaiter waiter;
+
+        const int polls = 20;
+        amf_pts start = amf_high_precision_clock();
+        for (int i = 0; i < polls; i++)
+        {
+            waiter.Wait(1);
+        }
+        amf_pts elapsed = amf_high_precision_clock() - start;
+        TEST_CHECK(elapsed >= polls * AMF_MILLISECOND / 2, "AMFPreciseWaiter: %d Wait(1) calls took %.3f ms, a poll has to sleep", polls,
+            double(elapsed) / AMF_MILLISECOND);
+
+        // not latched: the flag is reset when the next wait starts
+        waiter.Cancel();
+        amf_pts waited = waiter.Wait(5 * AMF_MILLISECOND);
+        TEST_CHECK(waited >= 5 * AMF_MILLISECOND, "AMFPreciseWaiter: Cancel() before Wait() cut the wait to %.3f ms", double(waited) / AMF_MILLISECOND);
+
+        DelayedCancel<AMFPreciseWaiter> canceller(&waiter, 20 * AMF_MILLISECOND);
+        canceller.Start();
+        waited = waiter.Wait(AMF_SECOND);
+        canceller.WaitForStop();
+        TEST_CHECK(waited < AMF_SECOND / 2, "AMFPreciseWaiter: Cancel() during Wait() returned after %.3f ms", double(waited) / AMF_MILLISECOND);
+
+        waited = waiter.WaitEx(3 * AMF_MILLISECOND);
+        TEST_CHECK(waited >= 3 * AMF_MILLISECOND, "AMFPreciseWaiter: WaitEx(3 ms) returned after %.3f ms", double(waited) / AMF_MILLISECOND);
+        return failures;
+    }
+
+    int TestDeadlineWaiter()
+    {
+        int failures = 0;
+        AMFDeadlineWaiter waiter;
+
+        amf_pts deadline = amf_high_precision_clock() + 3 * AMF_MILLISECOND;
+        TEST_CHECK(waiter.WaitUntil(deadline), "AMFDeadlineWaiter: WaitUntil() reported a cancel");
+        TEST_CHECK(amf_high_precision_clock() >= deadline, "AMFDeadlineWaiter: WaitUntil() returned before the deadline");
+
+        // latched: the next wait returns at once, the one after it sleeps again
+        waiter.Cancel();
+        amf_pts start = amf_high_precision_clock();
+        TEST_CHECK(!waiter.WaitUntil(start + AMF_SECOND), "AMFDeadlineWaiter: latched Cancel() not reported");
+        TEST_CHECK(amf_high_precision_clock() - start < AMF_SECOND / 2, "AMFDeadlineWaiter: latched Cancel() did not end the wait");
+        amf_pts waited = waiter.Wait(2 * AMF_MILLISECOND);
+        TEST_CHECK(waited >= 2 * AMF_MILLISECOND, "AMFDeadlineWaiter: Cancel() was latched twice, waited %.3f ms", double(waited) / AMF_MILLISECOND);
+
+        DelayedCancel<AMFDeadlineWaiter> canceller(&waiter, 20 * AMF_MILLISECOND);
+        canceller.Start();
+        waited = waiter.Wait(AMF_SECOND);
+        canceller.WaitForStop();
+        TEST_CHECK(waited < AMF_SECOND / 2, "AMFDeadlineWaiter: Cancel() during Wait() returned after %.3f ms", double(waited) / AMF_MILLISECOND);
+
+        // ticks on the grid: 10 frames of 2 ms take at least 18 ms after the first one
+        AMFFramePacer pacer(2 * AMF_MILLISECOND);
+        pacer.WaitNextFrame();
+        start = amf_high_precision_clock();
+        for (int i = 0; i < 9; i++)
+        {
+            pacer.WaitNextFrame();
+        }
+        amf_pts elapsed = amf_high_precision_clock() - start;
+        TEST_CHECK(elapsed >= 18 * AMF_MILLISECOND - AMF_MILLISECOND / 10, "AMFFramePacer: 9 ticks of 2 ms took %.3f ms", double(elapsed) / AMF_MILLISECOND);
+        return failures;
+    }
+}
+
+int TestWaiters()
+{
+    int failures = 0;
+    failures += TestPreciseWaiter();
+    failures += TestDeadlineWaiter();
+    return failures;
+}
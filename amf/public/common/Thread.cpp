@@ -621,4 +621,195 @@ namespace amf
     {
         return m_thread->IsRunning();
     }
+    //----------------------------------------------------------------------------
+    // AMFThreadPool
+    //----------------------------------------------------------------------------
+    static thread_local AMFThreadPool* s_pCurrentPool = NULL;   // pool of the worker running on this thread
+    static thread_local amf_int32 s_iCurrentWorker = -1;
+    //----------------------------------------------------------------------------
+    class AMFThreadPool::Worker : public AMFThread
+    {
+    public:
+        Worker(AMFThreadPool* pPool, amf_int32 iIndex) : m_pPool(pPool), m_iIndex(iIndex)
+        {}
+    protected:
+        virtual void Run()
+        {
+            m_pPool->WorkerLoop(m_iIndex);
+        }
+        AMFThreadPool*  m_pPool;
+        amf_int32       m_iIndex;
+    };
+    //----------------------------------------------------------------------------
+    static AMFCriticalSection& GetSharedPoolSync()
+    {
+        static AMFCriticalSection sync;
+        return sync;
+    }
+    static AMFThreadPool* s_pSharedPool = NULL;
+    static amf_long s_iSharedPoolRefs = 0;
+    //----------------------------------------------------------------------------
+    AMFThreadPool* AMFThreadPool::AcquireShared()
+    {
+        AMFLock lock(&GetSharedPoolSync());
+        if(s_iSharedPoolRefs++ == 0)
+        {
+            s_pSharedPool = new AMFThreadPool();
+        }
+        return s_pSharedPool;
+    }
+    //----------------------------------------------------------------------------
+    void AMFThreadPool::ReleaseShared()
+    {
+        AMFLock lock(&GetSharedPoolSync());
+        if(s_iSharedPoolRefs > 0 && --s_iSharedPoolRefs == 0)
+        {
+            delete s_pSharedPool;
+            s_pSharedPool = NULL;
+        }
+    }
+    //----------------------------------------------------------------------------
+    AMFThreadPool::AMFThreadPool(amf_int32 iThreads, bool bPinThreads) :
+        m_Pending(0),
+        m_bStop(false),
+        m_bPinThreads(bPinThreads)
+    {
+        if(iThreads <= 0)
+        {
+#if defined(_WIN32) || (__linux__)
+            iThreads = amf_get_cpu_cores();
+#endif
+            iThreads = iThreads > 0 ? iThreads : 4;
+        }
+        for(amf_int32 i = 0; i <= iThreads; i++)
+        {
+            m_Deques.push_back(new Deque());
+        }
+        for(amf_int32 i = 0; i < iThreads; i++)
+        {
+            Worker* pWorker = new Worker(this, i);
+            m_Workers.push_back(pWorker);
+            pWorker->Start();
+        }
+    }
+    //----------------------------------------------------------------------------
+    AMFThreadPool::~AMFThreadPool()
+    {
+        m_bStop = true;
+        for(size_t i = 0; i < m_Workers.size(); i++)
+        {
+            m_Workers[i]->RequestStop();
+        }
+        m_Pending.Unlock((amf_long)m_Workers.size());
+        for(size_t i = 0; i < m_Workers.size(); i++)
+        {
+            m_Workers[i]->WaitForStop();
+            delete m_Workers[i];
+        }
+        for(size_t i = 0; i < m_Deques.size(); i++)
+        {
+            delete m_Deques[i];
+        }
+    }
+    //----------------------------------------------------------------------------
+    void AMFThreadPool::Submit(const Task& task, amf_int32 iAffinity)
+    {
+        size_t iDeque = m_Deques.size() - 1;
+        if(iAffinity >= 0 && m_Workers.size() > 0)
+        {
+            iDeque = (size_t)iAffinity % m_Workers.size();
+        }
+        else if(s_pCurrentPool == this)
+        {
+            iDeque = (size_t)s_iCurrentWorker;
+        }
+        {
+            AMFLock lock(&m_Deques[iDeque]->sync);
+            m_Deques[iDeque]->tasks.push_back(task);
+        }
+        m_Pending.Unlock();
+    }
+    //----------------------------------------------------------------------------
+    bool AMFThreadPool::RunPendingTask()
+    {
+        if(!m_Pending.TryLock())
+        {
+            return false;
+        }
+        Task task;
+        Pop(s_pCurrentPool == this ? s_iCurrentWorker : -1, task);
+        Execute(task);
+        return true;
+    }
+    //----------------------------------------------------------------------------
+    void AMFThreadPool::Pop(amf_int32 iWorker, Task& task)
+    {
+        // the caller owns a unit of m_Pending, so a task is guaranteed to be queued somewhere
+        const size_t count = m_Deques.size();
+        for(;;)
+        {
+            if(iWorker >= 0)
+            {
+                Deque* pOwn = m_Deques[iWorker];
+                AMFLock lock(&pOwn->sync);
+                if(!pOwn->tasks.empty())
+                {
+                    task = pOwn->tasks.back();
+                    pOwn->tasks.pop_back();
+                    return;
+                }
+            }
+            // steal the oldest task: the external queue first, then the workers after this one
+            for(size_t i = 0; i < count; i++)
+            {
+                size_t iVictim = i == 0 ? count - 1 : size_t(amf_int64(iWorker) + amf_int64(i)) % (count - 1);
+                if((amf_int32)iVictim == iWorker)
+                {
+                    continue;
+                }
+                Deque* pVictim = m_Deques[iVictim];
+                AMFLock lock(&pVictim->sync);
+                if(!pVictim->tasks.empty())
+                {
+                    task = pVictim->tasks.front();
+                    pVictim->tasks.pop_front();
+                    return;
+                }
+            }
+        }
+    }
+    //----------------------------------------------------------------------------
+    void AMFThreadPool::Execute(Task& task)
+    {
+        task.pProc(task.pContext, task.iBegin, task.iEnd);
+        if(task.pGroup != NULL)
+        {
+            task.pGroup->Done();
+        }
+    }
+    //----------------------------------------------------------------------------
+    void AMFThreadPool::WorkerLoop(amf_int32 iWorker)
+    {
+        s_pCurrentPool = this;
+        s_iCurrentWorker = iWorker;
+#if defined(_WIN32) || (__linux__)
+        if(m_bPinThreads)
+        {
+            amf_set_thread_affinity(iWorker);
+        }
+#endif
+        for(;;)
+        {
+            m_Pending.Lock();
+            if(m_bStop)
+            {
+                break;
+            }
+            Task task;
+            Pop(iWorker, task);
+            Execute(task);
+        }
+        s_pCurrentPool = NULL;
+        s_iCurrentWorker = -1;
+    }
 } //namespace
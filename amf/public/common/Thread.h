@@ -35,8 +35,12 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <list>
+#include <deque>
 #include <vector>
+#include <atomic>
+#include <algorithm>
 
 #include "../include/core/Platform.h"
 
@@ -86,6 +90,14 @@ extern "C"
     void        AMF_CDECL_CALL amf_sleep(amf_ulong delay);
     amf_pts     AMF_CDECL_CALL amf_high_precision_clock();    // in 100 of nanosec
 
+    // threads: precise wait - sleeps in the kernel until an absolute deadline, no polling or spinning
+    amf_handle  AMF_CDECL_CALL amf_create_waiter();
+    bool        AMF_CDECL_CALL amf_delete_waiter(amf_handle hwaiter);
+    // deadline in amf_high_precision_clock() units; returns false if woken by amf_cancel_wait()
+    bool        AMF_CDECL_CALL amf_wait_until(amf_handle hwaiter, amf_pts deadline);
+    // wakes the current wait, or the next one if nobody is waiting
+    bool        AMF_CDECL_CALL amf_cancel_wait(amf_handle hwaiter);
+
     void        AMF_CDECL_CALL amf_increase_timer_precision();
     void        AMF_CDECL_CALL amf_restore_timer_precision();
 
@@ -113,6 +125,7 @@ extern "C"
     // cpu
 #if defined(_WIN32) || (__linux__)
     amf_int32   AMF_STD_CALL  amf_get_cpu_cores();
+    bool        AMF_STD_CALL  amf_set_thread_affinity(amf_int32 iCpu); // pins the calling thread, iCpu wraps around online CPUs
 #endif
 
 }
@@ -307,6 +320,99 @@ namespace amf
         }
     };
     //----------------------------------------------------------------
+    // counting semaphore with the count kept in user space: the kernel object is touched
+    // only when a thread has to sleep, and every released unit wakes at most one waiter
+    class AMFLightSemaphore
+    {
+    private:
+        std::atomic<amf_long> m_count;
+        AMFSemaphore m_sem;
+
+        AMFLightSemaphore(const AMFLightSemaphore&);
+        AMFLightSemaphore& operator=(const AMFLightSemaphore&);
+
+    public:
+        AMFLightSemaphore(amf_long iInitCount = 0) : m_count(iInitCount), m_sem(0, 0x7FFFFFFF)
+        {}
+
+        bool TryLock()
+        {
+            amf_long old = m_count.load(std::memory_order_relaxed);
+            while(old > 0)
+            {
+                if(m_count.compare_exchange_weak(old, old - 1, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+        bool Lock(amf_ulong ulTimeout = AMF_INFINITE)
+        {
+            if(TryLock())
+            {
+                return true;
+            }
+            if(m_count.fetch_sub(1, std::memory_order_acquire) > 0)
+            {
+                return true;
+            }
+            amf_pts start = amf_high_precision_clock();
+            amf_ulong remaining = ulTimeout;
+            for(;;)
+            {
+                if(m_sem.Lock(remaining))
+                {
+                    return true;
+                }
+                if(ulTimeout != AMF_INFINITE)
+                {
+                    amf_pts waited = (amf_high_precision_clock() - start) / (AMF_SECOND / 1000);
+                    if(waited >= (amf_pts)ulTimeout)
+                    {
+                        break;
+                    }
+                    remaining = ulTimeout - (amf_ulong)waited;  // woken by a signal - keep waiting
+                }
+            }
+            // timed out: give the reserved unit back unless Unlock() has already targeted this waiter
+            amf_long old = m_count.load(std::memory_order_relaxed);
+            for(;;)
+            {
+                if(old >= 0)
+                {
+                    while(!m_sem.Lock(AMF_INFINITE))
+                    {
+                    }
+                    return true;
+                }
+                if(m_count.compare_exchange_weak(old, old + 1, std::memory_order_relaxed, std::memory_order_relaxed))
+                {
+                    return false;
+                }
+            }
+        }
+        void Unlock(amf_long iCount = 1)
+        {
+            amf_long old = m_count.fetch_add(iCount, std::memory_order_release);
+            amf_long toWake = old < 0 ? AMF_MIN(-old, iCount) : 0;
+            for(amf_long i = 0; i < toWake; i++)
+            {
+                m_sem.Unlock();
+            }
+        }
+        // not thread safe: only for idle objects
+        void Reset(amf_long iCount)
+        {
+            m_count.store(iCount, std::memory_order_relaxed);
+        }
+        amf_long GetCount() const
+        {
+            amf_long count = m_count.load(std::memory_order_relaxed);
+            return count > 0 ? count : 0;
+        }
+    };
+    //----------------------------------------------------------------
     class AMFThreadObj;
     class AMFThread
     {
@@ -463,6 +569,292 @@ namespace amf
         }
     };
     //----------------------------------------------------------------
+    // bounded replacement for AMFQueue: a preallocated ring of cells, no heap allocation per item,
+    // free-slot / item counts kept in AMFLightSemaphore so Add() wakes exactly one waiting Get()
+    // and Get() wakes exactly one blocked Add().
+    // A queue size of 0 means unbounded like in AMFQueue: the ring is not allocated and all calls
+    // go to the AMFQueue implementation
+    enum AMF_RING_QUEUE_MODE
+    {
+        AMF_RING_QUEUE_MPMC = 0,        // any number of producers and consumers, lock free
+        AMF_RING_QUEUE_SPSC,            // one producer and one consumer thread (Clear() counts as consumer)
+        AMF_RING_QUEUE_PRIORITY,        // ordered by priority like AMFQueue, heap under a critical section
+    };
+
+    #define AMF_CACHE_LINE_SIZE         64
+
+    template<typename T>
+    class AMFRingQueue : public AMFQueue<T>
+    {
+    protected:
+        struct Cell
+        {
+            std::atomic<amf_size> sequence;
+            amf_ulong ulID;
+            T data;
+            Cell() : sequence(0), ulID(), data() {}
+        };
+        struct PriorityItem
+        {
+            T data;
+            amf_ulong ulID;
+            amf_long ulPriority;
+            amf_uint64 order;
+            PriorityItem() : data(), ulID(), ulPriority(), order() {}
+            bool operator<(const PriorityItem& other) const // max heap: higher priority, then older item on top
+            {
+                return ulPriority != other.ulPriority ? ulPriority < other.ulPriority : order > other.order;
+            }
+        };
+
+        AMF_RING_QUEUE_MODE         m_eMode;
+        Cell*                       m_pCells;
+        amf_size                    m_Mask;
+        std::vector<PriorityItem>   m_Heap;
+        amf_uint64                  m_iOrder;
+        AMFCriticalSection          m_HeapSect;
+        AMFLightSemaphore           m_FreeSlots;
+        AMFLightSemaphore           m_Items;
+
+        // producer and consumer positions live on their own cache lines
+        char                        m_Pad0[AMF_CACHE_LINE_SIZE];
+        std::atomic<amf_size>       m_EnqueuePos;
+        char                        m_Pad1[AMF_CACHE_LINE_SIZE - sizeof(std::atomic<amf_size>)];
+        std::atomic<amf_size>       m_DequeuePos;
+        char                        m_Pad2[AMF_CACHE_LINE_SIZE - sizeof(std::atomic<amf_size>)];
+
+        bool IsUnbounded() const
+        {
+            return this->m_iQueueSize <= 0;
+        }
+        bool Allocate(amf_int32 iQueueSize)
+        {
+            delete [] m_pCells;
+            m_pCells = NULL;
+            m_Heap.clear();
+
+            if(iQueueSize <= 0)
+            {
+                return AMFQueue<T>::SetQueueSize(0);
+            }
+            this->m_iQueueSize = iQueueSize;
+
+            if(m_eMode == AMF_RING_QUEUE_PRIORITY)
+            {
+                m_Heap.reserve((amf_size)iQueueSize);
+            }
+            else
+            {
+                amf_size capacity = 1;
+                while(capacity < (amf_size)iQueueSize)
+                {
+                    capacity <<= 1;
+                }
+                m_pCells = new Cell[capacity];
+                for(amf_size i = 0; i < capacity; i++)
+                {
+                    m_pCells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                m_Mask = capacity - 1;
+            }
+            m_EnqueuePos.store(0, std::memory_order_relaxed);
+            m_DequeuePos.store(0, std::memory_order_relaxed);
+            m_FreeSlots.Reset(iQueueSize);
+            m_Items.Reset(0);
+            return true;
+        }
+        // caller owns a free-slot unit
+        void Push(amf_ulong ulID, const T& item, amf_long ulPriority)
+        {
+            if(m_eMode == AMF_RING_QUEUE_PRIORITY)
+            {
+                AMFLock lock(&m_HeapSect);
+                PriorityItem entry;
+                entry.data = item;
+                entry.ulID = ulID;
+                entry.ulPriority = ulPriority;
+                entry.order = m_iOrder++;
+                m_Heap.push_back(entry);
+                std::push_heap(m_Heap.begin(), m_Heap.end());
+                return;
+            }
+            amf_size pos = m_EnqueuePos.load(std::memory_order_relaxed);
+            Cell* pCell = NULL;
+            if(m_eMode == AMF_RING_QUEUE_SPSC)
+            {
+                pCell = &m_pCells[pos & m_Mask];
+                m_EnqueuePos.store(pos + 1, std::memory_order_relaxed);
+            }
+            else
+            {
+                for(;;)
+                {
+                    pCell = &m_pCells[pos & m_Mask];
+                    std::ptrdiff_t diff = (std::ptrdiff_t)pCell->sequence.load(std::memory_order_acquire) - (std::ptrdiff_t)pos;
+                    if(diff == 0)
+                    {
+                        if(m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if(diff < 0)
+                    {
+                        amf_sleep(0); // consumer of this cell has not released it yet
+                        pos = m_EnqueuePos.load(std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        pos = m_EnqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+            while(pCell->sequence.load(std::memory_order_acquire) != pos) // SPSC: wait for the consumer to release the cell
+            {
+                amf_sleep(0);
+            }
+            pCell->ulID = ulID;
+            pCell->data = item;
+            pCell->sequence.store(pos + 1, std::memory_order_release);
+        }
+        // caller owns an item unit
+        void Pop(amf_ulong& ulID, T& item)
+        {
+            if(m_eMode == AMF_RING_QUEUE_PRIORITY)
+            {
+                AMFLock lock(&m_HeapSect);
+                std::pop_heap(m_Heap.begin(), m_Heap.end());
+                PriorityItem& entry = m_Heap.back();
+                ulID = entry.ulID;
+                item = entry.data;
+                m_Heap.pop_back();
+                return;
+            }
+            amf_size pos = m_DequeuePos.load(std::memory_order_relaxed);
+            Cell* pCell = NULL;
+            if(m_eMode == AMF_RING_QUEUE_SPSC)
+            {
+                pCell = &m_pCells[pos & m_Mask];
+                m_DequeuePos.store(pos + 1, std::memory_order_relaxed);
+            }
+            else
+            {
+                for(;;)
+                {
+                    pCell = &m_pCells[pos & m_Mask];
+                    std::ptrdiff_t diff = (std::ptrdiff_t)pCell->sequence.load(std::memory_order_acquire) - (std::ptrdiff_t)(pos + 1);
+                    if(diff == 0)
+                    {
+                        if(m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if(diff < 0)
+                    {
+                        amf_sleep(0); // producer of this cell is still writing it
+                        pos = m_DequeuePos.load(std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        pos = m_DequeuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+            while(pCell->sequence.load(std::memory_order_acquire) != pos + 1)
+            {
+                amf_sleep(0);
+            }
+            ulID = pCell->ulID;
+            item = pCell->data;
+            pCell->data = T(); // release references (surfaces, buffers) right away
+            pCell->sequence.store(pos + m_Mask + 1, std::memory_order_release);
+        }
+    public:
+        // iQueueSize 0 - unbounded, same as AMFQueue
+        AMFRingQueue(amf_int32 iQueueSize = 0, AMF_RING_QUEUE_MODE eMode = AMF_RING_QUEUE_MPMC)
+            : AMFQueue<T>(0),
+            m_eMode(eMode),
+            m_pCells(NULL),
+            m_Mask(0),
+            m_Heap(),
+            m_iOrder(0),
+            m_HeapSect(),
+            m_FreeSlots(0),
+            m_Items(0),
+            m_EnqueuePos(0),
+            m_DequeuePos(0)
+        {
+            Allocate(iQueueSize);
+        }
+        virtual ~AMFRingQueue()
+        {
+            delete [] m_pCells;
+        }
+        // not thread safe: call before the queue is shared
+        virtual bool SetQueueSize(amf_int32 iQueueSize)
+        {
+            Clear();
+            return Allocate(iQueueSize);
+        }
+        // ulPriority is ignored unless the queue was created with AMF_RING_QUEUE_PRIORITY or is unbounded
+        virtual bool Add(amf_ulong ulID, const T& item, amf_long ulPriority = 0, amf_ulong ulTimeout = AMF_INFINITE)
+        {
+            if(IsUnbounded())
+            {
+                return AMFQueue<T>::Add(ulID, item, ulPriority, ulTimeout);
+            }
+            if(!m_FreeSlots.Lock(ulTimeout))
+            {
+                return false;
+            }
+            Push(ulID, item, ulPriority);
+            m_Items.Unlock();
+            return true;
+        }
+        virtual bool Get(amf_ulong& ulID, T& item, amf_ulong ulTimeout)
+        {
+            if(IsUnbounded())
+            {
+                return AMFQueue<T>::Get(ulID, item, ulTimeout);
+            }
+            if(!m_Items.Lock(ulTimeout))
+            {
+                return false;
+            }
+            Pop(ulID, item);
+            m_FreeSlots.Unlock();
+            return true;
+        }
+        virtual void Clear()
+        {
+            if(IsUnbounded())
+            {
+                AMFQueue<T>::Clear();
+                return;
+            }
+            while(m_Items.TryLock())
+            {
+                amf_ulong ulID;
+                T item;
+                Pop(ulID, item);
+                m_FreeSlots.Unlock();
+            }
+        }
+        virtual amf_size GetSize()
+        {
+            if(IsUnbounded())
+            {
+                return AMFQueue<T>::GetSize();
+            }
+            return (amf_size)m_Items.GetCount();
+        }
+        AMF_RING_QUEUE_MODE GetMode() const
+        {
+            return m_eMode;
+        }
+    };
+    //----------------------------------------------------------------
     template<class inT, class outT>
     class AMFQueueThread : public AMFThread
     {
@@ -648,6 +1040,148 @@ namespace amf
         }
     };
     //----------------------------------------------------------------
+    // shared work-stealing thread pool
+    // every worker owns a deque: it pops its own tasks LIFO and steals from the others FIFO,
+    // threads waiting on an AMFTaskGroup execute queued tasks instead of sleeping
+    //----------------------------------------------------------------
+    typedef void (AMF_CDECL_CALL *AMFTaskProc)(void* pContext, amf_int64 iBegin, amf_int64 iEnd);
+
+    class AMFTaskGroup;
+    class AMFThreadPool
+    {
+    public:
+        struct Task
+        {
+            AMFTaskProc     pProc;
+            void*           pContext;
+            amf_int64       iBegin;
+            amf_int64       iEnd;
+            AMFTaskGroup*   pGroup;
+        };
+
+        // process-wide pool: created by the first AcquireShared() and stopped by the last
+        // ReleaseShared(), so a module can join the workers before it is unloaded
+        static AMFThreadPool* AcquireShared();
+        static void ReleaseShared();
+
+        // iThreads = 0 - one worker per CPU core; bPinThreads - bind worker N to CPU N
+        AMFThreadPool(amf_int32 iThreads = 0, bool bPinThreads = false);
+        virtual ~AMFThreadPool();
+
+        amf_int32 GetWorkerCount() const { return (amf_int32)m_Workers.size(); }
+
+        // iAffinity - preferred worker or -1; idle workers can still steal the task
+        void Submit(const Task& task, amf_int32 iAffinity = -1);
+        // executes one queued task on the calling thread, returns false if nothing is queued
+        bool RunPendingTask();
+
+        // calls func(iChunkBegin, iChunkEnd) over [iBegin, iEnd) split into chunks of at least iGrain,
+        // the calling thread runs the first chunk and returns when all chunks are done
+        template<typename F>
+        void ParallelFor(amf_int64 iBegin, amf_int64 iEnd, amf_int64 iGrain, const F& func);
+
+    protected:
+        class Worker;
+        struct Deque
+        {
+            AMFCriticalSection  sync;
+            std::deque<Task>    tasks;
+        };
+
+        void WorkerLoop(amf_int32 iWorker);
+        void Pop(amf_int32 iWorker, Task& task);
+        void Execute(Task& task);
+
+        std::vector<Worker*>    m_Workers;
+        std::vector<Deque*>     m_Deques;   // one per worker, the last one takes tasks from other threads
+        AMFLightSemaphore       m_Pending;  // one unit per queued task
+        std::atomic<bool>       m_bStop;
+        bool                    m_bPinThreads;
+    private:
+        AMFThreadPool(const AMFThreadPool&);
+        AMFThreadPool& operator=(const AMFThreadPool&);
+    };
+    //----------------------------------------------------------------
+    // fork/join: Run() queues tasks into the pool, Wait() helps executing them until all are done
+    class AMFTaskGroup
+    {
+        friend class AMFThreadPool;
+    public:
+        AMFTaskGroup(AMFThreadPool* pPool) : m_pPool(pPool), m_Pending(0), m_DoneEvent(false, false)
+        {}
+        ~AMFTaskGroup()
+        {
+            Wait();
+        }
+        void Run(AMFTaskProc pProc, void* pContext, amf_int64 iBegin, amf_int64 iEnd, amf_int32 iAffinity = -1)
+        {
+            AMFThreadPool::Task task = { pProc, pContext, iBegin, iEnd, this };
+            m_Pending.fetch_add(1, std::memory_order_relaxed);
+            m_pPool->Submit(task, iAffinity);
+        }
+        void Wait()
+        {
+            while(m_Pending.load(std::memory_order_acquire) > 0)
+            {
+                if(!m_pPool->RunPendingTask())
+                {
+                    m_DoneEvent.Lock();
+                }
+            }
+            AMFLock lock(&m_sync); // the last Done() may still be setting the event
+        }
+    protected:
+        void Done()
+        {
+            AMFLock lock(&m_sync);
+            if(m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                m_DoneEvent.SetEvent();
+            }
+        }
+
+        AMFThreadPool*          m_pPool;
+        std::atomic<amf_long>   m_Pending;
+        AMFEvent                m_DoneEvent;
+        AMFCriticalSection      m_sync;
+    private:
+        AMFTaskGroup(const AMFTaskGroup&);
+        AMFTaskGroup& operator=(const AMFTaskGroup&);
+    };
+    //----------------------------------------------------------------
+    template<typename F>
+    void AMFThreadPool::ParallelFor(amf_int64 iBegin, amf_int64 iEnd, amf_int64 iGrain, const F& func)
+    {
+        if(iEnd <= iBegin)
+        {
+            return;
+        }
+        iGrain = iGrain > 0 ? iGrain : 1;
+        amf_int64 iChunks = (iEnd - iBegin + iGrain - 1) / iGrain;
+        iChunks = AMF_MIN(iChunks, (amf_int64)GetWorkerCount() + 1);
+        if(iChunks <= 1)
+        {
+            func(iBegin, iEnd);
+            return;
+        }
+        struct Context
+        {
+            static void AMF_CDECL_CALL Proc(void* pContext, amf_int64 iChunkBegin, amf_int64 iChunkEnd)
+            {
+                (*static_cast<const F*>(pContext))(iChunkBegin, iChunkEnd);
+            }
+        };
+        AMFTaskGroup group(this);
+        const amf_int64 iRange = iEnd - iBegin;
+        for(amf_int64 i = 1; i < iChunks; i++)
+        {
+            // chunk N prefers worker N - 1 so consecutive calls keep the same rows on the same worker
+            group.Run(&Context::Proc, (void*)&func, iBegin + iRange * i / iChunks, iBegin + iRange * (i + 1) / iChunks, amf_int32(i - 1));
+        }
+        func(iBegin, iBegin + iRange / iChunks);
+        group.Wait();
+    }
+    //----------------------------------------------------------------
     class AMFPreciseWaiter
     {
     public:
@@ -717,5 +1251,112 @@ namespace amf
         bool m_bCancel;
     };
     //----------------------------------------------------------------
+    // sleeps in the kernel until an absolute deadline, no polling or spinning. Unlike AMFPreciseWaiter,
+    // waits are in amf_pts units at full precision and a Cancel() that arrives while nobody waits
+    // is latched: the next wait returns immediately
+    class AMFDeadlineWaiter
+    {
+    public:
+        AMFDeadlineWaiter() : m_hWaiter(amf_create_waiter())
+        {}
+        virtual ~AMFDeadlineWaiter()
+        {
+            amf_delete_waiter(m_hWaiter);
+        }
+        // returns time actually waited, less than waittime if cancelled
+        amf_pts Wait(amf_pts waittime)
+        {
+            if (waittime < 0)
+            {
+                return 0;
+            }
+            amf_pts start = amf_high_precision_clock();
+            amf_wait_until(m_hWaiter, start + waittime);
+            return amf_high_precision_clock() - start;
+        }
+        // deadline in amf_high_precision_clock() units, returns false if cancelled
+        bool WaitUntil(amf_pts deadline)
+        {
+            return amf_wait_until(m_hWaiter, deadline);
+        }
+        // wakes the current wait or, if nobody waits, makes the next one return immediately
+        void Cancel()
+        {
+            amf_cancel_wait(m_hWaiter);
+        }
+    protected:
+        amf_handle m_hWaiter;
+    private:
+        AMFDeadlineWaiter(const AMFDeadlineWaiter&);
+        AMFDeadlineWaiter& operator=(const AMFDeadlineWaiter&);
+    };
+    //----------------------------------------------------------------
+    // frame pacing clock for presenters and capture loops: ticks are on a fixed grid
+    // start + N * period, so a late frame does not shift the following ones
+    class AMFFramePacer
+    {
+    public:
+        AMFFramePacer(amf_pts period = 0) : m_period(period), m_start(-1LL), m_frame(0), m_dropped(0)
+        {}
+        void SetPeriod(amf_pts period)
+        {
+            m_period = period;
+            Reset();
+        }
+        void SetFrameRate(AMFRate rate)
+        {
+            SetPeriod(rate.num != 0 ? amf_pts(AMF_SECOND) * rate.den / rate.num : 0);
+        }
+        amf_pts GetPeriod() const { return m_period; }
+        // the next WaitNextFrame() starts a new grid at the current time
+        void Reset()
+        {
+            m_start = -1LL;
+            m_frame = 0;
+        }
+        amf_pts GetNextDeadline() const
+        {
+            return m_start < 0 ? amf_high_precision_clock() : m_start + m_frame * m_period;
+        }
+        // sleeps until the next tick; if more than a whole period late, skips the missed ticks.
+        // returns false if cancelled
+        bool WaitNextFrame()
+        {
+            if (m_period <= 0)
+            {
+                return true;
+            }
+            amf_pts now = amf_high_precision_clock();
+            if (m_start < 0)
+            {
+                m_start = now;
+                m_frame = 1;
+                return true;
+            }
+            amf_pts deadline = m_start + m_frame * m_period;
+            if (now - deadline >= m_period)
+            {
+                amf_int64 missed = (now - deadline) / m_period;
+                m_dropped += missed;
+                m_frame += missed;
+                deadline += missed * m_period;
+            }
+            m_frame++;
+            return now >= deadline || m_waiter.WaitUntil(deadline);
+        }
+        void Cancel()
+        {
+            m_waiter.Cancel();
+        }
+        amf_int64 GetFrameCount() const { return m_frame; }
+        amf_int64 GetDroppedTicks() const { return m_dropped; }
+    protected:
+        AMFDeadlineWaiter   m_waiter;
+        amf_pts             m_period;
+        amf_pts             m_start;
+        amf_int64           m_frame;    // index of the next tick
+        amf_int64           m_dropped;
+    };
+    //----------------------------------------------------------------
 } // namespace amf
 #endif // AMF_Thread_h
@@ -296,6 +296,86 @@ void AMF_CDECL_CALL amf_sleep(amf_ulong delay)
 #endif
 }
 //----------------------------------------------------------------------------------------
+// precise waiter: high resolution waitable timer (Windows 10 1803+, regular timer before) and a cancel event
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+struct MyWaiter
+{
+    HANDLE m_hTimer;
+    HANDLE m_hCancel;
+};
+//----------------------------------------------------------------------------------------
+amf_handle AMF_CDECL_CALL amf_create_waiter()
+{
+    MyWaiter* waiter = new MyWaiter;
+    waiter->m_hTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if(waiter->m_hTimer == NULL)
+    {
+        waiter->m_hTimer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+    }
+    waiter->m_hCancel = CreateEventW(NULL, FALSE, FALSE, NULL);
+    return (amf_handle)waiter;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_CDECL_CALL amf_delete_waiter(amf_handle hwaiter)
+{
+    if(hwaiter == NULL)
+    {
+        return false;
+    }
+    MyWaiter* waiter = (MyWaiter*)hwaiter;
+    if(waiter->m_hTimer != NULL)
+    {
+        CloseHandle(waiter->m_hTimer);
+    }
+    if(waiter->m_hCancel != NULL)
+    {
+        CloseHandle(waiter->m_hCancel);
+    }
+    delete waiter;
+    return true;
+}
+//----------------------------------------------------------------------------------------
+bool AMF_CDECL_CALL amf_wait_until(amf_handle hwaiter, amf_pts deadline)
+{
+    if(hwaiter == NULL)
+    {
+        return false;
+    }
+    MyWaiter* waiter = (MyWaiter*)hwaiter;
+    for(;;)
+    {
+        amf_pts remaining = deadline - amf_high_precision_clock();
+        if(remaining <= 0)
+        {
+            return WaitForSingleObject(waiter->m_hCancel, 0) != WAIT_OBJECT_0;
+        }
+        // the timer runs on the system clock, rearm from the remaining QPC time
+        LARGE_INTEGER due;
+        due.QuadPart = -remaining; // relative, in 100 ns units
+        if(waiter->m_hTimer == NULL || !SetWaitableTimer(waiter->m_hTimer, &due, 0, NULL, NULL, FALSE))
+        {
+            return WaitForSingleObject(waiter->m_hCancel, (DWORD)((remaining + 9999) / 10000)) != WAIT_OBJECT_0;
+        }
+        HANDLE handles[2] = { waiter->m_hCancel, waiter->m_hTimer };
+        if(WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0)
+        {
+            CancelWaitableTimer(waiter->m_hTimer);
+            return false;
+        }
+    }
+}
+//----------------------------------------------------------------------------------------
+bool AMF_CDECL_CALL amf_cancel_wait(amf_handle hwaiter)
+{
+    if(hwaiter == NULL)
+    {
+        return false;
+    }
+    return SetEvent(((MyWaiter*)hwaiter)->m_hCancel) != FALSE;
+}
+//----------------------------------------------------------------------------------------
 amf_pts AMF_CDECL_CALL amf_high_precision_clock()
 {
     static int state = 0;
@@ -461,5 +541,19 @@ amf_int32 AMF_STD_CALL amf_get_cpu_cores()
     return 1;
 }
 //----------------------------------------------------------------------------------------
+bool AMF_STD_CALL amf_set_thread_affinity(amf_int32 iCpu)
+{
+    SYSTEM_INFO info = {};
+    GetSystemInfo(&info);
+    if (iCpu < 0 || info.dwNumberOfProcessors == 0)
+    {
+        return false;
+    }
+    // affinity masks cover the processor group of the calling thread
+    DWORD cpus = AMF_MIN(info.dwNumberOfProcessors, (DWORD)(sizeof(DWORD_PTR) * 8));
+    DWORD_PTR mask = DWORD_PTR(1) << (iCpu % cpus);
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+//----------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------
 #endif // _WIN32
\ No newline at end of file
@@ -44,6 +44,7 @@
 // component properties
 #define FFMPEG_DEMUXER_PATH                     L"Path"                     // string - the file to open
 #define FFMPEG_DEMUXER_URL                      L"Url"                      // string - the stream url to open
+#define FFMPEG_DEMUXER_INPUT_STREAM             L"InputStream"              // AMFInterface* (AMFDataStream) - read from this stream instead of Path or Url; Seek() needs a seekable stream
 #define FFMPEG_DEMUXER_START_FRAME              L"StartFrame"               // amf_int64 (default = 0)
 #define FFMPEG_DEMUXER_FRAME_COUNT              L"FramesNumber"             // amf_int64 (default = 0)
 #define FFMPEG_DEMUXER_DURATION                 L"Duration"                 // amf_int64 (default = 0)
@@ -51,6 +52,13 @@
 //#define FFMPEG_DEMUXER_SYNC_AV                  L"SyncAV"                   // bool (default = false)
 #define FFMPEG_DEMUXER_INDIVIDUAL_STREAM_MODE   L"StreamMode"               // bool (default = true)
 #define FFMPEG_DEMUXER_LISTEN                   L"Listen"                   // bool (default = false)
+#define FFMPEG_DEMUXER_ZERO_COPY                L"ZeroCopy"                 // bool (default = false) - output buffers reference the demuxed packet data instead of a copy
+#define FFMPEG_DEMUXER_ALL_STREAMS              L"AllStreams"               // bool (default = false) - expose every video, audio, subtitle and data stream as an output, not only the main video and audio
+#define FFMPEG_DEMUXER_READ_AHEAD               L"ReadAhead"                // bool (default = false) - stream mode only: a reader thread fills per-output queues, outputs never block each other
+#define FFMPEG_DEMUXER_READ_AHEAD_MAX_BYTES     L"ReadAheadMaxBytes"        // amf_int64 (default = 32MB) - per output queue limit, reading pauses while every enabled output is at its limit; 0 - no limit
+#define FFMPEG_DEMUXER_READ_AHEAD_MAX_DURATION  L"ReadAheadMaxDuration"     // amf_int64 (default = 2 sec) - per output queue limit in AMF time units; 0 - no limit
+#define FFMPEG_DEMUXER_KEYFRAME_INDEX           L"KeyframeIndex"            // bool (default = false) - file input only: seek through a keyframe index of the main video stream, built in background and cached
+#define FFMPEG_DEMUXER_KEYFRAME_INDEX_PATH      L"KeyframeIndexPath"        // string - sidecar file of the keyframe index; empty - file path + ".amfkfi"
 
 // for common, video and audio properties see Component.h
 
@@ -51,4 +51,16 @@
 #define FFMPEG_MUXER_VIDEO_ROTATION           L"VideoRotation"            // amf_int64 (0, 90, 180, 270, default = 0)
 #define FFMPEG_MUXER_USAGE_IS_TRIM            L"UsageIsTrim"              // bool (default = false)
 
+// write path
+#define FFMPEG_MUXER_ASYNC_WRITE              L"AsyncWrite"               // bool (default = false) - write packets on a separate thread
+#define FFMPEG_MUXER_WRITE_QUEUE_SIZE         L"WriteQueueSize"           // amf_int64 (default = 64) - packets queued in async mode before SubmitInput returns AMF_INPUT_FULL
+#define FFMPEG_MUXER_IO_BUFFER_SIZE           L"IOBufferSize"             // amf_int64 (default = 0) - write buffer in bytes for PATH outputs, 0 - FFmpeg file protocol
+#define FFMPEG_MUXER_DIRECT_IO                L"DirectIO"                 // bool (default = false) - O_DIRECT for full buffers, needs IO_BUFFER_SIZE, Linux only
+#define FFMPEG_MUXER_SYNC_INTERVAL            L"SyncInterval"             // amf_int64 (default = 0) - bytes written between fdatasync calls, needs IO_BUFFER_SIZE, 0 - never
+
+// write statistics, read only
+#define FFMPEG_MUXER_STAT_QUEUE_DEPTH         L"StatQueueDepth"           // amf_int64 - packets waiting for the writer thread
+#define FFMPEG_MUXER_STAT_WRITE_LATENCY_AVG   L"StatWriteLatencyAvg"      // amf_pts - average time spent in av_interleaved_write_frame
+#define FFMPEG_MUXER_STAT_WRITE_LATENCY_MAX   L"StatWriteLatencyMax"      // amf_pts - longest av_interleaved_write_frame call
+
 #endif //#ifndef AMF_FileMuxerFFMPEG_h
@@ -47,6 +47,7 @@
 #define VIDEO_DECODER_BITRATE              L"BitRate"          // amf_int64 (default = 0)
 #define VIDEO_DECODER_FRAMERATE            L"FrameRate"        // AMFRate
 #define VIDEO_DECODER_SEEK_POSITION        L"SeekPosition"     // amf_int64 (default = 0)
+#define VIDEO_DECODER_ZERO_COPY            L"ZeroCopy"         // bool (default = false) - output surfaces wrap decoded frames when the layout matches; such surfaces must not be written to
 
 #define VIDEO_DECODER_COLOR_TRANSFER_CHARACTERISTIC L"ColorTransferChar"    // amf_int64(AMF_COLOR_TRANSFER_CHARACTERISTIC_ENUM); default = AMF_COLOR_TRANSFER_CHARACTERISTIC_UNDEFINED, ISO/IEC 23001-8_2013   7.2
 
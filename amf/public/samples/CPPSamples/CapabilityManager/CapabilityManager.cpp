@@ -508,9 +508,6 @@ bool QueryConverterCaps(amf::AMFContext* pContext)
     return result;
 }
 
-#if !defined(__aarch64__) && !defined(__arm__)
-const InstructionSet::InstructionSet_Internal InstructionSet::CPU_Rep;
-#endif
 void QueryCPUForSSE()
 {
     #if !defined(__aarch64__) && !defined(__arm__)
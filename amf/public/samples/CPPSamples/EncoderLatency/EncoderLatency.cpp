@@ -810,7 +810,7 @@ int main(int argc, char* argv[])
         amf_pts   max_latency = 0;
         amf_pts   latency_time = 0;
         amf_pts   write_duration = 0;
-        amf::AMFPreciseWaiter waiter;
+        amf::AMFFramePacer pacer(amf_pts(AMF_SECOND / fFrameRate));
 
         // output file, if we have one
         amf::AMFDataStreamPtr pLogFile;
@@ -823,7 +823,10 @@ int main(int argc, char* argv[])
         amf_pts begin_time = amf_high_precision_clock();
         while (submitted < frameCount)
         {
-            amf_pts begin_frame = amf_high_precision_clock();
+            if (bRealTime == true)
+            {
+                pacer.WaitNextFrame();
+            }
 
             if (preRenderedSurf.empty() == false)
             {
@@ -888,15 +891,6 @@ int main(int argc, char* argv[])
                 pLogFile->Write(buffer->GetNative(), buffer->GetSize(), NULL);
                 write_duration += amf_high_precision_clock() - poll_time;
             }
-            if (bRealTime == true)
-            {
-                amf_pts end_frame = amf_high_precision_clock();
-                amf_pts time_to_sleep = amf_pts(AMF_SECOND / fFrameRate) - (end_frame - begin_frame);
-                if (time_to_sleep > 0)
-                {
-                    waiter.Wait(time_to_sleep);
-                }
-            }
         }
         amf_pts end_time = amf_high_precision_clock();
         printTime(end_time - begin_time, latency_time, first_frame, min_latency, max_latency);
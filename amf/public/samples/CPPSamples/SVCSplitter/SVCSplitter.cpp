@@ -36,6 +36,7 @@
 #include <tchar.h>
 #include "SVCSplitter.h"
 #include "../common/CmdLogger.h"
+#include "../common/StartCodeScanner.h"
 #include "public/common/AMFFactory.h"
 
 
@@ -305,18 +306,17 @@ AMF_RESULT SVCSplitter::GetTemporalIndex(amf::AMFBuffer *buffer, amf_int32 &inde
     amf_uint8 *data = (amf_uint8 *)buffer->GetNative();
     amf_size size = buffer->GetSize();
 
-    for (amf_size i = 0; i < size; )
+    for (amf_size i = StartCodeScanner::FindStartCode(data, size); i < size; )
     {
-        if (0 == data[i] &&
-            0 == data[i + 1] &&
-            0 == data[i + 2] &&
-            1 == data[i + 3])
+        i += 3;
+        if (i >= size)
         {
-            i += 4;
-            // NAL unit - check it
-            NaluHeader* pHdr = reinterpret_cast<NaluHeader*>(data+i);
-            amf_uint8 naluType = pHdr->nal_unit_type;
-            i++;
+            break;
+        }
+        // NAL unit - check it
+        NaluHeader* pHdr = reinterpret_cast<NaluHeader*>(data+i);
+        amf_uint8 naluType = pHdr->nal_unit_type;
+        i++;
 // this is test code
 //            if(naluType == NALU_TYPE_IDR)
 //            {
@@ -324,23 +324,22 @@ AMF_RESULT SVCSplitter::GetTemporalIndex(amf::AMFBuffer *buffer, amf_int32 &inde
 //                return AMF_OK;
 //            }
 
-            if(naluType == NALU_TYPE_PREFIX || naluType == NALU_TYPE_SLC_EXT)
+        if(naluType == NALU_TYPE_PREFIX || naluType == NALU_TYPE_SLC_EXT)
+        {
+            if (i + sizeof(NaluHeaderExt) > size)
             {
-                NaluHeaderExt* pHdrExt = reinterpret_cast<NaluHeaderExt*>(data+i);
-                if (pHdrExt->reserved_three_2bits != 0x3)
-                {
-                    CHECK_AMF_ERROR_RETURN(AMF_INVALID_FORMAT, L"Fail: wrong Prefix syntax");
-                }
-                index = pHdrExt->temporal_id;
-                return AMF_OK;
+                CHECK_AMF_ERROR_RETURN(AMF_INVALID_FORMAT, L"Fail: truncated Prefix");
             }
-
-
-        }
-        else
-        {
-            i += 1;
+            NaluHeaderExt* pHdrExt = reinterpret_cast<NaluHeaderExt*>(data+i);
+            if (pHdrExt->reserved_three_2bits != 0x3)
+            {
+                CHECK_AMF_ERROR_RETURN(AMF_INVALID_FORMAT, L"Fail: wrong Prefix syntax");
+            }
+            index = pHdrExt->temporal_id;
+            return AMF_OK;
         }
+        // skip the NAL unit payload to the next start code
+        i += StartCodeScanner::FindStartCode(data + i, size - i);
     }
     return AMF_OK;
 }
@@ -43,6 +43,7 @@
 #include "public/include/components/VideoDecoderUVD.h"
 #include "public/common/DataStream.h"
 #include "../common/BitStreamParser.h"
+#include "../common/BitStreamIndex.h"
 #include "public/samples/CPPSamples/common/MiscHelpers.h"
 #include "public/samples/CPPSamples/common/SurfaceUtils.h"
 #include "public/samples/CPPSamples/common/PollingThread.h"
@@ -62,6 +63,7 @@ static amf::AMF_MEMORY_TYPE memoryTypeOut   = amf::AMF_MEMORY_VULKAN;
 #endif
 static amf::AMF_SURFACE_FORMAT formatOut    = amf::AMF_SURFACE_NV12;
 static amf_int32 frameCount                 = 500; // -1 means entire file
+static amf_int32 startFrame                 = 0; // optional second argument, decoding starts at the IRAP at or before it
 static amf_int32 submitted = 0;
 
 // The memory transfer from DX9 to HOST and writing a raw file is longer than decode time. To measure decode time correctly disable convert and write here:
@@ -103,6 +105,14 @@ int main(int argc, char* argv[])
 #endif
         fileNameIn = fileNameInW.c_str();
     }
+    if(argc > 2)
+    {
+#if defined(_WIN32) && defined(_UNICODE)
+        startFrame = _wtoi(argv[2]);
+#else
+        startFrame = atoi(argv[2]);
+#endif
+    }
     AMF_RESULT              res = AMF_OK; // error checking can be added later
     res = g_AMFFactory.Init();
     if(res != AMF_OK)
@@ -159,6 +169,16 @@ int main(int argc, char* argv[])
 	// H264/H265 elemntary stream parser from samples common
 	parser = BitStreamParser::Create(datastream, bsType, context);
 
+    if(startFrame > 0)
+    { // the index is cached next to the input, later runs skip the scan
+        BitStreamIndex index;
+        amf_size irap = 0;
+        if(index.Open(fileNameIn, bsType) == AMF_OK && index.Seek(parser.get(), startFrame, &irap) == AMF_OK)
+        {
+            wprintf(L"decoding from frame %d\n", (int)irap);
+        }
+    }
+
     // open output file with frame size in file name
     wchar_t fileNameOutWidthSize[2000];
     swprintf(fileNameOutWidthSize, amf_countof(fileNameOutWidthSize), fileNameOut, parser->GetPictureWidth(), parser->GetPictureHeight());
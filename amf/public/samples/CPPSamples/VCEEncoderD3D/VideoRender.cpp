@@ -48,8 +48,7 @@ VideoRender::VideoRender(amf_int width, amf_int height, bool bInterlaced, amf_in
     m_frames(frames),
     m_framesRendered(0),
     m_bInterlaced(bInterlaced),
-	m_renderFps(0),
-	m_lastRenderTime(0)
+	m_renderFps(0)
 {
 
 }
@@ -96,14 +95,7 @@ AMF_RESULT VideoRender::QueryOutput(amf::AMFData** ppData)
     {
 		if (m_renderFps > 0) //render with the fps setting.
 		{
-			amf_int64 currentTime = amf_high_precision_clock();
-			amf::AMFPreciseWaiter waiter;
-			amf_int64 waittime = (AMF_SECOND / m_renderFps) - (currentTime - m_lastRenderTime);
-			if(waittime>0)
-			{
-				waiter.WaitEx(waittime);
-			}
-			m_lastRenderTime = amf_high_precision_clock();
+			m_pacer.WaitNextFrame();
 		}
 
         AMF_RESULT res = Render(ppData);
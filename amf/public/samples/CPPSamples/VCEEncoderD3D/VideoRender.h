@@ -54,7 +54,7 @@ public:
 
     virtual amf_int32 GetInputSlotCount() const { return 0; }
     virtual amf_int32 GetOutputSlotCount() const { return 1; }
-	virtual void	  SetRenderFrameRate(amf_int fps) { m_renderFps = fps; }
+	virtual void	  SetRenderFrameRate(amf_int fps) { m_renderFps = fps; m_pacer.SetPeriod(fps > 0 ? AMF_SECOND / fps : 0); }
 
     static VideoRenderPtr Create(amf_int width, amf_int height, bool bInterlaced, amf_int frames, amf::AMF_MEMORY_TYPE type, amf::AMF_MEMORY_TYPE encodertype, amf::AMFContext* pContext);
 protected:
@@ -68,6 +68,6 @@ protected:
     amf_int                             m_frames;
     amf_int                             m_framesRendered;
 	amf_int								m_renderFps;
-	amf_int64							m_lastRenderTime;
+	amf::AMFFramePacer					m_pacer;
 };
 
@@ -0,0 +1,668 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "BitStreamIndex.h"
+#include "StartCodeScanner.h"
+#include "public/common/DataStream.h"
+#include "public/common/Thread.h"
+#include "public/common/TraceAdapter.h"
+
+#include <algorithm>
+#include <map>
+
+#define AMF_FACILITY L"BitStreamIndex"
+
+static const char       BITSTREAM_INDEX_MAGIC[8]    = { 'A', 'M', 'F', 'B', 'S', 'I', 'D', 'X' };
+static const amf_uint32 BITSTREAM_INDEX_VERSION     = 1;
+static const size_t     BITSTREAM_INDEX_HEADER_SIZE = sizeof(BITSTREAM_INDEX_MAGIC) + 4 + 4 + 8 + 4 + 8;
+static const size_t     BITSTREAM_INDEX_ENTRY_SIZE  = 8 + 8 + 4 + 4;
+static const size_t     IDENTIFY_BYTES              = 64 * 1024;
+
+static const amf_int64  SCAN_GRAIN                  = 4 * 1024 * 1024;  // smallest byte range of one scan task
+static const size_t     SCAN_READ_SIZE              = 1024 * 1024;
+static const size_t     SCAN_HEADER_BYTES           = 32;               // read past a range to parse the last NAL header
+
+static const size_t     IVF_FILE_HEADER_SIZE        = 32;
+static const size_t     IVF_FRAME_HEADER_SIZE       = 12;
+
+//-------------------------------------------------------------------------------------------------
+// helpers
+//-------------------------------------------------------------------------------------------------
+namespace
+{
+    struct Crc32Table
+    {
+        amf_uint32 values[256];
+
+        Crc32Table()
+        {
+            for (amf_uint32 i = 0; i < 256; i++)
+            {
+                amf_uint32 c = i;
+                for (int k = 0; k < 8; k++)
+                {
+                    c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+                }
+                values[i] = c;
+            }
+        }
+    };
+}
+//-------------------------------------------------------------------------------------------------
+static amf_uint32 Crc32(amf_uint32 crc, const amf_uint8* data, size_t size)
+{
+    static const Crc32Table table;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+//-------------------------------------------------------------------------------------------------
+static void PutLE(std::vector<amf_uint8>& data, amf_uint64 value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++)
+    {
+        data.push_back(amf_uint8(value >> (i * 8)));
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static amf_uint64 GetLE(const amf_uint8* data, size_t bytes)
+{
+    amf_uint64 value = 0;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        value |= amf_uint64(data[i]) << (i * 8);
+    }
+    return value;
+}
+//-------------------------------------------------------------------------------------------------
+static bool ReadLeb128(const amf_uint8* data, size_t size, size_t& pos, amf_uint64& value)
+{
+    value = 0;
+    for (size_t i = 0; i < 8 && pos < size; i++)
+    {
+        const amf_uint8 byte = data[pos++];
+        value |= amf_uint64(byte & 0x7F) << (i * 7);
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+static bool IsAnnexB(BitStreamType type)
+{
+    return type == BitStreamH264AnnexB || type == BitStream265AnnexB;
+}
+//-------------------------------------------------------------------------------------------------
+// Annex B scan
+//-------------------------------------------------------------------------------------------------
+namespace
+{
+    struct NalInfo
+    {
+        amf_int64   offset;         // including the zero_byte of a 4 byte start code
+        amf_uint8   type;
+        bool        bFirstSlice;    // first_mb_in_slice == 0 / first_slice_segment_in_pic_flag
+    };
+
+    struct ScanContext
+    {
+        const wchar_t*                              path;
+        BitStreamType                               type;
+        amf::AMFCriticalSection                     sync;
+        std::map<amf_int64, std::vector<NalInfo> >  ranges;     // by first byte of the range
+        bool                                        bFailed;
+    };
+
+    bool IsVcl(BitStreamType type, amf_uint8 nal)
+    {
+        return type == BitStreamH264AnnexB ? (nal >= 1 && nal <= 5) : nal < 32;
+    }
+    bool IsIrap(BitStreamType type, amf_uint8 nal)
+    {
+        return type == BitStreamH264AnnexB ? nal == 5 : (nal >= 16 && nal <= 23);
+    }
+    bool IsParameterSet(BitStreamType type, amf_uint8 nal)
+    {
+        return type == BitStreamH264AnnexB ? (nal == 7 || nal == 8) : (nal >= 32 && nal <= 34);
+    }
+    // NAL units that open the next access unit when they follow a VCL NAL unit,
+    // ITU-T H.264 7.4.1.2.3 and ITU-T H.265 7.4.2.4.4
+    bool StartsAccessUnit(BitStreamType type, amf_uint8 nal)
+    {
+        if (type == BitStreamH264AnnexB)
+        {
+            return (nal >= 6 && nal <= 9) || (nal >= 14 && nal <= 18);
+        }
+        return (nal >= 32 && nal <= 35) || nal == 39 || (nal >= 41 && nal <= 44) || (nal >= 48 && nal <= 55);
+    }
+
+    void ScanRange(ScanContext& context, amf_int64 begin, amf_int64 end)
+    {
+        amf::AMFDataStreamPtr pStream;
+        if (amf::AMFDataStream::OpenDataStream(context.path, amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &pStream) != AMF_OK)
+        {
+            amf::AMFLock lock(&context.sync);
+            context.bFailed = true;
+            return;
+        }
+
+        std::vector<NalInfo> nals;
+        std::vector<amf_uint8> buffer(1 + SCAN_READ_SIZE + SCAN_HEADER_BYTES);
+        amf_int64 pos = begin;
+        while (pos < end)
+        {
+            // one byte back for the zero_byte, some bytes past the range for the start code and header
+            const amf_int64 from = pos > 0 ? pos - 1 : 0;
+            const size_t base = size_t(pos - from);
+            const size_t step = size_t(AMF_MIN(amf_int64(SCAN_READ_SIZE), end - pos));
+            amf_size read = 0;
+            pStream->Seek(amf::AMF_SEEK_BEGIN, from, NULL);
+            pStream->Read(&buffer[0], base + step + SCAN_HEADER_BYTES, &read);
+            if (read <= base)
+            {
+                break;
+            }
+
+            const amf_uint8* data = &buffer[0];
+            const size_t scanEnd = AMF_MIN(base + step, size_t(read));
+            const size_t limit = AMF_MIN(scanEnd + 2, size_t(read));
+            size_t found = base + StartCodeScanner::FindStartCode(data + base, limit - base);
+            while (found < scanEnd)
+            {
+                const size_t header = found + 3;
+                if (header < read)
+                {
+                    NalInfo nal = { from + amf_int64(found), 0, false };
+                    if (found > 0 && data[found - 1] == 0)
+                    {
+                        nal.offset--;
+                    }
+                    const size_t available = read - header;
+                    if (context.type == BitStreamH264AnnexB)
+                    {
+                        nal.type = data[header] & 0x1F;
+                        nal.bFirstSlice = IsVcl(context.type, nal.type) && Parser::RbspBitReader(data + header, available, 8).readUe() == 0;
+                    }
+                    else
+                    {
+                        nal.type = (data[header] >> 1) & 0x3F;
+                        nal.bFirstSlice = IsVcl(context.type, nal.type) && Parser::RbspBitReader(data + header, available, 16).getBit();
+                    }
+                    nals.push_back(nal);
+                }
+                found = header + StartCodeScanner::FindStartCode(data + header, limit > header ? limit - header : 0);
+            }
+            pos += step;
+        }
+
+        amf::AMFLock lock(&context.sync);
+        context.ranges[begin].swap(nals);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+BitStreamIndex::BitStreamIndex()
+{
+    m_Source.fileSize = 0;
+    m_Source.crc = 0;
+    m_Source.type = BitStreamUnknown;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT BitStreamIndex::Identify(const wchar_t* path, BitStreamType type, Source* pSource)
+{
+    AMF_RETURN_IF_INVALID_POINTER(path, L"Identify() - path == NULL");
+    AMF_RETURN_IF_INVALID_POINTER(pSource, L"Identify() - pSource == NULL");
+
+    amf::AMFDataStreamPtr pStream;
+    AMF_RETURN_IF_FAILED(amf::AMFDataStream::OpenDataStream(path, amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &pStream), L"Identify() - cannot open %s", path);
+
+    std::vector<amf_uint8> data(IDENTIFY_BYTES);
+    amf_size read = 0;
+    pStream->Read(&data[0], data.size(), &read);
+
+    pSource->fileSize = 0;
+    pStream->GetSize(&pSource->fileSize);
+    pSource->crc = Crc32(0, &data[0], read);
+    pSource->type = type;
+    return pSource->fileSize > 0 ? AMF_OK : AMF_NOT_SUPPORTED;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT BitStreamIndex::Open(const wchar_t* path, BitStreamType type, const wchar_t* indexPath)
+{
+    Source source;
+    AMF_RETURN_IF_FAILED(Identify(path, type, &source));
+
+    amf_wstring sidecar = (indexPath != NULL && indexPath[0] != 0) ? amf_wstring(indexPath) : amf_wstring(path) + L".amfbsi";
+    if (Load(sidecar.c_str(), source) == AMF_OK)
+    {
+        return AMF_OK;
+    }
+    AMF_RETURN_IF_FAILED(Build(path, source));
+    if (Save(sidecar.c_str()) != AMF_OK)
+    {
+        AMFTraceWarning(AMF_FACILITY, L"Index of %s is not cached, it will be rebuilt on next open", path);
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT BitStreamIndex::Build(const wchar_t* path, const Source& source)
+{
+    AMF_RETURN_IF_INVALID_POINTER(path, L"Build() - path == NULL");
+
+    Clear();
+    AMF_RESULT res = AMF_NOT_SUPPORTED;
+    if (IsAnnexB(source.type))
+    {
+        res = BuildAnnexB(path, source);
+    }
+    else if (source.type == BitStreamIVF)
+    {
+        res = BuildIVF(path);
+    }
+    AMF_RETURN_IF_FAILED(res, L"Build() - cannot index %s", path);
+    AMF_RETURN_IF_FALSE(!m_Entries.empty(), AMF_NOT_FOUND, L"Build() - no access units in %s", path);
+
+    m_Source = source;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT BitStreamIndex::BuildAnnexB(const wchar_t* path, const Source& source)
+{
+    ScanContext context;
+    context.path = path;
+    context.type = source.type;
+    context.bFailed = false;
+
+    // start codes are owned by the range they begin in, so the ranges never report a NAL unit twice
+    amf::AMFThreadPool* pPool = amf::AMFThreadPool::AcquireShared();
+    pPool->ParallelFor(0, source.fileSize, SCAN_GRAIN, [&context](amf_int64 begin, amf_int64 end)
+    {
+        ScanRange(context, begin, end);
+    });
+    amf::AMFThreadPool::ReleaseShared();
+    AMF_RETURN_IF_FALSE(!context.bFailed, AMF_FILE_NOT_OPEN, L"BuildAnnexB() - cannot open %s", path);
+
+    // stitch the ranges into access units
+    std::vector<std::pair<amf_int64, amf_int64> > parameterSets;   // NAL units of the current access unit
+    std::vector<std::vector<std::pair<amf_int64, amf_int64> > > parameterSetsOfEntry;
+    std::vector<std::pair<amf_int64, amf_int64> > pendingParameterSets;
+    amf_int64 pendingStart = -1;    // first NAL unit after the last VCL NAL unit that opens an access unit
+    amf_uint32 pendingFlags = 0;
+    NalInfo previous = { -1, 0, false };
+
+    for (std::map<amf_int64, std::vector<NalInfo> >::const_iterator range = context.ranges.begin(); range != context.ranges.end(); ++range)
+    {
+        for (std::vector<NalInfo>::const_iterator nal = range->second.begin(); nal != range->second.end(); ++nal)
+        {
+            if (previous.offset >= 0 && IsParameterSet(source.type, previous.type))
+            {
+                pendingParameterSets.push_back(std::make_pair(previous.offset, nal->offset));
+            }
+            previous = *nal;
+
+            if (IsVcl(source.type, nal->type))
+            {
+                if (m_Entries.empty() || nal->bFirstSlice)
+                {
+                    Entry entry = { pendingStart >= 0 ? pendingStart : nal->offset, 0, pendingFlags, NoEntry };
+                    m_Entries.push_back(entry);
+                    parameterSetsOfEntry.push_back(std::vector<std::pair<amf_int64, amf_int64> >());
+                }
+                else
+                {
+                    m_Entries.back().flags |= pendingFlags;
+                }
+                if (IsIrap(source.type, nal->type))
+                {
+                    m_Entries.back().flags |= FLAG_IRAP;
+                }
+                parameterSetsOfEntry.back().insert(parameterSetsOfEntry.back().end(), pendingParameterSets.begin(), pendingParameterSets.end());
+                pendingParameterSets.clear();
+                pendingStart = -1;
+                pendingFlags = 0;
+            }
+            else if (StartsAccessUnit(source.type, nal->type))
+            {
+                if (pendingStart < 0)
+                {
+                    pendingStart = nal->offset;
+                }
+                if (IsParameterSet(source.type, nal->type))
+                {
+                    pendingFlags |= FLAG_PARAMETER_SETS;
+                }
+            }
+        }
+    }
+    if (m_Entries.empty())
+    {
+        return AMF_OK;
+    }
+
+    // sizes and parameter set changes, the parameter sets are few and small - read them again
+    amf::AMFDataStreamPtr pStream;
+    AMF_RETURN_IF_FAILED(amf::AMFDataStream::OpenDataStream(path, amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &pStream), L"BuildAnnexB() - cannot open %s", path);
+
+    std::vector<amf_uint8> data;
+    amf_uint32 lastParameterSets = NoEntry;
+    amf_uint32 lastCrc = 0;
+    for (size_t i = 0; i < m_Entries.size(); i++)
+    {
+        Entry& entry = m_Entries[i];
+        entry.size = (i + 1 < m_Entries.size() ? m_Entries[i + 1].offset : source.fileSize) - entry.offset;
+
+        if ((entry.flags & FLAG_PARAMETER_SETS) != 0)
+        {
+            amf_uint32 crc = 0;
+            for (size_t k = 0; k < parameterSetsOfEntry[i].size(); k++)
+            {
+                const std::pair<amf_int64, amf_int64>& nal = parameterSetsOfEntry[i][k];
+                data.resize(size_t(nal.second - nal.first));
+                amf_size read = 0;
+                pStream->Seek(amf::AMF_SEEK_BEGIN, nal.first, NULL);
+                pStream->Read(data.empty() ? NULL : &data[0], data.size(), &read);
+                crc = Crc32(crc, data.empty() ? NULL : &data[0], read);
+            }
+            if (lastParameterSets == NoEntry || crc != lastCrc)
+            {
+                entry.flags |= FLAG_PARAMETER_SETS_CHANGED;
+            }
+            lastParameterSets = amf_uint32(i);
+            lastCrc = crc;
+        }
+        entry.parameterSets = lastParameterSets;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT BitStreamIndex::BuildIVF(const wchar_t* path)
+{
+    amf::AMFDataStreamPtr pStream;
+    AMF_RETURN_IF_FAILED(amf::AMFDataStream::OpenDataStream(path, amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &pStream), L"BuildIVF() - cannot open %s", path);
+
+    amf_uint8 header[IVF_FILE_HEADER_SIZE] = {};
+    amf_size read = 0;
+    pStream->Read(header, sizeof(header), &read);
+    AMF_RETURN_IF_FALSE(read == sizeof(header) && memcmp(header, "DKIF", 4) == 0, AMF_INVALID_DATA_TYPE, L"BuildIVF() - %s is not an IVF file", path);
+    const bool bAV1 = memcmp(header + 8, "AV01", 4) == 0;
+    AMF_RETURN_IF_FALSE(bAV1 || memcmp(header + 8, "VP90", 4) == 0, AMF_NOT_SUPPORTED, L"BuildIVF() - only VP9 and AV1 are indexed");
+
+    // IVF frames are chained by their headers, the walk is sequential
+    amf_int64 offset = (amf_int64)GetLE(header + 6, 2);
+    amf_uint32 lastParameterSets = NoEntry;
+    amf_uint32 lastCrc = 0;
+    bool bReducedStillPicture = false;
+    std::vector<amf_uint8> frame;
+    for (;;)
+    {
+        amf_uint8 frameHeader[IVF_FRAME_HEADER_SIZE];
+        pStream->Seek(amf::AMF_SEEK_BEGIN, offset, NULL);
+        read = 0;
+        pStream->Read(frameHeader, sizeof(frameHeader), &read);
+        if (read != sizeof(frameHeader))
+        {
+            break;
+        }
+        const size_t frameSize = (size_t)GetLE(frameHeader, 4);
+        frame.resize(frameSize);
+        read = 0;
+        pStream->Read(frame.empty() ? NULL : &frame[0], frameSize, &read);
+        if (read != frameSize || frameSize == 0)
+        {
+            break;
+        }
+
+        Entry entry = { offset, amf_int64(IVF_FRAME_HEADER_SIZE + frameSize), 0, lastParameterSets };
+        const amf_uint8* data = &frame[0];
+        if (bAV1)
+        {
+            // the first frame header of the temporal unit tells the frame type
+            size_t pos = 0;
+            amf_uint32 crc = 0;
+            while (pos < frameSize)
+            {
+                const size_t start = pos;
+                const amf_uint8 obuHeader = data[pos];
+                const amf_uint8 obuType = (obuHeader >> 3) & 0xF;
+                pos += ((obuHeader & 0x4) != 0) ? 2 : 1;
+                amf_uint64 obuSize = frameSize > pos ? frameSize - pos : 0;
+                if ((obuHeader & 0x2) != 0 && !ReadLeb128(data, frameSize, pos, obuSize))
+                {
+                    break;
+                }
+                if (pos + obuSize > frameSize)
+                {
+                    break;
+                }
+                if (obuType == 1) // OBU_SEQUENCE_HEADER
+                {
+                    entry.flags |= FLAG_PARAMETER_SETS;
+                    crc = Crc32(crc, data + start, size_t(pos + obuSize - start));
+                    size_t bitIdx = pos * 8 + 4;   // seq_profile, still_picture
+                    bReducedStillPicture = obuSize > 0 && Parser::getBit(data, bitIdx);
+                }
+                else if ((obuType == 3 || obuType == 6) && obuSize > 0) // OBU_FRAME_HEADER, OBU_FRAME
+                {
+                    size_t bitIdx = pos * 8;
+                    // show_existing_frame, frame_type == KEY_FRAME
+                    if (bReducedStillPicture || (Parser::getBit(data, bitIdx) == false && Parser::readBits(data, bitIdx, 2) == 0))
+                    {
+                        entry.flags |= FLAG_IRAP;
+                    }
+                    break;
+                }
+                pos += size_t(obuSize);
+            }
+            if ((entry.flags & FLAG_PARAMETER_SETS) != 0)
+            {
+                if (lastParameterSets == NoEntry || crc != lastCrc)
+                {
+                    entry.flags |= FLAG_PARAMETER_SETS_CHANGED;
+                }
+                lastParameterSets = amf_uint32(m_Entries.size());
+                lastCrc = crc;
+                entry.parameterSets = lastParameterSets;
+            }
+        }
+        else if (frameSize >= 2)
+        {
+            // VP9 uncompressed header: frame_marker, profile, show_existing_frame, frame_type == KEY_FRAME
+            size_t bitIdx = 2;
+            const amf_uint32 profile = Parser::readBits(data, bitIdx, 1) | (Parser::readBits(data, bitIdx, 1) << 1);
+            if (profile == 3)
+            {
+                bitIdx++;
+            }
+            if ((data[0] >> 6) == 2 && Parser::getBit(data, bitIdx) == false && Parser::getBit(data, bitIdx) == false)
+            {
+                entry.flags |= FLAG_IRAP;
+            }
+        }
+        m_Entries.push_back(entry);
+        offset += entry.size;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT BitStreamIndex::Load(const wchar_t* indexPath, const Source& source)
+{
+    AMF_RETURN_IF_INVALID_POINTER(indexPath, L"Load() - indexPath == NULL");
+
+    Clear();
+
+    amf::AMFDataStreamPtr pStream;
+    if (amf::AMFDataStream::OpenDataStream(indexPath, amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &pStream) != AMF_OK)
+    {
+        // no cache yet - not an error
+        return AMF_FILE_NOT_OPEN;
+    }
+    amf_int64 size = 0;
+    pStream->GetSize(&size);
+    if (size < amf_int64(BITSTREAM_INDEX_HEADER_SIZE))
+    {
+        return AMF_INVALID_DATA_TYPE;
+    }
+    std::vector<amf_uint8> data((size_t)size);
+    amf_size read = 0;
+    pStream->Read(&data[0], data.size(), &read);
+
+    const amf_uint8* header = &data[0] + sizeof(BITSTREAM_INDEX_MAGIC);
+    const amf_uint32 version  = (amf_uint32)GetLE(header, 4);
+    const amf_uint32 type     = (amf_uint32)GetLE(header + 4, 4);
+    const amf_int64  fileSize = (amf_int64)GetLE(header + 8, 8);
+    const amf_uint32 crc      = (amf_uint32)GetLE(header + 16, 4);
+    const amf_uint64 count    = GetLE(header + 20, 8);
+
+    // a stale cache (file replaced or edited) is rebuilt by the caller
+    if (read != data.size() || memcmp(&data[0], BITSTREAM_INDEX_MAGIC, sizeof(BITSTREAM_INDEX_MAGIC)) != 0 ||
+        version != BITSTREAM_INDEX_VERSION || type != amf_uint32(source.type) || fileSize != source.fileSize || crc != source.crc ||
+        count == 0 || count > (data.size() - BITSTREAM_INDEX_HEADER_SIZE) / BITSTREAM_INDEX_ENTRY_SIZE)
+    {
+        return AMF_INVALID_DATA_TYPE;
+    }
+
+    m_Entries.resize((size_t)count);
+    const amf_uint8* entry = &data[0] + BITSTREAM_INDEX_HEADER_SIZE;
+    for (size_t i = 0; i < m_Entries.size(); i++, entry += BITSTREAM_INDEX_ENTRY_SIZE)
+    {
+        m_Entries[i].offset = (amf_int64)GetLE(entry, 8);
+        m_Entries[i].size = (amf_int64)GetLE(entry + 8, 8);
+        m_Entries[i].flags = (amf_uint32)GetLE(entry + 16, 4);
+        m_Entries[i].parameterSets = (amf_uint32)GetLE(entry + 20, 4);
+    }
+    m_Source = source;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT BitStreamIndex::Save(const wchar_t* indexPath) const
+{
+    AMF_RETURN_IF_INVALID_POINTER(indexPath, L"Save() - indexPath == NULL");
+    AMF_RETURN_IF_FALSE(!m_Entries.empty(), AMF_NOT_INITIALIZED, L"Save() - index is empty");
+
+    std::vector<amf_uint8> data(BITSTREAM_INDEX_MAGIC, BITSTREAM_INDEX_MAGIC + sizeof(BITSTREAM_INDEX_MAGIC));
+    data.reserve(BITSTREAM_INDEX_HEADER_SIZE + m_Entries.size() * BITSTREAM_INDEX_ENTRY_SIZE);
+    PutLE(data, BITSTREAM_INDEX_VERSION, 4);
+    PutLE(data, amf_uint32(m_Source.type), 4);
+    PutLE(data, amf_uint64(m_Source.fileSize), 8);
+    PutLE(data, m_Source.crc, 4);
+    PutLE(data, m_Entries.size(), 8);
+    for (amf::amf_vector<Entry>::const_iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+    {
+        PutLE(data, amf_uint64(it->offset), 8);
+        PutLE(data, amf_uint64(it->size), 8);
+        PutLE(data, it->flags, 4);
+        PutLE(data, it->parameterSets, 4);
+    }
+
+    amf::AMFDataStreamPtr pStream;
+    AMF_RETURN_IF_FAILED(amf::AMFDataStream::OpenDataStream(indexPath, amf::AMFSO_WRITE, amf::AMFFS_EXCLUSIVE, &pStream), L"Save() - cannot create %s", indexPath);
+    amf_size written = 0;
+    AMF_RETURN_IF_FAILED(pStream->Write(&data[0], data.size(), &written), L"Save() - write to %s failed", indexPath);
+    AMF_RETURN_IF_FALSE(written == data.size(), AMF_FAIL, L"Save() - write to %s failed", indexPath);
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void BitStreamIndex::Clear()
+{
+    m_Entries.clear();
+    m_Source.type = BitStreamUnknown;
+}
+//-------------------------------------------------------------------------------------------------
+amf_size BitStreamIndex::FindIrap(amf_size frame) const
+{
+    for (amf_size i = AMF_MIN(frame + 1, m_Entries.size()); i > 0; i--)
+    {
+        if ((m_Entries[i - 1].flags & FLAG_IRAP) != 0)
+        {
+            return i - 1;
+        }
+    }
+    return NoEntry;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT BitStreamIndex::Seek(BitStreamParser* pParser, amf_size frame, amf_size* pIrap) const
+{
+    AMF_RETURN_IF_INVALID_POINTER(pParser, L"Seek() - pParser == NULL");
+
+    const amf_size irap = FindIrap(frame);
+    AMF_RETURN_IF_FALSE(irap != NoEntry, AMF_NOT_FOUND, L"Seek() - no IRAP at or before frame %d", (int)frame);
+
+    // parameter sets sent before the IRAP are fed to the parser ahead of it
+    const Entry& entry = m_Entries[irap];
+    const amf_int64 parameterSetsOffset = (entry.parameterSets != NoEntry && entry.parameterSets != irap) ? m_Entries[entry.parameterSets].offset : -1;
+    AMF_RETURN_IF_FAILED(pParser->SeekToOffset(entry.offset, irap, parameterSetsOffset));
+
+    if (pIrap != NULL)
+    {
+        *pIrap = irap;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void BitStreamIndex::Split(amf_size parts, std::vector<Range>& ranges) const
+{
+    ranges.clear();
+    amf_size start = NoEntry;
+    for (amf_size i = 0; i < m_Entries.size(); i++)
+    {
+        if ((m_Entries[i].flags & FLAG_IRAP) != 0)
+        {
+            start = i;
+            break;
+        }
+    }
+    if (start == NoEntry || parts == 0)
+    {
+        return;
+    }
+
+    const amf_int64 begin = m_Entries[start].offset;
+    const amf_int64 total = m_Entries.back().offset + m_Entries.back().size - begin;
+    Range range = { start, m_Entries.size() };
+    for (amf_size i = start + 1; i < m_Entries.size() && ranges.size() + 1 < parts; i++)
+    {
+        // cut at the first IRAP past the next share of the bytes
+        if ((m_Entries[i].flags & FLAG_IRAP) != 0 && (m_Entries[i].offset - begin) * amf_int64(parts) >= total * amf_int64(ranges.size() + 1))
+        {
+            range.last = i;
+            ranges.push_back(range);
+            range.first = i;
+        }
+    }
+    range.last = m_Entries.size();
+    ranges.push_back(range);
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "BitStreamParser.h"
+#include "public/common/AMFSTL.h"
+
+#include <vector>
+
+//-------------------------------------------------------------------------------------------------
+// Access unit index of a raw H.264 / HEVC elementary stream or an IVF file. Annex B streams are
+// scanned by the shared thread pool in disjoint byte ranges, the NAL units found are stitched into
+// access units afterwards. The index is cached in a sidecar file next to the stream.
+//-------------------------------------------------------------------------------------------------
+class BitStreamIndex
+{
+public:
+    enum Flags
+    {
+        FLAG_IRAP                   = 0x1,  // IDR / IRAP / key frame, decoding can start here
+        FLAG_PARAMETER_SETS         = 0x2,  // carries SPS / PPS / VPS or an AV1 sequence header
+        FLAG_PARAMETER_SETS_CHANGED = 0x4,  // the parameter sets differ from the previous ones
+    };
+
+    struct Entry
+    {
+        amf_int64   offset;         // first byte of the access unit (IVF: of the frame header)
+        amf_int64   size;
+        amf_uint32  flags;
+        amf_uint32  parameterSets;  // access unit that last carried parameter sets, NoEntry if none
+    };
+
+    struct Range
+    {
+        amf_size    first;          // IRAP the range starts with
+        amf_size    last;           // one past the last access unit
+    };
+
+    // identifies the file an index belongs to
+    struct Source
+    {
+        amf_int64       fileSize;
+        amf_uint32      crc;        // of the first 64 KB
+        BitStreamType   type;
+    };
+
+    static const amf_uint32 NoEntry = 0xFFFFFFFF;
+
+    BitStreamIndex();
+
+    static AMF_RESULT   Identify(const wchar_t* path, BitStreamType type, Source* pSource);
+
+    // loads the sidecar (empty indexPath - path + ".amfbsi") or scans the file and saves it
+    AMF_RESULT          Open(const wchar_t* path, BitStreamType type, const wchar_t* indexPath = NULL);
+    AMF_RESULT          Build(const wchar_t* path, const Source& source);
+    AMF_RESULT          Load(const wchar_t* indexPath, const Source& source);
+    AMF_RESULT          Save(const wchar_t* indexPath) const;
+    void                Clear();
+
+    amf_size            GetCount() const                { return m_Entries.size(); }
+    const Entry&        GetEntry(amf_size index) const  { return m_Entries[index]; }
+
+    // last IRAP at or before frame, NoEntry if there is none
+    amf_size            FindIrap(amf_size frame) const;
+    // positions the parser at the IRAP at or before frame and returns its number
+    AMF_RESULT          Seek(BitStreamParser* pParser, amf_size frame, amf_size* pIrap) const;
+    // splits the stream into at most parts IRAP aligned ranges of about the same byte size,
+    // every range can be decoded by its own parser and decoder
+    void                Split(amf_size parts, std::vector<Range>& ranges) const;
+
+private:
+    AMF_RESULT          BuildAnnexB(const wchar_t* path, const Source& source);
+    AMF_RESULT          BuildIVF(const wchar_t* path);
+
+    Source              m_Source;
+    amf::amf_vector<Entry> m_Entries;
+};
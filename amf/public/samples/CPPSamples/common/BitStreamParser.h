@@ -78,6 +78,11 @@ public:
     virtual const wchar_t*          GetCodecComponent() = 0;
     virtual AMF_RESULT              QueryOutput(amf::AMFData** ppData) = 0;
     virtual AMF_RESULT              ReInit() = 0;
+    // output buffers reference the read window instead of owning a copy
+    virtual AMF_RESULT              SetZeroCopy(bool /*bZeroCopy*/) { return AMF_NOT_SUPPORTED; }
+    // jumps to an access unit found by BitStreamIndex. Frame numbers stay absolute, so SetMaxFramesNumber()
+    // ends a range; the parameter sets of the access unit at iParameterSetsOffset (-1 - none) go out first
+    virtual AMF_RESULT              SeekToOffset(amf_int64 /*iOffset*/, amf_size /*iFrame*/, amf_int64 /*iParameterSetsOffset*/) { return AMF_NOT_SUPPORTED; }
 
 public:
     static BitStreamParserPtr       Create(amf::AMFDataStream* pStream, BitStreamType type, amf::AMFContext* pContext);
@@ -164,5 +169,101 @@ namespace Parser
             return r;
         }
     }
+
+    // reads the RBSP straight from the escaped NAL unit: emulation prevention bytes are skipped,
+    // reads past the end return zero bits
+    class RbspBitReader
+    {
+    public:
+        RbspBitReader(const amf_uint8 *data, size_t size, size_t startBitIdx = 0) :
+            m_pData(data),
+            m_Size(size),
+            m_Pos(0),
+            m_Zeros(0),
+            m_Cache(0),
+            m_CacheBits(0)
+        {
+            Skip(startBitIdx);
+        }
+
+        bool getBit()
+        {
+            if (m_CacheBits == 0)
+            {
+                m_Cache = NextByte();
+                m_CacheBits = 8;
+            }
+            m_CacheBits--;
+            return (m_Cache >> m_CacheBits & 1) != 0;
+        }
+        amf_uint32 readBits(size_t bitsToRead)
+        {
+            if (bitsToRead > 32)
+            {
+                return 0; // assert(0);
+            }
+            amf_uint32 result = 0;
+            for (size_t i = 0; i < bitsToRead; i++)
+            {
+                result = (result << 1) | (getBit() ? 1 : 0);
+            }
+            return result;
+        }
+        void Skip(size_t bits)
+        {
+            for (; bits > 0; bits--)
+            {
+                getBit();
+            }
+        }
+        amf_uint32 readUe()
+        {
+            size_t zeroBitsCount = 0;
+            while (getBit() == false && IsEnd() == false)
+            {
+                zeroBitsCount++;
+            }
+            if (zeroBitsCount > 30)
+            {
+                return 0; // assert(0)
+            }
+            amf_uint32 leftPart = (0x1 << zeroBitsCount) - 1;
+            return leftPart + readBits(zeroBitsCount);
+        }
+        amf_int32 readSe()
+        {
+            amf_uint32 ue = readUe();
+            amf_int32 r = (amf_int32)(ue / 2 + ue % 2);
+            return (ue % 2) == 0 ? -r : r;
+        }
+        bool IsEnd() const { return m_CacheBits == 0 && m_Pos >= m_Size; }
+
+    private:
+        amf_uint8 NextByte()
+        {
+            if (m_Pos >= m_Size)
+            {
+                return 0;
+            }
+            if (m_Zeros >= 2 && m_pData[m_Pos] == 3)
+            {
+                m_Zeros = 0;
+                if (++m_Pos >= m_Size)
+                {
+                    return 0;
+                }
+            }
+            amf_uint8 byte = m_pData[m_Pos++];
+            m_Zeros = byte == 0 ? m_Zeros + 1 : 0;
+            return byte;
+        }
+
+        const amf_uint8 *m_pData;
+        size_t           m_Size;
+        size_t           m_Pos;
+        size_t           m_Zeros;
+        amf_uint8        m_Cache;
+        size_t           m_CacheBits;
+    };
 }
 
@@ -31,6 +31,8 @@
 //
 
 #include "BitStreamParserH264.h"
+#include "StartCodeScanner.h"
+#include "BitStreamWindow.h"
 
 #include <vector>
 #include <map>
@@ -88,6 +90,8 @@ public:
 
     virtual AMF_RESULT              QueryOutput(amf::AMFData** ppData);
     virtual AMF_RESULT              ReInit();
+    virtual AMF_RESULT              SetZeroCopy(bool bZeroCopy);
+    virtual AMF_RESULT              SeekToOffset(amf_int64 iOffset, amf_size iFrame, amf_int64 iParameterSetsOffset);
 
 protected:
 
@@ -232,7 +236,7 @@ protected:
             IdrPicFlag(0),
             IdrPicId(0)
         {}
-        bool Parse(amf_uint8 *data, size_t size, std::map<amf_uint32,SpsData> &spsMap, std::map<amf_uint32,PpsData> &ppsMap);
+        bool Parse(const amf_uint8 *data, size_t size, std::map<amf_uint32,SpsData> &spsMap, std::map<amf_uint32,PpsData> &ppsMap);
         bool IsNewPicture(const AccessUnitSigns &other);
     };
 
@@ -252,12 +256,15 @@ protected:
         return (NalUnitType)(data  & NalUnitTypeMask);
     }
     size_t EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos);
+    bool          CanWriteLengthsInPlace(const std::vector<size_t> &naluStarts, const std::vector<size_t> &naluSizes) const;
+    void          AddParameterSet(const amf_uint8 *nalu, size_t size);
 
 
-    AMFByteArray   m_ReadData;
+    BitStreamWindow m_ReadData;
     AMFByteArray   m_Extradata;
 
     AMFByteArray   m_EBSPtoRBSPData;
+    AMFByteArray   m_ParameterSets;     // output ready, sent with the next picture after SeekToOffset()
 
     bool           m_bUseStartCodes;
     amf_pts        m_currentFrameTimestamp;
@@ -415,6 +422,96 @@ void AvcParser::SetUseStartCodes(bool bUse)
     m_bUseStartCodes = bUse;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AvcParser::SetZeroCopy(bool bZeroCopy)
+{
+    m_ReadData.SetZeroCopy(bZeroCopy, m_pStream);
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AvcParser::SeekToOffset(amf_int64 iOffset, amf_size iFrame, amf_int64 iParameterSetsOffset)
+{
+    m_ParameterSets.SetSize(0);
+    if(iParameterSetsOffset >= 0)
+    {
+        // collect SPS and PPS up to the first slice of that access unit
+        AMF_RESULT res = m_pStream->Seek(amf::AMF_SEEK_BEGIN, iParameterSetsOffset, NULL);
+        if(res != AMF_OK)
+        {
+            return res;
+        }
+        m_ReadData.Clear();
+        m_bEof = false;
+        size_t dataOffset = 0;
+        for(;;)
+        {
+            size_t naluSize = 0;
+            size_t naluOffset = 0;
+            NalUnitType naluType = ReadNextNaluUnit(&dataOffset, &naluOffset, &naluSize);
+            if(naluType == NalUnitTypeSequenceParameterSet)
+            {
+                m_EBSPtoRBSPData.SetSize(naluSize);
+                memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
+                size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+
+                SpsData sps;
+                sps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
+                m_SpsMap[sps.Id] = sps;
+                AddParameterSet(m_ReadData.GetData() + naluOffset, naluSize);
+            }
+            else if(naluType == NalUnitTypePictureParameterSet)
+            {
+                m_EBSPtoRBSPData.SetSize(naluSize);
+                memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
+                size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
+
+                PpsData pps;
+                pps.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize);
+                m_PpsMap[pps.Id] = pps;
+                AddParameterSet(m_ReadData.GetData() + naluOffset, naluSize);
+            }
+            else if(naluType == NalUnitTypeUnspecified || naluType <= NalUnitTypeSliceIdrPicture)
+            {
+                break;
+            }
+        }
+    }
+
+    AMF_RESULT res = m_pStream->Seek(amf::AMF_SEEK_BEGIN, iOffset, NULL);
+    if(res != AMF_OK)
+    {
+        return res;
+    }
+    m_ReadData.Clear();
+    m_bEof = false;
+    m_PacketCount = iFrame;
+    m_currentFrameTimestamp = amf_pts(AMF_SECOND / GetFrameRate()) * amf_pts(iFrame);
+    m_currentAccessUnitsSigns = AccessUnitSigns();
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AvcParser::AddParameterSet(const amf_uint8 *nalu, size_t size)
+{
+    const size_t pos = m_ParameterSets.GetSize();
+    m_ParameterSets.SetSize(pos + NalUnitLengthSize + size);
+    amf_uint8 *data = m_ParameterSets.GetData() + pos;
+    if(m_bUseStartCodes)
+    {
+        *data++ = 0;
+        *data++ = 0;
+        *data++ = 0;
+        *data++ = 1;
+    }
+    else
+    {
+        amf_uint32 naluSize= (amf_uint32)size;
+        *data++ = (naluSize >> 24);
+        *data++ = ((naluSize >> 16) & 0x000000FF);
+        *data++ = ((naluSize >> 8) & 0x000000FF);
+        *data++ = ((naluSize & 0x000000FF));
+    }
+    memcpy(data, nalu, size);
+}
+//-------------------------------------------------------------------------------------------------
 void AvcParser::SetFrameRate(double fps)
 {
     m_fps = fps;
@@ -528,12 +625,7 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
         {
             bSliceFound = true;
             AccessUnitSigns naluAccessUnitsSigns;
-
-            m_EBSPtoRBSPData.SetSize(naluSize);
-            memcpy(m_EBSPtoRBSPData.GetData(), m_ReadData.GetData() + naluOffset, naluSize);
-            size_t newNaluSize = EBSPtoRBSP(m_EBSPtoRBSPData.GetData(),0, naluSize);
-
-            naluAccessUnitsSigns.Parse(m_EBSPtoRBSPData.GetData(), newNaluSize, m_SpsMap, m_PpsMap);
+            naluAccessUnitsSigns.Parse(m_ReadData.GetData() + naluOffset, naluSize, m_SpsMap, m_PpsMap);
 
             if (m_currentAccessUnitsSigns.PicParameterSetId == amf_uint32(-1))
             {
@@ -575,13 +667,53 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
     } while (!newPictureDetected);
 
 
+    // parameter sets of an earlier access unit after SeekToOffset()
+    const size_t parameterSetsSize = m_ParameterSets.GetSize();
+    packetSize += parameterSetsSize;
+
     amf::AMFBufferPtr pictureBuffer;
-    m_pContext->AllocBuffer(amf::AMF_MEMORY_HOST, packetSize, &pictureBuffer);
+    AMF_RESULT res = AMF_OK;
+    const bool bSlice = parameterSetsSize == 0 && packetSize > 0 && m_ReadData.IsZeroCopy() && (m_bUseStartCodes || CanWriteLengthsInPlace(naluStarts, naluSizes));
+    if(bSlice)
+    {
+        if(!m_bUseStartCodes)
+        {
+            // the length fields overwrite the start codes in the window
+            for( size_t i=0; i < naluStarts.size(); i++)
+            {
+                amf_uint32 naluSize= (amf_uint32)naluSizes[i];
+                amf_uint8 *data = m_ReadData.GetData() + naluStarts[i] - NalUnitLengthSize;
+                *data++ = (naluSize >> 24);
+                *data++ = ((naluSize >> 16) & 0x000000FF);
+                *data++ = ((naluSize >> 8) & 0x000000FF);
+                *data++ = ((naluSize & 0x000000FF));
+            }
+        }
+        res = m_ReadData.Slice(m_pContext, 0, packetSize, &pictureBuffer);
+    }
+    else
+    {
+        res = m_pContext->AllocBuffer(amf::AMF_MEMORY_HOST, packetSize, &pictureBuffer);
+    }
+    if(res != AMF_OK)
+    {
+        return res;
+    }
 
     amf_uint8 *data = (amf_uint8*)pictureBuffer->GetNative();
-    if(m_bUseStartCodes)
+    if(parameterSetsSize > 0)
     {
-        memcpy(data, m_ReadData.GetData(), packetSize);
+        memcpy(data, m_ParameterSets.GetData(), parameterSetsSize);
+        data += parameterSetsSize;
+        m_ParameterSets.SetSize(0);
+    }
+    if(bSlice)
+    {
+        // references the window, nothing to copy
+    }
+    else if(m_bUseStartCodes)
+    {
+        memcpy(data, m_ReadData.GetData(), packetSize - parameterSetsSize);
     }
     else
     {
@@ -606,23 +738,39 @@ AMF_RESULT AvcParser::QueryOutput(amf::AMFData** ppData)
 
 //    if (newPictureDetected)
     {
-    // shift remaining data in m_ReadData
-        size_t remainingData = m_ReadData.GetSize() - readSize;
-        memmove(m_ReadData.GetData(), m_ReadData.GetData()+readSize, remainingData);
-        m_ReadData.SetSize(remainingData);
+    // drop the consumed data from the front of m_ReadData, the remainder is not moved
+        m_ReadData.Consume(readSize);
     }
     *ppData = pictureBuffer.Detach();
     m_PacketCount++;
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+bool AvcParser::CanWriteLengthsInPlace(const std::vector<size_t> &naluStarts, const std::vector<size_t> &naluSizes) const
+{
+    if(!m_ReadData.IsWritable())
+    {
+        return false;
+    }
+    // every NAL unit has to follow a 4 byte start code directly
+    size_t end = 0;
+    for( size_t i=0; i < naluStarts.size(); i++)
+    {
+        if(naluStarts[i] != end + NalUnitLengthSize)
+        {
+            return false;
+        }
+        end = naluStarts[i] + naluSizes[i];
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
 AvcParser::NalUnitType   AvcParser::ReadNextNaluUnit(size_t *offset, size_t *nalu, size_t *size)
 {
     *size = 0;
     size_t startOffset = *offset;
 
     bool newNalFound = false;
-    size_t zerosCount = 0;
 
     while(!newNalFound)
     {
@@ -630,9 +778,8 @@ AvcParser::NalUnitType   AvcParser::ReadNextNaluUnit(size_t *offset, size_t *nal
         size_t ready = m_ReadData.GetSize() - *offset;
         if(ready == 0)
         {
-            m_ReadData.SetSize(m_ReadData.GetSize()+m_ReadSize);
             ready = 0;
-            m_pStream->Read(m_ReadData.GetData() + *offset, m_ReadSize, &ready);
+            m_ReadData.Read(m_pStream, m_ReadSize, &ready);
             if(ready == 0 )
             {
                 m_bEof = true;
@@ -647,35 +794,29 @@ AvcParser::NalUnitType   AvcParser::ReadNextNaluUnit(size_t *offset, size_t *nal
         {
             return NalUnitTypeUnspecified; // no data read
         }
-        data += *offset; // don't forget the offset!
 
-        for(size_t i = 0; i < ready; i++)
+        // a start code can straddle the previous portion - look back over its first two bytes
+        size_t from = (*offset >= startOffset + 2) ? *offset - 2 : startOffset;
+        size_t end = *offset + ready;
+        size_t found = from + StartCodeScanner::FindStartCode(data + from, end - from);
+        while (found < end)
         {
-            amf_uint8 ch = *data++;
-            if (0 == ch)
+            // the zeros in front belong to the start code (4 byte form, trailing_zero_8bits)
+            size_t zeros = found;
+            while (zeros > startOffset && data[zeros - 1] == 0)
             {
-                zerosCount++;
+                zeros--;
             }
-            else
+            if (zeros > startOffset) // We found a start code in Annex B stream
             {
-                if (1 == ch && zerosCount > 1) // We found a start code in Annex B stream
-                {
-                    if(*offset + (i - zerosCount) > startOffset)
-                    {
-                        ready = i - zerosCount;
-                        newNalFound = true; // new NAL
-                        break;
-                    }
-                    else
-                    {
-                        *nalu = *offset + zerosCount + 1;
-                    }
-                }
-                zerosCount = 0;
+                end = zeros;
+                newNalFound = true; // new NAL
+                break;
             }
+            *nalu = found + 3;
+            found = *nalu + StartCodeScanner::FindStartCode(data + *nalu, end - *nalu);
         }
-        // if zeros found but not a new NAL - continue with zerosCount on the next iteration
-        *offset += ready;
+        *offset = end;
     }
     if(!newNalFound)
     {
@@ -743,7 +884,7 @@ void    AvcParser::FindSPSandPPS()
     } while (true);
 
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
-    m_ReadData.SetSize(0);
+    m_ReadData.Clear();
     // It will fail if SPS or PPS are absent
     extraDataBuilder.GetExtradata(m_Extradata);
 }
@@ -919,13 +1060,14 @@ bool AvcParser::PpsData::Parse(amf_uint8 *nalu, size_t /* size */)
 //-------------------------------------------------------------------------------------------------
 #pragma warning (push)
 #pragma warning (disable : 4189) // local variable is initialized but not referenced
-bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::map<amf_uint32, SpsData>& spsMap, std::map<amf_uint32, PpsData>& ppsMap)
+bool AvcParser::AccessUnitSigns::Parse(const amf_uint8 *nalu, size_t size, std::map<amf_uint32, SpsData>& spsMap, std::map<amf_uint32, PpsData>& ppsMap)
 {
-    size_t offset = 8;
+    // read in place, the slice header is short so unescaping the whole slice is not needed
+    Parser::RbspBitReader reader(nalu, size, 8);
 
-    amf_uint32 firstMbInSlice = Parser::ExpGolomb::readUe(nalu, offset);
-    amf_uint32 sliceType = Parser::ExpGolomb::readUe(nalu, offset);
-    PicParameterSetId = Parser::ExpGolomb::readUe(nalu, offset);
+    amf_uint32 firstMbInSlice = reader.readUe();
+    amf_uint32 sliceType = reader.readUe();
+    PicParameterSetId = reader.readUe();
 
     std::map<amf_uint32,PpsData>::iterator ppsIt = ppsMap.find(PicParameterSetId);
     if (ppsIt == ppsMap.end())
@@ -941,23 +1083,23 @@ bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::
 
     if (spsIt->second.SeparateColourPlane)
     {
-       amf_uint32 colourPlaneId = Parser::readBits(nalu, offset, 2);
+       amf_uint32 colourPlaneId = reader.readBits(2);
     }
 
     amf_uint32 frameNumBitsCount = spsIt->second.Log2MaxFrameNumMinus4 + 4;
 
-    FrameNum = Parser::readBits(nalu, offset, frameNumBitsCount);
+    FrameNum = reader.readBits(frameNumBitsCount);
 
     FieldPicFlag = false;
     BottomFieldFlag = false;
 
     if (!spsIt->second.FrameMbsOnlyFlag)
     {
-        FieldPicFlag = Parser::getBit(nalu, offset);
+        FieldPicFlag = reader.getBit();
 
         if (FieldPicFlag)
         {
-            BottomFieldFlag = Parser::getBit(nalu, offset);
+            BottomFieldFlag = reader.getBit();
         }
     }
 
@@ -965,7 +1107,7 @@ bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::
     IdrPicId = 0;
     if (IdrPicFlag)
     {
-        IdrPicId = Parser::ExpGolomb::readUe(nalu, offset);
+        IdrPicId = reader.readUe();
     }
 
     PicOrderCntLsb = 0;
@@ -973,11 +1115,11 @@ bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::
     if (0 == spsIt->second.PicOrderCntType)
     {
         amf_uint32 picOrderCntLsbBitsCount = spsIt->second.Log2MaxPicOrderCntLsbMinus4 + 4;
-        PicOrderCntLsb = Parser::readBits(nalu, offset, picOrderCntLsbBitsCount);
+        PicOrderCntLsb = reader.readBits(picOrderCntLsbBitsCount);
 
         if (ppsIt->second.BottomFieldPicOrderInFramePresent && !FieldPicFlag)
         {
-            DeltaPicOrderCntBottom = Parser::ExpGolomb::readSe(nalu, offset);
+            DeltaPicOrderCntBottom = reader.readSe();
         }
     }
 
@@ -985,11 +1127,11 @@ bool AvcParser::AccessUnitSigns::Parse(amf_uint8 *nalu, size_t /* size */, std::
     DeltaPicOrderCnt1 = 0;
     if (1 == spsIt->second.PicOrderCntType && !spsIt->second.DeltaPicOrderAlwaysZero)
     {
-        DeltaPicOrderCnt0 = Parser::ExpGolomb::readSe(nalu, offset);
+        DeltaPicOrderCnt0 = reader.readSe();
 
         if (ppsIt->second.BottomFieldPicOrderInFramePresent && !FieldPicFlag)
         {
-            DeltaPicOrderCnt1 = Parser::ExpGolomb::readSe(nalu, offset);
+            DeltaPicOrderCnt1 = reader.readSe();
         }
     }
 
@@ -1181,58 +1323,14 @@ void ExtraDataAvccBuilder::SetAnnexB(amf_uint8 *data, size_t size)
     }
 }
 //-------------------------------------------------------------------------------------------------
-#define ZEROBYTES_SHORTSTARTCODE 2 //indicates the number of zero bytes in the short start-code prefix
-//-------------------------------------------------------------------------------------------------
 size_t AvcParser::EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos)
 {
-    int count = 0;
     if(end_bytepos < begin_bytepos)
     {
         return end_bytepos;
     }
-    amf_uint8 *streamBuffer_i=streamBuffer+begin_bytepos;
-    amf_uint8 *streamBuffer_end=streamBuffer+end_bytepos;
-    int iReduceCount=0;
-    for(; streamBuffer_i!=streamBuffer_end; )
-    {
-        //starting from begin_bytepos to avoid header information
-        //in NAL unit, 0x000000, 0x000001 or 0x000002 shall not occur at any amf_uint8-aligned position
-        amf_uint8 tmp=*streamBuffer_i;
-        if(count == ZEROBYTES_SHORTSTARTCODE)
-        {
-            if(tmp == 0x03)
-            {
-                //check the 4th amf_uint8 after 0x000003, except when cabac_zero_word is used, in which case the last three bytes of this NAL unit must be 0x000003
-                if((streamBuffer_i+1 != streamBuffer_end) && (streamBuffer_i[1] > 0x03))
-                {
-                    return static_cast<size_t>(-1);
-                }
-                //if cabac_zero_word is used, the final amf_uint8 of this NAL unit(0x03) is discarded, and the last two bytes of RBSP must be 0x0000
-                if(streamBuffer_i+1 == streamBuffer_end)
-                {
-                    break;
-                }
-                memmove(streamBuffer_i,streamBuffer_i+1,streamBuffer_end-streamBuffer_i-1);
-                streamBuffer_end--;
-                iReduceCount++;
-                count = 0;
-                tmp = *streamBuffer_i;
-            }
-            else if(tmp < 0x03)
-            {
-            }
-        }
-        if(tmp == 0x00)
-        {
-            count++;
-        }
-        else
-        {
-            count = 0;
-        }
-        streamBuffer_i++;
-    }
-    return end_bytepos - begin_bytepos + iReduceCount;
+    // in NAL unit, 0x000000, 0x000001 or 0x000002 shall not occur at any amf_uint8-aligned position
+    return StartCodeScanner::RemoveEmulationPrevention(streamBuffer + begin_bytepos, end_bytepos - begin_bytepos);
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT              AvcParser::ReInit()
@@ -1242,7 +1340,8 @@ AMF_RESULT              AvcParser::ReInit()
     m_PacketCount = 0;
     m_bEof = false;
     m_currentAccessUnitsSigns = AccessUnitSigns();
-    m_ReadData.SetSize(0);
+    m_ReadData.Clear();
+    m_ParameterSets.SetSize(0);
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
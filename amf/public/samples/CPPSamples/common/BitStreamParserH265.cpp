@@ -31,6 +31,8 @@
 //
 
 #include "BitStreamParserH265.h"
+#include "StartCodeScanner.h"
+#include "BitStreamWindow.h"
 #include "public/common/ByteArray.h"
 
 #include <vector>
@@ -87,6 +89,8 @@ public:
 
     virtual AMF_RESULT              QueryOutput(amf::AMFData** ppData);
     virtual AMF_RESULT              ReInit();
+    virtual AMF_RESULT              SetZeroCopy(bool bZeroCopy);
+    virtual AMF_RESULT              SeekToOffset(amf_int64 iOffset, amf_size iFrame, amf_int64 iParameterSetsOffset);
 
 protected:
     // ISO-IEC 14496-15-2004.pdf, page 14, table 1 " NAL unit types in elementary streams.
@@ -507,13 +511,16 @@ protected:
         return nalu_header;
     }
     size_t EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos);
+    bool CanWriteLengthsInPlace(const std::vector<size_t> &naluStarts, const std::vector<size_t> &naluSizes) const;
+    void AddParameterSet(const amf_uint8 *nalu, size_t size);
     AMFRect GetCropRect() const;
 
 
-    AMFByteArray   m_ReadData;
+    BitStreamWindow m_ReadData;
     AMFByteArray   m_Extradata;
 
     AMFByteArray   m_EBSPtoRBSPData;
+    AMFByteArray   m_ParameterSets;     // output ready, sent with the next picture after SeekToOffset()
 
     bool           m_bUseStartCodes;
     amf_pts        m_currentFrameTimestamp;
@@ -642,6 +649,77 @@ void HevcParser::SetUseStartCodes(bool bUse)
     m_bUseStartCodes = bUse;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT HevcParser::SetZeroCopy(bool bZeroCopy)
+{
+    m_ReadData.SetZeroCopy(bZeroCopy, m_pStream);
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT HevcParser::SeekToOffset(amf_int64 iOffset, amf_size iFrame, amf_int64 iParameterSetsOffset)
+{
+    m_ParameterSets.SetSize(0);
+    if (iParameterSetsOffset >= 0)
+    {
+        // collect VPS, SPS and PPS up to the first slice of that access unit
+        AMF_RESULT res = m_pStream->Seek(amf::AMF_SEEK_BEGIN, iParameterSetsOffset, NULL);
+        if (res != AMF_OK)
+        {
+            return res;
+        }
+        m_ReadData.Clear();
+        m_bEof = false;
+        size_t dataOffset = 0;
+        for (;;)
+        {
+            size_t naluSize = 0;
+            size_t naluOffset = 0;
+            NalUnitHeader naluHeader = ReadNextNaluUnit(&dataOffset, &naluOffset, &naluSize);
+            if (naluHeader.nal_unit_type == NAL_UNIT_INVALID || naluHeader.nal_unit_type < NAL_UNIT_VPS)
+            {
+                break;
+            }
+            if (naluHeader.nal_unit_type == NAL_UNIT_VPS || naluHeader.nal_unit_type == NAL_UNIT_SPS || naluHeader.nal_unit_type == NAL_UNIT_PPS)
+            {
+                AddParameterSet(m_ReadData.GetData() + naluOffset, naluSize);
+            }
+        }
+    }
+
+    AMF_RESULT res = m_pStream->Seek(amf::AMF_SEEK_BEGIN, iOffset, NULL);
+    if (res != AMF_OK)
+    {
+        return res;
+    }
+    m_ReadData.Clear();
+    m_bEof = false;
+    m_PacketCount = iFrame;
+    m_currentFrameTimestamp = amf_pts(AMF_SECOND / GetFrameRate()) * amf_pts(iFrame);
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void HevcParser::AddParameterSet(const amf_uint8 *nalu, size_t size)
+{
+    const size_t pos = m_ParameterSets.GetSize();
+    m_ParameterSets.SetSize(pos + NalUnitLengthSize + size);
+    amf_uint8 *data = m_ParameterSets.GetData() + pos;
+    if (m_bUseStartCodes)
+    {
+        *data++ = 0;
+        *data++ = 0;
+        *data++ = 0;
+        *data++ = 1;
+    }
+    else
+    {
+        amf_uint32 naluSize= (amf_uint32)size;
+        *data++ = (naluSize >> 24);
+        *data++ = static_cast<amf_uint8>(((naluSize & 0x00FF0000) >> 16));
+        *data++ = ((naluSize & 0x0000FF00) >> 8);
+        *data++ = ((naluSize & 0x000000FF));
+    }
+    memcpy(data, nalu, size);
+}
+//-------------------------------------------------------------------------------------------------
 void HevcParser::SetFrameRate(double fps)
 {
     m_fps = fps;
@@ -807,8 +885,34 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     } while (!newPictureDetected);
 
 
+    // parameter sets of an earlier access unit after SeekToOffset()
+    const size_t parameterSetsSize = m_ParameterSets.GetSize();
+    packetSize += parameterSetsSize;
+
     amf::AMFBufferPtr pictureBuffer;
-    AMF_RESULT ar = m_pContext->AllocBuffer(amf::AMF_MEMORY_HOST, packetSize, &pictureBuffer);
+    AMF_RESULT ar = AMF_OK;
+    const bool bSlice = parameterSetsSize == 0 && packetSize > 0 && m_ReadData.IsZeroCopy() && (m_bUseStartCodes || CanWriteLengthsInPlace(naluStarts, naluSizes));
+    if (bSlice)
+    {
+        if (!m_bUseStartCodes)
+        {
+            // the length fields overwrite the start codes in the window
+            for( size_t i=0; i < naluStarts.size(); i++)
+            {
+                amf_uint32 naluSize= (amf_uint32)naluSizes[i];
+                amf_uint8 *data = m_ReadData.GetData() + naluStarts[i] - NalUnitLengthSize;
+                *data++ = (naluSize >> 24);
+                *data++ = static_cast<amf_uint8>(((naluSize & 0x00FF0000) >> 16));
+                *data++ = ((naluSize & 0x0000FF00) >> 8);
+                *data++ = ((naluSize & 0x000000FF));
+            }
+        }
+        ar = m_ReadData.Slice(m_pContext, 0, packetSize, &pictureBuffer);
+    }
+    else
+    {
+        ar = m_pContext->AllocBuffer(amf::AMF_MEMORY_HOST, packetSize, &pictureBuffer);
+    }
 
     // AMF result check
     if (ar != AMF_OK) {
@@ -816,9 +920,19 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
     }
 
     amf_uint8 *data = (amf_uint8*)pictureBuffer->GetNative();
-    if(m_bUseStartCodes)
+    if(parameterSetsSize > 0)
     {
-        memcpy(data, m_ReadData.GetData(), packetSize);
+        memcpy(data, m_ParameterSets.GetData(), parameterSetsSize);
+        data += parameterSetsSize;
+        m_ParameterSets.SetSize(0);
+    }
+    if(bSlice)
+    {
+        // references the window, nothing to copy
+    }
+    else if(m_bUseStartCodes)
+    {
+        memcpy(data, m_ReadData.GetData(), packetSize - parameterSetsSize);
     }
     else
     {
@@ -843,23 +957,39 @@ AMF_RESULT HevcParser::QueryOutput(amf::AMFData** ppData)
 
 //    if (newPictureDetected)
     {
-    // shift remaining data in m_ReadData
-        size_t remainingData = m_ReadData.GetSize() - readSize;
-        memmove(m_ReadData.GetData(), m_ReadData.GetData()+readSize, remainingData);
-        m_ReadData.SetSize(remainingData);
+    // drop the consumed data from the front of m_ReadData, the remainder is not moved
+        m_ReadData.Consume(readSize);
     }
     *ppData = pictureBuffer.Detach();
     m_PacketCount++;
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+bool HevcParser::CanWriteLengthsInPlace(const std::vector<size_t> &naluStarts, const std::vector<size_t> &naluSizes) const
+{
+    if (!m_ReadData.IsWritable())
+    {
+        return false;
+    }
+    // every NAL unit has to follow a 4 byte start code directly
+    size_t end = 0;
+    for( size_t i=0; i < naluStarts.size(); i++)
+    {
+        if (naluStarts[i] != end + NalUnitLengthSize)
+        {
+            return false;
+        }
+        end = naluStarts[i] + naluSizes[i];
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
 HevcParser::NalUnitHeader   HevcParser::ReadNextNaluUnit(size_t *offset, size_t *nalu, size_t *size)
 {
     *size = 0;
     size_t startOffset = *offset;
 
     bool newNalFound = false;
-    size_t zerosCount = 0;
 
     while(!newNalFound)
     {
@@ -870,25 +1000,12 @@ HevcParser::NalUnitHeader   HevcParser::ReadNextNaluUnit(size_t *offset, size_t
 		{
 			if (m_bEof == false)
 			{
-				m_ReadData.SetSize(m_ReadData.GetSize() + m_ReadSize);
                 ready = 0;
-                m_pStream->Read(m_ReadData.GetData() + *offset, m_ReadSize, &ready);
-			}
-
-
-			if (ready != m_ReadSize && ready != 0)
-			{
-				m_ReadData.SetSize(m_ReadData.GetSize() - (m_ReadSize - ready));
+                m_ReadData.Read(m_pStream, m_ReadSize, &ready);
 			}
 
-
-
-
             if(ready == 0 )
             {
-				if (m_bEof == false)
-				m_ReadData.SetSize(m_ReadData.GetSize() - m_ReadSize);
-
                 m_bEof = true;
                 newNalFound = startOffset != *offset;
                 *offset = m_ReadData.GetSize();
@@ -903,35 +1020,29 @@ HevcParser::NalUnitHeader   HevcParser::ReadNextNaluUnit(size_t *offset, size_t
             header_nalu.nal_unit_type = NAL_UNIT_INVALID;
             return header_nalu; // no data read
         }
-        data += *offset; // don't forget the offset!
 
-        for(size_t i = 0; i < ready; i++)
+        // a start code can straddle the previous portion - look back over its first two bytes
+        size_t from = (*offset >= startOffset + 2) ? *offset - 2 : startOffset;
+        size_t end = *offset + ready;
+        size_t found = from + StartCodeScanner::FindStartCode(data + from, end - from);
+        while (found < end)
         {
-            amf_uint8 ch = *data++;
-            if (0 == ch)
+            // the zeros in front belong to the start code (4 byte form, trailing_zero_8bits)
+            size_t zeros = found;
+            while (zeros > startOffset && data[zeros - 1] == 0)
             {
-                zerosCount++;
+                zeros--;
             }
-            else
+            if (zeros > startOffset) // We found a start code in Annex B stream
             {
-                if (1 == ch && zerosCount >=2) // We found a start code in Annex B stream
-                {
-                    if(*offset + (i - zerosCount) > startOffset)
-                    {
-                        ready = i - zerosCount;
-                        newNalFound = true; // new NAL
-                        break;
-                    }
-                    else
-                    {
-                        *nalu = *offset + zerosCount + 1;
-                    }
-                }
-                zerosCount = 0;
+                end = zeros;
+                newNalFound = true; // new NAL
+                break;
             }
+            *nalu = found + 3;
+            found = *nalu + StartCodeScanner::FindStartCode(data + *nalu, end - *nalu);
         }
-        // if zeros found but not a new NAL - continue with zerosCount on the next iteration
-        *offset += ready;
+        *offset = end;
     }
     if(!newNalFound)
     {
@@ -1007,7 +1118,7 @@ void    HevcParser::FindSPSandPPS()
     } while (true);
 
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
-    m_ReadData.SetSize(0);
+    m_ReadData.Clear();
     // It will fail if SPS or PPS are absent
     extraDataBuilder.GetExtradata(m_Extradata, m_bUseStartCodes);
 }
@@ -1758,58 +1869,14 @@ bool HevcParser::ExtraDataBuilder::GetExtradata(AMFByteArray   &extradata, bool
     return true;
 }
 //-------------------------------------------------------------------------------------------------
-#define ZEROBYTES_SHORTSTARTCODE 2 //indicates the number of zero bytes in the short start-code prefix
-//-------------------------------------------------------------------------------------------------
 size_t HevcParser::EBSPtoRBSP(amf_uint8 *streamBuffer,size_t begin_bytepos, size_t end_bytepos)
 {
-    int count = 0;
     if(end_bytepos < begin_bytepos)
     {
         return end_bytepos;
     }
-    amf_uint8 *streamBuffer_i=streamBuffer+begin_bytepos;
-    amf_uint8 *streamBuffer_end=streamBuffer+end_bytepos;
-    int iReduceCount=0;
-    for(; streamBuffer_i!=streamBuffer_end; )
-    {
-        //starting from begin_bytepos to avoid header information
-        //in NAL unit, 0x000000, 0x000001 or 0x000002 shall not occur at any amf_uint8-aligned position
-        amf_uint8 tmp=*streamBuffer_i;
-        if(count == ZEROBYTES_SHORTSTARTCODE)
-        {
-            if(tmp == 0x03)
-            {
-                //check the 4th amf_uint8 after 0x000003, except when cabac_zero_word is used, in which case the last three bytes of this NAL unit must be 0x000003
-                if((streamBuffer_i+1 != streamBuffer_end) && (streamBuffer_i[1] > 0x03))
-                {
-                    return static_cast<size_t>(-1);
-                }
-                //if cabac_zero_word is used, the final amf_uint8 of this NAL unit(0x03) is discarded, and the last two bytes of RBSP must be 0x0000
-                if(streamBuffer_i+1 == streamBuffer_end)
-                {
-                    break;
-                }
-                memmove(streamBuffer_i,streamBuffer_i+1,streamBuffer_end-streamBuffer_i-1);
-                streamBuffer_end--;
-                iReduceCount++;
-                count = 0;
-                tmp = *streamBuffer_i;
-            }
-            else if(tmp < 0x03)
-            {
-            }
-        }
-        if(tmp == 0x00)
-        {
-            count++;
-        }
-        else
-        {
-            count = 0;
-        }
-        streamBuffer_i++;
-    }
-    return end_bytepos - begin_bytepos + iReduceCount;
+    // in NAL unit, 0x000000, 0x000001 or 0x000002 shall not occur at any amf_uint8-aligned position
+    return StartCodeScanner::RemoveEmulationPrevention(streamBuffer + begin_bytepos, end_bytepos - begin_bytepos);
 }
 
 //sizeId = 0
@@ -1843,5 +1910,7 @@ AMF_RESULT              HevcParser::ReInit()
     m_pStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
     m_PacketCount = 0;
     m_bEof = false;
+    m_ReadData.Clear();
+    m_ParameterSets.SetSize(0);
     return AMF_OK;
 }
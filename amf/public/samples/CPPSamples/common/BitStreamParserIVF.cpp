@@ -65,6 +65,7 @@ public:
 
 	virtual AMF_RESULT              QueryOutput(amf::AMFData** ppData);
 	virtual AMF_RESULT              ReInit();
+	virtual AMF_RESULT              SeekToOffset(amf_int64 iOffset, amf_size iFrame, amf_int64 iParameterSetsOffset);
 
 	static const size_t m_ReadSize = 1024 * 4;
 	amf_uint16 m_pwidth;
@@ -257,6 +258,21 @@ AMF_RESULT              IVFParser::ReInit()
 	return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT              IVFParser::SeekToOffset(amf_int64 iOffset, amf_size iFrame, amf_int64 /* iParameterSetsOffset */)
+{
+	// key frames carry what is needed to decode them, the offset is the one of the frame header
+	AMF_RESULT res = m_pStream->Seek(amf::AMF_SEEK_BEGIN, iOffset, NULL);
+	if (res != AMF_OK)
+	{
+		return res;
+	}
+	m_CurrentFrameSize = 0;
+	m_PacketCount = iFrame;
+	m_bEof = false;
+	m_ReadData.SetSize(0);
+	return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT IVFParser::QueryOutput(amf::AMFData** ppData)
 {
 	if (m_bFrozen)
@@ -344,7 +360,8 @@ AMF_RESULT IVFParser::QueryOutput(amf::AMFData** ppData)
 
 	amf_uint8 *data = (amf_uint8*)pictureBuffer->GetNative();
 
-	memcpy(data, m_ReadData.GetData(), m_CurrentFrameSize);
+	// only the bytes read are valid, a truncated frame is passed on as is
+	memcpy(data, m_ReadData.GetData(), currentOutputSize);
 
 	pictureBuffer->SetPts(m_currentFrameTimestamp);
 
@@ -0,0 +1,313 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/Context.h"
+#include "public/common/DataStream.h"
+#include "public/common/TraceAdapter.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string.h>
+
+#define AMF_FACILITY L"BitStreamWindow"
+
+//-------------------------------------------------------------------------------------------------
+// Read buffer of the elementary stream parsers.
+// In zero-copy mode access units are handed out as AMFBuffers that reference the window memory;
+// a block is written again only after every buffer referencing it has been released. Streams that
+// expose the whole file through AMFDataStreamView (mmap://) are not copied at all.
+//-------------------------------------------------------------------------------------------------
+class BitStreamWindow
+{
+public:
+    static const size_t DefaultBlockSize = 8 * 1024 * 1024;
+
+    BitStreamWindow() :
+        m_iHead(0),
+        m_iSize(0),
+        m_bZeroCopy(false),
+        m_pViewData(NULL),
+        m_iViewSize(0)
+    {
+    }
+
+    // pStream is checked for a whole file view, can be called with data pending
+    void SetZeroCopy(bool bZeroCopy, amf::AMFDataStream* pStream)
+    {
+        m_bZeroCopy = bZeroCopy;
+        if (bZeroCopy == false)
+        {
+            DetachView();
+            return;
+        }
+        if (m_pView != NULL || pStream == NULL)
+        {
+            return;
+        }
+
+        amf::AMFDataStreamViewPtr pView(pStream);
+        amf_int64 fileSize = 0;
+        amf_int64 position = 0;
+        const void* pData = NULL;
+        amf_size viewSize = 0;
+        if (pView == NULL || pView->GetSize(&fileSize) != AMF_OK || pView->GetPosition(&position) != AMF_OK ||
+            pView->GetView(0, (amf_size)fileSize, &pData, &viewSize) != AMF_OK || viewSize != (amf_size)fileSize)
+        {
+            return; // reads into blocks
+        }
+        m_pView = pView;
+        m_pViewData = static_cast<const amf_uint8*>(pData);
+        m_iViewSize = viewSize;
+        // the pending data is the same bytes in the mapping
+        m_iHead = (size_t)position - m_iSize;
+    }
+    bool IsZeroCopy() const { return m_bZeroCopy; }
+    // mapped data is read only
+    bool IsWritable() const { return m_pView == NULL; }
+
+    amf_uint8* GetData() const
+    {
+        if (m_pView != NULL)
+        {
+            return const_cast<amf_uint8*>(m_pViewData) + m_iHead;
+        }
+        return m_pBlock != NULL ? m_pBlock->pData + m_iHead : NULL;
+    }
+    size_t GetSize() const { return m_iSize; }
+
+    // appends up to size bytes from the stream
+    AMF_RESULT Read(amf::AMFDataStream* pStream, size_t size, size_t* pRead)
+    {
+        *pRead = 0;
+        if (m_pView != NULL)
+        {
+            amf_int64 position = 0;
+            AMF_RETURN_IF_FAILED(pStream->GetPosition(&position));
+            if (m_iSize == 0)
+            {
+                m_iHead = (size_t)position; // after Clear() or a seek
+            }
+            const size_t available = m_iViewSize > (size_t)position ? m_iViewSize - (size_t)position : 0;
+            const size_t read = size < available ? size : available;
+            AMF_RETURN_IF_FAILED(pStream->Seek(amf::AMF_SEEK_CURRENT, (amf_int64)read, NULL));
+            m_iSize += read;
+            *pRead = read;
+            return AMF_OK;
+        }
+
+        AMF_RETURN_IF_FALSE(Reserve(m_iSize + size), AMF_OUT_OF_MEMORY, L"Read() - cannot allocate %d bytes", (int)(m_iSize + size));
+        amf_size read = 0;
+        AMF_RESULT res = pStream->Read(GetData() + m_iSize, size, &read);
+        m_iSize += read;
+        *pRead = read;
+        return res;
+    }
+    void Consume(size_t size)
+    {
+        if (size >= m_iSize)
+        {
+            Clear();
+            return;
+        }
+        m_iHead += size;
+        m_iSize -= size;
+    }
+    void Clear()
+    {
+        m_iSize = 0;
+        if (m_pView == NULL)
+        {
+            m_iHead = 0;
+        }
+    }
+
+    // wraps size bytes at offset into a buffer that keeps the memory referenced
+    AMF_RESULT Slice(amf::AMFContext* pContext, size_t offset, size_t size, amf::AMFBuffer** ppBuffer)
+    {
+        AMF_RETURN_IF_FALSE(offset + size <= m_iSize, AMF_INVALID_ARG, L"Slice() - %d bytes at %d out of %d", (int)size, (int)offset, (int)m_iSize);
+
+        amf::AMFBufferObserver* pObserver = AddSliceReference();
+        AMF_RESULT res = pContext->CreateBufferFromHostNative(GetData() + offset, size, ppBuffer, pObserver);
+        if (res != AMF_OK)
+        {
+            pObserver->OnBufferDataRelease(NULL);
+        }
+        return res;
+    }
+    // keeps the memory at GetData() from being written again until OnBufferDataRelease() is
+    // called on the returned observer, which then deletes itself
+    amf::AMFBufferObserver* AddSliceReference()
+    {
+        return new SliceObserver(m_pBlock, m_pView);
+    }
+
+private:
+    struct Block
+    {
+        explicit Block(size_t size) : pData(new amf_uint8[size]), capacity(size), slices(0) {}
+        ~Block() { delete[] pData; }
+
+        amf_uint8*          pData;
+        size_t              capacity;
+        std::atomic<long>   slices;     // buffers still referencing the block
+    };
+    typedef std::shared_ptr<Block> BlockPtr;
+
+    class SliceObserver : public amf::AMFBufferObserver
+    {
+    public:
+        SliceObserver(const BlockPtr& pBlock, amf::AMFDataStream* pView) : m_pBlock(pBlock), m_pView(pView)
+        {
+            if (m_pBlock != NULL)
+            {
+                m_pBlock->slices++;
+            }
+        }
+        virtual ~SliceObserver()
+        {
+            if (m_pBlock != NULL)
+            {
+                m_pBlock->slices.fetch_sub(1, std::memory_order_release);
+            }
+        }
+        virtual void AMF_STD_CALL OnBufferDataRelease(amf::AMFBuffer* /*pBuffer*/) { delete this; }
+    private:
+        BlockPtr                m_pBlock;
+        amf::AMFDataStreamPtr   m_pView;    // keeps the mapping open
+    };
+
+    static bool IsFree(const BlockPtr& pBlock)
+    {
+        return pBlock->slices.load(std::memory_order_acquire) == 0;
+    }
+
+    bool Reserve(size_t size)
+    {
+        if (m_pBlock != NULL && m_iHead + size <= m_pBlock->capacity)
+        {
+            return true;
+        }
+        // nothing references the block - compact in place when at least as much was consumed as
+        // has to be moved, same as AMFByteArray
+        if (m_pBlock != NULL && IsFree(m_pBlock) && size <= m_pBlock->capacity && m_iHead >= m_iSize)
+        {
+            if (m_iSize > 0)
+            {
+                memmove(m_pBlock->pData, m_pBlock->pData + m_iHead, m_iSize);
+            }
+            m_iHead = 0;
+            return true;
+        }
+
+        // keep the block size while the pending data is small, a block still referenced by slices
+        // is left behind rather than grown
+        size_t capacity = m_pBlock != NULL ? m_pBlock->capacity : 0;
+        if (m_bZeroCopy && capacity < DefaultBlockSize)
+        {
+            capacity = DefaultBlockSize;
+        }
+        while (capacity < size * 2)
+        {
+            capacity = capacity > 0 ? capacity * 2 : size * 2;
+        }
+
+        // a released block of the pool or a new one, the pending data moves over
+        BlockPtr pNext;
+        if (m_bZeroCopy)
+        {
+            for (std::vector<BlockPtr>::iterator it = m_Pool.begin(); it != m_Pool.end(); ++it)
+            {
+                if (*it != m_pBlock && (*it)->capacity >= size && IsFree(*it))
+                {
+                    pNext = *it;
+                    break;
+                }
+            }
+        }
+        if (pNext == NULL)
+        {
+            pNext = BlockPtr(new (std::nothrow) Block(capacity));
+            if (pNext == NULL)
+            {
+                return false;
+            }
+            if (m_bZeroCopy)
+            {
+                m_Pool.push_back(pNext);
+            }
+        }
+        if (m_iSize > 0)
+        {
+            memcpy(pNext->pData, m_pBlock->pData + m_iHead, m_iSize);
+        }
+        m_pBlock = pNext;
+        m_iHead = 0;
+        return true;
+    }
+    void DetachView()
+    {
+        if (m_pView == NULL)
+        {
+            return;
+        }
+        const amf_uint8* pPending = m_pViewData + m_iHead;
+        m_pView = NULL;
+        m_pViewData = NULL;
+        m_iViewSize = 0;
+        m_iHead = 0;
+        const size_t pending = m_iSize;
+        m_iSize = 0;
+        if (pending > 0 && Reserve(pending))
+        {
+            memcpy(m_pBlock->pData, pPending, pending);
+            m_iSize = pending;
+        }
+    }
+
+    BlockPtr                    m_pBlock;
+    std::vector<BlockPtr>       m_Pool;         // zero-copy blocks, reused once released
+    size_t                      m_iHead;        // offset of the data in the block or the mapping
+    size_t                      m_iSize;
+    bool                        m_bZeroCopy;
+
+    amf::AMFDataStreamViewPtr   m_pView;
+    const amf_uint8*            m_pViewData;
+    size_t                      m_iViewSize;
+
+    BitStreamWindow(const BitStreamWindow&);
+    BitStreamWindow& operator=(const BitStreamWindow&);
+};
+
+#undef AMF_FACILITY
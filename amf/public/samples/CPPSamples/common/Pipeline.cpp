@@ -33,10 +33,15 @@
 #include "public/common/Thread.h"
 #include "CmdLogger.h"
 #include <sstream>
+#include <set>
 
 #pragma warning(disable:4355)
 
-typedef amf::AMFQueue<amf::AMFDataPtr>   DataQueue;
+typedef amf::AMFRingQueue<amf::AMFDataPtr>   DataQueue;
+
+// CT_Scheduled timer polls of components that do not report output
+static const amf_pts SCHEDULER_RETRY_MIN = AMF_MILLISECOND / 20;
+static const amf_pts SCHEDULER_RETRY_MAX = AMF_MILLISECOND;
 
 class PipelineConnector;
 class InputSlot;
@@ -80,7 +85,16 @@ public:
     virtual void Run();
     AMF_RESULT Drain();
     AMF_RESULT SubmitInput(amf::AMFData* pData, amf_ulong ulTimeout, bool poll);
-    virtual AMF_RESULT Flush() {return AMF_OK;}
+    virtual void Restart();
+    virtual AMF_RESULT Flush();
+
+    // CT_Scheduled: submits what the upstream queue holds, returns true if anything moved
+    bool SubmitScheduled(bool& bBlocked);
+
+    amf::AMFDataPtr         m_pPending;     // taken from the upstream queue, not accepted yet
+    bool                    m_bPending;
+    bool                    m_bResubmit;
+    bool                    m_bDraining;
 };
 typedef std::shared_ptr<InputSlot> InputSlotPtr;
 //-------------------------------------------------------------------------------------------------
@@ -98,21 +112,28 @@ public:
     AMF_RESULT Poll();
     virtual void Restart();
     virtual AMF_RESULT Flush();
+
+    // CT_Scheduled: moves output into the queue until it is full, returns true if anything moved
+    bool PollScheduled(bool& bIdle);
+
+    amf::AMFDataPtr         m_pPending;     // queried from the element, the queue was full
+    bool                    m_bPending;
 };
 typedef std::shared_ptr<OutputSlot> OutputSlotPtr;
 //-------------------------------------------------------------------------------------------------
-class PipelineConnector
+class PipelineConnector : public PipelineElementNotify
 {
     friend class Pipeline;
     friend class InputSlot;
     friend class OutputSlot;
+    friend class PipelineScheduler;
 protected:
 
 public:
     PipelineConnector(Pipeline *host, PipelineElementPtr element);
     virtual ~PipelineConnector();
 
-    void Start();
+    void Start(PipelineScheduler* pScheduler);
     void Stop();
     bool StopRequested() {return m_bStop;}
 
@@ -137,7 +158,22 @@ public:
 
     void SetStatSlot(amf_int32 slot) {m_iStatSlot = slot;}
 
+    // CT_Scheduled
+    bool IsScheduled() const;
+    void Schedule();
+    virtual void OnOutputReady() { Schedule(); }
+
 protected:
+    enum ScheduleState
+    {
+        ScheduleIdle,
+        ScheduleQueued,
+        ScheduleRunning,
+        ScheduleRunningAgain,   // readiness arrived while running, the step is queued again when it ends
+    };
+    static void AMF_CDECL_CALL ScheduledProc(void* pContext, amf_int64 iBegin, amf_int64 iEnd);
+    void RunScheduled();
+
     Pipeline*               m_pPipeline;
     PipelineElementPtr      m_pElement;
     bool                    m_bStop;
@@ -147,6 +183,39 @@ protected:
 
     std::vector<InputSlotPtr>               m_InputSlots;
     std::vector<OutputSlotPtr>              m_OutputSlots;
+
+    PipelineScheduler*                      m_pScheduler;
+    std::atomic<amf_int32>                  m_iScheduleState;
+    amf_pts                                 m_RetryInterval;
+    amf_pts                                 m_TimerDeadline;    // owned by the scheduler timer, 0 - none
+    bool                                    m_bAwaitingOutput;  // input was accepted, output may still come
+};
+//-------------------------------------------------------------------------------------------------
+// CT_Scheduled: a small worker pool runs the elements that became ready, one step per element at a time.
+// Components without output notification are polled again by the timer, starting at a fraction of a
+// millisecond and backing off while nothing moves
+//-------------------------------------------------------------------------------------------------
+class PipelineScheduler : public amf::AMFThread
+{
+public:
+    PipelineScheduler(amf_int32 iThreads);
+    virtual ~PipelineScheduler();
+
+    void Submit(PipelineConnector* pConnector);
+    void ScheduleAt(PipelineConnector* pConnector, amf_pts deadline);
+    // stops the timer and waits for the running steps, connectors must be stopped before
+    void Shutdown();
+
+protected:
+    virtual void Run();
+
+    typedef std::set<std::pair<amf_pts, PipelineConnector*> > TimerSet;
+
+    amf::AMFThreadPool      m_Pool;
+    amf::AMFTaskGroup       m_Steps;
+    amf::AMFCriticalSection m_sync;
+    TimerSet                m_Timers;
+    amf::AMFDeadlineWaiter  m_waiter;
 };
 //-------------------------------------------------------------------------------------------------
 // class Pipeline
@@ -154,7 +223,9 @@ protected:
 Pipeline::Pipeline() : 
     m_state(PipelineStateNotReady),
     m_startTime(0),
-    m_stopTime(0)
+    m_stopTime(0),
+    m_pScheduler(NULL),
+    m_iSchedulerThreads(0)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -222,6 +293,12 @@ PipelineElementPtr Pipeline::GetLastElement()
 
     return res;
 }
+AMF_RESULT Pipeline::SetSchedulerThreads(amf_int32 iThreads)
+{
+    amf::AMFLock lock(&m_cs);
+    m_iSchedulerThreads = iThreads;
+    return AMF_OK;
+}
 AMF_RESULT Pipeline::SetStatSlot(PipelineElementPtr pElement, amf_int32 slot)
 {
     PipelineConnectorPtr connector;
@@ -253,9 +330,26 @@ AMF_RESULT Pipeline::Start()
     }
     m_startTime = amf_high_precision_clock();
 
+    amf_int32 scheduled = 0;
+    for(ConnectorList::iterator it = m_connectors.begin(); it != m_connectors.end() ; it++)
+    {
+        if((*it)->IsScheduled())
+        {
+            scheduled++;
+        }
+    }
+    if(scheduled > 0 && m_pScheduler == NULL)
+    {
+        // an element never runs on two workers, and with one worker per element a step that blocks
+        // in a CT_Direct submit cannot starve the element that unblocks it
+        const amf_int32 threads = m_iSchedulerThreads > 0 ? m_iSchedulerThreads : scheduled;
+        m_pScheduler = new PipelineScheduler(threads);
+        m_pScheduler->Start();
+    }
+
     for(ConnectorList::iterator it = m_connectors.begin(); it != m_connectors.end() ; it++)
     {
-        (*it)->Start();
+        (*it)->Start(m_pScheduler);
     }
     m_state = PipelineStateRunning;
     return AMF_OK;
@@ -263,12 +357,23 @@ AMF_RESULT Pipeline::Start()
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT Pipeline::Stop()
 {
+    if(m_pScheduler != NULL)
+    {
+        // scheduled steps must be done before the elements are drained
+        for(ConnectorList::iterator it = m_connectors.begin(); it != m_connectors.end(); it++)
+        {
+            (*it)->m_bStop = true;
+        }
+        m_pScheduler->Shutdown();
+    }
     for(ConnectorList::iterator it = m_connectors.begin(); it != m_connectors.end(); it++)
     {
         (*it)->Stop();
     }
     amf::AMFLock lock(&m_cs);
     m_connectors.clear();
+    delete m_pScheduler;
+    m_pScheduler = NULL;
     m_state = PipelineStateNotReady;
     return AMF_OK;
 }
@@ -441,7 +546,10 @@ bool Slot::StopRequested()
 //-------------------------------------------------------------------------------------------------
 InputSlot::InputSlot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot) :
         Slot(eThreading, connector, thisSlot),
-        m_pUpstreamOutputSlot(NULL)
+        m_pUpstreamOutputSlot(NULL),
+        m_bPending(false),
+        m_bResubmit(false),
+        m_bDraining(false)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -591,16 +699,110 @@ AMF_RESULT InputSlot::SubmitInput(amf::AMFData* pData, amf_ulong /*ulTimeout*/,
     }
 
     // poll output
+    m_pConnector->Schedule(); // CT_Scheduled outputs of this element
     m_pConnector->PollAll();
 
     return res;
 }
 //-------------------------------------------------------------------------------------------------
+void InputSlot::Restart()
+{
+    m_pPending = NULL;
+    m_bPending = false;
+    m_bResubmit = false;
+    m_bDraining = false;
+    Slot::Restart();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT InputSlot::Flush()
+{
+    m_pPending = NULL;
+    m_bPending = false;
+    m_bResubmit = false;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+bool InputSlot::SubmitScheduled(bool& bBlocked)
+{
+    bool bMoved = false;
+    while(!StopRequested() && !m_bFrozen && !IsEof())
+    {
+        if(!m_bPending)
+        {
+            amf::AMFDataPtr data;
+            amf_ulong id = 0;
+            if(!m_pUpstreamOutputSlot->m_dataQueue.Get(id, data, 0))
+            {
+                break; // upstream schedules this element when it adds data
+            }
+            m_pUpstreamOutputSlot->m_pConnector->Schedule(); // space freed upstream
+            bMoved = true;
+            if(data == NULL)
+            {
+                OnEof();
+                m_bDraining = true;
+                break;
+            }
+            m_pPending = data;
+            m_bPending = true;
+            m_bResubmit = false;
+        }
+
+        AMF_RESULT res = m_bResubmit ? m_pConnector->m_pElement->ReSubmitInput(m_iThisSlot) : m_pConnector->m_pElement->SubmitInput(m_pPending, m_iThisSlot);
+        if(m_bFrozen)
+        {
+            break;
+        }
+        if(res == AMF_INPUT_FULL || res == AMF_DECODER_NO_FREE_SURFACES)
+        {
+            bBlocked = true; // retried after the element gives output away
+            break;
+        }
+        bMoved = true;
+        m_pConnector->m_bAwaitingOutput = true;
+        if(res == AMF_REPEAT)
+        {
+            m_bResubmit = true; // need to submit one more time
+            continue;
+        }
+        if(res == AMF_OK || res == AMF_RESOLUTION_UPDATED)
+        {
+            if(!m_bResubmit && m_iThisSlot == m_pConnector->m_iStatSlot)
+            {
+                m_pConnector->m_iSubmitFramesProcessed++;
+            }
+        }
+        else if(res != AMF_EOF && res != AMF_NEED_MORE_INPUT)
+        {
+            LOG_ERROR(L"SubmitInput() returned error: " << g_AMFFactory.GetTrace()->GetResultText(res));
+        }
+        m_pPending = NULL;
+        m_bPending = false;
+        m_bResubmit = false;
+    }
+
+    if(m_bDraining && !StopRequested() && !m_bFrozen)
+    {
+        if(m_pConnector->m_pElement->Drain(m_iThisSlot) == AMF_INPUT_FULL)
+        {
+            bBlocked = true;
+        }
+        else
+        {
+            m_bDraining = false;
+            m_pConnector->m_bAwaitingOutput = true;
+            bMoved = true;
+        }
+    }
+    return bMoved;
+}
+//-------------------------------------------------------------------------------------------------
 // class OutputSlot
 //-------------------------------------------------------------------------------------------------
 OutputSlot::OutputSlot(ConnectionThreading eThreading, PipelineConnector *connector, amf_int32 thisSlot, amf_int32 queueSize) :
     Slot(eThreading, connector, thisSlot),
-    m_pDownstreamInputSlot(NULL)
+    m_pDownstreamInputSlot(NULL),
+    m_bPending(false)
 {
     m_dataQueue.SetQueueSize(queueSize);
 }
@@ -742,15 +944,63 @@ AMF_RESULT OutputSlot::Poll()
     return res;
 }
 //-------------------------------------------------------------------------------------------------
+bool OutputSlot::PollScheduled(bool& bIdle)
+{
+    bool bMoved = false;
+    while(!StopRequested() && !m_bFrozen && !IsEof())
+    {
+        if(!m_bPending)
+        {
+            amf::AMFDataPtr data;
+            AMF_RESULT res = m_pConnector->m_pElement->QueryOutput(&data, m_iThisSlot);
+            if(m_bFrozen)
+            {
+                break;
+            }
+            if(data == NULL && res != AMF_EOF)
+            {
+                bIdle = true; // nothing in component
+                break;
+            }
+            if(data != NULL && m_iThisSlot == m_pConnector->m_iStatSlot)
+            {
+                m_pConnector->m_iPollFramesProcessed++; // EOF is not included
+            }
+            m_pPending = data; // EOF is sent as NULL data to the next element
+            m_bPending = true;
+        }
+
+        amf_ulong id = 0;
+        if(!m_dataQueue.Add(id, m_pPending, 0, 0))
+        {
+            break; // downstream schedules this element when it takes data
+        }
+        const bool bEof = m_pPending == NULL;
+        m_pPending = NULL;
+        m_bPending = false;
+        bMoved = true;
+        m_pDownstreamInputSlot->m_pConnector->Schedule();
+        if(bEof)
+        {
+            OnEof();
+        }
+    }
+    return bMoved;
+}
+//-------------------------------------------------------------------------------------------------
 void OutputSlot::Restart()
 {
     m_dataQueue.Clear();
+    m_pPending = NULL;
+    m_bPending = false;
     Slot::Restart();
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT OutputSlot::Flush()
 {
     m_dataQueue.Clear();
+    m_pPending = NULL;
+    m_bPending = false;
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -762,7 +1012,12 @@ PipelineConnector::PipelineConnector(Pipeline *host, PipelineElementPtr element)
   m_bStop(false),
   m_iSubmitFramesProcessed(0),
   m_iPollFramesProcessed(0),
-  m_iStatSlot(0)
+  m_iStatSlot(0),
+  m_pScheduler(NULL),
+  m_iScheduleState(ScheduleIdle),
+  m_RetryInterval(SCHEDULER_RETRY_MIN),
+  m_TimerDeadline(0),
+  m_bAwaitingOutput(false)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -771,9 +1026,10 @@ PipelineConnector::~PipelineConnector()
     Stop();
 }
 //-------------------------------------------------------------------------------------------------
-void PipelineConnector::Start()
+void PipelineConnector::Start(PipelineScheduler* pScheduler)
 {
     m_bStop = false;
+    m_pScheduler = IsScheduled() ? pScheduler : NULL;
 
     for(amf_size i  =0; i < m_InputSlots.size(); i++)
     {
@@ -788,17 +1044,26 @@ void PipelineConnector::Start()
     {
         OutputSlotPtr pSlot = m_OutputSlots[i];
 
-        if(pSlot->m_eThreading == CT_ThreadQueue || m_pElement->GetInputSlotCount() == 0 )
+        if(pSlot->m_eThreading == CT_ThreadQueue || (pSlot->m_eThreading != CT_Scheduled && m_pElement->GetInputSlotCount() == 0))
         {
             pSlot->Start();
         }
     }
 
+    if(m_pScheduler != NULL)
+    {
+        m_pElement->SetOutputNotify(this);
+        Schedule();
+    }
 }
 //-------------------------------------------------------------------------------------------------
 void PipelineConnector::Stop()
 {
     m_bStop = true; // must be atomic but will work
+    if(m_pScheduler != NULL)
+    {
+        m_pElement->SetOutputNotify(NULL);
+    }
 
     for(amf_size i  =0; i < m_InputSlots.size(); i++)
     {
@@ -848,6 +1113,8 @@ void PipelineConnector::Restart()
         m_OutputSlots[i]->Restart();
     }
     m_iSubmitFramesProcessed = 0;
+    m_bAwaitingOutput = false;
+    Schedule();
 }
 //-------------------------------------------------------------------------------------------------
 // a-sync operations from threads
@@ -912,7 +1179,9 @@ AMF_RESULT PipelineConnector::UnFreeze()
     {
         m_InputSlots[i]->UnFreeze();
     }
-    return m_pElement->UnFreeze();
+    AMF_RESULT res = m_pElement->UnFreeze();
+    Schedule();
+    return res;
 }
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT PipelineConnector::Flush()
@@ -928,6 +1197,237 @@ AMF_RESULT PipelineConnector::Flush()
     return m_pElement->Flush();
 }
 //-------------------------------------------------------------------------------------------------
+// CT_Scheduled
+//-------------------------------------------------------------------------------------------------
+bool PipelineConnector::IsScheduled() const
+{
+    for(amf_size i = 0; i < m_InputSlots.size(); i++)
+    {
+        if(m_InputSlots[i]->m_eThreading == CT_Scheduled)
+        {
+            return true;
+        }
+    }
+    for(amf_size i = 0; i < m_OutputSlots.size(); i++)
+    {
+        if(m_OutputSlots[i]->m_eThreading == CT_Scheduled)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::Schedule()
+{
+    if(m_pScheduler == NULL || m_bStop)
+    {
+        return;
+    }
+    amf_int32 state = m_iScheduleState.load(std::memory_order_acquire);
+    for(;;)
+    {
+        if(state == ScheduleIdle)
+        {
+            if(m_iScheduleState.compare_exchange_weak(state, ScheduleQueued, std::memory_order_acq_rel))
+            {
+                m_pScheduler->Submit(this);
+                return;
+            }
+        }
+        else if(state == ScheduleRunning)
+        {
+            if(m_iScheduleState.compare_exchange_weak(state, ScheduleRunningAgain, std::memory_order_acq_rel))
+            {
+                return;
+            }
+        }
+        else
+        {
+            return; // the queued or running step will see the change
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_CDECL_CALL PipelineConnector::ScheduledProc(void* pContext, amf_int64 /*iBegin*/, amf_int64 /*iEnd*/)
+{
+    PipelineConnector* pThis = static_cast<PipelineConnector*>(pContext);
+    pThis->m_iScheduleState.store(ScheduleRunning, std::memory_order_release);
+    pThis->RunScheduled();
+
+    amf_int32 state = ScheduleRunning;
+    if(!pThis->m_iScheduleState.compare_exchange_strong(state, ScheduleIdle, std::memory_order_acq_rel))
+    {
+        // requeue instead of looping so other ready elements get a worker too
+        pThis->m_iScheduleState.store(pThis->m_bStop ? ScheduleIdle : ScheduleQueued, std::memory_order_release);
+        if(!pThis->m_bStop)
+        {
+            pThis->m_pScheduler->Submit(pThis);
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineConnector::RunScheduled()
+{
+    bool bProgress = false;
+    bool bIdle = false;     // a slot found no output in the component
+    bool bBlocked = false;  // the component did not take input
+    for(;;)
+    {
+        bool bMoved = false;
+        bIdle = false;
+        bBlocked = false;
+        // output first: it frees the component for the input that follows
+        for(amf_size i = 0; i < m_OutputSlots.size(); i++)
+        {
+            if(m_OutputSlots[i]->m_eThreading == CT_Scheduled && m_OutputSlots[i]->PollScheduled(bIdle))
+            {
+                bMoved = true;
+            }
+        }
+        for(amf_size i = 0; i < m_InputSlots.size(); i++)
+        {
+            if(m_InputSlots[i]->m_eThreading == CT_Scheduled && m_InputSlots[i]->SubmitScheduled(bBlocked))
+            {
+                bMoved = true;
+            }
+        }
+        // CT_Direct outputs are pushed downstream right here
+        if(PollAll() == AMF_REPEAT)
+        {
+            bIdle = true;
+        }
+        if(!bMoved || StopRequested())
+        {
+            break;
+        }
+        bProgress = true;
+    }
+    if(StopRequested())
+    {
+        return;
+    }
+
+    bool bOutputEof = true;
+    for(amf_size i = 0; i < m_OutputSlots.size(); i++)
+    {
+        if(!m_OutputSlots[i]->IsEof())
+        {
+            bOutputEof = false;
+        }
+    }
+    if(bOutputEof)
+    {
+        m_bAwaitingOutput = false;
+    }
+
+    // nothing else wakes up a component that finishes work on its own,
+    // slot threads feeding this element count as a source
+    bool bSource = true;
+    for(amf_size i = 0; i < m_InputSlots.size(); i++)
+    {
+        if(m_InputSlots[i]->m_eThreading == CT_Scheduled)
+        {
+            bSource = false;
+        }
+    }
+    const bool bPollOutput = bIdle && !m_pElement->SupportsOutputNotify() && (bSource || m_bAwaitingOutput);
+    if(bBlocked || bPollOutput)
+    {
+        m_RetryInterval = bProgress ? SCHEDULER_RETRY_MIN : AMF_MIN(m_RetryInterval * 2, SCHEDULER_RETRY_MAX);
+        m_pScheduler->ScheduleAt(this, amf_high_precision_clock() + m_RetryInterval);
+    }
+    else
+    {
+        m_RetryInterval = SCHEDULER_RETRY_MIN;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+// class PipelineScheduler
+//-------------------------------------------------------------------------------------------------
+PipelineScheduler::PipelineScheduler(amf_int32 iThreads) :
+    m_Pool(iThreads),
+    m_Steps(&m_Pool)
+{
+}
+//-------------------------------------------------------------------------------------------------
+PipelineScheduler::~PipelineScheduler()
+{
+    Shutdown();
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineScheduler::Submit(PipelineConnector* pConnector)
+{
+    m_Steps.Run(&PipelineConnector::ScheduledProc, pConnector, 0, 0);
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineScheduler::ScheduleAt(PipelineConnector* pConnector, amf_pts deadline)
+{
+    amf::AMFLock lock(&m_sync);
+    if(pConnector->m_TimerDeadline != 0)
+    {
+        if(pConnector->m_TimerDeadline <= deadline)
+        {
+            return;
+        }
+        m_Timers.erase(std::make_pair(pConnector->m_TimerDeadline, pConnector));
+    }
+    pConnector->m_TimerDeadline = deadline;
+    m_Timers.insert(std::make_pair(deadline, pConnector));
+    if(m_Timers.begin()->second == pConnector)
+    {
+        m_waiter.Cancel(); // new earliest deadline
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineScheduler::Shutdown()
+{
+    RequestStop();
+    m_waiter.Cancel();
+    WaitForStop();
+    m_Steps.Wait();
+
+    amf::AMFLock lock(&m_sync);
+    for(TimerSet::iterator it = m_Timers.begin(); it != m_Timers.end(); it++)
+    {
+        it->second->m_TimerDeadline = 0;
+    }
+    m_Timers.clear();
+}
+//-------------------------------------------------------------------------------------------------
+void PipelineScheduler::Run()
+{
+    std::vector<PipelineConnector*> due;
+    while(!StopRequested())
+    {
+        amf_pts deadline = amf_high_precision_clock() + AMF_SECOND;
+        {
+            amf::AMFLock lock(&m_sync);
+            const amf_pts now = amf_high_precision_clock();
+            while(!m_Timers.empty() && m_Timers.begin()->first <= now)
+            {
+                due.push_back(m_Timers.begin()->second);
+                m_Timers.begin()->second->m_TimerDeadline = 0;
+                m_Timers.erase(m_Timers.begin());
+            }
+            if(!m_Timers.empty())
+            {
+                deadline = m_Timers.begin()->first;
+            }
+        }
+        if(due.empty())
+        {
+            m_waiter.WaitUntil(deadline);
+            continue;
+        }
+        for(amf_size i = 0; i < due.size(); i++)
+        {
+            due[i]->Schedule();
+        }
+        due.clear();
+    }
+}
+//-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
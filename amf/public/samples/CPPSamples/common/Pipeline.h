@@ -47,9 +47,11 @@ enum ConnectionThreading
     CT_ThreadQueue,
     CT_ThreadPoll,
     CT_Direct,
+    CT_Scheduled,   // no slot threads: the element runs on the pipeline worker pool when data, queue space or output arrives
 };
 
 class PipelineConnector;
+class PipelineScheduler;
 class Pipeline
 {
     friend class PipelineConnector;
@@ -62,6 +64,9 @@ public:
     AMF_RESULT Connect(PipelineElementPtr pElement, amf_int32 slot, PipelineElementPtr upstreamElement, amf_int32 upstreamSlot, amf_int32 queueSize, ConnectionThreading eThreading = CT_ThreadQueue);
     AMF_RESULT SetStatSlot(PipelineElementPtr pElement, amf_int32 slot);
     PipelineElementPtr GetLastElement();
+    // CT_Scheduled workers, 0 - one per scheduled element. Fewer workers can stall elements that also use CT_Direct.
+    // Takes effect on the first Start()
+    AMF_RESULT SetSchedulerThreads(amf_int32 iThreads);
 
     virtual AMF_RESULT      Start();
     virtual AMF_RESULT      Stop();
@@ -87,5 +92,7 @@ protected:
     typedef std::vector<PipelineConnectorPtr> ConnectorList;
     ConnectorList                       m_connectors;
     PipelineState                       m_state;
+    PipelineScheduler*                  m_pScheduler;
+    amf_int32                           m_iSchedulerThreads;
     mutable amf::AMFCriticalSection     m_cs;
 };
\ No newline at end of file
@@ -42,6 +42,15 @@
 
 class Pipeline;
 //-------------------------------------------------------------------------------------------------
+// receives output readiness from elements connected with CT_Scheduled
+class PipelineElementNotify
+{
+public:
+    virtual void OnOutputReady() = 0;
+protected:
+    virtual ~PipelineElementNotify(){}
+};
+//-------------------------------------------------------------------------------------------------
 class PipelineElement
 {
 public:
@@ -64,12 +73,30 @@ public:
     virtual AMF_RESULT OnEof() { return AMF_EOF; }
     virtual std::wstring       GetDisplayResult() { return std::wstring(); }
 
+    // elements that learn about new output on their own (component callbacks, worker threads) return true
+    // and call NotifyOutputReady(), the scheduler then stops polling them on a timer.
+    // Others are polled again 50 us after an empty QueryOutput, backing off to 1 ms while nothing moves:
+    // with CT_Scheduled an idle source, or an element that took input and has no output yet, still
+    // wakes a scheduler worker every 1 ms until it produces output or reaches EOF
+    virtual bool SupportsOutputNotify() const { return false; }
+    void SetOutputNotify(PipelineElementNotify* pNotify) { m_pOutputNotify = pNotify; }
+
     virtual ~PipelineElement(){}
 protected:
-    PipelineElement() : m_host(0), m_bFrozen(false){}
+    PipelineElement() : m_host(0), m_bFrozen(false), m_pOutputNotify(NULL){}
+
+    void NotifyOutputReady()
+    {
+        PipelineElementNotify* pNotify = m_pOutputNotify;
+        if(pNotify != NULL)
+        {
+            pNotify->OnOutputReady();
+        }
+    }
 
     Pipeline* m_host;
     bool    m_bFrozen;
+    std::atomic<PipelineElementNotify*> m_pOutputNotify;
     mutable amf::AMFCriticalSection m_cs;
 };
 //-------------------------------------------------------------------------------------------------
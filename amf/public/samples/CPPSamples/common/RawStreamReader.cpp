@@ -134,33 +134,64 @@ static void PlaneCopy(const amf_uint8 *src, amf_int32 srcStride, amf_int32 srcHe
     }
 }
 
-static void NV12PicCopy(const amf_uint8 *src, amf_int32 srcStride, amf_int32 srcHeight, amf_uint8 *dst, amf_int32 dstStride, amf_int32 dstHeight)
+// plane layout of a frame in the file (src) and in the surface (dst)
+struct PlaneLayout
 {
-    // Y- plane
-    PlaneCopy(src, srcStride, srcHeight, dst, dstStride, dstHeight); 
-    // UV - plane
-    amf_int32 srcYSize = srcHeight * srcStride;
-    amf_int32 dstYSize = dstHeight * dstStride;
-    PlaneCopy(src + srcYSize, srcStride, srcHeight / 2, dst + dstYSize, dstStride, dstHeight / 2); 
-}
-
-static void YUV420PicCopy(const amf_uint8 *src, amf_int32 srcStride, amf_int32 srcHeight, amf_uint8 *dst, amf_int32 dstStride, amf_int32 dstHeight)
+    amf_int32 srcOffset;
+    amf_int32 srcStride;
+    amf_int32 srcHeight;
+    amf_int32 dstOffset;
+    amf_int32 dstStride;
+    amf_int32 dstHeight;
+};
+
+static int PicGetPlanes(amf::AMF_SURFACE_FORMAT format, amf_int32 srcStride, amf_int32 srcHeight, amf_int32 dstStride, amf_int32 dstHeight, PlaneLayout planes[3])
 {
-    // Y- plane
-    PlaneCopy(src, srcStride, srcHeight, dst, dstStride, dstHeight); 
-    // U - plane
-    amf_int32 srcYSize = srcHeight * srcStride;
-    amf_int32 dstYSize = dstHeight * dstStride;
-
-    PlaneCopy(src + srcYSize, srcStride / 2, srcHeight / 2, dst + dstYSize, dstStride / 2, dstHeight / 2); 
-
-    amf_int32 srcUSize = srcHeight/2 * srcStride/2;
-    amf_int32 dstUSize = dstHeight/2 * dstStride/2;
-
-    PlaneCopy(src + srcYSize + srcUSize, srcStride / 2, srcHeight / 2, dst + dstYSize + dstUSize, dstStride / 2, dstHeight / 2); 
+    const amf_int32 srcYSize = srcHeight * srcStride;
+    const amf_int32 dstYSize = dstHeight * dstStride;
+    switch(format)
+    {
+    case amf::AMF_SURFACE_YUY2:
+    case amf::AMF_SURFACE_UYVY:
+    case amf::AMF_SURFACE_BGRA:
+    case amf::AMF_SURFACE_RGBA:
+    case amf::AMF_SURFACE_RGBA_F16:
+    case amf::AMF_SURFACE_R10G10B10A2:
+        {
+            const PlaneLayout packed = { 0, srcStride, srcHeight, 0, dstStride, dstHeight };
+            planes[0] = packed;
+        }
+        return 1;
+    case amf::AMF_SURFACE_YUV420P:
+        {
+            // Y, U, V
+            const amf_int32 srcUSize = srcHeight/2 * srcStride/2;
+            const amf_int32 dstUSize = dstHeight/2 * dstStride/2;
+            const PlaneLayout y = { 0, srcStride, srcHeight, 0, dstStride, dstHeight };
+            const PlaneLayout u = { srcYSize, srcStride / 2, srcHeight / 2, dstYSize, dstStride / 2, dstHeight / 2 };
+            const PlaneLayout v = { srcYSize + srcUSize, srcStride / 2, srcHeight / 2, dstYSize + dstUSize, dstStride / 2, dstHeight / 2 };
+            planes[0] = y;
+            planes[1] = u;
+            planes[2] = v;
+        }
+        return 3;
+    case amf::AMF_SURFACE_NV12:
+    case amf::AMF_SURFACE_P010:
+    case amf::AMF_SURFACE_P012:
+    case amf::AMF_SURFACE_P016:
+        {
+            // Y, UV
+            const PlaneLayout y = { 0, srcStride, srcHeight, 0, dstStride, dstHeight };
+            const PlaneLayout uv = { srcYSize, srcStride, srcHeight / 2, dstYSize, dstStride, dstHeight / 2 };
+            planes[0] = y;
+            planes[1] = uv;
+        }
+        return 2;
+    default:
+        return 0;
+    }
 }
 
-
 RawStreamReader::RawStreamReader()
     :m_pDataStream(),
     m_format(amf::AMF_SURFACE_UNKNOWN),
@@ -170,7 +201,11 @@ RawStreamReader::RawStreamReader()
     m_stride(0), 
     m_framesCount(0),
     m_framesCountRead(0),
-    m_frame()
+    m_frame(),
+    m_pPool(NULL),
+    m_pPrefetch(NULL),
+    m_prefetchResult(AMF_OK),
+    m_bPrefetchPending(false)
 {
 }
 
@@ -297,12 +332,25 @@ AMF_RESULT RawStreamReader::Init(ParametersStorage* pParams, amf::AMFContext* pC
         return AMF_FAIL;
     }
 
-    amf::AMFDataStream::OpenDataStream(path.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pDataStream);
+    // plain paths are mapped: frames are copied from the mapping straight into the surface.
+    // Pipes and files that cannot be mapped are read by the same stream
+    const std::wstring url = path.find(L"://") == std::wstring::npos ? L"mmap://" + path : path;
+    amf::AMFDataStream::OpenDataStream(url.c_str(), amf::AMFSO_READ, amf::AMFFS_SHARE_READ, &m_pDataStream);
     if (!m_pDataStream)
     {
         LOG_ERROR("Cannot open input file: " << path.c_str() );
         return AMF_FAIL;
     }
+    m_pDataView = amf::AMFDataStreamViewPtr(m_pDataStream);
+    if (m_pDataView != NULL)
+    {
+        const void* pView = NULL;
+        amf_size viewSize = 0;
+        if (m_pDataView->GetView(0, 1, &pView, &viewSize) != AMF_OK)
+        {
+            m_pDataView = NULL;
+        }
+    }
 
     if( !PicGetStride(m_format, m_width, m_stride) )
     {
@@ -315,7 +363,7 @@ AMF_RESULT RawStreamReader::Init(ParametersStorage* pParams, amf::AMFContext* pC
         LOG_ERROR("Wrong format:" << m_format);
         return AMF_FAIL;
     }
-    m_frame.SetSize(frameSize);
+    m_frame.SetSize(0); // allocated by the first frame that needs it
 
     if (!m_stride || !frameSize)
     {
@@ -329,12 +377,27 @@ AMF_RESULT RawStreamReader::Init(ParametersStorage* pParams, amf::AMFContext* pC
     {
         m_framesCount = AMF_MIN(frames, m_framesCount);
     }
+
+    if (m_pPool == NULL)
+    {
+        m_pPool = amf::AMFThreadPool::AcquireShared();
+        m_pPrefetch = new amf::AMFTaskGroup(m_pPool);
+    }
     return AMF_OK;
 }
 
 AMF_RESULT RawStreamReader::Terminate()
 {
     AMF_RESULT res = AMF_OK;
+    CancelPrefetch();
+    if (m_pPool != NULL)
+    {
+        delete m_pPrefetch;
+        m_pPrefetch = NULL;
+        amf::AMFThreadPool::ReleaseShared();
+        m_pPool = NULL;
+    }
+    m_pDataView = NULL;
     m_pDataStream = NULL;
     m_pContext = NULL;
     return res;
@@ -348,25 +411,29 @@ AMF_RESULT RawStreamReader::SubmitInput(amf::AMFData* /* pData */)
 AMF_RESULT RawStreamReader::QueryOutput(amf::AMFData** ppData)
 {
     AMF_RESULT res = AMF_OK;
-    amf::AMFSurfacePtr pSurface;
-
-    res = m_pContext->AllocSurface(amf::AMF_MEMORY_HOST, m_format, m_width , m_height, &pSurface);
-    CHECK_AMF_ERROR_RETURN(res, L"AMFContext::AllocSurface(amf::AMF_MEMORY_HOST) failed");
-    pSurface->SetCrop(m_roi_x, m_roi_y, m_roi_width, m_roi_height);
+    if (!m_bPrefetchPending)
+    {
+        res = StartPrefetch();
+        CHECK_AMF_ERROR_RETURN(res, L"AMFContext::AllocSurface(amf::AMF_MEMORY_HOST) failed");
+    }
+    m_pPrefetch->Wait();
+    m_bPrefetchPending = false;
 
-    amf::AMFPlanePtr plane = pSurface->GetPlaneAt(0);
-    res = ReadNextFrame(plane->GetHPitch(), m_height, plane->GetVPitch(), static_cast<unsigned char*>(plane->GetNative()));
+    amf::AMFSurfacePtr pSurface = m_pPrefetchSurface;
+    m_pPrefetchSurface = NULL;
+    res = m_prefetchResult;
     if(res == AMF_EOF)
     {
         return res;
     }
     CHECK_AMF_ERROR_RETURN(res, L"ReadNextFrame() failed");
 
-    // RawStreamReader doesn't have a frame rate, so let's
-    // assume the frame rate is 30 fps, and then set pts and duration
-    amf_pts frameDuration = amf_pts(AMF_SECOND / 30.0); // In 100 NanoSeconds
-    pSurface->SetPts((m_framesCountRead - 1) * frameDuration);
-    pSurface->SetDuration(frameDuration);
+    // the next frame loads while this one is encoded
+    if (m_framesCountRead < m_framesCount)
+    {
+        res = StartPrefetch();
+        CHECK_AMF_ERROR_RETURN(res, L"AMFContext::AllocSurface(amf::AMF_MEMORY_HOST) failed");
+    }
 
     *ppData = pSurface.Detach();
 
@@ -392,6 +459,53 @@ AMF_RESULT RawStreamReader::QueryOutput(amf::AMFData** ppData)
     return AMF_OK;
 }
 
+AMF_RESULT RawStreamReader::ReadNextSurface(amf::AMFSurface* pSurface)
+{
+    amf::AMFPlanePtr plane = pSurface->GetPlaneAt(0);
+    AMF_RESULT res = ReadNextFrame(plane->GetHPitch(), m_height, plane->GetVPitch(), static_cast<unsigned char*>(plane->GetNative()));
+    if (res != AMF_OK)
+    {
+        return res;
+    }
+
+    // RawStreamReader doesn't have a frame rate, so let's
+    // assume the frame rate is 30 fps, and then set pts and duration
+    amf_pts frameDuration = amf_pts(AMF_SECOND / 30.0); // In 100 NanoSeconds
+    pSurface->SetPts((m_framesCountRead - 1) * frameDuration);
+    pSurface->SetDuration(frameDuration);
+    return AMF_OK;
+}
+
+AMF_RESULT RawStreamReader::StartPrefetch()
+{
+    AMF_RESULT res = m_pContext->AllocSurface(amf::AMF_MEMORY_HOST, m_format, m_width , m_height, &m_pPrefetchSurface);
+    if (res != AMF_OK)
+    {
+        return res;
+    }
+    m_pPrefetchSurface->SetCrop(m_roi_x, m_roi_y, m_roi_width, m_roi_height);
+    m_prefetchResult = AMF_OK;
+    m_bPrefetchPending = true;
+    m_pPrefetch->Run(&RawStreamReader::PrefetchProc, this, 0, 1);
+    return AMF_OK;
+}
+
+void RawStreamReader::CancelPrefetch()
+{
+    if (m_bPrefetchPending)
+    {
+        m_pPrefetch->Wait();
+        m_bPrefetchPending = false;
+    }
+    m_pPrefetchSurface = NULL;
+}
+
+void AMF_CDECL_CALL RawStreamReader::PrefetchProc(void* pContext, amf_int64 /* iBegin */, amf_int64 /* iEnd */)
+{
+    RawStreamReader* pThis = static_cast<RawStreamReader*>(pContext);
+    pThis->m_prefetchResult = pThis->ReadNextSurface(pThis->m_pPrefetchSurface);
+}
+
 AMF_RESULT RawStreamReader::ReadNextFrame(int dstStride, int /* dstHeight */, int valignment, unsigned char* pDstBits)
 {
     if(m_framesCountRead == m_framesCount)
@@ -399,38 +513,72 @@ AMF_RESULT RawStreamReader::ReadNextFrame(int dstStride, int /* dstHeight */, in
         return AMF_EOF;
     }
 
+    PlaneLayout planes[3];
+    const int planeCount = PicGetPlanes(m_format, m_stride, m_height, dstStride, valignment, planes);
+    if (planeCount == 0)
+    {
+        LOG_ERROR("Format reading is not supported");
+        return AMF_FAIL;
+    }
+    int frameSize = 0;
+    PicGetFrameSize(m_format, m_width, m_height, frameSize);
+
+    const amf_uint8* pSrc = NULL;
+    if (m_pDataView != NULL)
     {
+        // copy from the mapping, PlaneCopy falls back to rows only for pitched surfaces
+        amf_int64 position = 0;
+        m_pDataStream->GetPosition(&position);
+        const void* pView = NULL;
+        amf_size viewSize = 0;
+        if (m_pDataView->GetView(position, frameSize, &pView, &viewSize) != AMF_OK || viewSize != amf_size(frameSize))
+        {
+            return AMF_EOF;
+        }
+        m_pDataStream->Seek(amf::AMF_SEEK_CURRENT, frameSize, NULL);
+        pSrc = static_cast<const amf_uint8*>(pView);
+    }
+    else
+    {
+        // planes with the file stride are read in place, one read per plane
+        bool bInPlace = true;
+        amf_int32 planesSize = 0;
+        for (int i = 0; i < planeCount; i++)
+        {
+            bInPlace = bInPlace && planes[i].srcStride == planes[i].dstStride && planes[i].srcHeight <= planes[i].dstHeight && planes[i].srcOffset == planesSize;
+            planesSize += planes[i].srcStride * planes[i].srcHeight;
+        }
+        bInPlace = bInPlace && planesSize == frameSize;
+        if (bInPlace)
+        {
+            for (int i = 0; i < planeCount; i++)
+            {
+                const amf_size planeSize = amf_size(planes[i].srcStride) * planes[i].srcHeight;
+                amf_size read = 0;
+                m_pDataStream->Read(pDstBits + planes[i].dstOffset, planeSize, &read);
+                if (read != planeSize)
+                {
+                    return AMF_EOF;
+                }
+            }
+            m_framesCountRead++;
+            return AMF_OK;
+        }
+
+        m_frame.SetSize(frameSize);
         amf_size read = 0;
         m_pDataStream->Read(m_frame.GetData(), m_frame.GetSize(), &read);
         if (read != m_frame.GetSize())
         {
             return AMF_EOF;
         }
-        m_framesCountRead++;
+        pSrc = m_frame.GetData();
     }
+    m_framesCountRead++;
 
-    switch(m_format)
+    for (int i = 0; i < planeCount; i++)
     {
-    case amf::AMF_SURFACE_YUY2:
-    case amf::AMF_SURFACE_UYVY:
-    case amf::AMF_SURFACE_BGRA:
-    case amf::AMF_SURFACE_RGBA:
-    case amf::AMF_SURFACE_RGBA_F16:
-    case amf::AMF_SURFACE_R10G10B10A2:
-        PlaneCopy(m_frame.GetData(), m_stride, m_height, pDstBits, dstStride, valignment);
-        break;
-    case amf::AMF_SURFACE_YUV420P:
-        YUV420PicCopy(m_frame.GetData(), m_stride, m_height, pDstBits, dstStride, valignment);
-        break;
-    case amf::AMF_SURFACE_NV12:
-    case amf::AMF_SURFACE_P010:
-    case amf::AMF_SURFACE_P012:
-    case amf::AMF_SURFACE_P016:
-        NV12PicCopy(m_frame.GetData(), m_stride, m_height, pDstBits, dstStride, valignment);
-        break;
-    default:
-        LOG_ERROR("Format reading is not supported");
-        return AMF_FAIL;
+        PlaneCopy(pSrc + planes[i].srcOffset, planes[i].srcStride, planes[i].srcHeight, pDstBits + planes[i].dstOffset, planes[i].dstStride, planes[i].dstHeight);
     }
     return AMF_OK;
 }
@@ -547,6 +695,7 @@ void RawStreamReader::ParseRawFileFormat(const std::wstring path, amf_int32 &wid
 
 void RawStreamReader::RestartReader()
 {
+    CancelPrefetch();
     m_pDataStream->Seek(amf::AMF_SEEK_BEGIN, 0, NULL);
     m_framesCountRead = 0;
 }
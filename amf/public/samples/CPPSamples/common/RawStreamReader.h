@@ -66,10 +66,15 @@ private:
 
     virtual AMF_RESULT Terminate();
     AMF_RESULT ReadNextFrame(int dstStride, int dstHeight, int valignment, unsigned char* pDstBits);
+    AMF_RESULT ReadNextSurface(amf::AMFSurface* pSurface);
+    AMF_RESULT StartPrefetch();
+    void       CancelPrefetch();
+    static void AMF_CDECL_CALL PrefetchProc(void* pContext, amf_int64 iBegin, amf_int64 iEnd);
 	AMF_RESULT ReadNextSearchCenterMap(int dstStride, int dstHeight, int valignment, unsigned char* pDstBits);
 
     amf::AMFContextPtr      m_pContext;
     amf::AMFDataStreamPtr   m_pDataStream;
+    amf::AMFDataStreamViewPtr m_pDataView;          // input is mapped, frames are copied from the mapping
     
     amf::AMF_SURFACE_FORMAT m_format;
     amf::AMF_MEMORY_TYPE    m_memoryType;
@@ -86,7 +91,14 @@ private:
     amf_int64               m_framesCount;
     amf_int64               m_framesCountRead;
 
-    AMFByteArray            m_frame;
+    AMFByteArray            m_frame;                // only used when the planes cannot be read in place
+
+    // the next frame is read on the shared thread pool while the current one is processed
+    amf::AMFThreadPool*     m_pPool;
+    amf::AMFTaskGroup*      m_pPrefetch;
+    amf::AMFSurfacePtr      m_pPrefetchSurface;
+    AMF_RESULT              m_prefetchResult;
+    bool                    m_bPrefetchPending;
 
 	amf::AMFDataStreamPtr   m_pSearchCenterMapStream;   
 	amf::AMF_SURFACE_FORMAT m_searchCenterMapformat;    
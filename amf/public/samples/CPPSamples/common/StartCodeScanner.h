@@ -0,0 +1,224 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+// Annex B start code (00 00 01) and emulation prevention (00 00 03) search shared by the
+// bitstream parsers. The scalar loops are the reference, SSE2 checks 16 bytes per step and
+// AVX2 64 bytes per step when the CPU has it.
+
+#include "public/include/core/Platform.h"
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define START_CODE_SCANNER_SIMD
+#   include <emmintrin.h>
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#       define START_CODE_SCANNER_AVX2
+#   elif defined(__GNUC__)
+#       define START_CODE_SCANNER_AVX2 __attribute__((target("avx2")))
+#   endif
+#endif
+
+namespace StartCodeScanner
+{
+    //-------------------------------------------------------------------------------------------------
+    // offset of the first 00 00 <last> in data or size
+    inline size_t FindScalar(const amf_uint8* data, size_t size, amf_uint8 last)
+    {
+        size_t i = 0;
+        while (i + 2 < size)
+        {
+            // a byte at i + 2 that is neither 0 nor <last> rules out a match at i, i + 1 and i + 2
+            if (data[i + 2] != 0 && data[i + 2] != last)
+            {
+                i += 3;
+            }
+            else if (data[i + 1] != 0)
+            {
+                i += 2;
+            }
+            else if (data[i] != 0 || data[i + 2] != last)
+            {
+                i++;
+            }
+            else
+            {
+                return i;
+            }
+        }
+        return size;
+    }
+
+#if defined(START_CODE_SCANNER_SIMD)
+    //-------------------------------------------------------------------------------------------------
+    inline amf_uint32 LowestBit(amf_uint64 mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+#   if defined(_M_X64)
+        _BitScanForward64(&index, mask);
+#   else
+        if (_BitScanForward(&index, (unsigned long)mask) == 0)
+        {
+            _BitScanForward(&index, (unsigned long)(mask >> 32));
+            index += 32;
+        }
+#   endif
+        return (amf_uint32)index;
+#else
+        return (amf_uint32)__builtin_ctzll(mask);
+#endif
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline size_t FindSSE2(const amf_uint8* data, size_t size, amf_uint8 last)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i third = _mm_set1_epi8((char)last);
+        size_t i = 0;
+        // the three loads look 2 bytes ahead of the step
+        for (; i + 18 <= size; i += 16)
+        {
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+            const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+            const __m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)), _mm_cmpeq_epi8(b2, third));
+            const int mask = _mm_movemask_epi8(match);
+            if (mask != 0)
+            {
+                return i + LowestBit((amf_uint32)mask);
+            }
+        }
+        return i + FindScalar(data + i, size - i, last);
+    }
+    //-------------------------------------------------------------------------------------------------
+    START_CODE_SCANNER_AVX2 inline amf_uint32 MatchAVX2(const amf_uint8* data, __m256i zero, __m256i third)
+    {
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 1));
+        const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 2));
+        const __m256i match = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)), _mm256_cmpeq_epi8(b2, third));
+        return (amf_uint32)_mm256_movemask_epi8(match);
+    }
+    //-------------------------------------------------------------------------------------------------
+    START_CODE_SCANNER_AVX2 inline size_t FindAVX2(const amf_uint8* data, size_t size, amf_uint8 last)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i third = _mm256_set1_epi8((char)last);
+        size_t i = 0;
+        for (; i + 66 <= size; i += 64)
+        {
+            const amf_uint64 mask = (amf_uint64)MatchAVX2(data + i, zero, third) | ((amf_uint64)MatchAVX2(data + i + 32, zero, third) << 32);
+            if (mask != 0)
+            {
+                return i + LowestBit(mask);
+            }
+        }
+        return i + FindSSE2(data + i, size - i, last);
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline bool HasAVX2()
+    {
+#if defined(_MSC_VER)
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (osxsave == false || avx == false || (_xgetbv(0) & 0x6) != 0x6)
+        {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif // START_CODE_SCANNER_SIMD
+
+    //-------------------------------------------------------------------------------------------------
+    inline size_t Find(const amf_uint8* data, size_t size, amf_uint8 last)
+    {
+#if defined(START_CODE_SCANNER_SIMD)
+        static const bool bAVX2 = HasAVX2();
+        return bAVX2 ? FindAVX2(data, size, last) : FindSSE2(data, size, last);
+#else
+        return FindScalar(data, size, last);
+#endif
+    }
+    //-------------------------------------------------------------------------------------------------
+    // offset of the first 00 00 01 in data or size
+    inline size_t FindStartCode(const amf_uint8* data, size_t size)
+    {
+        return Find(data, size, 0x01);
+    }
+    //-------------------------------------------------------------------------------------------------
+    // offset of the first 00 00 03 in data or size
+    inline size_t FindEmulationPrevention(const amf_uint8* data, size_t size)
+    {
+        return Find(data, size, 0x03);
+    }
+    //-------------------------------------------------------------------------------------------------
+    // EBSP to RBSP in place: drops every emulation_prevention_three_byte, including the final
+    // 0x03 after a cabac_zero_word. Returns the RBSP size or (size_t)-1 if 00 00 03 is followed
+    // by a byte above 0x03.
+    inline size_t RemoveEmulationPrevention(amf_uint8* data, size_t size)
+    {
+        size_t read = 0;
+        size_t write = 0;
+        for (;;)
+        {
+            const size_t found = read + FindEmulationPrevention(data + read, size - read);
+            if (found >= size)
+            {
+                break;
+            }
+            const size_t three = found + 2;
+            if (three + 1 < size && data[three + 1] > 0x03)
+            {
+                return static_cast<size_t>(-1);
+            }
+            memmove(data + write, data + read, three - read);
+            write += three - read;
+            read = three + 1;
+        }
+        memmove(data + write, data + read, size - read);
+        return write + size - read;
+    }
+}
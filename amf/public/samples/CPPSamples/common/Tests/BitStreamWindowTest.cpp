@@ -0,0 +1,389 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "SampleTests.h"
+#include "../BitStreamWindow.h"
+#include "public/common/AMFSTL.h"
+#include "public/common/Thread.h"
+#include <stdio.h>
+
+using namespace amf;
+
+namespace
+{
+    const char*     TEST_FILE       = "amf-bitstreamwindow-test.bin";
+    const wchar_t*  TEST_FILE_URL   = L"file://amf-bitstreamwindow-test.bin";
+    const wchar_t*  TEST_MMAP_URL   = L"mmap://amf-bitstreamwindow-test.bin";
+    const size_t    MB              = 1024 * 1024;
+
+    // content of the test file at a position, every offset is distinguishable
+    amf_uint8 PatternByte(size_t position)
+    {
+        const amf_uint32 x = amf_uint32(position) * 2654435761u;
+        return amf_uint8((x >> 24) ^ (position >> 16));
+    }
+    bool CheckPattern(const amf_uint8* pData, size_t position, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if (pData[i] != PatternByte(position + i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool WriteTestFile(size_t size)
+    {
+        FILE* pFile = fopen(TEST_FILE, "wb");
+        if (pFile == NULL)
+        {
+            return false;
+        }
+        amf_vector<amf_uint8> chunk(MB);
+        bool bOk = true;
+        for (size_t position = 0; position < size && bOk; position += chunk.size())
+        {
+            for (size_t i = 0; i < chunk.size(); i++)
+            {
+                chunk[i] = PatternByte(position + i);
+            }
+            bOk = fwrite(chunk.data(), 1, chunk.size(), pFile) == chunk.size();
+        }
+        fclose(pFile);
+        return bOk;
+    }
+
+    // an access unit handed out while the window moves on
+    struct Slice
+    {
+        const amf_uint8*    pData;
+        size_t              position;
+        size_t              size;
+        AMFBufferObserver*  pObserver;
+    };
+    Slice TakeSlice(BitStreamWindow& window, size_t position, size_t size)
+    {
+        Slice slice = { window.GetData(), position, size, window.AddSliceReference() };
+        return slice;
+    }
+    void ReleaseSlice(Slice& slice)
+    {
+        slice.pObserver->OnBufferDataRelease(NULL);
+        slice.pObserver = NULL;
+    }
+
+    // reads exactly size bytes, the window reads less only at the end of the file
+    bool ReadFully(BitStreamWindow& window, AMFDataStream* pStream, size_t size)
+    {
+        size_t read = 0;
+        return window.Read(pStream, size, &read) == AMF_OK && read == size;
+    }
+
+    // reads 1MB at a time, consuming as much, until the pending data moves to another place;
+    // returns the new location or NULL
+    amf_uint8* AdvanceUntilMove(BitStreamWindow& window, AMFDataStream* pStream, size_t& position)
+    {
+        for (int i = 0; i < 64; i++)
+        {
+            amf_uint8* pExpected = window.GetData();
+            if (ReadFully(window, pStream, 1 * MB) == false)
+            {
+                return NULL;
+            }
+            if (window.GetData() != pExpected)
+            {
+                return window.GetData();
+            }
+            window.Consume(1 * MB);
+            position += 1 * MB;
+        }
+        return NULL;
+    }
+
+    // the tail moves to another block while slices reference the current one, and a block is taken
+    // from the pool only once all of its slices are gone, whatever order they are released in
+    int TestSliceRecycling()
+    {
+        int failures = 0;
+        AMFDataStreamPtr pStream;
+        TEST_CHECK(AMFDataStream::OpenDataStream(TEST_FILE_URL, AMFSO_READ, AMFFS_SHARE_READ, &pStream) == AMF_OK, "open %ls", TEST_FILE_URL);
+        if (pStream == NULL)
+        {
+            return failures;
+        }
+
+        BitStreamWindow window;
+        window.SetZeroCopy(true, pStream);
+        TEST_CHECK(window.IsWritable(), "a file stream is read into blocks");
+
+        // slices A and B reference block 0
+        size_t position = 0;
+        TEST_CHECK(ReadFully(window, pStream, 3 * MB), "read block 0");
+        amf_uint8* pBlock0 = window.GetData();
+        Slice a = TakeSlice(window, position, 1 * MB);
+        window.Consume(1 * MB);
+        position += 1 * MB;
+        Slice b = TakeSlice(window, position, 1 * MB);
+        window.Consume(1 * MB);
+        position += 1 * MB;
+
+        amf_uint8* pBlock1 = AdvanceUntilMove(window, pStream, position);
+        TEST_CHECK(pBlock1 != NULL && pBlock1 != pBlock0, "the tail moves to a new block while block 0 is referenced");
+        TEST_CHECK(CheckPattern(window.GetData(), position, window.GetSize()), "moved tail content");
+        TEST_CHECK(CheckPattern(a.pData, a.position, a.size) && CheckPattern(b.pData, b.position, b.size), "slices of block 0 after the move");
+
+        // out of order: the later slice goes first, A still holds block 0
+        ReleaseSlice(b);
+        Slice c = TakeSlice(window, position, 1 * MB);
+        amf_uint8* pBlock2 = AdvanceUntilMove(window, pStream, position);
+        TEST_CHECK(pBlock2 != NULL && pBlock2 != pBlock0 && pBlock2 != pBlock1, "block 0 (slice A) and block 1 (slice C) are still referenced");
+        TEST_CHECK(CheckPattern(window.GetData(), position, window.GetSize()), "moved tail content");
+        TEST_CHECK(CheckPattern(a.pData, a.position, a.size), "slice A after B was released");
+        TEST_CHECK(CheckPattern(c.pData, c.position, c.size), "slice C after the move");
+
+        // releasing the last slice of block 0 makes it the first free block of the pool
+        ReleaseSlice(a);
+        Slice d = TakeSlice(window, position, 1 * MB);
+        amf_uint8* pBlock3 = AdvanceUntilMove(window, pStream, position);
+        TEST_CHECK(pBlock3 == pBlock0, "block 0 is reused once all its slices are released");
+        TEST_CHECK(CheckPattern(window.GetData(), position, window.GetSize()), "content of the recycled block");
+        TEST_CHECK(CheckPattern(c.pData, c.position, c.size) && CheckPattern(d.pData, d.position, d.size), "outstanding slices after the recycle");
+
+        ReleaseSlice(d);
+        ReleaseSlice(c);
+        return failures;
+    }
+
+    // parser-like pass over the whole file with up to three outstanding slices released out of order,
+    // every slice has to keep its content until released
+    int TestSliceStream(const wchar_t* pUrl, bool bMapped)
+    {
+        int failures = 0;
+        AMFDataStreamPtr pStream;
+        TEST_CHECK(AMFDataStream::OpenDataStream(pUrl, AMFSO_READ, AMFFS_SHARE_READ, &pStream) == AMF_OK, "open %ls", pUrl);
+        if (pStream == NULL)
+        {
+            return failures;
+        }
+        amf_int64 fileSize = 0;
+        pStream->GetSize(&fileSize);
+
+        BitStreamWindow window;
+        window.SetZeroCopy(true, pStream);
+        TEST_CHECK(window.IsWritable() == !bMapped, "%ls: writable %d", pUrl, (int)window.IsWritable());
+
+        amf_list<Slice> slices;
+        size_t position = 0;
+        size_t moves = 0;
+        size_t unit = 0;
+        for (;;)
+        {
+            const amf_uint8* pExpected = window.GetData();
+            size_t read = 0;
+            if (window.Read(pStream, 1 * MB, &read) != AMF_OK || read == 0)
+            {
+                break;
+            }
+            if (pExpected != NULL && window.GetData() != pExpected)
+            {
+                moves++;
+                TEST_CHECK(bMapped == false, "%ls: the mapping never moves", pUrl);
+            }
+            TEST_CHECK(CheckPattern(window.GetData(), position, window.GetSize()), "%ls: window at %d", pUrl, (int)position);
+
+            // access units of varying size
+            for (size_t auSize = 100000 + (unit % 7) * 50000; window.GetSize() >= auSize; auSize = 100000 + (unit % 7) * 50000)
+            {
+                if (unit % 3 == 0)
+                {
+                    slices.push_back(TakeSlice(window, position, auSize));
+                }
+                window.Consume(auSize);
+                position += auSize;
+                unit++;
+            }
+            if (slices.size() > 3)
+            {
+                // second oldest first, then the newest, the oldest stays longest
+                amf_list<Slice>::iterator it = slices.begin();
+                ++it;
+                ReleaseSlice(*it);
+                slices.erase(it);
+                ReleaseSlice(slices.back());
+                slices.pop_back();
+            }
+            for (amf_list<Slice>::iterator it = slices.begin(); it != slices.end(); ++it)
+            {
+                TEST_CHECK(CheckPattern(it->pData, it->position, it->size), "%ls: slice at %d overwritten", pUrl, (int)it->position);
+            }
+        }
+        TEST_CHECK(position + window.GetSize() == (size_t)fileSize, "%ls: read %d of %d bytes", pUrl, (int)(position + window.GetSize()), (int)fileSize);
+        TEST_CHECK(bMapped || moves > 0, "%ls: the tail never moved while slices were outstanding", pUrl);
+
+        // the mapping outlives the stream and the window while slices reference it
+        window.SetZeroCopy(false, NULL);
+        pStream = NULL;
+        for (amf_list<Slice>::iterator it = slices.begin(); it != slices.end(); ++it)
+        {
+            TEST_CHECK(CheckPattern(it->pData, it->position, it->size), "%ls: slice at %d after the stream was released", pUrl, (int)it->position);
+            ReleaseSlice(*it);
+        }
+        return failures;
+    }
+
+    // switching zero copy with data pending keeps the pending bytes
+    int TestZeroCopySwitch()
+    {
+        int failures = 0;
+        AMFDataStreamPtr pStream;
+        TEST_CHECK(AMFDataStream::OpenDataStream(TEST_MMAP_URL, AMFSO_READ, AMFFS_SHARE_READ, &pStream) == AMF_OK, "open %ls", TEST_MMAP_URL);
+        if (pStream == NULL)
+        {
+            return failures;
+        }
+        BitStreamWindow window;
+        TEST_CHECK(ReadFully(window, pStream, 3 * MB), "copy read");
+        window.Consume(1 * MB + 17);
+        size_t position = 1 * MB + 17;
+
+        window.SetZeroCopy(true, pStream);
+        TEST_CHECK(window.IsWritable() == false, "mmap:// is mapped");
+        TEST_CHECK(window.GetSize() == 2 * MB - 17 && CheckPattern(window.GetData(), position, window.GetSize()), "pending data in the mapping");
+        TEST_CHECK(ReadFully(window, pStream, 1 * MB), "mapped read");
+        window.Consume(2 * MB);
+        position += 2 * MB;
+
+        window.SetZeroCopy(false, pStream);
+        TEST_CHECK(window.IsWritable(), "back to blocks");
+        TEST_CHECK(window.GetSize() == 1 * MB - 17 && CheckPattern(window.GetData(), position, window.GetSize()), "pending data copied out of the mapping");
+        TEST_CHECK(ReadFully(window, pStream, 1 * MB), "copy read after the switch");
+        TEST_CHECK(CheckPattern(window.GetData(), position, window.GetSize()), "window after the switch");
+        return failures;
+    }
+
+    // one pass over the file cut into access units of auSize, a copy per access unit like the
+    // copying parser path or a slice reference
+    void ParseFile(const wchar_t* pUrl, bool bZeroCopy, size_t auSize)
+    {
+        AMFDataStreamPtr pStream;
+        AMFDataStream::OpenDataStream(pUrl, AMFSO_READ, AMFFS_SHARE_READ, &pStream);
+        BitStreamWindow window;
+        window.SetZeroCopy(bZeroCopy, pStream);
+
+        amf_list<AMFBufferObserver*> slices;   // a decoder holds a few access units
+        size_t read = 0;
+        while (window.Read(pStream, 1 * MB, &read) == AMF_OK && read > 0)
+        {
+            while (window.GetSize() >= auSize)
+            {
+                if (bZeroCopy)
+                {
+                    slices.push_back(window.AddSliceReference());
+                    if (slices.size() > 4)
+                    {
+                        slices.front()->OnBufferDataRelease(NULL);
+                        slices.pop_front();
+                    }
+                }
+                else
+                {
+                    amf_uint8* pCopy = new amf_uint8[auSize];
+                    memcpy(pCopy, window.GetData(), auSize);
+                    delete[] pCopy;
+                }
+                window.Consume(auSize);
+            }
+        }
+        for (amf_list<AMFBufferObserver*>::iterator it = slices.begin(); it != slices.end(); ++it)
+        {
+            (*it)->OnBufferDataRelease(NULL);
+        }
+    }
+    double MeasureParse(const wchar_t* pUrl, bool bZeroCopy, size_t auSize, size_t fileSize)
+    {
+        static const amf_pts minDuration = AMF_SECOND / 2;
+
+        ParseFile(pUrl, bZeroCopy, auSize);
+
+        int passes = 0;
+        const amf_pts start = amf_high_precision_clock();
+        amf_pts elapsed = 0;
+        do
+        {
+            ParseFile(pUrl, bZeroCopy, auSize);
+            passes++;
+            elapsed = amf_high_precision_clock() - start;
+        } while (elapsed < minDuration);
+
+        return double(fileSize) * passes / MB / (double(elapsed) / AMF_SECOND);
+    }
+}
+
+int TestBitStreamWindow()
+{
+    int failures = 0;
+    TEST_CHECK(WriteTestFile(40 * MB), "cannot write %s", TEST_FILE);
+
+    failures += TestSliceRecycling();
+    failures += TestSliceStream(TEST_FILE_URL, false);
+    failures += TestSliceStream(TEST_MMAP_URL, true);
+    failures += TestZeroCopySwitch();
+
+    remove(TEST_FILE);
+    return failures;
+}
+
+void BenchmarkBitStreamWindow()
+{
+    const size_t fileSize = 256 * MB;
+    if (WriteTestFile(fileSize) == false)
+    {
+        printf("BitStreamWindow benchmark: cannot write %s\n", TEST_FILE);
+        return;
+    }
+
+    // the file is in the page cache after the first pass, the numbers are memory throughput
+    printf("BitStreamWindow benchmark, MB/s per access unit size\n");
+    printf("%-10s %12s %12s %12s\n", "AU size", "file copy", "file slice", "mmap slice");
+    const size_t auSizes[] = { 16 * 1024, 256 * 1024, 2 * MB };
+    for (size_t i = 0; i < sizeof(auSizes) / sizeof(auSizes[0]); i++)
+    {
+        printf("%7dKB %12.0f %12.0f %12.0f\n", (int)(auSizes[i] / 1024),
+            MeasureParse(TEST_FILE_URL, false, auSizes[i], fileSize),
+            MeasureParse(TEST_FILE_URL, true, auSizes[i], fileSize),
+            MeasureParse(TEST_MMAP_URL, true, auSizes[i], fileSize));
+    }
+    remove(TEST_FILE);
+}
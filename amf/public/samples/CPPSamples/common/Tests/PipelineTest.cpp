@@ -0,0 +1,293 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "SampleTests.h"
+#include "../Pipeline.h"
+#include "public/common/InterfaceImpl.h"
+#include "public/common/PropertyStorageImpl.h"
+#include "public/common/Thread.h"
+#include <deque>
+
+using namespace amf;
+
+namespace
+{
+    // host frame carrying its sequence number in the pts
+    class TestFrame : public AMFInterfaceImpl<AMFPropertyStorageImpl<AMFData> >
+    {
+    public:
+        TestFrame(amf_pts pts) : m_pts(pts), m_duration(0) {}
+
+        AMF_BEGIN_INTERFACE_MAP
+            AMF_INTERFACE_ENTRY(AMFData)
+            AMF_INTERFACE_CHAIN_ENTRY(AMFPropertyStorageImpl<AMFData>)
+        AMF_END_INTERFACE_MAP
+
+        virtual AMF_MEMORY_TYPE AMF_STD_CALL GetMemoryType() { return AMF_MEMORY_HOST; }
+        virtual AMF_RESULT      AMF_STD_CALL Duplicate(AMF_MEMORY_TYPE /*type*/, AMFData** /*ppData*/) { return AMF_NOT_SUPPORTED; }
+        virtual AMF_RESULT      AMF_STD_CALL Convert(AMF_MEMORY_TYPE /*type*/) { return AMF_NOT_SUPPORTED; }
+        virtual AMF_RESULT      AMF_STD_CALL Interop(AMF_MEMORY_TYPE /*type*/) { return AMF_NOT_SUPPORTED; }
+        virtual AMF_DATA_TYPE   AMF_STD_CALL GetDataType() { return AMF_DATA_BUFFER; }
+        virtual amf_bool        AMF_STD_CALL IsReusable() { return false; }
+        virtual void            AMF_STD_CALL SetPts(amf_pts pts) { m_pts = pts; }
+        virtual amf_pts         AMF_STD_CALL GetPts() { return m_pts; }
+        virtual void            AMF_STD_CALL SetDuration(amf_pts duration) { m_duration = duration; }
+        virtual amf_pts         AMF_STD_CALL GetDuration() { return m_duration; }
+    private:
+        amf_pts m_pts;
+        amf_pts m_duration;
+    };
+
+    // emits frames 0..count-1 and then EOF, count < 0 - never ends
+    class TestSource : public PipelineElement
+    {
+    public:
+        TestSource(amf_int64 count) : m_iCount(count), m_iNext(0) {}
+
+        virtual amf_int32 GetInputSlotCount() const { return 0; }
+        virtual amf_int32 GetOutputSlotCount() const { return 1; }
+
+        virtual AMF_RESULT QueryOutput(AMFData** ppData)
+        {
+            AMFLock lock(&m_cs);
+            if (m_iCount >= 0 && m_iNext >= m_iCount)
+            {
+                return AMF_EOF;
+            }
+            AMFDataPtr pFrame(new TestFrame(m_iNext++));
+            *ppData = pFrame.Detach();
+            return AMF_OK;
+        }
+    private:
+        amf_int64 m_iCount;
+        amf_int64 m_iNext;
+    };
+
+    // a component with a few frames of internal buffering, like an encoder or a converter
+    class TestStage : public PipelineElement
+    {
+    public:
+        TestStage(size_t capacity) : m_Capacity(capacity), m_bDrain(false) {}
+
+        virtual amf_int32 GetInputSlotCount() const { return 1; }
+        virtual amf_int32 GetOutputSlotCount() const { return 1; }
+
+        virtual AMF_RESULT SubmitInput(AMFData* pData)
+        {
+            AMFLock lock(&m_cs);
+            if (m_Frames.size() >= m_Capacity)
+            {
+                return AMF_INPUT_FULL;
+            }
+            m_Frames.push_back(AMFDataPtr(pData));
+            return AMF_OK;
+        }
+        virtual AMF_RESULT QueryOutput(AMFData** ppData)
+        {
+            AMFLock lock(&m_cs);
+            if (m_Frames.empty())
+            {
+                return m_bDrain ? AMF_EOF : AMF_REPEAT;
+            }
+            *ppData = m_Frames.front().Detach();
+            m_Frames.pop_front();
+            return AMF_OK;
+        }
+        virtual AMF_RESULT Drain(amf_int32 /*inputSlot*/)
+        {
+            AMFLock lock(&m_cs);
+            m_bDrain = true;
+            return AMF_OK;
+        }
+    private:
+        size_t                  m_Capacity;
+        std::deque<AMFDataPtr>  m_Frames;
+        bool                    m_bDrain;
+    };
+
+    // counts the frames and the ones that arrived out of order
+    class TestSink : public PipelineElement
+    {
+    public:
+        TestSink() : m_iReceived(0), m_iOutOfOrder(0), m_iExpected(0), m_bEof(false) {}
+
+        virtual amf_int32 GetInputSlotCount() const { return 1; }
+        virtual amf_int32 GetOutputSlotCount() const { return 0; }
+
+        virtual AMF_RESULT SubmitInput(AMFData* pData)
+        {
+            AMFLock lock(&m_cs);
+            if (pData->GetPts() != m_iExpected)
+            {
+                m_iOutOfOrder++;
+            }
+            m_iExpected = pData->GetPts() + 1;
+            m_iReceived++;
+            return AMF_OK;
+        }
+        virtual AMF_RESULT Drain(amf_int32 /*inputSlot*/)
+        {
+            AMFLock lock(&m_cs);
+            m_bEof = true;
+            return AMF_OK;
+        }
+
+        amf_int64 GetReceived() const { AMFLock lock(&m_cs); return m_iReceived; }
+        amf_int64 GetOutOfOrder() const { AMFLock lock(&m_cs); return m_iOutOfOrder; }
+        bool IsEof() const { AMFLock lock(&m_cs); return m_bEof; }
+    private:
+        amf_int64   m_iReceived;
+        amf_int64   m_iOutOfOrder;
+        amf_int64   m_iExpected;
+        bool        m_bEof;
+    };
+    typedef std::shared_ptr<TestSink> TestSinkPtr;
+
+    // source -> stage -> stage -> sink, one threading mode per connection
+    void BuildChain(Pipeline& pipeline, amf_int64 count, const ConnectionThreading* threading, TestSinkPtr pSink)
+    {
+        pipeline.Connect(PipelineElementPtr(new TestSource(count)), 4);
+        pipeline.Connect(PipelineElementPtr(new TestStage(4)), 4, threading[0]);
+        pipeline.Connect(PipelineElementPtr(new TestStage(4)), 4, threading[1]);
+        pipeline.Connect(pSink, 4, threading[2]);
+    }
+
+    // waits until the pipeline reports EOF, false on timeout
+    bool WaitForEof(Pipeline& pipeline, amf_pts timeout)
+    {
+        const amf_pts start = amf_high_precision_clock();
+        while (pipeline.GetState() != PipelineStateEof)
+        {
+            if (amf_high_precision_clock() - start > timeout)
+            {
+                return false;
+            }
+            amf_sleep(1);
+        }
+        return true;
+    }
+
+    int TestDelivery(const char* pWhat, const ConnectionThreading* threading)
+    {
+        int failures = 0;
+        const amf_int64 count = 5000;
+        TestSinkPtr pSink(new TestSink());
+        Pipeline pipeline;
+        BuildChain(pipeline, count, threading, pSink);
+
+        TEST_CHECK(pipeline.Start() == AMF_OK, "%s: Start() failed", pWhat);
+        TEST_CHECK(WaitForEof(pipeline, 30 * AMF_SECOND), "%s: no EOF after %d of %d frames", pWhat, (int)pSink->GetReceived(), (int)count);
+        TEST_CHECK(pSink->IsEof(), "%s: the sink was not drained", pWhat);
+        TEST_CHECK(pSink->GetReceived() == count, "%s: %d of %d frames delivered", pWhat, (int)pSink->GetReceived(), (int)count);
+        TEST_CHECK(pSink->GetOutOfOrder() == 0, "%s: %d frames out of order", pWhat, (int)pSink->GetOutOfOrder());
+        TEST_CHECK(pipeline.GetNumberOfProcessedFrames() == count, "%s: %d frames counted", pWhat, (int)pipeline.GetNumberOfProcessedFrames());
+        pipeline.Stop();
+        return failures;
+    }
+
+    // Stop() while frames are moving must return without waiting for EOF
+    int TestStopMidRun(const char* pWhat, const ConnectionThreading* threading)
+    {
+        int failures = 0;
+        TestSinkPtr pSink(new TestSink());
+        Pipeline pipeline;
+        BuildChain(pipeline, -1, threading, pSink);
+
+        TEST_CHECK(pipeline.Start() == AMF_OK, "%s: Start() failed", pWhat);
+        const amf_pts start = amf_high_precision_clock();
+        while (pSink->GetReceived() < 100 && amf_high_precision_clock() - start < 10 * AMF_SECOND)
+        {
+            amf_sleep(1);
+        }
+        TEST_CHECK(pSink->GetReceived() >= 100, "%s: only %d frames before Stop()", pWhat, (int)pSink->GetReceived());
+
+        const amf_pts stopStart = amf_high_precision_clock();
+        TEST_CHECK(pipeline.Stop() == AMF_OK, "%s: Stop() failed", pWhat);
+        const amf_pts stopTime = amf_high_precision_clock() - stopStart;
+        TEST_CHECK(stopTime < 2 * AMF_SECOND, "%s: Stop() took %d ms", pWhat, (int)(stopTime / AMF_MILLISECOND));
+        TEST_CHECK(pSink->GetOutOfOrder() == 0, "%s: %d frames out of order", pWhat, (int)pSink->GetOutOfOrder());
+        TEST_CHECK(pipeline.GetState() == PipelineStateNotReady, "%s: state %d after Stop()", pWhat, (int)pipeline.GetState());
+        return failures;
+    }
+
+    struct Chain
+    {
+        const char*         pName;
+        ConnectionThreading threading[3];
+    };
+
+    const Chain s_Chains[] =
+    {
+        { "thread queue",   { CT_ThreadQueue, CT_ThreadQueue, CT_ThreadQueue } },
+        { "scheduled",      { CT_Scheduled, CT_Scheduled, CT_Scheduled } },
+        { "mixed",          { CT_Scheduled, CT_Direct, CT_ThreadQueue } },
+        { "mixed reversed", { CT_ThreadQueue, CT_Direct, CT_Scheduled } },
+    };
+
+    double MeasureFramesPerSecond(const ConnectionThreading* threading, amf_int64 count)
+    {
+        TestSinkPtr pSink(new TestSink());
+        Pipeline pipeline;
+        BuildChain(pipeline, count, threading, pSink);
+        const amf_pts start = amf_high_precision_clock();
+        pipeline.Start();
+        WaitForEof(pipeline, 120 * AMF_SECOND);
+        const amf_pts elapsed = amf_high_precision_clock() - start;
+        pipeline.Stop();
+        return double(pSink->GetReceived()) / (double(elapsed) / AMF_SECOND);
+    }
+}
+
+int TestPipeline()
+{
+    int failures = 0;
+    for (size_t i = 0; i < amf_countof(s_Chains); i++)
+    {
+        failures += TestDelivery(s_Chains[i].pName, s_Chains[i].threading);
+        failures += TestStopMidRun(s_Chains[i].pName, s_Chains[i].threading);
+    }
+    printf("Pipeline: %d failed check(s)\n", failures);
+    return failures;
+}
+
+void BenchmarkPipeline()
+{
+    // cheap elements, so the numbers are the hand-off cost of each connection mode
+    const amf_int64 count = 20000;
+    printf("Pipeline benchmark, source -> 2 stages -> sink, %d frames, frames/s\n", (int)count);
+    for (size_t i = 0; i < amf_countof(s_Chains); i++)
+    {
+        printf("%-20s %10.0f\n", s_Chains[i].pName, MeasureFramesPerSecond(s_Chains[i].threading, count));
+    }
+}
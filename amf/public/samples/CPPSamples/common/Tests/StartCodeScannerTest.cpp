@@ -0,0 +1,319 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#include "SampleTests.h"
+#include "../StartCodeScanner.h"
+#include "public/common/AMFSTL.h"
+#include "public/common/Thread.h"
+
+using namespace amf;
+
+namespace
+{
+    typedef size_t (*FindFunc)(const amf_uint8* data, size_t size, amf_uint8 last);
+
+    struct Scanner
+    {
+        const char* pName;
+        FindFunc    pFind;
+    };
+
+    // the zero counting loop the parsers used before the scanner
+    size_t FindByteLoop(const amf_uint8* data, size_t size, amf_uint8 last)
+    {
+        size_t zeros = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            if (data[i] == 0)
+            {
+                zeros++;
+            }
+            else
+            {
+                if (data[i] == last && zeros >= 2)
+                {
+                    return i - 2;
+                }
+                zeros = 0;
+            }
+        }
+        return size;
+    }
+
+    // every scanner this CPU can run, the scalar loop first
+    amf_vector<Scanner> GetScanners()
+    {
+        amf_vector<Scanner> scanners;
+        const Scanner scalar = { "scalar", StartCodeScanner::FindScalar };
+        scanners.push_back(scalar);
+#if defined(START_CODE_SCANNER_SIMD)
+        const Scanner sse2 = { "SSE2", StartCodeScanner::FindSSE2 };
+        scanners.push_back(sse2);
+        if (StartCodeScanner::HasAVX2())
+        {
+            const Scanner avx2 = { "AVX2", StartCodeScanner::FindAVX2 };
+            scanners.push_back(avx2);
+        }
+        else
+        {
+            printf("StartCodeScanner: AVX2 not supported by this CPU, skipped\n");
+        }
+#endif
+        return scanners;
+    }
+
+    amf_uint32 Random(amf_uint32& seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    }
+
+    // slice-like payload: mostly non-zero bytes with runs of zeros, near misses and the odd match
+    void FillPayload(amf_uint8* data, size_t size, amf_uint32& seed)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            const amf_uint32 r = Random(seed);
+            data[i] = (r % 5) == 0 ? 0 : (r % 97) == 1 ? amf_uint8(r >> 8 & 0x03) : amf_uint8(0x04 + (r >> 8) % 0xfc);
+        }
+    }
+
+    // every scanner finds the same first match as the byte loop, for every size and alignment
+    int TestFind(const amf_vector<Scanner>& scanners, const amf_uint8* data, size_t size, const char* pWhat)
+    {
+        int failures = 0;
+        const amf_uint8 lasts[] = { 0x01, 0x03 };
+        for (size_t l = 0; l < sizeof(lasts) / sizeof(lasts[0]); l++)
+        {
+            const size_t expected = FindByteLoop(data, size, lasts[l]);
+            for (size_t s = 0; s < scanners.size(); s++)
+            {
+                const size_t found = scanners[s].pFind(data, size, lasts[l]);
+                TEST_CHECK(found == expected, "%s: %s found 00 00 %02x at %d in %d bytes, expected %d", pWhat, scanners[s].pName, lasts[l],
+                    (int)found, (int)size, (int)expected);
+            }
+        }
+        return failures;
+    }
+
+    int TestFindPositions(const amf_vector<Scanner>& scanners)
+    {
+        int failures = 0;
+        const size_t bufferSize = 200;
+        amf_vector<amf_uint8> buffer(bufferSize + 64);
+        // one match at every position of every size, including the vector block edges and the scalar tail
+        for (size_t size = 0; size <= bufferSize && failures == 0; size++)
+        {
+            for (size_t pos = 0; pos + 3 <= size + 2 && failures == 0; pos++)
+            {
+                for (size_t misalign = 0; misalign < 3; misalign++)
+                {
+                    amf_uint8* data = buffer.data() + misalign;
+                    memset(data, 0x47, size);
+                    // a near miss right before the match: 00 00 02 and 00 01
+                    if (pos >= 5)
+                    {
+                        data[pos - 5] = 0x00;
+                        data[pos - 4] = 0x00;
+                        data[pos - 3] = 0x02;
+                        data[pos - 2] = 0x00;
+                        data[pos - 1] = 0x01;
+                    }
+                    for (size_t i = pos; i < pos + 3 && i < size; i++)
+                    {
+                        data[i] = i < pos + 2 ? 0x00 : (pos & 1) ? 0x03 : 0x01;
+                    }
+                    failures += TestFind(scanners, data, size, "positions");
+                }
+            }
+        }
+        return failures;
+    }
+
+    int TestFindRandom(const amf_vector<Scanner>& scanners)
+    {
+        int failures = 0;
+        amf_uint32 seed = 0x2545f491;
+        amf_vector<amf_uint8> buffer(64 * 1024);
+        for (int i = 0; i < 2000 && failures == 0; i++)
+        {
+            const size_t offset = Random(seed) % 64;
+            const size_t size = Random(seed) % (buffer.size() - offset);
+            // zero runs: all zeros, 00 00 00 01 and long zero runs before a match
+            FillPayload(buffer.data() + offset, size, seed);
+            if (i % 3 == 0 && size > 0)
+            {
+                memset(buffer.data() + offset + Random(seed) % size, 0, AMF_MIN(size_t(Random(seed) % 300), size / 2));
+            }
+            for (size_t start = 0; start < size && failures == 0; )
+            {
+                // walk the buffer like a parser does, from one match to the next
+                failures += TestFind(scanners, buffer.data() + offset + start, size - start, "random");
+                const size_t next = FindByteLoop(buffer.data() + offset + start, size - start, 0x01);
+                start += next + 3;
+            }
+        }
+        return failures;
+    }
+
+    // reference EBSP to RBSP: drop every 03 after two zeros, zeros before the 03 do not carry over
+    size_t RemoveEmulationPreventionReference(amf_vector<amf_uint8>& data)
+    {
+        amf_vector<amf_uint8> out;
+        size_t zeros = 0;
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            if (zeros >= 2 && data[i] == 0x03)
+            {
+                if (i + 1 < data.size() && data[i + 1] > 0x03)
+                {
+                    return static_cast<size_t>(-1);
+                }
+                zeros = 0;
+                continue;
+            }
+            zeros = data[i] == 0 ? zeros + 1 : 0;
+            out.push_back(data[i]);
+        }
+        data = out;
+        return data.size();
+    }
+
+    int TestRemoveEmulationPrevention()
+    {
+        int failures = 0;
+        amf_uint32 seed = 0x6c078965;
+        for (int i = 0; i < 3000 && failures == 0; i++)
+        {
+            amf_vector<amf_uint8> data(Random(seed) % 4096);
+            FillPayload(data.data(), data.size(), seed);
+            // emulation prevention bytes, some after cabac_zero_words and at the very end
+            for (size_t j = 0; j + 3 <= data.size(); j += 3 + Random(seed) % 200)
+            {
+                data[j] = 0x00;
+                data[j + 1] = 0x00;
+                data[j + 2] = 0x03;
+                if (j + 3 < data.size() && i % 7 != 0)
+                {
+                    data[j + 3] = amf_uint8(Random(seed) % 4);
+                }
+            }
+            amf_vector<amf_uint8> expected = data;
+            const size_t expectedSize = RemoveEmulationPreventionReference(expected);
+            const size_t size = StartCodeScanner::RemoveEmulationPrevention(data.data(), data.size());
+            TEST_CHECK(size == expectedSize, "%d byte EBSP: RBSP size %d, expected %d", (int)data.size(), (int)size, (int)expectedSize);
+            TEST_CHECK(size != expectedSize || size == static_cast<size_t>(-1) || memcmp(data.data(), expected.data(), size) == 0,
+                "%d byte EBSP: RBSP differs", (int)data.size());
+        }
+        return failures;
+    }
+
+    // GB/s of finding every start code in data
+    double MeasureScan(FindFunc pFind, const amf_vector<amf_uint8>& data, size_t* pCount)
+    {
+        static const amf_pts minDuration = AMF_SECOND / 2;
+        size_t count = 0;
+        amf_int64 bytes = 0;
+        const amf_pts start = amf_high_precision_clock();
+        amf_pts elapsed = 0;
+        do
+        {
+            count = 0;
+            for (size_t pos = 0; pos < data.size(); )
+            {
+                const size_t found = pFind(data.data() + pos, data.size() - pos, 0x01);
+                if (found >= data.size() - pos)
+                {
+                    break;
+                }
+                count++;
+                pos += found + 3;
+            }
+            bytes += data.size();
+            elapsed = amf_high_precision_clock() - start;
+        } while (elapsed < minDuration);
+        *pCount = count;
+        return double(bytes) / (double(elapsed) / AMF_SECOND) / (1024.0 * 1024.0 * 1024.0);
+    }
+}
+
+int TestStartCodeScanner()
+{
+    int failures = 0;
+    const amf_vector<Scanner> scanners = GetScanners();
+    failures += TestFindPositions(scanners);
+    failures += TestFindRandom(scanners);
+    failures += TestRemoveEmulationPrevention();
+
+    // 00 00 03 followed by a byte above 03 is not a valid EBSP
+    amf_uint8 invalid[] = { 0x25, 0x00, 0x00, 0x03, 0x04, 0x80 };
+    TEST_CHECK(StartCodeScanner::RemoveEmulationPrevention(invalid, sizeof(invalid)) == static_cast<size_t>(-1), "00 00 03 04 accepted");
+    amf_uint8 invalidAtEnd[] = { 0x25, 0x00, 0x00, 0x03, 0x04 };
+    TEST_CHECK(StartCodeScanner::RemoveEmulationPrevention(invalidAtEnd, sizeof(invalidAtEnd)) == static_cast<size_t>(-1), "00 00 03 04 at the end accepted");
+    // a final 03 after a cabac_zero_word is dropped
+    amf_uint8 cabacZeroWord[] = { 0x25, 0x00, 0x00, 0x03 };
+    TEST_CHECK(StartCodeScanner::RemoveEmulationPrevention(cabacZeroWord, sizeof(cabacZeroWord)) == 3, "final 00 00 03 kept");
+    printf("StartCodeScanner: %d failed check(s)\n", failures);
+    return failures;
+}
+
+void BenchmarkStartCodeScanner()
+{
+    // long slice payloads with few start codes, as in high bitrate intra frames
+    const size_t size = 64 * 1024 * 1024;
+    amf_vector<amf_uint8> data(size);
+    amf_uint32 seed = 0x9e3779b9;
+    for (size_t i = 0; i < size; i++)
+    {
+        const amf_uint32 r = Random(seed);
+        data[i] = (r % 7) == 0 ? 0 : amf_uint8(0x04 + (r >> 8) % 0xfc);
+    }
+    for (size_t pos = 0; pos + 4 <= size; pos += 512 * 1024)
+    {
+        data[pos] = 0x00;
+        data[pos + 1] = 0x00;
+        data[pos + 2] = 0x00;
+        data[pos + 3] = 0x01;
+    }
+
+    printf("StartCodeScanner benchmark, %d MB with a start code every 512 KB, GB/s\n", (int)(size >> 20));
+    size_t count = 0;
+    printf("%-20s %10.2f\n", "byte loop", MeasureScan(FindByteLoop, data, &count));
+    const amf_vector<Scanner> scanners = GetScanners();
+    for (size_t s = 0; s < scanners.size(); s++)
+    {
+        printf("%-20s %10.2f\n", scanners[s].pName, MeasureScan(scanners[s].pFind, data, &count));
+    }
+}
@@ -76,8 +76,7 @@ const AMFEnumDescriptionEntry AMF_SAMPLE_FORMAT_ENUM_DESCRIPTION[] =
 AMFAudioConverterFFMPEGImpl::AMFAudioConverterFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
     m_pResampler(NULL),
-    m_pTempBuffer(NULL),
-    m_uiTempBufferSize(0),
+    m_iOutSampleRemainder(0),
     m_inSampleFormat(AMFAF_UNKNOWN),
     m_outSampleFormat(AMFAF_UNKNOWN),
     m_inSampleRate(0),
@@ -188,17 +187,12 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::Terminate()
         m_pResampler = NULL;
     }
 
-    if (m_pTempBuffer != NULL)
-    {
-        free(m_pTempBuffer);
-        m_pTempBuffer = NULL;
-    }
+    m_OutputPool.clear();
+    m_iOutSampleRemainder = 0;
 
     m_audioFrameSubmitCount = 0;
     m_audioFrameQueryCount = 0;
 
-    m_uiTempBufferSize = 0;
-
     m_bEof = false;
     m_ptsNext = -1LL;
     m_ptsPrevEnd = -1LL;
@@ -225,6 +219,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::Flush()
     // clear the pts values
     m_ptsNext = -1LL;
     m_ptsPrevEnd = -1LL;
+    m_iOutSampleRemainder = 0;
 
     // we need to dump everything that's stored in the resampler
     // and re-init it - draining the last buffered information in
@@ -361,33 +356,6 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
     }
 
 
-    //
-    // Prepare output to retrieve the resampled data
-    const amf_int64  sampleSizeOut = GetAudioSampleSize(m_outSampleFormat);
-    
-    // Create output buffer to store converter output temporarily
-    // the reason we need the temporary buffer is because the max 
-    // required buffer size, might be more than what we get in the 
-    // end from actually doing the conversion as swr_get_out_samples
-    // gives us an upper bound, not the exact size
-    const amf_int64  requiredSize = sampleCountOutMax * m_outChannels * sampleSizeOut;
-    if (m_uiTempBufferSize < (amf_size) requiredSize)
-    {
-        m_uiTempBufferSize = ((((amf_size)requiredSize) + (64 - 1)) & ~(64 - 1));
-        m_pTempBuffer = (amf_uint8*) realloc(m_pTempBuffer, m_uiTempBufferSize);
-    }
-    AMF_RETURN_IF_FALSE(m_pTempBuffer != NULL, AMF_OUT_OF_MEMORY, L"QueryOutput() - No memory m_uiTempBufferSize = %" LPRId64 L"", (amf_int64)m_uiTempBufferSize);
-
-    // Set the pointers for each channel - if data is packed, there's only one 
-    // plane so the loop will set the pointer to the beginning of the plane
-    const amf_int64  channelsOut = IsAudioPlanar(m_outSampleFormat) ? m_outChannels : 1;
-          uint8_t*   obuf[12]    = { m_pTempBuffer };
-    for (amf_int64 ch = 0; ch < channelsOut; ch++)
-    {
-        obuf[ch] = m_pTempBuffer + ch * (sampleSizeOut * sampleCountOutMax);
-    }
-
-
     //
     // Convert audio
     // NOTE: we need to be careful if we find a gap in the audio stream
@@ -400,7 +368,44 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
     //       come out to 1, and it's not really a gap
     const amf_pts    currGap        = (m_pInputData != NULL) ? m_pInputData->GetPts() - m_ptsPrevEnd : 0;
     const bool       gapFound       = (m_ptsPrevEnd != -1LL) && (currGap > 1);
-    const amf_int64  sampleCountOut = swr_convert(m_pResampler, obuf, (int) sampleCountOutMax, 
+
+    // swr_get_out_samples is only an upper bound - ask for the number of samples
+    // this input accounts for at the output rate and let the resampler keep the
+    // rest, so the output normally fills the buffer exactly and needs no copy
+    amf_int64 sampleCountOutReq = sampleCountOutMax;
+    amf_int64 outSampleRemainder = m_iOutSampleRemainder;
+    if (m_pInputData != nullptr && gapFound == false)
+    {
+        const amf_int64  owed = m_iOutSampleRemainder + sampleCountIn * m_outSampleRate;
+        outSampleRemainder = owed % m_inSampleRate;
+        if (owed / m_inSampleRate > 0)
+        {
+            sampleCountOutReq = AMF_MIN(owed / m_inSampleRate, sampleCountOutMax);
+        }
+    }
+
+    //
+    // Prepare output to retrieve the resampled data
+    const amf_int64  sampleSizeOut = GetAudioSampleSize(m_outSampleFormat);
+
+    AMFAudioBufferPtr pOutputAudioBuffer;
+    if (sampleCountOutReq > 0)
+    {
+        AMF_RESULT err = AcquireOutputBuffer((amf_int32) sampleCountOutReq, &pOutputAudioBuffer);
+        AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AcquireOutputBuffer failed");
+    }
+
+    // Set the pointers for each channel - if data is packed, there's only one 
+    // plane so the loop will set the pointer to the beginning of the plane
+    amf_uint8*       pMemOut     = (pOutputAudioBuffer != nullptr) ? static_cast<amf_uint8*>(pOutputAudioBuffer->GetNative()) : nullptr;
+    const amf_int64  channelsOut = IsAudioPlanar(m_outSampleFormat) ? m_outChannels : 1;
+          uint8_t*   obuf[12]    = { pMemOut };
+    for (amf_int64 ch = 0; ch < channelsOut && pMemOut != nullptr; ch++)
+    {
+        obuf[ch] = pMemOut + ch * (sampleSizeOut * sampleCountOutReq);
+    }
+
+    const amf_int64  sampleCountOut = swr_convert(m_pResampler, obuf, (int) sampleCountOutReq, 
                                                  ((m_pInputData != NULL) && (gapFound == false)) ? ibuf : NULL, (gapFound == true) ? 0 : (int) sampleCountIn);
     
     char errBuf[AV_ERROR_MAX_STRING_SIZE] = { 0 };
@@ -431,25 +436,28 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
 
 
     //
-    // allocate output buffer
-    AMFAudioBufferPtr pOutputAudioBuffer;
-    AMF_RESULT  err = m_pContext->AllocAudioBuffer(AMF_MEMORY_HOST, m_outSampleFormat, (amf_int32) sampleCountOut, 
-                                                   (amf_int32) m_outSampleRate, (amf_int32) m_outChannels, &pOutputAudioBuffer);
-    AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AllocAudioBuffer failed");
-
-    // copy the data from the temporary buffer
-    amf_uint8* pMemOut = static_cast<amf_uint8*>(pOutputAudioBuffer->GetNative());
-    if (IsAudioPlanar(m_outSampleFormat))
+    // the resampler came up short (start of stream, gap or drain) - move
+    // what we got into a buffer of the right size
+    if (sampleCountOut < sampleCountOutReq)
     {
-        const amf_size  copySize = (amf_size)(sampleCountOut * sampleSizeOut);
-        for (amf_int32 ch = 0; ch < m_outChannels; ch++)
+        AMFAudioBufferPtr pShortBuffer;
+        AMF_RESULT  err = AcquireOutputBuffer((amf_int32) sampleCountOut, &pShortBuffer);
+        AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AcquireOutputBuffer failed");
+
+        amf_uint8* pMemShort = static_cast<amf_uint8*>(pShortBuffer->GetNative());
+        if (IsAudioPlanar(m_outSampleFormat))
         {
-            memcpy(pMemOut + ch * copySize, obuf[ch], copySize);
+            const amf_size  copySize = (amf_size)(sampleCountOut * sampleSizeOut);
+            for (amf_int32 ch = 0; ch < m_outChannels; ch++)
+            {
+                memcpy(pMemShort + ch * copySize, obuf[ch], copySize);
+            }
         }
-    }
-    else
-    { 
-        memcpy(pMemOut, obuf[0], (size_t)(sampleCountOut * m_outChannels * sampleSizeOut));
+        else
+        {
+            memcpy(pMemShort, obuf[0], (size_t)(sampleCountOut * m_outChannels * sampleSizeOut));
+        }
+        pOutputAudioBuffer = pShortBuffer;
     }
 
 
@@ -496,6 +504,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioConverterFFMPEGImpl::QueryOutput(AMFData** ppDa
 
         // update last pts position
         m_ptsPrevEnd = m_pInputData->GetPts() + m_pInputData->GetDuration();
+        m_iOutSampleRemainder = outSampleRemainder;
 
         // release frame so the next one can come in
         m_pInputData = nullptr;
@@ -573,6 +582,7 @@ AMF_RESULT AMF_STD_CALL AMFAudioConverterFFMPEGImpl::ReInitOnGap()
 
     // the previous pts will no longer be valid, due to the gap
     m_ptsPrevEnd = -1LL;
+    m_iOutSampleRemainder = 0;
 
     // close the resampler as we got the last bits out
     swr_close(m_pResampler);
@@ -597,3 +607,52 @@ AMF_RESULT AMF_STD_CALL AMFAudioConverterFFMPEGImpl::ReInitOnGap()
 
     return AMF_OK;
 }
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL AMFAudioConverterFFMPEGImpl::AcquireOutputBuffer(amf_int32 sampleCount, AMFAudioBuffer** ppBuffer)
+{
+    // a few sizes alternate when resampling (e.g. 940 and 941 samples for 48000 -> 44100)
+    static const amf_size maxPooledBuffers = 8;
+
+    AMF_RETURN_IF_FALSE(sampleCount > 0, AMF_INVALID_ARG, L"AcquireOutputBuffer() - invalid sample count %d", sampleCount);
+
+    // a buffer is free when the pool holds the only reference to it
+    amf_vector<AMFAudioBufferPtr>::iterator itFree = m_OutputPool.end();
+    for (amf_vector<AMFAudioBufferPtr>::iterator it = m_OutputPool.begin(); it != m_OutputPool.end(); it++)
+    {
+        (*it)->Acquire();
+        if ((*it)->Release() != 1)
+        {
+            continue;
+        }
+        if ((*it)->GetSampleCount() == sampleCount && (*it)->GetMemoryType() == AMF_MEMORY_HOST)
+        {
+            // properties of the previous frame must not leak into this one
+            (*it)->Clear();
+            *ppBuffer = *it;
+            (*ppBuffer)->Acquire();
+            return AMF_OK;
+        }
+        if (itFree == m_OutputPool.end())
+        {
+            itFree = it;
+        }
+    }
+
+    AMFAudioBufferPtr pBuffer;
+    AMF_RESULT err = m_pContext->AllocAudioBuffer(AMF_MEMORY_HOST, m_outSampleFormat, sampleCount,
+                                                  (amf_int32) m_outSampleRate, (amf_int32) m_outChannels, &pBuffer);
+    AMF_RETURN_IF_FAILED(err, L"AcquireOutputBuffer() - AllocAudioBuffer failed");
+
+    // replace an idle buffer of another size, or grow the pool up to its limit
+    if (itFree != m_OutputPool.end())
+    {
+        *itFree = pBuffer;
+    }
+    else if (m_OutputPool.size() < maxPooledBuffers)
+    {
+        m_OutputPool.push_back(pBuffer);
+    }
+
+    *ppBuffer = pBuffer.Detach();
+    return AMF_OK;
+}
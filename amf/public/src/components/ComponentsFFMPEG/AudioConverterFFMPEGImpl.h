@@ -102,8 +102,10 @@ namespace amf
 
         AMFAudioBufferPtr        m_pInputData;
 
-        amf_uint8*               m_pTempBuffer;
-        amf_size                 m_uiTempBufferSize;
+        // output buffers handed out before, reused once downstream releases them
+        amf_vector<AMFAudioBufferPtr>  m_OutputPool;
+        // fraction of an output sample carried between frames, in 1/m_inSampleRate units
+        amf_int64                m_iOutSampleRemainder;
 
         // cache property values and update them on 
         // OnPropertyChanged so we don't have to get
@@ -128,6 +130,7 @@ namespace amf
 
         AMF_RESULT AMF_STD_CALL InitResampler();
         AMF_RESULT AMF_STD_CALL ReInitOnGap();
+        AMF_RESULT AMF_STD_CALL AcquireOutputBuffer(amf_int32 sampleCount, AMFAudioBuffer** ppBuffer);
 
 
         AMFAudioConverterFFMPEGImpl(const AMFAudioConverterFFMPEGImpl&);
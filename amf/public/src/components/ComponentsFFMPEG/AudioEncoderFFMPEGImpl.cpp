@@ -80,7 +80,10 @@ AMFAudioEncoderFFMPEGImpl::AMFAudioEncoderFFMPEGImpl(AMFContext* pContext)
     m_inSampleFormat(AMFAF_UNKNOWN),
     m_samplePreProcRequired(false),
     m_channelCount(0),
-    m_sampleRate(0)
+    m_sampleRate(0),
+    m_ringReadSample(0),
+    m_ringWriteSample(0),
+    m_framesPerSubmit(1)
 {
     g_AMFFactory.Init();
 
@@ -89,6 +92,7 @@ AMFAudioEncoderFFMPEGImpl::AMFAudioEncoderFFMPEGImpl(AMFContext* pContext)
         AMFPropertyInfoBool(AUDIO_ENCODER_ENABLE_ENCODING, L"Enable encoding", true, false),
 
         AMFPropertyInfoInt64(AUDIO_ENCODER_AUDIO_CODEC_ID, L"Codec ID", AV_CODEC_ID_NONE, AV_CODEC_ID_NONE, INT_MAX, false),
+        AMFPropertyInfoInt64(AUDIO_ENCODER_FRAMES_PER_SUBMIT, L"Codec frames sent per SubmitInput", 1, 1, 64, false),
 
         AMFPropertyInfoInt64(AUDIO_ENCODER_IN_AUDIO_SAMPLE_RATE, L"Sample Rate In", 44100, 0, INT_MAX, false),
         AMFPropertyInfoInt64(AUDIO_ENCODER_IN_AUDIO_CHANNELS, L"Number of channels in (0 - default)", 2, 0, 100, false),
@@ -260,6 +264,18 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*fo
     // figure out if the encoder supports variable samples
     m_samplePreProcRequired = (pCodec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE) ? false : true;
 
+    // a ring of whole frames keeps frames from wrapping, it grows if the input is larger
+    if (m_samplePreProcRequired && (m_pCodecContext->frame_size > 0))
+    {
+        const amf_int32  planes     = IsAudioPlanar(m_inSampleFormat) ? m_channelCount : 1;
+        const amf_int32  sampleSize = GetAudioSampleSize(m_inSampleFormat) * (IsAudioPlanar(m_inSampleFormat) ? 1 : m_channelCount);
+        AMF_RETURN_IF_FAILED(m_ring.Init(planes, sampleSize, 8 * m_pCodecContext->frame_size, m_pCodecContext->frame_size));
+    }
+
+    amf_int64  framesPerSubmit = 1;
+    GetProperty(AUDIO_ENCODER_FRAMES_PER_SUBMIT, &framesPerSubmit);
+    m_framesPerSubmit = (amf_int32) framesPerSubmit;
+
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -291,10 +307,10 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::Terminate()
     m_audioFrameQueryCount = 0;
     m_bEof = false;
 
-    m_preparedFrames.clear();
-    m_recycledFrames.clear();
-    m_pPartialFrame = nullptr;
-    m_partialFrameSampleCount = 0;
+    m_ring.Release();
+    m_ringInputs.clear();
+    m_ringReadSample = 0;
+    m_ringWriteSample = 0;
 
     m_inputData.clear();
 
@@ -310,12 +326,13 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::Drain()
 
 
     //
-    // if we have remaining frames, start pushing them as we
-    // need to consume them to fully drain the component
-    // submit frames until the decoder is full
-    while (m_preparedFrames.empty() == false)
+    // if we have buffered samples, push them as we need to
+    // consume them to fully drain the component - the last
+    // frame is allowed to be shorter than the codec frame size
+    if (m_ring.GetAvailable() > 0)
     {
-        AMF_RESULT retCode = SubmitInput(m_preparedFrames.front());
+        amf_int32   framesSent = 0;
+        AMF_RESULT  retCode    = SendRingFrames(INT_MAX, true, &framesSent);
         if (retCode == AMF_INPUT_FULL)
         {
             // if the encoder is full, submitting any frames again
@@ -330,51 +347,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::Drain()
 
             return retCode;
         }
-    }
-
-
-    //
-    // if we have a partial frame left, we need to submit it also
-    if (m_pPartialFrame != nullptr)
-    {
-        // at this point, the only thing that's left to
-        // send to the encoder is the final partial frame
-        AMFAudioBufferPtr  pTempFrame = m_pPartialFrame;
-        m_pPartialFrame = nullptr;
-
-        // also clear any possible recycled frames as they
-        // would also have been allocated for the wrong size
-        // and if we need a new partial frame it has got to
-        // be the correct size
-        m_recycledFrames.clear();
-
-        // NOTE: need to make the final frame proper so it contains only the
-        //       partial information not a portion of a full frame which
-        //       will cause the encoder to get more info than it should
-        SplitOrCombineFrames(pTempFrame, m_partialFrameSampleCount);
-        AMF_RETURN_IF_FALSE(m_preparedFrames.empty() == false, AMF_FAIL, L"Drain() - we should've obtained a 'full' frame at this point");
-
-        // we don't care about any remaining data in this case
-        // as the partial frame we split should've been the
-        // ending partial data to be submitted to the encoder
-        m_pPartialFrame = nullptr;
-        m_partialFrameSampleCount = 0;
-
-        // what can happen is that the remaining partial frame
-        // might be able to generate more than one frame out
-        // (Ex: remaining samples 566, on 1536 sample size)
-        // but we only care about the first frame generated
-        // the rest would contain invalid information
-        while (m_preparedFrames.size() > 1)
-        {
-            m_preparedFrames.pop_back();
-        }
-
-        AMF_RESULT retCode = SubmitInput(m_preparedFrames.front());
-        if (retCode == AMF_INPUT_FULL)
-        {
-            return retCode;
-        }
+        AMF_RETURN_IF_FAILED(retCode, L"Drain() - sending buffered frames failed");
     }
 
 
@@ -421,10 +394,10 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::Flush()
     m_firstFramePts = -1LL;
     m_firstFFMPEGPts = LLONG_MIN;
 
-    m_preparedFrames.clear();
-    m_recycledFrames.clear();
-    m_pPartialFrame = nullptr;
-    m_partialFrameSampleCount = 0;
+    m_ring.Clear();
+    m_ringInputs.clear();
+    m_ringReadSample = 0;
+    m_ringWriteSample = 0;
 
     m_inputData.clear();
 
@@ -456,7 +429,6 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SubmitInput(AMFData* pData)
     //
     // start submitting information to the encoder
     AMFAudioBufferPtr pAudioBuffer;
-    amf_bool          resendFrame = false;
     int               ret         = 0;
     if (pData != nullptr)
     {
@@ -494,58 +466,61 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SubmitInput(AMFData* pData)
         //       should be passed directly to the encoder, without any combining or splitting
         //       (an example of this would be wav)
         //
-        // NOTE: if we're draining, so we set m_bEof, we're actually sending in
-        //       the combined/split frames so we don't want to do that again
+        // NOTE: if we're draining, so we set m_bEof, the ring is emptied by Drain
+        //       so anything that comes in after that goes to the encoder as is
         //
-        // NOTE: if by any chance we are splitting/combining the packets but the frame coming
-        //       in is the exact same size as required, if we don't have anything cached we
-        //       should just send the frame as is, without any combine/split, but if we
-        //       have a split frame or the cached is not empty, we have to add it so we don't
-        //       send stuff out of order to the encoder
+        // NOTE: if the frame coming in is the exact size required and nothing is
+        //       buffered, it is sent as is without going through the ring, otherwise
+        //       it has to be added after the buffered samples so we don't send
+        //       stuff out of order to the encoder
         const amf_int32  inSampleCount = pAudioBuffer->GetSampleCount();
+        const amf_int32  frameSize     = m_pCodecContext->frame_size;
         if (m_samplePreProcRequired && !m_bEof &&
-            (m_pCodecContext->frame_size > 0) &&
-            ((inSampleCount != m_pCodecContext->frame_size) || (m_preparedFrames.empty() == false) || (m_pPartialFrame != nullptr)) )
+            (frameSize > 0) &&
+            ((inSampleCount != frameSize) || (m_ring.GetAvailable() > 0)) )
         {
-            // limit the size of the queue we use for storing processed frames
-            // this should only matter when we go from large samples to small
-            // samples as we can create multiple packets and we don't want the
-            // queue to increase to unmanageable size
-            //
-            // in that case, we don't process the incoming frame but we still
-            // send what we have to the decoder
-            //
-            // this way we don't have to check if the frame we receive is the
-            // same one we didn't process as we leave the code in the same
-            // state as it was before - as we didn't add the new frame to the
-            // combined/split data
-            //
-            // NOTE: it is possible when we request the caller to resend the frame
-            //       to create a completely new frame with the same data (in which
-            //       case a frame with the same PTS would probably come), but it's
-            //       also possible that the old frame is dropped completely and a
-            //       new one is sent instead, which is why checking previous frames
-            //       doesn't always work properly
-            if ((int) m_preparedFrames.size() <= AMF_MAX(3 * inSampleCount / m_pCodecContext->frame_size, 5))
+            amf_int32  framesSent = 0;
+
+            // make room for the new samples by sending what's buffered - if the
+            // encoder is busy, the caller has to pull output and resend the frame
+            // which is safe as nothing from it went into the ring yet
+            if (m_ring.GetFree() < inSampleCount)
             {
-                err = SplitOrCombineFrames(pAudioBuffer, m_pCodecContext->frame_size);
-                AMF_RETURN_IF_FAILED(err, L"SubmitInput() - Splitting or combining audio samples was required but failed");
+                const amf_int32  framesNeeded = (inSampleCount - m_ring.GetFree() + frameSize - 1) / frameSize;
+                err = SendRingFrames(framesNeeded, false, &framesSent);
+                if (err == AMF_INPUT_FULL)
+                {
+                    return AMF_INPUT_FULL;
+                }
+                AMF_RETURN_IF_FAILED(err, L"SubmitInput() - sending buffered frames failed");
+
+                // whatever is left is less than a frame, so the input is larger than the ring
+                if (m_ring.GetFree() < inSampleCount)
+                {
+                    const amf_int32  required = m_ring.GetAvailable() + inSampleCount;
+                    err = m_ring.Reserve((required + frameSize - 1) / frameSize * frameSize);
+                    AMF_RETURN_IF_FAILED(err, L"SubmitInput() - growing the sample ring failed");
+                }
             }
-            else
+
+            err = WriteToRing(pAudioBuffer);
+            AMF_RETURN_IF_FAILED(err, L"SubmitInput() - buffering input samples failed");
+
+            // the encoder being busy is fine at this point - the samples
+            // are buffered and go out with the next call
+            err = SendRingFrames(m_framesPerSubmit, false, &framesSent);
+            if (err != AMF_INPUT_FULL)
             {
-                resendFrame = true;
+                AMF_RETURN_IF_FAILED(err, L"SubmitInput() - sending buffered frames failed");
             }
 
             // if we haven't managed to form a
             // full frame, then get more input
-            if (m_preparedFrames.empty() == true)
+            if ((framesSent == 0) && (m_ring.GetAvailable() < frameSize))
             {
                 return AMF_NEED_MORE_INPUT;
             }
-
-            // if we have any combined or split frames we
-            // should pick those to send to the encoder
-            pAudioBuffer = m_preparedFrames.front();
+            return AMF_OK;
         }
 
 
@@ -593,25 +568,9 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SubmitInput(AMFData* pData)
     //       along the normal case when it can't accept a new frame to process
     if (ret == AVERROR(EAGAIN))
     {
-        // the issue here for the case when we need to combine split frames is
-        // that we could process the frame coming in, add it to the partial/combined
-        // frame buffer, which we then pass to the encoder, but if the encoder comes
-        // back and says that it's busy, we can't say the input is full because that
-        // would send the frame back, and we've already added it to the partial frame
-        // so in that case, we need to say that it's OK, because we will get a new
-        // frame coming in, but we'll send to the encoder the processed frame we
-        // send the last time so it should all be good
-        //
-        // NOTE: if we've already set EOF, then if we get here it's because we
-        //       drain combined frames we still have so in that case, we need
-        //       to return AMF_INPUT_FULL, so the pipeline knows to keep removing
-        //       frames through QueryOutput
-        //
-        // NOTE: the default is if we get normal frames which don't need to be
-        //       combined or split, in which case the prepared frames is empty
-        return ((m_preparedFrames.empty() == true) ||
-                (m_bEof == true) ||
-                (resendFrame == true)) ? AMF_INPUT_FULL : AMF_OK;
+        // frames that go through the ring never get here, so the frame
+        // was not taken and the caller has to send it again
+        return AMF_INPUT_FULL;
     }
     if (ret == AVERROR_EOF)
     {
@@ -629,27 +588,10 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SubmitInput(AMFData* pData)
     // it's time to increment the submitted frames counter
     if (pAudioBuffer != nullptr)
     {
-        const amf_bool   isProcFrame  = (m_preparedFrames.empty() == false) && (pAudioBuffer == m_preparedFrames.front());
-        AMFTransitFrame  transitFrame = { (AMFData*) pAudioBuffer, !isProcFrame };
+        AMFTransitFrame  transitFrame = { (AMFData*) pAudioBuffer, pAudioBuffer->GetPts(), pAudioBuffer->GetDuration() };
 
         m_inputData.push_back(transitFrame);
         m_audioFrameSubmitCount++;
-
-        // if the frame we received is a combined/split frame it's time to
-        // remove it from the list since it's been processed at this point
-        if (isProcFrame == true)
-        {
-            m_preparedFrames.pop_front();
-        }
-
-        // if the queue is too large (and we don't want to make it really large
-        // due to memory usage, when we go from a large frame to a smaller frame
-        // then ask the sender to resend the frame - we don't have to worry as
-        // we don't reprocess the same frame to split or combine it
-        if (resendFrame == true)
-        {
-            return AMF_INPUT_FULL;
-        }
     }
 
     return ((m_bEof == true) || (ret == AVERROR_EOF)) ? AMF_EOF : AMF_OK;
@@ -764,15 +706,15 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::QueryOutput(AMFData** ppData
         while (m_inputData.empty() == false)
         {
             const AMFTransitFrame& transitFrame    = m_inputData.front();
-            const amf_pts          inFramePts      = transitFrame.pData->GetPts();
-            const amf_pts          inFrameDuration = transitFrame.pData->GetDuration();
+            const amf_pts          inFramePts      = transitFrame.pts;
+            const amf_pts          inFrameDuration = transitFrame.duration;
 
             // if the current pts is past the end of the frame
             // we should drop that frame as the frames should
             // come in sequentially
             std::list<AMFTransitFrame>::const_iterator itNext = ++m_inputData.begin();
             if ((pts > inFramePts + inFrameDuration) ||
-                ((itNext != m_inputData.end()) && (pts == itNext->pData->GetPts())))
+                ((itNext != m_inputData.end()) && (pts == itNext->pts)))
             {
                 m_inputData.pop_front();
                 continue;
@@ -793,7 +735,7 @@ AMF_RESULT AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::QueryOutput(AMFData** ppData
                 // check though if the frame is closer to the next frame, in which
                 // case it should probably copy from that frame
                 if ((itNext != m_inputData.end()) &&
-                    (abs((amf_int64) itNext->pData->GetPts() - (amf_int64) pts) < (pts - inFramePts)))
+                    (abs((amf_int64) itNext->pts - (amf_int64) pts) < (pts - inFramePts)))
                 {
                     itNext->pData->CopyTo(pBufferOut, false);
                 }
@@ -838,48 +780,9 @@ void AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::OnPropertyChanged(const wchar_t* p
     }
 }
 //-------------------------------------------------------------------------------------------------
-AMF_RESULT  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::GetNewFrame(AMFAudioBuffer** ppNewBuffer, amf_int32 requiredSize)
-{
-    AMF_RETURN_IF_FALSE(m_pCodecContext != nullptr, AMF_NOT_INITIALIZED, L"GetNewFrame() - Codec Context not Initialized");
-    AMF_RETURN_IF_FALSE(m_pContext != nullptr, AMF_NOT_INITIALIZED, L"GetNewFrame() - AMF Context not initialized");
-    AMF_RETURN_IF_FALSE(ppNewBuffer != nullptr, AMF_INVALID_ARG, L"GetNewFrame() - pInBuffer == NULL");
-
-
-    //
-    // check if we have a cached frame we could use instead of allocating
-    // another frame and waste an allocation
-    if ((m_recycledFrames.empty() == false) &&
-        (m_recycledFrames.front()->GetSampleCount() == requiredSize) &&
-        (m_recycledFrames.front()->GetSampleFormat() == m_inSampleFormat) &&
-        (m_recycledFrames.front()->GetChannelCount() == m_channelCount))
-    {
-        // if we have previously allocated data
-        // get the previously allocated pointer
-        AMFAudioBufferPtr pRecycledFrame = m_recycledFrames.front();
-        m_recycledFrames.pop_front();
-
-        // clear its properties so we can set/copy
-        // new ones from the passed in buffer
-        pRecycledFrame->Clear();
-
-        *ppNewBuffer = pRecycledFrame.Detach();
-        return AMF_OK;
-    }
-
-
-    //
-    // allocate a new frame to fill
-    AMF_RESULT err = m_pContext->AllocAudioBuffer(AMF_MEMORY_HOST, m_inSampleFormat, requiredSize, m_sampleRate, m_channelCount, ppNewBuffer);
-    AMF_RETURN_IF_FAILED(err, L"GetNewFrame() - AllocAudioBuffer failed");
-
-    return err;
-}
-//-------------------------------------------------------------------------------------------------
-AMF_RESULT  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SplitOrCombineFrames(AMFAudioBuffer* pInBuffer, amf_int32 requiredSize)
+AMF_RESULT  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::WriteToRing(AMFAudioBuffer* pInBuffer)
 {
-    AMF_RETURN_IF_FALSE(m_pCodecContext != nullptr, AMF_NOT_INITIALIZED, L"SplitOrCombineFrames() - Codec Context not Initialized");
-    AMF_RETURN_IF_FALSE(m_pContext != nullptr, AMF_NOT_INITIALIZED, L"SplitOrCombineFrames() - AMF Context not initialized");
-    AMF_RETURN_IF_FALSE(pInBuffer != nullptr, AMF_INVALID_ARG, L"SplitOrCombineFrames() - pInBuffer == NULL");
+    AMF_RETURN_IF_FALSE(pInBuffer != nullptr, AMF_INVALID_ARG, L"WriteToRing() - pInBuffer == NULL");
 
 
     //
@@ -893,107 +796,99 @@ AMF_RESULT  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SplitOrCombineFrames(AMFAud
     //      ABABABABABABABABABABABABABABABABABABABAB
     // NOTE: we are combining on the same format - we're not changing
     //       format here to go from planar to packed or the other way around
-    const amf_bool   isPlanar      = IsAudioPlanar(m_inSampleFormat);
-    const amf_int32  planar        = isPlanar ? 1 : m_channelCount;
-    const amf_int32  planes        = isPlanar ? m_channelCount : 1;
+    const amf_int32  planar        = IsAudioPlanar(m_inSampleFormat) ? 1 : m_channelCount;
     const amf_int32  sampleSize    = GetAudioSampleSize((AMF_AUDIO_FORMAT) m_inSampleFormat);
     const amf_int32  inSampleCount = pInBuffer->GetSampleCount();
-    const amf_pts    inDuration    = pInBuffer->GetDuration();
-
 
-    //
-    // while we have data in the input buffer we
-    // want to create new frames that contain the
-    // correct number of samples for the encoder
-    amf_int32  inSamplesConsumed = 0;
-    while (inSamplesConsumed < inSampleCount)
-    {
-        // if we have a partial frame, fill the partial frame first
-        // otherwise create a new frame
-        AMFAudioBufferPtr  pFrameToFill;
-        amf_int32          existingSampleCount = 0;
-        if (m_pPartialFrame != nullptr)
-        {
-            AMF_RETURN_IF_FALSE(m_pPartialFrame->GetSampleCount() == requiredSize, AMF_UNEXPECTED, L"SplitOrCombineFrames() - partial frame does not contain enough samples");
+    AMF_RESULT err = m_ring.Write(static_cast<const amf_uint8*>(pInBuffer->GetNative()), (amf_size) inSampleCount * sampleSize * planar, inSampleCount);
+    AMF_RETURN_IF_FAILED(err, L"WriteToRing() - writing %d samples failed", inSampleCount);
 
-            // the partial frame is the one we need to add samples into
-            pFrameToFill = m_pPartialFrame;
-            existingSampleCount = m_partialFrameSampleCount;
-        }
-        else
-        {
-            // get a new (well, or recycled) frame to fill
-            AMF_RESULT err = GetNewFrame(&pFrameToFill, requiredSize);
-            AMF_RETURN_IF_FAILED(err, L"SplitOrCombineFrames() - obtaining a new frame failed");
+    // remember where the buffer starts in the stream so frames
+    // cut from it get the right pts and its properties
+    AMFRingInput  input = { AMFDataPtr(pInBuffer), m_ringWriteSample, inSampleCount };
+    m_ringInputs.push_back(input);
+    m_ringWriteSample += inSampleCount;
 
-            // as we're starting a new frame, it's time
-            // to copy the incoming properties into it
-            pInBuffer->CopyTo(pFrameToFill, false);
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::SendRingFrames(amf_int32 maxFrames, bool bAllowShortFrame, amf_int32* pFramesSent)
+{
+    AMF_RETURN_IF_FALSE(m_pCodecContext != nullptr, AMF_NOT_INITIALIZED, L"SendRingFrames() - Codec Context not Initialized");
+    AMF_RETURN_IF_FALSE(pFramesSent != nullptr, AMF_INVALID_ARG, L"SendRingFrames() - pFramesSent == NULL");
 
-            // NOTE: Do we need to update the PTS and duration of
-            //       the new packet at this point?
-            pFrameToFill->SetPts(pInBuffer->GetPts() + inSamplesConsumed * inDuration / inSampleCount);
-        }
+    *pFramesSent = 0;
 
+    const amf_int32  frameSize = m_pCodecContext->frame_size;
+    amf_uint8*       planes[AV_NUM_DATA_POINTERS] = { nullptr };
+    AMF_RETURN_IF_FALSE(m_ring.GetPlanes() <= AV_NUM_DATA_POINTERS, AMF_NOT_SUPPORTED, L"SendRingFrames() - %d planes are not supported", m_ring.GetPlanes());
 
-        //
-        // do the data copy
-        const amf_int32  bufferSamples    = pFrameToFill->GetSampleCount();
-        const amf_int32  samplesAvailable = inSampleCount - inSamplesConsumed;
-        const amf_int32  samplesRequired  = bufferSamples - existingSampleCount;
-        const amf_int32  samplesToCopy    = AMF_MIN(samplesAvailable, samplesRequired);
-        const amf_int32  srcOffset        = inSamplesConsumed * sampleSize * planar;
-        const amf_int32  destOffset       = existingSampleCount * sampleSize * planar;
-        const amf_uint8* pSrcData         = static_cast<amf_uint8*>(pInBuffer->GetNative()) + srcOffset;
-              amf_uint8* pDestData        = static_cast<amf_uint8*>(pFrameToFill->GetNative()) + destOffset;
-        for (amf_int32 ch = 0; ch < planes; ch++)
+    while ((*pFramesSent < maxFrames) && (m_ring.GetAvailable() > 0))
+    {
+        const amf_int32  sampleCount = AMF_MIN(frameSize, m_ring.GetAvailable());
+        if ((sampleCount < frameSize) && !bAllowShortFrame)
         {
-            // copy the data from the frame that came in, into the frame going out
-            memcpy(pDestData, pSrcData, samplesToCopy * sampleSize * planar);
-
-            // update pointers for next plane (if planar format)
-            // otherwise the loop will exit (if non-planar format)
-            pSrcData += inSampleCount * sampleSize * planar;
-            pDestData += bufferSamples * sampleSize * planar;
+            break;
         }
 
-        // update consumed/copied samples information
-        inSamplesConsumed += samplesToCopy;
-        existingSampleCount += samplesToCopy;
+        // find the input buffer the frame starts in
+        while ((m_ringInputs.empty() == false) &&
+               (m_ringInputs.front().firstSample + m_ringInputs.front().sampleCount <= m_ringReadSample))
+        {
+            m_ringInputs.pop_front();
+        }
+        AMF_RETURN_IF_FALSE(m_ringInputs.empty() == false, AMF_UNEXPECTED, L"SendRingFrames() - no input buffer for ring position %" LPRId64 L"", m_ringReadSample);
 
-        // update the pts and duration of the newly created buffer
-        pFrameToFill->SetDuration(existingSampleCount * inDuration / inSampleCount);
+        const AMFRingInput&  input = m_ringInputs.front();
+        const amf_pts        pts   = input.pData->GetPts() + (m_ringReadSample - input.firstSample) * input.pData->GetDuration() / input.sampleCount;
 
+        AMF_RESULT err = m_ring.Peek(sampleCount, planes);
+        AMF_RETURN_IF_FAILED(err, L"SendRingFrames() - Peek() failed");
 
-        //
-        // if the frame is full, add it to the
-        // list of frames ready for the encoder
-        if (existingSampleCount == bufferSamples)
-        {
-            m_preparedFrames.push_back(pFrameToFill);
-            m_pPartialFrame = nullptr;
-            m_partialFrameSampleCount = 0;
-        }
-        else if (existingSampleCount < bufferSamples)
+        AVFrameEx  avFrame;
+        InitializeFrame(planes, sampleCount, pts, avFrame);
+
+        // the frame references the ring instead of being copied by the encoder -
+        // the samples stay held until FFmpeg drops its last reference to them.
+        // One buffer spans all planes of the frame
+        const amf_int32  planar     = IsAudioPlanar(m_inSampleFormat) ? 1 : m_channelCount;
+        const amf_size   planeBytes = (amf_size)sampleCount * GetAudioSampleSize((AMF_AUDIO_FORMAT) m_inSampleFormat) * planar;
+        const amf_size   span       = (amf_size)(planes[m_ring.GetPlanes() - 1] - planes[0]) + planeBytes;
+        avFrame.linesize[0] = (int)planeBytes;
+        avFrame.buf[0] = av_buffer_create(planes[0], span, ReleaseRingFrame, &m_ring, 0);
+        AMF_RETURN_IF_FALSE(avFrame.buf[0] != nullptr, AMF_OUT_OF_MEMORY, L"SendRingFrames() - av_buffer_create() failed");
+
+        // if the frame is refused, releasing our reference below hands back a
+        // pointer the ring does not hold, which it ignores
+        const int  ret = avcodec_send_frame(m_pCodecContext, &avFrame);
+        if (ret == AVERROR(EAGAIN))
         {
-            // otherwise, set the partial frame and exit the
-            // loop as there should be no data left to process
-            m_pPartialFrame = pFrameToFill;
-            m_partialFrameSampleCount = existingSampleCount;
-            break;
+            return AMF_INPUT_FULL;
         }
-        else
+        if (ret == AVERROR_EOF)
         {
-            // we should never really run into this condition
-            // where the existing sample count is more than
-            // the required size
-            AMF_RETURN_IF_FALSE(existingSampleCount <= bufferSamples, AMF_OUT_OF_RANGE, L"SplitOrCombineFrames() - An error occured splitting or combining frames, resulting in a frame larger than expected");
+            return AMF_EOF;
         }
+        char  errBuffer[AV_ERROR_MAX_STRING_SIZE] = { 0 };
+        AMF_RETURN_IF_FALSE(ret >= 0, AMF_FAIL, L"SendRingFrames() - Error sending a frame for encoding - %S", av_make_error_string(errBuffer, sizeof(errBuffer)/sizeof(errBuffer[0]), ret));
+
+        AMFTransitFrame  transitFrame = { input.pData, pts, AMF_SECOND * sampleCount / m_sampleRate };
+        m_inputData.push_back(transitFrame);
+        m_audioFrameSubmitCount++;
+
+        m_ring.Hold(sampleCount, planes[0]);
+        m_ringReadSample += sampleCount;
+        (*pFramesSent)++;
     }
 
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+void AMFAudioEncoderFFMPEGImpl::ReleaseRingFrame(void* opaque, uint8_t* data)
+{
+    static_cast<AMFAudioSampleRing*>(opaque)->ReleaseHeld(data);
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::InitializeFrame(AMFAudioBuffer* pInBuffer, AVFrame& avFrame)
 {
     AMF_RETURN_IF_FALSE(m_pCodecContext != nullptr, AMF_NOT_INITIALIZED, L"InitializeFrame() - Codec Context not Initialized");
@@ -1005,23 +900,35 @@ AMF_RESULT  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::InitializeFrame(AMFAudioBuf
     const amf_int32  planes      = isPlanar ? m_channelCount : 1;
     const amf_int32  sampleSize  = GetAudioSampleSize((AMF_AUDIO_FORMAT) m_inSampleFormat);
     const amf_int32  sampleCount = pInBuffer->GetSampleCount();
+    AMF_RETURN_IF_FALSE(planes <= AV_NUM_DATA_POINTERS, AMF_NOT_SUPPORTED, L"InitializeFrame() - %d planes are not supported", planes);
 
+    // setup the data pointers in the AVFrame
+    amf_uint8*      pPlanes[AV_NUM_DATA_POINTERS] = { nullptr };
+    const amf_size  dstPlaneSize = sampleCount * sampleSize * planar;
+    for (amf_int ch = 0; ch < planes; ch++)
+    {
+        pPlanes[ch] = (amf_uint8*)pInBuffer->GetNative() + ch * dstPlaneSize;
+    }
+    InitializeFrame(pPlanes, sampleCount, pInBuffer->GetPts(), avFrame);
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void  AMF_STD_CALL  AMFAudioEncoderFFMPEGImpl::InitializeFrame(amf_uint8** ppPlanes, amf_int32 sampleCount, amf_pts pts, AVFrame& avFrame)
+{
     avFrame.nb_samples = sampleCount;
     avFrame.format = m_pCodecContext->sample_fmt;
     avFrame.channel_layout = m_pCodecContext->channel_layout;
     avFrame.channels = m_channelCount;
     avFrame.sample_rate = m_sampleRate;
     avFrame.key_frame = 1;
-    avFrame.pts = av_rescale_q(pInBuffer->GetPts(), AMF_TIME_BASE_Q, m_pCodecContext->time_base);
+    avFrame.pts = av_rescale_q(pts, AMF_TIME_BASE_Q, m_pCodecContext->time_base);
 
-    // setup the data pointers in the AVFrame
-    const amf_size  dstPlaneSize = sampleCount * sampleSize * planar;
+    const amf_int32  planes = IsAudioPlanar(m_inSampleFormat) ? m_channelCount : 1;
     for (amf_int ch = 0; ch < planes; ch++)
     {
-        avFrame.data[ch] = (uint8_t *)pInBuffer->GetNative() + ch * dstPlaneSize;
+        avFrame.data[ch] = ppPlanes[ch];
     }
     avFrame.extended_data = avFrame.data;
-
-    return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -36,6 +36,7 @@
 #include "public/include/components/FFMPEGAudioEncoder.h"
 #include "public/common/PropertyStorageExImpl.h"
 #include "public/include/core/Context.h"
+#include "AudioSampleRing.h"
 
 extern "C"
 {
@@ -97,9 +98,12 @@ namespace amf
 
 
     protected:
-        AMF_RESULT  AMF_STD_CALL  GetNewFrame(AMFAudioBuffer** pNewBuffer, amf_int32 requiredSize);
-        AMF_RESULT  AMF_STD_CALL  SplitOrCombineFrames(AMFAudioBuffer* pInBuffer, amf_int32 requiredSize);
+        AMF_RESULT  AMF_STD_CALL  WriteToRing(AMFAudioBuffer* pInBuffer);
+        AMF_RESULT  AMF_STD_CALL  SendRingFrames(amf_int32 maxFrames, bool bAllowShortFrame, amf_int32* pFramesSent);
+        // AVBufferRef free callback of frames sent from the ring, opaque is the ring
+        static void               ReleaseRingFrame(void* opaque, uint8_t* data);
         AMF_RESULT  AMF_STD_CALL  InitializeFrame(AMFAudioBuffer* pInBuffer, AVFrame& avFrame);
+        void        AMF_STD_CALL  InitializeFrame(amf_uint8** ppPlanes, amf_int32 sampleCount, amf_pts pts, AVFrame& avFrame);
 
 
     private:
@@ -108,10 +112,20 @@ namespace amf
       // in QueryOutput, we want to make sure that we match the 
       // input frame that went in with what's coming out, so we 
       // copy the right properties to the right data going out 
+      // pData supplies the properties, pts and duration are those of the frame sent
       struct AMFTransitFrame
       {
           AMFDataPtr  pData;
-          amf_bool    isOriginal;
+          amf_pts     pts;
+          amf_pts     duration;
+      };
+
+      // input buffer whose samples are (partly) still in the ring
+      struct AMFRingInput
+      {
+          AMFDataPtr  pData;
+          amf_int64   firstSample;
+          amf_int32   sampleCount;
       };
 
         AMFContextPtr                 m_pContext;
@@ -130,15 +144,14 @@ namespace amf
 
         // it is possible we need to combine/split input 
         // frames to get them to what the encoder needs
-        // in which case, we need to keep track of the full
-        // frames ready to send to the encoder and to the 
-        // partial frame that still has data that needs to
-        // be filled with the next frame coming in
+        // in which case the samples go through a ring and
+        // the encoder gets frame_size views into it
         amf_bool                      m_samplePreProcRequired;
-        std::list<AMFAudioBufferPtr>  m_preparedFrames;
-        std::list<AMFAudioBufferPtr>  m_recycledFrames;
-        AMFAudioBufferPtr             m_pPartialFrame;
-        amf_int32                     m_partialFrameSampleCount;
+        AMFAudioSampleRing            m_ring;
+        std::list<AMFRingInput>       m_ringInputs;
+        amf_int64                     m_ringReadSample;     // stream position of the ring read pointer
+        amf_int64                     m_ringWriteSample;    // stream position of the ring write pointer
+        amf_int32                     m_framesPerSubmit;
 
         amf_bool                      m_bEof;
 
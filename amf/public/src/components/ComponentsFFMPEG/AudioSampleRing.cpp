@@ -0,0 +1,252 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "AudioSampleRing.h"
+#include "public/common/TraceAdapter.h"
+
+#include <string.h>
+
+#define AMF_FACILITY L"AMFAudioSampleRing"
+
+using namespace amf;
+
+//-------------------------------------------------------------------------------------------------
+AMFAudioSampleRing::AMFAudioSampleRing() :
+    m_iHeld(0),
+    m_iPlanes(0),
+    m_iSampleBytes(0),
+    m_iCapacity(0),
+    m_iMaxFrame(0),
+    m_iPlaneSize(0),
+    m_iRead(0),
+    m_iCount(0)
+{
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFAudioSampleRing::Init(amf_int32 planes, amf_int32 sampleBytes, amf_int32 capacity, amf_int32 maxFrame)
+{
+    AMF_RETURN_IF_FALSE(planes > 0 && sampleBytes > 0, AMF_INVALID_ARG, L"Init() - invalid sample layout planes=%d sampleBytes=%d", planes, sampleBytes);
+    AMF_RETURN_IF_FALSE(maxFrame > 0 && capacity >= maxFrame, AMF_INVALID_ARG, L"Init() - invalid capacity=%d maxFrame=%d", capacity, maxFrame);
+
+    Release();
+    m_iPlanes = planes;
+    m_iSampleBytes = sampleBytes;
+    m_iMaxFrame = maxFrame;
+    return Reserve(capacity);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFAudioSampleRing::Reserve(amf_int32 capacity)
+{
+    AMF_RETURN_IF_FALSE(m_iPlanes > 0, AMF_NOT_INITIALIZED, L"Reserve() - ring not initialized");
+    if (capacity <= m_iCapacity)
+    {
+        return AMF_OK;
+    }
+
+    const amf_size  planeSize = (amf_size)(capacity + m_iMaxFrame) * m_iSampleBytes;
+    amf_vector<amf_uint8>  buffer(planeSize * m_iPlanes);
+
+    // move what we hold to the start of the new planes
+    if (m_iCount > 0)
+    {
+        const amf_int32  firstRun = AMF_MIN(m_iCount, m_iCapacity - m_iRead);
+        for (amf_int32 plane = 0; plane < m_iPlanes; plane++)
+        {
+            amf_uint8* pDst = &buffer[0] + plane * planeSize;
+            memcpy(pDst, Plane(plane) + (amf_size)m_iRead * m_iSampleBytes, (amf_size)firstRun * m_iSampleBytes);
+            memcpy(pDst + (amf_size)firstRun * m_iSampleBytes, Plane(plane), (amf_size)(m_iCount - firstRun) * m_iSampleBytes);
+        }
+    }
+
+    RetireHeld();
+    m_Buffer.swap(buffer);
+    m_iCapacity = capacity;
+    m_iPlaneSize = planeSize;
+    m_iRead = 0;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioSampleRing::Clear()
+{
+    RetireHeld();
+    if (m_Buffer.empty() && m_iCapacity > 0)
+    {
+        m_Buffer.resize(m_iPlaneSize * m_iPlanes);
+    }
+    m_iRead = 0;
+    m_iCount = 0;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioSampleRing::Release()
+{
+    RetireHeld();
+    amf_vector<amf_uint8>().swap(m_Buffer);
+    m_iCapacity = 0;
+    m_iPlaneSize = 0;
+    Clear();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFAudioSampleRing::Write(const amf_uint8* pSrc, amf_size srcPlaneStride, amf_int32 sampleCount)
+{
+    AMF_RETURN_IF_FALSE(pSrc != nullptr, AMF_INVALID_ARG, L"Write() - pSrc == NULL");
+    if (sampleCount == 0)
+    {
+        return AMF_OK;
+    }
+    AMF_RETURN_IF_FALSE(sampleCount >= 0 && sampleCount <= GetFree(), AMF_INPUT_FULL, L"Write() - %d samples do not fit, %d free", sampleCount, GetFree());
+
+    if ((m_iCount == 0) && (GetHeld() == 0))
+    {
+        // keep frames aligned to the start so they don't wrap
+        m_iRead = 0;
+    }
+
+    const amf_int32  write    = (m_iRead + m_iCount) % m_iCapacity;
+    const amf_int32  firstRun = AMF_MIN(sampleCount, m_iCapacity - write);
+    for (amf_int32 plane = 0; plane < m_iPlanes; plane++)
+    {
+        const amf_uint8* pPlaneSrc = pSrc + plane * srcPlaneStride;
+        memcpy(Plane(plane) + (amf_size)write * m_iSampleBytes, pPlaneSrc, (amf_size)firstRun * m_iSampleBytes);
+        memcpy(Plane(plane), pPlaneSrc + (amf_size)firstRun * m_iSampleBytes, (amf_size)(sampleCount - firstRun) * m_iSampleBytes);
+    }
+    m_iCount += sampleCount;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFAudioSampleRing::Peek(amf_int32 sampleCount, amf_uint8** ppPlanes)
+{
+    AMF_RETURN_IF_FALSE(ppPlanes != nullptr, AMF_INVALID_ARG, L"Peek() - ppPlanes == NULL");
+    AMF_RETURN_IF_FALSE(sampleCount > 0 && sampleCount <= m_iCount && sampleCount <= m_iMaxFrame, AMF_OUT_OF_RANGE,
+                        L"Peek() - %d samples requested, %d available, max frame %d", sampleCount, m_iCount, m_iMaxFrame);
+
+    // the run wraps - continue it in the slack past the end of the ring
+    const amf_int32  wrapped = sampleCount - (m_iCapacity - m_iRead);
+    for (amf_int32 plane = 0; plane < m_iPlanes; plane++)
+    {
+        amf_uint8* pPlane = Plane(plane);
+        if (wrapped > 0)
+        {
+            memcpy(pPlane + (amf_size)m_iCapacity * m_iSampleBytes, pPlane, (amf_size)wrapped * m_iSampleBytes);
+        }
+        ppPlanes[plane] = pPlane + (amf_size)m_iRead * m_iSampleBytes;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioSampleRing::Consume(amf_int32 sampleCount)
+{
+    sampleCount = AMF_MIN(sampleCount, m_iCount);
+    {
+        AMFLock lock(&m_HeldSync);
+        if (m_Held.empty() == false)
+        {
+            // behind held frames the space only frees up together with theirs
+            HeldFrame  frame = { nullptr, sampleCount, true };
+            m_Held.push_back(frame);
+            m_iHeld += sampleCount;
+        }
+    }
+    m_iRead = (m_iRead + sampleCount) % m_iCapacity;
+    m_iCount -= sampleCount;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioSampleRing::Hold(amf_int32 sampleCount, const amf_uint8* pPlane0)
+{
+    sampleCount = AMF_MIN(sampleCount, m_iCount);
+    {
+        AMFLock lock(&m_HeldSync);
+        HeldFrame  frame = { pPlane0, sampleCount, false };
+        m_Held.push_back(frame);
+        m_iHeld += sampleCount;
+    }
+    m_iRead = (m_iRead + sampleCount) % m_iCapacity;
+    m_iCount -= sampleCount;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioSampleRing::ReleaseHeld(const amf_uint8* pPlane0)
+{
+    AMFLock lock(&m_HeldSync);
+    for (amf_list<HeldFrame>::iterator it = m_Held.begin(); it != m_Held.end(); it++)
+    {
+        if ((it->pPlane0 == pPlane0) && !it->bReleased)
+        {
+            it->bReleased = true;
+            while ((m_Held.empty() == false) && m_Held.front().bReleased)
+            {
+                m_iHeld -= m_Held.front().sampleCount;
+                m_Held.pop_front();
+            }
+            return;
+        }
+    }
+    for (amf_list<const amf_uint8*>::iterator it = m_RetiredHeld.begin(); it != m_RetiredHeld.end(); it++)
+    {
+        if (*it == pPlane0)
+        {
+            m_RetiredHeld.erase(it);
+            if (m_RetiredHeld.empty())
+            {
+                m_Retired.clear();
+            }
+            return;
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+amf_int32 AMFAudioSampleRing::GetHeld() const
+{
+    AMFLock lock(&m_HeldSync);
+    return m_iHeld;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFAudioSampleRing::RetireHeld()
+{
+    AMFLock lock(&m_HeldSync);
+    bool  bOutstanding = false;
+    for (amf_list<HeldFrame>::const_iterator it = m_Held.begin(); it != m_Held.end(); it++)
+    {
+        if (!it->bReleased)
+        {
+            m_RetiredHeld.push_back(it->pPlane0);
+            bOutstanding = true;
+        }
+    }
+    if (bOutstanding)
+    {
+        m_Retired.push_back(amf_vector<amf_uint8>());
+        m_Retired.back().swap(m_Buffer);
+    }
+    m_Held.clear();
+    m_iHeld = 0;
+}
+//-------------------------------------------------------------------------------------------------
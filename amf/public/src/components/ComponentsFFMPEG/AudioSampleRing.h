@@ -0,0 +1,110 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/Result.h"
+#include "public/common/AMFSTL.h"
+#include "public/common/Thread.h"
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Per-plane ring of audio samples used to re-chunk input into codec frames.
+    // Each plane keeps maxFrame samples of slack past its end, so a frame that
+    // wraps can still be handed out as one contiguous run - the wrapped head is
+    // copied there only when that happens.
+    // Frames can be handed out without a copy with Hold(): their space is reused
+    // only after ReleaseHeld(), which may come from any thread and in any order.
+    // Held frames stay valid across Reserve, Clear and Release - the old storage
+    // is kept until the last of them is released - but not past the destructor.
+    class AMFAudioSampleRing
+    {
+    public:
+        AMFAudioSampleRing();
+
+        // planes - channel count for planar formats, 1 for packed
+        // sampleBytes - bytes of one sample in a plane (all channels for packed formats)
+        AMF_RESULT  Init(amf_int32 planes, amf_int32 sampleBytes, amf_int32 capacity, amf_int32 maxFrame);
+        // grows the ring keeping the samples it holds
+        AMF_RESULT  Reserve(amf_int32 capacity);
+        void        Clear();
+        void        Release();
+
+        amf_int32   GetAvailable() const    { return m_iCount; }
+        amf_int32   GetFree() const         { return m_iCapacity - m_iCount - GetHeld(); }
+        amf_int32   GetPlanes() const       { return m_iPlanes; }
+
+        // plane p of the source starts at pSrc + p * srcPlaneStride
+        AMF_RESULT  Write(const amf_uint8* pSrc, amf_size srcPlaneStride, amf_int32 sampleCount);
+        // ppPlanes receives GetPlanes() pointers to sampleCount contiguous samples
+        // at the read position, valid until the next Write, Reserve or Consume
+        AMF_RESULT  Peek(amf_int32 sampleCount, amf_uint8** ppPlanes);
+        void        Consume(amf_int32 sampleCount);
+        // consumes the sampleCount samples the last Peek returned but keeps their space
+        // until ReleaseHeld() is called with the first plane pointer Peek returned
+        void        Hold(amf_int32 sampleCount, const amf_uint8* pPlane0);
+        // thread safe; pointers that are not held are ignored
+        void        ReleaseHeld(const amf_uint8* pPlane0);
+        amf_int32   GetHeld() const;
+
+    private:
+        struct HeldFrame
+        {
+            const amf_uint8*    pPlane0;
+            amf_int32           sampleCount;
+            bool                bReleased;
+        };
+
+        amf_uint8*  Plane(amf_int32 plane)  { return &m_Buffer[0] + plane * m_iPlaneSize; }
+        // moves the storage of outstanding held frames aside, m_Buffer is empty after it if there were any
+        void        RetireHeld();
+
+        mutable AMFCriticalSection          m_HeldSync;     // held frame bookkeeping, released from any thread
+        amf_list<HeldFrame>                 m_Held;         // in ring order, the space of the released head is reclaimed
+        amf_int32                           m_iHeld;        // samples in m_Held, not free yet
+        amf_list<const amf_uint8*>          m_RetiredHeld;  // held frames in retired storage
+        amf_list<amf_vector<amf_uint8> >    m_Retired;
+
+        amf_vector<amf_uint8>   m_Buffer;
+        amf_int32               m_iPlanes;
+        amf_int32               m_iSampleBytes;
+        amf_int32               m_iCapacity;
+        amf_int32               m_iMaxFrame;
+        amf_size                m_iPlaneSize;       // bytes per plane including the slack
+        amf_int32               m_iRead;
+        amf_int32               m_iCount;
+
+        AMFAudioSampleRing(const AMFAudioSampleRing&);
+        AMFAudioSampleRing& operator=(const AMFAudioSampleRing&);
+    };
+} // namespace amf
@@ -30,49 +30,77 @@ using namespace amf;
 //--------------------------------------------------------------------------------------------------------------------------------
 bool BaseEncoderFFMPEGImpl::SendThread::Process(amf_ulong& /*ulID*/, amf::AMFSurfacePtr& pSurfaceIn, int& /*outData*/)
 {
-    int ret = 0;
-    if (pSurfaceIn == nullptr)
+    // only used to check for stop requests while the encoder is full
+    static const amf_ulong waitTimeout = 50;
+
+    BaseEncoderFFMPEGImpl* pHost = m_pEncoderFFMPEG;
+
+    // NOTE: to drain, we need to submit a NULL frame to avcodec_send_frame call
+    //       Sending the first flush frame will return success.
+    //       Subsequent ones are unnecessary and will return AVERROR_EOF
+    AVFrameEx        avFrame;
+    AVFrame*         pFrame = nullptr;
+    AMFTransitFrame  transitFrame = {};
+    if (pSurfaceIn != nullptr)
     {
-        AMFLock lock(&m_pEncoderFFMPEG->m_SyncAVCodec);
-        // check if it is the end of the stream
-        if (m_pEncoderFFMPEG->m_isEOF)
+        // fill the frame information
+        pHost->InitializeFrame(pSurfaceIn, avFrame);
+        pFrame = &avFrame;
+
+        transitFrame.pts = pSurfaceIn->GetPts();
+        transitFrame.duration = pSurfaceIn->GetDuration();
+        // QueryOutput copies the whole storage to the output buffer: every property the
+        // application set on the input surface travels with the encoded frame, so it
+        // cannot be narrowed to the properties the encoder itself reads
+        if (pSurfaceIn->GetPropertyCount() > 0)
         {
-            // NOTE: to drain, we need to submit a NULL packet to avcodec_send_frame call
-            //       Sending the first flush packet will return success.
-            //       Subsequent ones are unnecessary and will return AVERROR_EOF
-            ret = avcodec_send_frame(m_pEncoderFFMPEG->m_pCodecContext, NULL);
+            transitFrame.pStorage = pHost->AcquireTransitStorage();
+            pSurfaceIn->CopyTo(transitFrame.pStorage, false);
         }
-        return true;
     }
-    // fill the frame information
-    AVFrameEx  avFrame;
-    m_pEncoderFFMPEG->InitializeFrame(pSurfaceIn, avFrame);
-    AMFTransitFrame  transitFrame = {};
-    transitFrame.pStorage = new AMFInterfaceImpl< AMFPropertyStorageImpl <AMFPropertyStorage>>();
-    transitFrame.pts = pSurfaceIn->GetPts();
-    transitFrame.duration = pSurfaceIn->GetDuration();
-    pSurfaceIn->CopyTo(transitFrame.pStorage, true);
-    while(true)
+
+    while (!StopRequested())
     {
+        int ret = 0;
         {// ffmpeg is not thread safe
-            AMFLock lock(&m_pEncoderFFMPEG->m_SyncAVCodec);
-            ret = avcodec_send_frame(m_pEncoderFFMPEG->m_pCodecContext, &avFrame);
+            AMFLock lock(&pHost->m_SyncAVCodec);
+            // a NULL frame only drains at the end of the stream
+            if (pFrame == nullptr && !pHost->m_isEOF)
+            {
+                return true;
+            }
+            if (pHost->m_eSendState == SEND_STATE_DRAINING)
+            {
+                return true;
+            }
 
+            ret = avcodec_send_frame(pHost->m_pCodecContext, pFrame);
             if (ret >= 0)
             {
+                if (pFrame == nullptr)
+                {
+                    pHost->m_eSendState = SEND_STATE_DRAINING;
+                    return true;
+                }
                 // if we did have a frame to submit, and we succeeded
                 // it's time to increment the submitted frames counter
-                if (m_pEncoderFFMPEG->m_pCodecContext->max_b_frames > 0)
+                if (pHost->m_pCodecContext->max_b_frames > 0)
                 {
-                    m_pEncoderFFMPEG->m_inputpts.push_back(transitFrame.pts);
+                    pHost->m_inputpts.push_back(transitFrame.pts);
                 }
-                m_pEncoderFFMPEG->m_inputData.push_back(transitFrame);
-
-                AMFTraceWarning(AMF_FACILITY, L"SendThread::Process() - sent input frame count is %d",
-                    m_pEncoderFFMPEG->m_videoFrameSubmitCount);
-                m_pEncoderFFMPEG->m_videoFrameSubmitCount++;
+                pHost->m_inputData.push_back(transitFrame);
+                pHost->m_videoFrameSubmitCount++;
+                pHost->m_eSendState = SEND_STATE_READY;
                 return true;
             }
+            // NOTE: it is possible the encoder is busy as encoded frames have not
+            //       been taken out yet, so it's possible that it will not accept even
+            //       to start flushing the data yet, so it can return AVERROR(EAGAIN)
+            //       along the normal case when it can't accept a new frame to process
+            if (ret == AVERROR(EAGAIN))
+            {
+                pHost->m_eSendState = SEND_STATE_FULL;
+            }
         }
         //
         // handle the error returns from the encoder
@@ -81,19 +109,14 @@ bool BaseEncoderFFMPEGImpl::SendThread::Process(amf_ulong& /*ulID*/, amf::AMFSur
         {
             return true;
         }
-        // NOTE: it is possible the encoder is busy as encoded frames have not
-        //       been taken out yet, so it's possible that it will not accept even
-        //       to start flushing the data yet, so it can return AVERROR(EAGAIN)
-        //       along the normal case when it can't accept a new frame to process
         if (ret == AVERROR(EAGAIN))
         {
-
-            AMFTraceWarning(AMF_FACILITY, L"SendThread::Process() - input is full");
-            amf_sleep(1);
+            // QueryOutput signals as soon as a packet is taken out
+            pHost->m_PacketTaken.Lock(waitTimeout);
             continue;
         }
         char  errBuffer[AV_ERROR_MAX_STRING_SIZE] = { 0 };
-        AMFTraceWarning(AMF_FACILITY, L"EncoderThread::Run() - Error sending a frame for encoding - %S",
+        AMFTraceWarning(AMF_FACILITY, L"SendThread::Process() - Error sending a frame for encoding - %S",
             av_make_error_string(errBuffer, sizeof(errBuffer) / sizeof(errBuffer[0]), ret));
         return false;
     }
@@ -101,6 +124,34 @@ bool BaseEncoderFFMPEGImpl::SendThread::Process(amf_ulong& /*ulID*/, amf::AMFSur
     return true;
 }
 //-------------------------------------------------------------------------------------------------
+AMFPropertyStoragePtr BaseEncoderFFMPEGImpl::AcquireTransitStorage()
+{
+    AMFLock lock(&m_SyncAVCodec);
+
+    if (m_TransitPool.empty())
+    {
+        return AMFPropertyStoragePtr(new AMFInterfaceImpl< AMFPropertyStorageImpl <AMFPropertyStorage>>());
+    }
+    AMFPropertyStoragePtr pStorage = m_TransitPool.back();
+    m_TransitPool.pop_back();
+    return pStorage;
+}
+//-------------------------------------------------------------------------------------------------
+void BaseEncoderFFMPEGImpl::ReleaseTransitStorage(AMFPropertyStorage* pStorage)
+{
+    // enough for the frames the encoder holds with lookahead and B-frames
+    static const size_t maxPooledStorages = 64;
+
+    AMFLock lock(&m_SyncAVCodec);
+
+    if (pStorage != nullptr && m_TransitPool.size() < maxPooledStorages)
+    {
+        // don't keep interfaces of old frames alive in the pool
+        pStorage->Clear();
+        m_TransitPool.push_back(AMFPropertyStoragePtr(pStorage));
+    }
+}
+//-------------------------------------------------------------------------------------------------
 // we can initialize PA in different modes, for external,
 // internal inside encoder, or various debug modes
 // the template definition that creates this object doesn't
@@ -116,7 +167,8 @@ BaseEncoderFFMPEGImpl::BaseEncoderFFMPEGImpl(AMFContext* pContext)
     m_CodecID(AV_CODEC_ID_NONE),
     m_FrameRate(AMFConstructRate(30, 1)),
     m_firstFramePts(-1LL),
-    m_SendThread(this, &m_SendQueue)
+    m_SendThread(this, &m_SendQueue),
+    m_eSendState(SEND_STATE_READY)
 {
     g_AMFFactory.Init();
 
@@ -155,6 +207,7 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::Init(AMF_SURFACE_FORMAT format,
 
     // reset the forced EOF flag
     m_isEOF = false;
+    m_eSendState = SEND_STATE_READY;
     // reset the first frame pts offset
     m_firstFramePts = -1LL;
 
@@ -207,8 +260,9 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::ReInit(amf_int32 width, amf_int3
 //-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::Terminate()
 {
-    // terminate/clean-up the thread
+    // terminate/clean-up the thread, wake it up if it waits for the encoder
     AMF_RETURN_IF_FALSE(m_SendThread.RequestStop(), AMF_UNEXPECTED, L"Terminate() - m_SendThread.RequestStop()");
+    m_PacketTaken.SetEvent();
     AMF_RETURN_IF_FALSE(m_SendThread.WaitForStop(), AMF_UNEXPECTED, L"Terminate() - m_SendThread.WaitForStop()");
 
     AMFLock lock(&m_Sync);
@@ -227,11 +281,13 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::Terminate()
     m_videoFrameSubmitCount = 0;
     m_videoFrameQueryCount = 0;
     m_isEOF = false;
+    m_eSendState = SEND_STATE_READY;
 
     // clean-up the internal states
     m_firstFramePts = -1LL;
     m_inputData.clear();
     m_inputpts.clear();
+    m_TransitPool.clear();
 
     m_SendQueue.Clear();
 
@@ -251,7 +307,10 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::Drain()
 
     AMFLock lock(&m_Sync);
 
-    m_isEOF = true;
+    {
+        AMFLock lock2(&m_SyncAVCodec); // read by the send thread
+        m_isEOF = true;
+    }
 
     return SubmitInput(nullptr);
 };
@@ -266,6 +325,7 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::Flush()
     //       get any more frames in
     // terminate encoding thread
     AMF_RETURN_IF_FALSE(m_SendThread.RequestStop(), AMF_UNEXPECTED, L"Flush() - m_SendThread.RequestStop()");
+    m_PacketTaken.SetEvent();
     AMF_RETURN_IF_FALSE(m_SendThread.WaitForStop(), AMF_UNEXPECTED, L"Flush() - m_SendThread.WaitForStop()");
 
     // now that we stopped the thread, we should be
@@ -283,6 +343,7 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::Flush()
     m_inputpts.clear();
     m_videoFrameSubmitCount = 0;
     m_videoFrameQueryCount = 0;
+    m_eSendState = SEND_STATE_READY;
 
     m_SendQueue.Clear();
 
@@ -359,6 +420,7 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::SubmitInput(AMFData* pData)
         // no more frames to encode so now it's time to drain the encoder
         // draining the encoder should happen once
         // otherwise an error code will be returned by avcodec_send_frame
+        AMFLock lock2(&m_SyncAVCodec); // read by the send thread
         m_isEOF = true;
     }
 
@@ -430,6 +492,13 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::QueryOutput(AMFData** ppData)
         //       Encoders are allowed to output empty packets, with no
         //       compressed data, containing only side data (e.g. to update
         //       some stream parameters at the end of encoding)."
+        // a packet came out, so the encoder has room for the frame the send thread holds
+        if (ret >= 0 && m_eSendState == SEND_STATE_FULL)
+        {
+            m_eSendState = SEND_STATE_READY;
+            m_PacketTaken.SetEvent();
+        }
+
         if (ret >= 0 && avPacket.size > 0)
         {
             // allocate and fill output buffer - if we fail the memory
@@ -483,12 +552,12 @@ AMF_RESULT AMF_STD_CALL  BaseEncoderFFMPEGImpl::QueryOutput(AMFData** ppData)
                     if ((itNext != m_inputData.end()) &&
                         (abs((amf_int64)(*itNext).pts - (amf_int64)pts) < (pts - inFramePts)))
                     {
-                        (*itNext).pStorage->CopyTo(pBufferOut, false);
                         transitFrame = itNext;
                     }
-                    else
+                    if ((*transitFrame).pStorage != nullptr)
                     {
                         (*transitFrame).pStorage->CopyTo(pBufferOut, false);
+                        ReleaseTransitStorage((*transitFrame).pStorage);
                     }
 
                     // check key frame
@@ -107,6 +107,16 @@ namespace amf
         };
         SendThread              m_SendThread;
 
+        // send side of the encoder, changed under m_SyncAVCodec
+        enum SendState
+        {
+            SEND_STATE_READY,       // avcodec_send_frame accepts input
+            SEND_STATE_FULL,        // EAGAIN - waiting for QueryOutput to take a packet
+            SEND_STATE_DRAINING,    // the NULL frame was sent, no more input
+        };
+        SendState               m_eSendState;
+        AMFEvent                m_PacketTaken;      // set by QueryOutput when the send thread is waiting in SEND_STATE_FULL
+
       mutable AMFCriticalSection        m_Sync;
 
       // in QueryOutput, we want to make sure that we match the
@@ -118,11 +128,14 @@ namespace amf
       // just imagine you queue 15 x 8k frames
       struct AMFTransitFrame
       {
-          AMFPropertyStoragePtr pStorage;
+          AMFPropertyStoragePtr pStorage;   // NULL if the surface had no properties
           amf_pts               pts;
           amf_pts               duration;
       };
 
+        AMFPropertyStoragePtr   AcquireTransitStorage();
+        void                    ReleaseTransitStorage(AMFPropertyStorage* pStorage);
+
         AMFContextPtr                   m_spContext;
         amf_bool                        m_bEncodingEnabled;
 
@@ -133,6 +146,7 @@ namespace amf
         mutable AMFCriticalSection      m_SyncAVCodec;
         amf_list<AMFTransitFrame>       m_inputData;
         amf_list<amf_pts>               m_inputpts; // contains monotonically increasing PTS in decode order
+        amf_vector<AMFPropertyStoragePtr> m_TransitPool; // guarded by m_SyncAVCodec
 
         amf_pts                         m_firstFramePts;
 
@@ -0,0 +1,786 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "BitstreamConverter.h"
+#include "public/common/TraceAdapter.h"
+
+#include <string.h>
+
+#define AMF_FACILITY L"AMFBitstreamConverter"
+
+using namespace amf;
+
+namespace
+{
+    const amf_uint8 AV1_OBU_TEMPORAL_DELIMITER      = 2;
+    const amf_uint8 AV1_OBU_FRAME_HEADER            = 3;
+    const amf_uint8 AV1_OBU_FRAME                   = 6;
+    const amf_uint8 AV1_OBU_HAS_SIZE_FIELD          = 0x02;
+    const amf_uint8 AV1_OBU_EXTENSION_FLAG          = 0x04;
+
+    const amf_size  START_CODE_SIZE                 = 4;
+
+    //-------------------------------------------------------------------------------------------------
+    inline amf_uint32 ReadBE(const amf_uint8* p, amf_int32 bytes)
+    {
+        amf_uint32 value = 0;
+        for (amf_int32 i = 0; i < bytes; i++)
+        {
+            value = (value << 8) | p[i];
+        }
+        return value;
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline void WriteBE(amf_uint8* p, amf_uint32 value, amf_int32 bytes)
+    {
+        for (amf_int32 i = bytes - 1; i >= 0; i--)
+        {
+            p[i] = (amf_uint8)value;
+            value >>= 8;
+        }
+    }
+    //-------------------------------------------------------------------------------------------------
+    // returns the number of bytes read, 0 if the value is truncated
+    inline amf_size ReadLeb128(const amf_uint8* p, const amf_uint8* pEnd, amf_uint64* pValue)
+    {
+        amf_uint64 value = 0;
+        for (amf_size i = 0; i < 8 && p + i < pEnd; i++)
+        {
+            value |= (amf_uint64)(p[i] & 0x7f) << (i * 7);
+            if ((p[i] & 0x80) == 0)
+            {
+                *pValue = value;
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline amf_size Leb128Size(amf_uint64 value)
+    {
+        amf_size bytes = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            bytes++;
+        }
+        return bytes;
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline amf_size WriteLeb128(amf_uint8* p, amf_uint64 value)
+    {
+        amf_size bytes = 0;
+        do
+        {
+            amf_uint8 byte = (amf_uint8)(value & 0x7f);
+            value >>= 7;
+            if (value != 0)
+            {
+                byte |= 0x80;
+            }
+            p[bytes++] = byte;
+        } while (value != 0);
+        return bytes;
+    }
+    //-------------------------------------------------------------------------------------------------
+    // returns the position of the next 00 00 01 or pEnd
+    inline const amf_uint8* FindStartCode(const amf_uint8* p, const amf_uint8* pEnd)
+    {
+        const amf_uint8* pLast = pEnd - 2;
+        while (p < pLast)
+        {
+            // a byte above 1 at p[2] rules out a start code at p, p+1 and p+2
+            if (p[2] > 1)
+            {
+                p += 3;
+            }
+            else if (p[1] != 0)
+            {
+                p += 2;
+            }
+            else if (p[0] != 0 || p[2] != 1)
+            {
+                p++;
+            }
+            else
+            {
+                return p;
+            }
+        }
+        return pEnd;
+    }
+    //-------------------------------------------------------------------------------------------------
+    inline bool StartsWithStartCode(const amf_uint8* p, amf_size size)
+    {
+        if (size < 3 || p[0] != 0 || p[1] != 0)
+        {
+            return false;
+        }
+        return p[2] == 1 || (size > 3 && p[2] == 0 && p[3] == 1);
+    }
+    //-------------------------------------------------------------------------------------------------
+    // true when the NAL length prefixes tile the packet exactly; "00 00 01" alone is not enough to
+    // tell the forms apart - it is also the 4 byte length of any NAL unit of 256-511 bytes
+    inline bool IsLengthPrefixed(const amf_uint8* p, amf_size size, amf_int32 lengthSize)
+    {
+        if (lengthSize == 4 && size >= 4 && p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 1)
+        {
+            return false;   // 4 byte start code, a 1 byte NAL unit is not valid
+        }
+        amf_size pos = 0;
+        while (pos < size)
+        {
+            if ((amf_size)lengthSize > size - pos)
+            {
+                return false;
+            }
+            const amf_size unitSize = ReadBE(p + pos, lengthSize);
+            pos += lengthSize;
+            if (unitSize == 0 || unitSize > size - pos)
+            {
+                return false;
+            }
+            pos += unitSize;
+        }
+        return true;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+AMFBitstreamConverter::AMFBitstreamConverter() :
+    m_eCodec(CODEC_UNKNOWN),
+    m_eInFormat(FORMAT_ANNEXB),
+    m_eOutFormat(FORMAT_ANNEXB),
+    m_iLengthSize(4),
+    m_bPrependPending(false),
+    m_pScanned(NULL),
+    m_iScannedSize(0),
+    m_iOutSize(0),
+    m_bPassThrough(true),
+    m_bPrepend(false)
+{
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::Init(Codec codec, Format inFormat, Format outFormat, const amf_uint8* pExtraData, amf_size extraDataSize)
+{
+    Terminate();
+
+    m_eInFormat = inFormat;
+    m_eOutFormat = outFormat;
+
+    if (pExtraData != NULL && extraDataSize > 0)
+    {
+        switch (codec)
+        {
+        case CODEC_H264:
+        case CODEC_HEVC:
+            if (StartsWithStartCode(pExtraData, extraDataSize))
+            {
+                // already Annex B - keep as is
+                m_ParameterSets.assign(pExtraData, pExtraData + extraDataSize);
+            }
+            else if (codec == CODEC_H264)
+            {
+                AMF_RETURN_IF_FAILED(ParseAvcC(pExtraData, extraDataSize));
+            }
+            else
+            {
+                AMF_RETURN_IF_FAILED(ParseHvcC(pExtraData, extraDataSize));
+            }
+            break;
+        case CODEC_AV1:
+            // av1C configOBUs repeat the in-band sequence header, nothing to keep
+            AMF_RETURN_IF_FALSE((pExtraData[0] & 0x80) != 0, AMF_INVALID_FORMAT, L"Init() - invalid av1C marker");
+            break;
+        default:
+            AMF_RETURN_IF_FALSE(false, AMF_NOT_SUPPORTED, L"Init() - unsupported codec %d", (int)codec);
+        }
+    }
+
+    m_eCodec = codec;
+    m_bPrependPending = !m_ParameterSets.empty();
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFBitstreamConverter::Terminate()
+{
+    m_eCodec = CODEC_UNKNOWN;
+    m_iLengthSize = 4;
+    m_ParameterSets.clear();
+    m_bPrependPending = false;
+    m_Units.clear();
+    m_pScanned = NULL;
+    m_iScannedSize = 0;
+    m_iOutSize = 0;
+    m_bPassThrough = true;
+    m_bPrepend = false;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::ParseAvcC(const amf_uint8* pData, amf_size size)
+{
+    AMF_RETURN_IF_FALSE(size >= 7 && pData[0] == 1, AMF_INVALID_FORMAT, L"ParseAvcC() - invalid avcC record size=%d", (int)size);
+
+    m_iLengthSize = (pData[4] & 0x3) + 1;
+    AMF_RETURN_IF_FALSE(m_iLengthSize != 3, AMF_INVALID_FORMAT, L"ParseAvcC() - invalid NAL length size");
+
+    amf_size pos = 5;
+    for (int set = 0; set < 2; set++) // SPS then PPS
+    {
+        AMF_RETURN_IF_FALSE(pos < size, AMF_INVALID_FORMAT, L"ParseAvcC() - truncated avcC record");
+        amf_uint32 count = (set == 0) ? (pData[pos] & 0x1f) : pData[pos];
+        pos++;
+        if (count == 0)
+        {
+            AMFTraceWarning(AMF_FACILITY, L"ParseAvcC() - %s NALU missing. The resulting stream may not play.", set == 0 ? L"SPS" : L"PPS");
+        }
+        for (amf_uint32 i = 0; i < count; i++)
+        {
+            AMF_RETURN_IF_FALSE(pos + 2 <= size, AMF_INVALID_FORMAT, L"ParseAvcC() - truncated avcC record");
+            const amf_size unitSize = ReadBE(pData + pos, 2);
+            pos += 2;
+            AMF_RETURN_IF_FALSE(unitSize <= size - pos, AMF_INVALID_FORMAT, L"ParseAvcC() - truncated avcC record");
+            AddParameterSet(pData + pos, unitSize);
+            pos += unitSize;
+        }
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::ParseHvcC(const amf_uint8* pData, amf_size size)
+{
+    AMF_RETURN_IF_FALSE(size >= 23 && pData[0] == 1, AMF_INVALID_FORMAT, L"ParseHvcC() - invalid hvcC record size=%d", (int)size);
+
+    m_iLengthSize = (pData[21] & 0x3) + 1;
+    AMF_RETURN_IF_FALSE(m_iLengthSize != 3, AMF_INVALID_FORMAT, L"ParseHvcC() - invalid NAL length size");
+
+    const amf_uint32 arrays = pData[22];
+    amf_size pos = 23;
+    for (amf_uint32 array = 0; array < arrays; array++)
+    {
+        AMF_RETURN_IF_FALSE(pos + 3 <= size, AMF_INVALID_FORMAT, L"ParseHvcC() - truncated hvcC record");
+        const amf_uint32 count = ReadBE(pData + pos + 1, 2); // skip array_completeness and NAL_unit_type
+        pos += 3;
+        for (amf_uint32 i = 0; i < count; i++)
+        {
+            AMF_RETURN_IF_FALSE(pos + 2 <= size, AMF_INVALID_FORMAT, L"ParseHvcC() - truncated hvcC record");
+            const amf_size unitSize = ReadBE(pData + pos, 2);
+            pos += 2;
+            AMF_RETURN_IF_FALSE(unitSize <= size - pos, AMF_INVALID_FORMAT, L"ParseHvcC() - truncated hvcC record");
+            AddParameterSet(pData + pos, unitSize);
+            pos += unitSize;
+        }
+    }
+    if (m_ParameterSets.empty())
+    {
+        AMFTraceWarning(AMF_FACILITY, L"ParseHvcC() - no parameter sets in hvcC. The resulting stream may not play.");
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFBitstreamConverter::AddParameterSet(const amf_uint8* pData, amf_size size)
+{
+    const amf_size pos = m_ParameterSets.size();
+    m_ParameterSets.resize(pos + START_CODE_SIZE + size);
+    WriteBE(&m_ParameterSets[pos], 1, START_CODE_SIZE);
+    memcpy(&m_ParameterSets[pos + START_CODE_SIZE], pData, size);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::GetOutputSize(const amf_uint8* pIn, amf_size inSize, amf_size* pOutSize)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pOutSize);
+    AMF_RETURN_IF_FAILED(Scan(pIn, inSize));
+    *pOutSize = m_iOutSize;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::Convert(const amf_uint8* pIn, amf_size inSize, amf_uint8* pOut, amf_size outSize, amf_size* pWritten)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pOut);
+    if (pIn != m_pScanned || inSize != m_iScannedSize)
+    {
+        AMF_RETURN_IF_FAILED(Scan(pIn, inSize));
+    }
+    AMF_RETURN_IF_FALSE(outSize >= m_iOutSize, AMF_INVALID_ARG, L"Convert() - output buffer too small %d < %d", (int)outSize, (int)m_iOutSize);
+
+    amf_size written = m_iOutSize;
+    if (m_bPassThrough)
+    {
+        memcpy(pOut, pIn, inSize);
+    }
+    else
+    {
+        written = Write(pIn, pOut);
+    }
+    if (m_bPrepend)
+    {
+        m_bPrependPending = false;
+    }
+    m_pScanned = NULL;
+
+    if (pWritten != NULL)
+    {
+        *pWritten = written;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::ConvertInPlace(amf_uint8* pData, amf_size size)
+{
+    AMF_RETURN_IF_FAILED(Scan(pData, size));
+    m_pScanned = NULL;
+
+    if (m_bPassThrough)
+    {
+        return AMF_OK;
+    }
+    if (IsInPlace() == false)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+
+    // every 4 byte length becomes a 4 byte start code or the other way round
+    const bool bAnnexB = m_eOutFormat == FORMAT_ANNEXB;
+    for (amf_vector<Unit>::const_iterator it = m_Units.begin(); it != m_Units.end(); ++it)
+    {
+        WriteBE(pData + it->offset - START_CODE_SIZE, bAnnexB ? 1 : (amf_uint32)it->size, START_CODE_SIZE);
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::Filter(const amf_uint8* pIn, amf_size inSize, const amf_uint8** ppOut, amf_size* pOutSize)
+{
+    AMF_RETURN_IF_INVALID_POINTER(ppOut);
+    AMF_RETURN_IF_INVALID_POINTER(pOutSize);
+    AMF_RETURN_IF_FAILED(Scan(pIn, inSize));
+
+    if (m_bPassThrough)
+    {
+        m_pScanned = NULL;
+        *ppOut = pIn;
+        *pOutSize = inSize;
+        return AMF_OK;
+    }
+
+    // the buffer only grows - later packets reuse it
+    if (m_OutBuffer.size() < m_iOutSize)
+    {
+        m_OutBuffer.resize(m_iOutSize);
+    }
+    amf_size written = 0;
+    AMF_RETURN_IF_FAILED(Convert(pIn, inSize, m_OutBuffer.data(), m_OutBuffer.size(), &written));
+
+    *ppOut = m_OutBuffer.data();
+    *pOutSize = written;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::Scan(const amf_uint8* pIn, amf_size inSize)
+{
+    m_Units.clear();
+    m_pScanned = NULL;
+    m_iScannedSize = inSize;
+    m_iOutSize = inSize;
+    m_bPassThrough = true;
+    m_bPrepend = false;
+
+    AMF_RETURN_IF_FALSE(pIn != NULL || inSize == 0, AMF_INVALID_POINTER, L"Scan() - NULL input");
+
+    if (m_eCodec == CODEC_UNKNOWN || m_eInFormat == m_eOutFormat || inSize == 0)
+    {
+        m_pScanned = pIn;
+        return AMF_OK;
+    }
+
+    if (m_eCodec == CODEC_AV1)
+    {
+        if (m_eInFormat == FORMAT_ANNEXB)
+        {
+            AMF_RETURN_IF_FAILED(ScanObuAnnexB(pIn, inSize));
+        }
+        else
+        {
+            AMF_RETURN_IF_FAILED(ScanObus(pIn, inSize));
+            MarkFrameUnits();
+        }
+    }
+    else
+    {
+        // input already in the output form is passed through
+        const bool bLengthPrefixed = IsLengthPrefixed(pIn, inSize, m_iLengthSize);
+        const bool bOutputForm = (m_eInFormat == FORMAT_ANNEXB) ? bLengthPrefixed : (!bLengthPrefixed && StartsWithStartCode(pIn, inSize));
+        if (bOutputForm)
+        {
+            m_pScanned = pIn;
+            return AMF_OK;
+        }
+
+        if (m_eInFormat == FORMAT_ANNEXB)
+        {
+            AMF_RETURN_IF_FAILED(ScanStartCodes(pIn, inSize));
+        }
+        else
+        {
+            AMF_RETURN_IF_FAILED(ScanLengthPrefixed(pIn, inSize));
+        }
+
+        if (m_eOutFormat == FORMAT_ANNEXB && m_bPrependPending)
+        {
+            for (amf_vector<Unit>::const_iterator it = m_Units.begin(); it != m_Units.end(); ++it)
+            {
+                if (IsPicture(it->type))
+                {
+                    m_bPrepend = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    m_bPassThrough = false;
+    m_iOutSize = ComputeOutputSize();
+    m_pScanned = pIn;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::ScanLengthPrefixed(const amf_uint8* pIn, amf_size inSize)
+{
+    const amf_size lengthSize = (amf_size)m_iLengthSize;
+    amf_size pos = 0;
+    while (pos < inSize)
+    {
+        AMF_RETURN_IF_FALSE(lengthSize <= inSize - pos, AMF_INVALID_FORMAT, L"ScanLengthPrefixed() - truncated NAL length at %d", (int)pos);
+        const amf_size unitSize = ReadBE(pIn + pos, m_iLengthSize);
+        pos += lengthSize;
+        AMF_RETURN_IF_FALSE(unitSize <= inSize - pos, AMF_INVALID_FORMAT, L"ScanLengthPrefixed() - NAL size %d past the end", (int)unitSize);
+        if (unitSize == 0)
+        {
+            continue;
+        }
+
+        Unit unit = {};
+        unit.offset = pos;
+        unit.size = unitSize;
+        unit.type = (m_eCodec == CODEC_H264) ? (pIn[pos] & 0x1f) : ((pIn[pos] >> 1) & 0x3f);
+        m_Units.push_back(unit);
+        pos += unitSize;
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::ScanStartCodes(const amf_uint8* pIn, amf_size inSize)
+{
+    const amf_uint8* pEnd = pIn + inSize;
+    const amf_uint8* pStart = FindStartCode(pIn, pEnd);
+    while (pStart < pEnd)
+    {
+        const amf_uint8* pUnit = pStart + 3;
+        pStart = FindStartCode(pUnit, pEnd);
+
+        // drop trailing_zero_8bits and the leading zero of a 4 byte start code
+        const amf_uint8* pUnitEnd = pStart;
+        while (pUnitEnd > pUnit && pUnitEnd[-1] == 0)
+        {
+            pUnitEnd--;
+        }
+        if (pUnitEnd == pUnit)
+        {
+            continue;
+        }
+
+        Unit unit = {};
+        unit.offset = pUnit - pIn;
+        unit.size = pUnitEnd - pUnit;
+        unit.type = (m_eCodec == CODEC_H264) ? (pUnit[0] & 0x1f) : ((pUnit[0] >> 1) & 0x3f);
+        AMF_RETURN_IF_FALSE(m_iLengthSize == 4 || unit.size < ((amf_size)1 << (8 * m_iLengthSize)), AMF_INVALID_FORMAT,
+            L"ScanStartCodes() - NAL size %d does not fit %d length bytes", (int)unit.size, m_iLengthSize);
+        m_Units.push_back(unit);
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::ScanObus(const amf_uint8* pIn, amf_size inSize)
+{
+    amf_size pos = 0;
+    while (pos < inSize)
+    {
+        AMF_RETURN_IF_FAILED(AddObu(pIn, pos, inSize, START_NONE, &pos));
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::ScanObuAnnexB(const amf_uint8* pIn, amf_size inSize)
+{
+    const amf_uint8* pEnd = pIn + inSize;
+    amf_size pos = 0;
+    while (pos < inSize)
+    {
+        amf_uint64 temporalUnitSize = 0;
+        amf_size bytes = ReadLeb128(pIn + pos, pEnd, &temporalUnitSize);
+        AMF_RETURN_IF_FALSE(bytes > 0 && temporalUnitSize <= inSize - pos - bytes, AMF_INVALID_FORMAT, L"ScanObuAnnexB() - invalid temporal_unit_size");
+        pos += bytes;
+        const amf_size temporalUnitEnd = pos + (amf_size)temporalUnitSize;
+
+        while (pos < temporalUnitEnd)
+        {
+            amf_uint64 frameUnitSize = 0;
+            bytes = ReadLeb128(pIn + pos, pIn + temporalUnitEnd, &frameUnitSize);
+            AMF_RETURN_IF_FALSE(bytes > 0 && frameUnitSize <= temporalUnitEnd - pos - bytes, AMF_INVALID_FORMAT, L"ScanObuAnnexB() - invalid frame_unit_size");
+            pos += bytes;
+            const amf_size frameUnitEnd = pos + (amf_size)frameUnitSize;
+
+            while (pos < frameUnitEnd)
+            {
+                amf_uint64 obuLength = 0;
+                bytes = ReadLeb128(pIn + pos, pIn + frameUnitEnd, &obuLength);
+                AMF_RETURN_IF_FALSE(bytes > 0 && obuLength <= frameUnitEnd - pos - bytes, AMF_INVALID_FORMAT, L"ScanObuAnnexB() - invalid obu_length");
+                pos += bytes;
+                const amf_size obuEnd = pos + (amf_size)obuLength;
+
+                amf_size next = 0;
+                AMF_RETURN_IF_FAILED(AddObu(pIn, pos, obuEnd, START_NONE, &next));
+                pos = obuEnd;
+            }
+        }
+    }
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFBitstreamConverter::AddObu(const amf_uint8* pIn, amf_size offset, amf_size end, amf_uint8 start, amf_size* pNext)
+{
+    AMF_RETURN_IF_FALSE(offset < end, AMF_INVALID_FORMAT, L"AddObu() - empty OBU");
+
+    Unit unit = {};
+    unit.header[0] = pIn[offset] & ~AV1_OBU_HAS_SIZE_FIELD;
+    unit.headerSize = (pIn[offset] & AV1_OBU_EXTENSION_FLAG) != 0 ? 2 : 1;
+    unit.type = (pIn[offset] >> 3) & 0xf;
+    unit.start = start;
+    AMF_RETURN_IF_FALSE(unit.headerSize <= end - offset, AMF_INVALID_FORMAT, L"AddObu() - truncated OBU header");
+    if (unit.headerSize > 1)
+    {
+        unit.header[1] = pIn[offset + 1];
+    }
+
+    amf_size pos = offset + unit.headerSize;
+    if ((pIn[offset] & AV1_OBU_HAS_SIZE_FIELD) != 0)
+    {
+        amf_uint64 obuSize = 0;
+        const amf_size bytes = ReadLeb128(pIn + pos, pIn + end, &obuSize);
+        AMF_RETURN_IF_FALSE(bytes > 0 && obuSize <= end - pos - bytes, AMF_INVALID_FORMAT, L"AddObu() - invalid obu_size");
+        pos += bytes;
+        unit.size = (amf_size)obuSize;
+    }
+    else
+    {
+        // without obu_size the OBU runs to the end of the enclosing unit
+        unit.size = end - pos;
+    }
+    unit.offset = pos;
+    m_Units.push_back(unit);
+
+    *pNext = pos + unit.size;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFBitstreamConverter::MarkFrameUnits()
+{
+    // a temporal unit starts at a temporal delimiter, a frame unit at each frame header after the first
+    bool bFrameSeen = false;
+    for (amf_size i = 0; i < m_Units.size(); i++)
+    {
+        Unit& unit = m_Units[i];
+        if (i == 0 || unit.type == AV1_OBU_TEMPORAL_DELIMITER)
+        {
+            unit.start = START_TEMPORAL_UNIT;
+            bFrameSeen = false;
+        }
+        if (unit.type == AV1_OBU_FRAME_HEADER || unit.type == AV1_OBU_FRAME)
+        {
+            if (bFrameSeen && unit.start == START_NONE)
+            {
+                unit.start = START_FRAME_UNIT;
+            }
+            bFrameSeen = true;
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
+amf_size AMFBitstreamConverter::ComputeOutputSize()
+{
+    amf_size total = 0;
+    if (m_eCodec != CODEC_AV1)
+    {
+        const amf_size prefixSize = (m_eOutFormat == FORMAT_ANNEXB) ? START_CODE_SIZE : (amf_size)m_iLengthSize;
+        for (amf_vector<Unit>::const_iterator it = m_Units.begin(); it != m_Units.end(); ++it)
+        {
+            total += prefixSize + it->size;
+        }
+        if (m_bPrepend)
+        {
+            total += m_ParameterSets.size();
+        }
+        return total;
+    }
+
+    if (m_eOutFormat == FORMAT_LENGTH_PREFIXED)
+    {
+        for (amf_vector<Unit>::const_iterator it = m_Units.begin(); it != m_Units.end(); ++it)
+        {
+            total += it->headerSize + Leb128Size(it->size) + it->size;
+        }
+        return total;
+    }
+
+    // Annex B sizes nest - OBUs add up to frame units, frame units to temporal units
+    amf_size frameUnit = 0;
+    for (amf_size i = 0; i < m_Units.size(); i++)
+    {
+        if (m_Units[i].start != START_NONE)
+        {
+            frameUnit = i;
+        }
+        const amf_size obuLength = m_Units[i].headerSize + m_Units[i].size;
+        m_Units[frameUnit].frameUnitSize += Leb128Size(obuLength) + obuLength;
+    }
+    amf_size temporalUnit = 0;
+    for (amf_size i = 0; i < m_Units.size(); i++)
+    {
+        if (m_Units[i].start == START_TEMPORAL_UNIT)
+        {
+            temporalUnit = i;
+        }
+        if (m_Units[i].start != START_NONE)
+        {
+            m_Units[temporalUnit].temporalUnitSize += Leb128Size(m_Units[i].frameUnitSize) + m_Units[i].frameUnitSize;
+        }
+    }
+    for (amf_vector<Unit>::const_iterator it = m_Units.begin(); it != m_Units.end(); ++it)
+    {
+        if (it->start == START_TEMPORAL_UNIT)
+        {
+            total += Leb128Size(it->temporalUnitSize) + it->temporalUnitSize;
+        }
+    }
+    return total;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFBitstreamConverter::IsPicture(amf_uint8 type) const
+{
+    if (m_eCodec == CODEC_H264)
+    {
+        return type == 1 || type == 5 || type == 6; // slice, IDR slice, SEI
+    }
+    return type < 32 || type == 39; // VCL, prefix SEI
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFBitstreamConverter::IsInPlace() const
+{
+    if (m_eCodec == CODEC_AV1 || m_iLengthSize != 4 || m_bPrepend)
+    {
+        return false;
+    }
+    // every unit has to sit right after a 4 byte prefix with nothing in between
+    amf_size expected = 0;
+    for (amf_vector<Unit>::const_iterator it = m_Units.begin(); it != m_Units.end(); ++it)
+    {
+        if (it->offset != expected + START_CODE_SIZE)
+        {
+            return false;
+        }
+        expected = it->offset + it->size;
+    }
+    return expected == m_iScannedSize;
+}
+//-------------------------------------------------------------------------------------------------
+amf_size AMFBitstreamConverter::Write(const amf_uint8* pIn, amf_uint8* pOut) const
+{
+    amf_uint8* p = pOut;
+    if (m_eCodec != CODEC_AV1)
+    {
+        bool bPrepend = m_bPrepend;
+        for (amf_vector<Unit>::const_iterator it = m_Units.begin(); it != m_Units.end(); ++it)
+        {
+            if (m_eOutFormat == FORMAT_ANNEXB)
+            {
+                if (bPrepend && IsPicture(it->type))
+                {
+                    memcpy(p, m_ParameterSets.data(), m_ParameterSets.size());
+                    p += m_ParameterSets.size();
+                    bPrepend = false;
+                }
+                WriteBE(p, 1, START_CODE_SIZE);
+                p += START_CODE_SIZE;
+            }
+            else
+            {
+                WriteBE(p, (amf_uint32)it->size, m_iLengthSize);
+                p += m_iLengthSize;
+            }
+            memcpy(p, pIn + it->offset, it->size);
+            p += it->size;
+        }
+        return p - pOut;
+    }
+
+    const bool bAnnexB = m_eOutFormat == FORMAT_ANNEXB;
+    for (amf_vector<Unit>::const_iterator it = m_Units.begin(); it != m_Units.end(); ++it)
+    {
+        if (bAnnexB)
+        {
+            if (it->start == START_TEMPORAL_UNIT)
+            {
+                p += WriteLeb128(p, it->temporalUnitSize);
+            }
+            if (it->start != START_NONE)
+            {
+                p += WriteLeb128(p, it->frameUnitSize);
+            }
+            p += WriteLeb128(p, it->headerSize + it->size);
+            *p++ = it->header[0];
+        }
+        else
+        {
+            *p++ = it->header[0] | AV1_OBU_HAS_SIZE_FIELD;
+        }
+        if (it->headerSize > 1)
+        {
+            *p++ = it->header[1];
+        }
+        if (bAnnexB == false)
+        {
+            p += WriteLeb128(p, it->size);
+        }
+        memcpy(p, pIn + it->offset, it->size);
+        p += it->size;
+    }
+    return p - pOut;
+}
@@ -0,0 +1,139 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/Result.h"
+#include "public/common/AMFSTL.h"
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // Converts access units between the start code and the length-prefixed forms:
+    //   H.264 / HEVC - Annex B start codes <-> avcC / hvcC length prefixes
+    //   AV1          - Annex B length-delimited <-> Section 5 low-overhead OBUs
+    // The output size is computed by a scan of the unit headers, then the output
+    // is written in one pass into a caller buffer, the internal buffer or in place.
+    class AMFBitstreamConverter
+    {
+    public:
+        enum Codec
+        {
+            CODEC_UNKNOWN = 0,
+            CODEC_H264,
+            CODEC_HEVC,
+            CODEC_AV1,
+        };
+        enum Format
+        {
+            FORMAT_ANNEXB = 0,          // start codes, AV1: Annex B length-delimited
+            FORMAT_LENGTH_PREFIXED,     // avcC / hvcC NAL length prefixes, AV1: Section 5 OBUs
+        };
+
+        AMFBitstreamConverter();
+
+        // pExtraData - avcC / hvcC / av1C record or Annex B parameter sets, may be NULL;
+        // parameter sets from it are put in front of the first picture when converting to Annex B
+        AMF_RESULT  Init(Codec codec, Format inFormat, Format outFormat, const amf_uint8* pExtraData, amf_size extraDataSize);
+        void        Terminate();
+        // put the parameter sets in front of the next picture again, e.g. after a seek
+        void        Reset()                                 { m_bPrependPending = !m_ParameterSets.empty(); }
+
+        AMF_RESULT  GetOutputSize(const amf_uint8* pIn, amf_size inSize, amf_size* pOutSize);
+        // call GetOutputSize() first with the same input - the scan it did is reused
+        AMF_RESULT  Convert(const amf_uint8* pIn, amf_size inSize, amf_uint8* pOut, amf_size outSize, amf_size* pWritten);
+        // only when the size stays the same (4 byte lengths and start codes, no parameter sets to add)
+        // returns AMF_NOT_SUPPORTED otherwise and leaves the data untouched
+        AMF_RESULT  ConvertInPlace(amf_uint8* pData, amf_size size);
+        // converts into a buffer owned by the converter, valid until the next call
+        AMF_RESULT  Filter(const amf_uint8* pIn, amf_size inSize, const amf_uint8** ppOut, amf_size* pOutSize);
+
+        amf_int32                       GetLengthSize() const       { return m_iLengthSize; }
+        // parameter sets from the extra data in Annex B form
+        const amf_vector<amf_uint8>&    GetParameterSets() const    { return m_ParameterSets; }
+
+    private:
+        enum UnitStart
+        {
+            START_NONE = 0,
+            START_FRAME_UNIT,       // AV1 Annex B frame_unit()
+            START_TEMPORAL_UNIT,    // AV1 Annex B temporal_unit(), also starts a frame unit
+        };
+        struct Unit
+        {
+            amf_size    offset;             // NAL unit or OBU payload in the input
+            amf_size    size;
+            amf_uint8   type;
+            amf_uint8   header[2];          // AV1 OBU header without obu_has_size_field and extension
+            amf_uint8   headerSize;
+            amf_uint8   start;              // UnitStart
+            amf_size    frameUnitSize;      // AV1 Annex B output sizes, set on the starting unit
+            amf_size    temporalUnitSize;
+        };
+
+        AMF_RESULT  Scan(const amf_uint8* pIn, amf_size inSize);
+        AMF_RESULT  ScanLengthPrefixed(const amf_uint8* pIn, amf_size inSize);
+        AMF_RESULT  ScanStartCodes(const amf_uint8* pIn, amf_size inSize);
+        AMF_RESULT  ScanObus(const amf_uint8* pIn, amf_size inSize);
+        AMF_RESULT  ScanObuAnnexB(const amf_uint8* pIn, amf_size inSize);
+        AMF_RESULT  AddObu(const amf_uint8* pIn, amf_size offset, amf_size end, amf_uint8 start, amf_size* pNext);
+        void        MarkFrameUnits();
+        amf_size    ComputeOutputSize();
+        bool        IsPicture(amf_uint8 type) const;
+        bool        IsInPlace() const;
+        amf_size    Write(const amf_uint8* pIn, amf_uint8* pOut) const;
+
+        AMF_RESULT  ParseAvcC(const amf_uint8* pData, amf_size size);
+        AMF_RESULT  ParseHvcC(const amf_uint8* pData, amf_size size);
+        void        AddParameterSet(const amf_uint8* pData, amf_size size);
+
+        Codec                   m_eCodec;
+        Format                  m_eInFormat;
+        Format                  m_eOutFormat;
+        amf_int32               m_iLengthSize;
+        amf_vector<amf_uint8>   m_ParameterSets;
+        bool                    m_bPrependPending;
+
+        // result of the last Scan()
+        amf_vector<Unit>        m_Units;
+        const amf_uint8*        m_pScanned;
+        amf_size                m_iScannedSize;
+        amf_size                m_iOutSize;
+        bool                    m_bPassThrough;
+        bool                    m_bPrepend;
+
+        amf_vector<amf_uint8>   m_OutBuffer;
+
+        AMFBitstreamConverter(const AMFBitstreamConverter&);
+        AMFBitstreamConverter& operator=(const AMFBitstreamConverter&);
+    };
+} // namespace amf
@@ -129,10 +129,10 @@ const AMFEnumDescriptionEntry AMF_STREAM_TYPE_ENUM_DESCRIPTION[] =
 };
 
 
+// frees a packet without returning it to the demuxer pool
 void  ClearPacket(AVPacket* pPacket)
 {
-    av_packet_unref(pPacket);
-    delete pPacket;
+    av_packet_free(&pPacket);
 }
 
 
@@ -148,7 +148,8 @@ AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::AMFOutputDemuxerImpl(AMFFileDemu
     : m_pHost(pHost),
       m_iIndexFFmpeg(index),
       m_bEnabled(false),
-      m_iPacketCount(0)
+      m_iPacketCount(0),
+      m_readAheadBytes(0)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -166,6 +167,31 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::QueryOu
     AMF_RETURN_IF_FALSE(m_pHost->m_pInputContext != NULL, AMF_NOT_INITIALIZED, L"QueryOutput() - Input Context not Initialized");
     AMF_RETURN_IF_FALSE(m_pHost->m_bStreamingMode, AMF_NOT_SUPPORTED, L"QueryOutput() - Individual stream output has been disabled");
 
+    if (m_pHost->m_bReadAhead)
+    {
+        // the reader thread owns the file, only our own queue is locked here;
+        // read the reader result first so the last buffers are not lost
+        const AMF_RESULT readerResult = m_pHost->m_ReaderResult;
+        AMFBufferPtr buf;
+        {
+            AMFLock queueLock(&m_queueSync);
+            if (!m_readAheadQueue.empty())
+            {
+                buf = m_readAheadQueue.front();
+                m_readAheadQueue.pop_front();
+                m_readAheadBytes -= buf->GetSize();
+            }
+        }
+        if (buf == NULL)
+        {
+            return readerResult == AMF_OK ? AMF_REPEAT : readerResult;
+        }
+        m_pHost->m_ReaderSpace.SetEvent();
+
+        *ppData = buf.Detach();
+        m_iPacketCount++;
+        return AMF_OK;
+    }
 
     AMFLock lock(&m_pHost->m_sync);
 
@@ -203,7 +229,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::QueryOu
     err = m_pHost->BufferFromPacket(packet, &buf);
     if (err != AMF_OK)
     {
-        ClearPacket(packet);
+        m_pHost->ReleasePacket(packet);
         return err;
     }
 
@@ -211,7 +237,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::QueryOu
     *ppData = buf;
     (*ppData)->Acquire();
 
-    ClearPacket(packet);
+    m_pHost->ReleasePacket(packet);
 
     m_iPacketCount++;
     return AMF_OK;
@@ -226,7 +252,7 @@ AMF_RESULT  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::CachePacket(AVPacket
 
     if(!m_bEnabled)
     {
-        ClearPacket(pPacket);
+        m_pHost->ReleasePacket(pPacket);
         return AMF_FAIL;
     }
        // add the packet to the cache...
@@ -241,12 +267,41 @@ void  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::ClearPacketCache()
         ClearPacket(*it);
     }
     m_packetsCache.clear();
+
+    AMFLock lock(&m_queueSync);
+    m_readAheadQueue.clear();
+    m_readAheadBytes = 0;
 }
 bool        AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::IsCached()
 {
     return m_packetsCache.size() != 0;
 }
 //-------------------------------------------------------------------------------------------------
+void  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::PushReadAhead(AMFBuffer* pBuffer)
+{
+    AMFLock lock(&m_queueSync);
+    m_readAheadQueue.push_back(AMFBufferPtr(pBuffer));
+    m_readAheadBytes += pBuffer->GetSize();
+}
+//-------------------------------------------------------------------------------------------------
+bool  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::IsReadAheadFull(amf_int64 maxBytes, amf_pts maxDuration)
+{
+    AMFLock lock(&m_queueSync);
+    if (m_readAheadQueue.empty())
+    {
+        return false;
+    }
+    if (maxBytes > 0 && (amf_int64)m_readAheadBytes >= maxBytes)
+    {
+        return true;
+    }
+    if (maxDuration > 0 && m_readAheadQueue.back()->GetPts() - m_readAheadQueue.front()->GetPts() >= maxDuration)
+    {
+        return true;
+    }
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
 void        AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::OnPropertyChanged(const wchar_t* pName)
 {
     const amf_wstring  name(pName);
@@ -254,6 +309,8 @@ void        AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl::OnProp
     {
         AMFLock lock(&m_pHost->m_sync);
         AMFPropertyStorage::GetProperty(AMF_STREAM_ENABLED, &m_bEnabled);
+        // the reader waits while no output is enabled
+        m_pHost->m_ReaderSpace.SetEvent();
     }
 }
 //-------------------------------------------------------------------------------------------------
@@ -423,6 +480,45 @@ AMFFileDemuxerFFMPEGImpl::AMFAudioOutputDemuxerImpl::AMFAudioOutputDemuxerImpl(A
 
 
 
+//
+//
+// AMFDataOutputDemuxerImpl
+//
+//
+
+//-------------------------------------------------------------------------------------------------
+AMFFileDemuxerFFMPEGImpl::AMFDataOutputDemuxerImpl::AMFDataOutputDemuxerImpl(AMFFileDemuxerFFMPEGImpl* pHost, amf_int32 index)
+    : AMFFileDemuxerFFMPEGImpl::AMFOutputDemuxerImpl(pHost, index)
+{
+    const AVStream* ist = pHost->m_pInputContext->streams[index];
+
+    // allocate a buffer to store the extra data
+    AMFBufferPtr spBuffer;
+    if (ist->codecpar->extradata_size != 0)
+    {
+        AMF_RESULT err = m_pHost->m_pContext->AllocBuffer(AMF_MEMORY_HOST, ist->codecpar->extradata_size, &spBuffer);
+        if ((err == AMF_OK) && spBuffer->GetNative())
+        {
+            memcpy(spBuffer->GetNative(), ist->codecpar->extradata, ist->codecpar->extradata_size);
+        }
+    }
+
+    AMFPrimitivePropertyInfoMapBegin
+        AMFPropertyInfoEnum(AMF_STREAM_TYPE, L"Stream Type", AMF_STREAM_DATA, AMF_STREAM_TYPE_ENUM_DESCRIPTION, false),
+        AMFPropertyInfoBool(AMF_STREAM_ENABLED, L"Enabled", false, true),
+        AMFPropertyInfoInt64(AMF_STREAM_CODEC_ID, L"Codec ID", ist->codecpar->codec_id, AV_CODEC_ID_NONE, INT_MAX, false),
+        AMFPropertyInfoInt64(AMF_STREAM_BIT_RATE, L"Bit Rate", ist->codecpar->bit_rate, 0, INT_MAX, false),
+        AMFPropertyInfoInterface(AMF_STREAM_EXTRA_DATA, L"Extra Data", NULL, false),
+    AMFPrimitivePropertyInfoMapEnd
+
+    SetProperty(AMF_STREAM_CODEC_ID, ist->codecpar->codec_id);
+    SetProperty(AMF_STREAM_BIT_RATE, ist->codecpar->bit_rate);
+
+    AMFPropertyStorage::SetProperty(AMF_STREAM_EXTRA_DATA, spBuffer);
+}
+
+
+
 //
 //
 // AMFFileDemuxerFFMPEGImpl
@@ -433,6 +529,7 @@ AMFFileDemuxerFFMPEGImpl::AMFAudioOutputDemuxerImpl::AMFAudioOutputDemuxerImpl(A
 AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
   : m_pContext(pContext),
     m_pInputContext(NULL),
+    m_pInputIO(NULL),
     m_ptsDuration(0),
     m_ptsPosition(0),
     m_ptsSeekPos(-1),
@@ -443,7 +540,14 @@ AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
     m_iVideoStreamIndexFFmpeg(-1),
     m_iAudioStreamIndexFFmpeg(-1),
     m_bTerminated(true),
-    m_bStreaming(false)
+    m_bStreaming(false),
+    m_bZeroCopy(false),
+    m_bReadAhead(false),
+    m_ReaderResult(AMF_OK),
+    m_pReader(NULL),
+    m_iReadAheadMaxBytes(32 * 1024 * 1024),
+    m_ptsReadAheadMaxDuration(2 * AMF_SECOND),
+    m_pIndexer(NULL)
 //    m_bSyncAV(false)
 {
     g_AMFFactory.Init();
@@ -451,6 +555,7 @@ AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
     AMFPrimitivePropertyInfoMapBegin
         AMFPropertyInfoPath(FFMPEG_DEMUXER_PATH, L"File Path", L"", false),
         AMFPropertyInfoPath(FFMPEG_DEMUXER_URL, L"Stream URL", L"", false),
+        AMFPropertyInfoInterface(FFMPEG_DEMUXER_INPUT_STREAM, L"Input Stream", NULL, false),
 
         AMFPropertyInfoInt64(FFMPEG_DEMUXER_START_FRAME, L"StartFrame", 0, 0, LLONG_MAX, true),
         AMFPropertyInfoInt64(FFMPEG_DEMUXER_FRAME_COUNT, L"FramesNumber", 0, 0, LLONG_MAX, true),
@@ -458,7 +563,14 @@ AMFFileDemuxerFFMPEGImpl::AMFFileDemuxerFFMPEGImpl(AMFContext* pContext)
 //        AMFPropertyInfoBool(FFMPEG_DEMUXER_SYNC_AV, L"Sync Audio and Video by PTS", false, false),
         AMFPropertyInfoBool(FFMPEG_DEMUXER_CHECK_MVC, L"Check MVC", true, false),
         AMFPropertyInfoBool(FFMPEG_DEMUXER_INDIVIDUAL_STREAM_MODE, L"Stream mode", true, false),
-        AMFPropertyInfoBool(FFMPEG_DEMUXER_LISTEN, L"Listen", false, false)
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_LISTEN, L"Listen", false, false),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_ZERO_COPY, L"Zero copy output", false, true),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_ALL_STREAMS, L"All streams", false, false),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_READ_AHEAD, L"Read ahead", false, false),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_READ_AHEAD_MAX_BYTES, L"Read ahead max bytes", 32 * 1024 * 1024, 0, LLONG_MAX, true),
+        AMFPropertyInfoInt64(FFMPEG_DEMUXER_READ_AHEAD_MAX_DURATION, L"Read ahead max duration", 2 * AMF_SECOND, 0, LLONG_MAX, true),
+        AMFPropertyInfoBool(FFMPEG_DEMUXER_KEYFRAME_INDEX, L"Keyframe index", false, false),
+        AMFPropertyInfoPath(FFMPEG_DEMUXER_KEYFRAME_INDEX_PATH, L"Keyframe index path", L"", false)
 
     AMFPrimitivePropertyInfoMapEnd
 
@@ -469,6 +581,12 @@ AMFFileDemuxerFFMPEGImpl::~AMFFileDemuxerFFMPEGImpl()
 {
     Terminate();
     Close();
+
+    for (amf_vector<AVPacket*>::iterator it = m_PacketPool.begin(); it != m_PacketPool.end(); ++it)
+    {
+        ClearPacket(*it);
+    }
+    m_PacketPool.clear();
     g_AMFFactory.Terminate();
 }
 //-------------------------------------------------------------------------------------------------
@@ -481,6 +599,12 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*for
         Close();
     }
 
+    bool bReadAhead = false;
+    GetProperty(FFMPEG_DEMUXER_READ_AHEAD, &bReadAhead);
+    GetProperty(FFMPEG_DEMUXER_READ_AHEAD_MAX_BYTES, &m_iReadAheadMaxBytes);
+    GetProperty(FFMPEG_DEMUXER_READ_AHEAD_MAX_DURATION, &m_ptsReadAheadMaxDuration);
+    m_bReadAhead = bReadAhead && m_bStreamingMode;
+
     AMF_RESULT res = Open();
     if (res == AMF_OK)
     {
@@ -488,6 +612,8 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*for
         Seek(pos, AMF_SEEK_PREV, -1);
 
         ReadRangeSettings();
+
+        StartReader();
     }
 
     return res;
@@ -503,6 +629,9 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Terminate()
 {
     AMFLock lock(&m_sync);
 
+    StopReader();
+    m_bReadAhead = false;
+
     m_ptsPosition = GetMinPosition();
     m_ptsSeekPos = -1;
     m_bTerminated = true;
@@ -523,7 +652,12 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Flush()
 {
     AMFLock lock(&m_sync);
 
+    const bool bRestart = StopReader();
     ClearCachedPackets();
+    if (bRestart)
+    {
+        StartReader();
+    }
 
     return AMF_OK;
 }
@@ -570,7 +704,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::QueryOutput(AMFData** ppData)
     AMF_RESULT err = BufferFromPacket(pPacket, &buf);
     if (err != AMF_OK)
     {
-        ClearPacket(pPacket);
+        ReleasePacket(pPacket);
         return err;
     }
 
@@ -578,7 +712,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::QueryOutput(AMFData** ppData)
     *ppData = buf;
     (*ppData)->Acquire();
 
-    ClearPacket(pPacket);
+    ReleasePacket(pPacket);
 
     return AMF_OK;
 }
@@ -606,6 +740,9 @@ AMF_RESULT AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::Seek(amf_pts ptsPos, AMF_SEEK_
         return AMF_OK;
     }
 
+    const bool bRestart = StopReader();
+
+    const AMFKeyframeIndex::Entry* pKeyframe = NULL;
     int flags = 0;
     switch (eType)
     {
@@ -640,26 +777,41 @@ AMF_RESULT AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::Seek(amf_pts ptsPos, AMF_SEEK_
         AVStream*  ist    = m_pInputContext->streams[stream_index];
         int64_t    offset = av_rescale_q(ptsPos, AMF_TIME_BASE_Q, ist->time_base);
 
+        // with a keyframe index jump straight to the keyframe's byte offset,
+        // packets before ptsPos are then marked as "Seeking" for exact landing
+        if (stream_index == m_KeyframeIndex.GetStreamIndex())
+        {
+            pKeyframe = (eType == AMF_SEEK_NEXT_KEYFRAME) ? m_KeyframeIndex.FindNext(offset) : m_KeyframeIndex.FindPrev(offset);
+        }
+
         // AVSEEK_FLAG_BACKWARD means that we need packet before ptsPos
-        int ret = av_seek_frame(m_pInputContext, stream_index, offset, flags);
+        int ret = (pKeyframe != NULL) ? av_seek_frame(m_pInputContext, stream_index, pKeyframe->pos, AVSEEK_FLAG_BYTE)
+                                      : av_seek_frame(m_pInputContext, stream_index, offset, flags);
         if (ret<0)
         {
             // sometimes failed av_seek_frame cause further av_read functions return errors too.
             AMFTraceError(AMF_FACILITY, L"Seek() - failed. Reinitialize ffmpeg context.");
             Close();
             Open();
+            pKeyframe = NULL;
         }
         else
         {
             ClearCachedPackets();
         }
     }
-    m_iPacketCount = 0;
+    // streams without timestamps get their dts from the packet count
+    m_iPacketCount = (pKeyframe != NULL) ? pKeyframe->frame : 0;
     m_ptsPosition = ptsPos;
 
     ReadRangeSettings();
 
     m_ptsSeekPos = ptsPos;
+
+    if (bRestart)
+    {
+        StartReader();
+    }
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
@@ -782,7 +934,7 @@ void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::OnPropertyChanged(const wchar_t* pN
     AMFLock lock(&m_sync);
 
     const amf_wstring  name(pName);
-    if (name == FFMPEG_DEMUXER_PATH || name == FFMPEG_DEMUXER_URL)
+    if (name == FFMPEG_DEMUXER_PATH || name == FFMPEG_DEMUXER_URL || name == FFMPEG_DEMUXER_INPUT_STREAM)
     {
 //        m_OutputStreams.clear();
 //        ReInit(0, 0);
@@ -794,6 +946,26 @@ void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::OnPropertyChanged(const wchar_t* pN
         GetProperty(FFMPEG_DEMUXER_INDIVIDUAL_STREAM_MODE, &m_bStreamingMode);
         return;
     }
+
+    if (name == FFMPEG_DEMUXER_ZERO_COPY)
+    {
+        GetProperty(FFMPEG_DEMUXER_ZERO_COPY, &m_bZeroCopy);
+        return;
+    }
+
+    if (name == FFMPEG_DEMUXER_READ_AHEAD_MAX_BYTES)
+    {
+        GetProperty(FFMPEG_DEMUXER_READ_AHEAD_MAX_BYTES, &m_iReadAheadMaxBytes);
+        m_ReaderSpace.SetEvent();
+        return;
+    }
+
+    if (name == FFMPEG_DEMUXER_READ_AHEAD_MAX_DURATION)
+    {
+        GetProperty(FFMPEG_DEMUXER_READ_AHEAD_MAX_DURATION, &m_ptsReadAheadMaxDuration);
+        m_ReaderSpace.SetEvent();
+        return;
+    }
 }
 
 
@@ -815,11 +987,23 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
     GetPropertyWString(FFMPEG_DEMUXER_URL, &Url);
     GetPropertyWString(FFMPEG_DEMUXER_PATH, &Path);
 
+    AMFInterfacePtr pInterface;
+    GetProperty(FFMPEG_DEMUXER_INPUT_STREAM, &pInterface);
+    AMFDataStreamPtr pInputStream(pInterface);
+
     amf_string convertedfilename;
     bool bListen = false;
     const AVInputFormat* file_iformat = NULL;
     bool bStreaming = false;
-    if(Url.length() >0)
+    if (pInputStream != NULL)
+    {
+        if (m_pInputStream == pInputStream)
+        {
+            return AMF_OK;
+        }
+        Url = L"InputStream";
+    }
+    else if(Url.length() >0)
     {
         if (m_Url == Url)
         {
@@ -875,7 +1059,11 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
     // try open the file, if it fails, return error code
     AVInputFormat* fmt               = NULL;
     amf_bool bImageFormat = false;
-    AMF_RESULT res = OpenFile(convertedfilename, fmt, options, bImageFormat);
+    AMF_RESULT res = (pInputStream != NULL) ? OpenInputStream(pInputStream) : AMF_OK;
+    if (res == AMF_OK)
+    {
+        res = OpenFile(convertedfilename, fmt, options, bImageFormat);
+    }
     AMF_RETURN_IF_FALSE(res==AMF_OK && m_pInputContext!=NULL, AMF_INVALID_ARG, L"Open() failed to open file %s", Url.c_str());
 
     if(file_iformat!= NULL)
@@ -888,25 +1076,36 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
         res = OpenAsImageSequence(convertedfilename, fmt, options);
     }
 
+    bool bAllStreams = false;
+    GetProperty(FFMPEG_DEMUXER_ALL_STREAMS, &bAllStreams);
+
     int videoIndex = -1;
     amf_vector<AMFOutputDemuxerImplPtr>  outputStreams;
     for (amf_int32 i = 0; i < static_cast<amf_int32>(m_pInputContext->nb_streams); i++)
     {
         const AVStream* ist = m_pInputContext->streams[i];
         AMFOutputDemuxerImplPtr newOutput;
-        if (ist->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && m_iVideoStreamIndexFFmpeg == i)
+        if (ist->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && (m_iVideoStreamIndexFFmpeg == i || bAllStreams))
         {
             if (ist->codecpar->format == AV_PIX_FMT_BGR24)
                 continue;
 
             newOutput = new AMFVideoOutputDemuxerImpl(this, i);
-            videoIndex = i;
+            if (m_iVideoStreamIndexFFmpeg == i)
+            {
+                videoIndex = (int)outputStreams.size();
+            }
         }
 
-        if (ist->codecpar->codec_type == AVMEDIA_TYPE_AUDIO && m_iAudioStreamIndexFFmpeg == i)
+        if (ist->codecpar->codec_type == AVMEDIA_TYPE_AUDIO && (m_iAudioStreamIndexFFmpeg == i || bAllStreams))
         {
             newOutput = new AMFAudioOutputDemuxerImpl(this, i);
         }
+
+        if ((ist->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE || ist->codecpar->codec_type == AVMEDIA_TYPE_DATA) && bAllStreams)
+        {
+            newOutput = new AMFDataOutputDemuxerImpl(this, i);
+        }
         if(newOutput != NULL)
         {
             for(amf_vector<AMFOutputDemuxerImplPtr>::iterator it = m_OutputStreams.begin(); it != m_OutputStreams.end(); it++)
@@ -924,7 +1123,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
 
 
 
-    if (m_iVideoStreamIndexFFmpeg >= 0 && m_pInputContext->streams[m_iVideoStreamIndexFFmpeg]->codecpar->codec_id == AV_CODEC_ID_H264)
+    if (videoIndex >= 0 && m_pInputContext->streams[m_iVideoStreamIndexFFmpeg]->codecpar->codec_id == AV_CODEC_ID_H264)
     {
         bool checkMVC = true;
         GetProperty(FFMPEG_DEMUXER_CHECK_MVC, &checkMVC);
@@ -961,6 +1160,15 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Open()
 //    GetProperty(FFMPEG_DEMUXER_SYNC_AV, &m_bSyncAV);
     SetProperty(FFMPEG_DEMUXER_DURATION, m_ptsDuration);
 
+    // the index seeks by byte offset, formats that cannot do that have a usable index anyway
+    bool bKeyframeIndex = false;
+    GetProperty(FFMPEG_DEMUXER_KEYFRAME_INDEX, &bKeyframeIndex);
+    if (bKeyframeIndex && !bStreaming && m_pInputStream == NULL && !bImageFormat && m_iVideoStreamIndexFFmpeg >= 0 &&
+        (m_pInputContext->iformat->flags & AVFMT_NO_BYTE_SEEK) == 0)
+    {
+        OpenKeyframeIndex(convertedfilename, Path);
+    }
+
     // trace info about file and number of streams
     AMFTrace(AMF_TRACE_INFO, AMF_FACILITY, L"Open(%s) succeeded; streams=%d", Url.c_str(), m_pInputContext->nb_streams);
 
@@ -971,11 +1179,16 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::Close()
 {
     AMFLock lock(&m_sync);
 
+    StopReader();
+    StopIndexer();
+    m_KeyframeIndex.Clear();
+
     if (m_pInputContext != NULL)
     {
         avformat_close_input(&m_pInputContext);
         m_pInputContext = NULL;
     }
+    CloseInputStream();
 
     ClearCachedPackets();
 
@@ -996,13 +1209,20 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReadPacket(AVPacket **packet)
 {
     *packet = NULL;
 
-    AVPacket  pkt ={};
-    pkt.dts = AV_NOPTS_VALUE;
-    pkt.pts = AV_NOPTS_VALUE;
+    if (m_bForceEof)
+    {
+        return AMF_EOF;
+    }
+
+    AVPacket* pPacket = AllocPacket();
+    AMF_RETURN_IF_INVALID_POINTER(pPacket, L"ReadPacket() - av_packet_alloc failed");
+
+    AVPacket& pkt = *pPacket;
 //    amf_pts currTime = amf_high_precision_clock();
-    if (m_bForceEof || av_read_frame(m_pInputContext, &pkt) < 0)
+    if (av_read_frame(m_pInputContext, &pkt) < 0)
     {
 //        AMFTraceInfo(AMF_FACILITY, L"ReadPacket() - EOF, END");
+        ReleasePacket(pPacket);
         return AMF_EOF;
     }
 //    amf_pts readDuration = amf_high_precision_clock() - currTime;
@@ -1018,22 +1238,8 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReadPacket(AVPacket **packet)
     if (pkt.stream_index == m_iVideoStreamIndexFFmpeg)
     {
 //        AMFTraceWarning(AMF_FACILITY, L"ReadPacket() video pts=%" LPRId64 L", dts=% " LPRId64 L" first_dts=%" LPRId64 , pkt.pts, pkt.dts, ist->first_dts);
-        if (pkt.dts == AV_NOPTS_VALUE)
-        {
-            pkt.dts = av_rescale(m_iPacketCount, ist->time_base.den, (int64_t)ist->time_base.num);
-            pkt.dts = av_rescale(pkt.dts, ist->r_frame_rate.den, (int64_t)ist->r_frame_rate.num);
-        }
-        else
-        {
-            if (pkt.pts != AV_NOPTS_VALUE && pkt.dts != AV_NOPTS_VALUE && pkt.dts<0)
-            {
-                pkt.dts += wrap;
-            }
-            if (fst->first_dts != AV_NOPTS_VALUE)
-            {
-                pkt.dts -= fst->first_dts;
-            }
-        }
+        // shared with the keyframe index so its entries match what we output
+        pkt.dts = AMFKeyframeIndex::NormalizeDts(ist, &pkt, m_iPacketCount);
         m_iPacketCount++;
     }
     else
@@ -1060,16 +1266,228 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReadPacket(AVPacket **packet)
     }
     if (OutOfRange())
     {
+        ReleasePacket(pPacket);
         return AMF_EOF;
     }
 
 
-    *packet = new AVPacket;
-    memcpy(*packet, &pkt, sizeof(pkt));
+    *packet = pPacket;
 
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AVPacket* AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::AllocPacket()
+{
+    if (m_PacketPool.empty())
+    {
+        return av_packet_alloc();
+    }
+    AVPacket* pPacket = m_PacketPool.back();
+    m_PacketPool.pop_back();
+    return pPacket;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReleasePacket(AVPacket* pPacket)
+{
+    // the pool only has to cover the packets in flight between ReadPacket and
+    // QueryOutput plus what the stream caches hold
+    static const size_t maxPooledPackets = 64;
+
+    av_packet_unref(pPacket);
+    if (m_PacketPool.size() < maxPooledPackets)
+    {
+        m_PacketPool.push_back(pPacket);
+    }
+    else
+    {
+        av_packet_free(&pPacket);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::StartReader()
+{
+    AMFLock lock(&m_sync);
+
+    if (!m_bReadAhead || m_pReader != NULL || m_pInputContext == NULL)
+    {
+        return;
+    }
+    m_ReaderResult = AMF_OK;
+    m_pReader = new AMFReaderThread(this);
+    m_pReader->Start();
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::StopReader()
+{
+    AMFLock lock(&m_sync);
+
+    if (m_pReader == NULL)
+    {
+        return false;
+    }
+    // the reader only takes m_sync with a timeout, so it's safe to wait while holding it
+    m_pReader->RequestStop();
+    m_ReaderSpace.SetEvent();
+    m_pReader->WaitForStop();
+    delete m_pReader;
+    m_pReader = NULL;
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::IsReadAheadFull()
+{
+    // the next packet can belong to any output, so reading only pauses once every
+    // enabled output is at its limit - a slow consumer never holds back the others;
+    // with no output enabled yet (Init starts the reader) nothing is read, otherwise
+    // the packets would be dropped before the application enables its outputs
+    for (size_t idx = 0; idx < m_OutputStreams.size(); idx++)
+    {
+        AMFOutputDemuxerImpl* pOutput = m_OutputStreams[idx];
+        if (!pOutput->m_bEnabled)
+        {
+            continue;
+        }
+        if (!pOutput->IsReadAheadFull(m_iReadAheadMaxBytes, m_ptsReadAheadMaxDuration))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::ReadAhead(AMFThread* pThread)
+{
+    static const amf_ulong lockTimeout = 50;
+
+    while (!pThread->StopRequested())
+    {
+        AMFLock lock(&m_sync, lockTimeout);
+        if (!lock.IsLocked())
+        {
+            continue;
+        }
+
+        // backpressure: wait until a consumer takes something
+        if (IsReadAheadFull())
+        {
+            lock.Unlock();
+            m_ReaderSpace.Lock(lockTimeout);
+            continue;
+        }
+
+        // packets cached before the reader started (CheckH264MVC) go out first
+        AVPacket*                pPacket = nullptr;
+        AMFOutputDemuxerImplPtr  pOutput;
+        for (size_t idx = 0; idx < m_OutputStreams.size(); idx++)
+        {
+            if (!m_OutputStreams[idx]->m_packetsCache.empty())
+            {
+                pOutput = m_OutputStreams[idx];
+                pPacket = pOutput->m_packetsCache.front();
+                pOutput->m_packetsCache.pop_front();
+                break;
+            }
+        }
+
+        if (!pPacket)
+        {
+            AMF_RESULT err = FindNextPacket(-1, &pPacket, false);
+            if (err != AMF_OK)
+            {
+                if (err != AMF_EOF)
+                {
+                    AMFTraceError(AMF_FACILITY, L"ReadAhead() - reading failed, err=%s", AMFGetResultText(err));
+                }
+                m_ReaderResult = err;
+                break;
+            }
+            pOutput = m_OutputStreams[FromFFmpegToOutputIndex(pPacket->stream_index)];
+        }
+
+        if (!pOutput->m_bEnabled)
+        {
+            ReleasePacket(pPacket);
+            continue;
+        }
+
+        AMFBufferPtr buf;
+        AMF_RESULT err = BufferFromPacket(pPacket, &buf);
+        ReleasePacket(pPacket);
+        if (err != AMF_OK)
+        {
+            AMFTraceError(AMF_FACILITY, L"ReadAhead() - BufferFromPacket() failed, err=%s", AMFGetResultText(err));
+            m_ReaderResult = err;
+            break;
+        }
+        pOutput->PushReadAhead(buf);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::OpenKeyframeIndex(const amf_string& url, const amf_wstring& path)
+{
+    AMFLock lock(&m_sync);
+
+    AMFKeyframeIndex::Source source;
+    if (AMFKeyframeIndex::Identify(url.c_str(), m_iVideoStreamIndexFFmpeg, &source) != AMF_OK)
+    {
+        return;
+    }
+
+    amf_wstring indexPath;
+    GetPropertyWString(FFMPEG_DEMUXER_KEYFRAME_INDEX_PATH, &indexPath);
+    if (indexPath.empty())
+    {
+        indexPath = path + L".amfkfi";
+    }
+    const amf_string indexUrl = amf_string("file:") + amf_from_unicode_to_utf8(indexPath);
+
+    // a valid cache is used right away, otherwise build it without blocking Open()
+    if (m_KeyframeIndex.Load(indexUrl.c_str(), source) == AMF_OK)
+    {
+        return;
+    }
+    StopIndexer();
+    m_pIndexer = new AMFIndexThread(this, url, indexUrl, source);
+    m_pIndexer->Start();
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::StopIndexer()
+{
+    AMFLock lock(&m_sync);
+
+    if (m_pIndexer != NULL)
+    {
+        // the indexer only takes m_sync with a timeout, so it's safe to wait while holding it
+        m_pIndexer->RequestStop();
+        m_pIndexer->WaitForStop();
+        delete m_pIndexer;
+        m_pIndexer = NULL;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void AMFFileDemuxerFFMPEGImpl::AMFIndexThread::Run()
+{
+    AMFKeyframeIndex index;
+    if (index.Build(m_Url.c_str(), m_Source, this) != AMF_OK)
+    {
+        return;
+    }
+    if (index.Save(m_IndexPath.c_str()) != AMF_OK)
+    {
+        AMFTraceWarning(AMF_FACILITY, L"Keyframe index is not cached, it will be rebuilt on next open");
+    }
+
+    while (!StopRequested())
+    {
+        AMFLock lock(&m_pHost->m_sync, 50);
+        if (lock.IsLocked())
+        {
+            m_pHost->m_KeyframeIndex.Swap(index);
+            break;
+        }
+    }
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::FindNextPacket(amf_int32 streamIndex, AVPacket **packet, bool saveSkipped)
 {
     // clear the return pointer in case we
@@ -1100,20 +1518,17 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::FindNextPacket(amf_int32 stre
 
         // we got a valid packet, assign it to
         // the appropriate cache/queue
-        // NOTE: for now we skip all streams
-        //       except 1 video and 1 audio
+        // NOTE: streams without an output (everything except
+        //       1 video and 1 audio unless FFMPEG_DEMUXER_ALL_STREAMS is set) are skipped
         const amf_int32  packetStreamIndex = pTempPacket->stream_index;
-        if ( ((m_iVideoStreamIndexFFmpeg != -1) && (packetStreamIndex == m_iVideoStreamIndexFFmpeg))
-            ||
-             ((m_iAudioStreamIndexFFmpeg != -1) && (packetStreamIndex == m_iAudioStreamIndexFFmpeg))
-            )
+        if (FromFFmpegToOutputIndex(packetStreamIndex) >= 0)
         {
             // nothing to do - code to handle correct packets
             // right after this "if"
         }
         else
         {
-            ClearPacket(pTempPacket);
+            ReleasePacket(pTempPacket);
 //          pTempPacket = nullptr;
 
             // if we're requesting packets from streams we don't
@@ -1143,7 +1558,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::FindNextPacket(amf_int32 stre
             }
             if(!bFound)
             {
-                ClearPacket(pTempPacket);
+                ReleasePacket(pTempPacket);
             }
             if (m_bStreaming)
             {
@@ -1188,6 +1603,10 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::BufferFromPacket(const AVPack
     AMF_RETURN_IF_FALSE(pPacket != NULL, AMF_INVALID_ARG, L"BufferFromPacket() - packet not passed in");
     AMF_RETURN_IF_FALSE(ppBuffer != NULL, AMF_INVALID_ARG, L"BufferFromPacket() - buffer pointer not passed in");
 
+    if (m_bZeroCopy && WrapPacket(pPacket, ppBuffer) == AMF_OK)
+    {
+        return UpdateBufferProperties(*ppBuffer, pPacket);
+    }
 
     // Reproduce FFMPEG packet allocate logic (file libavcodec/avpacket.c function av_packet_duplicate)
     // ...
@@ -1215,6 +1634,30 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::BufferFromPacket(const AVPack
     return UpdateBufferProperties(pBuffer, pPacket);
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::WrapPacket(const AVPacket* pPacket, AMFBuffer** ppBuffer)
+{
+    // only refcounted packets that carry the zeroed input padding decoders
+    // expect can be handed out as they are, anything else is copied
+    const AVBufferRef* pBuf = pPacket->buf;
+    if (pBuf == nullptr || pPacket->data == nullptr || pPacket->size <= 0 ||
+        pPacket->data < pBuf->data ||
+        pPacket->data + pPacket->size + AV_INPUT_BUFFER_PADDING_SIZE > pBuf->data + pBuf->size)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+
+    AVBufferRef* pRef = av_buffer_ref(pPacket->buf);
+    AMF_RETURN_IF_INVALID_POINTER(pRef, L"WrapPacket() - av_buffer_ref failed");
+
+    AVBufferTracker* pTracker = new AVBufferTracker(pRef);
+    AMF_RESULT err = m_pContext->CreateBufferFromHostNative(pPacket->data, pPacket->size, ppBuffer, pTracker);
+    if (err != AMF_OK)
+    {
+        delete pTracker;
+    }
+    return err;
+}
+//-------------------------------------------------------------------------------------------------
 AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferProperties(AMFBuffer* pBuffer, const AVPacket* pPacket)
 {
     AMF_RETURN_IF_FALSE(pBuffer != NULL, AMF_INVALID_ARG, L"UpdateBufferProperties() - buffer not passed in");
@@ -1286,6 +1729,12 @@ AMF_RESULT AMF_STD_CALL  AMFFileDemuxerFFMPEGImpl::UpdateBufferProperties(AMFBuf
         UpdateBufferAudioDuration(pBuffer, pPacket, ist);
 //        AMFTraceWarning(AMF_FACILITY, L"Audio count=%lld size=%d PTS=%5.2f", m_OutputStreams[outputIndex]->GetPacketCount(), (int)pBuffer->GetSize(),  pBuffer->GetPts() / 10000.);
     }
+    else
+    {
+        // subtitle and data packets carry their own duration, same as audio
+        pBuffer->SetProperty(FFMPEG_DEMUXER_BUFFER_TYPE, AMFVariant(AMF_STREAM_DATA));
+        UpdateBufferAudioDuration(pBuffer, pPacket, ist);
+    }
     if (outputIndex >= 0)
     {
         pBuffer->SetProperty(FFMPEG_DEMUXER_BUFFER_STREAM_INDEX, outputIndex);
@@ -1454,30 +1903,17 @@ bool AMF_STD_CALL AMFFileDemuxerFFMPEGImpl::CheckH264MVC()
             return false;
         }
 
-        // if it's the video or audio streams we handle
+        // if it's one of the streams we have an output for
         // cache the packet, otherwise remove it...
-        if ( ((m_iVideoStreamIndexFFmpeg != -1) && (packet->stream_index == m_iVideoStreamIndexFFmpeg)) ||
-             ((m_iAudioStreamIndexFFmpeg != -1) && (packet->stream_index == m_iAudioStreamIndexFFmpeg)))
+        amf_int32 outputIndex = FromFFmpegToOutputIndex(packet->stream_index);
+        if (outputIndex < 0)
         {
-
-            amf_int32 outputIndex = FromFFmpegToOutputIndex(packet->stream_index);
-            if (outputIndex >= 0)
-            {
-                err = m_OutputStreams[outputIndex]->CachePacket(packet);
-                if (err != AMF_OK)
-                {
-                    continue;
-                }
-            }
-            else
-            {
-                ClearPacket(packet);
-                continue;
-            }
+            ReleasePacket(packet);
+            continue;
         }
-        else
+        err = m_OutputStreams[outputIndex]->CachePacket(packet);
+        if (err != AMF_OK)
         {
-            ClearPacket(packet);
             continue;
         }
 
@@ -1705,6 +2141,76 @@ AMF_RESULT AMFFileDemuxerFFMPEGImpl::OpenFile(
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFFileDemuxerFFMPEGImpl::OpenInputStream(AMFDataStream* pStream)
+{
+    static const int bufferSize = 64 * 1024;
+
+    // FFmpeg probes from the current position, a reopen after a failed seek starts over
+    if (pStream->IsSeekable())
+    {
+        amf_int64 pos = 0;
+        pStream->Seek(AMF_SEEK_BEGIN, 0, &pos);
+    }
+
+    uint8_t* pBuffer = (uint8_t*)av_malloc(bufferSize);
+    AMF_RETURN_IF_FALSE(pBuffer != NULL, AMF_OUT_OF_MEMORY, L"OpenInputStream() - av_malloc failed");
+
+    m_pInputIO = avio_alloc_context(pBuffer, bufferSize, 0, pStream, ReadInputStream,
+                                    NULL, pStream->IsSeekable() ? SeekInputStream : NULL);
+    if (m_pInputIO == NULL)
+    {
+        av_free(pBuffer);
+    }
+    AMF_RETURN_IF_FALSE(m_pInputIO != NULL, AMF_OUT_OF_MEMORY, L"OpenInputStream() - avio_alloc_context failed");
+
+    // avformat_open_input uses a preallocated context with its pb as it is
+    m_pInputContext = avformat_alloc_context();
+    AMF_RETURN_IF_FALSE(m_pInputContext != NULL, AMF_OUT_OF_MEMORY, L"OpenInputStream() - avformat_alloc_context failed");
+    m_pInputContext->pb = m_pInputIO;
+    m_pInputContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    m_pInputStream = pStream;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFFileDemuxerFFMPEGImpl::CloseInputStream()
+{
+    // with AVFMT_FLAG_CUSTOM_IO avformat_close_input leaves the I/O context to us
+    if (m_pInputIO != NULL)
+    {
+        av_freep(&m_pInputIO->buffer);
+        avio_context_free(&m_pInputIO);
+    }
+    m_pInputStream = NULL;
+}
+//-------------------------------------------------------------------------------------------------
+int AMFFileDemuxerFFMPEGImpl::ReadInputStream(void* opaque, uint8_t* buf, int size)
+{
+    AMFDataStream* pStream = (AMFDataStream*)opaque;
+    amf_size ready = 0;
+    if (pStream->Read(buf, size, &ready) != AMF_OK)
+    {
+        return AVERROR(EIO);
+    }
+    return ready == 0 ? AVERROR_EOF : (int)ready;
+}
+//-------------------------------------------------------------------------------------------------
+int64_t AMFFileDemuxerFFMPEGImpl::SeekInputStream(void* opaque, int64_t offset, int whence)
+{
+    AMFDataStream* pStream = (AMFDataStream*)opaque;
+    amf_int64 ret = 0;
+    AMF_RESULT err = AMF_OK;
+    if (whence == AVSEEK_SIZE)
+    {
+        err = pStream->GetSize(&ret);
+    }
+    else
+    {
+        err = pStream->Seek((AMF_SEEK_ORIGIN)(whence & ~AVSEEK_FORCE), offset, &ret);
+    }
+    return err == AMF_OK ? ret : -1;
+}
+//-------------------------------------------------------------------------------------------------
 amf_int32               AMFFileDemuxerFFMPEGImpl::FromFFmpegToOutputIndex(amf_int32 indexFFmpeg)
 {
     for (size_t idx = 0; idx < m_OutputStreams.size(); idx++)
@@ -36,9 +36,11 @@
 #include "public/include/components/FFMPEGFileDemuxer.h"
 #include "public/include/components/MediaSource.h"
 #include "public/common/PropertyStorageExImpl.h"
+#include "public/common/DataStream.h"
 #include "public/include/core/Context.h"
 
 #include "H264Mp4ToAnnexB.h"
+#include "KeyframeIndex.h"
 
 extern "C"
 {
@@ -101,12 +103,21 @@ namespace amf
             amf_list<AVPacket*>        m_packetsCache;
             amf_int64                  m_iPacketCount;
 
+            // read-ahead queue, filled by the reader thread and drained by
+            // QueryOutput without taking the demuxer lock
+            AMFCriticalSection         m_queueSync;
+            amf_list<AMFBufferPtr>     m_readAheadQueue;
+            amf_size                   m_readAheadBytes;
+
 
             // packet handling helper methods
             AMF_RESULT  CachePacket(AVPacket* pPacket);
             void        ClearPacketCache();
             bool        IsCached();
             amf_int64   GetPacketCount() { return m_iPacketCount; }
+
+            void        PushReadAhead(AMFBuffer* pBuffer);
+            bool        IsReadAheadFull(amf_int64 maxBytes, amf_pts maxDuration);
         };
         typedef AMFInterfacePtr_T<AMFOutputDemuxerImpl>    AMFOutputDemuxerImplPtr;
     //-------------------------------------------------------------------------------------------------
@@ -129,6 +140,46 @@ namespace amf
             virtual ~AMFAudioOutputDemuxerImpl()    {};
         };
 
+    //-------------------------------------------------------------------------------------------------
+
+        // subtitle and data streams, only created in FFMPEG_DEMUXER_ALL_STREAMS mode
+        class AMFDataOutputDemuxerImpl :
+            public AMFOutputDemuxerImpl
+        {
+        public:
+            AMFDataOutputDemuxerImpl(AMFFileDemuxerFFMPEGImpl* pHost, amf_int32 index);
+            virtual ~AMFDataOutputDemuxerImpl()     {};
+        };
+
+    //-------------------------------------------------------------------------------------------------
+
+        class AMFReaderThread : public AMFThread
+        {
+        public:
+            AMFReaderThread(AMFFileDemuxerFFMPEGImpl* pHost) : m_pHost(pHost) {}
+        protected:
+            virtual void Run() { m_pHost->ReadAhead(this); }
+
+            AMFFileDemuxerFFMPEGImpl* m_pHost;
+        };
+
+    //-------------------------------------------------------------------------------------------------
+
+        // scans the file on its own context, saves the index and hands it to the host
+        class AMFIndexThread : public AMFThread
+        {
+        public:
+            AMFIndexThread(AMFFileDemuxerFFMPEGImpl* pHost, const amf_string& url, const amf_string& indexPath, const AMFKeyframeIndex::Source& source) :
+                m_pHost(pHost), m_Url(url), m_IndexPath(indexPath), m_Source(source) {}
+        protected:
+            virtual void Run();
+
+            AMFFileDemuxerFFMPEGImpl*   m_pHost;
+            amf_string                  m_Url;
+            amf_string                  m_IndexPath;
+            AMFKeyframeIndex::Source    m_Source;
+        };
+
 
     public:
         // interface access
@@ -190,11 +241,20 @@ namespace amf
 
         // helper functions
         AMF_RESULT AMF_STD_CALL  ReadPacket(AVPacket **packet);
+        void       AMF_STD_CALL  ReadAhead(AMFThread* pThread);
+        void       AMF_STD_CALL  StartReader();
+        bool       AMF_STD_CALL  StopReader();
+        bool       AMF_STD_CALL  IsReadAheadFull();
+        void       AMF_STD_CALL  OpenKeyframeIndex(const amf_string& url, const amf_wstring& path);
+        void       AMF_STD_CALL  StopIndexer();
+        AVPacket*  AMF_STD_CALL  AllocPacket();
+        void       AMF_STD_CALL  ReleasePacket(AVPacket* pPacket);
         AMF_RESULT AMF_STD_CALL  FindNextPacket(amf_int32 streamIndex, AVPacket **packet, bool saveSkipped);
         bool       AMF_STD_CALL  OutOfRange();
         void       AMF_STD_CALL  ClearCachedPackets();
 
         AMF_RESULT AMF_STD_CALL  BufferFromPacket(const AVPacket* pPacket, AMFBuffer** ppBuffer);
+        AMF_RESULT AMF_STD_CALL  WrapPacket(const AVPacket* pPacket, AMFBuffer** ppBuffer);
         AMF_RESULT AMF_STD_CALL  UpdateBufferProperties(AMFBuffer* pBuffer, const AVPacket* pPacket);
         void       AMF_STD_CALL  UpdateBufferVideoDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const AVStream *ist);
         void       AMF_STD_CALL  UpdateBufferAudioDuration(AMFBuffer* pBuffer, const AVPacket* pPacket, const AVStream *ist);
@@ -210,6 +270,11 @@ namespace amf
         bool AMF_STD_CALL        IsCached();
         AMF_RESULT OpenAsImageSequence(amf_string filename, AVInputFormat* pFmt, AVDictionary* pOptions);
         AMF_RESULT OpenFile(amf_string filename, AVInputFormat* pFmt, AVDictionary* pOptions, amf_bool& bIsImage);
+        AMF_RESULT OpenInputStream(AMFDataStream* pStream);
+        void       CloseInputStream();
+
+        static int      ReadInputStream(void* opaque, uint8_t* buf, int size);
+        static int64_t  SeekInputStream(void* opaque, int64_t offset, int whence);
 
     private:
       mutable AMFCriticalSection  m_sync;
@@ -223,6 +288,8 @@ namespace amf
         // member variables from AMFDemuxerFFMPEG
         AVFormatContext*        m_pInputContext;
         amf_wstring             m_Url;
+        AMFDataStreamPtr        m_pInputStream;     // FFMPEG_DEMUXER_INPUT_STREAM read through m_pInputIO
+        AVIOContext*            m_pInputIO;
 //        bool                    m_bSyncAV;
 
         amf_int64               m_iPacketCount;
@@ -246,6 +313,32 @@ namespace amf
 
         bool                    m_bStreaming;
 
+        bool                    m_bZeroCopy;
+
+        // read-ahead mode, the flags are read by output QueryOutput without m_sync
+        std::atomic<bool>       m_bReadAhead;
+        std::atomic<AMF_RESULT> m_ReaderResult;     // AMF_OK while reading, then AMF_EOF or the read error
+        AMFReaderThread*        m_pReader;
+        AMFEvent                m_ReaderSpace;      // set when an output takes a buffer from its queue
+        amf_int64               m_iReadAheadMaxBytes;
+        amf_pts                 m_ptsReadAheadMaxDuration;
+
+        AMFKeyframeIndex        m_KeyframeIndex;    // guarded by m_sync, empty until loaded or built
+        AMFIndexThread*         m_pIndexer;
+        amf_vector<AVPacket*>   m_PacketPool;       // unreferenced packets for ReadPacket, guarded by m_sync
+
+        // keeps the packet data referenced while an output buffer wraps it
+        class AVBufferTracker : public AMFBufferObserver
+        {
+        public:
+            AVBufferTracker(AVBufferRef* pRef) : m_pRef(pRef) {}
+            virtual ~AVBufferTracker() { av_buffer_unref(&m_pRef); }
+
+            virtual void AMF_STD_CALL OnBufferDataRelease(AMFBuffer* /*pBuffer*/) { delete this; }
+        private:
+            AVBufferRef* m_pRef;
+        };
+
         AMFFileDemuxerFFMPEGImpl(const AMFFileDemuxerFFMPEGImpl&);
         AMFFileDemuxerFFMPEGImpl& operator=(const AMFFileDemuxerFFMPEGImpl&);
     };
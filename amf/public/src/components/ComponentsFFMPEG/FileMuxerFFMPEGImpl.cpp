@@ -144,7 +144,8 @@ AMFFileMuxerFFMPEGImpl::AMFInputMuxerImpl::AMFInputMuxerImpl(AMFFileMuxerFFMPEGI
       m_bEnabled(true),
       m_iPacketCount(0),
       m_ptsLast(0),
-      m_ptsShift(0)
+      m_ptsShift(0),
+      m_bConvert(false)
 {
 }
 //-------------------------------------------------------------------------------------------------
@@ -294,7 +295,14 @@ AMFFileMuxerFFMPEGImpl::AMFFileMuxerFFMPEGImpl(AMFContext* pContext)
     m_ptsStatTime(0),
     m_bPtsOffsetIsCalculated(false),
     m_ptsOffset(0),
-    m_isUsageTrim(false)
+    m_isUsageTrim(false),
+    m_bAsyncWrite(false),
+    m_pWriter(NULL),
+    m_eWriterResult(AMF_OK),
+    m_bFileIO(false),
+    m_ptsWriteTotal(0),
+    m_iWriteCount(0),
+    m_ptsWriteMax(0)
 {
     g_AMFFactory.Init();
 
@@ -305,8 +313,15 @@ AMFFileMuxerFFMPEGImpl::AMFFileMuxerFFMPEGImpl(AMFContext* pContext)
         AMFPropertyInfoBool(FFMPEG_MUXER_ENABLE_AUDIO, L"Enable audio stream", false, true),
         AMFPropertyInfoBool(FFMPEG_MUXER_LISTEN, L"Listen", false, false),
         AMFPropertyInfoBool(FFMPEG_MUXER_USAGE_IS_TRIM, L"is the usage of the muxer to trim a video by remux", false, true),
-        AMFPropertyInfoInterface(FFMPEG_MUXER_CURRENT_TIME_INTERFACE, L"Interface object for getting current time", NULL, false)
-        
+        AMFPropertyInfoInterface(FFMPEG_MUXER_CURRENT_TIME_INTERFACE, L"Interface object for getting current time", NULL, false),
+        AMFPropertyInfoBool(FFMPEG_MUXER_ASYNC_WRITE, L"Write packets on a separate thread", false, false),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_WRITE_QUEUE_SIZE, L"Packets queued for the writer thread", 64, 1, 4096, false),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_IO_BUFFER_SIZE, L"File write buffer size in bytes, 0 - FFmpeg default", 0, 0, 256 * 1024 * 1024, false),
+        AMFPropertyInfoBool(FFMPEG_MUXER_DIRECT_IO, L"Bypass the page cache for full write buffers", false, false),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_SYNC_INTERVAL, L"Bytes written between fdatasync calls, 0 - never", 0, 0, LLONG_MAX, false),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_STAT_QUEUE_DEPTH, L"Packets waiting for the writer thread", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_STAT_WRITE_LATENCY_AVG, L"Average packet write time", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ),
+        AMFPropertyInfoInt64(FFMPEG_MUXER_STAT_WRITE_LATENCY_MAX, L"Longest packet write time", 0, 0, LLONG_MAX, AMF_PROPERTY_ACCESS_READ)
 
     AMFPrimitivePropertyInfoMapEnd
 
@@ -331,6 +346,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*forma
 
     GetProperty(FFMPEG_MUXER_USAGE_IS_TRIM, &m_isUsageTrim);
 
+    StopWriter();
     Close();
     AMF_RESULT res = Open();
     AMF_RETURN_IF_FAILED(res, L"Open() failed");
@@ -343,6 +359,17 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Init(AMF_SURFACE_FORMAT /*forma
     m_bPtsOffsetIsCalculated = false;
     m_ptsOffset = 0;
 
+    {
+        AMFLock statLock(&m_statSync);
+        m_ptsWriteTotal = 0;
+        m_iWriteCount = 0;
+        m_ptsWriteMax = 0;
+    }
+    UpdateWriteStats();
+
+    GetProperty(FFMPEG_MUXER_ASYNC_WRITE, &m_bAsyncWrite);
+    StartWriter();
+
     return res;
 }
 //-------------------------------------------------------------------------------------------------
@@ -358,6 +385,8 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Terminate()
 
     m_bTerminated = true;
 
+    // pending packets still go to the file before the trailer
+    StopWriter();
     Close();
 
     return AMF_OK;
@@ -504,6 +533,22 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::AllocateContext()
             }
         }
 
+        // avcC / hvcC extra data tells the container to store the packets as they come, so
+        // they have to be length-prefixed - encoders produce Annex B
+        spInput->m_bConvert = false;
+        if ((codecID == AV_CODEC_ID_H264 || codecID == AV_CODEC_ID_HEVC) &&
+            ist->codecpar->extradata_size > 0 && ist->codecpar->extradata[0] == 1)
+        {
+            const AMFBitstreamConverter::Codec codec = (codecID == AV_CODEC_ID_H264) ? AMFBitstreamConverter::CODEC_H264 : AMFBitstreamConverter::CODEC_HEVC;
+            AMF_RESULT res = spInput->m_Converter.Init(codec, AMFBitstreamConverter::FORMAT_ANNEXB, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED,
+                ist->codecpar->extradata, ist->codecpar->extradata_size);
+            spInput->m_bConvert = res == AMF_OK;
+            if (res != AMF_OK)
+            {
+                AMFTraceWarning(AMF_FACILITY, L"AllocateContext() - stream# %d, cannot parse extra data, packets are written as is", ind);
+            }
+        }
+
         if (streamType==AMF_STREAM_VIDEO)
         {
             AMFRate  frameRate;
@@ -582,6 +627,7 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Open()
     amf_string convertedfilename;
     bool bListen = false;
     bool bRtmpLive = false;
+    bool bFileIO = false;
     if(url.length() > 0)
     {
         GetProperty(FFMPEG_MUXER_LISTEN, &bListen);
@@ -611,6 +657,10 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Open()
     else if(path.length() > 0)
     {
         convertedfilename = amf_string("file:") + amf_from_unicode_to_utf8(path);
+
+        amf_int64 ioBufferSize = 0;
+        GetProperty(FFMPEG_MUXER_IO_BUFFER_SIZE, &ioBufferSize);
+        bFileIO = ioBufferSize > 0;
     }
     if(file_oformat == NULL)
     {
@@ -636,11 +686,33 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Open()
     }
     // open file
 //    int iret = avio_open(&m_pOutputContext->pb, convertedfilename.c_str(), AVIO_FLAG_WRITE);
-    iret = avio_open2(&m_pOutputContext->pb, convertedfilename.c_str(), AVIO_FLAG_WRITE, NULL, &options);
+    if (bFileIO)
+    {
+        av_dict_free(&options);
+
+        amf_int64 ioBufferSize = 0;
+        bool bDirectIO = false;
+        amf_int64 syncInterval = 0;
+        GetProperty(FFMPEG_MUXER_IO_BUFFER_SIZE, &ioBufferSize);
+        GetProperty(FFMPEG_MUXER_DIRECT_IO, &bDirectIO);
+        GetProperty(FFMPEG_MUXER_SYNC_INTERVAL, &syncInterval);
 
-    if(iret != 0)
+        AMF_RESULT res = m_FileIO.Open(path, (amf_size)ioBufferSize, bDirectIO, syncInterval);
+        AMF_RETURN_IF_FAILED(res, L"Open() - cannot open %s", path.c_str());
+
+        m_pOutputContext->pb = m_FileIO.GetContext();
+        m_pOutputContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+        m_bFileIO = true;
+    }
+    else
     {
-        return AMF_FILE_NOT_OPEN;
+        iret = avio_open2(&m_pOutputContext->pb, convertedfilename.c_str(), AVIO_FLAG_WRITE, NULL, &options);
+        av_dict_free(&options);
+
+        if(iret != 0)
+        {
+            return AMF_FILE_NOT_OPEN;
+        }
     }
 
     AMF_RESULT err = WriteHeader();
@@ -664,7 +736,15 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::Close()
         {
             av_write_trailer(m_pOutputContext);
         }
-        avio_close(m_pOutputContext->pb);
+        if (m_bFileIO)
+        {
+            m_FileIO.Close();
+            m_bFileIO = false;
+        }
+        else
+        {
+            avio_close(m_pOutputContext->pb);
+        }
         m_pOutputContext->pb = 0;
         m_pOutputContext->oformat = 0;
     }
@@ -695,146 +775,274 @@ AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::WriteData(AMFData* pData, amf_i
     if (pData)
     {
         m_bForceEof = false;
-        AVStream *ost = m_pOutputContext->streams[iIndex];
-
-        // fill packet
-        AVPacket  pkt = {};
-        av_init_packet(&pkt);
 
         AMFBufferPtr pInBuffer(pData);
         AMF_RETURN_IF_FALSE(pInBuffer != 0,AMF_INVALID_ARG, L"WriteData() - Input should be Buffer");
 
         AMF_RESULT err = pInBuffer->Convert(AMF_MEMORY_HOST);
         AMF_RETURN_IF_FAILED(err, L"WriteData() - Convert(AMF_MEMORY_HOST) failed");
+        AMF_RETURN_IF_FALSE(pInBuffer->GetSize() != 0, AMF_INVALID_ARG, L"WriteData() - Invalid param");
 
-        amf_size uiMemSizeIn = pInBuffer->GetSize();
-        AMF_RETURN_IF_FALSE(uiMemSizeIn!=0, AMF_INVALID_ARG, L"WriteData() - Invalid param");
-
-        pkt.data = static_cast<uint8_t*>(pInBuffer->GetNative());
-        pkt.size = (int)uiMemSizeIn;
-        pkt.stream_index = iIndex;
-
-        if (m_isUsageTrim)
+        if (m_pWriter != NULL)
         {
-            amf_int64 flags = 0;
-            if (AMF_OK == pData->GetProperty(L"FFMPEG:flags", &flags))
+            // report a failure on the writer thread to the caller
+            err = m_eWriterResult;
+            AMF_RETURN_IF_FAILED(err, L"WriteData() - writer thread failed");
+
+            QueuedPacket packet;
+            packet.pData = pData;
+            packet.iIndex = iIndex;
+            if (!m_WriteQueue.Add(0, packet, 0, 0))
             {
-                pkt.flags = (amf_int) flags;
+                return AMF_INPUT_FULL;
             }
-                
         }
+        else
+        {
+            err = WritePacket(pData, iIndex);
+            AMF_RETURN_IF_FAILED(err, L"WriteData() - WritePacket() failed");
+        }
+        UpdateWriteStats();
+    }
+    // check if all streams reached EOF
+    if (!pData || m_bForceEof)
+    {
+        m_bEofList[iIndex] = true;
+    }
+    for(amf_size i=0; i < m_bEofList.size(); i++)
+    {
+        if (!m_bEofList[i])
+        {
+            return AMF_OK;
+        }
+    }
+    // EOF detected - write out queued packets and close the file
+    StopWriter();
+    AMF_RESULT res = m_eWriterResult;
+    Close();
+    AMF_RETURN_IF_FAILED(res, L"WriteData() - writer thread failed");
+    return AMF_EOF;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::WritePacket(AMFData* pData, amf_int32 iIndex)
+{
+    AVStream *ost = m_pOutputContext->streams[iIndex];
+    AMFBufferPtr pInBuffer(pData);
+
+    // fill packet
+    AVPacket  pkt = {};
+    av_init_packet(&pkt);
 
-        // Try to determine the output video frame type
-        amf_int64 outputDataType = -1;
-        if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE, &outputDataType))
+    pkt.data = static_cast<uint8_t*>(pInBuffer->GetNative());
+    pkt.size = (int)pInBuffer->GetSize();
+    pkt.stream_index = iIndex;
+
+    AMFInputMuxerImplPtr spInput = m_InputStreams[iIndex];
+    if (spInput->m_bConvert)
+    {
+        // the converter keeps the output buffer, the muxer copies the data before it is reused
+        const amf_uint8* pConverted = NULL;
+        amf_size convertedSize = 0;
+        AMF_RETURN_IF_FAILED(spInput->m_Converter.Filter(pkt.data, (amf_size)pkt.size, &pConverted, &convertedSize));
+        pkt.data = const_cast<uint8_t*>(pConverted);
+        pkt.size = (int)convertedSize;
+    }
+
+    if (m_isUsageTrim)
+    {
+        amf_int64 flags = 0;
+        if (AMF_OK == pData->GetProperty(L"FFMPEG:flags", &flags))
         {
-            // set key flag for key frames
-            if (outputDataType == AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE_IDR || outputDataType == AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE_I)
-            {
-                pkt.flags |= AV_PKT_FLAG_KEY;
-            }
+            pkt.flags = (amf_int) flags;
         }
-        else if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE, &outputDataType))
+            
+    }
+
+    // Try to determine the output video frame type
+    amf_int64 outputDataType = -1;
+    if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE, &outputDataType))
+    {
+        // set key flag for key frames
+        if (outputDataType == AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE_IDR || outputDataType == AMF_VIDEO_ENCODER_OUTPUT_DATA_TYPE_I)
         {
-            if (outputDataType == AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE_I || outputDataType == AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE_IDR)
-            {
-                pkt.flags |= AV_PKT_FLAG_KEY;
-            }
+            pkt.flags |= AV_PKT_FLAG_KEY;
         }
-        else if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_AV1_OUTPUT_FRAME_TYPE, &outputDataType))
+    }
+    else if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE, &outputDataType))
+    {
+        if (outputDataType == AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE_I || outputDataType == AMF_VIDEO_ENCODER_HEVC_OUTPUT_DATA_TYPE_IDR)
         {
-            if (outputDataType == AMF_VIDEO_ENCODER_AV1_OUTPUT_FRAME_TYPE_KEY)
-            {
-                pkt.flags |= AV_PKT_FLAG_KEY;
-            }
+            pkt.flags |= AV_PKT_FLAG_KEY;
+        }
+    }
+    else if (AMF_OK == pData->GetProperty(AMF_VIDEO_ENCODER_AV1_OUTPUT_FRAME_TYPE, &outputDataType))
+    {
+        if (outputDataType == AMF_VIDEO_ENCODER_AV1_OUTPUT_FRAME_TYPE_KEY)
+        {
+            pkt.flags |= AV_PKT_FLAG_KEY;
         }
-        // resample pts
-        amf_pts pts = pData->GetPts();
-        amf_pts duration = pData->GetDuration();
+    }
+    // resample pts
+    amf_pts pts = pData->GetPts();
+    amf_pts duration = pData->GetDuration();
 
-        pkt.duration = av_rescale_q(duration, AMF_TIME_BASE_Q, ost->time_base);
+    pkt.duration = av_rescale_q(duration, AMF_TIME_BASE_Q, ost->time_base);
 
-        amf_pts dts = pts;
-        if (ost->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+    amf_pts dts = pts;
+    if (ost->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+    {
+        if (pData->GetProperty(AMF_VIDEO_ENCODER_PRESENTATION_TIME_STAMP, &pts) == AMF_OK)
         {
-            if (pData->GetProperty(AMF_VIDEO_ENCODER_PRESENTATION_TIME_STAMP, &pts) == AMF_OK)
+            if (!m_bPtsOffsetIsCalculated && ((pkt.flags & AV_PKT_FLAG_KEY) != 0))
             {
-                if (!m_bPtsOffsetIsCalculated && ((pkt.flags & AV_PKT_FLAG_KEY) != 0))
+                // calculate offset for preventing PTS < DTS
+                if (pts == dts)
                 {
-                    // calculate offset for preventing PTS < DTS
-                    if (pts == dts)
-                    {
-                        m_ptsOffset = duration;
-                    }
-                    else if (pts > dts)
-                    {
-                        // PTS and DTS set by encoder are the same for the first frame
-                        // adjust PTS by the same offset applied to DTS by upstream application
-                        m_ptsOffset = duration - pts + dts;
-                    }
-
-                    m_bPtsOffsetIsCalculated = true;
+                    m_ptsOffset = duration;
                 }
-
-                pts += m_ptsOffset;
-
-                // PTS can be smaller than DTS when there are large gaps in input PTS
-                // in which case set PTS = DTS
-                if (pts < dts)
+                else if (pts > dts)
                 {
-                    pts = dts;
+                    // PTS and DTS set by encoder are the same for the first frame
+                    // adjust PTS by the same offset applied to DTS by upstream application
+                    m_ptsOffset = duration - pts + dts;
                 }
+
+                m_bPtsOffsetIsCalculated = true;
             }
-        }
 
-        pkt.pts=av_rescale_q(pts, AMF_TIME_BASE_Q, ost->time_base);
-        if (ffstream(ost)->cur_dts == pkt.pts && ost->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) // MM sometimes time_base doesn't have enough precision for the a buffer with small number of compressed samples producing the same dts. AVI muxder fails with this
-        {
-            pkt.pts++;
-        }
+            pts += m_ptsOffset;
 
-        if (dts != pts)
-        {
-            pkt.dts = av_rescale_q(dts, AMF_TIME_BASE_Q, ost->time_base);
-        }
-        else
-        {
-            pkt.dts = pkt.pts;
+            // PTS can be smaller than DTS when there are large gaps in input PTS
+            // in which case set PTS = DTS
+            if (pts < dts)
+            {
+                pts = dts;
+            }
         }
-        //pkt.pts = AV_NOPTS_VALUE;
-        //pkt.dts = AV_NOPTS_VALUE;
+    }
+
+    pkt.pts=av_rescale_q(pts, AMF_TIME_BASE_Q, ost->time_base);
+    if (ffstream(ost)->cur_dts == pkt.pts && ost->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) // MM sometimes time_base doesn't have enough precision for the a buffer with small number of compressed samples producing the same dts. AVI muxder fails with this
+    {
+        pkt.pts++;
+    }
+
+    if (dts != pts)
+    {
+        pkt.dts = av_rescale_q(dts, AMF_TIME_BASE_Q, ost->time_base);
+    }
+    else
+    {
+        pkt.dts = pkt.pts;
+    }
+    //pkt.pts = AV_NOPTS_VALUE;
+    //pkt.dts = AV_NOPTS_VALUE;
 //        amf_int64 ptsFFmpeg = pkt.pts;
-        if (av_interleaved_write_frame(m_pOutputContext,&pkt)<0)
+    const amf_pts writeStart = amf_high_precision_clock();
+    if (av_interleaved_write_frame(m_pOutputContext,&pkt)<0)
+    {
+        return AMF_FAIL;
+    }
+    const amf_pts writeTime = amf_high_precision_clock() - writeStart;
+    {
+        AMFLock statLock(&m_statSync);
+        m_ptsWriteTotal += writeTime;
+        m_iWriteCount++;
+        if (writeTime > m_ptsWriteMax)
         {
-            return AMF_FAIL;
+            m_ptsWriteMax = writeTime;
         }
+    }
 
-        if(ost->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && m_pCurrentTime != nullptr)
-        {
-            m_ptsStatTime += m_pCurrentTime->Get() - pData->GetPts();
+    if(ost->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && m_pCurrentTime != nullptr)
+    {
+        m_ptsStatTime += m_pCurrentTime->Get() - pData->GetPts();
 
-            m_iViewFrameCount++;
-            if((m_iViewFrameCount % 100) == 0)
-            {
+        m_iViewFrameCount++;
+        if((m_iViewFrameCount % 100) == 0)
+        {
 //                AMFTraceWarning(AMF_FACILITY, L" Averate Latency=%5.2f", m_ptsStatTime / 100. / 10000.);
-                m_ptsStatTime = 0;
-            }
+            m_ptsStatTime = 0;
         }
     }
-    // check if all streams reached EOF
-    if (!pData || m_bForceEof)
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::StartWriter()
+{
+    AMFLock lock(&m_sync);
+
+    if (!m_bAsyncWrite || m_pWriter != NULL || m_pOutputContext == NULL)
     {
-        m_bEofList[iIndex] = true;
+        return;
     }
-    for(amf_size i=0; i < m_bEofList.size(); i++)
+    amf_int64 queueSize = 64;
+    GetProperty(FFMPEG_MUXER_WRITE_QUEUE_SIZE, &queueSize);
+    m_WriteQueue.SetQueueSize((amf_int32)queueSize);
+    m_eWriterResult = AMF_OK;
+
+    m_pWriter = new AMFWriterThread(this);
+    m_pWriter->Start();
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::StopWriter()
+{
+    AMFLock lock(&m_sync);
+
+    if (m_pWriter == NULL)
     {
-        if (!m_bEofList[i])
+        return;
+    }
+    // the writer never takes m_sync and leaves only once the queue is empty
+    m_pWriter->RequestStop();
+    m_pWriter->WaitForStop();
+    delete m_pWriter;
+    m_pWriter = NULL;
+    m_WriteQueue.Clear();
+    UpdateWriteStats();
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::WriteQueued(AMFThread* pThread)
+{
+    static const amf_ulong waitTimeout = 50;
+
+    for (;;)
+    {
+        amf_ulong    id = 0;
+        QueuedPacket packet;
+        if (!m_WriteQueue.Get(id, packet, pThread->StopRequested() ? 0 : waitTimeout))
         {
-            return AMF_OK;
+            if (pThread->StopRequested())
+            {
+                break;
+            }
+            continue;
+        }
+        // after a failure keep draining so the producer is not blocked, the error is reported from WriteData
+        if (m_eWriterResult == AMF_OK)
+        {
+            AMF_RESULT res = WritePacket(packet.pData, packet.iIndex);
+            if (res != AMF_OK)
+            {
+                AMFTraceError(AMF_FACILITY, L"WriteQueued() - WritePacket() failed, stream# %d", packet.iIndex);
+                m_eWriterResult = res;
+            }
         }
     }
-    Close(); // EOF detected - close the file
-    return AMF_EOF;
+}
+//-------------------------------------------------------------------------------------------------
+void AMF_STD_CALL  AMFFileMuxerFFMPEGImpl::UpdateWriteStats()
+{
+    amf_pts average = 0;
+    amf_pts longest = 0;
+    {
+        AMFLock statLock(&m_statSync);
+        average = m_iWriteCount > 0 ? m_ptsWriteTotal / m_iWriteCount : 0;
+        longest = m_ptsWriteMax;
+    }
+    SetPrivateProperty(FFMPEG_MUXER_STAT_QUEUE_DEPTH, (amf_int64)m_WriteQueue.GetSize());
+    SetPrivateProperty(FFMPEG_MUXER_STAT_WRITE_LATENCY_AVG, average);
+    SetPrivateProperty(FFMPEG_MUXER_STAT_WRITE_LATENCY_MAX, longest);
 }
 //-------------------------------------------------------------------------------------------------
 //-------------------------------------------------------------------------------------------------
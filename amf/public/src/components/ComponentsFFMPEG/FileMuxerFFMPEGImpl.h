@@ -53,6 +53,11 @@ extern "C"
 #include "public/common/PropertyStorageExImpl.h"
 #include "public/include/core/Context.h"
 #include "public/include/core/CurrentTime.h"
+#include "public/common/Thread.h"
+#include "FileWriterIO.h"
+#include "BitstreamConverter.h"
+
+#include <atomic>
 
 
 
@@ -100,6 +105,8 @@ namespace amf
             amf_int64                 m_iPacketCount;
             amf_pts                   m_ptsLast;
             amf_pts                   m_ptsShift;
+            AMFBitstreamConverter     m_Converter;
+            bool                      m_bConvert;     // Annex B input for avcC / hvcC extra data
 
         };
         typedef AMFInterfacePtr_T<AMFInputMuxerImpl>    AMFInputMuxerImplPtr;
@@ -126,6 +133,24 @@ namespace amf
 
         };
 
+    //-------------------------------------------------------------------------------------------------
+
+        class AMFWriterThread : public AMFThread
+        {
+        public:
+            AMFWriterThread(AMFFileMuxerFFMPEGImpl* pHost) : m_pHost(pHost) {}
+        protected:
+            virtual void Run() { m_pHost->WriteQueued(this); }
+
+            AMFFileMuxerFFMPEGImpl* m_pHost;
+        };
+
+        struct QueuedPacket
+        {
+            AMFDataPtr  pData;
+            amf_int32   iIndex;
+        };
+
 
     public:
         // interface access
@@ -172,6 +197,12 @@ namespace amf
 
         AMF_RESULT AMF_STD_CALL     WriteHeader();
         AMF_RESULT AMF_STD_CALL     WriteData(AMFData* pData, amf_int32 iIndex);
+        AMF_RESULT AMF_STD_CALL     WritePacket(AMFData* pData, amf_int32 iIndex);
+
+        void AMF_STD_CALL           StartWriter();
+        void AMF_STD_CALL           StopWriter();
+        void AMF_STD_CALL           WriteQueued(AMFThread* pThread);
+        void AMF_STD_CALL           UpdateWriteStats();
     private:
       mutable AMFCriticalSection  m_sync;
 
@@ -195,6 +226,19 @@ namespace amf
         bool                    m_bPtsOffsetIsCalculated;
         amf_pts                 m_ptsOffset;
         bool                    m_isUsageTrim;
+
+        // async write path
+        bool                    m_bAsyncWrite;
+        AMFQueue<QueuedPacket>  m_WriteQueue;
+        AMFWriterThread*        m_pWriter;
+        std::atomic<AMF_RESULT> m_eWriterResult;     // first failure on the writer thread
+        AMFFileWriterIO         m_FileIO;
+        bool                    m_bFileIO;
+
+        AMFCriticalSection      m_statSync;
+        amf_pts                 m_ptsWriteTotal;
+        amf_int64               m_iWriteCount;
+        amf_pts                 m_ptsWriteMax;
     };
 
  //   typedef AMFInterfacePtr_T<AMFFileMuxerFFMPEGImpl>    AMFFileMuxerFFMPEGPtr;
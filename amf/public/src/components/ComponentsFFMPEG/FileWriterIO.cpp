@@ -0,0 +1,327 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+extern "C"
+{
+#if defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable:4244) // possible loss of data with conversion
+#endif
+
+    #include "libavformat/avio.h"
+    #include "libavutil/mem.h"
+
+#if defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+}
+
+#include "FileWriterIO.h"
+#include "public/common/TraceAdapter.h"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+    #include <io.h>
+    #include <share.h>
+    #define amf_close   _close
+    #define amf_write   _write
+    #define amf_seek64  _lseeki64
+    #define amf_sync    _commit
+#else
+    #include <unistd.h>
+    #define amf_close   close
+    #define amf_write   write
+    #define amf_seek64  lseek64
+    #define amf_sync    fdatasync
+#endif
+
+#define AMF_FACILITY L"AMFFileWriterIO"
+
+using namespace amf;
+
+// O_DIRECT needs the buffer address, the size and the file offset aligned to the logical block size
+static const amf_size   DIRECT_IO_ALIGNMENT = 4096;
+
+//-------------------------------------------------------------------------------------------------
+static inline bool IsAligned(amf_int64 value)
+{
+    return (value & (amf_int64)(DIRECT_IO_ALIGNMENT - 1)) == 0;
+}
+//-------------------------------------------------------------------------------------------------
+AMFFileWriterIO::AMFFileWriterIO() :
+    m_iFileDescriptor(-1),
+    m_pContext(NULL),
+    m_pBuffer(NULL),
+    m_bAlignedBuffer(false),
+    m_bDirectIO(false),
+    m_bDirect(false),
+    m_iSyncInterval(0),
+    m_iUnsynced(0),
+    m_iPosition(0),
+    m_iSize(0),
+    m_iDirectWrites(0),
+    m_iSyncCount(0)
+{
+}
+//-------------------------------------------------------------------------------------------------
+AMFFileWriterIO::~AMFFileWriterIO()
+{
+    Close();
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFFileWriterIO::Open(const amf_wstring& path, amf_size bufferSize, bool bDirectIO, amf_int64 syncInterval)
+{
+    Close();
+    AMF_RETURN_IF_FALSE(bufferSize > 0 && bufferSize <= 0x40000000, AMF_INVALID_ARG, L"Open() - invalid buffer size %d", (int)bufferSize);
+
+    bufferSize = (bufferSize + DIRECT_IO_ALIGNMENT - 1) & ~(DIRECT_IO_ALIGNMENT - 1);
+
+#if defined(_WIN32)
+    bDirectIO = false; // unbuffered handles are not available through the CRT descriptors
+    m_iFileDescriptor = _wsopen(path.c_str(), _O_BINARY | O_CREAT | O_TRUNC | O_WRONLY, _SH_DENYWR, 0666);
+#else
+    #if !defined(O_DIRECT)
+    bDirectIO = false;
+    #endif
+    amf_string str = amf_from_unicode_to_utf8(path);
+    m_iFileDescriptor = open(str.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0666);
+#endif
+    AMF_RETURN_IF_FALSE(m_iFileDescriptor != -1, AMF_FILE_NOT_OPEN, L"Open() - cannot open %s", path.c_str());
+
+#if !defined(_WIN32)
+    if (bDirectIO)
+    {
+        void* pBuffer = NULL;
+        if (posix_memalign(&pBuffer, DIRECT_IO_ALIGNMENT, bufferSize) == 0)
+        {
+            m_pBuffer = (uint8_t*)pBuffer;
+            m_bAlignedBuffer = true;
+        }
+    }
+#endif
+    if (m_pBuffer == NULL)
+    {
+        bDirectIO = false;
+        m_pBuffer = (uint8_t*)av_malloc(bufferSize);
+    }
+    if (m_pBuffer == NULL)
+    {
+        Close();
+        return AMF_OUT_OF_MEMORY;
+    }
+
+    m_bDirectIO = bDirectIO;
+    m_iSyncInterval = syncInterval;
+    m_iDirectWrites = 0;
+    m_iSyncCount = 0;
+
+    m_pContext = avio_alloc_context(m_pBuffer, (int)bufferSize, 1, this, NULL, &AMFFileWriterIO::WritePacket, &AMFFileWriterIO::Seek);
+    if (m_pContext == NULL)
+    {
+        Close();
+        return AMF_OUT_OF_MEMORY;
+    }
+    // hand full buffers to the callback so they stay aligned for O_DIRECT
+    m_pContext->direct = 0;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFFileWriterIO::Close()
+{
+    AMF_RESULT res = AMF_OK;
+    if (m_pContext != NULL)
+    {
+        avio_flush(m_pContext);
+        if (m_pContext->error < 0)
+        {
+            res = AMF_FAIL;
+        }
+        // if the context replaced the buffer it already released ours
+        if (m_pContext->buffer != m_pBuffer)
+        {
+            av_freep(&m_pContext->buffer);
+            m_pBuffer = NULL;
+        }
+        avio_context_free(&m_pContext);
+    }
+    if (m_pBuffer != NULL)
+    {
+        if (m_bAlignedBuffer)
+        {
+            free(m_pBuffer);
+        }
+        else
+        {
+            av_free(m_pBuffer);
+        }
+        m_pBuffer = NULL;
+    }
+    if (m_iFileDescriptor != -1)
+    {
+        SetDirect(false);
+        if (m_iSyncInterval > 0 && m_iUnsynced > 0)
+        {
+            amf_sync(m_iFileDescriptor);
+            m_iSyncCount++;
+        }
+        if (amf_close(m_iFileDescriptor) != 0)
+        {
+            res = AMF_FAIL;
+        }
+        m_iFileDescriptor = -1;
+    }
+    m_bAlignedBuffer = false;
+    m_bDirectIO = false;
+    m_iSyncInterval = 0;
+    m_iUnsynced = 0;
+    m_iPosition = 0;
+    m_iSize = 0;
+    return res;
+}
+//-------------------------------------------------------------------------------------------------
+int AMFFileWriterIO::WritePacket(void* opaque, uint8_t* buf, int size)
+{
+    return static_cast<AMFFileWriterIO*>(opaque)->Write(buf, size);
+}
+//-------------------------------------------------------------------------------------------------
+int64_t AMFFileWriterIO::Seek(void* opaque, int64_t offset, int whence)
+{
+    AMFFileWriterIO* pThis = static_cast<AMFFileWriterIO*>(opaque);
+    amf_int64 position = 0;
+    switch (whence & ~AVSEEK_FORCE)
+    {
+    case AVSEEK_SIZE:
+        return pThis->m_iSize;
+    case SEEK_SET:
+        position = offset;
+        break;
+    case SEEK_CUR:
+        position = pThis->m_iPosition + offset;
+        break;
+    case SEEK_END:
+        position = pThis->m_iSize + offset;
+        break;
+    default:
+        return AVERROR(EINVAL);
+    }
+    if (position < 0)
+    {
+        return AVERROR(EINVAL);
+    }
+    if (amf_seek64(pThis->m_iFileDescriptor, position, SEEK_SET) < 0)
+    {
+        return AVERROR(errno);
+    }
+    pThis->m_iPosition = position;
+    return position;
+}
+//-------------------------------------------------------------------------------------------------
+int AMFFileWriterIO::Write(const uint8_t* buf, int size)
+{
+    if (m_bDirectIO)
+    {
+        // full buffers land on block boundaries; the tail and header rewrites go through the page cache
+        SetDirect(IsAligned((amf_int64)(size_t)buf) && IsAligned(size) && IsAligned(m_iPosition));
+    }
+
+    int written = 0;
+    while (written < size)
+    {
+        int ret = (int)amf_write(m_iFileDescriptor, buf + written, size - written);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EINVAL && m_bDirect)
+            {
+                // the file system refused the alignment, stay buffered from now on
+                SetDirect(false);
+                m_bDirectIO = false;
+                continue;
+            }
+            return AVERROR(errno);
+        }
+        written += ret;
+    }
+    if (m_bDirect)
+    {
+        m_iDirectWrites++;
+    }
+    m_iPosition += written;
+    if (m_iPosition > m_iSize)
+    {
+        m_iSize = m_iPosition;
+    }
+
+    if (m_iSyncInterval > 0)
+    {
+        m_iUnsynced += written;
+        if (m_iUnsynced >= m_iSyncInterval)
+        {
+            amf_sync(m_iFileDescriptor);
+            m_iSyncCount++;
+            m_iUnsynced = 0;
+        }
+    }
+    return written;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFFileWriterIO::SetDirect(bool bDirect)
+{
+#if defined(O_DIRECT) && !defined(_WIN32)
+    if (bDirect == m_bDirect)
+    {
+        return;
+    }
+    int flags = fcntl(m_iFileDescriptor, F_GETFL);
+    if (flags == -1)
+    {
+        return;
+    }
+    flags = bDirect ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+    if (fcntl(m_iFileDescriptor, F_SETFL, flags) == 0)
+    {
+        m_bDirect = bDirect;
+    }
+#else
+    (void)bDirect;
+#endif
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,88 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/Result.h"
+#include "public/common/AMFSTL.h"
+
+struct AVIOContext;
+
+namespace amf
+{
+    //-------------------------------------------------------------------------------------------------
+    // File output for the muxer with a large write buffer, used instead of
+    // FFmpeg's file protocol when the muxer asks for it. On Linux it can write
+    // full aligned buffers with O_DIRECT and batch fdatasync calls.
+    class AMFFileWriterIO
+    {
+    public:
+        AMFFileWriterIO();
+        ~AMFFileWriterIO();
+
+        // bufferSize is rounded up to the direct I/O alignment; syncInterval - bytes between
+        // fdatasync calls, 0 leaves flushing to the OS
+        AMF_RESULT      Open(const amf_wstring& path, amf_size bufferSize, bool bDirectIO, amf_int64 syncInterval);
+        AMF_RESULT      Close();
+
+        AVIOContext*    GetContext()    { return m_pContext; }
+
+        // counters since the last Open: writes issued with O_DIRECT set and fdatasync calls
+        amf_int64       GetDirectWrites() const { return m_iDirectWrites; }
+        amf_int64       GetSyncCount() const    { return m_iSyncCount; }
+        // false once the file system refused O_DIRECT
+        bool            IsDirectIO() const      { return m_bDirectIO; }
+
+    private:
+        static int      WritePacket(void* opaque, uint8_t* buf, int size);
+        static int64_t  Seek(void* opaque, int64_t offset, int whence);
+
+        int             Write(const uint8_t* buf, int size);
+        void            SetDirect(bool bDirect);
+
+        int             m_iFileDescriptor;
+        AVIOContext*    m_pContext;
+        uint8_t*        m_pBuffer;
+        bool            m_bAlignedBuffer;   // from posix_memalign, released with free()
+        bool            m_bDirectIO;        // requested
+        bool            m_bDirect;          // O_DIRECT currently set on the descriptor
+        amf_int64       m_iSyncInterval;
+        amf_int64       m_iUnsynced;
+        amf_int64       m_iPosition;
+        amf_int64       m_iSize;
+        amf_int64       m_iDirectWrites;
+        amf_int64       m_iSyncCount;
+
+        AMFFileWriterIO(const AMFFileWriterIO&);
+        AMFFileWriterIO& operator=(const AMFFileWriterIO&);
+    };
+} // namespace amf
@@ -34,299 +34,46 @@
 #include "H264Mp4ToAnnexB.h"
 #include "public/common/AMFFactory.h"
 #include "public/common/TraceAdapter.h"
-#include <limits.h>
 
 using namespace amf;
 
-//-------------------------------------------------------------------------------------------------
-// class H264Mp4ToAnnexB
-//------------------------------------------------------------------------------------------------
-#ifndef AV_RB16
-#   define AV_RB16(x)                           \
-    ((((const amf_uint8*)(x))[0] << 8) |         \
-     ((const amf_uint8*)(x))[1])
-#endif
-#ifndef AV_RB32
-#   define AV_RB32(x)                           \
-    ((((const amf_uint8*)(x))[0] << 24) |        \
-     (((const amf_uint8*)(x))[1] << 16) |        \
-     (((const amf_uint8*)(x))[2] <<  8) |        \
-     ((const amf_uint8*)(x))[3])
-#endif
-#ifndef AV_WB32
-#   define AV_WB32(p, d) do {                   \
-        ((amf_uint8*)(p))[3] = (d);              \
-        ((amf_uint8*)(p))[2] = (d)>>8;           \
-        ((amf_uint8*)(p))[1] = (d)>>16;          \
-        ((amf_uint8*)(p))[0] = (d)>>24;          \
-        } while(0)
-#endif
-
-#define AMF_INPUT_BUFFER_PADDING_SIZE 8
-
-
 #ifdef __USE_H264Mp4ToAnnexB
 //------------------------------------------------------------------------------------------------
-H264Mp4ToAnnexB::H264Mp4ToAnnexB() :
-m_lengthSize(0),
-m_firstIDR(0),
-m_pExtradata(NULL),
-m_ExtradataSize(0),
-m_pOutBuf(NULL),
-m_outBufSize(0)
+H264Mp4ToAnnexB::H264Mp4ToAnnexB()
 {
     g_AMFFactory.Init();
 }
 //-------------------------------------------------------------------------------------------------
 H264Mp4ToAnnexB::~H264Mp4ToAnnexB()
 {
-    if (m_pExtradata != NULL)
-    {
-        free(m_pExtradata);
-    }
-
-    if (m_pOutBuf != NULL)
-    {
-        free(m_pOutBuf);
-    }
-
+    m_Converter.Terminate();
     g_AMFFactory.Terminate();
 }
 //-------------------------------------------------------------------------------------------------
-static const amf_uint8 naluHeader[4] = { 0, 0, 0, 1 };
 int H264Mp4ToAnnexB::ProcessExtradata(const amf_uint8* pExtraData, amf_size extraDataSize)
 {
-    amf_uint16 unitSize;
-    amf_size totalSize = 0;
-    amf_uint8 *pOutData = NULL;
-    amf_uint8 unitNB = 0;
-    amf_uint8 spsDone = 0;
-    amf_uint8 spsSeen = 0;
-    amf_uint8 ppsSeen = 0;
-
-    // check if data already parocessed - if get annexB streams
+    // too short for avcC or Annex B parameter sets
     if (extraDataSize < 4)
     {
         return 1;
     }
-    if (pExtraData[0] != 1 && memcmp(pExtraData, naluHeader, 4) == 0)
-    {
-        m_pExtradata = (amf_uint8*)malloc(extraDataSize);
-        memcpy(m_pExtradata, pExtraData, extraDataSize);
-        m_ExtradataSize = extraDataSize;
-        m_firstIDR = 1;
-        return 0;
-    }
-
-    const amf_uint8* extradata = pExtraData + 4;
-
-    // retrieve length coded size for future use - AVCC nal units have size of this length at the beginning
-    m_lengthSize = (*extradata++ & 0x3) + 1;
-    if (m_lengthSize == 3)
-    {
-        return 1; // error - wrong value
-    }
-
-    // retrieve sps and pps unit(s)
-    unitNB = *extradata++ & 0x1f; // number of sps unit(s) 
-    if (!unitNB)
-    {
-        goto pps;
-    }
-    else
-    {
-        spsSeen = 1;
-    }
-
-    while (unitNB--)
-    {
-        void *tmp;
-
-        unitSize = AV_RB16(extradata);
-        totalSize += unitSize + 4;
-        if (totalSize > INT_MAX - AMF_INPUT_BUFFER_PADDING_SIZE ||
-            extradata + 2 + unitSize > pExtraData + extraDataSize) {
-            free(pOutData);
-            return 1;
-        }
-        tmp = realloc(pOutData, totalSize + AMF_INPUT_BUFFER_PADDING_SIZE);
-        if (!tmp) {
-            free(pOutData);
-            return 1;
-        }
-        pOutData = (amf_uint8*)tmp;
-        memcpy(pOutData + totalSize - unitSize - 4, naluHeader, 4);
-        memcpy(pOutData + totalSize - unitSize, extradata + 2, unitSize);
-        extradata += 2 + unitSize;
-    pps:
-        if (!unitNB && !spsDone++) {
-            unitNB = *extradata++; // number of pps unit(s) 
-            if (unitNB)
-                ppsSeen = 1;
-        }
-    }
-
-    if (pOutData)
-        memset(pOutData + totalSize, 0, AMF_INPUT_BUFFER_PADDING_SIZE);
-
-    if (!spsSeen){
-        AMFTraceError(AMF_FACILITY, L"ProcessExtradata() - Warning: SPS NALU missing or invalid. The resulting stream may not play. ");
-    }
-    if (!ppsSeen){
-        AMFTraceError(AMF_FACILITY, L"ProcessExtradata() - Warning: PPS NALU missing or invalid. The resulting stream may not play. ");
-    }
-    m_pExtradata = pOutData;
-    m_ExtradataSize = totalSize;
-    m_firstIDR = 1;
-    return 0;
+    AMF_RESULT res = m_Converter.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED,
+        AMFBitstreamConverter::FORMAT_ANNEXB, pExtraData, extraDataSize);
+    return res == AMF_OK ? 0 : 1;
 }
 //-------------------------------------------------------------------------------------------------
 int H264Mp4ToAnnexB::Filter(amf_uint8** pOutBuf, amf_size* pOutBufSize, amf_uint8* pBuf, amf_size bufSize)
 {
-    amf_uint8 unitType = 0;
-    amf_int32 nalSize = 0;
-    amf_uint32 cumulSize = 0;
-    const amf_uint8* pBufEnd = pBuf + bufSize;
-
-    // check if data already parocessed - if get annexB streams
-    if (bufSize>4 && memcmp(pBuf, naluHeader, 4) == 0)
-    {
-        *pOutBuf = pBuf;
-        *pOutBufSize = bufSize;
-
-        return 0;
-    }
-
-
-    /* nothing to filter */
-    if (!m_pExtradata || m_ExtradataSize < 6 || m_lengthSize == 0)
-    {
-        *pOutBuf = pBuf;
-        *pOutBufSize = bufSize;
-
-        return 0;
-    }
-
-    *pOutBufSize = 0;
-    *pOutBuf = NULL;
-
-    AMF_RESULT res = AMF_OK;
-
-    do
-    {
-        if (pBuf + m_lengthSize > pBufEnd)
-        {
-            res = AMF_FAIL;
-            break;
-        }
-
-        if (m_lengthSize == 1)
-        {
-            nalSize = pBuf[0];
-        }
-        else if (m_lengthSize == 2)
-        {
-            nalSize = AV_RB16(pBuf);
-        }
-        else
-        {
-            nalSize = AV_RB32(pBuf);
-        }
-
-        pBuf += m_lengthSize;
-        unitType = *pBuf & 0x1f;
-
-        if (unitType == 0) //MM added this condition to remove trailing zeros
-        {
-            break;
-        }
-
-        if (pBuf + nalSize > pBufEnd || nalSize < 0)
-        {
-            res = AMF_FAIL;
-        }
-
-        /* prepend only to the first type 5 NAL unit of an IDR picture */
-        //MM - 6 comes first in some files - try this
-        //        if (first_idr && unit_type == 5 ) {
-        if (m_firstIDR && (unitType == 5 || unitType == 6 || unitType == 1))
-        {
-            if (AllocAndCopy(pOutBufSize, m_pExtradata, m_ExtradataSize, pBuf, nalSize) < 0)
-            {
-                res = AMF_FAIL;
-                break;
-            }
-            m_firstIDR = 0;
-        }
-        else
-        {
-            if (AllocAndCopy(pOutBufSize, NULL, 0, pBuf, nalSize) < 0)
-            {
-                res = AMF_FAIL;
-                break;
-            }
-        }
-
-        pBuf += nalSize;
-        cumulSize += nalSize + m_lengthSize;
-    } while (cumulSize < bufSize);
-
-    if (res == AMF_OK)
-    {
-        *pOutBuf = m_pOutBuf;
-        return 1;
-    }
-    else
+    const amf_uint8* pOut = NULL;
+    if (m_Converter.Filter(pBuf, bufSize, &pOut, pOutBufSize) != AMF_OK)
     {
-        if (pOutBuf != NULL)
-        {
-            free(*pOutBuf);
-        }
-
+        *pOutBuf = NULL;
         *pOutBufSize = 0;
-
         return 0;
     }
-
-
-}
-//-------------------------------------------------------------------------------------------------
-int H264Mp4ToAnnexB::AllocAndCopy(amf_size* pOutBufSize, const amf_uint8* pSpsPps, amf_size spsPpsSize, const amf_uint8* pInData, amf_size inDataSize)
-{
-    amf_size offset = *pOutBufSize;
-    amf_uint8 nal_header_size = offset ? 3 : 4;
-
-    *pOutBufSize += spsPpsSize + inDataSize + nal_header_size;
-
-    if (*pOutBufSize > m_outBufSize) //MM fast realloc
-    {
-        m_pOutBuf = reinterpret_cast<amf_uint8*>(realloc(m_pOutBuf, *pOutBufSize));
-        m_outBufSize = *pOutBufSize;
-    }
-    if (!m_pOutBuf)
-    {
-        return -1;
-    }
-
-    if (pSpsPps)
-    {
-        memcpy(m_pOutBuf + offset, pSpsPps, spsPpsSize);
-    }
-
-    memcpy(m_pOutBuf + spsPpsSize + nal_header_size + offset, pInData, inDataSize);
-
-    if (!offset)
-    {
-        AV_WB32(m_pOutBuf + spsPpsSize, 1);
-    }
-    else
-    {
-        (m_pOutBuf + offset + spsPpsSize)[0] = 0;
-        (m_pOutBuf + offset + spsPpsSize)[1] = 0;
-        (m_pOutBuf + offset + spsPpsSize)[2] = 1;
-    }
-
-    return 0;
+    *pOutBuf = const_cast<amf_uint8*>(pOut);
+    // 0 - passed through as is
+    return pOut != pBuf ? 1 : 0;
 }
 //-------------------------------------------------------------------------------------------------
-#endif// __USE_H264Mp4ToAnnexB
\ No newline at end of file
+#endif// __USE_H264Mp4ToAnnexB
@@ -33,6 +33,7 @@
 #pragma once
 
 #include "public/include/components/Component.h"
+#include "BitstreamConverter.h"
 
 #define __USE_H264Mp4ToAnnexB
 
@@ -40,6 +41,7 @@ namespace amf
 {
 
     //-------------------------------------------------------------------------------------------------
+    // avcC to Annex B on top of AMFBitstreamConverter
 #ifdef __USE_H264Mp4ToAnnexB
     class H264Mp4ToAnnexB
     {
@@ -50,23 +52,15 @@ namespace amf
         int ProcessExtradata(const amf_uint8* pExtraData, amf_size extraDataSize);
         int Filter(amf_uint8** pOutBuf, amf_size* pOutBufSize, amf_uint8* pBuf, amf_size bufSize);
 
-        void*  GetExtraData()      { return m_pExtradata; }
-        size_t GetExtraDataSize()  { return m_ExtradataSize; }
-
-    protected:
-        int AllocAndCopy(amf_size* pOutBufSize, const amf_uint8* pSpsPps, amf_size spsPpsSize, const amf_uint8* pInData, amf_size inDataSize);
+        void*  GetExtraData()      { return m_Converter.GetParameterSets().empty() ? NULL : (void*)m_Converter.GetParameterSets().data(); }
+        size_t GetExtraDataSize()  { return m_Converter.GetParameterSets().size(); }
 
     private:
         H264Mp4ToAnnexB(const H264Mp4ToAnnexB&);
         H264Mp4ToAnnexB& operator=(const H264Mp4ToAnnexB&);
 
     private:
-        amf_uint8  m_lengthSize;
-        amf_uint8  m_firstIDR;
-        amf_uint8  *m_pExtradata;
-        amf_size   m_ExtradataSize;
-        amf_uint8  *m_pOutBuf;
-        amf_size   m_outBufSize;
+        AMFBitstreamConverter   m_Converter;
     };
 #endif
 
@@ -0,0 +1,290 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+extern "C"
+{
+#if defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable:4244) // possible loss of data with conversion
+#endif
+
+    #include "libavformat/internal.h"
+    #include "libavutil/crc.h"
+
+#if defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+}
+
+#include "KeyframeIndex.h"
+#include "public/common/Thread.h"
+#include "public/common/TraceAdapter.h"
+
+#include <algorithm>
+
+#define AMF_FACILITY L"AMFKeyframeIndex"
+
+using namespace amf;
+
+static const char       KEYFRAME_INDEX_MAGIC[8]     = { 'A', 'M', 'F', 'K', 'F', 'I', 'D', 'X' };
+static const amf_uint32 KEYFRAME_INDEX_VERSION      = 1;
+static const amf_int64  KEYFRAME_INDEX_ENTRY_SIZE   = 3 * sizeof(amf_int64);
+static const int        IDENTIFY_BYTES              = 64 * 1024;
+
+//-------------------------------------------------------------------------------------------------
+static bool EntryLess(const AMFKeyframeIndex::Entry& left, const AMFKeyframeIndex::Entry& right)
+{
+    return left.dts < right.dts;
+}
+//-------------------------------------------------------------------------------------------------
+AMFKeyframeIndex::AMFKeyframeIndex()
+{
+    m_Source.fileSize = 0;
+    m_Source.crc = 0;
+    m_Source.streamIndex = -1;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFKeyframeIndex::Identify(const char* url, amf_int32 streamIndex, Source* pSource)
+{
+    AMF_RETURN_IF_INVALID_POINTER(url, L"Identify() - url == NULL");
+    AMF_RETURN_IF_INVALID_POINTER(pSource, L"Identify() - pSource == NULL");
+
+    AVIOContext* pIO = NULL;
+    AMF_RETURN_IF_FALSE(avio_open(&pIO, url, AVIO_FLAG_READ) >= 0, AMF_FILE_NOT_OPEN, L"Identify() - cannot open %S", url);
+
+    amf_vector<amf_uint8> data(IDENTIFY_BYTES);
+    const int read = avio_read(pIO, data.data(), IDENTIFY_BYTES);
+
+    pSource->fileSize = avio_size(pIO);
+    pSource->crc = read > 0 ? av_crc(av_crc_get_table(AV_CRC_32_IEEE_LE), 0xFFFFFFFF, data.data(), read) : 0;
+    pSource->streamIndex = streamIndex;
+
+    avio_closep(&pIO);
+    return pSource->fileSize > 0 ? AMF_OK : AMF_NOT_SUPPORTED;
+}
+//-------------------------------------------------------------------------------------------------
+// must stay in sync with the video path of AMFFileDemuxerFFMPEGImpl::ReadPacket()
+amf_int64 AMFKeyframeIndex::NormalizeDts(const AVStream* ist, const AVPacket* pPacket, amf_int64 frame)
+{
+    if (pPacket->dts == AV_NOPTS_VALUE)
+    {
+        amf_int64 dts = av_rescale(frame, ist->time_base.den, (int64_t)ist->time_base.num);
+        return av_rescale(dts, ist->r_frame_rate.den, (int64_t)ist->r_frame_rate.num);
+    }
+
+    amf_int64 dts = pPacket->dts;
+    if (pPacket->pts != AV_NOPTS_VALUE && dts < 0)
+    {
+        dts += 1LL << ist->pts_wrap_bits;
+    }
+    const amf_int64 firstDts = cffstream(ist)->first_dts;
+    if (firstDts != AV_NOPTS_VALUE)
+    {
+        dts -= firstDts;
+    }
+    return dts;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFKeyframeIndex::Build(const char* url, const Source& source, AMFThread* pThread)
+{
+    AMF_RETURN_IF_INVALID_POINTER(url, L"Build() - url == NULL");
+
+    Clear();
+
+    // a private context, the demuxer keeps reading from its own while we scan
+    AVFormatContext* pContext = NULL;
+    AMF_RETURN_IF_FALSE(avformat_open_input(&pContext, url, NULL, NULL) >= 0, AMF_FILE_NOT_OPEN, L"Build() - cannot open %S", url);
+    if (avformat_find_stream_info(pContext, NULL) < 0 || source.streamIndex < 0 || source.streamIndex >= (amf_int32)pContext->nb_streams)
+    {
+        avformat_close_input(&pContext);
+        AMF_RETURN_IF_FALSE(false, AMF_INVALID_ARG, L"Build() - stream %d not found in %S", source.streamIndex, url);
+    }
+
+    // only the index stream is needed, skip demuxing work for the others
+    for (unsigned int i = 0; i < pContext->nb_streams; i++)
+    {
+        if ((amf_int32)i != source.streamIndex)
+        {
+            pContext->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    const AVStream* ist = pContext->streams[source.streamIndex];
+    AVPacket* pPacket = av_packet_alloc();
+    amf_int64 frame = 0;
+    bool bStopped = false;
+    while (pPacket != NULL)
+    {
+        if (pThread != NULL && pThread->StopRequested())
+        {
+            bStopped = true;
+            break;
+        }
+        if (av_read_frame(pContext, pPacket) < 0)
+        {
+            break;
+        }
+        if (pPacket->stream_index == source.streamIndex)
+        {
+            if ((pPacket->flags & AV_PKT_FLAG_KEY) != 0 && pPacket->pos >= 0)
+            {
+                Entry entry = { pPacket->pos, NormalizeDts(ist, pPacket, frame), frame };
+                m_Entries.push_back(entry);
+            }
+            frame++;
+        }
+        av_packet_unref(pPacket);
+    }
+    av_packet_free(&pPacket);
+    avformat_close_input(&pContext);
+
+    if (bStopped)
+    {
+        Clear();
+        return AMF_FAIL;
+    }
+    AMF_RETURN_IF_FALSE(!m_Entries.empty(), AMF_NOT_FOUND, L"Build() - no keyframes with positions in %S", url);
+
+    std::stable_sort(m_Entries.begin(), m_Entries.end(), EntryLess);
+    m_Source = source;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFKeyframeIndex::Load(const char* path, const Source& source)
+{
+    AMF_RETURN_IF_INVALID_POINTER(path, L"Load() - path == NULL");
+
+    Clear();
+
+    AVIOContext* pIO = NULL;
+    if (avio_open(&pIO, path, AVIO_FLAG_READ) < 0)
+    {
+        // no cache yet - not an error
+        return AMF_FILE_NOT_OPEN;
+    }
+
+    char magic[sizeof(KEYFRAME_INDEX_MAGIC)] = {};
+    avio_read(pIO, (unsigned char*)magic, sizeof(magic));
+    const amf_uint32 version     = avio_rl32(pIO);
+    const amf_int32  streamIndex = (amf_int32)avio_rl32(pIO);
+    const amf_int64  fileSize    = (amf_int64)avio_rl64(pIO);
+    const amf_uint32 crc         = avio_rl32(pIO);
+    const amf_int64  count       = (amf_int64)avio_rl64(pIO);
+
+    // a stale cache (file replaced or edited) is rebuilt by the caller
+    const amf_int64 available = avio_size(pIO) - avio_tell(pIO);
+    if (memcmp(magic, KEYFRAME_INDEX_MAGIC, sizeof(magic)) != 0 || version != KEYFRAME_INDEX_VERSION ||
+        streamIndex != source.streamIndex || fileSize != source.fileSize || crc != source.crc ||
+        count <= 0 || count * KEYFRAME_INDEX_ENTRY_SIZE > available)
+    {
+        avio_closep(&pIO);
+        return AMF_INVALID_DATA_TYPE;
+    }
+
+    m_Entries.resize((size_t)count);
+    for (amf_int64 i = 0; i < count; i++)
+    {
+        m_Entries[i].pos = (amf_int64)avio_rl64(pIO);
+        m_Entries[i].dts = (amf_int64)avio_rl64(pIO);
+        m_Entries[i].frame = (amf_int64)avio_rl64(pIO);
+    }
+    const bool bError = pIO->error != 0 || avio_feof(pIO);
+    avio_closep(&pIO);
+
+    if (bError)
+    {
+        Clear();
+        return AMF_FAIL;
+    }
+    m_Source = source;
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMFKeyframeIndex::Save(const char* path) const
+{
+    AMF_RETURN_IF_INVALID_POINTER(path, L"Save() - path == NULL");
+    AMF_RETURN_IF_FALSE(!m_Entries.empty(), AMF_NOT_INITIALIZED, L"Save() - index is empty");
+
+    AVIOContext* pIO = NULL;
+    AMF_RETURN_IF_FALSE(avio_open(&pIO, path, AVIO_FLAG_WRITE) >= 0, AMF_FILE_NOT_OPEN, L"Save() - cannot create %S", path);
+
+    avio_write(pIO, (const unsigned char*)KEYFRAME_INDEX_MAGIC, sizeof(KEYFRAME_INDEX_MAGIC));
+    avio_wl32(pIO, KEYFRAME_INDEX_VERSION);
+    avio_wl32(pIO, (unsigned int)m_Source.streamIndex);
+    avio_wl64(pIO, (uint64_t)m_Source.fileSize);
+    avio_wl32(pIO, m_Source.crc);
+    avio_wl64(pIO, (uint64_t)m_Entries.size());
+    for (amf_vector<Entry>::const_iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+    {
+        avio_wl64(pIO, (uint64_t)it->pos);
+        avio_wl64(pIO, (uint64_t)it->dts);
+        avio_wl64(pIO, (uint64_t)it->frame);
+    }
+    avio_flush(pIO);
+    const bool bError = pIO->error != 0;
+    avio_closep(&pIO);
+
+    AMF_RETURN_IF_FALSE(!bError, AMF_FAIL, L"Save() - write to %S failed", path);
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndex::Swap(AMFKeyframeIndex& other)
+{
+    std::swap(m_Source, other.m_Source);
+    m_Entries.swap(other.m_Entries);
+}
+//-------------------------------------------------------------------------------------------------
+void AMFKeyframeIndex::Clear()
+{
+    m_Entries.clear();
+    m_Source.streamIndex = -1;
+}
+//-------------------------------------------------------------------------------------------------
+const AMFKeyframeIndex::Entry* AMFKeyframeIndex::FindPrev(amf_int64 dts) const
+{
+    Entry key = { 0, dts, 0 };
+    amf_vector<Entry>::const_iterator it = std::upper_bound(m_Entries.begin(), m_Entries.end(), key, EntryLess);
+    if (it == m_Entries.begin())
+    {
+        return m_Entries.empty() ? NULL : &m_Entries.front();
+    }
+    return &*(--it);
+}
+//-------------------------------------------------------------------------------------------------
+const AMFKeyframeIndex::Entry* AMFKeyframeIndex::FindNext(amf_int64 dts) const
+{
+    Entry key = { 0, dts, 0 };
+    amf_vector<Entry>::const_iterator it = std::lower_bound(m_Entries.begin(), m_Entries.end(), key, EntryLess);
+    return it != m_Entries.end() ? &*it : NULL;
+}
+//-------------------------------------------------------------------------------------------------
@@ -0,0 +1,89 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/Result.h"
+#include "public/common/AMFSTL.h"
+
+struct AVStream;
+struct AVPacket;
+
+namespace amf
+{
+    class AMFThread;
+
+    //-------------------------------------------------------------------------------------------------
+    // Keyframe positions of one stream, built by a scan of the whole file and
+    // cached in a small sidecar file. Lets Seek() jump straight to the byte
+    // offset of a keyframe for formats without a usable index of their own.
+    class AMFKeyframeIndex
+    {
+    public:
+        struct Entry
+        {
+            amf_int64   pos;        // byte offset of the packet in the file
+            amf_int64   dts;        // stream time base, normalized like the demuxer output
+            amf_int64   frame;      // packet number in the stream, used to rebuild missing timestamps
+        };
+
+        // identifies the file and stream an index belongs to
+        struct Source
+        {
+            amf_int64   fileSize;
+            amf_uint32  crc;        // of the first 64 KB
+            amf_int32   streamIndex;
+        };
+
+        AMFKeyframeIndex();
+
+        static AMF_RESULT   Identify(const char* url, amf_int32 streamIndex, Source* pSource);
+        static amf_int64    NormalizeDts(const AVStream* ist, const AVPacket* pPacket, amf_int64 frame);
+
+        // pThread is polled for stop requests, may be NULL
+        AMF_RESULT      Build(const char* url, const Source& source, AMFThread* pThread);
+        AMF_RESULT      Load(const char* path, const Source& source);
+        AMF_RESULT      Save(const char* path) const;
+
+        void            Swap(AMFKeyframeIndex& other);
+        void            Clear();
+        bool            IsEmpty() const         { return m_Entries.empty(); }
+        amf_int32       GetStreamIndex() const  { return m_Entries.empty() ? -1 : m_Source.streamIndex; }
+
+        const Entry*    FindPrev(amf_int64 dts) const;     // last keyframe at or before dts
+        const Entry*    FindNext(amf_int64 dts) const;     // first keyframe at or after dts
+
+    private:
+        Source              m_Source;
+        amf_vector<Entry>   m_Entries;      // sorted by dts
+    };
+} // namespace amf
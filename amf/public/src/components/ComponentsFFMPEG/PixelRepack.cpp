@@ -0,0 +1,679 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "PixelRepack.h"
+
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define AMF_REPACK_X86
+    #include <immintrin.h>
+    #include "public/common/CPUCaps.h"
+#endif
+
+#if defined(AMF_REPACK_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define AMF_REPACK_TARGET_SSE41     __attribute__((target("ssse3,sse4.1")))
+    #define AMF_REPACK_TARGET_AVX2      __attribute__((target("avx2")))
+    #define AMF_REPACK_TARGET_AVX512    __attribute__((target("avx512f,avx512bw")))
+#else
+    #define AMF_REPACK_TARGET_SSE41
+    #define AMF_REPACK_TARGET_AVX2
+    #define AMF_REPACK_TARGET_AVX512
+#endif
+
+using namespace amf;
+
+//-------------------------------------------------------------------------------------------------
+// scalar reference kernels - the SIMD versions fall back to these for the line tails
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV8_C(amf_uint8* pDst, const amf_uint8* pU, const amf_uint8* pV, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[2 * x + 0] = pU[x];
+        pDst[2 * x + 1] = pV[x];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void InterleaveUV16_C(amf_uint16* pDst, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    // FFMPEG outputs in LSB format but we want MSB
+    // 10-bit example:
+    //     (LSB)         :  000000DD DDDDDDDD
+    //     we want (MSB) :  DDDDDDDD DD000000
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[2 * x + 0] = amf_uint16(pU[x] << shift);
+        pDst[2 * x + 1] = amf_uint16(pV[x] << shift);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void Shift16_C(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[x] = amf_uint16(pSrc[x] << shift);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void PackY210_C(amf_uint16* pDst, const amf_uint16* pY, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = amf_uint16(pU[x] << shift);
+        pDst[4 * x + 1] = amf_uint16(pY[2 * x] << shift);
+        pDst[4 * x + 2] = amf_uint16(pV[x] << shift);
+        pDst[4 * x + 3] = amf_uint16(pY[2 * x + 1] << shift);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void PackY416_C(amf_uint16* pDst, const amf_uint16* pY, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = amf_uint16(pU[x] << shift);
+        pDst[4 * x + 1] = amf_uint16(pY[x] << shift);
+        pDst[4 * x + 2] = amf_uint16(pV[x] << shift);
+        pDst[4 * x + 3] = 65535;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48BEToRGBA8_C(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = pSrc[6 * x + 0];
+        pDst[4 * x + 1] = pSrc[6 * x + 2];
+        pDst[4 * x + 2] = pSrc[6 * x + 4];
+        pDst[4 * x + 3] = 255;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48LEToRGBA8_C(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = pSrc[6 * x + 1];
+        pDst[4 * x + 1] = pSrc[6 * x + 3];
+        pDst[4 * x + 2] = pSrc[6 * x + 5];
+        pDst[4 * x + 3] = 255;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGBA64LEToRGBA8_C(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = pSrc[8 * x + 1];
+        pDst[4 * x + 1] = pSrc[8 * x + 3];
+        pDst[4 * x + 2] = pSrc[8 * x + 5];
+        pDst[4 * x + 3] = pSrc[8 * x + 7];
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48BEToRGBA16_C(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        pDst[4 * x + 0] = amf_uint16((pSrc[6 * x + 0] << 8) | pSrc[6 * x + 1]);
+        pDst[4 * x + 1] = amf_uint16((pSrc[6 * x + 2] << 8) | pSrc[6 * x + 3]);
+        pDst[4 * x + 2] = amf_uint16((pSrc[6 * x + 4] << 8) | pSrc[6 * x + 5]);
+        pDst[4 * x + 3] = 65535;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+static void RGB48LEToRGBA16_C(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    for (amf_size x = 0; x < count; x++)
+    {
+        memcpy(pDst + 4 * x, pSrc + 6 * x, 3 * sizeof(amf_uint16));
+        pDst[4 * x + 3] = 65535;
+    }
+}
+
+#if defined(AMF_REPACK_X86)
+//-------------------------------------------------------------------------------------------------
+// shuffle masks for the 16-bit RGB kernels; each picks two pixels from the 12 low bytes of a
+// register, 0x80 zeroes the byte so alpha can be or-ed in
+//-------------------------------------------------------------------------------------------------
+static const amf_int8 s_RGB48BEToRGBA8Lo[16]  = { 0, 2, 4, -128, 6, 8, 10, -128, -128, -128, -128, -128, -128, -128, -128, -128 };
+static const amf_int8 s_RGB48BEToRGBA8Hi[16]  = { -128, -128, -128, -128, -128, -128, -128, -128, 0, 2, 4, -128, 6, 8, 10, -128 };
+static const amf_int8 s_RGB48LEToRGBA8Lo[16]  = { 1, 3, 5, -128, 7, 9, 11, -128, -128, -128, -128, -128, -128, -128, -128, -128 };
+static const amf_int8 s_RGB48LEToRGBA8Hi[16]  = { -128, -128, -128, -128, -128, -128, -128, -128, 1, 3, 5, -128, 7, 9, 11, -128 };
+static const amf_int8 s_RGB48BEToRGBA16[16]   = { 1, 0, 3, 2, 5, 4, -128, -128, 7, 6, 9, 8, 11, 10, -128, -128 };
+static const amf_int8 s_RGB48LEToRGBA16[16]   = { 0, 1, 2, 3, 4, 5, -128, -128, 6, 7, 8, 9, 10, 11, -128, -128 };
+
+//-------------------------------------------------------------------------------------------------
+// SSE4.1
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void InterleaveUV8_SSE41(amf_uint8* pDst, const amf_uint8* pU, const amf_uint8* pV, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i u = _mm_loadu_si128((const __m128i*)(pU + x));
+        const __m128i v = _mm_loadu_si128((const __m128i*)(pV + x));
+        _mm_storeu_si128((__m128i*)(pDst + 2 * x),      _mm_unpacklo_epi8(u, v));
+        _mm_storeu_si128((__m128i*)(pDst + 2 * x + 16), _mm_unpackhi_epi8(u, v));
+    }
+    InterleaveUV8_C(pDst + 2 * x, pU + x, pV + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void InterleaveUV16_SSE41(amf_uint16* pDst, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i u = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pU + x)), s);
+        const __m128i v = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pV + x)), s);
+        _mm_storeu_si128((__m128i*)(pDst + 2 * x),     _mm_unpacklo_epi16(u, v));
+        _mm_storeu_si128((__m128i*)(pDst + 2 * x + 8), _mm_unpackhi_epi16(u, v));
+    }
+    InterleaveUV16_C(pDst + 2 * x, pU + x, pV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void Shift16_SSE41(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(pSrc + x));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(pSrc + x + 8));
+        _mm_storeu_si128((__m128i*)(pDst + x),     _mm_sll_epi16(a, s));
+        _mm_storeu_si128((__m128i*)(pDst + x + 8), _mm_sll_epi16(b, s));
+    }
+    Shift16_C(pDst + x, pSrc + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void PackY210_SSE41(amf_uint16* pDst, const amf_uint16* pY, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i u  = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pU + x)), s);
+        const __m128i v  = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pV + x)), s);
+        const __m128i y0 = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pY + 2 * x)), s);
+        const __m128i y1 = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pY + 2 * x + 8)), s);
+        const __m128i uvLo = _mm_unpacklo_epi16(u, v);
+        const __m128i uvHi = _mm_unpackhi_epi16(u, v);
+
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm_storeu_si128((__m128i*)(pOut + 0),  _mm_unpacklo_epi16(uvLo, y0));
+        _mm_storeu_si128((__m128i*)(pOut + 8),  _mm_unpackhi_epi16(uvLo, y0));
+        _mm_storeu_si128((__m128i*)(pOut + 16), _mm_unpacklo_epi16(uvHi, y1));
+        _mm_storeu_si128((__m128i*)(pOut + 24), _mm_unpackhi_epi16(uvHi, y1));
+    }
+    PackY210_C(pDst + 4 * x, pY + 2 * x, pU + x, pV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void PackY416_SSE41(amf_uint16* pDst, const amf_uint16* pY, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    const __m128i s     = _mm_cvtsi32_si128(shift);
+    const __m128i alpha = _mm_set1_epi16(-1);
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m128i u = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pU + x)), s);
+        const __m128i v = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pV + x)), s);
+        const __m128i y = _mm_sll_epi16(_mm_loadu_si128((const __m128i*)(pY + x)), s);
+        const __m128i uvLo = _mm_unpacklo_epi16(u, v);
+        const __m128i uvHi = _mm_unpackhi_epi16(u, v);
+        const __m128i yaLo = _mm_unpacklo_epi16(y, alpha);
+        const __m128i yaHi = _mm_unpackhi_epi16(y, alpha);
+
+        amf_uint16* pOut = pDst + 4 * x;
+        _mm_storeu_si128((__m128i*)(pOut + 0),  _mm_unpacklo_epi16(uvLo, yaLo));
+        _mm_storeu_si128((__m128i*)(pOut + 8),  _mm_unpackhi_epi16(uvLo, yaLo));
+        _mm_storeu_si128((__m128i*)(pOut + 16), _mm_unpacklo_epi16(uvHi, yaHi));
+        _mm_storeu_si128((__m128i*)(pOut + 24), _mm_unpackhi_epi16(uvHi, yaHi));
+    }
+    PackY416_C(pDst + 4 * x, pY + x, pU + x, pV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static amf_size RGB48ToRGBA8_SSE41(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count, const amf_int8* pMaskLo, const amf_int8* pMaskHi)
+{
+    const __m128i maskLo = _mm_loadu_si128((const __m128i*)pMaskLo);
+    const __m128i maskHi = _mm_loadu_si128((const __m128i*)pMaskHi);
+    const __m128i alpha  = _mm_set1_epi32(amf_int32(0xFF000000));
+    amf_size x = 0;
+    // 4 pixels are 24 bytes but the second load reads 28, keep it inside the line
+    for (; x + 5 <= count; x += 4)
+    {
+        const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 6 * x)), maskLo);
+        const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 6 * x + 12)), maskHi);
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x), _mm_or_si128(_mm_or_si128(a, b), alpha));
+    }
+    return x;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void RGB48BEToRGBA8_SSE41(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const amf_size x = RGB48ToRGBA8_SSE41(pDst, pSrc, count, s_RGB48BEToRGBA8Lo, s_RGB48BEToRGBA8Hi);
+    RGB48BEToRGBA8_C(pDst + 4 * x, pSrc + 6 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void RGB48LEToRGBA8_SSE41(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const amf_size x = RGB48ToRGBA8_SSE41(pDst, pSrc, count, s_RGB48LEToRGBA8Lo, s_RGB48LEToRGBA8Hi);
+    RGB48LEToRGBA8_C(pDst + 4 * x, pSrc + 6 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void RGBA64LEToRGBA8_SSE41(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 4 <= count; x += 4)
+    {
+        const __m128i a = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(pSrc + 8 * x)), 8);
+        const __m128i b = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(pSrc + 8 * x + 16)), 8);
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x), _mm_packus_epi16(a, b));
+    }
+    RGBA64LEToRGBA8_C(pDst + 4 * x, pSrc + 8 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static amf_size RGB48ToRGBA16_SSE41(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count, const amf_int8* pMask)
+{
+    const __m128i mask  = _mm_loadu_si128((const __m128i*)pMask);
+    const __m128i alpha = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    amf_size x = 0;
+    // 2 pixels are 12 bytes but a load reads 16, keep the last one inside the line
+    for (; x + 5 <= count; x += 4)
+    {
+        const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 6 * x)), mask);
+        const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 6 * x + 12)), mask);
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x),     _mm_or_si128(a, alpha));
+        _mm_storeu_si128((__m128i*)(pDst + 4 * x + 8), _mm_or_si128(b, alpha));
+    }
+    return x;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void RGB48BEToRGBA16_SSE41(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const amf_size x = RGB48ToRGBA16_SSE41(pDst, pSrc, count, s_RGB48BEToRGBA16);
+    RGB48BEToRGBA16_C(pDst + 4 * x, pSrc + 6 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_SSE41
+static void RGB48LEToRGBA16_SSE41(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const amf_size x = RGB48ToRGBA16_SSE41(pDst, pSrc, count, s_RGB48LEToRGBA16);
+    RGB48LEToRGBA16_C(pDst + 4 * x, pSrc + 6 * x, count - x);
+}
+
+//-------------------------------------------------------------------------------------------------
+// AVX2 - unpack and shuffle work within 128-bit lanes, the lanes are put back in order
+// with permute2x128 before storing
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static inline __m256i LoadLanes(const amf_uint8* pLo, const amf_uint8* pHi)
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)pLo)), _mm_loadu_si128((const __m128i*)pHi), 1);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void InterleaveUV8_AVX2(amf_uint8* pDst, const amf_uint8* pU, const amf_uint8* pV, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        const __m256i u  = _mm256_loadu_si256((const __m256i*)(pU + x));
+        const __m256i v  = _mm256_loadu_si256((const __m256i*)(pV + x));
+        const __m256i lo = _mm256_unpacklo_epi8(u, v);
+        const __m256i hi = _mm256_unpackhi_epi8(u, v);
+        _mm256_storeu_si256((__m256i*)(pDst + 2 * x),      _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(pDst + 2 * x + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    InterleaveUV8_SSE41(pDst + 2 * x, pU + x, pV + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void InterleaveUV16_AVX2(amf_uint16* pDst, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m256i u  = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pU + x)), s);
+        const __m256i v  = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pV + x)), s);
+        const __m256i lo = _mm256_unpacklo_epi16(u, v);
+        const __m256i hi = _mm256_unpackhi_epi16(u, v);
+        _mm256_storeu_si256((__m256i*)(pDst + 2 * x),      _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(pDst + 2 * x + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    InterleaveUV16_SSE41(pDst + 2 * x, pU + x, pV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void Shift16_AVX2(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(pSrc + x));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(pSrc + x + 16));
+        _mm256_storeu_si256((__m256i*)(pDst + x),      _mm256_sll_epi16(a, s));
+        _mm256_storeu_si256((__m256i*)(pDst + x + 16), _mm256_sll_epi16(b, s));
+    }
+    Shift16_SSE41(pDst + x, pSrc + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void StoreQuads_AVX2(amf_uint16* pOut, __m256i a, __m256i b, __m256i c, __m256i d)
+{
+    // a = [0 1 | 8 9], b = [2 3 | 10 11], c = [4 5 | 12 13], d = [6 7 | 14 15] in 64-bit groups
+    _mm256_storeu_si256((__m256i*)(pOut + 0),  _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256((__m256i*)(pOut + 16), _mm256_permute2x128_si256(c, d, 0x20));
+    _mm256_storeu_si256((__m256i*)(pOut + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    _mm256_storeu_si256((__m256i*)(pOut + 48), _mm256_permute2x128_si256(c, d, 0x31));
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void PackY210_AVX2(amf_uint16* pDst, const amf_uint16* pY, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m256i u  = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pU + x)), s);
+        const __m256i v  = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pV + x)), s);
+        const __m256i y0 = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pY + 2 * x)), s);
+        const __m256i y1 = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pY + 2 * x + 16)), s);
+        // match the luma pairs to the lanes the chroma unpack produces
+        const __m256i yLo  = _mm256_permute2x128_si256(y0, y1, 0x20);
+        const __m256i yHi  = _mm256_permute2x128_si256(y0, y1, 0x31);
+        const __m256i uvLo = _mm256_unpacklo_epi16(u, v);
+        const __m256i uvHi = _mm256_unpackhi_epi16(u, v);
+
+        StoreQuads_AVX2(pDst + 4 * x,
+            _mm256_unpacklo_epi16(uvLo, yLo), _mm256_unpackhi_epi16(uvLo, yLo),
+            _mm256_unpacklo_epi16(uvHi, yHi), _mm256_unpackhi_epi16(uvHi, yHi));
+    }
+    PackY210_SSE41(pDst + 4 * x, pY + 2 * x, pU + x, pV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void PackY416_AVX2(amf_uint16* pDst, const amf_uint16* pY, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    const __m128i s     = _mm_cvtsi32_si128(shift);
+    const __m256i alpha = _mm256_set1_epi16(-1);
+    amf_size x = 0;
+    for (; x + 16 <= count; x += 16)
+    {
+        const __m256i u = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pU + x)), s);
+        const __m256i v = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pV + x)), s);
+        const __m256i y = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i*)(pY + x)), s);
+        const __m256i uvLo = _mm256_unpacklo_epi16(u, v);
+        const __m256i uvHi = _mm256_unpackhi_epi16(u, v);
+        const __m256i yaLo = _mm256_unpacklo_epi16(y, alpha);
+        const __m256i yaHi = _mm256_unpackhi_epi16(y, alpha);
+
+        StoreQuads_AVX2(pDst + 4 * x,
+            _mm256_unpacklo_epi16(uvLo, yaLo), _mm256_unpackhi_epi16(uvLo, yaLo),
+            _mm256_unpacklo_epi16(uvHi, yaHi), _mm256_unpackhi_epi16(uvHi, yaHi));
+    }
+    PackY416_SSE41(pDst + 4 * x, pY + x, pU + x, pV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static amf_size RGB48ToRGBA8_AVX2(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count, const amf_int8* pMaskLo, const amf_int8* pMaskHi)
+{
+    const __m256i maskLo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)pMaskLo));
+    const __m256i maskHi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)pMaskHi));
+    const __m256i alpha  = _mm256_set1_epi32(amf_int32(0xFF000000));
+    amf_size x = 0;
+    // 8 pixels are 48 bytes, the last load ends at 52
+    for (; x + 9 <= count; x += 8)
+    {
+        const amf_uint8* pIn = pSrc + 6 * x;
+        const __m256i a = _mm256_shuffle_epi8(LoadLanes(pIn,      pIn + 24), maskLo);
+        const __m256i b = _mm256_shuffle_epi8(LoadLanes(pIn + 12, pIn + 36), maskHi);
+        _mm256_storeu_si256((__m256i*)(pDst + 4 * x), _mm256_or_si256(_mm256_or_si256(a, b), alpha));
+    }
+    return x;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void RGB48BEToRGBA8_AVX2(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const amf_size x = RGB48ToRGBA8_AVX2(pDst, pSrc, count, s_RGB48BEToRGBA8Lo, s_RGB48BEToRGBA8Hi);
+    RGB48BEToRGBA8_SSE41(pDst + 4 * x, pSrc + 6 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void RGB48LEToRGBA8_AVX2(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const amf_size x = RGB48ToRGBA8_AVX2(pDst, pSrc, count, s_RGB48LEToRGBA8Lo, s_RGB48LEToRGBA8Hi);
+    RGB48LEToRGBA8_SSE41(pDst + 4 * x, pSrc + 6 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void RGBA64LEToRGBA8_AVX2(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    amf_size x = 0;
+    for (; x + 8 <= count; x += 8)
+    {
+        const __m256i a = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i*)(pSrc + 8 * x)), 8);
+        const __m256i b = _mm256_srli_epi16(_mm256_loadu_si256((const __m256i*)(pSrc + 8 * x + 32)), 8);
+        // packus interleaves the lanes of a and b in 64-bit groups
+        _mm256_storeu_si256((__m256i*)(pDst + 4 * x), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    RGBA64LEToRGBA8_SSE41(pDst + 4 * x, pSrc + 8 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static amf_size RGB48ToRGBA16_AVX2(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count, const amf_int8* pMask)
+{
+    const __m256i mask  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)pMask));
+    const __m256i alpha = _mm256_set1_epi64x(amf_int64(0xFFFF000000000000ULL));
+    amf_size x = 0;
+    for (; x + 9 <= count; x += 8)
+    {
+        const amf_uint8* pIn = pSrc + 6 * x;
+        const __m256i a = _mm256_shuffle_epi8(LoadLanes(pIn,      pIn + 12), mask);
+        const __m256i b = _mm256_shuffle_epi8(LoadLanes(pIn + 24, pIn + 36), mask);
+        _mm256_storeu_si256((__m256i*)(pDst + 4 * x),      _mm256_or_si256(a, alpha));
+        _mm256_storeu_si256((__m256i*)(pDst + 4 * x + 16), _mm256_or_si256(b, alpha));
+    }
+    return x;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void RGB48BEToRGBA16_AVX2(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const amf_size x = RGB48ToRGBA16_AVX2(pDst, pSrc, count, s_RGB48BEToRGBA16);
+    RGB48BEToRGBA16_SSE41(pDst + 4 * x, pSrc + 6 * x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX2
+static void RGB48LEToRGBA16_AVX2(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count)
+{
+    const amf_size x = RGB48ToRGBA16_AVX2(pDst, pSrc, count, s_RGB48LEToRGBA16);
+    RGB48LEToRGBA16_SSE41(pDst + 4 * x, pSrc + 6 * x, count - x);
+}
+
+//-------------------------------------------------------------------------------------------------
+// AVX-512 (F + BW) - only the plain interleave and shift kernels gain from the wider
+// registers, the packers keep their AVX2 versions
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX512
+static void InterleaveUV8_AVX512(amf_uint8* pDst, const amf_uint8* pU, const amf_uint8* pV, amf_size count)
+{
+    // unpack works per 128-bit lane, put lo/hi lanes back in order in 64-bit steps
+    const __m512i order0 = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+    const __m512i order1 = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+    amf_size x = 0;
+    for (; x + 64 <= count; x += 64)
+    {
+        const __m512i u  = _mm512_loadu_si512((const void*)(pU + x));
+        const __m512i v  = _mm512_loadu_si512((const void*)(pV + x));
+        const __m512i lo = _mm512_unpacklo_epi8(u, v);
+        const __m512i hi = _mm512_unpackhi_epi8(u, v);
+        _mm512_storeu_si512((void*)(pDst + 2 * x),      _mm512_permutex2var_epi64(lo, order0, hi));
+        _mm512_storeu_si512((void*)(pDst + 2 * x + 64), _mm512_permutex2var_epi64(lo, order1, hi));
+    }
+    InterleaveUV8_AVX2(pDst + 2 * x, pU + x, pV + x, count - x);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX512
+static void InterleaveUV16_AVX512(amf_uint16* pDst, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift)
+{
+    const __m512i order0 = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+    const __m512i order1 = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        const __m512i u  = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pU + x)), s);
+        const __m512i v  = _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pV + x)), s);
+        const __m512i lo = _mm512_unpacklo_epi16(u, v);
+        const __m512i hi = _mm512_unpackhi_epi16(u, v);
+        _mm512_storeu_si512((void*)(pDst + 2 * x),      _mm512_permutex2var_epi64(lo, order0, hi));
+        _mm512_storeu_si512((void*)(pDst + 2 * x + 32), _mm512_permutex2var_epi64(lo, order1, hi));
+    }
+    InterleaveUV16_AVX2(pDst + 2 * x, pU + x, pV + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_REPACK_TARGET_AVX512
+static void Shift16_AVX512(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift)
+{
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    amf_size x = 0;
+    for (; x + 32 <= count; x += 32)
+    {
+        _mm512_storeu_si512((void*)(pDst + x), _mm512_sll_epi16(_mm512_loadu_si512((const void*)(pSrc + x)), s));
+    }
+    Shift16_AVX2(pDst + x, pSrc + x, count - x, shift);
+}
+//-------------------------------------------------------------------------------------------------
+static amf_uint64 GetEnabledXStateFeatures()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    amf_uint32 eax = 0;
+    amf_uint32 edx = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (amf_uint64(edx) << 32) | eax;
+#endif
+}
+#endif // AMF_REPACK_X86
+
+//-------------------------------------------------------------------------------------------------
+static const AMFPixelRepackKernels s_KernelsScalar =
+{
+    AMF_PIXEL_REPACK_SCALAR,
+    InterleaveUV8_C, InterleaveUV16_C, Shift16_C, PackY210_C, PackY416_C,
+    RGB48BEToRGBA8_C, RGB48LEToRGBA8_C, RGBA64LEToRGBA8_C, RGB48BEToRGBA16_C, RGB48LEToRGBA16_C
+};
+#if defined(AMF_REPACK_X86)
+static const AMFPixelRepackKernels s_KernelsSSE41 =
+{
+    AMF_PIXEL_REPACK_SSE41,
+    InterleaveUV8_SSE41, InterleaveUV16_SSE41, Shift16_SSE41, PackY210_SSE41, PackY416_SSE41,
+    RGB48BEToRGBA8_SSE41, RGB48LEToRGBA8_SSE41, RGBA64LEToRGBA8_SSE41, RGB48BEToRGBA16_SSE41, RGB48LEToRGBA16_SSE41
+};
+static const AMFPixelRepackKernels s_KernelsAVX2 =
+{
+    AMF_PIXEL_REPACK_AVX2,
+    InterleaveUV8_AVX2, InterleaveUV16_AVX2, Shift16_AVX2, PackY210_AVX2, PackY416_AVX2,
+    RGB48BEToRGBA8_AVX2, RGB48LEToRGBA8_AVX2, RGBA64LEToRGBA8_AVX2, RGB48BEToRGBA16_AVX2, RGB48LEToRGBA16_AVX2
+};
+static const AMFPixelRepackKernels s_KernelsAVX512 =
+{
+    AMF_PIXEL_REPACK_AVX512,
+    InterleaveUV8_AVX512, InterleaveUV16_AVX512, Shift16_AVX512, PackY210_AVX2, PackY416_AVX2,
+    RGB48BEToRGBA8_AVX2, RGB48LEToRGBA8_AVX2, RGBA64LEToRGBA8_AVX2, RGB48BEToRGBA16_AVX2, RGB48LEToRGBA16_AVX2
+};
+#endif
+//-------------------------------------------------------------------------------------------------
+static AMF_PIXEL_REPACK_ISA DetectPixelRepackISA()
+{
+#if defined(AMF_REPACK_X86)
+    if (InstructionSet::SSSE3() == false || InstructionSet::SSE41() == false)
+    {
+        return AMF_PIXEL_REPACK_SCALAR;
+    }
+    // the OS has to save the wider registers too: XMM|YMM for AVX2, plus opmask|ZMM for AVX-512
+    const amf_uint64 xstate = (InstructionSet::OSXSAVE() && InstructionSet::AVX()) ? GetEnabledXStateFeatures() : 0;
+    if (InstructionSet::AVX2() == false || (xstate & 0x06) != 0x06)
+    {
+        return AMF_PIXEL_REPACK_SSE41;
+    }
+    if (InstructionSet::AVX512F() == false || InstructionSet::AVX512BW() == false || (xstate & 0xE6) != 0xE6)
+    {
+        return AMF_PIXEL_REPACK_AVX2;
+    }
+    return AMF_PIXEL_REPACK_AVX512;
+#else
+    return AMF_PIXEL_REPACK_SCALAR;
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+const AMFPixelRepackKernels& AMF_STD_CALL amf::GetPixelRepackKernels(AMF_PIXEL_REPACK_ISA eISA)
+{
+    static const AMF_PIXEL_REPACK_ISA eSupported = DetectPixelRepackISA();
+    if (eISA > eSupported)
+    {
+        eISA = eSupported;
+    }
+
+    switch (eISA)
+    {
+#if defined(AMF_REPACK_X86)
+    case AMF_PIXEL_REPACK_AVX512:   return s_KernelsAVX512;
+    case AMF_PIXEL_REPACK_AVX2:     return s_KernelsAVX2;
+    case AMF_PIXEL_REPACK_SSE41:    return s_KernelsSSE41;
+#endif
+    default:                        return s_KernelsScalar;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+const AMFPixelRepackKernels& AMF_STD_CALL amf::GetPixelRepackKernels()
+{
+    return GetPixelRepackKernels(AMF_PIXEL_REPACK_AVX512);
+}
+//-------------------------------------------------------------------------------------------------
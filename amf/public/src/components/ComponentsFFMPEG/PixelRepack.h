@@ -0,0 +1,77 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#pragma once
+
+#include "public/include/core/Platform.h"
+
+// Line kernels for the pixel repacking done by the FFmpeg decoder copy paths.
+// Every ISA level produces the same bytes as the scalar code; the best level
+// supported by the CPU is picked once at runtime.
+namespace amf
+{
+    enum AMF_PIXEL_REPACK_ISA
+    {
+        AMF_PIXEL_REPACK_SCALAR = 0,
+        AMF_PIXEL_REPACK_SSE41,
+        AMF_PIXEL_REPACK_AVX2,
+        AMF_PIXEL_REPACK_AVX512,
+    };
+
+    struct AMFPixelRepackKernels
+    {
+        AMF_PIXEL_REPACK_ISA eISA;
+
+        // U0 V0 U1 V1 ... from planar U and V (NV12 chroma)
+        void (*InterleaveUV8)(amf_uint8* pDst, const amf_uint8* pU, const amf_uint8* pV, amf_size count);
+        // same for 16-bit samples, shifting LSB aligned values up by shift (P010/P012/P016 chroma)
+        void (*InterleaveUV16)(amf_uint16* pDst, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift);
+        // LSB to MSB aligned samples (P010/P012 luma)
+        void (*Shift16)(amf_uint16* pDst, const amf_uint16* pSrc, amf_size count, amf_int32 shift);
+        // U Y0 V Y1 per pixel pair from planar 4:2:2, count is in pixel pairs (Y210)
+        void (*PackY210)(amf_uint16* pDst, const amf_uint16* pY, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift);
+        // U Y V A per pixel from planar 4:4:4 with opaque alpha (Y416)
+        void (*PackY416)(amf_uint16* pDst, const amf_uint16* pY, const amf_uint16* pU, const amf_uint16* pV, amf_size count, amf_int32 shift);
+        // 16-bit RGB / RGBA to RGBA8 keeping the most significant byte, alpha is opaque for RGB
+        void (*RGB48BEToRGBA8)(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count);
+        void (*RGB48LEToRGBA8)(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count);
+        void (*RGBA64LEToRGBA8)(amf_uint8* pDst, const amf_uint8* pSrc, amf_size count);
+        // 16-bit RGB to native endian RGBA16 with opaque alpha (stored in RGBA_F16 surfaces as is)
+        void (*RGB48BEToRGBA16)(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count);
+        void (*RGB48LEToRGBA16)(amf_uint16* pDst, const amf_uint8* pSrc, amf_size count);
+    };
+
+    // kernels for the best ISA the CPU supports
+    const AMFPixelRepackKernels& AMF_STD_CALL GetPixelRepackKernels();
+    // kernels for a given ISA, lowered to what the CPU supports - for validation and benchmarks
+    const AMFPixelRepackKernels& AMF_STD_CALL GetPixelRepackKernels(AMF_PIXEL_REPACK_ISA eISA);
+}
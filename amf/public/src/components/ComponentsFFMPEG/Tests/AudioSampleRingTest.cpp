@@ -0,0 +1,284 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "ComponentTests.h"
+#include "../AudioSampleRing.h"
+#include "public/common/Thread.h"
+
+using namespace amf;
+
+namespace
+{
+    // two planes of 32 bit samples, sample k of plane p holds k * 2 + p
+    const amf_int32 s_Planes = 2;
+    const amf_int32 s_Frame = 16;
+
+    void WriteSamples(AMFAudioSampleRing& ring, amf_int32 first, amf_int32 count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        amf_vector<amf_int32> source((amf_size)count * s_Planes);
+        for (amf_int32 p = 0; p < s_Planes; p++)
+        {
+            for (amf_int32 i = 0; i < count; i++)
+            {
+                source[(amf_size)p * count + i] = (first + i) * 2 + p;
+            }
+        }
+        ring.Write(reinterpret_cast<const amf_uint8*>(&source[0]), (amf_size)count * sizeof(amf_int32), count);
+    }
+    bool CheckSamples(amf_uint8* const* ppPlanes, amf_int32 first, amf_int32 count)
+    {
+        for (amf_int32 p = 0; p < s_Planes; p++)
+        {
+            const amf_int32* pSamples = reinterpret_cast<const amf_int32*>(ppPlanes[p]);
+            for (amf_int32 i = 0; i < count; i++)
+            {
+                if (pSamples[i] != (first + i) * 2 + p)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    struct HeldFrame
+    {
+        amf_uint8*  planes[s_Planes];
+        amf_int32   first;
+    };
+    HeldFrame HoldFrame(AMFAudioSampleRing& ring, amf_int32 first)
+    {
+        HeldFrame frame = {};
+        ring.Peek(s_Frame, frame.planes);
+        ring.Hold(s_Frame, frame.planes[0]);
+        frame.first = first;
+        return frame;
+    }
+
+    // held space comes back only when released, and only from the oldest frame on
+    int TestHeldFrames()
+    {
+        int failures = 0;
+        AMFAudioSampleRing ring;
+        ring.Init(s_Planes, sizeof(amf_int32), 8 * s_Frame, s_Frame);
+
+        WriteSamples(ring, 0, 8 * s_Frame);
+        amf_vector<HeldFrame> held;
+        for (amf_int32 i = 0; i < 8; i++)
+        {
+            held.push_back(HoldFrame(ring, i * s_Frame));
+        }
+        TEST_CHECK(ring.GetAvailable() == 0 && ring.GetFree() == 0 && ring.GetHeld() == 8 * s_Frame, "all held: available %d, free %d, held %d",
+            ring.GetAvailable(), ring.GetFree(), ring.GetHeld());
+
+        ring.ReleaseHeld(held[2].planes[0]);
+        TEST_CHECK(ring.GetFree() == 0, "out of order release freed %d samples", ring.GetFree());
+        ring.ReleaseHeld(held[0].planes[0]);
+        TEST_CHECK(ring.GetFree() == s_Frame, "release of the oldest frame freed %d samples", ring.GetFree());
+        ring.ReleaseHeld(held[1].planes[0]);
+        TEST_CHECK(ring.GetFree() == 3 * s_Frame, "released run freed %d samples", ring.GetFree());
+        ring.ReleaseHeld(held[1].planes[0]);
+        ring.ReleaseHeld(reinterpret_cast<const amf_uint8*>(&ring));
+        TEST_CHECK(ring.GetFree() == 3 * s_Frame, "repeated and unknown releases changed the free space to %d", ring.GetFree());
+
+        // new samples go into the freed space only
+        WriteSamples(ring, 8 * s_Frame, 3 * s_Frame);
+        for (amf_size i = 3; i < held.size(); i++)
+        {
+            TEST_CHECK(CheckSamples(held[i].planes, held[i].first, s_Frame), "held frame %d overwritten", (int)i);
+        }
+
+        for (amf_size i = 3; i < held.size(); i++)
+        {
+            ring.ReleaseHeld(held[i].planes[0]);
+        }
+        TEST_CHECK(ring.GetHeld() == 0 && ring.GetFree() + ring.GetAvailable() == 8 * s_Frame, "all released: held %d, free %d, available %d",
+            ring.GetHeld(), ring.GetFree(), ring.GetAvailable());
+        return failures;
+    }
+
+    // a frame that wraps is handed out from the slack, its head in the ring stays held with it
+    int TestWrappedFrame()
+    {
+        int failures = 0;
+        AMFAudioSampleRing ring;
+        ring.Init(s_Planes, sizeof(amf_int32), 8 * s_Frame, s_Frame);
+
+        WriteSamples(ring, 0, 8 * s_Frame - s_Frame / 2);
+        amf_vector<HeldFrame> held;
+        for (amf_int32 i = 0; i < 7; i++)
+        {
+            held.push_back(HoldFrame(ring, i * s_Frame));
+        }
+        ring.Consume(s_Frame / 2);
+        for (amf_size i = 0; i < held.size(); i++)
+        {
+            ring.ReleaseHeld(held[i].planes[0]);
+        }
+        TEST_CHECK(ring.GetHeld() == 0, "consumed behind held frames: %d samples held", ring.GetHeld());
+
+        WriteSamples(ring, 8 * s_Frame, s_Frame);
+        HeldFrame wrapped = HoldFrame(ring, 8 * s_Frame);
+        TEST_CHECK(CheckSamples(wrapped.planes, wrapped.first, s_Frame), "wrapped frame");
+        TEST_CHECK(ring.GetFree() == 7 * s_Frame, "%d samples free next to a wrapped frame", ring.GetFree());
+        WriteSamples(ring, 9 * s_Frame, ring.GetFree());
+        HeldFrame next = HoldFrame(ring, 9 * s_Frame);
+        TEST_CHECK(CheckSamples(wrapped.planes, wrapped.first, s_Frame) && CheckSamples(next.planes, next.first, s_Frame),
+            "frames overwritten after the ring filled up");
+
+        ring.ReleaseHeld(next.planes[0]);
+        ring.ReleaseHeld(wrapped.planes[0]);
+        TEST_CHECK(ring.GetHeld() == 0 && ring.GetAvailable() == 6 * s_Frame, "all released: held %d, available %d", ring.GetHeld(), ring.GetAvailable());
+        return failures;
+    }
+
+    // storage with held frames survives Reserve and Clear until they are released
+    int TestHeldStorage()
+    {
+        int failures = 0;
+        AMFAudioSampleRing ring;
+        ring.Init(s_Planes, sizeof(amf_int32), 4 * s_Frame, s_Frame);
+
+        WriteSamples(ring, 0, 4 * s_Frame);
+        HeldFrame first = HoldFrame(ring, 0);
+        HeldFrame second = HoldFrame(ring, s_Frame);
+        ring.Reserve(16 * s_Frame);
+        TEST_CHECK(ring.GetHeld() == 0 && ring.GetAvailable() == 2 * s_Frame && ring.GetFree() == 14 * s_Frame, "after Reserve: held %d, available %d, free %d",
+            ring.GetHeld(), ring.GetAvailable(), ring.GetFree());
+        WriteSamples(ring, 4 * s_Frame, 14 * s_Frame);
+        TEST_CHECK(CheckSamples(first.planes, 0, s_Frame) && CheckSamples(second.planes, s_Frame, s_Frame), "held frames lost by Reserve");
+        HeldFrame third = HoldFrame(ring, 2 * s_Frame);
+        TEST_CHECK(CheckSamples(third.planes, 2 * s_Frame, s_Frame), "unread samples moved by Reserve");
+
+        ring.Clear();
+        TEST_CHECK(ring.GetHeld() == 0 && ring.GetAvailable() == 0 && ring.GetFree() == 16 * s_Frame, "after Clear: held %d, available %d, free %d",
+            ring.GetHeld(), ring.GetAvailable(), ring.GetFree());
+        WriteSamples(ring, 100 * s_Frame, 16 * s_Frame);
+        TEST_CHECK(CheckSamples(third.planes, 2 * s_Frame, s_Frame), "held frame lost by Clear");
+        TEST_CHECK(CheckSamples(first.planes, 0, s_Frame), "frame held across Reserve and Clear");
+
+        ring.ReleaseHeld(second.planes[0]);
+        ring.ReleaseHeld(first.planes[0]);
+        ring.ReleaseHeld(third.planes[0]);
+        TEST_CHECK(ring.GetFree() == 0 && ring.GetAvailable() == 16 * s_Frame, "releasing retired frames changed the ring");
+        return failures;
+    }
+
+    // the encoder drops its frame references on its own threads
+    class FrameReleaser : public AMFThread
+    {
+    public:
+        FrameReleaser(AMFAudioSampleRing* pRing, amf_vector<const amf_uint8*>* pFrames, AMFCriticalSection* pSync) :
+            m_pRing(pRing), m_pFrames(pFrames), m_pSync(pSync) {}
+    protected:
+        virtual void Run()
+        {
+            while (!StopRequested())
+            {
+                const amf_uint8* pFrame = nullptr;
+                {
+                    AMFLock lock(m_pSync);
+                    if (m_pFrames->empty() == false)
+                    {
+                        pFrame = m_pFrames->front();
+                        m_pFrames->erase(m_pFrames->begin());
+                    }
+                }
+                if (pFrame != nullptr)
+                {
+                    m_pRing->ReleaseHeld(pFrame);
+                }
+            }
+        }
+    private:
+        AMFAudioSampleRing*             m_pRing;
+        amf_vector<const amf_uint8*>*   m_pFrames;
+        AMFCriticalSection*             m_pSync;
+    };
+    int TestReleaseThread()
+    {
+        int failures = 0;
+        AMFAudioSampleRing ring;
+        ring.Init(s_Planes, sizeof(amf_int32), 4 * s_Frame, s_Frame);
+
+        amf_vector<const amf_uint8*> frames;
+        AMFCriticalSection sync;
+        FrameReleaser releaser(&ring, &frames, &sync);
+        releaser.Start();
+
+        amf_int32 written = 0;
+        amf_int32 read = 0;
+        int corrupted = 0;
+        while (read < 20000 * s_Frame)
+        {
+            const amf_int32 toWrite = AMF_MIN(ring.GetFree(), s_Frame * 3 / 2);
+            WriteSamples(ring, written, toWrite);
+            written += toWrite;
+            while (ring.GetAvailable() >= s_Frame)
+            {
+                HeldFrame frame = HoldFrame(ring, read);
+                if (!CheckSamples(frame.planes, read, s_Frame))
+                {
+                    corrupted++;
+                }
+                read += s_Frame;
+                AMFLock lock(&sync);
+                frames.push_back(frame.planes[0]);
+            }
+        }
+        releaser.RequestStop();
+        releaser.WaitForStop();
+        for (amf_size i = 0; i < frames.size(); i++)
+        {
+            ring.ReleaseHeld(frames[i]);
+        }
+        TEST_CHECK(corrupted == 0, "%d frames corrupted", corrupted);
+        TEST_CHECK(ring.GetHeld() == 0, "%d samples still held", ring.GetHeld());
+        return failures;
+    }
+}
+
+int TestAudioSampleRing()
+{
+    int failures = 0;
+    failures += TestHeldFrames();
+    failures += TestWrappedFrame();
+    failures += TestHeldStorage();
+    failures += TestReleaseThread();
+    return failures;
+}
@@ -0,0 +1,309 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "ComponentTests.h"
+#include "../BitstreamConverter.h"
+#include "public/common/Thread.h"
+#include <string.h>
+
+using namespace amf;
+
+namespace
+{
+    typedef amf_vector<amf_uint8> Bytes;
+
+    const amf_uint8 s_SPS[] = { 0x67, 0x64, 0x00, 0x28, 0xac, 0xd9, 0x40, 0x78 };
+    const amf_uint8 s_PPS[] = { 0x68, 0xeb, 0xe3, 0xcb, 0x22, 0xc0 };
+    const amf_uint8 s_StartCode[] = { 0x00, 0x00, 0x00, 0x01 };
+
+    void Append(Bytes& out, const amf_uint8* pData, amf_size size)
+    {
+        out.insert(out.end(), pData, pData + size);
+    }
+    void AppendBE32(Bytes& out, amf_uint32 val)
+    {
+        const amf_uint8 bytes[4] = { amf_uint8(val >> 24), amf_uint8(val >> 16), amf_uint8(val >> 8), amf_uint8(val) };
+        Append(out, bytes, sizeof(bytes));
+    }
+    Bytes MakeAvcC()
+    {
+        Bytes avcC;
+        const amf_uint8 header[] = { 0x01, s_SPS[1], s_SPS[2], s_SPS[3], 0xff, 0xe1 };    // 4 byte lengths, one SPS
+        Append(avcC, header, sizeof(header));
+        avcC.push_back(0);
+        avcC.push_back(amf_uint8(sizeof(s_SPS)));
+        Append(avcC, s_SPS, sizeof(s_SPS));
+        avcC.push_back(1);
+        avcC.push_back(0);
+        avcC.push_back(amf_uint8(sizeof(s_PPS)));
+        Append(avcC, s_PPS, sizeof(s_PPS));
+        return avcC;
+    }
+    // IDR slice of the given size, payload without zero bytes so it cannot contain a start code
+    Bytes MakeIDR(amf_size size)
+    {
+        Bytes nal(size);
+        nal[0] = 0x65;
+        for (amf_size i = 1; i < size; i++)
+        {
+            nal[i] = amf_uint8(0x80 | (i & 0x7f));
+        }
+        return nal;
+    }
+
+    // a length prefix of 0x000001xx reads as a 3 byte start code
+    int TestLengthPrefixedToAnnexB(amf_size nalSize)
+    {
+        int failures = 0;
+        const Bytes avcC = MakeAvcC();
+        const Bytes nal = MakeIDR(nalSize);
+
+        Bytes in;
+        AppendBE32(in, amf_uint32(nal.size()));
+        Append(in, nal.data(), nal.size());
+
+        Bytes expected;
+        Append(expected, s_StartCode, sizeof(s_StartCode));
+        Append(expected, s_SPS, sizeof(s_SPS));
+        Append(expected, s_StartCode, sizeof(s_StartCode));
+        Append(expected, s_PPS, sizeof(s_PPS));
+        Append(expected, s_StartCode, sizeof(s_StartCode));
+        Append(expected, nal.data(), nal.size());
+
+        AMFBitstreamConverter converter;
+        AMF_RESULT res = converter.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED,
+            AMFBitstreamConverter::FORMAT_ANNEXB, avcC.data(), avcC.size());
+        TEST_CHECK(res == AMF_OK, "Init() returned %d", (int)res);
+
+        const amf_uint8* pOut = NULL;
+        amf_size outSize = 0;
+        res = converter.Filter(in.data(), in.size(), &pOut, &outSize);
+        TEST_CHECK(res == AMF_OK, "Filter() returned %d for a %d byte NAL", (int)res, (int)nalSize);
+        TEST_CHECK(res != AMF_OK || pOut != in.data(), "%d byte length-prefixed NAL passed through", (int)nalSize);
+        TEST_CHECK(res != AMF_OK || (outSize == expected.size() && memcmp(pOut, expected.data(), outSize) == 0),
+            "%d byte NAL: wrong Annex B output, size %d expected %d", (int)nalSize, (int)outSize, (int)expected.size());
+
+        // the same access unit again: no parameter sets this time
+        res = converter.Filter(in.data(), in.size(), &pOut, &outSize);
+        TEST_CHECK(res == AMF_OK && outSize == in.size() && memcmp(pOut, s_StartCode, sizeof(s_StartCode)) == 0 &&
+            memcmp(pOut + sizeof(s_StartCode), nal.data(), nal.size()) == 0, "%d byte NAL: wrong second access unit", (int)nalSize);
+        return failures;
+    }
+
+    // length-prefixed data handed to an Annex B -> length-prefixed converter is kept as is
+    int TestLengthPrefixedPassThrough(amf_size nalSize)
+    {
+        int failures = 0;
+        const Bytes nal = MakeIDR(nalSize);
+        Bytes in;
+        AppendBE32(in, amf_uint32(nal.size()));
+        Append(in, nal.data(), nal.size());
+
+        AMFBitstreamConverter converter;
+        AMF_RESULT res = converter.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_ANNEXB,
+            AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED, NULL, 0);
+        TEST_CHECK(res == AMF_OK, "Init() returned %d", (int)res);
+
+        const amf_uint8* pOut = NULL;
+        amf_size outSize = 0;
+        res = converter.Filter(in.data(), in.size(), &pOut, &outSize);
+        TEST_CHECK(res == AMF_OK && pOut == in.data() && outSize == in.size(), "%d byte length-prefixed NAL not passed through", (int)nalSize);
+        return failures;
+    }
+
+    // Annex B data handed to a length-prefixed -> Annex B converter is kept as is
+    int TestAnnexBPassThrough()
+    {
+        int failures = 0;
+        Bytes in;
+        Append(in, s_StartCode, sizeof(s_StartCode));
+        Append(in, s_SPS, sizeof(s_SPS));
+        Append(in, s_StartCode + 1, sizeof(s_StartCode) - 1);
+        Append(in, s_PPS, sizeof(s_PPS));
+
+        AMFBitstreamConverter converter;
+        AMF_RESULT res = converter.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED,
+            AMFBitstreamConverter::FORMAT_ANNEXB, NULL, 0);
+        TEST_CHECK(res == AMF_OK, "Init() returned %d", (int)res);
+
+        const amf_uint8* pOut = NULL;
+        amf_size outSize = 0;
+        res = converter.Filter(in.data(), in.size(), &pOut, &outSize);
+        TEST_CHECK(res == AMF_OK && pOut == in.data() && outSize == in.size(), "Annex B input not passed through");
+        return failures;
+    }
+
+    // intra frame split into slices, as an encoder at high bitrate produces it
+    Bytes MakeIntraFrame(amf_size frameSize, amf_size slices, bool bStartCodes)
+    {
+        Bytes frame;
+        frame.reserve(frameSize + slices * 4);
+        const Bytes nal = MakeIDR(frameSize / slices);
+        for (amf_size i = 0; i < slices; i++)
+        {
+            if (bStartCodes)
+            {
+                Append(frame, s_StartCode, sizeof(s_StartCode));
+            }
+            else
+            {
+                AppendBE32(frame, amf_uint32(nal.size()));
+            }
+            Append(frame, nal.data(), nal.size());
+        }
+        return frame;
+    }
+
+    // GB/s over the frame size
+    template<typename _TFunc>
+    double MeasureGBps(amf_size frameSize, _TFunc func)
+    {
+        static const amf_pts minDuration = AMF_SECOND / 2;
+
+        func();
+
+        int frames = 0;
+        const amf_pts start = amf_high_precision_clock();
+        amf_pts elapsed = 0;
+        do
+        {
+            func();
+            frames++;
+            elapsed = amf_high_precision_clock() - start;
+        } while (elapsed < minDuration);
+
+        return double(frameSize) * frames / (double(elapsed) / AMF_SECOND) / (1024.0 * 1024.0 * 1024.0);
+    }
+
+    // 4 byte lengths and 4 byte start codes swap in place, both ways
+    int TestInPlaceRoundTrip()
+    {
+        int failures = 0;
+        const Bytes lengthPrefixed = MakeIntraFrame(70000, 4, false);
+        const Bytes annexB = MakeIntraFrame(70000, 4, true);
+
+        AMFBitstreamConverter toAnnexB;
+        AMFBitstreamConverter toLengthPrefixed;
+        toAnnexB.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED, AMFBitstreamConverter::FORMAT_ANNEXB, NULL, 0);
+        toLengthPrefixed.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_ANNEXB, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED, NULL, 0);
+
+        Bytes data = lengthPrefixed;
+        AMF_RESULT res = toAnnexB.ConvertInPlace(data.data(), data.size());
+        TEST_CHECK(res == AMF_OK && data == annexB, "in place to Annex B returned %d", (int)res);
+        res = toLengthPrefixed.ConvertInPlace(data.data(), data.size());
+        TEST_CHECK(res == AMF_OK && data == lengthPrefixed, "in place to length prefixes returned %d", (int)res);
+        return failures;
+    }
+}
+
+int TestBitstreamConverter()
+{
+    int failures = 0;
+    const amf_size sizes[] = { 100, 255, 256, 300, 511, 512, 70000 };
+    for (amf_size i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        failures += TestLengthPrefixedToAnnexB(sizes[i]);
+        failures += TestLengthPrefixedPassThrough(sizes[i]);
+    }
+    failures += TestAnnexBPassThrough();
+    failures += TestInPlaceRoundTrip();
+    printf("BitstreamConverter: %d failed check(s)\n", failures);
+    return failures;
+}
+
+void BenchmarkBitstreamConverter()
+{
+    static const amf_size s_Slices = 4;
+    const amf_size frameSizes[] = { 512 * 1024, 8 * 1024 * 1024 };
+
+    printf("BitstreamConverter benchmark, H.264 intra frame of %d slices, GB/s\n", (int)s_Slices);
+    printf("%-44s %10s %10s\n", "", "512 KB", "8 MB");
+
+    double results[5][2] = {};
+    for (amf_size f = 0; f < sizeof(frameSizes) / sizeof(frameSizes[0]); f++)
+    {
+        const amf_size frameSize = frameSizes[f];
+        const Bytes lengthPrefixed = MakeIntraFrame(frameSize, s_Slices, false);
+        const Bytes annexB = MakeIntraFrame(frameSize, s_Slices, true);
+        const Bytes avcC = MakeAvcC();
+        Bytes out(frameSize * 2);
+
+        // the floor: one copy of the frame
+        results[0][f] = MeasureGBps(frameSize, [&]() { memcpy(out.data(), lengthPrefixed.data(), lengthPrefixed.size()); });
+
+        AMFBitstreamConverter toAnnexB;
+        toAnnexB.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED, AMFBitstreamConverter::FORMAT_ANNEXB,
+            avcC.data(), avcC.size());
+        results[1][f] = MeasureGBps(frameSize, [&]()
+        {
+            const amf_uint8* pOut = NULL;
+            amf_size outSize = 0;
+            toAnnexB.Filter(lengthPrefixed.data(), lengthPrefixed.size(), &pOut, &outSize);
+        });
+        results[2][f] = MeasureGBps(frameSize, [&]()
+        {
+            amf_size outSize = 0;
+            amf_size written = 0;
+            toAnnexB.GetOutputSize(lengthPrefixed.data(), lengthPrefixed.size(), &outSize);
+            toAnnexB.Convert(lengthPrefixed.data(), lengthPrefixed.size(), out.data(), out.size(), &written);
+        });
+
+        AMFBitstreamConverter toLengthPrefixed;
+        toLengthPrefixed.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_ANNEXB, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED,
+            NULL, 0);
+        results[3][f] = MeasureGBps(frameSize, [&]()
+        {
+            const amf_uint8* pOut = NULL;
+            amf_size outSize = 0;
+            toLengthPrefixed.Filter(annexB.data(), annexB.size(), &pOut, &outSize);
+        });
+
+        // in place there and back, no parameter sets to put in front
+        AMFBitstreamConverter inPlaceToAnnexB;
+        inPlaceToAnnexB.Init(AMFBitstreamConverter::CODEC_H264, AMFBitstreamConverter::FORMAT_LENGTH_PREFIXED, AMFBitstreamConverter::FORMAT_ANNEXB,
+            NULL, 0);
+        Bytes inPlace = lengthPrefixed;
+        results[4][f] = 2.0 * MeasureGBps(frameSize, [&]()
+        {
+            inPlaceToAnnexB.ConvertInPlace(inPlace.data(), inPlace.size());
+            toLengthPrefixed.ConvertInPlace(inPlace.data(), inPlace.size());
+        });
+    }
+
+    const char* names[] = { "memcpy", "avcC -> Annex B, Filter()", "avcC -> Annex B, Convert() to caller buffer",
+        "Annex B -> avcC, Filter()", "ConvertInPlace()" };
+    for (amf_size i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        printf("%-44s %10.2f %10.2f\n", names[i], results[i][0], results[i][1]);
+    }
+}
@@ -0,0 +1,393 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Read-ahead mode of the FFmpeg demuxer on an in-memory NUT stream: two outputs
+// drained at different rates while Flush() and Seek() run under the reader thread.
+
+#include "public/src/components/ComponentsFFMPEG/Tests/ComponentTests.h"
+#include "public/src/components/ComponentsFFMPEG/FileDemuxerFFMPEGImpl.h"
+#include "public/common/AMFFactory.h"
+#include "public/common/DataStream.h"
+#include "public/common/Thread.h"
+
+#include <string.h>
+
+using namespace amf;
+
+namespace
+{
+    // every packet starts with its index in the stream, both streams have a 40 ms packet
+    const amf_int32 s_Packets       = 400;
+    const amf_int32 s_VideoWidth    = 16;
+    const amf_int32 s_VideoHeight   = 16;
+    const amf_int32 s_SampleRate    = 48000;
+    const amf_int32 s_PacketSamples = 1920;
+
+    const amf_int32 s_SeekIndex     = 40;   // Seek() target, 1.6 sec
+    const amf_pts   s_Timeout       = 10 * AMF_SECOND;
+
+    const amf_int32 s_EofMark       = -1;
+    const amf_int32 s_ErrorMark     = -2;
+
+    AVStream* AddStream(AVFormatContext* pFormat, AVMediaType type, AVCodecID codec, AVRational timeBase)
+    {
+        AVStream* pStream = avformat_new_stream(pFormat, NULL);
+        if (pStream == NULL)
+        {
+            return NULL;
+        }
+        pStream->time_base = timeBase;
+        pStream->codecpar->codec_type = type;
+        pStream->codecpar->codec_id = codec;
+        return pStream;
+    }
+
+    bool WritePacket(AVFormatContext* pFormat, AVStream* pStream, amf_int32 index, amf_int64 pts, amf_int64 duration, int size)
+    {
+        AVPacket* pPacket = av_packet_alloc();
+        if (pPacket == NULL || av_new_packet(pPacket, size) < 0)
+        {
+            av_packet_free(&pPacket);
+            return false;
+        }
+        memset(pPacket->data, 0, size);
+        memcpy(pPacket->data, &index, sizeof(index));
+        pPacket->stream_index = pStream->index;
+        pPacket->pts = pts;
+        pPacket->dts = pts;
+        pPacket->duration = duration;
+        pPacket->flags = AV_PKT_FLAG_KEY;
+        const bool bOk = av_interleaved_write_frame(pFormat, pPacket) >= 0;
+        av_packet_free(&pPacket);
+        return bOk;
+    }
+
+    // muxes the test content into the memory stream: raw 16x16 yuv420p video at 25 fps
+    // and 16 bit mono PCM, every frame of both is a keyframe
+    bool MuxTestStream(AMFDataStream* pStream)
+    {
+        AVFormatContext* pFormat = NULL;
+        if (avformat_alloc_output_context2(&pFormat, NULL, "nut", NULL) < 0)
+        {
+            return false;
+        }
+
+        bool bOk = false;
+        AVStream* pVideo = AddStream(pFormat, AVMEDIA_TYPE_VIDEO, AV_CODEC_ID_RAWVIDEO, AVRational{ 1, 25 });
+        AVStream* pAudio = AddStream(pFormat, AVMEDIA_TYPE_AUDIO, AV_CODEC_ID_PCM_S16LE, AVRational{ 1, s_SampleRate });
+        if (pVideo != NULL && pAudio != NULL && avio_open_dyn_buf(&pFormat->pb) >= 0)
+        {
+            pVideo->codecpar->format = AV_PIX_FMT_YUV420P;
+            pVideo->codecpar->width = s_VideoWidth;
+            pVideo->codecpar->height = s_VideoHeight;
+            pAudio->codecpar->format = AV_SAMPLE_FMT_S16;
+            pAudio->codecpar->sample_rate = s_SampleRate;
+            av_channel_layout_default(&pAudio->codecpar->ch_layout, 1);
+
+            bOk = avformat_write_header(pFormat, NULL) >= 0;
+            for (amf_int32 i = 0; i < s_Packets && bOk; i++)
+            {
+                // the header may have changed the time bases
+                const amf_int64 videoPts = av_rescale_q(i, AVRational{ 1, 25 }, pVideo->time_base);
+                const amf_int64 videoDuration = av_rescale_q(1, AVRational{ 1, 25 }, pVideo->time_base);
+                const amf_int64 audioPts = av_rescale_q((amf_int64)i * s_PacketSamples, AVRational{ 1, s_SampleRate }, pAudio->time_base);
+                const amf_int64 audioDuration = av_rescale_q(s_PacketSamples, AVRational{ 1, s_SampleRate }, pAudio->time_base);
+
+                bOk = WritePacket(pFormat, pVideo, i, videoPts, videoDuration, s_VideoWidth * s_VideoHeight * 3 / 2) &&
+                      WritePacket(pFormat, pAudio, i, audioPts, audioDuration, s_PacketSamples * 2);
+            }
+            bOk = bOk && av_write_trailer(pFormat) >= 0;
+
+            uint8_t* pData = NULL;
+            const int size = avio_close_dyn_buf(pFormat->pb, &pData);
+            pFormat->pb = NULL;
+            amf_size written = 0;
+            bOk = bOk && pStream->Write(pData, size, &written) == AMF_OK && written == (amf_size)size;
+            av_free(pData);
+
+            amf_int64 pos = 0;
+            bOk = bOk && pStream->Seek(AMF_SEEK_BEGIN, 0, &pos) == AMF_OK;
+        }
+        avformat_free_context(pFormat);
+        return bOk;
+    }
+
+    //-------------------------------------------------------------------------------------------------
+    // logs the packet index of every buffer taken from the output, s_EofMark once per
+    // end of stream; sleeps delay ms after every buffer
+    class DrainThread : public AMFThread
+    {
+    public:
+        DrainThread(AMFOutput* pOutput, amf_ulong delay) :
+            m_pOutput(pOutput),
+            m_Delay(delay),
+            m_iLast(-1),
+            m_EofTime(0)
+        {
+        }
+
+        virtual void Run()
+        {
+            bool bEof = false;
+            while (!StopRequested())
+            {
+                AMFDataPtr pData;
+                const AMF_RESULT res = m_pOutput->QueryOutput(&pData);
+                if (res == AMF_OK && pData != NULL)
+                {
+                    AMFBufferPtr pBuffer(pData);
+                    amf_int32 index = s_ErrorMark;
+                    if (pBuffer != NULL && pBuffer->GetSize() >= sizeof(index))
+                    {
+                        memcpy(&index, pBuffer->GetNative(), sizeof(index));
+                    }
+                    Log(index);
+                    bEof = false;
+                    amf_sleep(m_Delay);
+                }
+                else if (res == AMF_EOF)
+                {
+                    if (!bEof)
+                    {
+                        m_EofTime = amf_high_precision_clock();
+                        Log(s_EofMark);
+                        bEof = true;
+                    }
+                    amf_sleep(1);
+                }
+                else if (res == AMF_REPEAT)
+                {
+                    amf_sleep(1);
+                }
+                else
+                {
+                    Log(s_ErrorMark);
+                    break;
+                }
+            }
+        }
+
+        amf_int32 GetLast()
+        {
+            AMFLock lock(&m_Sync);
+            return m_iLast;
+        }
+        amf_vector<amf_int32> GetLog()
+        {
+            AMFLock lock(&m_Sync);
+            return m_Log;
+        }
+        amf_pts GetEofTime()
+        {
+            AMFLock lock(&m_Sync);
+            return m_EofTime;
+        }
+
+    private:
+        void Log(amf_int32 index)
+        {
+            AMFLock lock(&m_Sync);
+            m_Log.push_back(index);
+            m_iLast = index;
+        }
+
+        AMFOutputPtr            m_pOutput;
+        amf_ulong               m_Delay;
+        AMFCriticalSection      m_Sync;
+        amf_vector<amf_int32>   m_Log;
+        amf_int32               m_iLast;
+        amf_pts                 m_EofTime;
+    };
+
+    // waits until the last logged index reaches index, or the end of stream when index is s_EofMark
+    bool WaitFor(DrainThread& thread, amf_int32 index)
+    {
+        const amf_pts deadline = amf_high_precision_clock() + s_Timeout;
+        while (amf_high_precision_clock() < deadline)
+        {
+            const amf_int32 last = thread.GetLast();
+            if (last == s_ErrorMark)
+            {
+                return false;
+            }
+            if (index == s_EofMark ? last == s_EofMark : last >= index)
+            {
+                return true;
+            }
+            amf_sleep(1);
+        }
+        return false;
+    }
+
+    // the log of one output: increasing indices with at most one gap left by Flush(),
+    // one jump back to the Seek() target, then every packet up to the end of stream
+    int CheckLog(const char* name, const amf_vector<amf_int32>& log, bool bFromStart)
+    {
+        int failures = 0;
+
+        TEST_CHECK(log.size() >= 2 && log.back() == s_EofMark && log[log.size() - 2] == s_Packets - 1,
+            "%s: the stream does not end with the last packet and EOF", name);
+        TEST_CHECK(!bFromStart || (!log.empty() && log[0] == 0), "%s: the first packet is %d", name, log.empty() ? -1 : log[0]);
+
+        amf_int32 gaps = 0;
+        amf_int32 jumps = 0;
+        amf_int32 seekStart = -1;
+        for (amf_size i = 1; i < log.size(); i++)
+        {
+            const amf_int32 prev = log[i - 1];
+            const amf_int32 index = log[i];
+            TEST_CHECK(index != s_ErrorMark && prev != s_ErrorMark, "%s: QueryOutput() failed or returned a foreign buffer", name);
+            if (index == s_EofMark || prev == s_EofMark || index == prev + 1)
+            {
+                continue;
+            }
+            if (index < prev)
+            {
+                jumps++;
+                seekStart = index;
+            }
+            else
+            {
+                // buffers queued at Flush() are dropped, later ones are still in order
+                TEST_CHECK(jumps == 0, "%s: %d follows %d after the seek", name, index, prev);
+                gaps++;
+            }
+        }
+        TEST_CHECK(gaps <= 1, "%s: %d gaps, only Flush() may drop buffers", name, gaps);
+        TEST_CHECK(jumps == 1, "%s: %d jumps back, expected one for Seek()", name, jumps);
+        // the NUT syncpoint before the target can be a few packets early
+        TEST_CHECK(seekStart > s_SeekIndex - 10 && seekStart <= s_SeekIndex, "%s: Seek() resumed at %d", name, seekStart);
+        return failures;
+    }
+}
+
+int TestDemuxerReadAhead()
+{
+    int failures = 0;
+
+    if (g_AMFFactory.Init() != AMF_OK)
+    {
+        printf("SKIPPED TestDemuxerReadAhead: AMF runtime is not available\n");
+        return failures;
+    }
+
+    AMFContextPtr pContext;
+    g_AMFFactory.GetFactory()->CreateContext(&pContext);
+    TEST_CHECK(pContext != NULL, "CreateContext() failed");
+
+    AMFDataStreamPtr pStream;
+    AMFDataStream::OpenDataStream(L"memory://", AMFSO_READ_WRITE, AMFFS_EXCLUSIVE, &pStream);
+    TEST_CHECK(pStream != NULL, "OpenDataStream(memory://) failed");
+    if (pContext == NULL || pStream == NULL)
+    {
+        g_AMFFactory.Terminate();
+        return failures;
+    }
+    TEST_CHECK(MuxTestStream(pStream), "muxing the test stream failed");
+
+    {
+        AMFComponentExPtr pDemuxer = new AMFInterfaceMultiImpl< AMFFileDemuxerFFMPEGImpl, AMFComponentEx, AMFContext* >(pContext);
+        pDemuxer->SetProperty(FFMPEG_DEMUXER_INPUT_STREAM, AMFInterfacePtr(pStream));
+        pDemuxer->SetProperty(FFMPEG_DEMUXER_READ_AHEAD, true);
+        // two audio packets or ten video packets fill a queue, only the duration is unlimited
+        pDemuxer->SetProperty(FFMPEG_DEMUXER_READ_AHEAD_MAX_BYTES, 4096);
+        pDemuxer->SetProperty(FFMPEG_DEMUXER_READ_AHEAD_MAX_DURATION, 0);
+
+        AMF_RESULT res = pDemuxer->Init(AMF_SURFACE_UNKNOWN, 0, 0);
+        TEST_CHECK(res == AMF_OK, "Init() failed: %d", (int)res);
+        TEST_CHECK(pDemuxer->GetOutputCount() == 2, "%d outputs instead of video and audio", (int)pDemuxer->GetOutputCount());
+
+        AMFOutputPtr pVideo;
+        AMFOutputPtr pAudio;
+        for (amf_int32 i = 0; res == AMF_OK && i < pDemuxer->GetOutputCount(); i++)
+        {
+            AMFOutputPtr pOutput;
+            pDemuxer->GetOutput(i, &pOutput);
+            amf_int64 type = AMF_STREAM_UNKNOWN;
+            pOutput->GetProperty(AMF_STREAM_TYPE, &type);
+            (type == AMF_STREAM_VIDEO ? pVideo : pAudio) = pOutput;
+        }
+
+        if (pVideo != NULL && pAudio != NULL)
+        {
+            // the reader must wait for the outputs instead of dropping what it reads meanwhile
+            amf_sleep(20);
+            pVideo->SetProperty(AMF_STREAM_ENABLED, true);
+            pAudio->SetProperty(AMF_STREAM_ENABLED, true);
+
+            DrainThread video(pVideo, 1);
+            DrainThread audio(pAudio, 2);
+            video.Start();
+            audio.Start();
+
+            TEST_CHECK(WaitFor(audio, 20), "audio did not reach packet 20");
+            TEST_CHECK(video.GetLast() != s_EofMark, "the reader finished before Flush()");
+            pDemuxer->Flush();
+
+            TEST_CHECK(WaitFor(audio, 2 * s_SeekIndex), "audio did not reach packet %d", 2 * s_SeekIndex);
+            TEST_CHECK(video.GetLast() != s_EofMark, "the reader finished before Seek()");
+            const amf_int32 videoAtSeek = video.GetLast();
+            AMFMediaSourcePtr pSource(pDemuxer);
+            res = pSource->Seek(s_SeekIndex * AMF_SECOND / 25, AMF_SEEK_PREV_KEYFRAME, -1);
+            TEST_CHECK(res == AMF_OK, "Seek() failed: %d", (int)res);
+
+            const bool bVideoEof = WaitFor(video, s_EofMark);
+            const bool bAudioEof = WaitFor(audio, s_EofMark);
+            TEST_CHECK(bVideoEof && bAudioEof, "no EOF after Seek(): video %d, audio %d", video.GetLast(), audio.GetLast());
+            video.RequestStop();
+            audio.RequestStop();
+            video.WaitForStop();
+            audio.WaitForStop();
+
+            // the slow output holds more than its limit instead of pacing the fast one
+            TEST_CHECK(videoAtSeek > 2 * s_SeekIndex, "video was at %d when audio was at %d", videoAtSeek, 2 * s_SeekIndex);
+            TEST_CHECK(video.GetEofTime() < audio.GetEofTime(), "video did not finish before audio");
+
+            failures += CheckLog("video", video.GetLog(), true);
+            failures += CheckLog("audio", audio.GetLog(), false);
+        }
+        pDemuxer->Terminate();
+    }
+    pStream = NULL;
+    pContext = NULL;
+    g_AMFFactory.Terminate();
+    return failures;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+    const int failures = TestDemuxerReadAhead();
+    printf("%s: %d failed check(s)\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "MuxerTests.h"
+#include "public/src/components/ComponentsFFMPEG/FileWriterIO.h"
+
+extern "C"
+{
+    #include "libavformat/avio.h"
+}
+
+#include <stdio.h>
+
+using namespace amf;
+
+namespace
+{
+    const amf_size  s_BufferSize = 16 * 1024;
+    const wchar_t*  s_Path = L"amf-file-writer-io-test.bin";
+
+    // writes through the AVIOContext and applies the same write to the expected content
+    class Writer
+    {
+    public:
+        Writer(AVIOContext* pContext) : m_pContext(pContext), m_iPosition(0), m_iSeed(0) {}
+
+        void Write(amf_size size)
+        {
+            amf_vector<amf_uint8> data(size);
+            for (amf_size i = 0; i < size; i++)
+            {
+                data[i] = (amf_uint8)((m_iSeed * 131 + i * 7) & 0xFF);
+            }
+            m_iSeed++;
+            avio_write(m_pContext, &data[0], (int)size);
+
+            if (m_iPosition + size > m_Expected.size())
+            {
+                m_Expected.resize(m_iPosition + size);
+            }
+            memcpy(&m_Expected[m_iPosition], &data[0], size);
+            m_iPosition += size;
+        }
+        void Seek(amf_int64 position)
+        {
+            avio_seek(m_pContext, position, SEEK_SET);
+            m_iPosition = (amf_size)position;
+        }
+        void SeekToEnd()
+        {
+            // avio_seek() takes SEEK_SET and SEEK_CUR only
+            avio_seek(m_pContext, avio_size(m_pContext), SEEK_SET);
+            m_iPosition = m_Expected.size();
+        }
+        const amf_vector<amf_uint8>& GetExpected() const { return m_Expected; }
+
+    private:
+        AVIOContext*            m_pContext;
+        amf_size                m_iPosition;
+        amf_size                m_iSeed;
+        amf_vector<amf_uint8>   m_Expected;
+    };
+
+    bool CheckFile(const amf_vector<amf_uint8>& expected)
+    {
+        FILE* pFile = fopen(amf_from_unicode_to_utf8(s_Path).c_str(), "rb");
+        if (pFile == NULL)
+        {
+            return false;
+        }
+        amf_vector<amf_uint8> content(expected.size() + 1);
+        const amf_size read = fread(&content[0], 1, content.size(), pFile);
+        fclose(pFile);
+        return read == expected.size() && memcmp(&content[0], &expected[0], read) == 0;
+    }
+
+    // a muxer-like pattern: header, full buffers, a header rewrite after a seek back,
+    // more data from an unaligned end and a block aligned rewrite of one buffer;
+    // the context hands full buffers over at once and the rest on a seek, so the writes are
+    // 16K at 0, 16K, 32K - 948 - 20 at 10 - 4 x 16K from 50100 - 4464 - 16K at 16K
+    int RunPattern(const char* name, bool bDirectIO, amf_int64 syncInterval, amf_int64 expectedSyncs)
+    {
+        int failures = 0;
+
+        AMFFileWriterIO io;
+        AMF_RESULT res = io.Open(s_Path, s_BufferSize, bDirectIO, syncInterval);
+        TEST_CHECK(res == AMF_OK, "%s: Open() failed: %d", name, (int)res);
+        if (res != AMF_OK)
+        {
+            return failures;
+        }
+
+        Writer writer(io.GetContext());
+        writer.Write(100);
+        writer.Write(50000);        // three full buffers at 0, 16K and 32K
+        writer.Seek(10);
+        writer.Write(20);
+        writer.SeekToEnd();
+        writer.Write(70000);        // full buffers from 50100, none aligned
+        writer.Seek(s_BufferSize);
+        writer.Write(s_BufferSize); // one full buffer at 16K
+
+        // the file system may refuse O_DIRECT, then every write goes through the page cache
+        const bool bDirect = io.IsDirectIO();
+        res = io.Close();
+        TEST_CHECK(res == AMF_OK, "%s: Close() failed: %d", name, (int)res);
+
+        TEST_CHECK(CheckFile(writer.GetExpected()), "%s: the file content differs", name);
+
+        const amf_int64 expectedDirect = bDirect ? 4 : 0;
+        TEST_CHECK(io.GetDirectWrites() == expectedDirect, "%s: %d writes with O_DIRECT, expected %d",
+            name, (int)io.GetDirectWrites(), (int)expectedDirect);
+        TEST_CHECK(io.GetSyncCount() == expectedSyncs, "%s: %d fdatasync calls, expected %d",
+            name, (int)io.GetSyncCount(), (int)expectedSyncs);
+        if (bDirectIO && !bDirect)
+        {
+            printf("NOTE %s: O_DIRECT is not supported here, only the buffered path was checked\n", name);
+        }
+        return failures;
+    }
+}
+
+int TestFileWriterIO()
+{
+    int failures = 0;
+
+    failures += RunPattern("buffered", false, 0, 0);
+    failures += RunPattern("direct", true, 0, 0);
+    // the unsynced bytes pass 32K after the 2nd, 6th, 8th and last write, nothing is left for Close()
+    failures += RunPattern("direct, sync every 32K", true, 32 * 1024, 4);
+    failures += RunPattern("buffered, sync on close", false, 1024 * 1024, 1);
+
+    remove(amf_from_unicode_to_utf8(s_Path).c_str());
+    return failures;
+}
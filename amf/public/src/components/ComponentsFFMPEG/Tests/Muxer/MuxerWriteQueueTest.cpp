@@ -0,0 +1,186 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "MuxerTests.h"
+#include "public/src/components/ComponentsFFMPEG/FileMuxerFFMPEGImpl.h"
+#include "public/common/AMFFactory.h"
+#include "public/common/Thread.h"
+
+#include <string.h>
+
+using namespace amf;
+
+namespace
+{
+    const amf_int32 s_Packets   = 300;
+    const amf_int64 s_QueueSize = 4;
+    const wchar_t*  s_Path      = L"amf-muxer-write-queue-test.nut";
+
+    // packet i starts with its index, the rest is a pattern of the index
+    amf_size PacketSize(amf_int32 index)
+    {
+        return 1000 + ((amf_size)index * 7919) % 20000;
+    }
+    void FillPacket(amf_uint8* pData, amf_int32 index)
+    {
+        const amf_size size = PacketSize(index);
+        memcpy(pData, &index, sizeof(index));
+        for (amf_size i = sizeof(index); i < size; i++)
+        {
+            pData[i] = (amf_uint8)((index + i) & 0xFF);
+        }
+    }
+    bool CheckPacket(const amf_uint8* pData, amf_size size, amf_int32 index)
+    {
+        if (size != PacketSize(index))
+        {
+            return false;
+        }
+        amf_vector<amf_uint8> expected(size);
+        FillPacket(&expected[0], index);
+        return memcmp(pData, &expected[0], size) == 0;
+    }
+
+    // demuxes the file and returns the number of packets in order, stops at the first bad one
+    amf_int32 CheckFile()
+    {
+        AVFormatContext* pFormat = NULL;
+        if (avformat_open_input(&pFormat, amf_from_unicode_to_utf8(s_Path).c_str(), NULL, NULL) < 0)
+        {
+            return -1;
+        }
+        amf_int32 count = 0;
+        AVPacket* pPacket = av_packet_alloc();
+        while (pPacket != NULL && av_read_frame(pFormat, pPacket) >= 0)
+        {
+            const bool bOk = CheckPacket(pPacket->data, (amf_size)pPacket->size, count);
+            av_packet_unref(pPacket);
+            if (!bOk)
+            {
+                break;
+            }
+            count++;
+        }
+        av_packet_free(&pPacket);
+        avformat_close_input(&pFormat);
+        return count;
+    }
+}
+
+// the producer submits faster than the writer thread writes, so the bounded queue
+// fills up; every packet must still reach the file once and in order
+int TestMuxerWriteQueue()
+{
+    int failures = 0;
+
+    if (g_AMFFactory.Init() != AMF_OK)
+    {
+        printf("SKIPPED TestMuxerWriteQueue: AMF runtime is not available\n");
+        return failures;
+    }
+
+    AMFContextPtr pContext;
+    g_AMFFactory.GetFactory()->CreateContext(&pContext);
+    TEST_CHECK(pContext != NULL, "CreateContext() failed");
+    if (pContext == NULL)
+    {
+        g_AMFFactory.Terminate();
+        return failures;
+    }
+
+    amf_int32 inputFull = 0;
+    {
+        AMFComponentExPtr pMuxer = new AMFInterfaceMultiImpl< AMFFileMuxerFFMPEGImpl, AMFComponentEx, AMFContext* >(pContext);
+        pMuxer->SetProperty(FFMPEG_MUXER_PATH, s_Path);
+        pMuxer->SetProperty(FFMPEG_MUXER_ASYNC_WRITE, true);
+        pMuxer->SetProperty(FFMPEG_MUXER_WRITE_QUEUE_SIZE, s_QueueSize);
+        pMuxer->SetProperty(FFMPEG_MUXER_IO_BUFFER_SIZE, 64 * 1024);
+        pMuxer->SetProperty(FFMPEG_MUXER_DIRECT_IO, true);
+        pMuxer->SetProperty(FFMPEG_MUXER_SYNC_INTERVAL, 256 * 1024);
+
+        AMFInputPtr pInput;
+        pMuxer->GetInput(0, &pInput);
+        pInput->SetProperty(AMF_STREAM_VIDEO_FRAME_SIZE, AMFConstructSize(64, 64));
+        pInput->SetProperty(AMF_STREAM_VIDEO_FRAME_RATE, AMFConstructRate(30, 1));
+
+        AMF_RESULT res = pMuxer->Init(AMF_SURFACE_UNKNOWN, 0, 0);
+        TEST_CHECK(res == AMF_OK, "Init() failed: %d", (int)res);
+
+        for (amf_int32 i = 0; res == AMF_OK && i < s_Packets; i++)
+        {
+            AMFBufferPtr pBuffer;
+            res = pContext->AllocBuffer(AMF_MEMORY_HOST, PacketSize(i), &pBuffer);
+            TEST_CHECK(res == AMF_OK, "AllocBuffer() failed: %d", (int)res);
+            if (res != AMF_OK)
+            {
+                break;
+            }
+            FillPacket(static_cast<amf_uint8*>(pBuffer->GetNative()), i);
+            pBuffer->SetPts(i * AMF_SECOND / 30);
+            pBuffer->SetDuration(AMF_SECOND / 30);
+
+            while ((res = pInput->SubmitInput(pBuffer)) == AMF_INPUT_FULL)
+            {
+                inputFull++;
+                amf_sleep(1);
+            }
+            TEST_CHECK(res == AMF_OK, "SubmitInput(%d) failed: %d", i, (int)res);
+
+            amf_int64 depth = 0;
+            pMuxer->GetProperty(FFMPEG_MUXER_STAT_QUEUE_DEPTH, &depth);
+            TEST_CHECK(depth <= s_QueueSize, "%d packets queued, the limit is %d", (int)depth, (int)s_QueueSize);
+        }
+
+        // the last EOF drains the queue, writes the trailer and closes the file
+        res = pInput->SubmitInput(NULL);
+        TEST_CHECK(res == AMF_EOF, "SubmitInput(NULL) returned %d instead of AMF_EOF", (int)res);
+
+        amf_pts average = 0;
+        amf_pts longest = 0;
+        pMuxer->GetProperty(FFMPEG_MUXER_STAT_WRITE_LATENCY_AVG, &average);
+        pMuxer->GetProperty(FFMPEG_MUXER_STAT_WRITE_LATENCY_MAX, &longest);
+        TEST_CHECK(average > 0 && longest >= average, "write latency avg %lld, max %lld", (long long)average, (long long)longest);
+
+        pMuxer->Terminate();
+    }
+    pContext = NULL;
+    g_AMFFactory.Terminate();
+
+    const amf_int32 count = CheckFile();
+    TEST_CHECK(count == s_Packets, "%d of %d packets read back intact and in order", count, s_Packets);
+    printf("TestMuxerWriteQueue: the queue was full %d times\n", inputFull);
+
+    remove(amf_from_unicode_to_utf8(s_Path).c_str());
+    return failures;
+}
@@ -0,0 +1,390 @@
+//
+// Notice Regarding Standards.  AMD does not provide a license or sublicense to
+// any Intellectual Property Rights relating to any standards, including but not
+// limited to any audio and/or video codec technologies such as MPEG-2, MPEG-4;
+// AVC/H.264; HEVC/H.265; AAC decode/FFMPEG; AAC encode/FFMPEG; VC-1; and MP3
+// (collectively, the "Media Technologies"). For clarity, you will pay any
+// royalties due for such third party technologies, which may include the Media
+// Technologies that are owed as a result of AMD providing the Software to you.
+//
+// MIT license
+//
+//
+// Copyright (c) 2018 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "ComponentTests.h"
+#include "../PixelRepack.h"
+#include "public/common/AMFSTL.h"
+#include "public/common/Thread.h"
+#include <string.h>
+
+using namespace amf;
+
+namespace
+{
+    const amf_size  GUARD_BYTES = 64;      // checked after every line for writes past the end
+    const amf_uint8 GUARD_VALUE = 0xCD;
+
+    const AMF_PIXEL_REPACK_ISA s_Levels[] = { AMF_PIXEL_REPACK_SSE41, AMF_PIXEL_REPACK_AVX2, AMF_PIXEL_REPACK_AVX512 };
+
+    const char* GetISAName(AMF_PIXEL_REPACK_ISA eISA)
+    {
+        switch (eISA)
+        {
+        case AMF_PIXEL_REPACK_SSE41:    return "SSE4.1";
+        case AMF_PIXEL_REPACK_AVX2:     return "AVX2";
+        case AMF_PIXEL_REPACK_AVX512:   return "AVX-512";
+        default:                        return "scalar";
+        }
+    }
+
+    void FillRandom(amf_vector<amf_uint8>& buffer, amf_uint32& seed)
+    {
+        for (amf_size i = 0; i < buffer.size(); i++)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            buffer[i] = amf_uint8(seed);
+        }
+    }
+
+    // runs one line kernel for a line of count units, source and destination pointers
+    // are offset by misalign bytes to cover unaligned loads and stores
+    struct LineKernel
+    {
+        const char* pName;
+        amf_size    srcUnitBytes[3];    // per source plane, 0 - plane unused
+        amf_size    dstUnitBytes;
+        bool        bShift;
+        void (*Run)(const AMFPixelRepackKernels& kernels, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32 shift);
+    };
+
+    #define SRC16(i) reinterpret_cast<const amf_uint16*>(ppSrc[i])
+    #define DST16    reinterpret_cast<amf_uint16*>(pDst)
+
+    void RunInterleaveUV8(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32)
+    {
+        k.InterleaveUV8(pDst, ppSrc[0], ppSrc[1], count);
+    }
+    void RunInterleaveUV16(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32 shift)
+    {
+        k.InterleaveUV16(DST16, SRC16(0), SRC16(1), count, shift);
+    }
+    void RunShift16(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32 shift)
+    {
+        k.Shift16(DST16, SRC16(0), count, shift);
+    }
+    void RunPackY210(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32 shift)
+    {
+        k.PackY210(DST16, SRC16(0), SRC16(1), SRC16(2), count, shift);
+    }
+    void RunPackY416(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32 shift)
+    {
+        k.PackY416(DST16, SRC16(0), SRC16(1), SRC16(2), count, shift);
+    }
+    void RunRGB48BEToRGBA8(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32)
+    {
+        k.RGB48BEToRGBA8(pDst, ppSrc[0], count);
+    }
+    void RunRGB48LEToRGBA8(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32)
+    {
+        k.RGB48LEToRGBA8(pDst, ppSrc[0], count);
+    }
+    void RunRGBA64LEToRGBA8(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32)
+    {
+        k.RGBA64LEToRGBA8(pDst, ppSrc[0], count);
+    }
+    void RunRGB48BEToRGBA16(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32)
+    {
+        k.RGB48BEToRGBA16(DST16, ppSrc[0], count);
+    }
+    void RunRGB48LEToRGBA16(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* const* ppSrc, amf_size count, amf_int32)
+    {
+        k.RGB48LEToRGBA16(DST16, ppSrc[0], count);
+    }
+
+    #undef SRC16
+    #undef DST16
+
+    // Y210 count is in pixel pairs: two luma samples per unit
+    const LineKernel s_LineKernels[] =
+    {
+        { "InterleaveUV8",      { 1, 1, 0 }, 2, false, RunInterleaveUV8 },
+        { "InterleaveUV16",     { 2, 2, 0 }, 4, true,  RunInterleaveUV16 },
+        { "Shift16",            { 2, 0, 0 }, 2, true,  RunShift16 },
+        { "PackY210",           { 4, 2, 2 }, 8, true,  RunPackY210 },
+        { "PackY416",           { 2, 2, 2 }, 8, true,  RunPackY416 },
+        { "RGB48BEToRGBA8",     { 6, 0, 0 }, 4, false, RunRGB48BEToRGBA8 },
+        { "RGB48LEToRGBA8",     { 6, 0, 0 }, 4, false, RunRGB48LEToRGBA8 },
+        { "RGBA64LEToRGBA8",    { 8, 0, 0 }, 4, false, RunRGBA64LEToRGBA8 },
+        { "RGB48BEToRGBA16",    { 6, 0, 0 }, 8, false, RunRGB48BEToRGBA16 },
+        { "RGB48LEToRGBA16",    { 6, 0, 0 }, 8, false, RunRGB48LEToRGBA16 },
+    };
+    const amf_size s_LineKernelCount = sizeof(s_LineKernels) / sizeof(s_LineKernels[0]);
+
+    int TestLineKernel(const LineKernel& kernel, const AMFPixelRepackKernels& reference, const AMFPixelRepackKernels& tested,
+        amf_size count, amf_size misalign, amf_int32 shift, amf_uint32& seed)
+    {
+        int failures = 0;
+
+        amf_vector<amf_uint8> src[3];
+        const amf_uint8* pSrc[3] = {};
+        for (int plane = 0; plane < 3; plane++)
+        {
+            if (kernel.srcUnitBytes[plane] != 0)
+            {
+                src[plane].resize(count * kernel.srcUnitBytes[plane] + misalign);
+                FillRandom(src[plane], seed);
+                pSrc[plane] = src[plane].data() + misalign;
+            }
+        }
+        const amf_size dstSize = count * kernel.dstUnitBytes;
+        amf_vector<amf_uint8> expected(misalign + dstSize + GUARD_BYTES, GUARD_VALUE);
+        amf_vector<amf_uint8> actual(expected.size(), GUARD_VALUE);
+
+        kernel.Run(reference, expected.data() + misalign, pSrc, count, shift);
+        kernel.Run(tested, actual.data() + misalign, pSrc, count, shift);
+
+        if (memcmp(expected.data(), actual.data(), expected.size()) != 0)
+        {
+            amf_size pos = 0;
+            while (expected[pos] == actual[pos])
+            {
+                pos++;
+            }
+            TEST_CHECK(false, "%s %s: count=%d misalign=%d shift=%d differs from scalar at byte %d%s", kernel.pName, GetISAName(tested.eISA),
+                (int)count, (int)misalign, (int)shift, (int)(pos - misalign), pos >= misalign + dstSize ? " (past the end)" : "");
+        }
+        return failures;
+    }
+
+    //---------------------------------------------------------------------------------------------
+    // frame level conversions as done by the decoder copy paths, for the benchmark
+    struct FrameFormat
+    {
+        const char* pName;
+        void (*Run)(const AMFPixelRepackKernels& kernels, amf_uint8* pDst, const amf_uint8* pSrc, amf_int32 width, amf_int32 height);
+        amf_size    srcBytesPerPixel;   // over all source planes, x2 for 4:2:0 sizes
+        amf_size    dstBytesPerPixel;
+    };
+
+    // sources are stored as planes back to back in pSrc, destinations as AMF surfaces would be
+    void RunNV12(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* pSrc, amf_int32 width, amf_int32 height)
+    {
+        const amf_uint8* pU = pSrc + width * height;
+        const amf_uint8* pV = pU + (width / 2) * (height / 2);
+        amf_uint8* pUV = pDst + width * height;
+        for (amf_int32 y = 0; y < height / 2; y++)
+        {
+            k.InterleaveUV8(pUV + y * width, pU + y * (width / 2), pV + y * (width / 2), width / 2);
+        }
+    }
+    void RunP010(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* pSrc, amf_int32 width, amf_int32 height)
+    {
+        const amf_uint16* pY = reinterpret_cast<const amf_uint16*>(pSrc);
+        const amf_uint16* pU = pY + width * height;
+        const amf_uint16* pV = pU + (width / 2) * (height / 2);
+        amf_uint16* pOutY = reinterpret_cast<amf_uint16*>(pDst);
+        amf_uint16* pOutUV = pOutY + width * height;
+        for (amf_int32 y = 0; y < height; y++)
+        {
+            k.Shift16(pOutY + y * width, pY + y * width, width, 6);
+        }
+        for (amf_int32 y = 0; y < height / 2; y++)
+        {
+            k.InterleaveUV16(pOutUV + y * width, pU + y * (width / 2), pV + y * (width / 2), width / 2, 6);
+        }
+    }
+    void RunY210(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* pSrc, amf_int32 width, amf_int32 height)
+    {
+        const amf_uint16* pY = reinterpret_cast<const amf_uint16*>(pSrc);
+        const amf_uint16* pU = pY + width * height;
+        const amf_uint16* pV = pU + (width / 2) * height;
+        amf_uint16* pOut = reinterpret_cast<amf_uint16*>(pDst);
+        for (amf_int32 y = 0; y < height; y++)
+        {
+            k.PackY210(pOut + y * width * 2, pY + y * width, pU + y * (width / 2), pV + y * (width / 2), width / 2, 6);
+        }
+    }
+    void RunY416(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* pSrc, amf_int32 width, amf_int32 height)
+    {
+        const amf_uint16* pY = reinterpret_cast<const amf_uint16*>(pSrc);
+        const amf_uint16* pU = pY + width * height;
+        const amf_uint16* pV = pU + width * height;
+        amf_uint16* pOut = reinterpret_cast<amf_uint16*>(pDst);
+        for (amf_int32 y = 0; y < height; y++)
+        {
+            k.PackY416(pOut + y * width * 4, pY + y * width, pU + y * width, pV + y * width, width, 4);
+        }
+    }
+    void RunRGB48ToRGBA8(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* pSrc, amf_int32 width, amf_int32 height)
+    {
+        for (amf_int32 y = 0; y < height; y++)
+        {
+            k.RGB48LEToRGBA8(pDst + y * width * 4, pSrc + y * width * 6, width);
+        }
+    }
+    void RunRGBA64ToRGBA8(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* pSrc, amf_int32 width, amf_int32 height)
+    {
+        for (amf_int32 y = 0; y < height; y++)
+        {
+            k.RGBA64LEToRGBA8(pDst + y * width * 4, pSrc + y * width * 8, width);
+        }
+    }
+    void RunRGB48ToRGBA16(const AMFPixelRepackKernels& k, amf_uint8* pDst, const amf_uint8* pSrc, amf_int32 width, amf_int32 height)
+    {
+        for (amf_int32 y = 0; y < height; y++)
+        {
+            k.RGB48LEToRGBA16(reinterpret_cast<amf_uint16*>(pDst) + y * width * 4, pSrc + y * width * 6, width);
+        }
+    }
+
+    // bytes per pixel are doubled to keep 4:2:0 sizes integral
+    const FrameFormat s_FrameFormats[] =
+    {
+        { "NV12 (yuv420p)",         RunNV12,            3,  3 },
+        { "P010 (yuv420p10)",       RunP010,            6,  6 },
+        { "Y210 (yuv422p10)",       RunY210,            8,  8 },
+        { "Y416 (yuv444p12)",       RunY416,            12, 16 },
+        { "RGBA8 (rgb48le)",        RunRGB48ToRGBA8,    12, 8 },
+        { "RGBA8 (rgba64le)",       RunRGBA64ToRGBA8,   16, 8 },
+        { "RGBA16 (rgb48le)",       RunRGB48ToRGBA16,   12, 16 },
+    };
+
+    struct Resolution
+    {
+        const char* pName;
+        amf_int32   width;
+        amf_int32   height;
+    };
+    const Resolution s_Resolutions[] =
+    {
+        { "720p",   1280, 720 },
+        { "1080p",  1920, 1080 },
+        { "4K",     3840, 2160 },
+    };
+
+    // average time per frame in ms, at least minDuration of work after one warm up frame
+    double MeasureFrame(const FrameFormat& format, const AMFPixelRepackKernels& kernels, amf_uint8* pDst, const amf_uint8* pSrc,
+        amf_int32 width, amf_int32 height)
+    {
+        static const amf_pts minDuration = AMF_SECOND / 2;
+
+        format.Run(kernels, pDst, pSrc, width, height);
+
+        int frames = 0;
+        const amf_pts start = amf_high_precision_clock();
+        amf_pts elapsed = 0;
+        do
+        {
+            format.Run(kernels, pDst, pSrc, width, height);
+            frames++;
+            elapsed = amf_high_precision_clock() - start;
+        } while (elapsed < minDuration);
+
+        return double(elapsed) / frames / AMF_MILLISECOND;
+    }
+}
+
+int TestPixelRepack()
+{
+    int failures = 0;
+    amf_uint32 seed = 0x12345678;
+
+    const AMFPixelRepackKernels& reference = GetPixelRepackKernels(AMF_PIXEL_REPACK_SCALAR);
+    for (amf_size level = 0; level < sizeof(s_Levels) / sizeof(s_Levels[0]); level++)
+    {
+        const AMFPixelRepackKernels& tested = GetPixelRepackKernels(s_Levels[level]);
+        if (tested.eISA != s_Levels[level])
+        {
+            printf("PixelRepack: %s not supported by this CPU, skipped\n", GetISAName(s_Levels[level]));
+            continue;
+        }
+        for (amf_size kernel = 0; kernel < s_LineKernelCount; kernel++)
+        {
+            const LineKernel& line = s_LineKernels[kernel];
+            const amf_int32 shifts[] = { 0, 4, 6 };
+            const amf_size shiftCount = line.bShift ? sizeof(shifts) / sizeof(shifts[0]) : 1;
+            for (amf_size s = 0; s < shiftCount; s++)
+            {
+                // every tail length of the widest vector loop, then typical line widths
+                for (amf_size count = 0; count <= 160; count++)
+                {
+                    failures += TestLineKernel(line, reference, tested, count, count % 4, shifts[s], seed);
+                }
+                const amf_size widths[] = { 255, 640, 719, 960, 1279, 1280, 1919, 1920, 3839, 3840 };
+                for (amf_size w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+                {
+                    for (amf_size misalign = 0; misalign < 4; misalign++)
+                    {
+                        failures += TestLineKernel(line, reference, tested, widths[w], misalign, shifts[s], seed);
+                    }
+                }
+            }
+        }
+        printf("PixelRepack: %s checked against scalar\n", GetISAName(tested.eISA));
+    }
+    printf("PixelRepack: %d failed check(s)\n", failures);
+    return failures;
+}
+
+void BenchmarkPixelRepack()
+{
+    amf_uint32 seed = 0x9e3779b9;
+
+    printf("PixelRepack benchmark, ms per frame (speed-up over scalar)\n");
+    printf("%-20s %-6s %10s", "format", "size", GetISAName(AMF_PIXEL_REPACK_SCALAR));
+    for (amf_size level = 0; level < sizeof(s_Levels) / sizeof(s_Levels[0]); level++)
+    {
+        printf(" %18s", GetISAName(s_Levels[level]));
+    }
+    printf("\n");
+
+    for (amf_size res = 0; res < sizeof(s_Resolutions) / sizeof(s_Resolutions[0]); res++)
+    {
+        const Resolution& resolution = s_Resolutions[res];
+        const amf_size pixels = amf_size(resolution.width) * resolution.height;
+        for (amf_size f = 0; f < sizeof(s_FrameFormats) / sizeof(s_FrameFormats[0]); f++)
+        {
+            const FrameFormat& format = s_FrameFormats[f];
+            amf_vector<amf_uint8> src(pixels * format.srcBytesPerPixel / 2);
+            amf_vector<amf_uint8> dst(pixels * format.dstBytesPerPixel / 2);
+            FillRandom(src, seed);
+
+            const double scalar = MeasureFrame(format, GetPixelRepackKernels(AMF_PIXEL_REPACK_SCALAR), dst.data(), src.data(), resolution.width, resolution.height);
+            printf("%-20s %-6s %10.3f", format.pName, resolution.pName, scalar);
+            for (amf_size level = 0; level < sizeof(s_Levels) / sizeof(s_Levels[0]); level++)
+            {
+                const AMFPixelRepackKernels& kernels = GetPixelRepackKernels(s_Levels[level]);
+                if (kernels.eISA != s_Levels[level])
+                {
+                    printf(" %18s", "-");
+                    continue;
+                }
+                const double ms = MeasureFrame(format, kernels, dst.data(), src.data(), resolution.width, resolution.height);
+                printf(" %10.3f (%4.1fx)", ms, scalar / ms);
+            }
+            printf("\n");
+        }
+    }
+}
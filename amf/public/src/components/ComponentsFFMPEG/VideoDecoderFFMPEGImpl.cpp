@@ -56,7 +56,10 @@ AMFVideoDecoderFFMPEGImpl::AMFVideoDecoderFFMPEGImpl(AMFContext* pContext)
     m_videoFrameQueryCount(0),
     m_eFormat(AMF_SURFACE_UNKNOWN),
     m_FrameRate(AMFConstructRate(25,1)),
-    m_CopyPipeline(&m_InputQueue)
+    m_bZeroCopy(false),
+    m_pDirectPool(nullptr),
+    m_DirectPoolSize(0),
+    m_pThreadPool(nullptr)
 {
     g_AMFFactory.Init();
 
@@ -69,6 +72,7 @@ AMFVideoDecoderFFMPEGImpl::AMFVideoDecoderFFMPEGImpl(AMFContext* pContext)
         AMFPropertyInfoInt64(VIDEO_DECODER_BITRATE, L"Bitrate", 0, 0, INT_MAX, true),
         AMFPropertyInfoRate(VIDEO_DECODER_FRAMERATE, L"Frame rate", 25, 1, false),
         AMFPropertyInfoInt64(VIDEO_DECODER_SEEK_POSITION, L"Seek Position", 0, 0, INT_MAX, true),
+        AMFPropertyInfoBool(VIDEO_DECODER_ZERO_COPY, L"Zero copy output", false, true),
     AMFPrimitivePropertyInfoMapEnd
 
     InitFFMPEG();
@@ -77,6 +81,10 @@ AMFVideoDecoderFFMPEGImpl::AMFVideoDecoderFFMPEGImpl(AMFContext* pContext)
 AMFVideoDecoderFFMPEGImpl::~AMFVideoDecoderFFMPEGImpl()
 {
     Terminate();
+    if (m_pThreadPool != nullptr)
+    {
+        AMFThreadPool::ReleaseShared();
+    }
     g_AMFFactory.Terminate();
 }
 //-------------------------------------------------------------------------------------------------
@@ -215,6 +223,14 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Init(AMF_SURFACE_FORMAT form
 
     m_pCodecContext->strict_std_compliance = FF_COMPLIANCE_STRICT; // MM to try compliance
 
+    // let FFmpeg decode into buffers that QueryOutput can wrap instead of copy
+    GetProperty(VIDEO_DECODER_ZERO_COPY, &m_bZeroCopy);
+    if (m_bZeroCopy && (pCodec->capabilities & AV_CODEC_CAP_DR1) != 0 && IsDirectFormat(m_eFormat, AV_PIX_FMT_NONE))
+    {
+        m_pCodecContext->opaque = this;
+        m_pCodecContext->get_buffer2 = GetBufferDirect;
+    }
+
     if (avcodec_open2(m_pCodecContext, pCodec, NULL) < 0)
     {
         Terminate();
@@ -249,6 +265,13 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::Terminate()
         m_pCodecContext = nullptr;
     }
 
+    // buffers still held by output surfaces keep the pool alive until they are released
+    {
+        AMFLock lock(&m_DirectPoolSync);
+        av_buffer_pool_uninit(&m_pDirectPool);
+        m_DirectPoolSize = 0;
+    }
+
     m_videoFrameSubmitCount = 0;
     m_videoFrameQueryCount = 0;
     m_bEof = false;
@@ -522,20 +545,29 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
 
 
     //
+    // wrap the decoded frame if its layout matches the output format, otherwise
     // allocate output frame to put out and copy the FFmpeg output data into
     // if the allocation fails, we have a bigger issue than trying to recover
     // from that, but try anyway
-    AMF_RESULT err = AMF_OK;
+    AMF_RESULT err = AMF_NOT_SUPPORTED;
     AMFSurfacePtr pSurfaceOut;
-    if (m_pOutputDataCallback != nullptr)
+    if (m_bZeroCopy && m_pOutputDataCallback == nullptr)
     {
-        err = m_pOutputDataCallback->AllocSurface(AMF_MEMORY_HOST, m_eFormat, m_pCodecContext->width, m_pCodecContext->height, 0, 0, &pSurfaceOut);
+        err = WrapFrameDirect(picture, &pSurfaceOut);
     }
-    else
+    const bool bDirect = (err == AMF_OK);
+    if (bDirect == false)
     {
-        err = m_pContext->AllocSurface(AMF_MEMORY_HOST, m_eFormat, m_pCodecContext->width, m_pCodecContext->height, &pSurfaceOut);
+        if (m_pOutputDataCallback != nullptr)
+        {
+            err = m_pOutputDataCallback->AllocSurface(AMF_MEMORY_HOST, m_eFormat, m_pCodecContext->width, m_pCodecContext->height, 0, 0, &pSurfaceOut);
+        }
+        else
+        {
+            err = m_pContext->AllocSurface(AMF_MEMORY_HOST, m_eFormat, m_pCodecContext->width, m_pCodecContext->height, &pSurfaceOut);
+        }
+        AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AllocSurface failed");
     }
-    AMF_RETURN_IF_FAILED(err, L"QueryOutput() - AllocSurface failed");
 
 
     //
@@ -566,80 +598,9 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::QueryOutput(AMFData** ppData
     }
 
 
-    amf_bool  bIsPlanar = (m_eFormat == AMF_SURFACE_RGBA) ? false : true;
-    amf_int32 paddedLSB = (m_eFormat == AMF_SURFACE_P010) ? 6 :
-                          (m_eFormat == AMF_SURFACE_P012) ? 4 :
-                          (m_eFormat == AMF_SURFACE_P016) ? 0 : 0;
-    amf_int32 iThreadCount = 2;
-
-
-    //
-    // handle the Y plane
-    AMFPlanePtr pPlaneY = pSurfaceOut->GetPlane(AMF_PLANE_Y);
-    AMF_RETURN_IF_INVALID_POINTER(pPlaneY, L"QueryOutput() - pPlaneY is NULL");
-
-    if (pPlaneY->GetHeight() > 2160 && m_eFormat != AMF_SURFACE_P010 &&
-                                       m_eFormat != AMF_SURFACE_P012 &&
-                                       m_eFormat != AMF_SURFACE_P016)
-    {
-        CopyFrameThreaded(pPlaneY, picture, iThreadCount, false);
-    }
-    else if (picture.format == AV_PIX_FMT_YUV422P10LE)  //ProRes 10bit 4:2:2 from BM camera
-    {
-        CopyFrameYUV422(pPlaneY, picture);
-        bIsPlanar = false;
-    }
-    else if (picture.format == AV_PIX_FMT_YUV444P10LE)  //YUV444
-    {
-        CopyFrameYUV444(pPlaneY, picture);
-        bIsPlanar = false;
-    }
-    else if ((picture.format == AV_PIX_FMT_RGBA64LE) || //RGB -->RGBA
-             (picture.format == AV_PIX_FMT_RGB48LE)  || //RGB -->RGBA
-             (picture.format == AV_PIX_FMT_RGB48BE))    //RGB -->RGBA
-    {
-        CopyFrameRGB_FP16(pPlaneY, picture);
-        pSurfaceOut->SetProperty(VIDEO_DECODER_COLOR_TRANSFER_CHARACTERISTIC, AMF_COLOR_TRANSFER_CHARACTERISTIC_LINEAR);
-        bIsPlanar = false;
-    }
-    else if (pPlaneY->GetHPitch() == picture.linesize[0])   // AMF plane pitch and FFmpeg linesize match
-    {
-        CopyLineLSB((amf_uint8*) pPlaneY->GetNative(), picture.data[0], pPlaneY->GetHPitch() * pPlaneY->GetHeight(), paddedLSB);
-    }
-    else
-    {
-        amf_uint8 *pTmpMemOut = static_cast<amf_uint8*>(pPlaneY->GetNative());
-        amf_uint8 *pTmpMemIn  = picture.data[0];
-        amf_size  linesToCopy = pPlaneY->GetHeight();
-        amf_size  to_copy     = AMF_MIN(pPlaneY->GetHPitch(), std::abs(picture.linesize[0]));
-
-        while (linesToCopy > 0)
-        {
-            CopyLineLSB(pTmpMemOut, pTmpMemIn, to_copy, paddedLSB);
-            pTmpMemOut += pPlaneY->GetHPitch();
-            pTmpMemIn += picture.linesize[0];
-            linesToCopy -= 1;
-        }
-    }
-
-
-    //
-    // handle the UV plane
-    if (bIsPlanar)
+    if (bDirect == false)
     {
-        AMFPlanePtr pPlaneUV = pSurfaceOut->GetPlane(AMF_PLANE_UV);
-        AMF_RETURN_IF_INVALID_POINTER(pPlaneUV, L"QueryOutput() - pPlaneUV is NULL");
-
-        if (pPlaneUV->GetHeight() > 2160 / 2 && m_eFormat != AMF_SURFACE_P010 &&
-                                                m_eFormat != AMF_SURFACE_P012 &&
-                                                m_eFormat != AMF_SURFACE_P016)
-        {
-            CopyFrameThreaded(pPlaneUV, picture, iThreadCount, true);
-        }
-        else
-        {
-            CopyFrameUV(pPlaneUV, picture, paddedLSB);
-        }
+        AMF_RETURN_IF_FAILED(CopyFrame(pSurfaceOut, picture), L"QueryOutput() - CopyFrame failed");
     }
 
 
@@ -915,16 +876,98 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::GetColorInfo(AMFSurface* pSu
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
-AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameThreaded(AMFPlane* pPlane, const AVFrame& picture, amf_int threadCount, bool isUVPlane)
+AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrame(AMFSurface* pSurfaceOut, const AVFrame& picture)
+{
+    AMF_RETURN_IF_INVALID_POINTER(pSurfaceOut, L"CopyFrame() - pSurfaceOut is NULL");
+
+
+    amf_bool  bIsPlanar = (m_eFormat == AMF_SURFACE_RGBA) ? false : true;
+    amf_int32 paddedLSB = (m_eFormat == AMF_SURFACE_P010) ? 6 :
+                          (m_eFormat == AMF_SURFACE_P012) ? 4 :
+                          (m_eFormat == AMF_SURFACE_P016) ? 0 : 0;
+
+
+    //
+    // handle the Y plane
+    AMFPlanePtr pPlaneY = pSurfaceOut->GetPlane(AMF_PLANE_Y);
+    AMF_RETURN_IF_INVALID_POINTER(pPlaneY, L"CopyFrame() - pPlaneY is NULL");
+
+    if (pPlaneY->GetHeight() > 2160 && m_eFormat != AMF_SURFACE_P010 &&
+                                       m_eFormat != AMF_SURFACE_P012 &&
+                                       m_eFormat != AMF_SURFACE_P016)
+    {
+        CopyFrameThreaded(pPlaneY, picture, false);
+    }
+    else if (picture.format == AV_PIX_FMT_YUV422P10LE)  //ProRes 10bit 4:2:2 from BM camera
+    {
+        CopyFrameYUV422(pPlaneY, picture);
+        bIsPlanar = false;
+    }
+    else if (picture.format == AV_PIX_FMT_YUV444P10LE)  //YUV444
+    {
+        CopyFrameYUV444(pPlaneY, picture);
+        bIsPlanar = false;
+    }
+    else if ((picture.format == AV_PIX_FMT_RGBA64LE) || //RGB -->RGBA
+             (picture.format == AV_PIX_FMT_RGB48LE)  || //RGB -->RGBA
+             (picture.format == AV_PIX_FMT_RGB48BE))    //RGB -->RGBA
+    {
+        CopyFrameRGB_FP16(pPlaneY, picture);
+        pSurfaceOut->SetProperty(VIDEO_DECODER_COLOR_TRANSFER_CHARACTERISTIC, AMF_COLOR_TRANSFER_CHARACTERISTIC_LINEAR);
+        bIsPlanar = false;
+    }
+    else if (pPlaneY->GetHPitch() == picture.linesize[0])   // AMF plane pitch and FFmpeg linesize match
+    {
+        CopyLineLSB((amf_uint8*) pPlaneY->GetNative(), picture.data[0], pPlaneY->GetHPitch() * pPlaneY->GetHeight(), paddedLSB);
+    }
+    else
+    {
+        amf_uint8 *pTmpMemOut = static_cast<amf_uint8*>(pPlaneY->GetNative());
+        amf_uint8 *pTmpMemIn  = picture.data[0];
+        amf_size  linesToCopy = pPlaneY->GetHeight();
+        amf_size  to_copy     = AMF_MIN(pPlaneY->GetHPitch(), std::abs(picture.linesize[0]));
+
+        while (linesToCopy > 0)
+        {
+            CopyLineLSB(pTmpMemOut, pTmpMemIn, to_copy, paddedLSB);
+            pTmpMemOut += pPlaneY->GetHPitch();
+            pTmpMemIn += picture.linesize[0];
+            linesToCopy -= 1;
+        }
+    }
+
+
+    //
+    // handle the UV plane
+    if (bIsPlanar)
+    {
+        AMFPlanePtr pPlaneUV = pSurfaceOut->GetPlane(AMF_PLANE_UV);
+        AMF_RETURN_IF_INVALID_POINTER(pPlaneUV, L"CopyFrame() - pPlaneUV is NULL");
+
+        if (pPlaneUV->GetHeight() > 2160 / 2 && m_eFormat != AMF_SURFACE_P010 &&
+                                                m_eFormat != AMF_SURFACE_P012 &&
+                                                m_eFormat != AMF_SURFACE_P016)
+        {
+            CopyFrameThreaded(pPlaneUV, picture, true);
+        }
+        else
+        {
+            CopyFrameUV(pPlaneUV, picture, paddedLSB);
+        }
+    }
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameThreaded(AMFPlane* pPlane, const AVFrame& picture, bool isUVPlane)
 {
     AMF_RETURN_IF_INVALID_POINTER(pPlane, L"CopyFrameThreaded() - pPlane is NULL");
 
 
-    if (m_CopyPipeline.m_ThreadPool.size() == 0)
+    if (m_pThreadPool == nullptr)
     {
-        m_CopyPipeline.Start(threadCount, 0);
+        m_pThreadPool = AMFThreadPool::AcquireShared();
     }
-    amf_long counter = threadCount;
 
     CopyTask task = {};
 
@@ -933,25 +976,13 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameThreaded(AMFPlane*
     task.pDst = (amf_uint8*)pPlane->GetNative();
     task.SrcLineSize = (!isUVPlane) ? picture.linesize[0] : picture.linesize[1];
     task.DstLineSize = pPlane->GetHPitch();
-    task.pEvent = &m_CopyPipeline.m_endEvent;
-    task.pCounter = &counter;
 
-    const amf_int planeHeight = pPlane->GetHeight();
-    for (int i = 0; i < threadCount; i++)
+    // split the plane into bands of rows, the calling thread copies the first band
+    static const amf_int64 minLinesPerTask = 64;
+    m_pThreadPool->ParallelFor(0, pPlane->GetHeight(), minLinesPerTask, [&task](amf_int64 lineStart, amf_int64 lineEnd)
     {
-        task.lineStart = i * (planeHeight / threadCount);
-        if (i < threadCount - 1)
-        {
-            task.lineEnd = task.lineStart + planeHeight / threadCount;
-        }
-        else
-        {
-            task.lineEnd = planeHeight;
-        }
-        m_InputQueue.Add(i, task);
-    }
-            
-    m_CopyPipeline.m_endEvent.Lock(1000);
+        task.Run((amf_int)lineStart, (amf_int)lineEnd);
+    });
 
     return AMF_OK;
 }
@@ -961,21 +992,17 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameYUV422(AMFPlane* pP
     AMF_RETURN_IF_INVALID_POINTER(pPlane, L"CopyFrameYUV444() - pPlane is NULL");
 
 
+    const AMFPixelRepackKernels& repack = GetPixelRepackKernels();
+
     amf_uint16 *pTmpMemY210 = static_cast<amf_uint16*>(pPlane->GetNative());
     const amf_uint16 *pTmpMemInY  = (const amf_uint16*)(picture.data[0]);
-    const amf_uint16 *pTmpMemInV  = (const amf_uint16*)(picture.data[1]);
-    const amf_uint16 *pTmpMemInU  = (const amf_uint16*)(picture.data[2]);
+    const amf_uint16 *pTmpMemInU  = (const amf_uint16*)(picture.data[1]);
+    const amf_uint16 *pTmpMemInV  = (const amf_uint16*)(picture.data[2]);
     const amf_size    linesToCopy = pPlane->GetHeight();
     const amf_size    uWidth      = pPlane->GetWidth() / 2;  //YUYV
     for (amf_size y = 0; y < linesToCopy; y++)
     {
-        for (amf_size x = 0; x < uWidth; x++)  //UYVY
-        {
-            pTmpMemY210[4 * x + 0] = (pTmpMemInV[x] << 6) & 0xFFC0;        //U
-            pTmpMemY210[4 * x + 1] = (pTmpMemInY[2 * x] << 6) & 0xFFC0;    //Y
-            pTmpMemY210[4 * x + 2] = (pTmpMemInU[x] << 6) & 0xFFC0;        //V
-            pTmpMemY210[4 * x + 3] = (pTmpMemInY[2 * x + 1] << 6) & 0xFFC0;//Y
-        }
+        repack.PackY210(pTmpMemY210, pTmpMemInY, pTmpMemInU, pTmpMemInV, uWidth, 6);   //UYVY
         pTmpMemInY  += picture.linesize[0] / sizeof(amf_uint16);
         pTmpMemInU  += picture.linesize[1] / sizeof(amf_uint16);
         pTmpMemInV  += picture.linesize[2] / sizeof(amf_uint16);
@@ -989,6 +1016,7 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameYUV444(AMFPlane* pP
 {
     AMF_RETURN_IF_INVALID_POINTER(pPlane, L"CopyFrameYUV444() - pPlane is NULL");
 
+    const AMFPixelRepackKernels& repack = GetPixelRepackKernels();
 
     amf_uint16 *pTmpMemYUVA = static_cast<amf_uint16*>(pPlane->GetNative());
     const amf_uint16 *pTmpMemInY  = (const amf_uint16*)(picture.data[0]);
@@ -998,13 +1026,7 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameYUV444(AMFPlane* pP
     const amf_size    uWidth      = pPlane->GetWidth();
     for (amf_size y = 0; y < linesToCopy; y++)
     {
-        for (amf_size x = 0; x < uWidth; x++)
-        {
-            pTmpMemYUVA[4 * x + 0] = pTmpMemInU[x] << 6;
-            pTmpMemYUVA[4 * x + 1] = pTmpMemInY[x] << 6;
-            pTmpMemYUVA[4 * x + 2] = pTmpMemInV[x] << 6;
-            pTmpMemYUVA[4 * x + 3] = 65535;
-        }
+        repack.PackY416(pTmpMemYUVA, pTmpMemInY, pTmpMemInU, pTmpMemInV, uWidth, 6);
         pTmpMemInY += picture.linesize[0] / sizeof(amf_uint16);
         pTmpMemInU += picture.linesize[1] / sizeof(amf_uint16);
         pTmpMemInV += picture.linesize[2] / sizeof(amf_uint16);
@@ -1027,95 +1049,56 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameRGB_FP16(AMFPlane*
     const amf_size   uHeight      = pPlane->GetHeight();      //frame height
     AMF_RESULT       ret          = AMF_OK;
 
+    const AMFPixelRepackKernels& repack = GetPixelRepackKernels();
+
+    // pick the line kernel once instead of testing the pixel format per pixel
+    void (*pfnToRGBA8)(amf_uint8*, const amf_uint8*, amf_size)   = nullptr;
+    void (*pfnToRGBA16)(amf_uint16*, const amf_uint8*, amf_size) = nullptr;
+    switch (iPixelFormat)
+    {
+    case AV_PIX_FMT_RGB48BE:    //png
+        pfnToRGBA8  = repack.RGB48BEToRGBA8;
+        pfnToRGBA16 = repack.RGB48BEToRGBA16;
+        break;
+    case AV_PIX_FMT_RGB48LE:    //EXR
+        pfnToRGBA8  = repack.RGB48LEToRGBA8;
+        pfnToRGBA16 = repack.RGB48LEToRGBA16;
+        break;
+    case AV_PIX_FMT_RGBA64LE:   //EXR, RGBA16 is a plain copy
+        pfnToRGBA8  = repack.RGBA64LEToRGBA8;
+        break;
+    default:
+        return AMF_NOT_SUPPORTED;
+    }
+
     if (m_eFormat == AMF_SURFACE_RGBA)
     {
         const amf_uint8* pSrc = pMemIn;
         amf_uint8* pDst = pMemOut;
         for (amf_size y = 0; y < uHeight; y++)
         {
-            for (amf_size x = 0; x < uWidth; x++)
-            {
-                if (iPixelFormat == AV_PIX_FMT_RGB48BE) //png
-                {
-                    pDst[4 * x + 0] = pSrc[6 * x + 0];
-                    pDst[4 * x + 1] = pSrc[6 * x + 2];
-                    pDst[4 * x + 2] = pSrc[6 * x + 4];
-                    pDst[4 * x + 3] = 255;
-                }
-                else if (iPixelFormat == AV_PIX_FMT_RGB48LE) //EXR
-                {
-                    pDst[4 * x + 0] = pSrc[6 * x + 1];
-                    pDst[4 * x + 1] = pSrc[6 * x + 3];
-                    pDst[4 * x + 2] = pSrc[6 * x + 5];
-                    pDst[4 * x + 3] = 255;
-                }
-                else if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR
-                {
-                    pDst[4 * x + 0] = pSrc[8 * x + 1];
-                    pDst[4 * x + 1] = pSrc[8 * x + 3];
-                    pDst[4 * x + 2] = pSrc[8 * x + 5];
-                    pDst[4 * x + 3] = pSrc[8 * x + 7];
-                }
-                else
-                {
-                    pDst[4 * x + 0] = pSrc[6 * x + 1];
-                    pDst[4 * x + 1] = pSrc[6 * x + 3];
-                    pDst[4 * x + 2] = pSrc[6 * x + 5];
-                }
-            }
+            pfnToRGBA8(pDst, pSrc, uWidth);
             pDst += uPitchOut;
             pSrc += uPitchIn;
         }
     }
     else if (m_eFormat == AMF_SURFACE_RGBA_F16)
     {
-        const amf_uint16 *pSrc = (const amf_uint16 *) pMemIn;
-        amf_uint16 *pDst = (amf_uint16 *)pMemOut;
-        if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR, beter performance
+        const amf_uint8* pSrc = pMemIn;
+        amf_uint8* pDst = pMemOut;
+        const amf_size uLineWidth = uWidth * 4 * sizeof(amf_uint16);
+        for (amf_size y = 0; y < uHeight; y++)
         {
-            const amf_size uLineWidth = uWidth * 4 * sizeof(amf_uint16);
-            for (amf_size y = 0; y < uHeight; y++)
+            if (pfnToRGBA16 != nullptr)
             {
-                memcpy(pDst, pSrc, uLineWidth);
-                pDst += uPitchOut / sizeof(amf_uint16);
-                pSrc += uPitchIn / sizeof(amf_uint16);
+                pfnToRGBA16((amf_uint16*)pDst, pSrc, uWidth);
             }
-        }
-        else
-        {
-            for (amf_size y = 0; y < uHeight; y++)
+            else
             {
-                for (amf_size x = 0; x < uWidth; x++)
-                {
-                    if (iPixelFormat == AV_PIX_FMT_RGB48BE) //png
-                    {
-                        amf_uint8* pTemp = 0;
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 0];
-                        pDst[4 * x + 0] = (pTemp[0] << 8) | pTemp[1];
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 1];
-                        pDst[4 * x + 1] = (pTemp[0] << 8) | pTemp[1];
-                        pTemp = (amf_uint8*)&pSrc[3 * x + 2];
-                        pDst[4 * x + 2] = (pTemp[0] << 8) | pTemp[1];
-                        pDst[4 * x + 3] = 65535;
-                    }
-                    else if (iPixelFormat == AV_PIX_FMT_RGB48LE) //EXR
-                    {
-                        pDst[4 * x + 0] = pSrc[3 * x + 0];
-                        pDst[4 * x + 1] = pSrc[3 * x + 1];
-                        pDst[4 * x + 2] = pSrc[3 * x + 2];
-                        pDst[4 * x + 3] = 65535;
-                    }
-                    else if (iPixelFormat == AV_PIX_FMT_RGBA64LE) //EXR
-                    {
-                        pDst[4 * x + 0] = pSrc[4 * x + 0];
-                        pDst[4 * x + 1] = pSrc[4 * x + 1];
-                        pDst[4 * x + 2] = pSrc[4 * x + 2];
-                        pDst[4 * x + 3] = pSrc[4 * x + 3];
-                    }
-                }
-                pDst += uPitchOut / sizeof(amf_uint16);
-                pSrc += uPitchIn / sizeof(amf_uint16);
+                memcpy(pDst, pSrc, uLineWidth);
             }
+            pDst += uPitchOut;
+            pSrc += uPitchIn;
         }
     }
     else
@@ -1138,23 +1121,15 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameUV(AMFPlane* pPlane
     amf_uint8* pTmpMemOut   = static_cast<amf_uint8*>(pPlaneUV->GetNative());
     amf_uint8* pTmpMemIn[2] = { picture.data[1], picture.data[2] };
 
+    const AMFPixelRepackKernels& repack = GetPixelRepackKernels();
+
     // need to pack uv plane properly for 16-bit colour
     if (pPlaneUV->GetPixelSizeInBytes() == 4)
     {
         for (amf_size y = 0; y < uHeight; y++)
         {
-            amf_uint16* pLineMemOut = (amf_uint16*) pTmpMemOut;
-            amf_uint16* pLineMemIn1 = (amf_uint16*) pTmpMemIn[0];
-            amf_uint16* pLineMemIn2 = (amf_uint16*) pTmpMemIn[1];
-            for (amf_size x = 0; x < uWidth; x++)
-            {
-                // FFMPEG outputs in LSB format but we want MSB
-                // 10-bit example:
-                //     (LSB)         :  000000DD DDDDDDDD
-                //     we want (MSB) :  DDDDDDDD DD000000
-                *pLineMemOut++ = *pLineMemIn1++ << paddedLSB;
-                *pLineMemOut++ = *pLineMemIn2++ << paddedLSB;
-            }
+            // FFMPEG outputs in LSB format, the kernel shifts to MSB while interleaving
+            repack.InterleaveUV16((amf_uint16*)pTmpMemOut, (const amf_uint16*)pTmpMemIn[0], (const amf_uint16*)pTmpMemIn[1], uWidth, paddedLSB);
             pTmpMemOut += iOutStride;
             pTmpMemIn[0] += picture.linesize[1];
             pTmpMemIn[1] += picture.linesize[2];
@@ -1164,14 +1139,7 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyFrameUV(AMFPlane* pPlane
     {
         for (amf_size y = 0; y < uHeight; y++)
         {
-            amf_uint8* pLineMemOut = pTmpMemOut;
-            amf_uint8* pLineMemIn1 = pTmpMemIn[0];
-            amf_uint8* pLineMemIn2 = pTmpMemIn[1];
-            for (amf_size x = 0; x < uWidth; x++)
-            {
-                *pLineMemOut++ = *pLineMemIn1++;
-                *pLineMemOut++ = *pLineMemIn2++;
-            }
+            repack.InterleaveUV8(pTmpMemOut, pTmpMemIn[0], pTmpMemIn[1], uWidth);
             pTmpMemOut += iOutStride;
             pTmpMemIn[0] += picture.linesize[1];
             pTmpMemIn[1] += picture.linesize[2];
@@ -1197,19 +1165,157 @@ AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::CopyLineLSB(amf_uint8* pMemO
         // modifying picture data directly messes up the 
         // decoder big time so we have to do it ourselves
         // by copying the data properly
-        const amf_uint16* pTmp16Src  = (const amf_uint16 *)pMemIn;
-              amf_uint16* pTmp16Dest = (amf_uint16 *)pMemOut;
+        GetPixelRepackKernels().Shift16((amf_uint16 *)pMemOut, (const amf_uint16 *)pMemIn, sizeToCopy >> 1, paddedLSB);
+    }
+    else
+    {
+        memcpy(pMemOut, pMemIn, sizeToCopy);
+    }
+
+    return AMF_OK;
+}
+//-------------------------------------------------------------------------------------------------
+bool AMFVideoDecoderFFMPEGImpl::IsDirectFormat(AMF_SURFACE_FORMAT eFormat, amf_int32 iPixelFormat)
+{
+    // AV_PIX_FMT_NONE checks whether eFormat can be output directly at all
+    switch (eFormat)
+    {
+    case AMF_SURFACE_NV12:      return (iPixelFormat == AV_PIX_FMT_NONE) || (iPixelFormat == AV_PIX_FMT_NV12);
+    case AMF_SURFACE_YUV420P:   return (iPixelFormat == AV_PIX_FMT_NONE) || (iPixelFormat == AV_PIX_FMT_YUV420P) || (iPixelFormat == AV_PIX_FMT_YUVJ420P);
+    case AMF_SURFACE_P010:      return (iPixelFormat == AV_PIX_FMT_NONE) || (iPixelFormat == AV_PIX_FMT_P010LE);
+    case AMF_SURFACE_P016:      return (iPixelFormat == AV_PIX_FMT_NONE) || (iPixelFormat == AV_PIX_FMT_P016LE);
+    case AMF_SURFACE_GRAY8:     return (iPixelFormat == AV_PIX_FMT_NONE) || (iPixelFormat == AV_PIX_FMT_GRAY8);
+    case AMF_SURFACE_RGBA:      return (iPixelFormat == AV_PIX_FMT_NONE) || (iPixelFormat == AV_PIX_FMT_RGBA);
+    case AMF_SURFACE_BGRA:      return (iPixelFormat == AV_PIX_FMT_NONE) || (iPixelFormat == AV_PIX_FMT_BGRA);
+    default:                    return false;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+int AMFVideoDecoderFFMPEGImpl::GetBufferDirect(AVCodecContext* pCodecContext, AVFrame* pFrame, int flags)
+{
+    // called by FFmpeg, possibly from one of its frame threads - formats that
+    // need repacking anyway go through the default allocator
+    AMFVideoDecoderFFMPEGImpl* pThis = static_cast<AMFVideoDecoderFFMPEGImpl*>(pCodecContext->opaque);
+    if (pThis != nullptr && pThis->AllocFrameDirect(pCodecContext, pFrame) == AMF_OK)
+    {
+        return 0;
+    }
+    return avcodec_default_get_buffer2(pCodecContext, pFrame, flags);
+}
+//-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::AllocFrameDirect(AVCodecContext* pCodecContext, AVFrame* pFrame)
+{
+    if (IsDirectFormat(m_eFormat, pFrame->format) == false)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+
+    int width  = pFrame->width;
+    int height = pFrame->height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS] = {};
+    avcodec_align_dimensions2(pCodecContext, &width, &height, linesizeAlign);
+
+    const AVPixFmtDescriptor* pDesc = av_pix_fmt_desc_get((AVPixelFormat)pFrame->format);
+    AMF_RETURN_IF_INVALID_POINTER(pDesc, L"AllocFrameDirect() - unknown pixel format %d", pFrame->format);
 
-        for (amf_size lineIdx = 0; lineIdx < sizeToCopy >> 1; lineIdx++)
+    // one allocation in the layout CreateSurfaceFromHostNative() expects: chroma
+    // right below luma, and a pitch that keeps every plane aligned for FFmpeg's SIMD
+    static const int planeAlign = 64;
+    const bool  bPlanarChroma = (pDesc->flags & AV_PIX_FMT_FLAG_PLANAR) != 0 && pDesc->nb_components >= 3 && av_pix_fmt_count_planes((AVPixelFormat)pFrame->format) == 3;
+    const int   lumaBytes     = av_image_get_linesize((AVPixelFormat)pFrame->format, width, 0);
+    AMF_RETURN_IF_FALSE(lumaBytes > 0, AMF_NOT_SUPPORTED, L"AllocFrameDirect() - av_image_get_linesize failed");
+
+    int pitchAlign = bPlanarChroma ? planeAlign * 2 : planeAlign;
+    for (int i = 0; i < AV_NUM_DATA_POINTERS; i++)
+    {
+        pitchAlign = AMF_MAX(pitchAlign, linesizeAlign[i]);
+    }
+    const int pitch   = FFALIGN(lumaBytes, pitchAlign);
+    const int vPitch  = FFALIGN(height, 2);
+    const int planes  = av_pix_fmt_count_planes((AVPixelFormat)pFrame->format);
+    const amf_size lumaSize   = amf_size(pitch) * vPitch;
+    const amf_size chromaSize = (planes == 1) ? 0 : lumaSize / 2;   // 4:2:0 only
+    const amf_size size       = lumaSize + chromaSize + 16 + planeAlign - 1;  // same over-read slack as the default allocator
+
+    {
+        AMFLock lock(&m_DirectPoolSync);
+        if (m_pDirectPool == nullptr || m_DirectPoolSize != size)
         {
-            pTmp16Dest[lineIdx] = pTmp16Src[lineIdx] << paddedLSB;
+            av_buffer_pool_uninit(&m_pDirectPool);
+            m_pDirectPool = av_buffer_pool_init(size, av_buffer_alloc);
+            m_DirectPoolSize = size;
+            AMF_RETURN_IF_INVALID_POINTER(m_pDirectPool, L"AllocFrameDirect() - av_buffer_pool_init failed");
         }
+        pFrame->buf[0] = av_buffer_pool_get(m_pDirectPool);
     }
-    else
+    AMF_RETURN_IF_INVALID_POINTER(pFrame->buf[0], L"AllocFrameDirect() - av_buffer_pool_get failed");
+
+    amf_uint8* pData = pFrame->buf[0]->data;
+    pFrame->data[0]     = pData;
+    pFrame->linesize[0] = pitch;
+    if (bPlanarChroma)
     {
-        memcpy(pMemOut, pMemIn, sizeToCopy);
+        pFrame->data[1]     = pData + lumaSize;
+        pFrame->data[2]     = pData + lumaSize + lumaSize / 4;
+        pFrame->linesize[1] = pitch / 2;
+        pFrame->linesize[2] = pitch / 2;
     }
+    else if (planes == 2)
+    {
+        pFrame->data[1]     = pData + lumaSize;
+        pFrame->linesize[1] = pitch;
+    }
+    pFrame->extended_data = pFrame->data;
 
     return AMF_OK;
 }
 //-------------------------------------------------------------------------------------------------
+AMF_RESULT AMF_STD_CALL  AMFVideoDecoderFFMPEGImpl::WrapFrameDirect(const AVFrame& picture, AMFSurface** ppSurface)
+{
+    if (IsDirectFormat(m_eFormat, picture.format) == false || picture.buf[0] == nullptr)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+
+    // frames from GetBufferDirect() always match, but anything the decoder
+    // allocated differently is checked against the host surface layout here
+    const amf_int32 pitch  = picture.linesize[0];
+    amf_int32       vPitch = picture.height;
+    const int       planes = av_pix_fmt_count_planes((AVPixelFormat)picture.format);
+    if (pitch <= 0)
+    {
+        return AMF_NOT_SUPPORTED;
+    }
+    if (planes > 1)
+    {
+        const ptrdiff_t offset = picture.data[1] - picture.data[0];
+        if (offset <= 0 || (offset % pitch) != 0 || (offset / pitch) < picture.height)
+        {
+            return AMF_NOT_SUPPORTED;
+        }
+        vPitch = amf_int32(offset / pitch);
+
+        if (planes == 2 && picture.linesize[1] != pitch)
+        {
+            return AMF_NOT_SUPPORTED;
+        }
+        if (planes == 3 && ((pitch & 1) != 0 || (vPitch & 1) != 0 ||
+                            picture.linesize[1] != pitch / 2 || picture.linesize[2] != pitch / 2 ||
+                            picture.data[2] != picture.data[1] + amf_size(pitch / 2) * (vPitch / 2)))
+        {
+            return AMF_NOT_SUPPORTED;
+        }
+    }
+
+    AVFrame* pRef = av_frame_clone(&picture);
+    AMF_RETURN_IF_INVALID_POINTER(pRef, L"WrapFrameDirect() - av_frame_clone failed");
+
+    AVFrameTracker* pTracker = new AVFrameTracker(pRef);
+    AMF_RESULT err = m_pContext->CreateSurfaceFromHostNative(m_eFormat, picture.width, picture.height, pitch, vPitch, picture.data[0], ppSurface, pTracker);
+    if (err != AMF_OK)
+    {
+        delete pTracker;
+    }
+    return err;
+}
+//-------------------------------------------------------------------------------------------------
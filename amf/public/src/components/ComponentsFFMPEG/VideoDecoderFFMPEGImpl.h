@@ -37,6 +37,7 @@
 #include "public/include/components/ColorSpace.h"
 #include "public/include/core/Context.h"
 #include "public/common/PropertyStorageExImpl.h"
+#include "PixelRepack.h"
 
 extern "C"
 {
@@ -106,13 +107,21 @@ namespace amf
         AMF_RESULT AMF_STD_CALL  GetHDRInfo(const AVMasteringDisplayMetadata* pInFFmpegMetadata, AMFHDRMetadata* pAMFHDRInfo);
         AMF_RESULT AMF_STD_CALL  GetColorInfo(AMFSurface* pSurfaceOut, const AVFrame& picture);
 
-        AMF_RESULT AMF_STD_CALL  CopyFrameThreaded(AMFPlane* pPlane, const AVFrame& picture, amf_int threadCount, bool isUVPlane);
+        AMF_RESULT AMF_STD_CALL  CopyFrame(AMFSurface* pSurfaceOut, const AVFrame& picture);
+        AMF_RESULT AMF_STD_CALL  CopyFrameThreaded(AMFPlane* pPlane, const AVFrame& picture, bool isUVPlane);
         AMF_RESULT AMF_STD_CALL  CopyFrameYUV422(AMFPlane* pPlane, const AVFrame& picture);
         AMF_RESULT AMF_STD_CALL  CopyFrameYUV444(AMFPlane* pPlane, const AVFrame& picture);
         AMF_RESULT AMF_STD_CALL  CopyFrameRGB_FP16(AMFPlane* pPlane, const AVFrame& picture);
         AMF_RESULT AMF_STD_CALL  CopyFrameUV(AMFPlane* pPlaneUV, const AVFrame& picture, amf_int32 paddedLSB);
         AMF_RESULT AMF_STD_CALL  CopyLineLSB(amf_uint8* pMemOut, const amf_uint8* pMemIn, amf_size sizeToCopy, amf_int32 paddedLSB);
 
+        // zero copy output: FFmpeg decodes into buffers laid out like AMF host
+        // surfaces, and the output surface wraps the decoded frame memory
+        static bool              IsDirectFormat(AMF_SURFACE_FORMAT eFormat, amf_int32 iPixelFormat);
+        static int               GetBufferDirect(AVCodecContext* pCodecContext, AVFrame* pFrame, int flags);
+        AMF_RESULT AMF_STD_CALL  AllocFrameDirect(AVCodecContext* pCodecContext, AVFrame* pFrame);
+        AMF_RESULT AMF_STD_CALL  WrapFrameDirect(const AVFrame& picture, AMFSurface** ppSurface);
+
 
         virtual AMF_RESULT AMF_STD_CALL  SubmitDebug(AVCodecContext* /*pCodecContext*/, AVPacket& /*avpkt*/)                                            {  return AMF_OK;  };
         virtual AMF_RESULT AMF_STD_CALL  RetrieveDebug(const AVCodecContext* /*pCodecContext*/, const AVFrame& /*picture*/, AMFData* /*pOutputData*/)   {  return AMF_OK;  };
@@ -150,6 +159,25 @@ namespace amf
 
         AMFDataAllocatorCBPtr       m_pOutputDataCallback;
 
+        bool                        m_bZeroCopy;
+        AMFCriticalSection          m_DirectPoolSync;   // get_buffer2 runs on FFmpeg frame threads, m_sync is held while decoding
+        AVBufferPool*               m_pDirectPool;
+        amf_size                    m_DirectPoolSize;
+
+        // keeps the decoded frame referenced while the wrapping surface is alive,
+        // which also stops FFmpeg from writing into it as a reference frame
+        class AVFrameTracker : public AMFSurfaceObserver
+        {
+        public:
+            AVFrameTracker(AVFrame* pFrame) : m_pFrame(pFrame) {}
+            virtual ~AVFrameTracker() { av_frame_free(&m_pFrame); }
+        protected:
+            virtual void AMF_STD_CALL OnSurfaceDataRelease(AMFSurface* /* pSurface */) { delete this; }
+
+        private:
+            AVFrame*    m_pFrame;
+        };
+
         struct CopyTask
         {
             amf_uint8 *pSrc;
@@ -157,12 +185,8 @@ namespace amf
             amf_uint8 *pDst;
             amf_size   SrcLineSize;
             amf_size   DstLineSize;
-            amf_int    lineStart;
-            amf_int    lineEnd;
-            AMFEvent*  pEvent;
-            amf_long*  pCounter;
 
-            void Run()
+            void Run(amf_int lineStart, amf_int lineEnd) const
             {
 
                 if (pSrc1 == nullptr)
@@ -176,51 +200,16 @@ namespace amf
                 else
                 {
                     amf_size   toCopy = SrcLineSize;
+                    const AMFPixelRepackKernels& repack = GetPixelRepackKernels();
 
                     for (amf_int i = lineStart; i < lineEnd; i++)
                     {
-                        amf_uint8 *pLineMemOut = pDst + i * DstLineSize;
-                        amf_uint8 *pLineMemIn1 = pSrc + i * SrcLineSize;
-                        amf_uint8 *pLineMemIn2 = pSrc1 + i * SrcLineSize;
-
-                        for (amf_size x = 0; x < toCopy; x++)
-                        {
-                            *pLineMemOut++ = *pLineMemIn1++;
-                            *pLineMemOut++ = *pLineMemIn2++;
-                        }
+                        repack.InterleaveUV8(pDst + i * DstLineSize, pSrc + i * SrcLineSize, pSrc1 + i * SrcLineSize, toCopy);
                     }
                 }
-                if (amf_atomic_dec(pCounter) == 0)
-                {
-                    pEvent->SetEvent();
-                }
-            }
-        };
-        AMFQueue<CopyTask> m_InputQueue;
-
-        class CopyThread : public AMFQueueThread<CopyTask, int>
-        {
-        public:
-            CopyThread(AMFQueue<CopyTask>* pInputQueue, AMFQueue<int>* pOutputQueue, int /*param*/) :
-                AMFQueueThread<CopyTask, int>(pInputQueue, pOutputQueue) {}
-            virtual bool Process(amf_ulong& /*ulID*/, CopyTask& inData, int& /*outData*/)
-            {
-                inData.Run();
-                return true;
-            }
-        };
-
-        class CopyPipeline : public AMFQueueThreadPipeline<CopyTask, int, CopyThread, int>
-        {
-        public:
-            CopyPipeline(AMFQueue<CopyTask>* pInputQueue) :
-                AMFQueueThreadPipeline<CopyTask, int, CopyThread, int>(pInputQueue, nullptr),
-                m_endEvent(false, false)
-            {
             }
-            AMFEvent m_endEvent;
         };
-        CopyPipeline m_CopyPipeline;
+        AMFThreadPool*              m_pThreadPool;  // shared pool, acquired on the first threaded copy
 
         AMFVideoDecoderFFMPEGImpl(const AMFVideoDecoderFFMPEGImpl&);
         AMFVideoDecoderFFMPEGImpl& operator=(const AMFVideoDecoderFFMPEGImpl&);